@@ -0,0 +1,128 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "DispatchGroup.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace nc::base {
+
+/**
+ * DispatchStack processes the pushed items by a bounded number of blocks running in a dispatch group.
+ * The items are taken last-in-first-out, so a tree traversal which pushes the children of the node being processed
+ * goes depth-first and keeps the amount of the pending nodes low.
+ * A block quits once there are no more items and new blocks are started when more items are pushed later, so none of
+ * them is left idling. Completion is awaited via the dispatch group.
+ * Stop() drops the pending items and lets the running blocks quit after their current items.
+ * Is thread-safe, the items can be pushed from within the processing function.
+ */
+template <class T>
+class DispatchStack
+{
+public:
+    using Processor = std::function<void(T _item)>;
+
+    DispatchStack(const DispatchGroup &_group, size_t _concurrency, Processor _processor);
+    DispatchStack(const DispatchStack &) = delete;
+    void operator=(const DispatchStack &) = delete;
+
+    // Queues a single item.
+    void Push(T _item);
+
+    // Queues the items at once, the last one is processed first. The items are moved from.
+    void Push(std::span<T> _items);
+
+    // Drops the pending items and ignores the ones pushed afterwards.
+    void Stop() noexcept;
+
+    bool Stopped() const noexcept;
+
+private:
+    void Dispatch(size_t _to_run);
+    void Drain();
+
+    const DispatchGroup &m_Group;
+    const size_t m_Concurrency;
+    const Processor m_Processor;
+    std::mutex m_Lock;
+    std::vector<T> m_Items; // guarded by m_Lock
+    size_t m_Running = 0;   // blocks draining m_Items, guarded by m_Lock
+    std::atomic_bool m_Stopped{false};
+};
+
+template <class T>
+DispatchStack<T>::DispatchStack(const DispatchGroup &_group, size_t _concurrency, Processor _processor)
+    : m_Group(_group), m_Concurrency(std::max(_concurrency, size_t(1))), m_Processor(std::move(_processor))
+{
+    assert(m_Processor);
+}
+
+template <class T>
+void DispatchStack<T>::Push(T _item)
+{
+    Push(std::span<T>{&_item, 1});
+}
+
+template <class T>
+void DispatchStack<T>::Push(std::span<T> _items)
+{
+    if( _items.empty() )
+        return;
+    size_t to_run = 0;
+    {
+        const auto lock = std::lock_guard{m_Lock};
+        if( m_Stopped )
+            return;
+        std::ranges::move(_items, std::back_inserter(m_Items));
+        to_run = std::min(m_Concurrency - m_Running, m_Items.size());
+        m_Running += to_run;
+    }
+    Dispatch(to_run);
+}
+
+template <class T>
+void DispatchStack<T>::Stop() noexcept
+{
+    const auto lock = std::lock_guard{m_Lock};
+    m_Stopped = true;
+    m_Items.clear();
+}
+
+template <class T>
+bool DispatchStack<T>::Stopped() const noexcept
+{
+    return m_Stopped;
+}
+
+template <class T>
+void DispatchStack<T>::Dispatch(size_t _to_run)
+{
+    for( size_t i = 0; i != _to_run; ++i )
+        m_Group.Run([this] { Drain(); });
+}
+
+template <class T>
+void DispatchStack<T>::Drain()
+{
+    while( true ) {
+        T item;
+        {
+            const auto lock = std::lock_guard{m_Lock};
+            if( m_Items.empty() ) {
+                --m_Running; // a new block will be started if more items are pushed later
+                return;
+            }
+            item = std::move(m_Items.back());
+            m_Items.pop_back();
+        }
+        m_Processor(std::move(item));
+    }
+}
+
+} // namespace nc::base
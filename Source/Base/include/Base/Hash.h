@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2019 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include <vector>
@@ -21,6 +21,20 @@ public:
         SHA2_256,
         SHA2_384,
         SHA2_512,
+        // Non-cryptographic hashes and a checksum, much faster than the digests above.
+        XXH3_64,
+        XXH3_128,
+        CRC32C,
+        // Cryptographic, hashes large inputs on multiple threads.
+        BLAKE3,
+    };
+
+    enum class FileAccess {
+        // Sequential large reads into a page-aligned buffer.
+        Read,
+        // Mapping of the file into memory, which avoids copying but turns a concurrent truncation of the file into a
+        // crash (SIGBUS). Only suitable for files that can't change meanwhile, falls back to reading otherwise.
+        Map
     };
 
     Hash(Mode _mode);
@@ -28,11 +42,15 @@ public:
     Hash &Feed(const void *_data, size_t _size);
     std::vector<uint8_t> Final();
 
+    // Feeds the whole contents of the file _fd, regardless of its current position.
+    // Returns true on success, false otherwise + errno contains an error code.
+    bool FeedFile(int _fd, FileAccess _access = FileAccess::Read);
+
     static std::string Hex(const std::vector<uint8_t> &_d);
 
 private:
     Mode m_Mode;
-    uint8_t m_Stuff[1024];
+    alignas(16) uint8_t m_Stuff[2048];
 };
 
 } // namespace nc::base
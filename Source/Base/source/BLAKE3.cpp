@@ -0,0 +1,305 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "BLAKE3.h"
+#include <Base/dispatch_cpp.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+namespace nc::base::detail {
+
+static_assert(std::endian::native == std::endian::little);
+
+using CV = BLAKE3::CV;
+
+static constexpr size_t g_BlockLen = 64;
+static constexpr size_t g_ChunkLen = 1024;
+
+// subtrees of at least this size are hashed concurrently, split into the pieces of g_ParallelPiece bytes each
+static constexpr size_t g_ParallelThreshold = 1024 * 1024;
+static constexpr size_t g_ParallelPiece = 128 * 1024;
+static_assert(std::has_single_bit(g_ParallelPiece) && g_ParallelThreshold >= 2 * g_ParallelPiece);
+
+static constexpr uint32_t g_ChunkStart = 1 << 0;
+static constexpr uint32_t g_ChunkEnd = 1 << 1;
+static constexpr uint32_t g_Parent = 1 << 2;
+static constexpr uint32_t g_Root = 1 << 3;
+
+static constexpr CV g_IV = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+
+// the message words used by each of the 7 rounds, i.e. the cumulative effect of the message permutation
+static constexpr auto g_Schedule = [] {
+    constexpr size_t permutation[16] = {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8};
+    std::array<std::array<uint8_t, 16>, 7> schedule{};
+    for( size_t i = 0; i < 16; ++i )
+        schedule[0][i] = static_cast<uint8_t>(i);
+    for( size_t round = 1; round < 7; ++round )
+        for( size_t i = 0; i < 16; ++i )
+            schedule[round][i] = schedule[round - 1][permutation[i]];
+    return schedule;
+}();
+
+static inline void G(uint32_t *_s, size_t _a, size_t _b, size_t _c, size_t _d, uint32_t _x, uint32_t _y) noexcept
+{
+    _s[_a] = _s[_a] + _s[_b] + _x;
+    _s[_d] = std::rotr(_s[_d] ^ _s[_a], 16);
+    _s[_c] = _s[_c] + _s[_d];
+    _s[_b] = std::rotr(_s[_b] ^ _s[_c], 12);
+    _s[_a] = _s[_a] + _s[_b] + _y;
+    _s[_d] = std::rotr(_s[_d] ^ _s[_a], 8);
+    _s[_c] = _s[_c] + _s[_d];
+    _s[_b] = std::rotr(_s[_b] ^ _s[_c], 7);
+}
+
+// Returns the full 16-word output of the compression function.
+static void Compress(const CV &_cv,
+                     const unsigned char *_block,
+                     uint32_t _block_len,
+                     uint64_t _counter,
+                     uint32_t _flags,
+                     uint32_t _out[16]) noexcept
+{
+    uint32_t m[16];
+    std::memcpy(m, _block, sizeof(m));
+    uint32_t *const s = _out;
+    std::copy(_cv.begin(), _cv.end(), s);
+    std::copy(g_IV.begin(), g_IV.begin() + 4, s + 8);
+    s[12] = static_cast<uint32_t>(_counter);
+    s[13] = static_cast<uint32_t>(_counter >> 32);
+    s[14] = _block_len;
+    s[15] = _flags;
+    for( const auto &w : g_Schedule ) {
+        G(s, 0, 4, 8, 12, m[w[0]], m[w[1]]);
+        G(s, 1, 5, 9, 13, m[w[2]], m[w[3]]);
+        G(s, 2, 6, 10, 14, m[w[4]], m[w[5]]);
+        G(s, 3, 7, 11, 15, m[w[6]], m[w[7]]);
+        G(s, 0, 5, 10, 15, m[w[8]], m[w[9]]);
+        G(s, 1, 6, 11, 12, m[w[10]], m[w[11]]);
+        G(s, 2, 7, 8, 13, m[w[12]], m[w[13]]);
+        G(s, 3, 4, 9, 14, m[w[14]], m[w[15]]);
+    }
+    for( size_t i = 0; i < 8; ++i ) {
+        s[i] ^= s[i + 8];
+        s[i + 8] ^= _cv[i];
+    }
+}
+
+static CV CompressCV(const CV &_cv,
+                     const unsigned char *_block,
+                     uint32_t _block_len,
+                     uint64_t _counter,
+                     uint32_t _flags) noexcept
+{
+    uint32_t out[16];
+    Compress(_cv, _block, _block_len, _counter, _flags, out);
+    CV cv;
+    std::copy(out, out + 8, cv.begin());
+    return cv;
+}
+
+namespace {
+
+// The inputs of the last compression of a node, which can either be turned into a chaining value or into the root.
+struct Output {
+    CV cv;
+    unsigned char block[g_BlockLen];
+    uint32_t block_len;
+    uint64_t counter;
+    uint32_t flags;
+
+    CV ChainingValue() const noexcept { return CompressCV(cv, block, block_len, counter, flags); }
+
+    void Root(unsigned char _out[BLAKE3::OutputSize]) const noexcept
+    {
+        uint32_t words[16];
+        Compress(cv, block, block_len, 0, flags | g_Root, words);
+        std::memcpy(_out, words, BLAKE3::OutputSize);
+    }
+};
+
+} // namespace
+
+static Output ParentOutput(const CV &_left, const CV &_right) noexcept
+{
+    Output output;
+    output.cv = g_IV;
+    std::memcpy(output.block, _left.data(), 32);
+    std::memcpy(output.block + 32, _right.data(), 32);
+    output.block_len = g_BlockLen;
+    output.counter = 0;
+    output.flags = g_Parent;
+    return output;
+}
+
+static CV ParentCV(const CV &_left, const CV &_right) noexcept
+{
+    return ParentOutput(_left, _right).ChainingValue();
+}
+
+static CV ChunkCV(const unsigned char *_chunk, uint64_t _counter) noexcept
+{
+    CV cv = g_IV;
+    for( size_t i = 0; i < g_ChunkLen / g_BlockLen; ++i ) {
+        const uint32_t flags = (i == 0 ? g_ChunkStart : 0) | (i == g_ChunkLen / g_BlockLen - 1 ? g_ChunkEnd : 0);
+        cv = CompressCV(cv, _chunk + i * g_BlockLen, g_BlockLen, _counter, flags);
+    }
+    return cv;
+}
+
+// Hashes a complete subtree, _size must be a power-of-two number of chunks.
+static CV SubtreeCV(const unsigned char *_data, size_t _size, uint64_t _counter) noexcept
+{
+    if( _size == g_ChunkLen )
+        return ChunkCV(_data, _counter);
+    const size_t half = _size / 2;
+    return ParentCV(SubtreeCV(_data, half, _counter), SubtreeCV(_data + half, half, _counter + half / g_ChunkLen));
+}
+
+// Hashes a complete subtree of at least two chunks and returns the chaining values of the two children of its root.
+static std::pair<CV, CV> SubtreeChildren(const unsigned char *_data, size_t _size, uint64_t _counter) noexcept
+{
+    const size_t half = _size / 2;
+    if( _size < g_ParallelThreshold )
+        return {SubtreeCV(_data, half, _counter), SubtreeCV(_data + half, half, _counter + half / g_ChunkLen)};
+
+    std::vector<CV> cvs(_size / g_ParallelPiece);
+    dispatch_apply(cvs.size(), [&](size_t _piece) {
+        const size_t offset = _piece * g_ParallelPiece;
+        cvs[_piece] = SubtreeCV(_data + offset, g_ParallelPiece, _counter + offset / g_ChunkLen);
+    });
+    for( size_t count = cvs.size(); count > 2; count /= 2 )
+        for( size_t i = 0; i < count / 2; ++i )
+            cvs[i] = ParentCV(cvs[2 * i], cvs[2 * i + 1]);
+    return {cvs[0], cvs[1]};
+}
+
+BLAKE3::BLAKE3() noexcept
+{
+    ResetChunk(0);
+}
+
+size_t BLAKE3::ChunkLength() const noexcept
+{
+    return g_BlockLen * m_BlocksCompressed + m_BlockLength;
+}
+
+void BLAKE3::ResetChunk(uint64_t _chunk_counter) noexcept
+{
+    m_ChunkCV = g_IV;
+    m_ChunkCounter = _chunk_counter;
+    m_BlockLength = 0;
+    m_BlocksCompressed = 0;
+}
+
+void BLAKE3::UpdateChunk(const unsigned char *_data, size_t _size) noexcept
+{
+    while( _size > 0 ) {
+        // a full block is compressed only once more data arrives, since the last block of a chunk is special
+        if( m_BlockLength == g_BlockLen ) {
+            const uint32_t flags = m_BlocksCompressed == 0 ? g_ChunkStart : 0;
+            m_ChunkCV = CompressCV(m_ChunkCV, m_Block, g_BlockLen, m_ChunkCounter, flags);
+            ++m_BlocksCompressed;
+            m_BlockLength = 0;
+        }
+        const size_t take = std::min(g_BlockLen - m_BlockLength, _size);
+        std::memcpy(m_Block + m_BlockLength, _data, take);
+        m_BlockLength += static_cast<uint8_t>(take);
+        _data += take;
+        _size -= take;
+    }
+}
+
+void BLAKE3::MergeCVStack(uint64_t _total_chunks) noexcept
+{
+    // the stack holds one chaining value per each set bit of the number of chunks hashed so far
+    const size_t post_merge_length = std::popcount(_total_chunks);
+    while( m_CVStackLength > post_merge_length ) {
+        m_CVStack[m_CVStackLength - 2] = ParentCV(m_CVStack[m_CVStackLength - 2], m_CVStack[m_CVStackLength - 1]);
+        --m_CVStackLength;
+    }
+}
+
+void BLAKE3::PushCV(const CV &_cv, uint64_t _chunk_counter) noexcept
+{
+    MergeCVStack(_chunk_counter);
+    m_CVStack[m_CVStackLength++] = _cv;
+}
+
+void BLAKE3::Update(const void *_data, size_t _size) noexcept
+{
+    auto input = static_cast<const unsigned char *>(_data);
+
+    if( ChunkLength() > 0 ) {
+        const size_t take = std::min(g_ChunkLen - ChunkLength(), _size);
+        UpdateChunk(input, take);
+        input += take;
+        _size -= take;
+        if( _size == 0 )
+            return;
+        // the chunk is complete and more data follows, so it's not the root
+        Output output{m_ChunkCV, {}, m_BlockLength, m_ChunkCounter, g_ChunkEnd};
+        std::memcpy(output.block, m_Block, g_BlockLen);
+        PushCV(output.ChainingValue(), m_ChunkCounter);
+        ResetChunk(m_ChunkCounter + 1);
+    }
+
+    // hash the largest whole subtrees while more than a chunk is left, each subtree has to be aligned to its size
+    while( _size > g_ChunkLen ) {
+        size_t subtree_len = std::bit_floor(_size);
+        const uint64_t count_so_far = m_ChunkCounter * g_ChunkLen;
+        while( ((subtree_len - 1) & count_so_far) != 0 )
+            subtree_len /= 2;
+        const uint64_t subtree_chunks = subtree_len / g_ChunkLen;
+        if( subtree_len == g_ChunkLen ) {
+            PushCV(ChunkCV(input, m_ChunkCounter), m_ChunkCounter);
+        }
+        else {
+            const auto [left, right] = SubtreeChildren(input, subtree_len, m_ChunkCounter);
+            PushCV(left, m_ChunkCounter);
+            PushCV(right, m_ChunkCounter + subtree_chunks / 2);
+        }
+        m_ChunkCounter += subtree_chunks;
+        input += subtree_len;
+        _size -= subtree_len;
+    }
+
+    if( _size > 0 ) {
+        UpdateChunk(input, _size);
+        // the stack can't contain the root anymore, so it can be merged eagerly, which simplifies Final()
+        MergeCVStack(m_ChunkCounter);
+    }
+}
+
+void BLAKE3::Final(unsigned char _out[OutputSize]) const noexcept
+{
+    const auto chunk_output = [this] {
+        Output output{m_ChunkCV, {}, m_BlockLength, m_ChunkCounter, g_ChunkEnd};
+        if( m_BlocksCompressed == 0 )
+            output.flags |= g_ChunkStart;
+        std::memcpy(output.block, m_Block, m_BlockLength);
+        return output;
+    };
+
+    if( m_CVStackLength == 0 ) {
+        chunk_output().Root(_out);
+        return;
+    }
+
+    Output output;
+    size_t remaining = m_CVStackLength;
+    if( ChunkLength() > 0 ) {
+        output = chunk_output();
+    }
+    else {
+        output = ParentOutput(m_CVStack[remaining - 2], m_CVStack[remaining - 1]);
+        remaining -= 2;
+    }
+    while( remaining > 0 ) {
+        output = ParentOutput(m_CVStack[remaining - 1], output.ChainingValue());
+        --remaining;
+    }
+    output.Root(_out);
+}
+
+} // namespace nc::base::detail
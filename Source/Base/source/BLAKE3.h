@@ -0,0 +1,44 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace nc::base::detail {
+
+// Streaming unkeyed BLAKE3 with the default 32-byte output.
+// Large inputs are split into the whole subtrees of chunks which are hashed concurrently, so feeding the data in big
+// pieces (megabytes) lets the hashing scale with the number of cores. Is trivially copyable.
+class BLAKE3
+{
+public:
+    static constexpr size_t OutputSize = 32;
+    using CV = std::array<uint32_t, 8>;
+
+    BLAKE3() noexcept;
+    void Update(const void *_data, size_t _size) noexcept;
+    void Final(unsigned char _out[OutputSize]) const noexcept;
+
+private:
+    static constexpr size_t MaxDepth = 54;
+
+    size_t ChunkLength() const noexcept;
+    void UpdateChunk(const unsigned char *_data, size_t _size) noexcept;
+    void ResetChunk(uint64_t _chunk_counter) noexcept;
+    void PushCV(const CV &_cv, uint64_t _chunk_counter) noexcept;
+    void MergeCVStack(uint64_t _total_chunks) noexcept;
+
+    // the chunk currently being filled
+    CV m_ChunkCV;
+    uint64_t m_ChunkCounter = 0;
+    unsigned char m_Block[64];
+    uint8_t m_BlockLength = 0;
+    uint8_t m_BlocksCompressed = 0;
+
+    // the chaining values of the completed subtrees, merged lazily
+    uint8_t m_CVStackLength = 0;
+    CV m_CVStack[MaxDepth + 1];
+};
+
+} // namespace nc::base::detail
@@ -0,0 +1,97 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "CRC32C.h"
+#include <array>
+#include <cstring>
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#elif defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace nc::base::detail {
+
+static constexpr uint32_t g_Polynomial = 0x82F63B78U; // reversed 0x1EDC6F41
+
+// slicing-by-8 tables, g_Tables[0] is the classic byte-wise table
+static constexpr auto g_Tables = [] {
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for( uint32_t i = 0; i < 256; ++i ) {
+        uint32_t crc = i;
+        for( int bit = 0; bit < 8; ++bit )
+            crc = (crc >> 1) ^ ((crc & 1) ? g_Polynomial : 0);
+        tables[0][i] = crc;
+    }
+    for( uint32_t i = 0; i < 256; ++i )
+        for( size_t t = 1; t < 8; ++t )
+            tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+    return tables;
+}();
+
+[[maybe_unused]] static uint32_t Software(uint32_t _crc, const unsigned char *_p, size_t _size) noexcept
+{
+    for( ; _size >= 8; _p += 8, _size -= 8 ) {
+        uint64_t v;
+        std::memcpy(&v, _p, sizeof(v));
+        v ^= _crc;
+        _crc = g_Tables[7][v & 0xFF] ^ g_Tables[6][(v >> 8) & 0xFF] ^ g_Tables[5][(v >> 16) & 0xFF] ^
+               g_Tables[4][(v >> 24) & 0xFF] ^ g_Tables[3][(v >> 32) & 0xFF] ^ g_Tables[2][(v >> 40) & 0xFF] ^
+               g_Tables[1][(v >> 48) & 0xFF] ^ g_Tables[0][v >> 56];
+    }
+    for( ; _size > 0; ++_p, --_size )
+        _crc = (_crc >> 8) ^ g_Tables[0][(_crc ^ *_p) & 0xFF];
+    return _crc;
+}
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+
+static uint32_t Hardware(uint32_t _crc, const unsigned char *_p, size_t _size) noexcept
+{
+    for( ; _size >= 8; _p += 8, _size -= 8 ) {
+        uint64_t v;
+        std::memcpy(&v, _p, sizeof(v));
+        _crc = __crc32cd(_crc, v);
+    }
+    for( ; _size > 0; ++_p, --_size )
+        _crc = __crc32cb(_crc, *_p);
+    return _crc;
+}
+
+uint32_t CRC32C(uint32_t _crc, const void *_data, size_t _size) noexcept
+{
+    return ~Hardware(~_crc, static_cast<const unsigned char *>(_data), _size);
+}
+
+#elif defined(__x86_64__)
+
+__attribute__((target("sse4.2"))) static uint32_t
+Hardware(uint32_t _crc, const unsigned char *_p, size_t _size) noexcept
+{
+    uint64_t crc = _crc;
+    for( ; _size >= 8; _p += 8, _size -= 8 ) {
+        uint64_t v;
+        std::memcpy(&v, _p, sizeof(v));
+        crc = _mm_crc32_u64(crc, v);
+    }
+    for( ; _size > 0; ++_p, --_size )
+        crc = _mm_crc32_u8(static_cast<uint32_t>(crc), *_p);
+    return static_cast<uint32_t>(crc);
+}
+
+uint32_t CRC32C(uint32_t _crc, const void *_data, size_t _size) noexcept
+{
+    static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+    const auto p = static_cast<const unsigned char *>(_data);
+    return ~(has_sse42 ? Hardware(~_crc, p, _size) : Software(~_crc, p, _size));
+}
+
+#else
+
+uint32_t CRC32C(uint32_t _crc, const void *_data, size_t _size) noexcept
+{
+    return ~Software(~_crc, static_cast<const unsigned char *>(_data), _size);
+}
+
+#endif
+
+} // namespace nc::base::detail
@@ -0,0 +1,13 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nc::base::detail {
+
+// Updates the CRC-32C (Castagnoli) checksum _crc with the bytes of _data, starting with a zero checksum.
+// Uses the CRC32C instructions when the CPU provides them and falls back to a table-driven implementation otherwise.
+uint32_t CRC32C(uint32_t _crc, const void *_data, size_t _size) noexcept;
+
+} // namespace nc::base::detail
@@ -1,16 +1,39 @@
-// Copyright (C) 2014-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <Base/Hash.h>
+#include "BLAKE3.h"
+#include "CRC32C.h"
+#include "XXH3.h"
 #include <CommonCrypto/CommonDigest.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <zlib.h>
 
 namespace nc::base {
 
+// the sizes of the large chunks used when feeding files
+static constexpr size_t g_FileReadBufferSize = 8 * 1024 * 1024;
+static constexpr size_t g_FileMapSlice = 64 * 1024 * 1024;
+
+static void PutBigEndian(uint64_t _value, uint8_t *_out) noexcept
+{
+    for( int i = 7; i >= 0; --i, _value >>= 8 )
+        _out[i] = static_cast<uint8_t>(_value);
+}
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
 
 Hash::Hash(Mode _mode) : m_Mode(_mode)
 {
+    static_assert(sizeof(detail::XXH3) <= sizeof(m_Stuff) && alignof(detail::XXH3) <= 16);
+    static_assert(sizeof(detail::BLAKE3) <= sizeof(m_Stuff) && alignof(detail::BLAKE3) <= 16);
     switch( m_Mode ) {
         case SHA1_160:
             CC_SHA1_Init(reinterpret_cast<CC_SHA1_CTX *>(m_Stuff));
@@ -42,6 +65,16 @@ Hash::Hash(Mode _mode) : m_Mode(_mode)
         case CRC32:
             *reinterpret_cast<uint32_t *>(m_Stuff) = static_cast<uint32_t>(crc32(0, nullptr, 0));
             break;
+        case XXH3_64:
+        case XXH3_128:
+            new(m_Stuff) detail::XXH3;
+            break;
+        case CRC32C:
+            *reinterpret_cast<uint32_t *>(m_Stuff) = 0;
+            break;
+        case BLAKE3:
+            new(m_Stuff) detail::BLAKE3;
+            break;
         default:
             assert(0);
     }
@@ -83,6 +116,17 @@ Hash &Hash::Feed(const void *_data, size_t _size)
             *reinterpret_cast<uint32_t *>(m_Stuff) = static_cast<uint32_t>(
                 crc32(*reinterpret_cast<uint32_t *>(m_Stuff), reinterpret_cast<const unsigned char *>(_data), usize));
             break;
+        case XXH3_64:
+        case XXH3_128:
+            reinterpret_cast<detail::XXH3 *>(m_Stuff)->Update(_data, _size);
+            break;
+        case CRC32C:
+            *reinterpret_cast<uint32_t *>(m_Stuff) =
+                detail::CRC32C(*reinterpret_cast<uint32_t *>(m_Stuff), _data, _size);
+            break;
+        case BLAKE3:
+            reinterpret_cast<detail::BLAKE3 *>(m_Stuff)->Update(_data, _size);
+            break;
         default:
             assert(0);
     }
@@ -134,13 +178,74 @@ std::vector<uint8_t> Hash::Final()
         }
         case Adler32:
         case CRC32:
+        case CRC32C:
             return std::vector<uint8_t>{m_Stuff[3], m_Stuff[2], m_Stuff[1], m_Stuff[0]};
+        case XXH3_64: {
+            std::vector<uint8_t> r(8);
+            PutBigEndian(reinterpret_cast<const detail::XXH3 *>(m_Stuff)->Digest64(), r.data());
+            return r;
+        }
+        case XXH3_128: {
+            const auto digest = reinterpret_cast<const detail::XXH3 *>(m_Stuff)->Digest128();
+            std::vector<uint8_t> r(16);
+            PutBigEndian(digest.high, r.data());
+            PutBigEndian(digest.low, r.data() + 8);
+            return r;
+        }
+        case BLAKE3: {
+            std::vector<uint8_t> r(detail::BLAKE3::OutputSize);
+            reinterpret_cast<const detail::BLAKE3 *>(m_Stuff)->Final(r.data());
+            return r;
+        }
         default:
             assert(0);
     }
     return {};
 }
 
+bool Hash::FeedFile(int _fd, FileAccess _access)
+{
+    struct stat st;
+    if( fstat(_fd, &st) != 0 )
+        return false;
+
+    if( _access == FileAccess::Map && S_ISREG(st.st_mode) && st.st_size > 0 ) {
+        const size_t size = static_cast<size_t>(st.st_size);
+        void *const addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, _fd, 0);
+        if( addr != MAP_FAILED ) {
+            madvise(addr, size, MADV_SEQUENTIAL);
+            // CommonCrypto and zlib accept only 32-bit sizes, so the mapping is fed piece by piece
+            const auto bytes = static_cast<const uint8_t *>(addr);
+            for( size_t offset = 0; offset < size; offset += g_FileMapSlice )
+                Feed(bytes + offset, std::min(g_FileMapSlice, size - offset));
+            munmap(addr, size);
+            return true;
+        }
+    }
+
+    const size_t page = static_cast<size_t>(getpagesize());
+    const auto buffer = std::unique_ptr<uint8_t, decltype(&std::free)>(
+        static_cast<uint8_t *>(std::aligned_alloc(page, g_FileReadBufferSize)), &std::free);
+    if( !buffer ) {
+        errno = ENOMEM;
+        return false;
+    }
+
+    off_t offset = 0;
+    while( true ) {
+        const ssize_t rn = pread(_fd, buffer.get(), g_FileReadBufferSize, offset);
+        if( rn < 0 ) {
+            if( errno == EINTR )
+                continue;
+            return false;
+        }
+        if( rn == 0 )
+            return true;
+        Feed(buffer.get(), static_cast<size_t>(rn));
+        offset += rn;
+    }
+}
+
 std::string Hash::Hex(const std::vector<uint8_t> &_d)
 {
     static const char c[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
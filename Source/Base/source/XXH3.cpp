@@ -0,0 +1,446 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "XXH3.h"
+#include <bit>
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace nc::base::detail {
+
+static_assert(std::endian::native == std::endian::little);
+
+static constexpr size_t g_StripeLen = 64;
+static constexpr size_t g_SecretConsumeRate = 8;
+static constexpr size_t g_SecretSize = 192;
+static constexpr size_t g_SecretSizeMin = 136;
+static constexpr size_t g_SecretMergeAccsStart = 11;
+static constexpr size_t g_SecretLastAccStart = 7;
+static constexpr size_t g_StripesPerBlock = (g_SecretSize - g_StripeLen) / g_SecretConsumeRate;
+static constexpr size_t g_MidSizeMax = 240;
+
+static constexpr uint32_t g_Prime32_1 = 0x9E3779B1U;
+static constexpr uint32_t g_Prime32_2 = 0x85EBCA77U;
+static constexpr uint32_t g_Prime32_3 = 0xC2B2AE3DU;
+static constexpr uint64_t g_Prime64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t g_Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t g_Prime64_3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t g_Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t g_Prime64_5 = 0x27D4EB2F165667C5ULL;
+
+alignas(64) static constexpr unsigned char g_Secret[g_SecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c, //
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, //
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21, //
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c, //
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, //
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8, //
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d, //
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, //
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb, //
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e, //
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, //
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e, //
+};
+
+static inline uint32_t Read32(const unsigned char *_p) noexcept
+{
+    uint32_t v;
+    std::memcpy(&v, _p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t Read64(const unsigned char *_p) noexcept
+{
+    uint64_t v;
+    std::memcpy(&v, _p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t Mult32To64(uint64_t _a, uint64_t _b) noexcept
+{
+    return (_a & 0xFFFFFFFFULL) * (_b & 0xFFFFFFFFULL);
+}
+
+static inline XXH3::Hash128 Mult64To128(uint64_t _a, uint64_t _b) noexcept
+{
+    const unsigned __int128 product = static_cast<unsigned __int128>(_a) * _b;
+    return {static_cast<uint64_t>(product), static_cast<uint64_t>(product >> 64)};
+}
+
+static inline uint64_t Mul128Fold64(uint64_t _a, uint64_t _b) noexcept
+{
+    const auto product = Mult64To128(_a, _b);
+    return product.low ^ product.high;
+}
+
+static inline uint64_t XXH64Avalanche(uint64_t _h) noexcept
+{
+    _h ^= _h >> 33;
+    _h *= g_Prime64_2;
+    _h ^= _h >> 29;
+    _h *= g_Prime64_3;
+    _h ^= _h >> 32;
+    return _h;
+}
+
+static inline uint64_t Avalanche(uint64_t _h) noexcept
+{
+    _h ^= _h >> 37;
+    _h *= 0x165667919E3779F9ULL;
+    _h ^= _h >> 32;
+    return _h;
+}
+
+static inline uint64_t RRMXMX(uint64_t _h, uint64_t _length) noexcept
+{
+    _h ^= std::rotl(_h, 49) ^ std::rotl(_h, 24);
+    _h *= 0x9FB21C651E98DF25ULL;
+    _h ^= (_h >> 35) + _length;
+    _h *= 0x9FB21C651E98DF25ULL;
+    _h ^= _h >> 28;
+    return _h;
+}
+
+static inline uint64_t Mix16B(const unsigned char *_input, const unsigned char *_secret) noexcept
+{
+    return Mul128Fold64(Read64(_input) ^ Read64(_secret), Read64(_input + 8) ^ Read64(_secret + 8));
+}
+
+static inline void Mix32B(XXH3::Hash128 &_acc,
+                          const unsigned char *_input_1,
+                          const unsigned char *_input_2,
+                          const unsigned char *_secret) noexcept
+{
+    _acc.low += Mix16B(_input_1, _secret);
+    _acc.low ^= Read64(_input_2) + Read64(_input_2 + 8);
+    _acc.high += Mix16B(_input_2, _secret + 16);
+    _acc.high ^= Read64(_input_1) + Read64(_input_1 + 8);
+}
+
+static uint64_t Hash64_0To16(const unsigned char *_input, size_t _len) noexcept
+{
+    if( _len > 8 ) {
+        const uint64_t flip_1 = Read64(g_Secret + 24) ^ Read64(g_Secret + 32);
+        const uint64_t flip_2 = Read64(g_Secret + 40) ^ Read64(g_Secret + 48);
+        const uint64_t input_lo = Read64(_input) ^ flip_1;
+        const uint64_t input_hi = Read64(_input + _len - 8) ^ flip_2;
+        const uint64_t acc = _len + std::byteswap(input_lo) + input_hi + Mul128Fold64(input_lo, input_hi);
+        return Avalanche(acc);
+    }
+    if( _len >= 4 ) {
+        const uint64_t flip = Read64(g_Secret + 8) ^ Read64(g_Secret + 16);
+        const uint64_t input64 = Read32(_input + _len - 4) + (static_cast<uint64_t>(Read32(_input)) << 32);
+        return RRMXMX(input64 ^ flip, _len);
+    }
+    if( _len > 0 ) {
+        const uint32_t combined = (static_cast<uint32_t>(_input[0]) << 16) |
+                                  (static_cast<uint32_t>(_input[_len >> 1]) << 24) |
+                                  static_cast<uint32_t>(_input[_len - 1]) | (static_cast<uint32_t>(_len) << 8);
+        const uint64_t flip = Read32(g_Secret) ^ Read32(g_Secret + 4);
+        return XXH64Avalanche(combined ^ flip);
+    }
+    return XXH64Avalanche(Read64(g_Secret + 56) ^ Read64(g_Secret + 64));
+}
+
+static uint64_t Hash64_17To128(const unsigned char *_input, size_t _len) noexcept
+{
+    uint64_t acc = _len * g_Prime64_1;
+    if( _len > 32 ) {
+        if( _len > 64 ) {
+            if( _len > 96 ) {
+                acc += Mix16B(_input + 48, g_Secret + 96);
+                acc += Mix16B(_input + _len - 64, g_Secret + 112);
+            }
+            acc += Mix16B(_input + 32, g_Secret + 64);
+            acc += Mix16B(_input + _len - 48, g_Secret + 80);
+        }
+        acc += Mix16B(_input + 16, g_Secret + 32);
+        acc += Mix16B(_input + _len - 32, g_Secret + 48);
+    }
+    acc += Mix16B(_input, g_Secret);
+    acc += Mix16B(_input + _len - 16, g_Secret + 16);
+    return Avalanche(acc);
+}
+
+static uint64_t Hash64_129To240(const unsigned char *_input, size_t _len) noexcept
+{
+    uint64_t acc = _len * g_Prime64_1;
+    const size_t rounds = _len / 16;
+    for( size_t i = 0; i < 8; ++i )
+        acc += Mix16B(_input + 16 * i, g_Secret + 16 * i);
+    acc = Avalanche(acc);
+    for( size_t i = 8; i < rounds; ++i )
+        acc += Mix16B(_input + 16 * i, g_Secret + 16 * (i - 8) + 3);
+    acc += Mix16B(_input + _len - 16, g_Secret + g_SecretSizeMin - 17);
+    return Avalanche(acc);
+}
+
+static XXH3::Hash128 Hash128_0To16(const unsigned char *_input, size_t _len) noexcept
+{
+    if( _len > 8 ) {
+        const uint64_t flip_lo = Read64(g_Secret + 32) ^ Read64(g_Secret + 40);
+        const uint64_t flip_hi = Read64(g_Secret + 48) ^ Read64(g_Secret + 56);
+        const uint64_t input_lo = Read64(_input);
+        uint64_t input_hi = Read64(_input + _len - 8);
+        auto m128 = Mult64To128(input_lo ^ input_hi ^ flip_lo, g_Prime64_1);
+        m128.low += static_cast<uint64_t>(_len - 1) << 54;
+        input_hi ^= flip_hi;
+        m128.high += input_hi + Mult32To64(static_cast<uint32_t>(input_hi), g_Prime32_2 - 1);
+        m128.low ^= std::byteswap(m128.high);
+        auto h128 = Mult64To128(m128.low, g_Prime64_2);
+        h128.high += m128.high * g_Prime64_2;
+        return {Avalanche(h128.low), Avalanche(h128.high)};
+    }
+    if( _len >= 4 ) {
+        const uint64_t input64 = Read32(_input) + (static_cast<uint64_t>(Read32(_input + _len - 4)) << 32);
+        const uint64_t flip = Read64(g_Secret + 16) ^ Read64(g_Secret + 24);
+        auto m128 = Mult64To128(input64 ^ flip, g_Prime64_1 + (_len << 2));
+        m128.high += m128.low << 1;
+        m128.low ^= m128.high >> 3;
+        m128.low ^= m128.low >> 35;
+        m128.low *= 0x9FB21C651E98DF25ULL;
+        m128.low ^= m128.low >> 28;
+        return {m128.low, Avalanche(m128.high)};
+    }
+    if( _len > 0 ) {
+        const uint32_t combined_lo = (static_cast<uint32_t>(_input[0]) << 16) |
+                                     (static_cast<uint32_t>(_input[_len >> 1]) << 24) |
+                                     static_cast<uint32_t>(_input[_len - 1]) | (static_cast<uint32_t>(_len) << 8);
+        const uint32_t combined_hi = std::rotl(std::byteswap(combined_lo), 13);
+        const uint64_t flip_lo = static_cast<uint64_t>(Read32(g_Secret)) ^ Read32(g_Secret + 4);
+        const uint64_t flip_hi = static_cast<uint64_t>(Read32(g_Secret + 8)) ^ Read32(g_Secret + 12);
+        return {XXH64Avalanche(combined_lo ^ flip_lo), XXH64Avalanche(combined_hi ^ flip_hi)};
+    }
+    return {XXH64Avalanche(Read64(g_Secret + 64) ^ Read64(g_Secret + 72)),
+            XXH64Avalanche(Read64(g_Secret + 80) ^ Read64(g_Secret + 88))};
+}
+
+static XXH3::Hash128 Finalize128(XXH3::Hash128 _acc, size_t _len) noexcept
+{
+    return {Avalanche(_acc.low + _acc.high),
+            0 - Avalanche(_acc.low * g_Prime64_1 + _acc.high * g_Prime64_4 + _len * g_Prime64_2)};
+}
+
+static XXH3::Hash128 Hash128_17To128(const unsigned char *_input, size_t _len) noexcept
+{
+    XXH3::Hash128 acc{_len * g_Prime64_1, 0};
+    if( _len > 32 ) {
+        if( _len > 64 ) {
+            if( _len > 96 )
+                Mix32B(acc, _input + 48, _input + _len - 64, g_Secret + 96);
+            Mix32B(acc, _input + 32, _input + _len - 48, g_Secret + 64);
+        }
+        Mix32B(acc, _input + 16, _input + _len - 32, g_Secret + 32);
+    }
+    Mix32B(acc, _input, _input + _len - 16, g_Secret);
+    return Finalize128(acc, _len);
+}
+
+static XXH3::Hash128 Hash128_129To240(const unsigned char *_input, size_t _len) noexcept
+{
+    XXH3::Hash128 acc{_len * g_Prime64_1, 0};
+    const size_t rounds = _len / 32;
+    for( size_t i = 0; i < 4; ++i )
+        Mix32B(acc, _input + 32 * i, _input + 32 * i + 16, g_Secret + 32 * i);
+    acc.low = Avalanche(acc.low);
+    acc.high = Avalanche(acc.high);
+    for( size_t i = 4; i < rounds; ++i )
+        Mix32B(acc, _input + 32 * i, _input + 32 * i + 16, g_Secret + 3 + 32 * (i - 4));
+    Mix32B(acc, _input + _len - 16, _input + _len - 32, g_Secret + g_SecretSizeMin - 17 - 16);
+    return Finalize128(acc, _len);
+}
+
+// Processes a 64-byte stripe, which is where almost all the time goes for the long inputs.
+static inline void Accumulate512(uint64_t *__restrict _acc,
+                                 const unsigned char *__restrict _input,
+                                 const unsigned char *__restrict _secret) noexcept
+{
+#if defined(__aarch64__)
+    uint64x2_t *const acc = reinterpret_cast<uint64x2_t *>(_acc);
+    for( size_t i = 0; i < 4; ++i ) {
+        const uint64x2_t data = vreinterpretq_u64_u8(vld1q_u8(_input + 16 * i));
+        const uint64x2_t key = veorq_u64(data, vreinterpretq_u64_u8(vld1q_u8(_secret + 16 * i)));
+        const uint64x2_t sum = vaddq_u64(acc[i], vextq_u64(data, data, 1));
+        acc[i] = vmlal_u32(sum, vmovn_u64(key), vshrn_n_u64(key, 32));
+    }
+#elif defined(__SSE2__)
+    __m128i *const acc = reinterpret_cast<__m128i *>(_acc);
+    for( size_t i = 0; i < 4; ++i ) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_input) + i);
+        const __m128i key = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i *>(_secret) + i));
+        const __m128i product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+        const __m128i sum = _mm_add_epi64(acc[i], _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2)));
+        acc[i] = _mm_add_epi64(product, sum);
+    }
+#else
+    for( size_t i = 0; i < 8; ++i ) {
+        const uint64_t data = Read64(_input + 8 * i);
+        const uint64_t key = data ^ Read64(_secret + 8 * i);
+        _acc[i ^ 1] += data;
+        _acc[i] += Mult32To64(key, key >> 32);
+    }
+#endif
+}
+
+static inline void ScrambleAcc(uint64_t *__restrict _acc, const unsigned char *__restrict _secret) noexcept
+{
+#if defined(__aarch64__)
+    uint64x2_t *const acc = reinterpret_cast<uint64x2_t *>(_acc);
+    const uint32x2_t prime = vdup_n_u32(g_Prime32_1);
+    for( size_t i = 0; i < 4; ++i ) {
+        const uint64x2_t data = veorq_u64(acc[i], vshrq_n_u64(acc[i], 47));
+        const uint64x2_t key = veorq_u64(data, vreinterpretq_u64_u8(vld1q_u8(_secret + 16 * i)));
+        const uint64x2_t product_hi = vshlq_n_u64(vmull_u32(vshrn_n_u64(key, 32), prime), 32);
+        acc[i] = vmlal_u32(product_hi, vmovn_u64(key), prime);
+    }
+#elif defined(__SSE2__)
+    __m128i *const acc = reinterpret_cast<__m128i *>(_acc);
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(g_Prime32_1));
+    for( size_t i = 0; i < 4; ++i ) {
+        const __m128i data = _mm_xor_si128(acc[i], _mm_srli_epi64(acc[i], 47));
+        const __m128i key = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i *>(_secret) + i));
+        const __m128i product_lo = _mm_mul_epu32(key, prime);
+        const __m128i product_hi = _mm_mul_epu32(_mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+        acc[i] = _mm_add_epi64(product_lo, _mm_slli_epi64(product_hi, 32));
+    }
+#else
+    for( size_t i = 0; i < 8; ++i ) {
+        uint64_t acc = _acc[i];
+        acc ^= acc >> 47;
+        acc ^= Read64(_secret + 8 * i);
+        acc *= g_Prime32_1;
+        _acc[i] = acc;
+    }
+#endif
+}
+
+static inline void
+AccumulateStripes(uint64_t *_acc, const unsigned char *_input, const unsigned char *_secret, size_t _stripes) noexcept
+{
+    for( size_t i = 0; i < _stripes; ++i )
+        Accumulate512(_acc, _input + i * g_StripeLen, _secret + i * g_SecretConsumeRate);
+}
+
+// Accumulates the stripes while keeping track of the position within the current block, scrambles the accumulators
+// upon reaching the end of a block. Returns the new position within the block.
+static size_t
+ConsumeStripes(uint64_t *_acc, size_t _stripes, size_t _stripes_in_block, const unsigned char *_input) noexcept
+{
+    if( g_StripesPerBlock - _stripes_in_block <= _stripes ) {
+        const size_t to_end = g_StripesPerBlock - _stripes_in_block;
+        const size_t after_end = _stripes - to_end;
+        AccumulateStripes(_acc, _input, g_Secret + _stripes_in_block * g_SecretConsumeRate, to_end);
+        ScrambleAcc(_acc, g_Secret + g_SecretSize - g_StripeLen);
+        AccumulateStripes(_acc, _input + to_end * g_StripeLen, g_Secret, after_end);
+        return after_end;
+    }
+    AccumulateStripes(_acc, _input, g_Secret + _stripes_in_block * g_SecretConsumeRate, _stripes);
+    return _stripes_in_block + _stripes;
+}
+
+static uint64_t MergeAccs(const uint64_t *_acc, const unsigned char *_secret, uint64_t _start) noexcept
+{
+    uint64_t result = _start;
+    for( size_t i = 0; i < 4; ++i )
+        result +=
+            Mul128Fold64(_acc[2 * i] ^ Read64(_secret + 16 * i), _acc[2 * i + 1] ^ Read64(_secret + 16 * i + 8));
+    return Avalanche(result);
+}
+
+XXH3::XXH3() noexcept
+    : m_Acc{g_Prime32_3, g_Prime64_1, g_Prime64_2, g_Prime64_3, g_Prime64_4, g_Prime32_2, g_Prime64_5, g_Prime32_1}
+{
+}
+
+void XXH3::Update(const void *_data, size_t _size) noexcept
+{
+    constexpr size_t buffer_stripes = BufferSize / g_StripeLen;
+    auto input = static_cast<const unsigned char *>(_data);
+    m_TotalLength += _size;
+
+    if( m_BufferedSize + _size <= BufferSize ) {
+        if( _size != 0 )
+            std::memcpy(m_Buffer + m_BufferedSize, input, _size);
+        m_BufferedSize += _size;
+        return;
+    }
+
+    if( m_BufferedSize > 0 ) {
+        const size_t fill = BufferSize - m_BufferedSize;
+        std::memcpy(m_Buffer + m_BufferedSize, input, fill);
+        input += fill;
+        _size -= fill;
+        m_StripesInBlock = ConsumeStripes(m_Acc, buffer_stripes, m_StripesInBlock, m_Buffer);
+        m_BufferedSize = 0;
+    }
+
+    // the last portion is always kept in the buffer, since the final stripe is processed differently
+    if( _size > BufferSize ) {
+        do {
+            m_StripesInBlock = ConsumeStripes(m_Acc, buffer_stripes, m_StripesInBlock, input);
+            input += BufferSize;
+            _size -= BufferSize;
+        } while( _size > BufferSize );
+        // the digest of a short tail refers to the preceding bytes
+        std::memcpy(m_Buffer + BufferSize - g_StripeLen, input - g_StripeLen, g_StripeLen);
+    }
+
+    std::memcpy(m_Buffer, input, _size);
+    m_BufferedSize = _size;
+}
+
+void XXH3::DigestLong(uint64_t *_acc) const noexcept
+{
+    std::memcpy(_acc, m_Acc, sizeof(m_Acc));
+    if( m_BufferedSize >= g_StripeLen ) {
+        const size_t stripes = (m_BufferedSize - 1) / g_StripeLen;
+        ConsumeStripes(_acc, stripes, m_StripesInBlock, m_Buffer);
+        Accumulate512(_acc,
+                      m_Buffer + m_BufferedSize - g_StripeLen,
+                      g_Secret + g_SecretSize - g_StripeLen - g_SecretLastAccStart);
+    }
+    else {
+        unsigned char last_stripe[g_StripeLen];
+        const size_t catchup = g_StripeLen - m_BufferedSize;
+        std::memcpy(last_stripe, m_Buffer + BufferSize - catchup, catchup);
+        std::memcpy(last_stripe + catchup, m_Buffer, m_BufferedSize);
+        Accumulate512(_acc, last_stripe, g_Secret + g_SecretSize - g_StripeLen - g_SecretLastAccStart);
+    }
+}
+
+uint64_t XXH3::Digest64() const noexcept
+{
+    if( m_TotalLength > g_MidSizeMax ) {
+        alignas(16) uint64_t acc[8];
+        DigestLong(acc);
+        return MergeAccs(acc, g_Secret + g_SecretMergeAccsStart, m_TotalLength * g_Prime64_1);
+    }
+    if( m_TotalLength <= 16 )
+        return Hash64_0To16(m_Buffer, m_BufferedSize);
+    if( m_TotalLength <= 128 )
+        return Hash64_17To128(m_Buffer, m_BufferedSize);
+    return Hash64_129To240(m_Buffer, m_BufferedSize);
+}
+
+XXH3::Hash128 XXH3::Digest128() const noexcept
+{
+    if( m_TotalLength > g_MidSizeMax ) {
+        alignas(16) uint64_t acc[8];
+        DigestLong(acc);
+        const uint64_t low = MergeAccs(acc, g_Secret + g_SecretMergeAccsStart, m_TotalLength * g_Prime64_1);
+        const uint64_t high = MergeAccs(
+            acc, g_Secret + g_SecretSize - sizeof(acc) - g_SecretMergeAccsStart, ~(m_TotalLength * g_Prime64_2));
+        return {low, high};
+    }
+    if( m_TotalLength <= 16 )
+        return Hash128_0To16(m_Buffer, m_BufferedSize);
+    if( m_TotalLength <= 128 )
+        return Hash128_17To128(m_Buffer, m_BufferedSize);
+    return Hash128_129To240(m_Buffer, m_BufferedSize);
+}
+
+} // namespace nc::base::detail
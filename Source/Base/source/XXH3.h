@@ -0,0 +1,36 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nc::base::detail {
+
+// Streaming XXH3 with the default secret and a zero seed, producing the same values as the reference
+// XXH3_64bits()/XXH3_128bits(). Is trivially copyable and has no external resources.
+class XXH3
+{
+public:
+    struct Hash128 {
+        uint64_t low;
+        uint64_t high;
+    };
+
+    XXH3() noexcept;
+    void Update(const void *_data, size_t _size) noexcept;
+    uint64_t Digest64() const noexcept;
+    Hash128 Digest128() const noexcept;
+
+private:
+    static constexpr size_t BufferSize = 256;
+
+    void DigestLong(uint64_t *_acc) const noexcept;
+
+    alignas(16) uint64_t m_Acc[8];
+    alignas(16) unsigned char m_Buffer[BufferSize];
+    size_t m_BufferedSize = 0;
+    size_t m_StripesInBlock = 0;
+    uint64_t m_TotalLength = 0;
+};
+
+} // namespace nc::base::detail
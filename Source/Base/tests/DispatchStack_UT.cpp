@@ -0,0 +1,67 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "DispatchStack.h"
+#include "UnitTests_main.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using nc::base::DispatchGroup;
+using nc::base::DispatchStack;
+
+#define PREFIX "nc::base::DispatchStack "
+
+TEST_CASE(PREFIX "processes the items pushed from within the processing")
+{
+    // a binary tree of depth 10, each node pushes its children
+    std::atomic_int processed{0};
+    const DispatchGroup group;
+    DispatchStack<int> stack(group, 4, [&](int _depth) {
+        ++processed;
+        if( _depth < 10 ) {
+            int children[2] = {_depth + 1, _depth + 1};
+            stack.Push(children);
+        }
+    });
+    stack.Push(0);
+    group.Wait();
+    CHECK(processed == 2047);
+}
+
+TEST_CASE(PREFIX "goes depth-first")
+{
+    std::vector<int> order;
+    std::mutex lock;
+    const DispatchGroup group;
+    DispatchStack<int> stack(group, 1, [&](int _node) {
+        {
+            const auto guard = std::lock_guard{lock};
+            order.emplace_back(_node);
+        }
+        if( _node < 100 ) {
+            int children[2] = {_node * 10 + 2, _node * 10 + 1};
+            stack.Push(children);
+        }
+    });
+    stack.Push(1);
+    group.Wait();
+    CHECK(order == std::vector<int>{1, 11, 111, 112, 12, 121, 122});
+}
+
+TEST_CASE(PREFIX "drops the pending items once stopped")
+{
+    std::atomic_int processed{0};
+    const DispatchGroup group;
+    DispatchStack<int> stack(group, 1, [&](int _node) {
+        ++processed;
+        if( _node == 3 )
+            stack.Stop();
+    });
+    int items[5] = {5, 4, 3, 2, 1};
+    stack.Push(items);
+    group.Wait();
+    CHECK(processed == 3);
+    CHECK(stack.Stopped());
+    stack.Push(6);
+    group.Wait();
+    CHECK(processed == 3);
+}
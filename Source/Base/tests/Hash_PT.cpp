@@ -0,0 +1,78 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "Hash.h"
+#include "UnitTests_main.h"
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <random>
+#include <unistd.h>
+
+// NB! disable by default, include in the BaseUT to enable
+
+#define PREFIX "Hash PT "
+
+using nc::base::Hash;
+
+static const std::pair<Hash::Mode, const char *> g_Modes[] = {
+    {Hash::Adler32, "Adler32"},
+    {Hash::CRC32, "CRC32"},
+    {Hash::CRC32C, "CRC32C"},
+    {Hash::XXH3_64, "XXH3_64"},
+    {Hash::XXH3_128, "XXH3_128"},
+    {Hash::MD5, "MD5"},
+    {Hash::SHA1_160, "SHA1_160"},
+    {Hash::SHA2_256, "SHA2_256"},
+    {Hash::SHA2_512, "SHA2_512"},
+    {Hash::BLAKE3, "BLAKE3"},
+};
+
+// 1GB of pseudo-random bytes.
+static const std::vector<uint64_t> &Input()
+{
+    static const auto input = [] {
+        std::vector<uint64_t> input(1024 * 1024 * 1024 / sizeof(uint64_t));
+        std::mt19937_64 rng(42);
+        for( auto &v : input )
+            v = rng();
+        return input;
+    }();
+    return input;
+}
+
+TEST_CASE(PREFIX "1GB in memory")
+{
+    const auto &input = Input();
+    for( auto [mode, name] : g_Modes ) {
+        BENCHMARK(name)
+        {
+            return Hash(mode).Feed(input.data(), input.size() * sizeof(uint64_t)).Final();
+        };
+    }
+}
+
+TEST_CASE(PREFIX "1GB file")
+{
+    const auto &input = Input();
+    const auto path = std::filesystem::temp_directory_path() / "nc_base_hash_pt.bin";
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char *>(input.data()), input.size() * sizeof(uint64_t));
+    const int fd = open(path.c_str(), O_RDONLY);
+    REQUIRE(fd >= 0);
+    for( auto [mode, name] : g_Modes ) {
+        BENCHMARK(std::string(name) + ", read")
+        {
+            Hash hash(mode);
+            hash.FeedFile(fd, Hash::FileAccess::Read);
+            return hash.Final();
+        };
+        BENCHMARK(std::string(name) + ", map")
+        {
+            Hash hash(mode);
+            hash.FeedFile(fd, Hash::FileAccess::Map);
+            return hash.Final();
+        };
+    }
+    close(fd);
+    std::filesystem::remove(path);
+}
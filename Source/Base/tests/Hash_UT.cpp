@@ -1,6 +1,10 @@
 // Copyright (C) 2014-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Hash.h"
 #include "UnitTests_main.h"
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
 
 using nc::base::Hash;
 
@@ -30,4 +34,69 @@ TEST_CASE(PREFIX "check the hash results")
     CHECK(Hash::Hex(Hash(Hash::MD5).Feed(d.c_str(), d.size()).Final()) == "189b20088062f608cc1c9ce6002e10e0");
     CHECK(Hash::Hex(Hash(Hash::Adler32).Feed(d.c_str(), d.size()).Final()) == "e3d9270a");
     CHECK(Hash::Hex(Hash(Hash::CRC32).Feed(d.c_str(), d.size()).Final()) == "d3ec3da8");
+    CHECK(Hash::Hex(Hash(Hash::XXH3_64).Feed(d.c_str(), d.size()).Final()) == "e0cc28bf0b172384");
+    CHECK(Hash::Hex(Hash(Hash::XXH3_128).Feed(d.c_str(), d.size()).Final()) == "82dfbc1150308404c5300785c5fb371a");
+    CHECK(Hash::Hex(Hash(Hash::CRC32C).Feed(d.c_str(), d.size()).Final()) == "ffe6e1b7");
+    CHECK(Hash::Hex(Hash(Hash::BLAKE3).Feed(d.c_str(), d.size()).Final()) ==
+          "83a5b839969295169b35488e9f7dfbf761d9cfc3c64daf1713f53d5d7aafecc4");
+}
+
+TEST_CASE(PREFIX "fast hashes of an empty input")
+{
+    CHECK(Hash::Hex(Hash(Hash::XXH3_64).Final()) == "2d06800538d394c2");
+    CHECK(Hash::Hex(Hash(Hash::XXH3_128).Final()) == "99aa06d3014798d86001c324468d497f");
+    CHECK(Hash::Hex(Hash(Hash::CRC32C).Final()) == "00000000");
+    CHECK(Hash::Hex(Hash(Hash::BLAKE3).Final()) ==
+          "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262");
+}
+
+static std::vector<uint8_t> MakeLargeInput()
+{
+    std::vector<uint8_t> data(5 * 1024 * 1024 + 123);
+    for( size_t i = 0; i < data.size(); ++i )
+        data[i] = static_cast<uint8_t>(i % 251);
+    return data;
+}
+
+static const std::pair<Hash::Mode, const char *> g_LargeInputHashes[] = {
+    {Hash::XXH3_64, "c092f3b1edde4d7b"},
+    {Hash::XXH3_128, "e1ec13a8be485230c092f3b1edde4d7b"},
+    {Hash::CRC32C, "5cefb3e3"},
+    {Hash::BLAKE3, "a0dc8c48f59eb0ec7cda7bb828c5edc2bde44bb5c57cb58c25e209961cfc9948"},
+};
+
+TEST_CASE(PREFIX "fast hashes don't depend on how the input is split")
+{
+    const auto data = MakeLargeInput();
+    for( auto [mode, expected] : g_LargeInputHashes ) {
+        CHECK(Hash::Hex(Hash(mode).Feed(data.data(), data.size()).Final()) == expected);
+
+        Hash hash(mode);
+        size_t offset = 0;
+        for( size_t step = 1; offset < data.size(); step = step * 3 + 1 ) {
+            const size_t size = std::min(step % (3 * 1024 * 1024), data.size() - offset);
+            hash.Feed(data.data() + offset, size);
+            offset += size;
+        }
+        CHECK(Hash::Hex(hash.Final()) == expected);
+    }
+}
+
+TEST_CASE(PREFIX "feeding files")
+{
+    const auto data = MakeLargeInput();
+    const auto path = std::filesystem::temp_directory_path() / "nc_base_hash_ut.bin";
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char *>(data.data()), data.size());
+    const int fd = open(path.c_str(), O_RDONLY);
+    REQUIRE(fd >= 0);
+    for( auto access : {Hash::FileAccess::Read, Hash::FileAccess::Map} )
+        for( auto [mode, expected] : g_LargeInputHashes ) {
+            Hash hash(mode);
+            REQUIRE(hash.FeedFile(fd, access));
+            CHECK(Hash::Hex(hash.Final()) == expected);
+        }
+    CHECK(Hash(Hash::MD5).FeedFile(fd) == true);
+    close(fd);
+    std::filesystem::remove(path);
+    CHECK(Hash(Hash::MD5).FeedFile(fd) == false);
 }
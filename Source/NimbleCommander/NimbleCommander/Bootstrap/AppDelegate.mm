@@ -83,6 +83,7 @@
 #include <Term/Log.h>
 
 #include <VFS/Log.h>
+#include <VFS/NativeDirectorySizeCache.h>
 
 #include <VFSIcon/Log.h>
 
@@ -101,6 +102,7 @@ static std::optional<std::string> Load(const std::string &_filepath);
 
 static auto g_ConfigDirPostfix = "Config/";
 static auto g_StateDirPostfix = "State/";
+static auto g_DirectorySizeCacheFilename = "DirectorySizes.bin";
 
 static nc::config::ConfigImpl *g_Config = nullptr;
 static nc::config::ConfigImpl *g_State = nullptr;
@@ -237,6 +239,7 @@ static NCAppDelegate *g_Me = nil;
     std::unique_ptr<nc::utility::NativeFSManager> m_NativeFSManager;
     std::shared_ptr<nc::vfs::NativeHost> m_NativeHost;
     std::unique_ptr<nc::utility::FSEventsFileUpdateImpl> m_FSEventsFileUpdate;
+    std::unique_ptr<nc::vfs::native::DirectorySizeCacheObserver> m_DirectorySizeCacheObserver;
     nc::ops::PoolEnqueueFilter m_PoolEnqueueFilter;
     std::unique_ptr<ConfigWiring> m_ConfigWiring;
     std::unique_ptr<nc::SystemThemeDetector> m_SystemThemeDetector;
@@ -264,6 +267,7 @@ static NCAppDelegate *g_Me = nil;
         CheckDefaultsReset();
         m_SupportDirectory = nc::AppDelegate::SupportDirectory();
         [self setupConfigs];
+        [self setupDirectorySizeCache];
         m_SystemThemeDetector = std::make_unique<nc::SystemThemeDetector>();
     }
     return self;
@@ -498,6 +502,32 @@ static NCAppDelegate *g_Me = nil;
     });
 }
 
+- (void)setupDirectorySizeCache
+{
+    auto cache = std::make_shared<nc::vfs::native::DirectorySizeCache>();
+    m_NativeHost->SetDirectorySizeCache(cache);
+
+    // the cache can be large, so it's loaded in background and starts observing the changes once loaded
+    const auto path = m_StateDirectory / g_DirectorySizeCacheFilename;
+    dispatch_to_background([self, cache, path] {
+        cache->Load(path);
+        dispatch_to_main_queue([self, cache] {
+            m_DirectorySizeCacheObserver = std::make_unique<nc::vfs::native::DirectorySizeCacheObserver>(*cache);
+        });
+    });
+
+    // Save the cache upon application shutdown, unless it wasn't loaded yet
+    [NSNotificationCenter.defaultCenter addObserverForName:NSApplicationWillTerminateNotification
+                                                    object:nil
+                                                     queue:nil
+                                                usingBlock:^([[maybe_unused]] NSNotification *_Nonnull note) {
+                                                  if( m_DirectorySizeCacheObserver ) {
+                                                      m_DirectorySizeCacheObserver.reset();
+                                                      cache->Save(path);
+                                                  }
+                                                }];
+}
+
 - (BOOL)applicationShouldTerminateAfterLastWindowClosed:(NSApplication *) [[maybe_unused]] _app
 {
     return NO;
@@ -49,6 +49,7 @@ static constexpr std::pair<const char*,int> g_ActionsTags[] = {
     {"menu.file.find",                                  11'050},
     {"menu.file.find_next",                             11'051},
     {"menu.file.find_with_spotlight",                   11'130},
+    {"menu.file.find_duplicates",                       11'190},
     {"menu.file.page_setup",                            11'060},
     {"menu.file.print",                                 11'070},
     
@@ -147,6 +148,7 @@ static constexpr std::pair<const char*,int> g_ActionsTags[] = {
     {"menu.command.external_editor",                    15'081},
     {"menu.command.eject_volume",                       15'090},
     {"menu.command.batch_rename",                       15'220},
+    {"menu.command.synchronize_directories",            15'250},
     {"menu.command.copy_to",                            15'110},
     {"menu.command.copy_as",                            15'120},
     {"menu.command.move_to",                            15'130},
@@ -257,6 +259,7 @@ static constinit std::pair<const char*, const char8_t*> g_DefaultShortcuts[] = {
     {"menu.file.find",                                      u8"⌘f"      }, // cmd+f
     {"menu.file.find_next",                                 u8"⌘g"      }, // cmd+g
     {"menu.file.find_with_spotlight",                       u8"⌥⌘f"     }, // alt+cmd+f
+    {"menu.file.find_duplicates",                           u8""        },
     {"menu.file.page_setup",                                u8"⇧⌘p"     }, // shift+cmd+p
     {"menu.file.print",                                     u8"⌘p"      }, // cmd+p
 
@@ -353,6 +356,7 @@ static constinit std::pair<const char*, const char8_t*> g_DefaultShortcuts[] = {
     {"menu.command.external_editor",                        u8"\uF707"  }, // F4
     {"menu.command.eject_volume",                           u8"⌘e"      }, // cmd+e
     {"menu.command.batch_rename",                           u8"^m"      }, // ctrl+m
+    {"menu.command.synchronize_directories",                u8""        },
     {"menu.command.copy_to",                                u8"\uF708"  }, // F5
     {"menu.command.copy_as",                                u8"⇧\uF708" }, // shift+F5
     {"menu.command.move_to",                                u8"\uF709"  }, // F6
@@ -9,30 +9,98 @@
 #include <NimbleCommander/Bootstrap/NativeVFSHostInstance.h>
 
 #include <algorithm>
+#include <cstring>
 
-static std::optional<std::vector<uint8_t>> CalculateFileHash(const std::string &_path)
+// files up to g_SampleBlocks * g_SampleBlockSize bytes are hashed entirely during the sampling
+static constexpr uint64_t g_SampleBlocks = 16;
+static constexpr uint64_t g_SampleBlockSize = 64 * 1024;
+static constexpr size_t g_FullHashChunkSize = 1 * 1024 * 1024;
+
+// the checks are postponed if necessary to not read more than this on average
+static constexpr uint64_t g_MaxCheckBytesPerSecond = 128 * 1024 * 1024;
+
+static VFSFilePtr OpenFile(VFSHost &_host, const std::string &_path)
 {
-    const int chunk_sz = 1 * 1024 * 1024;
     VFSFilePtr file;
-    int rc = nc::bootstrap::NativeVFSHostInstance().CreateFile(_path.c_str(), file, nullptr);
-    if( rc != 0 )
-        return std::nullopt;
+    if( _host.CreateFile(_path, file, nullptr) != 0 )
+        return nullptr;
+    if( file->Open(VFSFlags::OF_Read | VFSFlags::OF_ShLock, nullptr) != 0 )
+        return nullptr;
+    return file;
+}
 
-    rc = file->Open(VFSFlags::OF_Read | VFSFlags::OF_ShLock, nullptr);
-    if( rc != 0 )
-        return std::nullopt;
+static bool ReadExactlyAt(VFSFile &_file, uint64_t _offset, void *_buf, size_t _size)
+{
+    auto buf = static_cast<std::byte *>(_buf);
+    while( _size > 0 ) {
+        const ssize_t rn = _file.ReadAt(_offset, buf, _size);
+        if( rn <= 0 )
+            return false;
+        buf += rn;
+        _offset += rn;
+        _size -= rn;
+    }
+    return true;
+}
 
-    auto buf = std::make_unique<uint8_t[]>(chunk_sz);
-    nc::base::Hash h(nc::base::Hash::MD5);
+static std::optional<uint64_t> CalculateSampledHash(VFSFile &_file, uint64_t _size, uint64_t &_bytes_read)
+{
+    nc::base::Hash h(nc::base::Hash::XXH3_64);
+    h.Feed(&_size, sizeof(_size));
+    auto buf = std::make_unique<std::byte[]>(g_SampleBlockSize);
+    if( _size <= g_SampleBlocks * g_SampleBlockSize ) {
+        for( uint64_t offset = 0; offset < _size; offset += g_SampleBlockSize ) {
+            const size_t block = std::min(g_SampleBlockSize, _size - offset);
+            if( !ReadExactlyAt(_file, offset, buf.get(), block) )
+                return std::nullopt;
+            h.Feed(buf.get(), block);
+        }
+        _bytes_read += _size;
+    }
+    else {
+        // the blocks are spread evenly, including the very first and the very last ones
+        for( uint64_t i = 0; i < g_SampleBlocks; ++i ) {
+            const uint64_t offset = (_size - g_SampleBlockSize) * i / (g_SampleBlocks - 1);
+            if( !ReadExactlyAt(_file, offset, buf.get(), g_SampleBlockSize) )
+                return std::nullopt;
+            h.Feed(buf.get(), g_SampleBlockSize);
+        }
+        _bytes_read += g_SampleBlocks * g_SampleBlockSize;
+    }
+    const auto digest = h.Final();
+    uint64_t hash = 0;
+    std::memcpy(&hash, digest.data(), sizeof(hash));
+    return hash;
+}
 
-    ssize_t rn = 0;
-    while( (rn = file->Read(buf.get(), chunk_sz)) > 0 )
+static std::optional<std::vector<uint8_t>> CalculateFullHash(VFSFile &_file, uint64_t &_bytes_read)
+{
+    auto buf = std::make_unique<std::byte[]>(g_FullHashChunkSize);
+    nc::base::Hash h(nc::base::Hash::XXH3_128);
+    for( uint64_t offset = 0;; ) {
+        const ssize_t rn = _file.ReadAt(offset, buf.get(), g_FullHashChunkSize);
+        if( rn < 0 )
+            return std::nullopt;
+        if( rn == 0 )
+            break;
         h.Feed(buf.get(), rn);
+        offset += rn;
+        _bytes_read += rn;
+    }
+    return h.Final();
+}
 
-    if( rn < 0 )
-        return std::nullopt;
+static bool IsSampledEntirely(uint64_t _size) noexcept
+{
+    return _size <= g_SampleBlocks * g_SampleBlockSize;
+}
 
-    return h.Final();
+// Returns how long the next check has to wait for after reading _bytes_read in _spent.
+static std::chrono::nanoseconds ThrottlingDelay(uint64_t _bytes_read, std::chrono::nanoseconds _spent)
+{
+    const auto budget = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(static_cast<double>(_bytes_read) / g_MaxCheckBytesPerSecond));
+    return budget > _spent ? budget - _spent : std::chrono::nanoseconds{0};
 }
 
 TemporaryNativeFileChangesSentinel &TemporaryNativeFileChangesSentinel::Instance()
@@ -46,9 +114,10 @@ bool TemporaryNativeFileChangesSentinel::WatchFile(const std::string &_path,
                                                    std::chrono::milliseconds _check_delay,
                                                    std::chrono::milliseconds _drop_delay)
 {
-    // 1st - read current file and it's MD5 hash
-    auto file_hash = CalculateFileHash(_path);
-    if( !file_hash )
+    // 1st - read current file and its hashes
+    uint64_t bytes_read = 0;
+    auto fingerprint = TakeFingerprint(nc::bootstrap::NativeVFSHostInstance(), _path, bytes_read);
+    if( !fingerprint )
         return false;
 
     auto current = std::make_shared<Meta>();
@@ -62,7 +131,7 @@ bool TemporaryNativeFileChangesSentinel::WatchFile(const std::string &_path,
     current->fswatch_ticket = watch_ticket;
     current->path = _path;
     current->callback = to_shared_ptr(std::move(_on_file_changed));
-    current->last_md5_hash = std::move(*file_hash);
+    current->fingerprint = std::move(*fingerprint);
     current->drop_delay = _drop_delay;
     current->check_delay = _check_delay;
 
@@ -107,23 +176,119 @@ void TemporaryNativeFileChangesSentinel::FSEventCallback(std::shared_ptr<Meta> _
 
     _meta->checking_now = true;
 
-    dispatch_to_background_after(_meta->check_delay, [=, this] { BackgroundItemCheck(_meta); });
+    // all the checks go through the same serial queue, so that many files changing at once are checked one by one
+    m_CheckQueue.after(_meta->check_delay, [=, this] { BackgroundItemCheck(_meta); });
 }
 
 void TemporaryNativeFileChangesSentinel::BackgroundItemCheck(std::shared_ptr<Meta> _meta)
 {
     dispatch_assert_background_queue();
+
+    // the reading is over budget - put this check off without blocking the queue
+    const auto started = nc::base::machtime();
+    if( started < m_ThrottledUntil ) {
+        m_CheckQueue.after(m_ThrottledUntil - started, [=, this] { BackgroundItemCheck(_meta); });
+        return;
+    }
+
     auto clear_flag = at_scope_end([&] { _meta->checking_now = false; });
 
-    auto current_hash = CalculateFileHash(_meta->path);
-    if( !current_hash )
+    uint64_t bytes_read = 0;
+    const auto changed =
+        CheckForChanges(nc::bootstrap::NativeVFSHostInstance(), _meta->path, _meta->fingerprint, bytes_read);
+    const auto finished = nc::base::machtime();
+    m_ThrottledUntil = finished + ThrottlingDelay(bytes_read, finished - started);
+
+    if( !changed )
         return; // this file is not ok - just abort
 
-    if( *current_hash != _meta->last_md5_hash ) {
-        _meta->last_md5_hash = std::move(*current_hash);
+    if( *changed ) {
         ScheduleItemDrop(_meta);
 
         auto client_callback = _meta->callback;
         dispatch_to_main_queue([=] { (*client_callback)(); });
     }
 }
+
+bool TemporaryNativeFileChangesSentinel::Fingerprint::HasSameMetadata(const Fingerprint &_other) const noexcept
+{
+    return size == _other.size && inode == _other.inode && dev == _other.dev && mtime.tv_sec == _other.mtime.tv_sec &&
+           mtime.tv_nsec == _other.mtime.tv_nsec;
+}
+
+std::optional<TemporaryNativeFileChangesSentinel::Fingerprint>
+TemporaryNativeFileChangesSentinel::StatFile(VFSHost &_host, const std::string &_path)
+{
+    VFSStat st;
+    if( _host.Stat(_path, st, 0, nullptr) != 0 )
+        return std::nullopt;
+
+    Fingerprint fingerprint;
+    fingerprint.size = st.size;
+    fingerprint.inode = st.inode;
+    fingerprint.dev = st.dev;
+    fingerprint.mtime = st.mtime;
+    return fingerprint;
+}
+
+std::optional<TemporaryNativeFileChangesSentinel::Fingerprint>
+TemporaryNativeFileChangesSentinel::TakeFingerprint(VFSHost &_host, const std::string &_path, uint64_t &_bytes_read)
+{
+    auto fingerprint = StatFile(_host, _path);
+    if( !fingerprint )
+        return std::nullopt;
+
+    const auto file = OpenFile(_host, _path);
+    if( !file )
+        return std::nullopt;
+
+    const auto sampled_hash = CalculateSampledHash(*file, fingerprint->size, _bytes_read);
+    if( !sampled_hash )
+        return std::nullopt;
+    fingerprint->sampled_hash = *sampled_hash;
+
+    if( !IsSampledEntirely(fingerprint->size) ) {
+        fingerprint->full_hash = CalculateFullHash(*file, _bytes_read);
+        if( !fingerprint->full_hash )
+            return std::nullopt;
+    }
+    return fingerprint;
+}
+
+std::optional<bool> TemporaryNativeFileChangesSentinel::CheckForChanges(VFSHost &_host,
+                                                                        const std::string &_path,
+                                                                        Fingerprint &_fingerprint,
+                                                                        uint64_t &_bytes_read)
+{
+    auto current = StatFile(_host, _path);
+    if( !current )
+        return std::nullopt;
+
+    // the events are reported for the whole directory, so usually nothing has happened with this very file
+    if( current->HasSameMetadata(_fingerprint) )
+        return false;
+
+    const auto file = OpenFile(_host, _path);
+    if( !file )
+        return std::nullopt;
+
+    // the sampled hash is taken regardless of the size to serve as a baseline for the future checks
+    const auto sampled_hash = CalculateSampledHash(*file, current->size, _bytes_read);
+    if( !sampled_hash )
+        return std::nullopt;
+    current->sampled_hash = *sampled_hash;
+
+    bool changed = current->size != _fingerprint.size || current->sampled_hash != _fingerprint.sampled_hash;
+    if( !IsSampledEntirely(current->size) ) {
+        // the full hash is taken even when the samples already tell the versions apart, otherwise the next check of
+        // this version would have nothing to compare the contents with
+        current->full_hash = CalculateFullHash(*file, _bytes_read);
+        if( !current->full_hash )
+            return std::nullopt;
+        if( !changed )
+            changed = current->full_hash != _fingerprint.full_hash;
+    }
+
+    _fingerprint = std::move(*current);
+    return changed;
+}
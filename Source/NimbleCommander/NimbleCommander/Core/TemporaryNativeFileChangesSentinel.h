@@ -1,17 +1,48 @@
-// Copyright (C) 2016-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2016-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include <Base/spinlock.h>
+#include <Base/dispatch_cpp.h>
+#include <VFS/VFSDeclarations.h>
+#include <optional>
 #include <string>
 #include <functional>
 #include <memory>
 #include <atomic>
 #include <chrono>
+#include <ctime>
 #include <vector>
 
+/**
+ * Watches the files opened from temporary storage and reports the changes of their contents.
+ * The checks of all watched files are performed one at a time on a single background queue, with the amount of data
+ * read per second being limited. Each check is tiered to avoid reading large files whenever possible:
+ * 1. the size, modification time, inode and device are compared, if they are the same the file is considered intact;
+ * 2. a hash of the sampled blocks of the file is calculated, the file has changed if either it or the size differs;
+ * 3. the whole file is hashed only when the sampled blocks alone can't prove that the contents are the same.
+ * The throttling doesn't block the queue - once a check has read too much, the next ones are postponed instead.
+ */
 class TemporaryNativeFileChangesSentinel
 {
 public:
+    /**
+     * The state of a file at some moment, which the later versions of it are compared with.
+     */
+    struct Fingerprint {
+        uint64_t size = 0;
+        uint64_t inode = 0;
+        int32_t dev = 0;
+        timespec mtime = {0, 0};
+
+        // a hash of the sampled blocks, covers the whole file if it's small enough
+        uint64_t sampled_hash = 0;
+
+        // a hash of the whole contents, missing if the file is small enough to be covered by the sampled hash
+        std::optional<std::vector<uint8_t>> full_hash;
+
+        bool HasSameMetadata(const Fingerprint &_other) const noexcept;
+    };
+
     static TemporaryNativeFileChangesSentinel &Instance();
 
     /**
@@ -34,12 +65,25 @@ public:
      */
     bool StopFileWatch(const std::string &_path);
 
+    /**
+     * Reads the file at _path to take its fingerprint. The amount of data read is added to _bytes_read.
+     */
+    static std::optional<Fingerprint> TakeFingerprint(VFSHost &_host, const std::string &_path, uint64_t &_bytes_read);
+
+    /**
+     * Performs the tiered check of the file at _path against _fingerprint, which is then updated to describe the
+     * current version of the file. Returns whether the contents have changed or nullopt if the file can't be read.
+     * The amount of data read is added to _bytes_read.
+     */
+    static std::optional<bool>
+    CheckForChanges(VFSHost &_host, const std::string &_path, Fingerprint &_fingerprint, uint64_t &_bytes_read);
+
 private:
     struct Meta {
         std::string path;
         std::shared_ptr<std::function<void()>> callback;
         uint64_t fswatch_ticket = 0;
-        std::vector<uint8_t> last_md5_hash;
+        Fingerprint fingerprint;
         std::chrono::milliseconds drop_time;
         std::chrono::milliseconds check_delay;
         std::chrono::milliseconds drop_delay;
@@ -49,7 +93,10 @@ private:
     void FSEventCallback(std::shared_ptr<Meta> _meta);
     void BackgroundItemCheck(std::shared_ptr<Meta> _meta);
     void ScheduleItemDrop(const std::shared_ptr<Meta> &_meta);
+    static std::optional<Fingerprint> StatFile(VFSHost &_host, const std::string &_path);
 
     nc::spinlock m_WatchesLock;
     std::vector<std::shared_ptr<Meta>> m_Watches;
+    dispatch_queue m_CheckQueue{"com.magnumbytes.nimblecommander.temporary_file_changes_sentinel"};
+    std::chrono::nanoseconds m_ThrottledUntil{0}; // accessed only from m_CheckQueue
 };
@@ -0,0 +1,16 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "DefaultAction.h"
+
+@class PanelController;
+
+namespace nc::panel::actions {
+
+// Searches for the files with the same contents among the selected items and shows the found ones in the panel.
+struct FindDuplicates final : PanelAction {
+    bool Predicate(PanelController *_target) const override;
+    void Perform(PanelController *_target, id _sender) const override;
+};
+
+} // namespace nc::panel::actions
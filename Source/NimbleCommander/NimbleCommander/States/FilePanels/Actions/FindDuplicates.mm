@@ -0,0 +1,43 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "FindDuplicates.h"
+#include "../PanelController.h"
+#include "../PanelView.h"
+#include "../../MainWindowController.h"
+#include <Panel/PanelData.h>
+#include <Operations/DuplicatesSearch.h>
+#include <Base/dispatch_cpp.h>
+
+namespace nc::panel::actions {
+
+bool FindDuplicates::Predicate(PanelController *_target) const
+{
+    const auto i = _target.view.item;
+    if( !i )
+        return false;
+    return !i.IsDotDot() || _target.data.Stats().selected_entries_amount > 0;
+}
+
+void FindDuplicates::Perform(PanelController *_target, id) const
+{
+    auto entries = _target.selectedEntriesOrFocusedEntry;
+    if( entries.empty() )
+        return;
+
+    const auto op = std::make_shared<nc::ops::DuplicatesSearch>(std::move(entries));
+    const auto weak_op = std::weak_ptr<nc::ops::DuplicatesSearch>{op};
+    __weak PanelController *weak_target = _target;
+    op->ObserveUnticketed(nc::ops::Operation::NotifyAboutCompletion, [weak_target, weak_op] {
+        const auto search = weak_op.lock();
+        if( !search )
+            return;
+        const auto listing = search->ComposeListing();
+        dispatch_to_main_queue([weak_target, listing] {
+            if( PanelController *const panel = weak_target )
+                [panel loadListing:listing];
+        });
+    });
+
+    [_target.mainWindowController enqueueOperation:op];
+}
+
+} // namespace nc::panel::actions
@@ -0,0 +1,16 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "DefaultAction.h"
+
+namespace nc::panel::actions {
+
+// Compares the directory of the active panel with the directory of the opposite one. The differing items are shown in
+// the active panel as a temporary listing which grows while the trees are being compared. Afterwards the user is
+// offered to bring the opposite directory in line with the active one.
+struct SynchronizeDirectories final : StateAction {
+    bool Predicate(MainWindowFilePanelState *_target) const override;
+    void Perform(MainWindowFilePanelState *_target, id _sender) const override;
+};
+
+} // namespace nc::panel::actions
@@ -0,0 +1,169 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "SynchronizeDirectories.h"
+#include "../MainWindowFilePanelState.h"
+#include "../PanelController.h"
+#include "../PanelAux.h"
+#include <Operations/Copying.h>
+#include <Operations/Deletion.h>
+#include <Operations/Pool.h>
+#include <Operations/Synchronization.h>
+#include <NimbleCommander/Core/Alert.h>
+#include <NimbleCommander/States/MainWindowController.h>
+#include <VFS/VFSListingInput.h>
+#include <Base/dispatch_cpp.h>
+#include <Utility/StringExtras.h>
+#include <ankerl/unordered_dense.h>
+#include <chrono>
+#include <mutex>
+
+namespace nc::panel::actions {
+
+using ops::synchronization::DiffEntry;
+using ops::synchronization::TreeDiff;
+
+// how often the panel is updated with the differences found so far
+static constexpr std::chrono::milliseconds g_ListingUpdatePeriod{500};
+
+// The differing items as a temporary listing: the source ones for the New and Changed entries and the destination ones
+// for the Deleted entries.
+static VFSListingPtr BuildDifferencesListing(std::span<const DiffEntry> _entries, const std::string &_title)
+{
+    std::vector<VFSListingPtr> listings;
+    std::vector<std::vector<unsigned>> indices;
+    ankerl::unordered_dense::map<const VFSListing *, size_t> positions;
+    for( const auto &entry : _entries ) {
+        const VFSListingItem &item = entry.source ? entry.source : entry.destination;
+        const auto [it, inserted] = positions.emplace(item.Listing().get(), listings.size());
+        if( inserted ) {
+            listings.emplace_back(item.Listing());
+            indices.emplace_back();
+        }
+        indices[it->second].emplace_back(item.Index());
+    }
+    auto input = VFSListing::Compose(listings, indices);
+    input.title = _title;
+    return VFSListing::Build(std::move(input));
+}
+
+static void AskAboutSynchronization(size_t _differences,
+                                    const std::string &_destination_path,
+                                    NSWindow *_window,
+                                    std::function<void(NSModalResponse)> _handler)
+{
+    Alert *const dialog = [[Alert alloc] init];
+    [dialog addButtonWithTitle:NSLocalizedString(@"Synchronize", "User action to synchronize directories")];
+    [dialog addButtonWithTitle:NSLocalizedString(@"Synchronize and Delete Extra Items",
+                                                 "User action to synchronize directories and delete the items "
+                                                 "which exist only in the destination")];
+    [dialog addButtonWithTitle:NSLocalizedString(@"Cancel", "")];
+    auto fmt = NSLocalizedString(@"Found %@ differences. Do you want to update \u201c%@\u201d?",
+                                 "Asking user to synchronize the directories after comparing them");
+    dialog.messageText = [NSString localizedStringWithFormat:fmt,
+                                                             [NSNumber numberWithUnsignedLong:_differences],
+                                                             [NSString stringWithUTF8StdString:_destination_path]];
+    [dialog beginSheetModalForWindow:_window
+                   completionHandler:^(NSModalResponse result) {
+                     _handler(result);
+                   }];
+}
+
+static void Synchronize(MainWindowFilePanelState *_target,
+                        std::span<const DiffEntry> _entries,
+                        const std::string &_source_path,
+                        const std::string &_destination_path,
+                        const VFSHostPtr &_destination_host,
+                        bool _delete_extraneous)
+{
+    ops::SynchronizationOptions options;
+    options.delete_extraneous = _delete_extraneous;
+    options.copying = MakeDefaultFileCopyOptions();
+    auto plan = ops::MakeSynchronizationPlan(_entries, _source_path, _destination_path, _destination_host, options);
+
+    __weak PanelController *const opposite = _target.oppositePanelController;
+    const auto refresh = [opposite] { dispatch_to_main_queue([opposite] { [opposite refreshPanel]; }); };
+    if( plan.deletion )
+        plan.deletion->ObserveUnticketed(ops::Operation::NotifyAboutFinish, refresh);
+    if( plan.copying )
+        plan.copying->ObserveUnticketed(ops::Operation::NotifyAboutFinish, refresh);
+    ops::EnqueueSynchronization(_target.mainWindowController.operationsPool, std::move(plan));
+}
+
+bool SynchronizeDirectories::Predicate(MainWindowFilePanelState *_target) const
+{
+    const auto act_pc = _target.activePanelController;
+    const auto opp_pc = _target.oppositePanelController;
+    return act_pc && opp_pc && act_pc.isUniform && opp_pc.isUniform && opp_pc.vfs->IsWritable();
+}
+
+void SynchronizeDirectories::Perform(MainWindowFilePanelState *_target, id) const
+{
+    PanelController *const act_pc = _target.activePanelController;
+    PanelController *const opp_pc = _target.oppositePanelController;
+    if( !Predicate(_target) )
+        return;
+
+    const VFSHostPtr source_host = act_pc.vfs;
+    const std::string source_path = act_pc.currentDirectoryPath;
+    const VFSHostPtr destination_host = opp_pc.vfs;
+    const std::string destination_path = opp_pc.currentDirectoryPath;
+    const std::string title = NSLocalizedString(@"Differences", "Title of a listing with the differing items")
+                                  .UTF8String;
+
+    __weak MainWindowFilePanelState *const weak_state = _target;
+    __weak PanelController *const weak_panel = act_pc;
+    auto task = [=](const std::function<bool()> &_is_cancelled) {
+        // the comparison runs in background and the differences are pushed into the panel while it goes
+        const auto show = [=](VFSListingPtr _listing) {
+            dispatch_to_main_queue([=] {
+                PanelController *const panel = weak_panel;
+                if( panel && !_is_cancelled() )
+                    [panel loadListing:_listing];
+            });
+        };
+
+        std::mutex lock;
+        std::vector<DiffEntry> entries;
+        auto last_update = std::chrono::steady_clock::now();
+        const auto on_entry = [&](DiffEntry _entry) {
+            std::vector<DiffEntry> snapshot;
+            {
+                const auto guard = std::lock_guard{lock};
+                entries.emplace_back(std::move(_entry));
+                const auto now = std::chrono::steady_clock::now();
+                if( now - last_update < g_ListingUpdatePeriod )
+                    return;
+                last_update = now;
+                snapshot = entries;
+            }
+            show(BuildDifferencesListing(snapshot, title));
+        };
+
+        const TreeDiff diff(source_host, source_path, destination_host, destination_path);
+        const int rc = diff.Run(on_entry, {}, _is_cancelled);
+        if( rc != VFSError::Ok || _is_cancelled() || entries.empty() )
+            return;
+        show(BuildDifferencesListing(entries, title));
+
+        auto shared_entries = std::make_shared<const std::vector<DiffEntry>>(std::move(entries));
+        dispatch_to_main_queue([=] {
+            MainWindowFilePanelState *const state = weak_state;
+            if( !state || !weak_panel || _is_cancelled() )
+                return;
+            AskAboutSynchronization(
+                shared_entries->size(), destination_path, state.window, [=](NSModalResponse _response) {
+                    if( _response != NSAlertFirstButtonReturn && _response != NSAlertSecondButtonReturn )
+                        return;
+                    if( MainWindowFilePanelState *const state = weak_state )
+                        Synchronize(state,
+                                    *shared_entries,
+                                    source_path,
+                                    destination_path,
+                                    destination_host,
+                                    _response == NSAlertSecondButtonReturn);
+                });
+        });
+    };
+    [act_pc commitCancelableLoadingTask:std::move(task)];
+}
+
+} // namespace nc::panel::actions
@@ -486,7 +486,11 @@ private:
 
     m_FileSearch->SetFilterSize(self.searchFilterSizeFromUI);
 
-    auto found_callback = [=](const char *_filename, const char *_in_path, VFSHost &_in_host, CFRange _cont_pos) {
+    auto found_callback = [=](const char *_filename,
+                              const char *_in_path,
+                              VFSHost &_in_host,
+                              CFRange _cont_pos,
+                              std::span<const CFRange>) {
         FindFilesSheetControllerFoundItem it;
         it.host = _in_host.SharedPtr();
         it.filename = _filename;
@@ -26,6 +26,7 @@ namespace nc::panel {
 static const auto g_ConfigArchivesExtensionsWhiteList = "filePanel.general.archivesExtensionsWhitelist";
 static const auto g_ConfigExecutableExtensionsWhitelist = "filePanel.general.executableExtensionsWhitelist";
 static const auto g_ConfigDefaultVerificationSetting = "filePanel.operations.defaultChecksumVerification";
+static const auto g_ConfigOverwriteChangedBlocksOnly = "filePanel.operations.overwriteChangedBlocksOnly";
 static const auto g_CheckDelay = "filePanel.operations.vfsShadowUploadChangesCheckDelay";
 static const auto g_DropDelay = "filePanel.operations.vfsShadowUploadObservationDropDelay";
 static const auto g_QLPanel = "filePanel.presentation.showQuickLookAsFloatingPanel";
@@ -314,6 +315,7 @@ ops::CopyingOptions MakeDefaultFileCopyOptions()
     ops::CopyingOptions options;
     options.docopy = true;
     options.verification = DefaultChecksumVerificationSetting();
+    options.overwrite_changed_blocks_only = GlobalConfig().GetBool(g_ConfigOverwriteChangedBlocksOnly);
 
     return options;
 }
@@ -323,6 +325,7 @@ ops::CopyingOptions MakeDefaultFileMoveOptions()
     ops::CopyingOptions options;
     options.docopy = false;
     options.verification = DefaultChecksumVerificationSetting();
+    options.overwrite_changed_blocks_only = GlobalConfig().GetBool(g_ConfigOverwriteChangedBlocksOnly);
 
     return options;
 }
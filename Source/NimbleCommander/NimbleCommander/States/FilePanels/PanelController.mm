@@ -15,6 +15,7 @@
 #include "PanelDataOptionsPersistence.h"
 #include <Base/CommonPaths.h>
 #include <VFS/Native.h>
+#include <VFS/DirectorySizeCalculator.h>
 #include "PanelHistory.h"
 #include <Base/SerialQueue.h>
 #include <Panel/PanelData.h>
@@ -36,6 +37,7 @@
 #include <Utility/StringExtras.h>
 #include <Utility/PathManip.h>
 #include <Base/mach_time.h>
+#include <Base/spinlock.h>
 
 #include <algorithm>
 
@@ -44,7 +46,7 @@ using namespace nc::core;
 using namespace nc::panel;
 using namespace std::literals;
 
-static constexpr size_t g_MaxSizeCalculationCommitBatches = 40;
+static constexpr std::chrono::nanoseconds g_SizeCalculationCommitPeriod = std::chrono::milliseconds{100};
 static constexpr std::chrono::nanoseconds g_FilesystemHintTriggerDelay = std::chrono::milliseconds{500}; // 0.5s
 
 static const auto g_ConfigShowDotDotEntry = "filePanel.general.showDotDotEntry";
@@ -492,73 +494,94 @@ static void HeatUpConfigValues()
     dispatch_assert_background_queue();
     assert(!_items.empty());
 
-    // divide all items into maximum of g_MaxSizeCalculationCommitBatches batches as equally as
-    // possible
-    const size_t items_count = _items.size();
-    const size_t batches = std::min(g_MaxSizeCalculationCommitBatches, items_count);
-    const size_t items_per_batch = items_count / batches;
-    const size_t items_leftover = items_count - items_per_batch * batches;
-
-    for( size_t batch = 0, items_first = 0, items_last = 0; batch != batches; ++batch ) {
-        items_first = items_last;
-        items_last += items_per_batch + (batch < items_leftover ? 1 : 0);
+    std::vector<VFSListingItem> items;
+    std::vector<vfs::DirectorySizeCalculator::Directory> directories;
+    for( auto &i : _items ) {
+        if( !i.IsDir() )
+            continue;
+        items.emplace_back(i);
+        directories.push_back({i.Host(), !i.IsDotDot() ? i.Path() : i.Directory()});
+    }
+    if( directories.empty() )
+        return;
 
+    // the sizes are streamed to the panel as the directories are finished, but not more often than once per
+    // g_SizeCalculationCommitPeriod to avoid flooding the main queue when there are many small directories.
+    // the sizes held back are flushed by a timer, so each of them shows up within that period.
+    struct Pending {
+        spinlock lock;
         panel::CalculatedSizesBatch calculated;
-        calculated.items.reserve(items_last - items_first);
-        calculated.sizes.reserve(items_last - items_first);
-
-        for( size_t item_index = items_first; item_index != items_last; ++item_index ) {
-            if( m_DirectorySizeCountingQ.IsStopped() )
-                return;
-
-            auto &i = _items[item_index];
-            if( !i.IsDir() )
-                continue;
-
-            const auto result =
-                i.Host()->CalculateDirectorySize(!i.IsDotDot() ? i.Path().c_str() : i.Directory().c_str(),
-                                                 [=] { return m_DirectorySizeCountingQ.IsStopped(); });
-
-            if( result < 0 )
-                continue; // silently skip items that caused erros while calculating size
-
-            calculated.items.emplace_back(i);
-            calculated.sizes.emplace_back(static_cast<uint64_t>(result));
+        std::chrono::nanoseconds last_commit = base::machtime();
+        bool flush_scheduled = false;
+    };
+    const auto pending = std::make_shared<Pending>();
+    const auto commit = [self, pending] { // to be called with pending->lock held
+        if( pending->calculated.items.empty() )
+            return;
+        dispatch_to_main_queue(
+            [self, calculated = std::move(pending->calculated)] { [self commitCalculatedSizes:calculated]; });
+        pending->calculated = {};
+        pending->last_commit = base::machtime();
+    };
+
+    const auto on_calculated = [&](size_t _index, ssize_t _size) {
+        if( _size < 0 )
+            return; // silently skip items that caused erros while calculating size
+        const auto guard = std::lock_guard{pending->lock};
+        pending->calculated.items.emplace_back(items[_index]);
+        pending->calculated.sizes.emplace_back(static_cast<uint64_t>(_size));
+        const auto since_commit = base::machtime() - pending->last_commit;
+        if( since_commit >= g_SizeCalculationCommitPeriod ) {
+            commit();
         }
+        else if( !pending->flush_scheduled ) {
+            pending->flush_scheduled = true;
+            dispatch_to_background_after(g_SizeCalculationCommitPeriod - since_commit, [=] {
+                const auto guard = std::lock_guard{pending->lock};
+                pending->flush_scheduled = false;
+                if( !m_DirectorySizeCountingQ.IsStopped() )
+                    commit();
+            });
+        }
+    };
+    vfs::DirectorySizeCalculator{}.Calculate(
+        directories, on_calculated, [=] { return m_DirectorySizeCountingQ.IsStopped(); });
 
-        if( calculated.items.empty() )
-            continue;
+    if( !m_DirectorySizeCountingQ.IsStopped() ) {
+        const auto guard = std::lock_guard{pending->lock};
+        commit();
+    }
+}
 
-        auto commit_batch = [=, calculated = std::move(calculated)] {
-            assert(!calculated.items.empty());
+- (void)commitCalculatedSizes:(const panel::CalculatedSizesBatch &)_calculated
+{
+    dispatch_assert_main_queue();
+    assert(!_calculated.items.empty());
 
-            // may cause re-sorting if current sorting is by size so save the cursor
-            const auto pers = CursorBackup{m_View.curpos, m_Data};
+    // may cause re-sorting if current sorting is by size so save the cursor
+    const auto pers = CursorBackup{m_View.curpos, m_Data};
 
-            size_t num_set = 0;
-            if( &m_Data.Listing() == calculated.items.front().Listing().get() ) {
-                // the listing is the same, can use indices directly
-                std::vector<unsigned> raw_indices(calculated.items.size());
-                std::ranges::transform(calculated.items, raw_indices.begin(), [](auto &i) { return i.Index(); });
-                num_set = m_Data.SetCalculatedSizesForDirectories(raw_indices, calculated.sizes);
-            }
-            else {
-                // the listing has changed, need to use indirects: filename and directory
-                std::vector<std::string_view> filenames(calculated.items.size());
-                std::vector<std::string_view> directories(calculated.items.size());
-                std::ranges::transform(
-                    calculated.items, filenames.begin(), [](auto &i) { return std::string_view{i.Filename()}; });
-                std::ranges::transform(
-                    calculated.items, directories.begin(), [](auto &i) { return std::string_view{i.Directory()}; });
-                num_set = m_Data.SetCalculatedSizesForDirectories(filenames, directories, calculated.sizes);
-            }
-            if( num_set != 0 ) {
-                [m_View dataUpdated];
-                [m_View volatileDataChanged];
-                m_View.curpos = pers.RestoredCursorPosition();
-            }
-        };
-        dispatch_to_main_queue(std::move(commit_batch));
+    size_t num_set = 0;
+    if( &m_Data.Listing() == _calculated.items.front().Listing().get() ) {
+        // the listing is the same, can use indices directly
+        std::vector<unsigned> raw_indices(_calculated.items.size());
+        std::ranges::transform(_calculated.items, raw_indices.begin(), [](auto &i) { return i.Index(); });
+        num_set = m_Data.SetCalculatedSizesForDirectories(raw_indices, _calculated.sizes);
+    }
+    else {
+        // the listing has changed, need to use indirects: filename and directory
+        std::vector<std::string_view> filenames(_calculated.items.size());
+        std::vector<std::string_view> directories(_calculated.items.size());
+        std::ranges::transform(
+            _calculated.items, filenames.begin(), [](auto &i) { return std::string_view{i.Filename()}; });
+        std::ranges::transform(
+            _calculated.items, directories.begin(), [](auto &i) { return std::string_view{i.Directory()}; });
+        num_set = m_Data.SetCalculatedSizesForDirectories(filenames, directories, _calculated.sizes);
+    }
+    if( num_set != 0 ) {
+        [m_View dataUpdated];
+        [m_View volatileDataChanged];
+        m_View.curpos = pers.RestoredCursorPosition();
     }
 }
 
@@ -12,6 +12,7 @@
 #include "Actions/OpenWithExternalEditor.h"
 #include "Actions/ToggleSort.h"
 #include "Actions/FindFiles.h"
+#include "Actions/FindDuplicates.h"
 #include "Actions/ShowGoToPopup.h"
 #include "Actions/MakeNew.h"
 #include "Actions/CalculateSizes.h"
@@ -58,6 +59,7 @@ PanelActionsMap BuildPanelActionsMap(nc::config::Config &_global_config,
     add(@selector(onAlwaysOpenFileWith:), new AlwaysOpenFileWithSubmenu{_open_with_menu_delegate});
     add(@selector(onMainMenuPerformFindAction:), new FindFiles{_make_viewer, _make_viewer_controller});
     add(@selector(OnSpotlightSearch:), new SpotlightSearch);
+    add(@selector(OnFindDuplicates:), new FindDuplicates);
     add(@selector(OnDuplicate:), new Duplicate{_global_config});
     add(@selector(OnAddToFavorites:), new AddToFavorites);
     add(@selector(OnCalculateSizes:), new CalculateSizes);
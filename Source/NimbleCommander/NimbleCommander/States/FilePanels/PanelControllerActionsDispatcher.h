@@ -76,6 +76,7 @@ using PanelActionsMap = ankerl::unordered_dense::map<SEL, std::unique_ptr<const
 - (IBAction)OnOpenExtendedAttributes:(id)sender;
 - (IBAction)OnAddToFavorites:(id)sender;
 - (IBAction)OnSpotlightSearch:(id)sender;
+- (IBAction)OnFindDuplicates:(id)sender;
 - (IBAction)OnEjectVolume:(id)sender;
 - (IBAction)OnCopyCurrentFileName:(id)sender;
 - (IBAction)OnCopyCurrentFilePath:(id)sender;
@@ -8,6 +8,7 @@
 #include "Actions/RevealInOppositePanel.h"
 #include "Actions/ShowTerminal.h"
 #include "Actions/SyncPanels.h"
+#include "Actions/SynchronizeDirectories.h"
 #include "Actions/ExecuteExternalTool.h"
 #include "Actions/ChangePanelsPosition.h"
 #include "Actions/FocusOverlappedTerminal.h"
@@ -40,6 +41,7 @@ StateActionsMap BuildStateActionsMap(nc::config::Config &_global_config,
     add(@selector(OnShowTerminal:), new ShowTerminal);
     add(@selector(OnSyncPanels:), new SyncPanels);
     add(@selector(OnSwapPanels:), new SwapPanels);
+    add(@selector(OnSynchronizeDirectories:), new SynchronizeDirectories);
     add(@selector(OnFileCopyCommand:), new CopyTo{_global_config});
     add(@selector(OnFileCopyAsCommand:), new CopyAs{_global_config});
     add(@selector(OnFileRenameMoveCommand:), new MoveTo);
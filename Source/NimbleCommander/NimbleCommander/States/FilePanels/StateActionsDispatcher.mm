@@ -183,6 +183,10 @@ static void Perform(SEL _sel, const StateActionsMap &_map, MainWindowFilePanelSt
 {
     PERFORM;
 }
+- (IBAction)OnSynchronizeDirectories:(id)sender
+{
+    PERFORM;
+}
 - (IBAction)OnShowTerminal:(id)sender
 {
     PERFORM;
@@ -0,0 +1,97 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include <NimbleCommander/Core/TemporaryNativeFileChangesSentinel.h>
+#include <Utility/FSEventsFileUpdateImpl.h>
+#include <Utility/NativeFSManagerImpl.h>
+#include <VFS/Native.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using Sentinel = TemporaryNativeFileChangesSentinel;
+
+#define PREFIX "TemporaryNativeFileChangesSentinel "
+
+// larger than the sampled blocks together, the 2nd sampled block starts at ~268Kb
+static constexpr size_t g_Size = 4 * 1024 * 1024;
+static constexpr uint64_t g_SamplesSize = 16 * 64 * 1024;
+
+static void Write(const std::filesystem::path &_path, size_t _offset, std::string_view _bytes, time_t _mtime)
+{
+    const int fd = open(_path.c_str(), O_WRONLY | O_CREAT, 0600);
+    REQUIRE(fd >= 0);
+    REQUIRE(pwrite(fd, _bytes.data(), _bytes.size(), _offset) == static_cast<ssize_t>(_bytes.size()));
+    // the modification time is set explicitly to not depend on the timestamps' granularity
+    const timespec times[2] = {{0, UTIME_OMIT}, {_mtime, 0}};
+    REQUIRE(futimens(fd, times) == 0);
+    close(fd);
+}
+
+namespace {
+struct Context {
+    Context()
+    {
+        path = dir.directory / "file";
+        Write(path, 0, std::string(g_Size, 'a'), 1'000'000'000);
+        uint64_t read = 0;
+        auto taken = Sentinel::TakeFingerprint(host, path, read);
+        REQUIRE(taken);
+        REQUIRE(taken->full_hash);
+        fingerprint = std::move(*taken);
+    }
+    std::optional<bool> Check()
+    {
+        bytes_read = 0;
+        return Sentinel::CheckForChanges(host, path, fingerprint, bytes_read);
+    }
+    TempTestDir dir;
+    nc::utility::FSEventsFileUpdateImpl fsevents_file_update;
+    nc::utility::NativeFSManagerImpl native_fs_man;
+    nc::vfs::NativeHost host{native_fs_man, fsevents_file_update};
+    std::filesystem::path path;
+    Sentinel::Fingerprint fingerprint;
+    uint64_t bytes_read = 0;
+};
+} // namespace
+
+TEST_CASE(PREFIX "Intact metadata means no reading")
+{
+    Context ctx;
+    CHECK(ctx.Check() == false);
+    CHECK(ctx.bytes_read == 0);
+}
+
+TEST_CASE(PREFIX "Touched file is read entirely to prove it's intact")
+{
+    Context ctx;
+    Write(ctx.path, 0, "a", 1'000'000'001);
+    CHECK(ctx.Check() == false);
+    CHECK(ctx.bytes_read == g_SamplesSize + g_Size);
+}
+
+TEST_CASE(PREFIX "Change in a sampled block is detected by the samples")
+{
+    Context ctx;
+    Write(ctx.path, 0, "b", 1'000'000'001);
+    CHECK(ctx.Check() == true);
+    // the new version is hashed entirely as well, so that the next check can compare the contents with it
+    REQUIRE(ctx.fingerprint.full_hash);
+
+    Write(ctx.path, 0, "b", 1'000'000'002);
+    CHECK(ctx.Check() == false);
+}
+
+TEST_CASE(PREFIX "Change between the sampled blocks is detected by the full hash")
+{
+    Context ctx;
+    Write(ctx.path, 100'000, "b", 1'000'000'001);
+    CHECK(ctx.Check() == true);
+    CHECK(ctx.bytes_read == g_SamplesSize + g_Size);
+}
+
+TEST_CASE(PREFIX "Resized file is detected by the samples")
+{
+    Context ctx;
+    Write(ctx.path, g_Size, "b", 1'000'000'000);
+    CHECK(ctx.Check() == true);
+}
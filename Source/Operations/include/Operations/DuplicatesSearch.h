@@ -0,0 +1 @@
+#include "../../source/DuplicatesSearch/DuplicatesSearch.h"
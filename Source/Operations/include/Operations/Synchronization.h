@@ -0,0 +1 @@
+#include "../../source/Synchronization/Synchronization.h"
@@ -17,6 +17,11 @@ using Callbacks = AttrsChangingJobCallbacks;
 
 AttrsChanging::AttrsChanging(AttrsChangingCommand _command)
 {
+    struct SchedulingProfile profile;
+    profile.AddDevices(_command.items);
+    profile.kind = _command.apply_to_subdirs ? SchedulingProfile::Kind::Bulk : SchedulingProfile::Kind::Interactive;
+    SetSchedulingProfile(std::move(profile));
+
     m_Job = std::make_unique<AttrsChangingJob>(std::move(_command));
     m_Job->m_OnSourceAccessError = [this](int _err, const std::string &_path, VFSHost &_vfs) {
         return (Callbacks::SourceAccessErrorResolution)OnSourceAccessError(_err, _path, _vfs);
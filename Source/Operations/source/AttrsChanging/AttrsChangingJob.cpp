@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "AttrsChangingJob.h"
 #include <Utility/PathManip.h>
 #include <sys/stat.h>
@@ -10,6 +10,9 @@ struct AttrsChangingJob::Meta {
     int origin_item;
 };
 
+// the amount of items handed to VFSHost::SetAttributes() at once
+static constexpr size_t g_BatchSize = 512;
+
 static std::pair<uint16_t, uint16_t> PermissionsValueAndMask(const AttrsChangingCommand::Permissions &_p);
 static std::pair<uint32_t, uint32_t> FlagsValueAndMask(const AttrsChangingCommand::Flags &_f);
 
@@ -161,27 +164,166 @@ void AttrsChangingJob::ScanItem(const std::string &_full_path,
 
 void AttrsChangingJob::DoChange()
 {
+    // The changes are handed to the host in batches which it can apply with less overhead than one call per
+    // attribute per item. Items which already have the requested attributes are not touched at all.
+    std::vector<vfs::AttributesChange> changes;
+    std::vector<int> items;
+    VFSHost *batch_vfs = nullptr;
+    const auto flush = [&] {
+        if( !changes.empty() )
+            ChangeBatch(*batch_vfs, changes, items);
+        changes.clear();
+        items.clear();
+    };
+
     int n = 0;
     for( auto i = std::begin(m_Filenames), e = std::end(m_Filenames); i != e; ++i, ++n ) {
         const auto &meta = m_Metas[n];
         const auto &origin_item = m_Command.items[meta.origin_item];
-        const auto path = EnsureNoTrailingSlash(origin_item.Directory() + (*i).to_str_with_pref());
-
-        const auto success = AlterSingleItem(path, *origin_item.Host(), meta.stat);
+        auto &vfs = *origin_item.Host();
+        auto path = EnsureNoTrailingSlash(origin_item.Directory() + (*i).to_str_with_pref());
+
+        auto change = MakeChange(meta.stat);
+        if( !change.permissions && !change.ownership && !change.flags && !change.btime && !change.mtime &&
+            !change.ctime && !change.atime ) {
+            ReportProcessed(path, vfs);
+            continue;
+        }
 
-        if( success ) {
-            Statistics().CommitProcessed(Statistics::SourceType::Items, 1);
+        if( batch_vfs != &vfs || changes.size() == g_BatchSize ) {
+            flush();
+            if( BlockIfPaused(); IsStopped() )
+                return;
+            batch_vfs = &vfs;
+        }
+        change.path = std::move(path);
+        changes.emplace_back(std::move(change));
+        items.emplace_back(n);
+    }
+    flush();
+}
 
-            // for now reports only about successful processing
-            const ItemStateReport report{.host = *origin_item.Host(), .path = path, .status = ItemStatus::Processed};
-            TellItemReport(report);
+void AttrsChangingJob::ChangeBatch(VFSHost &_vfs,
+                                   std::span<const vfs::AttributesChange> _changes,
+                                   std::span<const int> _items)
+{
+    std::vector<vfs::AttributesChangeResult> results(_changes.size());
+    const auto rc = _vfs.SetAttributes(_changes, results, [this] { return IsStopped(); });
+    if( rc == VFSError::Cancelled || IsStopped() )
+        return;
+    if( rc != VFSError::Ok ) {
+        // the batch as a whole has failed, e.g. the connection was lost, so the items are processed one by one to
+        // route the errors through the usual callbacks
+        for( size_t i = 0; i != _changes.size(); ++i ) {
+            if( BlockIfPaused(); IsStopped() )
+                return;
+            const auto &path = _changes[i].path;
+            if( AlterSingleItem(path, _vfs, m_Metas[_items[i]].stat) )
+                ReportProcessed(path, _vfs);
         }
+        return;
+    }
 
-        if( BlockIfPaused(); IsStopped() )
+    for( size_t i = 0; i != _changes.size(); ++i ) {
+        const auto &path = _changes[i].path;
+        if( results[i].failed == vfs::AttributesChangeResult::Step::None ||
+            ResolveChangeFailure(results[i], path, _vfs, m_Metas[_items[i]].stat) )
+            ReportProcessed(path, _vfs);
+
+        if( IsStopped() )
             return;
     }
 }
 
+bool AttrsChangingJob::ResolveChangeFailure(const vfs::AttributesChangeResult &_result,
+                                            const std::string &_path,
+                                            VFSHost &_vfs,
+                                            const VFSStat &_stat)
+{
+    // mimics the resolution of the first failure of AlterSingleItem(), retrying means processing the item anew
+    const auto resolve = [&](auto _resolution, auto _stop, auto _skip) {
+        if( _resolution == _stop ) {
+            Stop();
+            return false;
+        }
+        if( _resolution == _skip ) {
+            Statistics().CommitSkipped(Statistics::SourceType::Items, 1);
+            return false;
+        }
+        return AlterSingleItem(_path, _vfs, _stat);
+    };
+
+    using Step = vfs::AttributesChangeResult::Step;
+    switch( _result.failed ) {
+        case Step::Permissions:
+            return resolve(
+                m_OnChmodError(_result.error, _path, _vfs), ChmodErrorResolution::Stop, ChmodErrorResolution::Skip);
+        case Step::Ownership:
+            return resolve(
+                m_OnChownError(_result.error, _path, _vfs), ChownErrorResolution::Stop, ChownErrorResolution::Skip);
+        case Step::Flags:
+            return resolve(
+                m_OnFlagsError(_result.error, _path, _vfs), FlagsErrorResolution::Stop, FlagsErrorResolution::Skip);
+        case Step::Times:
+            return resolve(
+                m_OnTimesError(_result.error, _path, _vfs), TimesErrorResolution::Stop, TimesErrorResolution::Skip);
+        case Step::None:
+            return true;
+    }
+    return false;
+}
+
+void AttrsChangingJob::ReportProcessed(const std::string &_path, VFSHost &_vfs)
+{
+    Statistics().CommitProcessed(Statistics::SourceType::Items, 1);
+
+    // for now reports only about successful processing
+    const ItemStateReport report{.host = _vfs, .path = _path, .status = ItemStatus::Processed};
+    TellItemReport(report);
+}
+
+vfs::AttributesChange AttrsChangingJob::MakeChange(const VFSStat &_stat) const
+{
+    vfs::AttributesChange change;
+
+    if( m_ChmodCommand ) {
+        const auto [new_mode, mask] = *m_ChmodCommand;
+        const uint16_t mode = (_stat.mode & ~mask) | (new_mode & mask);
+        if( mode != _stat.mode )
+            change.permissions = mode;
+    }
+
+    if( m_Command.ownage ) {
+        const auto new_uid = m_Command.ownage->uid ? *m_Command.ownage->uid : _stat.uid;
+        const auto new_gid = m_Command.ownage->gid ? *m_Command.ownage->gid : _stat.gid;
+        if( new_uid != _stat.uid || new_gid != _stat.gid )
+            change.ownership = vfs::AttributesChange::Ownership{.uid = new_uid, .gid = new_gid};
+    }
+
+    if( m_ChflagCommand ) {
+        const auto [new_flags, mask] = *m_ChflagCommand;
+        const uint32_t flags = (_stat.flags & ~mask) | (new_flags & mask);
+        if( flags != _stat.flags )
+            change.flags = flags;
+    }
+
+    if( m_Command.times ) {
+        const auto differs = [](const std::optional<time_t> &_time, const timespec &_current) {
+            return _time && (*_time != _current.tv_sec || _current.tv_nsec != 0);
+        };
+        if( differs(m_Command.times->btime, _stat.btime) )
+            change.btime = m_Command.times->btime;
+        if( differs(m_Command.times->mtime, _stat.mtime) )
+            change.mtime = m_Command.times->mtime;
+        if( differs(m_Command.times->ctime, _stat.ctime) )
+            change.ctime = m_Command.times->ctime;
+        if( differs(m_Command.times->atime, _stat.atime) )
+            change.atime = m_Command.times->atime;
+    }
+
+    return change;
+}
+
 bool AttrsChangingJob::AlterSingleItem(const std::string &_path, VFSHost &_vfs, const VFSStat &_stat)
 {
     if( m_ChmodCommand )
@@ -281,14 +423,14 @@ bool AttrsChangingJob::ChflagSingleItem(const std::string &_path, VFSHost &_vfs,
     return true;
 }
 
-bool AttrsChangingJob::ChtimesSingleItem(const std::string &_path, VFSHost &_vfs, [[maybe_unused]] const VFSStat &_stat)
+bool AttrsChangingJob::ChtimesSingleItem(const std::string &_path, VFSHost &_vfs, const VFSStat &_stat)
 {
+    const auto change = MakeChange(_stat);
+    if( !change.btime && !change.mtime && !change.ctime && !change.atime )
+        return true;
+
     while( true ) {
-        const auto set_times_rc = _vfs.SetTimes(_path.c_str(),
-                                                m_Command.times->btime,
-                                                m_Command.times->mtime,
-                                                m_Command.times->ctime,
-                                                m_Command.times->atime);
+        const auto set_times_rc = _vfs.SetTimes(_path.c_str(), change.btime, change.mtime, change.ctime, change.atime);
         if( set_times_rc == VFSError::Ok )
             break;
         switch( m_OnTimesError(set_times_rc, _path, _vfs) ) {
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2019 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "../Job.h"
@@ -65,6 +65,13 @@ private:
                   unsigned _origin_item,
                   const base::chained_strings::node *_prefix);
     void DoChange();
+    void ChangeBatch(VFSHost &_vfs, std::span<const vfs::AttributesChange> _changes, std::span<const int> _items);
+    bool ResolveChangeFailure(const vfs::AttributesChangeResult &_result,
+                              const std::string &_path,
+                              VFSHost &_vfs,
+                              const VFSStat &_stat);
+    void ReportProcessed(const std::string &_path, VFSHost &_vfs);
+    vfs::AttributesChange MakeChange(const VFSStat &_stat) const;
     bool AlterSingleItem(const std::string &_path, VFSHost &_vfs, const VFSStat &_stat);
     bool ChmodSingleItem(const std::string &_path, VFSHost &_vfs, const VFSStat &_stat);
     bool ChownSingleItem(const std::string &_path, VFSHost &_vfs, const VFSStat &_stat);
@@ -27,6 +27,12 @@ BatchRenaming::BatchRenaming(std::vector<std::string> _src_paths,
 
     SetTitle(Caption(_src_paths));
 
+    struct SchedulingProfile profile;
+    profile.kind = SchedulingProfile::Kind::Interactive;
+    if( !_src_paths.empty() )
+        profile.AddDevice(*_vfs, _src_paths.front());
+    SetSchedulingProfile(std::move(profile));
+
     m_Job = std::make_unique<BatchRenamingJob>(std::move(_src_paths), std::move(_dst_paths), _vfs);
     m_Job->m_OnRenameError = [this](int _err, const std::string &_path, VFSHost &_vfs) {
         return (Callbacks::RenameErrorResolution)OnRenameError(_err, _path, _vfs);
@@ -156,6 +156,20 @@ static auto g_MyPrivateTableViewDataType = @"com.magnumbytes.nc.ops.BatchRenameS
 using SourceReverseMappingStorage =
     ankerl::unordered_dense::map<std::string, size_t, nc::UnorderedStringHashEqual, nc::UnorderedStringHashEqual>;
 
+// The inputs of the mask stage of renaming, its results are reused as long as these stay the same.
+struct MaskedNamesKey {
+    NSString *mask = nil;
+    int counter_start = 0;
+    int counter_step = 0;
+    long counter_digits = 0;
+    bool operator==(const MaskedNamesKey &_rhs) const noexcept
+    {
+        return mask != nil && _rhs.mask != nil && [mask isEqualToString:_rhs.mask] &&
+               counter_start == _rhs.counter_start && counter_step == _rhs.counter_step &&
+               counter_digits == _rhs.counter_digits;
+    }
+};
+
 @implementation NCOpsBatchRenamingDialog {
     std::vector<BatchRenamingScheme::FileInfo> m_FileInfos;
     SourceReverseMappingStorage m_SourceReverseMapping;
@@ -170,6 +184,9 @@ using SourceReverseMappingStorage =
     std::vector<std::string> m_ResultSource;
     std::vector<std::string> m_ResultDestination;
 
+    std::vector<NSString *> m_MaskedNames; // must be reset whenever m_FileInfos changes
+    MaskedNamesKey m_MaskedNamesKey;
+
     NCUtilSimpleComboBoxPersistentDataSource *m_RenamePatternDataSource;
     NCUtilSimpleComboBoxPersistentDataSource *m_SearchForDataSource;
     NCUtilSimpleComboBoxPersistentDataSource *m_ReplaceWithDataSource;
@@ -348,13 +365,17 @@ using SourceReverseMappingStorage =
         return;
     }
 
-    // apply the renaming scheme to the source filenames
-    std::vector<NSString *> renamed_names;
-    renamed_names.reserve(m_FileInfos.size());
-    for( size_t index = 0, e = m_FileInfos.size(); index != e; ++index ) {
-        NSString *renamed_name = br.Rename(m_FileInfos[index], static_cast<int>(index));
-        renamed_names.emplace_back(renamed_name);
+    // apply the renaming scheme to the source filenames, the mask stage is skipped if only the search/replace or the
+    // case transform options were changed
+    const MaskedNamesKey masked_key{.mask = filename_mask,
+                                    .counter_start = m_CounterStartsAt,
+                                    .counter_step = m_CounterStepsBy,
+                                    .counter_digits = self.CounterDigits.selectedTag};
+    if( m_MaskedNames.size() != m_FileInfos.size() || m_MaskedNamesKey != masked_key ) {
+        m_MaskedNames = br.ApplyMask(m_FileInfos);
+        m_MaskedNamesKey = masked_key;
     }
+    const std::vector<NSString *> renamed_names = br.ApplyPostprocessing(m_MaskedNames);
 
     // build the reverse mapping to check for duplicates later
     SourceReverseMappingStorage dest_reverse_mapping;
@@ -598,6 +619,7 @@ using SourceReverseMappingStorage =
     std::swap(m_LabelsBefore[drag_to], m_LabelsBefore[drag_from]);
     std::swap(m_LabelsAfter[drag_to], m_LabelsAfter[drag_from]);
     std::swap(m_ResultSource[drag_to], m_ResultSource[drag_from]);
+    m_MaskedNames.clear();
 
     [self.FilenamesTable reloadData];
 
@@ -667,6 +689,7 @@ using SourceReverseMappingStorage =
     m_LabelsBefore.erase(std::next(m_LabelsBefore.begin(), _index));
     m_LabelsAfter.erase(std::next(m_LabelsAfter.begin(), _index));
     m_ResultSource.erase(std::next(m_ResultSource.begin(), _index));
+    m_MaskedNames.clear();
 
     [self.FilenamesTable reloadData];
 
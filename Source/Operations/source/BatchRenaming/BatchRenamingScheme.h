@@ -1,7 +1,9 @@
-// Copyright (C) 2015-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2015-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include <VFS/VFS.h>
+#include <span>
+#include <string>
 
 namespace nc::ops {
 
@@ -62,6 +64,13 @@ public:
         NSString *extension; // txt
         time_t mod_time;
         struct tm mod_time_tm;
+
+        // UTF-16 copies of the names, used to build new names without going through NSString per step
+        std::u16string filename_u16;
+        std::u16string name_u16;
+        std::u16string extension_u16;
+        std::u16string parent_u16;
+        std::u16string grandparent_u16;
     };
 
     enum class CaseTransform {
@@ -104,6 +113,15 @@ public:
 
     NSString *Rename(const FileInfo &_fi, int _number) const;
 
+    // Renames the whole batch concurrently, _infos[i] gets the counter value of 'i'.
+    std::vector<NSString *> Rename(std::span<const FileInfo> _infos) const;
+
+    // The two stages of Rename(): the mask script itself and the search/replace with the case transform afterwards.
+    // The first stage doesn't depend on the replacing options nor on the case transform, hence its results can be
+    // reused while only those options are being changed.
+    std::vector<NSString *> ApplyMask(std::span<const FileInfo> _infos) const;
+    std::vector<NSString *> ApplyPostprocessing(std::span<NSString *const> _masked) const;
+
 private:
     enum class ActionType : short {
         Static,
@@ -162,15 +180,21 @@ private:
     void AddInsertCounter(const Counter &t);
     bool ParsePlaceholder(NSString *_ph);
     static NSString *DoSearchReplace(const ReplaceOptions &_opts, NSString *_source);
+    NSString *ApplyMask(const FileInfo &_fi, int _number) const;
+    NSString *ApplyMaskViaNSString(const FileInfo &_fi, int _number) const;
+    NSString *ApplyMaskViaUTF16(const FileInfo &_fi, int _number) const;
+    NSString *ApplyPostprocessing(NSString *_masked) const;
 
     std::vector<Step> m_Steps;
     std::vector<NSString *> m_ActionsStatic;
+    std::vector<std::u16string> m_ActionsStaticU16;
     std::vector<TextExtraction> m_ActionsTextExtraction;
     std::vector<Counter> m_ActionsCounter;
     ReplaceOptions m_SearchReplace;
     CaseTransform m_CaseTransform = CaseTransform::Unchanged;
     bool m_CaseTransformWithExt = false;
     DefaultCounter m_DefaultCounter;
+    bool m_HasCaseTransformSteps = false; // per-step case transforms require NSString processing
 };
 
 inline BatchRenamingScheme::Range::Range() : location(0), length(0)
@@ -1,10 +1,18 @@
 // Copyright (C) 2015-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "BatchRenamingScheme.h"
 #include <Utility/StringExtras.h>
+#include <Base/dispatch_cpp.h>
 #include <fmt/format.h>
 
 namespace nc::ops {
 
+static std::u16string ToUTF16(NSString *_s)
+{
+    std::u16string str(_s.length, 0);
+    [_s getCharacters:reinterpret_cast<unichar *>(str.data()) range:NSMakeRange(0, str.length())];
+    return str;
+}
+
 std::optional<std::vector<BatchRenamingScheme::MaskDecomposition>>
 BatchRenamingScheme::DecomposeMaskIntoPlaceholders(NSString *_mask)
 {
@@ -112,6 +120,11 @@ bool BatchRenamingScheme::BuildActionsScript(NSString *_mask)
         }
     }
 
+    m_HasCaseTransformSteps = std::ranges::any_of(m_Steps, [](const Step &_step) {
+        return _step.type == ActionType::Uppercase || _step.type == ActionType::Lowercase ||
+               _step.type == ActionType::Capitalized;
+    });
+
     // need to clean action on failed parsing
     return ok;
 }
@@ -805,6 +818,7 @@ void BatchRenamingScheme::AddStaticText(NSString *s)
 {
     m_Steps.emplace_back(ActionType::Static, m_ActionsStatic.size());
     m_ActionsStatic.emplace_back(s);
+    m_ActionsStaticU16.emplace_back(ToUTF16(s));
 }
 
 void BatchRenamingScheme::AddInsertName(const TextExtraction &t)
@@ -843,7 +857,205 @@ void BatchRenamingScheme::AddInsertGrandparent(const TextExtraction &t)
     m_ActionsTextExtraction.emplace_back(t);
 }
 
+// the amount of items renamed by a single worker in one go
+static constexpr size_t g_ConcurrentChunkSize = 256;
+
+template <class F>
+static void ForEachConcurrently(size_t _count, const F &_f)
+{
+    const size_t chunks = (_count + g_ConcurrentChunkSize - 1) / g_ConcurrentChunkSize;
+    dispatch_apply(chunks, [&](size_t _chunk) {
+        @autoreleasepool {
+            const size_t first = _chunk * g_ConcurrentChunkSize;
+            const size_t last = std::min(first + g_ConcurrentChunkSize, _count);
+            for( size_t index = first; index != last; ++index )
+                _f(index);
+        }
+    });
+}
+
+template <class T>
+static void AppendASCII(std::u16string &_to, fmt::format_string<T> _fmt, T _value)
+{
+    char buf[64];
+    const auto result = fmt::format_to_n(buf, sizeof(buf), _fmt, _value);
+    _to.append(buf, std::min(result.out, std::end(buf)));
+}
+
+// mirrors BatchRenamingScheme::ExtractText(), appends the extracted text to _to
+static void ExtractTextU16(std::u16string_view _from,
+                           const BatchRenamingScheme::TextExtraction &_te,
+                           std::u16string &_to)
+{
+    using Range = BatchRenamingScheme::Range;
+    const auto length = static_cast<unsigned short>(_from.length());
+    if( length == 0 )
+        return;
+
+    const auto append = [&](Range _r) { _to.append(_from.substr(_r.location, _r.length)); };
+    if( _te.direct_range ) {
+        auto rr = *_te.direct_range;
+        auto sr = Range(0, length);
+        if( !sr.intersects(rr) )
+            return;
+
+        auto res = sr.intersection(rr);
+        if( (_te.zero_flag || _te.space_flag) && rr.length != Range::max_length() && res.length < rr.length ) {
+            const auto insufficient = std::min(rr.length - res.length, 300);
+            _to.append(static_cast<size_t>(insufficient), _te.zero_flag ? u'0' : u' ');
+        }
+        append(res);
+    }
+    else if( _te.reverse_range ) {
+        auto rr = *_te.reverse_range;
+        auto sr = Range(0, length);
+        if( rr.location + 1 > sr.length )
+            rr.location = 0;
+        else
+            rr.location = sr.length - rr.location - 1;
+
+        if( !sr.intersects(rr) )
+            return;
+
+        append(sr.intersection(rr));
+    }
+    else {
+        if( _te.to_last + 1 >= length )
+            return;
+        const unsigned start = _te.from_first;
+        const unsigned end = length - _te.to_last - 1;
+        if( start > end )
+            return;
+
+        append(Range(static_cast<unsigned short>(start), static_cast<unsigned short>(end - start + 1)));
+    }
+}
+
+// mirrors BatchRenamingScheme::FormatCounter(), appends the formatted counter to _to
+static void FormatCounterU16(const BatchRenamingScheme::Counter &_c, int _file_number, std::u16string &_to)
+{
+    if( _c.stripe == 0 )
+        return;
+    char buf[64];
+    const auto result =
+        fmt::format_to_n(buf, sizeof(buf), "{:0{}}", _c.start + _c.step * (_file_number / _c.stripe), _c.width);
+    _to.append(buf, std::min(result.out, std::end(buf)));
+}
+
 NSString *BatchRenamingScheme::Rename(const FileInfo &_fi, int _number) const
+{
+    return ApplyPostprocessing(ApplyMask(_fi, _number));
+}
+
+std::vector<NSString *> BatchRenamingScheme::Rename(std::span<const FileInfo> _infos) const
+{
+    std::vector<NSString *> renamed(_infos.size());
+    ForEachConcurrently(_infos.size(), [&](size_t _index) {
+        renamed[_index] = Rename(_infos[_index], static_cast<int>(_index));
+    });
+    return renamed;
+}
+
+std::vector<NSString *> BatchRenamingScheme::ApplyMask(std::span<const FileInfo> _infos) const
+{
+    std::vector<NSString *> masked(_infos.size());
+    ForEachConcurrently(_infos.size(), [&](size_t _index) {
+        masked[_index] = ApplyMask(_infos[_index], static_cast<int>(_index));
+    });
+    return masked;
+}
+
+std::vector<NSString *> BatchRenamingScheme::ApplyPostprocessing(std::span<NSString *const> _masked) const
+{
+    std::vector<NSString *> renamed(_masked.size());
+    ForEachConcurrently(_masked.size(), [&](size_t _index) { renamed[_index] = ApplyPostprocessing(_masked[_index]); });
+    return renamed;
+}
+
+NSString *BatchRenamingScheme::ApplyMask(const FileInfo &_fi, int _number) const
+{
+    return m_HasCaseTransformSteps ? ApplyMaskViaNSString(_fi, _number) : ApplyMaskViaUTF16(_fi, _number);
+}
+
+NSString *BatchRenamingScheme::ApplyMaskViaUTF16(const FileInfo &_fi, int _number) const
+{
+    std::u16string str;
+    str.reserve(64);
+
+    for( auto step : m_Steps ) {
+        switch( step.type ) {
+            case ActionType::Static:
+                str += m_ActionsStaticU16[step.index];
+                break;
+            case ActionType::Name:
+                ExtractTextU16(_fi.name_u16, m_ActionsTextExtraction[step.index], str);
+                break;
+            case ActionType::Extension:
+                ExtractTextU16(_fi.extension_u16, m_ActionsTextExtraction[step.index], str);
+                break;
+            case ActionType::Filename:
+                ExtractTextU16(_fi.filename_u16, m_ActionsTextExtraction[step.index], str);
+                break;
+            case ActionType::ParentFilename:
+                ExtractTextU16(_fi.parent_u16, m_ActionsTextExtraction[step.index], str);
+                break;
+            case ActionType::GrandparentFilename:
+                ExtractTextU16(_fi.grandparent_u16, m_ActionsTextExtraction[step.index], str);
+                break;
+            case ActionType::Counter:
+                FormatCounterU16(m_ActionsCounter[step.index], _number, str);
+                break;
+            case ActionType::OpenBracket:
+                str += u'[';
+                break;
+            case ActionType::CloseBracket:
+                str += u']';
+                break;
+            case ActionType::TimeSeconds:
+                AppendASCII(str, "{:02}", _fi.mod_time_tm.tm_sec);
+                break;
+            case ActionType::TimeMinutes:
+                AppendASCII(str, "{:02}", _fi.mod_time_tm.tm_min);
+                break;
+            case ActionType::TimeHours:
+                AppendASCII(str, "{:02}", _fi.mod_time_tm.tm_hour);
+                break;
+            case ActionType::TimeDay:
+                AppendASCII(str, "{:02}", _fi.mod_time_tm.tm_mday);
+                break;
+            case ActionType::TimeMonth:
+                AppendASCII(str, "{:02}", _fi.mod_time_tm.tm_mon + 1);
+                break;
+            case ActionType::TimeYear2: {
+                const int year = _fi.mod_time_tm.tm_year;
+                AppendASCII(str, "{:02}", year >= 100 ? year - 100 : year);
+                break;
+            }
+            case ActionType::TimeYear4:
+                AppendASCII(str, "{:04}", _fi.mod_time_tm.tm_year + 1900);
+                break;
+            case ActionType::Date:
+                str += ToUTF16(FormatDate(_fi.mod_time));
+                break;
+            case ActionType::Time:
+                str += ToUTF16(FormatTime(_fi.mod_time));
+                break;
+            default:
+                break;
+        }
+    }
+
+    return [NSString stringWithCharacters:reinterpret_cast<const unichar *>(str.data()) length:str.length()];
+}
+
+NSString *BatchRenamingScheme::ApplyPostprocessing(NSString *_masked) const
+{
+    NSString *const after_replacing = DoSearchReplace(m_SearchReplace, _masked);
+    NSString *const after_case_trans = StringByTransform(after_replacing, m_CaseTransform, m_CaseTransformWithExt);
+    return after_case_trans;
+}
+
+NSString *BatchRenamingScheme::ApplyMaskViaNSString(const FileInfo &_fi, int _number) const
 {
     NSMutableString *const str = [[NSMutableString alloc] initWithCapacity:64];
 
@@ -928,9 +1140,7 @@ NSString *BatchRenamingScheme::Rename(const FileInfo &_fi, int _number) const
         }
     }
 
-    NSString *const after_replacing = DoSearchReplace(m_SearchReplace, str);
-    NSString *const after_case_trans = StringByTransform(after_replacing, m_CaseTransform, m_CaseTransformWithExt);
-    return after_case_trans;
+    return str;
 }
 
 BatchRenamingScheme::FileInfo::FileInfo(VFSListingItem _item)
@@ -948,6 +1158,12 @@ BatchRenamingScheme::FileInfo::FileInfo(VFSListingItem _item)
         name = filename;
         extension = @"";
     }
+
+    filename_u16 = ToUTF16(filename);
+    name_u16 = ToUTF16(name);
+    extension_u16 = ToUTF16(extension);
+    parent_u16 = ToUTF16(ParentFilename());
+    grandparent_u16 = ToUTF16(GrandparentFilename());
 }
 
 NSString *BatchRenamingScheme::FileInfo::ParentFilename() const
@@ -1,7 +1,8 @@
-// Copyright (C) 2017-2019 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "../Operation.h"
+#include "Options.h"
 #include <VFS/VFS.h>
 
 /*
@@ -19,7 +20,7 @@ public:
     Compression(std::vector<VFSListingItem> _src_files,
                 std::string _dst_root,
                 VFSHostPtr _dst_vfs,
-                std::string _passphrase = "");
+                CompressionOptions _options = {});
     virtual ~Compression();
 
     std::string ArchivePath() const;
@@ -1,12 +1,20 @@
 // Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "CompressionJob.h"
+#include "ZipStreamWriter.h"
 #include <Base/algo.h>
+#include <Base/DispatchGroup.h>
 #include <libarchive/archive.h>
 #include <libarchive/archive_entry.h>
 #include <Utility/PathManip.h>
+#include <Utility/ExtensionLowercaseComparison.h>
 #include <VFS/AppleDoubleEA.h>
 #include <sys/param.h>
 #include <fmt/format.h>
+#include <zlib.h>
+#include <condition_variable>
+#include <limits>
+#include <stdexcept>
+#include <thread>
 
 namespace nc::ops {
 
@@ -53,19 +61,82 @@ struct CompressionJob::Source {
     }
 };
 
+// Without encryption the archive is produced by a pipeline: regular files are read and deflated in background while
+// the job's thread writes the results into the archive in the original order. Each file is split into chunks which
+// are deflated independently, with the tail of a previous chunk used as a preset dictionary of the next one, so the
+// compression ratio stays close to the one of a single deflate stream.
+struct CompressionJob::PipelineChunk {
+    std::vector<std::byte> data; // deflated or stored bytes of this chunk
+    size_t raw_size = 0;
+    size_t budget = 0; // amount of bytes accounted in Pipeline::bytes_in_flight
+    uint32_t crc32 = 0;
+    int error = VFSError::Ok; // set if the chunk couldn't be deflated, e.g. due to lack of memory
+    bool stored = false;      // true if the whole file turned out to be incompressible and is stored as-is
+    bool ready = false;
+};
+
+struct CompressionJob::PipelineEntry {
+    int index = 0;
+    std::string full_path;
+    ZipStreamWriter::Method method = ZipStreamWriter::Method::Deflate;
+    VFSStat stat;
+    int access_error = VFSError::Ok;
+    int read_error = VFSError::Ok;
+    bool opened = false;
+    bool done = false;
+    size_t bytes_in_flight = 0;
+    std::vector<std::shared_ptr<PipelineChunk>> chunks;
+    std::vector<std::byte> apple_double;
+};
+
+struct CompressionJob::Pipeline {
+    base::DispatchGroup group;
+    std::mutex lock; // guards everything below and the contents of the entries and chunks
+    std::condition_variable cv;
+    std::vector<std::shared_ptr<PipelineEntry>> entries; // indexed as the source items
+    int head = -1;                                       // index of the entry being written now
+    size_t bytes_in_flight = 0;
+
+    // used only by the job's thread
+    base::chained_strings::iterator schedule_it;
+    int schedule_index = 0;
+};
+
+static constexpr size_t g_PipelineChunkSize = 1024 * 1024;
+static constexpr size_t g_PipelineMemoryBudget = 64 * 1024 * 1024;
+static constexpr size_t g_DeflateWindowSize = 32 * 1024;
+static const int g_PipelineLookahead = static_cast<int>(std::clamp(std::thread::hardware_concurrency(), 4u, 16u));
+static constexpr std::byte g_DeflateFinalEmptyBlock[] = {std::byte{0x03}, std::byte{0x00}};
+
 static void WriteEmptyArchiveEntry(struct ::archive *_archive);
 static bool WriteEAsIfAny(VFSFile &_src, struct archive *_a, const char *_source_fn);
+static bool WriteEAsIfAny(VFSFile &_src, ZipStreamWriter &_zip, const char *_source_fn);
+static std::vector<std::byte> BuildEAs(VFSFile &_src);
+static std::string MakeEAsPath(const char *_source_fn);
 static void archive_entry_copy_stat(struct archive_entry *_ae, const VFSStat &_vfs_stat);
+static ZipStreamWriter::EntryInfo MakeZipEntryInfo(const std::string &_path, const VFSStat &_stat);
+static uint32_t CRC32(std::span<const std::byte> _data) noexcept;
+static void AttachEAsIfAny(VFSFile &_src, struct archive_entry *_entry);
+static std::string_view ArchiveExtension(CompressionFormat _format) noexcept;
+static const char *SevenZipMethodName(CompressionOptions::SevenZip::Method _method) noexcept;
 
 CompressionJob::CompressionJob(std::vector<VFSListingItem> _src_files,
                                std::string _dst_root,
                                VFSHostPtr _dst_vfs,
-                               std::string _password)
+                               CompressionOptions _options)
     : m_InitialListingItems{std::move(_src_files)}, m_DstRoot{std::move(_dst_root)}, m_DstVFS{std::move(_dst_vfs)},
-      m_Password{std::move(_password)}
+      m_Options{std::move(_options)}, m_Pipeline{std::make_unique<Pipeline>()}
 {
     if( m_DstRoot.empty() || m_DstRoot.back() != '/' )
         m_DstRoot += '/';
+    if( !m_Options.password.empty() && m_Options.format != CompressionFormat::Zip )
+        throw std::invalid_argument("CompressionJob: only zip archives can be protected with a password");
+    m_Options.zip.level = std::clamp(m_Options.zip.level, 0, 9);
+    m_Options.zstd.level = std::clamp(m_Options.zstd.level, 1, 19);
+    m_Options.zstd.threads = std::max(m_Options.zstd.threads, 0);
+    m_Options.xz.level = std::clamp(m_Options.xz.level, 0, 9);
+    m_Options.xz.threads = std::max(m_Options.xz.threads, 0);
+    m_Options.seven_zip.level = std::clamp(m_Options.seven_zip.level, 0, 9);
 }
 
 CompressionJob::~CompressionJob() = default;
@@ -92,53 +163,152 @@ void CompressionJob::Perform()
     BuildArchive();
 }
 
+void CompressionJob::OnStopped()
+{
+    // wake up both the writer and the readers waiting inside the pipeline
+    const auto lock = std::lock_guard{m_Pipeline->lock};
+    m_Pipeline->cv.notify_all();
+}
+
 bool CompressionJob::BuildArchive()
 {
     const auto flags =
         VFSFlags::OF_Write | VFSFlags::OF_Create | VFSFlags::OF_IRUsr | VFSFlags::OF_IWUsr | VFSFlags::OF_IRGrp;
     m_DstVFS->CreateFile(m_TargetArchivePath.c_str(), m_TargetFile, nullptr);
     const auto open_rc = m_TargetFile->Open(flags);
-    if( open_rc == VFSError::Ok ) {
-        m_Archive = archive_write_new();
-        archive_write_set_format_zip(m_Archive);
-        archive_write_add_filter_none(m_Archive);
-        if( !m_Password.empty() ) {
-            if( archive_write_set_options(m_Archive, "zip:encryption=aes256") != ARCHIVE_OK ) {
-                Stop();
+    if( open_rc != VFSError::Ok ) {
+        m_TargetWriteError(open_rc, m_TargetArchivePath, *m_DstVFS);
+        Stop();
+        return false;
+    }
+
+    // libarchive can't accept data which was deflated beforehand, so the pipeline has its own zip writer
+    const bool built = IsBuiltViaPipeline() ? BuildArchiveViaPipeline() : BuildArchiveViaLibArchive();
+
+    m_TargetFile->Close();
+
+    if( IsStopped() )
+        m_DstVFS->Unlink(m_TargetArchivePath.c_str(), nullptr);
+
+    return built;
+}
+
+bool CompressionJob::BuildArchiveViaLibArchive()
+{
+    m_Archive = archive_write_new();
+    const auto archive_cleanup = at_scope_end([&] {
+        archive_write_free(m_Archive);
+        m_Archive = nullptr;
+    });
+    if( !SetupArchiveFormat() ) {
+        Stop();
+        return false;
+    }
+
+    archive_write_open(m_Archive, this, nullptr, WriteCallback, nullptr);
+    archive_write_set_bytes_in_last_block(m_Archive, 1);
+
+    ProcessItems();
+
+    if( m_Source->filenames.empty() && m_Options.format == CompressionFormat::Zip )
+        WriteEmptyArchiveEntry(m_Archive);
+
+    archive_write_close(m_Archive);
+    return true;
+}
+
+bool CompressionJob::SetupArchiveFormat()
+{
+    const auto set = [this](const char *_module, const char *_option, const std::string &_value) {
+        return archive_write_set_option(m_Archive, _module, _option, _value.c_str()) == ARCHIVE_OK;
+    };
+    const auto threads = [](int _threads) {
+        return std::to_string(_threads > 0 ? _threads : static_cast<int>(std::thread::hardware_concurrency()));
+    };
+
+    switch( m_Options.format ) {
+        case CompressionFormat::Zip:
+            if( archive_write_set_format_zip(m_Archive) != ARCHIVE_OK ||
+                archive_write_add_filter_none(m_Archive) != ARCHIVE_OK )
                 return false;
+            if( m_Options.zip.level == 0 )
+                set("zip", "compression", "store");
+            else
+                set("zip", "compression-level", std::to_string(m_Options.zip.level));
+            if( IsEncrypted() ) {
+                if( !set("zip", "encryption", "aes256") || !set("zip", "experimental", "1") )
+                    return false;
+                if( archive_write_set_passphrase(m_Archive, m_Options.password.c_str()) != ARCHIVE_OK )
+                    return false;
             }
-            if( archive_write_set_options(m_Archive, "zip:experimental") != ARCHIVE_OK ) {
-                Stop();
+            return true;
+        case CompressionFormat::TarZstd:
+            if( archive_write_set_format_pax_restricted(m_Archive) != ARCHIVE_OK ||
+                archive_write_add_filter_zstd(m_Archive) != ARCHIVE_OK )
                 return false;
-            }
-            if( archive_write_set_passphrase(m_Archive, m_Password.c_str()) != ARCHIVE_OK ) {
-                Stop();
+            if( !set("zstd", "compression-level", std::to_string(m_Options.zstd.level)) )
                 return false;
-            }
-        }
+            set("zstd", "threads", threads(m_Options.zstd.threads)); // libzstd might be built without threads
+            return true;
+        case CompressionFormat::TarXz:
+            if( archive_write_set_format_pax_restricted(m_Archive) != ARCHIVE_OK ||
+                archive_write_add_filter_xz(m_Archive) != ARCHIVE_OK )
+                return false;
+            if( !set("xz", "compression-level", std::to_string(m_Options.xz.level)) )
+                return false;
+            set("xz", "threads", threads(m_Options.xz.threads)); // liblzma might be built without threads
+            return true;
+        case CompressionFormat::SevenZip:
+            if( archive_write_set_format_7zip(m_Archive) != ARCHIVE_OK ||
+                archive_write_add_filter_none(m_Archive) != ARCHIVE_OK )
+                return false;
+            return set("7zip", "compression", SevenZipMethodName(m_Options.seven_zip.method)) &&
+                   set("7zip", "compression-level", std::to_string(m_Options.seven_zip.level));
+    }
+    return false;
+}
 
-        archive_write_open(m_Archive, this, nullptr, WriteCallback, nullptr);
-        archive_write_set_bytes_in_last_block(m_Archive, 1);
+bool CompressionJob::BuildArchiveViaPipeline()
+{
+    const auto sink = [this](const void *_buffer, size_t _size) {
+        auto buffer = static_cast<const std::byte *>(_buffer);
+        while( _size > 0 ) {
+            const ssize_t rc = m_TargetFile->Write(buffer, _size);
+            if( rc <= 0 )
+                return false;
+            buffer += rc;
+            _size -= rc;
+        }
+        return true;
+    };
+    m_ZipWriter = std::make_unique<ZipStreamWriter>(sink);
+    const auto writer_cleanup = at_scope_end([&] { m_ZipWriter.reset(); });
 
-        ProcessItems();
+    auto &pipeline = *m_Pipeline;
+    pipeline.entries.resize(m_Source->metas.size());
+    pipeline.schedule_it = m_Source->filenames.begin();
+    pipeline.schedule_index = 0;
 
-        if( m_Source->filenames.empty() )
-            WriteEmptyArchiveEntry(m_Archive);
+    ProcessItems();
 
-        archive_write_close(m_Archive);
-        archive_write_free(m_Archive);
+    // the background tasks bail out quickly once the job is stopped
+    pipeline.group.Wait();
+    pipeline.entries.clear();
 
-        m_TargetFile->Close();
+    if( IsStopped() )
+        return false;
 
-        if( IsStopped() )
-            m_DstVFS->Unlink(m_TargetArchivePath.c_str(), nullptr);
+    if( m_Source->filenames.empty() ) {
+        ZipStreamWriter::EntryInfo info;
+        info.mode = S_IFDIR | S_IRWXU;
+        m_ZipWriter->AddDirectory(info);
     }
-    else {
-        m_TargetWriteError(open_rc, m_TargetArchivePath, *m_DstVFS);
+
+    if( !m_ZipWriter->Finish() ) {
+        m_TargetWriteError(m_TargetFile->LastError(), m_TargetArchivePath, *m_DstVFS);
         Stop();
         return false;
     }
-
     return true;
 }
 
@@ -146,6 +316,8 @@ void CompressionJob::ProcessItems()
 {
     int n = 0;
     for( const auto &item : m_Source->filenames ) {
+        if( m_ZipWriter )
+            SchedulePipelineEntries(n);
 
         ProcessItem(item, n++);
         Statistics().CommitProcessed(Statistics::SourceType::Items, 1);
@@ -167,6 +339,8 @@ void CompressionJob::ProcessItem(const base::chained_strings::node &_node, int _
         result = ProcessDirectoryItem(_index, rel_path, full_path);
     else if( (meta.flags & IF::symlink) == IF::symlink )
         result = ProcessSymlinkItem(_index, rel_path, full_path);
+    else if( m_ZipWriter )
+        result = ProcessRegularItemViaPipeline(_index, rel_path, full_path);
     else
         result = ProcessRegularItem(_index, rel_path, full_path);
 
@@ -217,6 +391,15 @@ CompressionJob::ProcessSymlinkItem(int _index, const std::string &_relative_path
         }
     }
 
+    if( m_ZipWriter ) {
+        if( !m_ZipWriter->AddSymlink(MakeZipEntryInfo(_relative_path, stat), symlink) ) {
+            m_TargetWriteError(m_TargetFile->LastError(), m_TargetArchivePath, *m_DstVFS);
+            Stop();
+            return StepResult::Stopped;
+        }
+        return StepResult::Done;
+    }
+
     const auto entry = archive_entry_new();
     const auto entry_cleanup = at_scope_end([&] { archive_entry_free(entry); });
     archive_entry_set_pathname(entry, _relative_path.c_str());
@@ -249,23 +432,41 @@ CompressionJob::ProcessDirectoryItem(int _index, const std::string &_relative_pa
         }
     }
 
-    auto entry = archive_entry_new();
-    auto entry_cleanup = at_scope_end([&] { archive_entry_free(entry); });
-    archive_entry_set_pathname(entry, _relative_path.c_str());
-    archive_entry_copy_stat(entry, vfs_stat);
-    const auto head_write_rc = archive_write_header(m_Archive, entry);
-    if( head_write_rc < 0 ) {
-        m_TargetWriteError(m_TargetFile->LastError(), m_TargetArchivePath, *m_DstVFS);
-        Stop();
+    if( m_ZipWriter ) {
+        if( !m_ZipWriter->AddDirectory(MakeZipEntryInfo(_relative_path, vfs_stat)) ) {
+            m_TargetWriteError(m_TargetFile->LastError(), m_TargetArchivePath, *m_DstVFS);
+            Stop();
+            return StepResult::Stopped;
+        }
+    }
+    else {
+        auto entry = archive_entry_new();
+        auto entry_cleanup = at_scope_end([&] { archive_entry_free(entry); });
+        archive_entry_set_pathname(entry, _relative_path.c_str());
+        archive_entry_copy_stat(entry, vfs_stat);
+        if( StoresEAsAsMacMetadata() ) {
+            VFSFilePtr src_file;
+            vfs.CreateFile(_full_path.c_str(), src_file);
+            if( src_file->Open(VFSFlags::OF_Read) == VFSError::Ok )
+                AttachEAsIfAny(*src_file, entry);
+        }
+        const auto head_write_rc = archive_write_header(m_Archive, entry);
+        if( head_write_rc < 0 ) {
+            m_TargetWriteError(m_TargetFile->LastError(), m_TargetArchivePath, *m_DstVFS);
+            Stop();
+        }
     }
 
-    if( IsEncrypted() == false ) {
+    if( IsEncrypted() == false && StoresEAsAsMacMetadata() == false ) {
         // we can't support encrypted EAs due to lack of read support in LA
         VFSFilePtr src_file;
         vfs.CreateFile(_full_path.c_str(), src_file);
         if( src_file->Open(VFSFlags::OF_Read) == VFSError::Ok ) {
             const std::string name_wo_slash = {std::begin(_relative_path), std::end(_relative_path) - 1};
-            WriteEAsIfAny(*src_file, m_Archive, name_wo_slash.c_str());
+            if( m_ZipWriter )
+                WriteEAsIfAny(*src_file, *m_ZipWriter, name_wo_slash.c_str());
+            else
+                WriteEAsIfAny(*src_file, m_Archive, name_wo_slash.c_str());
         }
     }
 
@@ -318,6 +519,8 @@ CompressionJob::ProcessRegularItem(int _index, const std::string &_relative_path
 
     archive_entry_set_pathname(entry, _relative_path.c_str());
     archive_entry_copy_stat(entry, stat);
+    if( StoresEAsAsMacMetadata() )
+        AttachEAsIfAny(*src_file, entry);
     const auto head_write_rc = archive_write_header(m_Archive, entry);
     if( head_write_rc < 0 ) {
         m_TargetWriteError(m_TargetFile->LastError(), m_TargetArchivePath, *m_DstVFS);
@@ -347,6 +550,7 @@ CompressionJob::ProcessRegularItem(int _index, const std::string &_relative_path
         }
 
         Statistics().CommitProcessed(Statistics::SourceType::Bytes, source_read_rc);
+        ThrottleIO(source_read_rc);
     }
 
     if( source_read_rc < 0 )
@@ -358,7 +562,7 @@ CompressionJob::ProcessRegularItem(int _index, const std::string &_relative_path
                 return StepResult::Skipped;
         }
 
-    if( IsEncrypted() == false ) {
+    if( IsEncrypted() == false && StoresEAsAsMacMetadata() == false ) {
         // we can't support encrypted EAs due to lack of read support in LA
         WriteEAsIfAny(*src_file, m_Archive, _relative_path.c_str());
     }
@@ -366,15 +570,362 @@ CompressionJob::ProcessRegularItem(int _index, const std::string &_relative_path
     return StepResult::Done;
 }
 
+CompressionJob::StepResult CompressionJob::ProcessRegularItemViaPipeline(int _index,
+                                                                         const std::string &_relative_path,
+                                                                         const std::string &_full_path)
+{
+    const auto meta = m_Source->metas[_index];
+    auto &vfs = *m_Source->base_hosts[meta.base_vfs_indx];
+    auto &pipeline = *m_Pipeline;
+    const auto write_failed = [&] {
+        m_TargetWriteError(m_TargetFile->LastError(), m_TargetArchivePath, *m_DstVFS);
+        Stop();
+        return StepResult::Stopped;
+    };
+
+    std::shared_ptr<PipelineEntry> entry = std::move(pipeline.entries[_index]);
+    assert(entry);
+    {
+        const auto lock = std::lock_guard{pipeline.lock};
+        pipeline.head = _index;
+    }
+    pipeline.cv.notify_all();
+
+    while( true ) {
+        int access_error = VFSError::Ok;
+        {
+            auto lock = std::unique_lock{pipeline.lock};
+            pipeline.cv.wait(lock, [&] { return entry->opened || entry->done || IsStopped(); });
+            if( IsStopped() )
+                return StepResult::Stopped;
+            if( entry->opened )
+                break;
+            access_error = entry->access_error;
+        }
+        switch( m_SourceAccessError(access_error, _full_path, vfs) ) {
+            case SourceAccessErrorResolution::Stop:
+                Stop();
+                return StepResult::Stopped;
+            case SourceAccessErrorResolution::Skip:
+                return StepResult::Skipped;
+            case SourceAccessErrorResolution::Retry:
+                entry = SchedulePipelineEntry(_index, _full_path);
+                continue;
+        }
+    }
+
+    // the stat is set before the entry is marked as opened and is not changed afterwards
+    const VFSStat &stat = entry->stat;
+    std::optional<ZipStreamWriter::Method> method; // defined by the first chunk
+    uLong crc = crc32(0, nullptr, 0);
+    uint64_t size = 0;
+    int read_error = VFSError::Ok;
+    int chunk_error = VFSError::Ok; // the rest of the chunks are only drained after a chunk failed
+    for( size_t chunk_index = 0;; ++chunk_index ) {
+        std::shared_ptr<PipelineChunk> chunk;
+        {
+            auto lock = std::unique_lock{pipeline.lock};
+            pipeline.cv.wait(lock, [&] {
+                if( chunk_index < entry->chunks.size() )
+                    return entry->chunks[chunk_index]->ready || IsStopped();
+                return entry->done || IsStopped();
+            });
+            if( IsStopped() )
+                return StepResult::Stopped;
+            if( chunk_index == entry->chunks.size() ) {
+                read_error = chunk_error != VFSError::Ok ? chunk_error : entry->read_error;
+                break;
+            }
+            chunk = std::move(entry->chunks[chunk_index]);
+        }
+
+        if( chunk_error == VFSError::Ok )
+            chunk_error = chunk->error;
+        if( chunk_error == VFSError::Ok ) {
+            if( !method ) {
+                method = chunk->stored ? ZipStreamWriter::Method::Store : entry->method;
+                if( !m_ZipWriter->BeginFile(MakeZipEntryInfo(_relative_path, stat), *method, stat.size) )
+                    return write_failed();
+            }
+            if( !m_ZipWriter->WriteFileData(chunk->data) )
+                return write_failed();
+            crc = crc32_combine(crc, chunk->crc32, static_cast<z_off_t>(chunk->raw_size));
+            size += chunk->raw_size;
+        }
+
+        {
+            const auto lock = std::lock_guard{pipeline.lock};
+            pipeline.bytes_in_flight -= chunk->budget;
+            entry->bytes_in_flight -= chunk->budget;
+        }
+        pipeline.cv.notify_all();
+
+        Statistics().CommitProcessed(Statistics::SourceType::Bytes, chunk->raw_size);
+        // the readers are bounded by the memory budget, so throttling the writer throttles the whole pipeline
+        ThrottleIO(chunk->raw_size);
+
+        if( BlockIfPaused(); IsStopped() )
+            return StepResult::Stopped;
+    }
+
+    if( read_error != VFSError::Ok ) {
+        if( method ) {
+            // close the truncated entry, the deflate stream was sync-flushed so it can be terminated by an empty block
+            if( *method == ZipStreamWriter::Method::Deflate && !m_ZipWriter->WriteFileData(g_DeflateFinalEmptyBlock) )
+                return write_failed();
+            if( !m_ZipWriter->EndFile(static_cast<uint32_t>(crc), size) )
+                return write_failed();
+        }
+        switch( m_SourceReadError(read_error, _full_path, vfs) ) {
+            case SourceReadErrorResolution::Stop:
+                Stop();
+                return StepResult::Stopped;
+            case SourceReadErrorResolution::Skip:
+                return StepResult::Skipped;
+        }
+    }
+
+    if( !m_ZipWriter->EndFile(static_cast<uint32_t>(crc), size) )
+        return write_failed();
+
+    if( !entry->apple_double.empty() ) {
+        ZipStreamWriter::EntryInfo info;
+        info.path = MakeEAsPath(_relative_path.c_str());
+        info.mode = S_IFREG | 0644;
+        if( !info.path.empty() && !m_ZipWriter->AddFile(info, entry->apple_double) )
+            return write_failed();
+    }
+
+    return StepResult::Done;
+}
+
+void CompressionJob::SchedulePipelineEntries(int _index)
+{
+    using IF = Source::ItemFlags;
+    auto &pipeline = *m_Pipeline;
+    const int limit = std::min(static_cast<int>(m_Source->metas.size()), _index + g_PipelineLookahead);
+    for( ; pipeline.schedule_index < limit; ++pipeline.schedule_index, ++pipeline.schedule_it ) {
+        const auto meta = m_Source->metas[pipeline.schedule_index];
+        if( (meta.flags & (IF::is_dir | IF::symlink)) != IF::none )
+            continue;
+        const auto &base_path = m_Source->base_paths[meta.base_path_indx];
+        const auto full_path = EnsureNoTrailingSlash(base_path + (*pipeline.schedule_it).to_str_with_pref());
+        pipeline.entries[pipeline.schedule_index] = SchedulePipelineEntry(pipeline.schedule_index, full_path);
+    }
+}
+
+std::shared_ptr<CompressionJob::PipelineEntry> CompressionJob::SchedulePipelineEntry(int _index,
+                                                                                     const std::string &_full_path)
+{
+    auto entry = std::make_shared<PipelineEntry>();
+    entry->index = _index;
+    entry->full_path = _full_path;
+    if( m_Options.zip.level == 0 || (m_Options.zip.store_compressed_files && IsAlreadyCompressed(_full_path)) )
+        entry->method = ZipStreamWriter::Method::Store;
+    m_Pipeline->group.Run([this, entry] { ReadPipelineEntry(*entry); });
+    return entry;
+}
+
+void CompressionJob::ReadPipelineEntry(PipelineEntry &_entry)
+{
+    const ScopedIOPriority io_priority{IOPriority()};
+    auto &pipeline = *m_Pipeline;
+    auto &vfs = *m_Source->base_hosts[m_Source->metas[_entry.index].base_vfs_indx];
+    const auto finish = [&](int _access_error, int _read_error) {
+        {
+            const auto lock = std::lock_guard{pipeline.lock};
+            _entry.access_error = _access_error;
+            _entry.read_error = _read_error;
+            _entry.done = true;
+        }
+        pipeline.cv.notify_all();
+    };
+
+    VFSStat stat;
+    if( const auto rc = vfs.Stat(_entry.full_path.c_str(), stat, 0); rc != VFSError::Ok )
+        return finish(rc, VFSError::Ok);
+
+    VFSFilePtr file;
+    if( const auto rc = vfs.CreateFile(_entry.full_path.c_str(), file); rc != VFSError::Ok )
+        return finish(rc, VFSError::Ok);
+
+    if( const auto rc = file->Open(VFSFlags::OF_Read | VFSFlags::OF_ShLock); rc != VFSError::Ok )
+        return finish(rc, VFSError::Ok);
+
+    {
+        const auto lock = std::lock_guard{pipeline.lock};
+        _entry.stat = stat;
+        _entry.opened = true;
+    }
+    pipeline.cv.notify_all();
+
+    // without ZIP64 sizes reserved in the local header the entry must stay below the limit even if the file grows
+    const uint64_t limit = ZipStreamWriter::ReservesZIP64(stat.size) ? std::numeric_limits<uint64_t>::max()
+                                                                     : ZipStreamWriter::ZIP64Reservation - 1;
+    size_t reserved = 0; // the budget which is not handed over to a chunk yet
+    const auto release = [&] {
+        const auto lock = std::lock_guard{pipeline.lock};
+        pipeline.bytes_in_flight -= reserved;
+        _entry.bytes_in_flight -= reserved;
+        reserved = 0;
+    };
+
+    try {
+        std::vector<std::byte> dictionary;
+        uint64_t left = stat.size; // only an estimation, the file can change while being read
+        uint64_t total = 0;
+        for( bool first = true;; first = false ) {
+            // a chunk shorter than its capacity is the last one, hence the +1 for the files of a known size,
+            // while a file that has grown past its estimated size is read by the whole chunks
+            const uint64_t expected = left == 0 && !first ? g_PipelineChunkSize : left + 1;
+            const size_t capacity =
+                static_cast<size_t>(std::min({uint64_t(g_PipelineChunkSize), expected, limit - total}));
+            {
+                // the entry being written can always have a chunk in flight, otherwise the job would deadlock
+                auto lock = std::unique_lock{pipeline.lock};
+                pipeline.cv.wait(lock, [&] {
+                    return pipeline.bytes_in_flight + capacity <= g_PipelineMemoryBudget ||
+                           (pipeline.head == _entry.index && _entry.bytes_in_flight == 0) || IsStopped();
+                });
+                if( IsStopped() )
+                    return;
+                pipeline.bytes_in_flight += capacity;
+                _entry.bytes_in_flight += capacity;
+                reserved = capacity;
+            }
+
+            std::vector<std::byte> raw(capacity);
+            size_t filled = 0;
+            ssize_t rc = 0;
+            while( filled < capacity && (rc = file->Read(raw.data() + filled, capacity - filled)) > 0 )
+                filled += rc;
+            if( rc < 0 ) {
+                release();
+                return finish(VFSError::Ok, static_cast<int>(rc));
+            }
+            raw.resize(filled);
+            left -= std::min<uint64_t>(left, filled);
+            total += filled;
+            const bool last = filled < capacity || total == limit;
+
+            auto chunk = std::make_shared<PipelineChunk>();
+            chunk->raw_size = filled;
+            chunk->budget = capacity;
+            const size_t dictionary_size = std::min(raw.size(), g_DeflateWindowSize);
+            std::vector<std::byte> next_dictionary;
+            if( _entry.method != ZipStreamWriter::Method::Store && !last )
+                next_dictionary.assign(raw.end() - dictionary_size, raw.end());
+            {
+                const auto lock = std::lock_guard{pipeline.lock};
+                _entry.chunks.emplace_back(chunk);
+                reserved = 0;
+            }
+
+            if( _entry.method == ZipStreamWriter::Method::Store ) {
+                const auto crc = CRC32(raw);
+                {
+                    const auto lock = std::lock_guard{pipeline.lock};
+                    chunk->crc32 = crc;
+                    chunk->data = std::move(raw);
+                    chunk->ready = true;
+                }
+                pipeline.cv.notify_all();
+            }
+            else if( first && last ) {
+                // a small file, not worth a separate task
+                CompressPipelineChunk(*chunk, std::move(raw), {}, true, true);
+            }
+            else {
+                pipeline.group.Run(
+                    [this, chunk, raw = std::move(raw), dictionary = std::move(dictionary), last]() mutable {
+                        CompressPipelineChunk(*chunk, std::move(raw), dictionary, last, false);
+                    });
+                dictionary = std::move(next_dictionary);
+            }
+
+            if( last )
+                break;
+        }
+    } catch( const std::bad_alloc & ) {
+        // the failure is reported by the job's thread as a read error of this file
+        release();
+        return finish(VFSError::Ok, VFSError::FromErrno(ENOMEM));
+    }
+
+    if( !IsEncrypted() ) {
+        auto apple_double = BuildEAs(*file);
+        const auto lock = std::lock_guard{pipeline.lock};
+        _entry.apple_double = std::move(apple_double);
+    }
+
+    finish(VFSError::Ok, VFSError::Ok);
+}
+
+void CompressionJob::CompressPipelineChunk(PipelineChunk &_chunk,
+                                           std::vector<std::byte> _raw,
+                                           std::span<const std::byte> _dictionary,
+                                           bool _last,
+                                           bool _single)
+{
+    const uint32_t crc = CRC32(_raw);
+    std::vector<std::byte> deflated;
+    int error = VFSError::Ok;
+    if( !IsStopped() ) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if( deflateInit2(&stream, m_Options.zip.level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK ) {
+            if( !_dictionary.empty() )
+                deflateSetDictionary(&stream,
+                                     reinterpret_cast<const Bytef *>(_dictionary.data()),
+                                     static_cast<uInt>(_dictionary.size()));
+            try {
+                // the sync flush marker is not accounted in deflateBound()
+                deflated.resize(deflateBound(&stream, static_cast<uLong>(_raw.size())) + 16);
+                stream.next_in = reinterpret_cast<Bytef *>(_raw.data());
+                stream.avail_in = static_cast<uInt>(_raw.size());
+                while( true ) {
+                    stream.next_out = reinterpret_cast<Bytef *>(deflated.data() + stream.total_out);
+                    stream.avail_out = static_cast<uInt>(deflated.size() - stream.total_out);
+                    const int rc = deflate(&stream, _last ? Z_FINISH : Z_SYNC_FLUSH);
+                    if( rc == Z_STREAM_END || (!_last && rc == Z_OK && stream.avail_out != 0) )
+                        break;
+                    deflated.resize(deflated.size() * 2);
+                }
+                deflated.resize(stream.total_out);
+            } catch( const std::bad_alloc & ) {
+                error = VFSError::FromErrno(ENOMEM);
+            }
+            deflateEnd(&stream);
+        }
+        else {
+            error = VFSError::FromErrno(ENOMEM);
+        }
+    }
+
+    // this runs on a dispatch queue, so the failures are passed to the job's thread instead of being thrown
+    const bool store = error == VFSError::Ok && _single && deflated.size() >= _raw.size();
+    {
+        auto &pipeline = *m_Pipeline;
+        const auto lock = std::lock_guard{pipeline.lock};
+        _chunk.crc32 = crc;
+        _chunk.data = store ? std::move(_raw) : std::move(deflated);
+        _chunk.stored = store;
+        _chunk.error = error;
+        _chunk.ready = true;
+    }
+    m_Pipeline->cv.notify_all();
+}
+
 std::string CompressionJob::FindSuitableFilename(const std::string &_proposed_arcname) const
 {
-    std::string fn = fmt::format("{}{}.zip", m_DstRoot, _proposed_arcname);
+    const std::string_view ext = ArchiveExtension(m_Options.format);
+    std::string fn = fmt::format("{}{}.{}", m_DstRoot, _proposed_arcname, ext);
     VFSStat st;
     if( m_DstVFS->Stat(fn.c_str(), st, VFSFlags::F_NoFollow, nullptr) != 0 )
         return fn;
 
     for( int i = 2; i < 100; ++i ) {
-        fn = fmt::format("{}{} {}.zip", m_DstRoot, _proposed_arcname, i);
+        fn = fmt::format("{}{} {}.{}", m_DstRoot, _proposed_arcname, i, ext);
         if( m_DstVFS->Stat(fn.c_str(), st, VFSFlags::F_NoFollow, nullptr) != 0 )
             return fn;
     }
@@ -551,7 +1102,34 @@ ssize_t CompressionJob::WriteCallback(struct archive *, void *_client_data, cons
 
 bool CompressionJob::IsEncrypted() const noexcept
 {
-    return m_Password.empty() == false;
+    return m_Options.format == CompressionFormat::Zip && m_Options.password.empty() == false;
+}
+
+bool CompressionJob::IsBuiltViaPipeline() const noexcept
+{
+    return m_Options.format == CompressionFormat::Zip && !IsEncrypted();
+}
+
+bool CompressionJob::StoresEAsAsMacMetadata() const noexcept
+{
+    // the pax writer emits the metadata as "._" AppleDouble companions, the same way bsdtar does on macOS
+    return m_Options.format == CompressionFormat::TarZstd || m_Options.format == CompressionFormat::TarXz;
+}
+
+bool CompressionJob::IsAlreadyCompressed(std::string_view _filename) const noexcept
+{
+    // deflating these only burns CPU, the gain is negligible if any
+    [[clang::no_destroy]] static const utility::ExtensionsLowercaseList extensions(
+        "jpg, jpeg, png, gif, heic, heif, webp, avif, jxl, mp3, m4a, aac, ogg, opus, flac, mp4, m4v, mov, avi, mkv, "
+        "webm, wmv, zip, gz, tgz, bz2, tbz, xz, txz, zst, lz4, lzma, 7z, rar, dmg, pkg, xip, jar, apk, ipa, docx, "
+        "xlsx, pptx, pages, numbers, key, epub");
+    const auto dot = _filename.rfind('.');
+    if( dot == std::string_view::npos || dot + 1 == _filename.size() )
+        return false;
+    const auto extension = _filename.substr(dot + 1);
+    if( extension.find('/') != std::string_view::npos )
+        return false;
+    return extensions.contains(extension);
 }
 
 static void archive_entry_copy_stat(struct archive_entry *_ae, const VFSStat &_vfs_stat)
@@ -573,11 +1151,10 @@ static void WriteEmptyArchiveEntry(struct ::archive *_archive)
     archive_entry_free(entry);
 }
 
-static bool WriteEAs(struct archive *_a, void *_md, size_t _md_s, const char *_path, const char *_name)
+static bool WriteEAs(struct archive *_a, void *_md, size_t _md_s, const std::string &_metadata_path)
 {
-    const std::string metadata_path = fmt::format("__MACOSX/{}._{}", _path, _name);
     struct archive_entry *entry = archive_entry_new();
-    archive_entry_set_pathname(entry, metadata_path.c_str());
+    archive_entry_set_pathname(entry, _metadata_path.c_str());
     archive_entry_set_size(entry, _md_s);
     archive_entry_set_filetype(entry, AE_IFREG);
     archive_entry_set_perm(entry, 0644);
@@ -588,6 +1165,14 @@ static bool WriteEAs(struct archive *_a, void *_md, size_t _md_s, const char *_p
     return ret == static_cast<ssize_t>(_md_s);
 }
 
+static std::string MakeEAsPath(const char *_source_fn)
+{
+    char item_path[MAXPATHLEN], item_name[MAXPATHLEN];
+    if( GetFilenameFromRelPath(_source_fn, item_name) && GetDirectoryContainingItemFromRelPath(_source_fn, item_path) )
+        return fmt::format("__MACOSX/{}._{}", item_path, item_name);
+    return {};
+}
+
 static bool WriteEAsIfAny(VFSFile &_src, struct archive *_a, const char *_source_fn)
 {
     assert(!IsPathWithTrailingSlash(_source_fn));
@@ -598,16 +1183,104 @@ static bool WriteEAsIfAny(VFSFile &_src, struct archive *_a, const char *_source
     if( metadata == nullptr )
         return true;
 
-    char item_path[MAXPATHLEN], item_name[MAXPATHLEN];
-    if( GetFilenameFromRelPath(_source_fn, item_name) &&
-        GetDirectoryContainingItemFromRelPath(_source_fn, item_path) ) {
-        const bool ret = WriteEAs(_a, metadata, metadata_sz, item_path, item_name);
-        free(metadata);
-        return ret;
-    }
+    const auto metadata_cleanup = at_scope_end([&] { free(metadata); });
+    if( const auto metadata_path = MakeEAsPath(_source_fn); !metadata_path.empty() )
+        return WriteEAs(_a, metadata, metadata_sz, metadata_path);
 
-    free(metadata);
     return true;
 }
 
+static std::vector<std::byte> BuildEAs(VFSFile &_src)
+{
+    size_t metadata_sz = 0;
+    void *metadata = vfs::BuildAppleDoubleFromEA(_src, &metadata_sz);
+    if( metadata == nullptr )
+        return {};
+    const auto bytes = static_cast<const std::byte *>(metadata);
+    std::vector<std::byte> apple_double(bytes, bytes + metadata_sz);
+    free(metadata);
+    return apple_double;
+}
+
+static bool WriteEAsIfAny(VFSFile &_src, ZipStreamWriter &_zip, const char *_source_fn)
+{
+    assert(!IsPathWithTrailingSlash(_source_fn));
+
+    const auto apple_double = BuildEAs(_src);
+    if( apple_double.empty() )
+        return true;
+
+    ZipStreamWriter::EntryInfo info;
+    info.path = MakeEAsPath(_source_fn);
+    info.mode = S_IFREG | 0644;
+    if( info.path.empty() )
+        return true;
+
+    return _zip.AddFile(info, apple_double);
+}
+
+static void AttachEAsIfAny(VFSFile &_src, struct archive_entry *_entry)
+{
+    size_t metadata_sz = 0;
+    void *metadata = vfs::BuildAppleDoubleFromEA(_src, &metadata_sz);
+    if( metadata == nullptr )
+        return;
+    archive_entry_copy_mac_metadata(_entry, metadata, metadata_sz);
+    free(metadata);
+}
+
+static std::string_view ArchiveExtension(CompressionFormat _format) noexcept
+{
+    switch( _format ) {
+        case CompressionFormat::Zip:
+            return "zip";
+        case CompressionFormat::TarZstd:
+            return "tar.zst";
+        case CompressionFormat::TarXz:
+            return "tar.xz";
+        case CompressionFormat::SevenZip:
+            return "7z";
+    }
+    return "zip";
+}
+
+static const char *SevenZipMethodName(CompressionOptions::SevenZip::Method _method) noexcept
+{
+    using Method = CompressionOptions::SevenZip::Method;
+    switch( _method ) {
+        case Method::LZMA2:
+            return "lzma2";
+        case Method::LZMA1:
+            return "lzma1";
+        case Method::Deflate:
+            return "deflate";
+        case Method::BZip2:
+            return "bzip2";
+        case Method::PPMd:
+            return "ppmd";
+        case Method::Store:
+            return "store";
+    }
+    return "lzma2";
+}
+
+static ZipStreamWriter::EntryInfo MakeZipEntryInfo(const std::string &_path, const VFSStat &_stat)
+{
+    ZipStreamWriter::EntryInfo info;
+    info.path = _path;
+    info.mode = _stat.mode;
+    info.mtime = _stat.mtime.tv_sec;
+    info.atime = _stat.atime.tv_sec;
+    info.uid = _stat.uid;
+    info.gid = _stat.gid;
+    return info;
+}
+
+static uint32_t CRC32(std::span<const std::byte> _data) noexcept
+{
+    // the chunks are small enough to fit into the 32-bit length of crc32()
+    return static_cast<uint32_t>(
+        crc32(crc32(0, nullptr, 0), reinterpret_cast<const Bytef *>(_data.data()), static_cast<uInt>(_data.size())));
+}
+
 } // namespace nc::ops
@@ -1,7 +1,8 @@
-// Copyright (C) 2017-2020 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "../Job.h"
+#include "Options.h"
 #include <VFS/VFS.h>
 #include <Base/chained_strings.h>
 
@@ -9,6 +10,8 @@ struct archive;
 
 namespace nc::ops {
 
+class ZipStreamWriter;
+
 struct CompressionJobCallbacks {
     std::function<void()> m_TargetPathDefined = [] {};
 
@@ -45,13 +48,16 @@ public:
     CompressionJob(std::vector<VFSListingItem> _src_files,
                    std::string _dst_root,
                    VFSHostPtr _dst_vfs,
-                   std::string _password);
+                   CompressionOptions _options);
     ~CompressionJob();
 
     const std::string &TargetArchivePath() const;
 
 private:
     struct Source;
+    struct Pipeline;
+    struct PipelineEntry;
+    struct PipelineChunk;
     enum class StepResult {
         Stopped,
         Done,
@@ -59,6 +65,7 @@ private:
     };
 
     virtual void Perform() override;
+    virtual void OnStopped() override;
     std::optional<Source> ScanItems();
     bool ScanItem(const VFSListingItem &_item, Source &_ctx);
     bool ScanItem(const std::string &_full_path,
@@ -68,14 +75,32 @@ private:
                   const base::chained_strings::node *_prefix,
                   Source &_ctx);
     bool BuildArchive();
+    bool BuildArchiveViaLibArchive();
+    bool SetupArchiveFormat();
+    bool BuildArchiveViaPipeline();
     void ProcessItems();
     void ProcessItem(const base::chained_strings::node &_node, int _index);
     StepResult ProcessDirectoryItem(int _index, const std::string &_relative_path, const std::string &_full_path);
     StepResult ProcessRegularItem(int _index, const std::string &_relative_path, const std::string &_full_path);
     StepResult ProcessSymlinkItem(int _index, const std::string &_relative_path, const std::string &_full_path);
+    StepResult
+    ProcessRegularItemViaPipeline(int _index, const std::string &_relative_path, const std::string &_full_path);
+
+    // Starts reading and compressing the regular files that follow _index in background, up to a lookahead limit.
+    void SchedulePipelineEntries(int _index);
+    std::shared_ptr<PipelineEntry> SchedulePipelineEntry(int _index, const std::string &_full_path);
+    void ReadPipelineEntry(PipelineEntry &_entry);
+    void CompressPipelineChunk(PipelineChunk &_chunk,
+                               std::vector<std::byte> _raw,
+                               std::span<const std::byte> _dictionary,
+                               bool _last,
+                               bool _single);
 
     std::string FindSuitableFilename(const std::string &_proposed_arcname) const;
     bool IsEncrypted() const noexcept;
+    bool IsBuiltViaPipeline() const noexcept;
+    bool StoresEAsAsMacMetadata() const noexcept;
+    bool IsAlreadyCompressed(std::string_view _filename) const noexcept;
 
     static ssize_t WriteCallback(struct archive *, void *_client_data, const void *_buffer, size_t _length);
 
@@ -83,9 +108,11 @@ private:
     std::string m_DstRoot;
     VFSHostPtr m_DstVFS;
     std::string m_TargetArchivePath;
-    std::string m_Password;
+    CompressionOptions m_Options;
 
     struct ::archive *m_Archive = nullptr;
+    std::unique_ptr<ZipStreamWriter> m_ZipWriter;
+    std::unique_ptr<Pipeline> m_Pipeline;
     std::shared_ptr<VFSFile> m_TargetFile;
 
     std::unique_ptr<const Source> m_Source;
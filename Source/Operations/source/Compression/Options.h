@@ -0,0 +1,75 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <string>
+
+namespace nc::ops {
+
+enum class CompressionFormat : char {
+    Zip = 0,
+    TarZstd = 1,
+    TarXz = 2,
+    SevenZip = 3
+};
+
+struct CompressionOptions {
+    struct Zip {
+        // deflate compression level, [0..9], 0 means that the files are stored as-is
+        int level = 6;
+
+        // store files which are known to be already compressed (e.g. jpg, mp4, zip) without deflating them
+        bool store_compressed_files = true;
+    };
+
+    struct Zstd {
+        // [1..19]
+        int level = 3;
+
+        // amount of compression threads, 0 means as many as there are CPU cores
+        int threads = 0;
+    };
+
+    struct Xz {
+        // [0..9]
+        int level = 6;
+
+        // amount of compression threads, 0 means as many as there are CPU cores
+        int threads = 0;
+    };
+
+    struct SevenZip {
+        enum class Method : char {
+            LZMA2 = 0,
+            LZMA1 = 1,
+            Deflate = 2,
+            BZip2 = 3,
+            PPMd = 4,
+            Store = 5
+        };
+
+        Method method = Method::LZMA2;
+
+        // [0..9]
+        int level = 6;
+    };
+
+    CompressionOptions() = default;
+    CompressionOptions(std::string _password) noexcept;
+
+    CompressionFormat format = CompressionFormat::Zip;
+
+    // an empty password means that the archive is not encrypted.
+    // only Zip supports encryption, a password for any other format is rejected instead of being ignored.
+    std::string password;
+
+    Zip zip;
+    Zstd zstd;
+    Xz xz;
+    SevenZip seven_zip;
+};
+
+inline CompressionOptions::CompressionOptions(std::string _password) noexcept : password(std::move(_password))
+{
+}
+
+} // namespace nc::ops
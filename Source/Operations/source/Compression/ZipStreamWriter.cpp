@@ -0,0 +1,366 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "ZipStreamWriter.h"
+#include <zlib.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace nc::ops {
+
+static constexpr uint32_t g_LocalHeaderSignature = 0x04034b50;
+static constexpr uint32_t g_DataDescriptorSignature = 0x08074b50;
+static constexpr uint32_t g_CentralHeaderSignature = 0x02014b50;
+static constexpr uint32_t g_EndOfCentralDirectorySignature = 0x06054b50;
+static constexpr uint32_t g_ZIP64EndOfCentralDirectorySignature = 0x06064b50;
+static constexpr uint32_t g_ZIP64EndOfCentralDirectoryLocatorSignature = 0x07064b50;
+static constexpr uint16_t g_ExtraZIP64 = 0x0001;
+static constexpr uint16_t g_ExtraExtendedTimestamp = 0x5455;
+static constexpr uint16_t g_ExtraUnixOwnership = 0x7875;
+static constexpr uint16_t g_FlagLengthAtEnd = 1 << 3;
+static constexpr uint16_t g_FlagUTF8 = 1 << 11;
+static constexpr uint16_t g_VersionMadeBy = (3 << 8) | 45; // UNIX, spec 4.5
+static constexpr uint16_t g_VersionNeededDefault = 20;
+static constexpr uint16_t g_VersionNeededZIP64 = 45;
+static constexpr size_t g_BufferSize = 1024 * 1024;
+
+namespace {
+
+// Little-endian serialization of the ZIP records.
+class Encoder
+{
+public:
+    void U16(uint64_t _v)
+    {
+        for( int i = 0; i < 2; ++i )
+            m_Data.push_back(static_cast<std::byte>((_v >> (8 * i)) & 0xFF));
+    }
+    void U32(uint64_t _v)
+    {
+        for( int i = 0; i < 4; ++i )
+            m_Data.push_back(static_cast<std::byte>((_v >> (8 * i)) & 0xFF));
+    }
+    void U64(uint64_t _v)
+    {
+        for( int i = 0; i < 8; ++i )
+            m_Data.push_back(static_cast<std::byte>((_v >> (8 * i)) & 0xFF));
+    }
+    void Bytes(std::string_view _s)
+    {
+        const auto p = reinterpret_cast<const std::byte *>(_s.data());
+        m_Data.insert(m_Data.end(), p, p + _s.size());
+    }
+    size_t Size() const noexcept { return m_Data.size(); }
+    const std::byte *Data() const noexcept { return m_Data.data(); }
+
+private:
+    std::vector<std::byte> m_Data;
+};
+
+} // namespace
+
+static uint32_t Clamp32(uint64_t _v) noexcept
+{
+    return _v >= ZipStreamWriter::ZIP64Threshold ? 0xFFFFFFFF : static_cast<uint32_t>(_v);
+}
+
+static void ToDOSTime(time_t _time, uint16_t &_dos_time, uint16_t &_dos_date) noexcept
+{
+    struct tm tm;
+    localtime_r(&_time, &tm);
+    if( tm.tm_year < 80 ) { // DOS time starts at 1980
+        _dos_time = 0;
+        _dos_date = (1 << 5) | 1;
+        return;
+    }
+    _dos_time = static_cast<uint16_t>((tm.tm_hour << 11) | (tm.tm_min << 5) | (tm.tm_sec / 2));
+    _dos_date = static_cast<uint16_t>(((tm.tm_year - 80) << 9) | ((tm.tm_mon + 1) << 5) | tm.tm_mday);
+}
+
+ZipStreamWriter::ZipStreamWriter(Sink _sink) : m_Sink(std::move(_sink))
+{
+    if( !m_Sink )
+        throw std::invalid_argument("ZipStreamWriter: a sink must be provided");
+    m_Buffer.reserve(g_BufferSize);
+}
+
+ZipStreamWriter::~ZipStreamWriter() = default;
+
+ZipStreamWriter::CentralRecord ZipStreamWriter::MakeRecord(const EntryInfo &_info, Method _method) const
+{
+    CentralRecord record;
+    record.path = _info.path;
+    record.method = static_cast<uint16_t>(_method);
+    record.flags = g_FlagUTF8;
+    ToDOSTime(_info.mtime, record.dos_time, record.dos_date);
+    record.local_header_offset = m_Offset + m_Buffer.size();
+    record.external_attributes = static_cast<uint32_t>(_info.mode) << 16;
+    if( S_ISDIR(_info.mode) )
+        record.external_attributes |= 0x10; // MS-DOS directory attribute
+    record.mtime = _info.mtime;
+    record.uid = _info.uid;
+    record.gid = _info.gid;
+    return record;
+}
+
+bool ZipStreamWriter::WriteLocalHeader(const CentralRecord &_record, const EntryInfo &_info, bool _length_at_end)
+{
+    Encoder e;
+    e.U32(g_LocalHeaderSignature);
+    e.U16(_record.zip64 ? g_VersionNeededZIP64 : g_VersionNeededDefault);
+    e.U16(_record.flags);
+    e.U16(_record.method);
+    e.U16(_record.dos_time);
+    e.U16(_record.dos_date);
+    e.U32(_length_at_end ? 0 : _record.crc32);
+    if( _record.zip64 ) {
+        e.U32(0xFFFFFFFF);
+        e.U32(0xFFFFFFFF);
+    }
+    else {
+        e.U32(_length_at_end ? 0 : _record.compressed_size);
+        e.U32(_length_at_end ? 0 : _record.uncompressed_size);
+    }
+    e.U16(_record.path.size());
+    e.U16((_record.zip64 ? 20 : 0) + 13 + 15);
+    e.Bytes(_record.path);
+    if( _record.zip64 ) {
+        e.U16(g_ExtraZIP64);
+        e.U16(16);
+        e.U64(_length_at_end ? 0 : _record.uncompressed_size);
+        e.U64(_length_at_end ? 0 : _record.compressed_size);
+    }
+    e.U16(g_ExtraExtendedTimestamp);
+    e.U16(9);
+    e.Bytes("\x03"); // mtime and atime are present
+    e.U32(static_cast<uint32_t>(_info.mtime));
+    e.U32(static_cast<uint32_t>(_info.atime));
+    e.U16(g_ExtraUnixOwnership);
+    e.U16(11);
+    e.Bytes("\x01\x04"); // version 1, 4-byte uid
+    e.U32(_info.uid);
+    e.Bytes("\x04"); // 4-byte gid
+    e.U32(_info.gid);
+    return Put(e.Data(), e.Size());
+}
+
+bool ZipStreamWriter::WriteCompleteEntry(const EntryInfo &_info, std::span<const std::byte> _data, uint32_t _crc32)
+{
+    if( m_Failed || m_InFile )
+        return false;
+    auto record = MakeRecord(_info, Method::Store);
+    record.crc32 = _crc32;
+    record.compressed_size = record.uncompressed_size = _data.size();
+    record.zip64 = _data.size() >= ZIP64Threshold;
+    if( !WriteLocalHeader(record, _info, false) || !Put(_data.data(), _data.size()) )
+        return false;
+    m_Records.emplace_back(std::move(record));
+    return true;
+}
+
+bool ZipStreamWriter::AddDirectory(const EntryInfo &_info)
+{
+    assert(_info.path.empty() || _info.path.back() == '/');
+    return WriteCompleteEntry(_info, {}, 0);
+}
+
+bool ZipStreamWriter::AddSymlink(const EntryInfo &_info, std::string_view _value)
+{
+    const auto data = std::as_bytes(std::span{_value.data(), _value.size()});
+    const auto crc = crc32(0, reinterpret_cast<const Bytef *>(_value.data()), static_cast<uInt>(_value.size()));
+    return WriteCompleteEntry(_info, data, static_cast<uint32_t>(crc));
+}
+
+bool ZipStreamWriter::AddFile(const EntryInfo &_info, std::span<const std::byte> _data)
+{
+    uLong crc = crc32(0, nullptr, 0);
+    for( size_t offset = 0; offset < _data.size(); ) { // crc32() takes only 32-bit lengths
+        const auto chunk = std::min<size_t>(_data.size() - offset, 1 << 30);
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(_data.data() + offset), static_cast<uInt>(chunk));
+        offset += chunk;
+    }
+    return WriteCompleteEntry(_info, _data, static_cast<uint32_t>(crc));
+}
+
+bool ZipStreamWriter::BeginFile(const EntryInfo &_info, Method _method, uint64_t _size_hint)
+{
+    if( m_Failed || m_InFile )
+        return false;
+    auto record = MakeRecord(_info, _method);
+    record.flags |= g_FlagLengthAtEnd;
+    // reserve ZIP64 sizes upfront for big files, with some room for the deflate overhead and the file growing
+    record.zip64 = ReservesZIP64(_size_hint);
+    if( !WriteLocalHeader(record, _info, true) )
+        return false;
+    m_Records.emplace_back(std::move(record));
+    m_InFile = true;
+    return true;
+}
+
+bool ZipStreamWriter::WriteFileData(std::span<const std::byte> _data)
+{
+    if( m_Failed || !m_InFile )
+        return false;
+    m_Records.back().compressed_size += _data.size();
+    return Put(_data.data(), _data.size());
+}
+
+bool ZipStreamWriter::EndFile(uint32_t _crc32, uint64_t _uncompressed_size)
+{
+    if( m_Failed || !m_InFile )
+        return false;
+    m_InFile = false;
+
+    auto &record = m_Records.back();
+    record.crc32 = _crc32;
+    record.uncompressed_size = _uncompressed_size;
+    if( !record.zip64 && (record.compressed_size >= ZIP64Threshold || record.uncompressed_size >= ZIP64Threshold) ) {
+        // the local header has no room for the actual sizes, the archive would be broken
+        m_Failed = true;
+        return false;
+    }
+
+    Encoder e;
+    e.U32(g_DataDescriptorSignature);
+    e.U32(record.crc32);
+    if( record.zip64 ) {
+        e.U64(record.compressed_size);
+        e.U64(record.uncompressed_size);
+    }
+    else {
+        e.U32(record.compressed_size);
+        e.U32(record.uncompressed_size);
+    }
+    return Put(e.Data(), e.Size());
+}
+
+bool ZipStreamWriter::Finish()
+{
+    if( m_Failed || m_InFile )
+        return false;
+
+    const uint64_t cd_offset = m_Offset + m_Buffer.size();
+    for( const auto &record : m_Records ) {
+        const bool big_uncompressed = record.uncompressed_size >= ZIP64Threshold;
+        const bool big_compressed = record.compressed_size >= ZIP64Threshold;
+        const bool big_offset = record.local_header_offset >= ZIP64Threshold;
+        const uint16_t zip64_size = 8 * (int(big_uncompressed) + int(big_compressed) + int(big_offset));
+
+        Encoder e;
+        e.U32(g_CentralHeaderSignature);
+        e.U16(g_VersionMadeBy);
+        e.U16(record.zip64 || zip64_size ? g_VersionNeededZIP64 : g_VersionNeededDefault);
+        e.U16(record.flags);
+        e.U16(record.method);
+        e.U16(record.dos_time);
+        e.U16(record.dos_date);
+        e.U32(record.crc32);
+        e.U32(Clamp32(record.compressed_size));
+        e.U32(Clamp32(record.uncompressed_size));
+        e.U16(record.path.size());
+        e.U16((zip64_size ? 4 + zip64_size : 0) + 9 + 15);
+        e.U16(0); // comment length
+        e.U16(0); // disk number
+        e.U16(0); // internal attributes
+        e.U32(record.external_attributes);
+        e.U32(Clamp32(record.local_header_offset));
+        e.Bytes(record.path);
+        if( zip64_size ) {
+            e.U16(g_ExtraZIP64);
+            e.U16(zip64_size);
+            if( big_uncompressed )
+                e.U64(record.uncompressed_size);
+            if( big_compressed )
+                e.U64(record.compressed_size);
+            if( big_offset )
+                e.U64(record.local_header_offset);
+        }
+        e.U16(g_ExtraExtendedTimestamp);
+        e.U16(5);
+        e.Bytes("\x03"); // the central directory has only mtime, but the flags describe the local header
+        e.U32(static_cast<uint32_t>(record.mtime));
+        e.U16(g_ExtraUnixOwnership);
+        e.U16(11);
+        e.Bytes("\x01\x04");
+        e.U32(record.uid);
+        e.Bytes("\x04");
+        e.U32(record.gid);
+        if( !Put(e.Data(), e.Size()) )
+            return false;
+    }
+    const uint64_t cd_end = m_Offset + m_Buffer.size();
+    const uint64_t cd_size = cd_end - cd_offset;
+    const uint64_t entries = m_Records.size();
+
+    Encoder e;
+    if( entries >= 0xFFFF || cd_offset >= ZIP64Threshold || cd_size >= ZIP64Threshold ) {
+        e.U32(g_ZIP64EndOfCentralDirectorySignature);
+        e.U64(44); // size of the remaining record
+        e.U16(g_VersionMadeBy);
+        e.U16(g_VersionNeededZIP64);
+        e.U32(0); // number of this disk
+        e.U32(0); // disk with the central directory
+        e.U64(entries);
+        e.U64(entries);
+        e.U64(cd_size);
+        e.U64(cd_offset);
+        e.U32(g_ZIP64EndOfCentralDirectoryLocatorSignature);
+        e.U32(0);
+        e.U64(cd_end);
+        e.U32(1); // total number of disks
+    }
+    e.U32(g_EndOfCentralDirectorySignature);
+    e.U16(0);
+    e.U16(0);
+    e.U16(std::min<uint64_t>(entries, 0xFFFF));
+    e.U16(std::min<uint64_t>(entries, 0xFFFF));
+    e.U32(Clamp32(cd_size));
+    e.U32(Clamp32(cd_offset));
+    e.U16(0); // comment length
+    if( !Put(e.Data(), e.Size()) )
+        return false;
+    m_Records.clear();
+    return Flush();
+}
+
+uint64_t ZipStreamWriter::BytesWritten() const noexcept
+{
+    return m_Offset + m_Buffer.size();
+}
+
+bool ZipStreamWriter::Put(const void *_buffer, size_t _size)
+{
+    if( m_Failed )
+        return false;
+    if( m_Buffer.size() + _size > g_BufferSize && !Flush() )
+        return false;
+    if( _size >= g_BufferSize ) {
+        if( !m_Sink(_buffer, _size) ) {
+            m_Failed = true;
+            return false;
+        }
+        m_Offset += _size;
+        return true;
+    }
+    const auto p = static_cast<const std::byte *>(_buffer);
+    m_Buffer.insert(m_Buffer.end(), p, p + _size);
+    return true;
+}
+
+bool ZipStreamWriter::Flush()
+{
+    if( m_Failed )
+        return false;
+    if( m_Buffer.empty() )
+        return true;
+    if( !m_Sink(m_Buffer.data(), m_Buffer.size()) ) {
+        m_Failed = true;
+        return false;
+    }
+    m_Offset += m_Buffer.size();
+    m_Buffer.clear();
+    return true;
+}
+
+} // namespace nc::ops
@@ -0,0 +1,109 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nc::ops {
+
+// ZipStreamWriter produces a ZIP container from entries which are already compressed by the caller.
+// The output is strictly sequential, i.e. the sink is never asked to seek back. Regular files written via
+// BeginFile()/WriteFileData()/EndFile() carry their CRC and sizes in a trailing data descriptor, while the rest of the
+// entries have them in the local headers. ZIP64 records are emitted only when required.
+class ZipStreamWriter
+{
+public:
+    // Must consume the whole buffer, returns false on failure.
+    using Sink = std::function<bool(const void *_buffer, size_t _size)>;
+
+    enum class Method : uint16_t {
+        Store = 0,
+        Deflate = 8
+    };
+
+    struct EntryInfo {
+        std::string path; // relative, directories must have a trailing slash
+        uint16_t mode = 0;
+        time_t mtime = 0;
+        time_t atime = 0;
+        uint32_t uid = 0;
+        uint32_t gid = 0;
+    };
+
+    ZipStreamWriter(Sink _sink);
+    ~ZipStreamWriter();
+
+    // Writes a directory entry, an empty path is allowed for a placeholder entry of an empty archive.
+    bool AddDirectory(const EntryInfo &_info);
+
+    // Writes a symlink entry, the value of the symlink is stored as the entry's data.
+    bool AddSymlink(const EntryInfo &_info, std::string_view _value);
+
+    // Writes a regular file entry with a contents fully available upfront, the data is stored uncompressed.
+    bool AddFile(const EntryInfo &_info, std::span<const std::byte> _data);
+
+    // Starts a regular file entry whose data is fed later via WriteFileData().
+    // _size_hint is used to decide whether ZIP64 sizes have to be reserved for this entry.
+    bool BeginFile(const EntryInfo &_info, Method _method, uint64_t _size_hint);
+
+    // Appends already compressed (or stored) data of the current entry.
+    bool WriteFileData(std::span<const std::byte> _data);
+
+    // Finalizes the current entry with the CRC32 and size of the uncompressed data.
+    bool EndFile(uint32_t _crc32, uint64_t _uncompressed_size);
+
+    // Writes the central directory, the writer can't be used afterwards.
+    bool Finish();
+
+    // Total amount of bytes passed to the sink so far.
+    uint64_t BytesWritten() const noexcept;
+
+    // ZIP entries bigger than this one have to be marked as ZIP64.
+    static constexpr uint64_t ZIP64Threshold = 0xFFFFFFFFull;
+
+    // BeginFile() reserves ZIP64 sizes for the entries whose size hint reaches this one, leaving some room for the
+    // deflate overhead. An entry without the reservation must be kept below it.
+    static constexpr uint64_t ZIP64Reservation = ZIP64Threshold - ZIP64Threshold / 16;
+    static constexpr bool ReservesZIP64(uint64_t _size_hint) noexcept
+    {
+        return _size_hint >= ZIP64Reservation;
+    }
+
+private:
+    struct CentralRecord {
+        std::string path;
+        uint16_t method = 0;
+        uint16_t flags = 0;
+        uint16_t dos_time = 0;
+        uint16_t dos_date = 0;
+        uint32_t crc32 = 0;
+        uint64_t compressed_size = 0;
+        uint64_t uncompressed_size = 0;
+        uint64_t local_header_offset = 0;
+        uint32_t external_attributes = 0;
+        time_t mtime = 0;
+        uint32_t uid = 0;
+        uint32_t gid = 0;
+        bool zip64 = false;
+    };
+
+    bool WriteCompleteEntry(const EntryInfo &_info, std::span<const std::byte> _data, uint32_t _crc32);
+    bool WriteLocalHeader(const CentralRecord &_record, const EntryInfo &_info, bool _length_at_end);
+    bool Put(const void *_buffer, size_t _size);
+    bool Flush();
+    CentralRecord MakeRecord(const EntryInfo &_info, Method _method) const;
+
+    Sink m_Sink;
+    std::vector<std::byte> m_Buffer;
+    std::vector<CentralRecord> m_Records;
+    uint64_t m_Offset = 0;
+    bool m_InFile = false;
+    bool m_Failed = false;
+};
+
+} // namespace nc::ops
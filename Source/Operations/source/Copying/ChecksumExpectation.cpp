@@ -2,25 +2,25 @@
 #include "ChecksumExpectation.h"
 
 #include <algorithm>
+#include <stdexcept>
 
 namespace nc::ops::copying {
 
-ChecksumExpectation::ChecksumExpectation(int _source_ind, std::string _destination, const std::vector<uint8_t> &_md5)
+ChecksumExpectation::ChecksumExpectation(int _source_ind,
+                                         std::string _destination,
+                                         const std::vector<uint8_t> &_source_checksum,
+                                         const std::vector<uint8_t> &_destination_checksum)
     : destination_path(std::move(_destination)), original_item(_source_ind)
 {
-    if( _md5.size() != 16 )
-        throw std::invalid_argument("ChecksumExpectation: _md5 should be 16 bytes long!");
-    std::ranges::copy(_md5, std::begin(md5.buf));
+    if( _source_checksum.size() != Size || _destination_checksum.size() != Size )
+        throw std::invalid_argument("ChecksumExpectation: checksums should be 16 bytes long!");
+    std::ranges::copy(_source_checksum, std::begin(source.buf));
+    std::ranges::copy(_destination_checksum, std::begin(destination.buf));
 }
 
-bool operator==(const ChecksumExpectation &_lhs, const std::vector<uint8_t> &_rhs) noexcept
+bool ChecksumExpectation::Matches() const noexcept
 {
-    return _rhs.size() == 16 && std::equal(std::begin(_rhs), std::end(_rhs), std::begin(_lhs.md5.buf));
-}
-
-bool operator==(const std::vector<uint8_t> &_rhs, const ChecksumExpectation &_lhs) noexcept
-{
-    return _lhs == _rhs;
+    return std::ranges::equal(source.buf, destination.buf);
 }
 
 } // namespace nc::ops::copying
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2018 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include <string>
@@ -7,16 +7,22 @@
 
 namespace nc::ops::copying {
 
+// Checksums of the data read from a source file and of the data written into its destination, both are calculated
+// on the fly while the file is being copied.
 struct ChecksumExpectation {
-    ChecksumExpectation(int _source_ind, std::string _destination, const std::vector<uint8_t> &_md5);
+    static constexpr size_t Size = 16;
+
+    ChecksumExpectation(int _source_ind,
+                        std::string _destination,
+                        const std::vector<uint8_t> &_source_checksum,
+                        const std::vector<uint8_t> &_destination_checksum);
+    bool Matches() const noexcept;
+
     std::string destination_path;
     int original_item;
     struct {
-        uint8_t buf[16];
-    } md5;
+        uint8_t buf[Size];
+    } source, destination;
 };
 
-bool operator==(const ChecksumExpectation &_lhs, const std::vector<uint8_t> &_rhs) noexcept;
-bool operator==(const std::vector<uint8_t> &_rhs, const ChecksumExpectation &_lhs) noexcept;
-
 } // namespace nc::ops::copying
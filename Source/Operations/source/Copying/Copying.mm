@@ -6,14 +6,38 @@
 #include "../GenericErrorDialog.h"
 #include "FileAlreadyExistDialog.h"
 #include "CopyingTitleBuilder.h"
+#include <Utility/NativeFSManager.h>
+#include <VFS/Native.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <memory>
+#include <span>
 
 namespace nc::ops {
 
 using CB = CopyingJobCallbacks;
 
+// Moving within the same native volume or within the same non-native host is merely renaming, as done by CopyingJob.
+// The scheduling devices can't tell that, e.g. the APFS volumes of the same container share a device.
+static bool IsRenaming(std::span<const VFSListingItem> _items,
+                       const std::string &_destination_path,
+                       const VFSHost &_destination_host)
+{
+    if( const auto native = dynamic_cast<const vfs::NativeHost *>(&_destination_host) ) {
+        // the volumes are looked up by the path strings only, there's no I/O involved
+        const auto &fs_man = native->NativeFSManager();
+        const auto destination_volume = fs_man.VolumeFromPathFast(_destination_path);
+        if( !destination_volume )
+            return false;
+        return std::ranges::all_of(_items, [&](const VFSListingItem &_item) {
+            return _item.Host()->IsNativeFS() && fs_man.VolumeFromPathFast(_item.Directory()) == destination_volume;
+        });
+    }
+    return std::ranges::all_of(_items,
+                               [&](const VFSListingItem &_item) { return _item.Host().get() == &_destination_host; });
+}
+
 Copying::Copying(std::vector<VFSListingItem> _source_files,
                  const std::string &_destination_path,
                  const std::shared_ptr<VFSHost> &_destination_host,
@@ -22,6 +46,13 @@ Copying::Copying(std::vector<VFSListingItem> _source_files,
     m_ExistBehavior = _options.exist_behavior;
     m_LockedBehaviour = _options.locked_items_behaviour;
 
+    struct SchedulingProfile profile;
+    profile.AddDevices(_source_files);
+    profile.AddDevice(*_destination_host, _destination_path);
+    const bool renaming = !_options.docopy && IsRenaming(_source_files, _destination_path, *_destination_host);
+    profile.kind = renaming ? SchedulingProfile::Kind::Interactive : SchedulingProfile::Classify(_source_files);
+    SetSchedulingProfile(std::move(profile));
+
     m_Job = std::make_unique<CopyingJob>(_source_files, _destination_path, _destination_host, _options);
     SetupCallbacks();
     OnStageChanged();
@@ -47,6 +47,7 @@ static std::string MakeCanonicPath(std::string _input)
 @property(strong, nonatomic) IBOutlet NSButton *CopyFileTimesCheckbox;
 @property(strong, nonatomic) IBOutlet NSButton *CopyUNIXFlagsCheckbox;
 @property(strong, nonatomic) IBOutlet NSButton *CopyUnixOwnersCheckbox;
+@property(strong, nonatomic) IBOutlet NSButton *OverwriteChangedBlocksOnlyCheckbox;
 @property(strong, nonatomic) IBOutlet NSButton *CopyButtonStringStub;
 @property(strong, nonatomic) IBOutlet NSButton *RenameButtonStringStub;
 @property(nonatomic) bool isValidInput;
@@ -84,6 +85,7 @@ static std::string MakeCanonicPath(std::string _input)
 @synthesize CopyFileTimesCheckbox;
 @synthesize CopyUNIXFlagsCheckbox;
 @synthesize CopyUnixOwnersCheckbox;
+@synthesize OverwriteChangedBlocksOnlyCheckbox;
 @synthesize CopyButtonStringStub;
 @synthesize RenameButtonStringStub;
 @synthesize isValidInput;
@@ -168,6 +170,8 @@ static std::string MakeCanonicPath(std::string _input)
         self.CopyButton.title = self.RenameButtonStringStub.title;
     }
     [self.VerifySetting selectItemWithTag:static_cast<int>(m_Options.verification)];
+    self.OverwriteChangedBlocksOnlyCheckbox.state =
+        m_Options.overwrite_changed_blocks_only ? NSControlStateValueOn : NSControlStateValueOff;
 }
 
 - (IBAction)OnCopy:(id) [[maybe_unused]] _sender
@@ -233,6 +237,7 @@ static std::string MakeCanonicPath(std::string _input)
     m_Options.copy_file_times = self.CopyFileTimesCheckbox.state == NSControlStateValueOn;
     m_Options.copy_unix_flags = self.CopyUNIXFlagsCheckbox.state == NSControlStateValueOn;
     m_Options.copy_unix_owners = self.CopyUnixOwnersCheckbox.state == NSControlStateValueOn;
+    m_Options.overwrite_changed_blocks_only = self.OverwriteChangedBlocksOnlyCheckbox.state == NSControlStateValueOn;
     m_Options.verification = static_cast<CopyingOptions::ChecksumVerification>(self.VerifySetting.selectedTag);
 }
 
@@ -3,6 +3,7 @@
 #include "../Statistics.h"
 #include "Helpers.h"
 #include "NativeFSHelpers.h"
+#include <Base/CommonPaths.h>
 #include <Base/Hash.h>
 #include <Base/algo.h>
 #include <RoutedIO/RoutedIO.h>
@@ -31,10 +32,37 @@ static constexpr mode_t g_NewDirectoryMode = S_IRUSR | S_IXUSR | S_IWUSR | // Us
 // A bitmask of flags that have a meaning when passed to chmod()
 static constexpr mode_t g_ChModMask = S_IRWXU | S_IRWXG | S_IRWXO | S_ISUID | S_ISGID | S_ISVTX;
 
+// How often the progress of copying a file is recorded in the journal
+static constexpr uint64_t g_JournalCheckpointBytes = 64 * 1024 * 1024;
+
+// The journals of the operations which weren't re-run for this long are deleted
+static constexpr std::chrono::seconds g_JournalMaxAge = std::chrono::days{7};
+
+// Granularity of comparing the source and the destination when only the changed blocks are rewritten
+static constexpr uint64_t g_DeltaBlockSize = 64 * 1024;
+
 // return true if _1st is older than _2nd
 static bool EntryIsOlder(const struct stat &_1st, const struct stat &_2nd);
 static bool EntryIsOlder(const VFSStat &_1st, const VFSStat &_2nd);
 
+static bool IsEarlier(const timespec &_1st, const timespec &_2nd) noexcept
+{
+    return _1st.tv_sec < _2nd.tv_sec || (_1st.tv_sec == _2nd.tv_sec && _1st.tv_nsec < _2nd.tv_nsec);
+}
+
+static TransferJournal::DestinationIdentity DestinationIdentity(const struct stat &_st) noexcept
+{
+    return {static_cast<uint64_t>(_st.st_ino), _st.st_mtimespec};
+}
+
+static TransferJournal::DestinationIdentity DestinationIdentity(int _fd) noexcept
+{
+    struct stat st;
+    if( fstat(_fd, &st) != 0 )
+        return {};
+    return DestinationIdentity(st);
+}
+
 CopyingJob::CopyingJob(std::vector<VFSListingItem> _source_items,
                        const std::string &_dest_path,
                        const VFSHostPtr &_dest_host,
@@ -49,6 +77,14 @@ CopyingJob::CopyingJob(std::vector<VFSListingItem> _source_items,
         throw std::invalid_argument(msg);
     }
     m_Options = _opts;
+    if( !m_Options.source_root.empty() ) {
+        m_Options.source_root = EnsureTrailingSlash(m_Options.source_root);
+        for( const auto &item : m_VFSListingItems )
+            if( !item.Directory().starts_with(m_Options.source_root) ) {
+                const auto msg = "CopyingJob::CopyingJob(): source items should reside below the source root";
+                throw std::invalid_argument(msg);
+            }
+    }
     m_IsSingleInitialItemProcessing = m_VFSListingItems.size() == 1;
 
     if( m_VFSListingItems.empty() )
@@ -114,6 +150,11 @@ void CopyingJob::Perform()
             return;
         }
         m_DestinationNativeFSInfo = fs_info;
+
+        // a journal left by an interrupted run of the same operation lets to continue from where it has stopped
+        const std::filesystem::path journals_dir = base::CommonPaths::AppTemporaryDirectory();
+        TransferJournal::RemoveExpired(journals_dir, g_JournalMaxAge);
+        m_Journal = std::make_unique<TransferJournal>(TransferJournal::PathFor(journals_dir, ComposeJournalKey()));
     }
 
     auto [scan_result, source_db] = ScanSourceItems();
@@ -126,8 +167,15 @@ void CopyingJob::Perform()
 
     ProcessItems();
 
-    if( BlockIfPaused(); IsStopped() )
+    if( BlockIfPaused(); IsStopped() ) {
+        // a cancelled operation has removed its partial files, so there's nothing left to continue from
+        if( m_Journal && !IsInterrupted() )
+            m_Journal->Remove();
         return;
+    }
+
+    if( m_Journal )
+        m_Journal->Remove();
 
     SetStage(Stage::Default);
 }
@@ -163,10 +211,8 @@ void CopyingJob::ProcessItems()
     bool all_matched = true;
     if( !m_Checksums.empty() ) {
         SetStage(Stage::Verify);
-        for( auto &item : m_Checksums ) {
-            bool matched = false;
-            auto step_result = VerifyCopiedFile(item, matched);
-            if( step_result != StepResult::Ok || matched != true ) {
+        for( const auto &item : m_Checksums ) {
+            if( !item.Matches() ) {
                 m_OnFileVerificationFailed(item.destination_path, *m_DestinationHost);
                 all_matched = false;
             }
@@ -210,30 +256,57 @@ CopyingJob::StepResult CopyingJob::ProcessItemNo(int _item_number)
         /////////////////////////////////////////////////////////////////////////////////////////////////
         // Regular files
         /////////////////////////////////////////////////////////////////////////////////////////////////
-        std::optional<base::Hash> hash; // this optional will be filled with the first call of hash_feedback
-        auto hash_feedback = [&](const void *_data, unsigned _sz) {
-            if( !hash )
-                hash.emplace(base::Hash::MD5);
-            hash->Feed(_data, _sz);
+        // these optionals will be filled with the first calls of the feedbacks.
+        // the source and the destination checksums are calculated on the fly in two different threads, so verifying
+        // the copied file doesn't require reading it once again.
+        std::optional<base::Hash> source_hash;
+        std::optional<base::Hash> destination_hash;
+        DataFeedback source_data_feedback = nullptr;
+        DataFeedback destination_data_feedback = nullptr;
+        if( m_Options.verification == ChecksumVerification::Always ||
+            (!m_Options.docopy && m_Options.verification >= ChecksumVerification::WhenMoves) ) {
+            source_data_feedback = [&](const void *_data, unsigned _sz) {
+                if( !source_hash )
+                    source_hash.emplace(base::Hash::XXH3_128);
+                source_hash->Feed(_data, _sz);
+            };
+            destination_data_feedback = [&](const void *_data, unsigned _sz) {
+                if( !destination_hash )
+                    destination_hash.emplace(base::Hash::XXH3_128);
+                destination_hash->Feed(_data, _sz);
+            };
+        }
+        const auto compose_checksums = [&]() -> std::optional<ChecksumExpectation> {
+            if( !source_hash )
+                return std::nullopt;
+            auto destination_checksum = destination_hash ? destination_hash->Final()
+                                                         : base::Hash(base::Hash::XXH3_128).Final();
+            return ChecksumExpectation(_item_number, destination_path, source_hash->Final(), destination_checksum);
         };
-
-        std::function<void(const void *_data, unsigned _sz)> data_feedback = nullptr;
-        if( m_Options.verification == ChecksumVerification::Always )
-            data_feedback = hash_feedback;
-        else if( !m_Options.docopy && m_Options.verification >= ChecksumVerification::WhenMoves )
-            data_feedback = hash_feedback;
+        bool is_journaled = false; // true if the progress of copying this file is recorded in the journal
 
         if( source_host.IsNativeFS() && m_IsDestinationHostNative ) { // native -> native ///////////////////////
             // native fs processing
-            if( m_Options.docopy ) { // copy
+            const bool is_rename = !m_Options.docopy && is_same_native_volume();
+            is_journaled = !is_rename;
+            if( !is_rename && IsCompletedInJournal(source_path, destination_path, source_data_feedback != nullptr) ) {
+                // this file was already copied by an interrupted run of the same operation
+                is_journaled = false;
+                step_result = StepResult::Ok;
+                Statistics().CommitProcessed(Statistics::SourceType::Bytes, source_size);
+                if( !m_Options.docopy )
+                    m_SourceItemsToDelete.emplace_back(_item_number); // mark source file for deletion
+            }
+            else if( m_Options.docopy ) { // copy
                 step_result = CopyNativeFileToNativeFile(dynamic_cast<vfs::NativeHost &>(source_host),
                                                          source_path,
                                                          destination_path,
-                                                         data_feedback,
+                                                         source_data_feedback,
+                                                         destination_data_feedback,
                                                          nonexistent_dst_req_handler);
             }
             else {
-                if( is_same_native_volume() ) { // rename
+                if( is_rename ) { // rename
                     step_result = RenameNativeFile(dynamic_cast<vfs::NativeHost &>(source_host),
                                                    source_path,
                                                    destination_path,
@@ -245,7 +318,8 @@ CopyingJob::StepResult CopyingJob::ProcessItemNo(int _item_number)
                     step_result = CopyNativeFileToNativeFile(dynamic_cast<vfs::NativeHost &>(source_host),
                                                              source_path,
                                                              destination_path,
-                                                             data_feedback,
+                                                             source_data_feedback,
+                                                             destination_data_feedback,
                                                              nonexistent_dst_req_handler);
                     if( step_result == StepResult::Ok )
                         m_SourceItemsToDelete.emplace_back(_item_number); // mark source file for deletion
@@ -258,7 +332,8 @@ CopyingJob::StepResult CopyingJob::ProcessItemNo(int _item_number)
                                                   source_path,
                                                   dynamic_cast<vfs::NativeHost &>(*m_DestinationHost),
                                                   destination_path,
-                                                  data_feedback,
+                                                  source_data_feedback,
+                                                  destination_data_feedback,
                                                   nonexistent_dst_req_handler);
             if( m_Options.docopy == false ) { // move
                 if( step_result == StepResult::Ok )
@@ -268,8 +343,12 @@ CopyingJob::StepResult CopyingJob::ProcessItemNo(int _item_number)
         else {                       // vfs -> vfs
                                      // /////////////////////////////////////////////////////////////////////////////
             if( m_Options.docopy ) { // copy
-                step_result = CopyVFSFileToVFSFile(
-                    source_host, source_path, destination_path, data_feedback, nonexistent_dst_req_handler);
+                step_result = CopyVFSFileToVFSFile(source_host,
+                                                   source_path,
+                                                   destination_path,
+                                                   source_data_feedback,
+                                                   destination_data_feedback,
+                                                   nonexistent_dst_req_handler);
             }
             else {                                              // move
                 if( &source_host == m_DestinationHost.get() ) { // rename
@@ -280,8 +359,12 @@ CopyingJob::StepResult CopyingJob::ProcessItemNo(int _item_number)
                         Statistics().CommitProcessed(Statistics::SourceType::Bytes, source_size);
                 }
                 else { // move
-                    step_result = CopyVFSFileToVFSFile(
-                        source_host, source_path, destination_path, data_feedback, nonexistent_dst_req_handler);
+                    step_result = CopyVFSFileToVFSFile(source_host,
+                                                       source_path,
+                                                       destination_path,
+                                                       source_data_feedback,
+                                                       destination_data_feedback,
+                                                       nonexistent_dst_req_handler);
                     if( step_result == StepResult::Ok )
                         m_SourceItemsToDelete.emplace_back(_item_number); // mark source file for deletion
                 }
@@ -289,8 +372,11 @@ CopyingJob::StepResult CopyingJob::ProcessItemNo(int _item_number)
         }
 
         // check step result?
-        if( hash )
-            m_Checksums.emplace_back(_item_number, destination_path, hash->Final());
+        const auto checksums = compose_checksums();
+        if( is_journaled && step_result == StepResult::Ok )
+            RecordCompletionInJournal(source_path, destination_path, checksums);
+        if( checksums )
+            m_Checksums.emplace_back(*checksums);
     }
     else if( S_ISDIR(source_mode) )
         step_result = ProcessDirectoryItem(source_host, source_path, _item_number, destination_path);
@@ -583,7 +669,8 @@ std::tuple<CopyingJob::StepResult, SourceItems> CopyingJob::ScanSourceItems()
 
         auto host_indx = db.InsertOrFindHost(i.Host());
         auto &host = db.Host(host_indx);
-        auto base_dir_indx = db.InsertOrFindBaseDir(i.Directory());
+        const bool relative_to_root = !m_Options.source_root.empty();
+        auto base_dir_indx = db.InsertOrFindBaseDir(relative_to_root ? m_Options.source_root : i.Directory());
         std::function<StepResult(int _parent_ind,
                                  const std::string &_full_relative_path,
                                  const std::string &_item_name)> // need function holder for recursion to work
@@ -680,7 +767,12 @@ std::tuple<CopyingJob::StepResult, SourceItems> CopyingJob::ScanSourceItems()
             return StepResult::Ok;
         };
 
-        auto result = scan_item(-1, i.Filename(), i.Filename());
+        // the items below the source root are named by their relative paths, e.g. "dir/file.txt", which the
+        // destination paths are composed of
+        const std::string name = relative_to_root
+                                     ? i.Directory().substr(m_Options.source_root.length()).append(i.Filename())
+                                     : i.Filename();
+        auto result = scan_item(-1, name, name);
         if( result != StepResult::Ok )
             return {result, {}};
     }
@@ -688,6 +780,145 @@ std::tuple<CopyingJob::StepResult, SourceItems> CopyingJob::ScanSourceItems()
     return {StepResult::Ok, std::move(db)};
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// rewriting the changed blocks of an existing native file
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CopyingJob::StepResult CopyingJob::CopyChangedBlocksToNativeFile(const SourceReader &_read_source,
+                                                                 uint64_t _source_size,
+                                                                 VFSHost &_src_host,
+                                                                 const std::string &_src_path,
+                                                                 int _dst_fd,
+                                                                 uint64_t _dst_size,
+                                                                 vfs::NativeHost &_dst_host,
+                                                                 const std::string &_dst_path,
+                                                                 const DataFeedback &_source_data_feedback,
+                                                                 const DataFeedback &_destination_data_feedback)
+{
+    auto source_buffer = m_Buffers[0].get(), destination_buffer = m_Buffers[1].get();
+    constexpr int max_io_loops = 5; // looked in Apple's copyfile() - treat 5 zero-resulting reads/writes as an error
+    const uint64_t comparable_size = std::min(_source_size, _dst_size);
+    uint64_t offset = 0;
+
+    while( offset < _source_size ) {
+        // check user decided to pause operation or discard it
+        if( BlockIfPaused(); IsStopped() )
+            return StepResult::Stop;
+
+        const uint64_t chunk = std::min(static_cast<uint64_t>(m_BufferSize), _source_size - offset);
+        const uint64_t comparable = offset < comparable_size ? std::min(chunk, comparable_size - offset) : 0;
+
+        // <<<--- reading the destination in secondary thread --->>>
+        std::optional<StepResult> dst_read_return; // optional storage for error returning
+        m_IOGroup.Run([&] {
+            const ScopedIOPriority io_priority{IOPriority()};
+            uint64_t has_read = 0;
+            while( has_read < comparable ) {
+                const ssize_t read_result =
+                    pread(_dst_fd, destination_buffer + has_read, comparable - has_read, offset + has_read);
+                if( read_result > 0 ) {
+                    has_read += read_result;
+                    continue;
+                }
+                const int vfs_error =
+                    read_result < 0 ? VFSError::FromErrno() : static_cast<int>(VFSError::UnexpectedEOF);
+                switch( m_OnDestinationFileReadError(vfs_error, _dst_path, _dst_host) ) {
+                    case DestinationFileReadErrorResolution::Skip:
+                        dst_read_return = StepResult::Skipped;
+                        return;
+                    case DestinationFileReadErrorResolution::Stop:
+                        dst_read_return = StepResult::Stop;
+                        return;
+                }
+            }
+        });
+
+        // <<<--- reading the source in current thread --->>>
+        std::optional<StepResult> read_return; // optional storage for error returning
+        uint64_t has_read = 0;
+        int read_loops = 0; // amount of zero-resulting reads
+        while( has_read < chunk ) {
+            const ssize_t read_result = _read_source(source_buffer + has_read, chunk - has_read);
+            if( read_result > 0 ) {
+                if( _source_data_feedback )
+                    _source_data_feedback(source_buffer + has_read, static_cast<unsigned>(read_result));
+                has_read += read_result;
+            }
+            else if( (read_result < 0) || (++read_loops > max_io_loops) ) {
+                const int vfs_error = read_result < 0 ? static_cast<int>(read_result) : VFSError::UnexpectedEOF;
+                switch( m_OnSourceFileReadError(vfs_error, _src_path, _src_host) ) {
+                    case SourceFileReadErrorResolution::Skip:
+                        read_return = StepResult::Skipped;
+                        break;
+                    case SourceFileReadErrorResolution::Stop:
+                        read_return = StepResult::Stop;
+                        break;
+                    case SourceFileReadErrorResolution::Retry:
+                        continue;
+                }
+                break;
+            }
+        }
+
+        m_IOGroup.Wait();
+
+        // if something bad happened in reading - return from this routine
+        if( dst_read_return )
+            return *dst_read_return;
+        if( read_return )
+            return *read_return;
+        ThrottleIO(has_read + comparable);
+
+        // compare the chunks block by block and write down the runs of differing blocks
+        const auto block_is_same = [&](uint64_t _pos) {
+            const uint64_t size = std::min(g_DeltaBlockSize, chunk - _pos);
+            return _pos + size <= comparable && memcmp(source_buffer + _pos, destination_buffer + _pos, size) == 0;
+        };
+        for( uint64_t pos = 0; pos < chunk; ) {
+            if( block_is_same(pos) ) {
+                const uint64_t size = std::min(g_DeltaBlockSize, chunk - pos);
+                if( _destination_data_feedback )
+                    _destination_data_feedback(destination_buffer + pos, static_cast<unsigned>(size));
+                pos += size;
+                continue;
+            }
+
+            uint64_t run_end = std::min(pos + g_DeltaBlockSize, chunk);
+            while( run_end < chunk && !block_is_same(run_end) )
+                run_end = std::min(run_end + g_DeltaBlockSize, chunk);
+
+            uint64_t has_written = 0;
+            int write_loops = 0;
+            while( pos + has_written < run_end ) {
+                const ssize_t n_written = pwrite(
+                    _dst_fd, source_buffer + pos + has_written, run_end - pos - has_written, offset + pos + has_written);
+                if( n_written > 0 ) {
+                    Statistics().CommitWritten(n_written);
+                    if( _destination_data_feedback )
+                        _destination_data_feedback(source_buffer + pos + has_written,
+                                                   static_cast<unsigned>(n_written));
+                    has_written += n_written;
+                }
+                else if( n_written < 0 || (++write_loops > max_io_loops) ) {
+                    switch( m_OnDestinationFileWriteError(VFSError::FromErrno(), _dst_path, _dst_host) ) {
+                        case DestinationFileWriteErrorResolution::Skip:
+                            return StepResult::Skipped;
+                        case DestinationFileWriteErrorResolution::Stop:
+                            return StepResult::Stop;
+                        case DestinationFileWriteErrorResolution::Retry:
+                            continue;
+                    }
+                }
+            }
+            pos = run_end;
+        }
+
+        Statistics().CommitProcessed(Statistics::SourceType::Bytes, chunk);
+        offset += chunk;
+    }
+    return StepResult::Ok;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // native file -> native file copying routine
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -712,7 +943,8 @@ static void TurnIntoBlockingOrThrow(const int _fd)
 CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_native_host,
                                                               const std::string &_src_path,
                                                               const std::string &_dst_path,
-                                                              const SourceDataFeedback &_source_data_feedback,
+                                                              const DataFeedback &_source_data_feedback,
+                                                              const DataFeedback &_destination_data_feedback,
                                                               const RequestNonexistentDst &_new_dst_callback)
 {
     auto &io = routedio::RoutedIO::Default;
@@ -771,10 +1003,15 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
     }
     auto &src_fs_info = *src_fs_info_holder;
 
+    // the journal may tell that this file was partially copied by an interrupted run of the same operation
+    const TransferJournal::SourceIdentity source_identity{static_cast<uint64_t>(src_stat_buffer.st_size),
+                                                          src_stat_buffer.st_mtimespec};
+    uint64_t resume_offset = 0;
+
     // setting up copying scenario
     int dst_open_flags = 0;
     bool do_erase_xattrs = false, do_copy_xattrs = true, do_unlink_on_stop = false, do_set_times = true,
-         do_set_unix_flags = true, need_dst_truncate = false;
+         do_set_unix_flags = true, need_dst_truncate = false, do_journal = m_Journal != nullptr, do_delta = false;
     int64_t dst_size_on_stop = 0, total_dst_size = src_stat_buffer.st_size, preallocate_delta = 0,
             initial_writing_offset = 0;
 
@@ -790,7 +1027,8 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
     if( io.stat(_dst_path.c_str(), &dst_stat_buffer) != -1 ) {
         // file already exist. what should we do now?
         const auto setup_overwrite = [&] {
-            dst_open_flags = O_WRONLY;
+            do_delta = m_Options.overwrite_changed_blocks_only && dst_stat_buffer.st_size > 0;
+            dst_open_flags = do_delta ? O_RDWR : O_WRONLY;
             do_unlink_on_stop = true;
             dst_size_on_stop = 0;
             do_erase_xattrs = true;
@@ -807,28 +1045,50 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
             total_dst_size += dst_stat_buffer.st_size;
             initial_writing_offset = dst_stat_buffer.st_size;
             preallocate_delta = src_stat_buffer.st_size;
+            do_journal = false; // the written bytes don't start at the beginning of the destination
+        };
+        const auto setup_resume = [&](uint64_t _offset) {
+            dst_open_flags = O_RDWR; // the already copied part might be read back to calculate the checksums
+            do_unlink_on_stop = true;
+            dst_size_on_stop = 0;
+            preallocate_delta = src_stat_buffer.st_size - dst_stat_buffer.st_size; // negative value is ok here
+            need_dst_truncate = src_stat_buffer.st_size < dst_stat_buffer.st_size;
+            initial_writing_offset = _offset;
+            resume_offset = _offset;
         };
 
-        const auto res = m_OnCopyDestinationAlreadyExists(src_stat_buffer, dst_stat_buffer, _dst_path);
-        switch( res ) {
-            case CopyDestExistsResolution::Skip:
-                return StepResult::Skipped;
-            case CopyDestExistsResolution::OverwriteOld:
-                if( !EntryIsOlder(dst_stat_buffer, src_stat_buffer) )
+        // the destination has to be the very file which was written, it's modified afterwards only if the previous
+        // run has crashed after a checkpoint
+        const auto journaled = m_Journal ? m_Journal->Find(_dst_path) : nullptr;
+        if( journaled && !journaled->finished && journaled->completed > 0 && journaled->source == source_identity &&
+            journaled->destination.inode == static_cast<uint64_t>(dst_stat_buffer.st_ino) &&
+            !IsEarlier(dst_stat_buffer.st_mtimespec, journaled->destination.mtime) &&
+            static_cast<uint64_t>(dst_stat_buffer.st_size) >= journaled->completed ) {
+            // the destination is what has left from the previous attempt - continue writing it
+            setup_resume(journaled->completed);
+        }
+        else {
+            const auto res = m_OnCopyDestinationAlreadyExists(src_stat_buffer, dst_stat_buffer, _dst_path);
+            switch( res ) {
+                case CopyDestExistsResolution::Skip:
                     return StepResult::Skipped;
-                [[fallthrough]];
-            case CopyDestExistsResolution::Overwrite:
-                setup_overwrite();
-                break;
-            case CopyDestExistsResolution::Append:
-                setup_append();
-                break;
-            case CopyDestExistsResolution::KeepBoth:
-                _new_dst_callback();
-                setup_new();
-                break;
-            default:
-                return StepResult::Stop;
+                case CopyDestExistsResolution::OverwriteOld:
+                    if( !EntryIsOlder(dst_stat_buffer, src_stat_buffer) )
+                        return StepResult::Skipped;
+                    [[fallthrough]];
+                case CopyDestExistsResolution::Overwrite:
+                    setup_overwrite();
+                    break;
+                case CopyDestExistsResolution::Append:
+                    setup_append();
+                    break;
+                case CopyDestExistsResolution::KeepBoth:
+                    _new_dst_callback();
+                    setup_new();
+                    break;
+                default:
+                    return StepResult::Stop;
+            }
         }
     }
     else {
@@ -862,9 +1122,20 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
         }
     });
 
+    // amount of bytes which the journal knows to be written into the destination
+    uint64_t journaled_bytes = resume_offset;
+
     // for some circumstances we have to clean up remains if anything goes wrong
     // and do it BEFORE close_destination fires
     auto clean_destination = at_scope_end([&] {
+        if( destination_fd != -1 && journaled_bytes > 0 && IsInterrupted() ) {
+            // keep the journaled part so that a re-run of the operation could continue from there.
+            // a cancelled operation removes the destination as usual instead of leaving a truncated file behind.
+            ftruncate(destination_fd, journaled_bytes);
+            m_Journal->Progress(_dst_path, source_identity, DestinationIdentity(destination_fd), journaled_bytes);
+            close(destination_fd);
+            destination_fd = -1;
+        }
         if( destination_fd != -1 ) {
             // we need to revert what we've done
             ftruncate(destination_fd, dst_size_on_stop);
@@ -929,6 +1200,34 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
         }
     }
 
+    // skip the part of the source which was copied before
+    if( resume_offset > 0 ) {
+        // the checksums have to cover the whole file, thus the copied part is read back from both sides
+        if( const auto rc = FeedNativeFilePrefix(
+                source_fd, resume_offset, _src_path, _native_host, false, _source_data_feedback);
+            rc != StepResult::Ok )
+            return rc;
+        if( const auto rc = FeedNativeFilePrefix(
+                destination_fd, resume_offset, _dst_path, _native_host, true, _destination_data_feedback);
+            rc != StepResult::Ok )
+            return rc;
+
+        while( true ) {
+            const auto rc = lseek(source_fd, resume_offset, SEEK_SET);
+            if( rc >= 0 )
+                break;
+            switch( m_OnSourceFileReadError(VFSError::FromErrno(), _src_path, _native_host) ) {
+                case SourceFileReadErrorResolution::Skip:
+                    return StepResult::Skipped;
+                case SourceFileReadErrorResolution::Stop:
+                    return StepResult::Stop;
+                case SourceFileReadErrorResolution::Retry:
+                    continue;
+            }
+        }
+        Statistics().CommitProcessed(Statistics::SourceType::Bytes, resume_offset);
+    }
+
     auto read_buffer = m_Buffers[0].get(), write_buffer = m_Buffers[1].get();
     const uint32_t src_preferred_io_size =
         src_fs_info.basic.io_size < m_BufferSize ? src_fs_info.basic.io_size : m_BufferSize;
@@ -936,8 +1235,29 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
         dst_fs_info.basic.io_size < m_BufferSize ? dst_fs_info.basic.io_size : m_BufferSize;
     constexpr int max_io_loops = 5; // looked in Apple's copyfile() - treat 5 zero-resulting reads/writes as an error
     uint32_t bytes_to_write = 0;
-    uint64_t source_bytes_read = 0;
-    uint64_t destination_bytes_written = 0;
+    uint64_t source_bytes_read = resume_offset;
+    uint64_t destination_bytes_written = resume_offset;
+
+    if( do_delta ) {
+        // rewrite only the changed blocks, thus leaving nothing to do for the regular copying below
+        const auto read_source = [source_fd](void *_buffer, size_t _size) -> ssize_t {
+            const ssize_t rc = read(source_fd, _buffer, _size);
+            return rc < 0 ? VFSError::FromErrno() : rc;
+        };
+        const auto rc = CopyChangedBlocksToNativeFile(read_source,
+                                                      src_stat_buffer.st_size,
+                                                      _native_host,
+                                                      _src_path,
+                                                      destination_fd,
+                                                      dst_stat_buffer.st_size,
+                                                      _native_host,
+                                                      _dst_path,
+                                                      _source_data_feedback,
+                                                      _destination_data_feedback);
+        if( rc != StepResult::Ok )
+            return rc;
+        source_bytes_read = destination_bytes_written = src_stat_buffer.st_size;
+    }
 
     // read from source within current thread and write to destination within secondary queue
     while( static_cast<uint64_t>(src_stat_buffer.st_size) != destination_bytes_written ) {
@@ -955,8 +1275,10 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
                        dst_preferred_io_size,
                        &destination_bytes_written,
                        &write_return,
+                       &_destination_data_feedback,
                        &_dst_path,
                        &_native_host] {
+            const ScopedIOPriority io_priority{IOPriority()};
             uint32_t left_to_write = bytes_to_write;
             uint32_t has_written = 0; // amount of bytes written into destination this time
             int write_loops = 0;
@@ -964,6 +1286,9 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
                 const int64_t n_written =
                     write(destination_fd, write_buffer + has_written, std::min(left_to_write, dst_preferred_io_size));
                 if( n_written > 0 ) {
+                    Statistics().CommitWritten(n_written);
+                    if( _destination_data_feedback )
+                        _destination_data_feedback(write_buffer + has_written, static_cast<unsigned>(n_written));
                     has_written += n_written;
                     left_to_write -= n_written;
                     destination_bytes_written += n_written;
@@ -1025,6 +1350,15 @@ CopyingJob::StepResult CopyingJob::CopyNativeFileToNativeFile(vfs::NativeHost &_
             return *read_return;
 
         Statistics().CommitProcessed(Statistics::SourceType::Bytes, bytes_to_write);
+        ThrottleIO(has_read);
+
+        // record the progress, the data is flushed beforehand so that the journal never claims more than was stored
+        if( do_journal && destination_bytes_written - journaled_bytes >= g_JournalCheckpointBytes ) {
+            fsync(destination_fd);
+            m_Journal->Progress(
+                _dst_path, source_identity, DestinationIdentity(destination_fd), destination_bytes_written);
+            journaled_bytes = destination_bytes_written;
+        }
 
         // swap buffers ang go again
         bytes_to_write = has_read;
@@ -1087,7 +1421,8 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToNativeFile(VFSHost &_src_vfs,
                                                            const std::string &_src_path,
                                                            vfs::NativeHost &_dst_host,
                                                            const std::string &_dst_path,
-                                                           const SourceDataFeedback &_source_data_feedback,
+                                                           const DataFeedback &_source_data_feedback,
+                                                           const DataFeedback &_destination_data_feedback,
                                                            const RequestNonexistentDst &_new_dst_callback)
 {
     auto &io = routedio::RoutedIO::Default;
@@ -1143,7 +1478,7 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToNativeFile(VFSHost &_src_vfs,
     // setting up the copying scenario
     int dst_open_flags = 0;
     bool do_erase_xattrs = false, do_copy_xattrs = true, do_unlink_on_stop = false, do_set_times = true,
-         do_set_unix_flags = true, need_dst_truncate = false;
+         do_set_unix_flags = true, need_dst_truncate = false, do_delta = false;
     int64_t dst_size_on_stop = 0, total_dst_size = src_stat_buffer.size, preallocate_delta = 0,
             initial_writing_offset = 0;
 
@@ -1159,7 +1494,8 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToNativeFile(VFSHost &_src_vfs,
     if( io.stat(_dst_path.c_str(), &dst_stat_buffer) != -1 ) {
         // file already exist. what should we do now?
         const auto setup_overwrite = [&] {
-            dst_open_flags = O_WRONLY;
+            do_delta = m_Options.overwrite_changed_blocks_only && dst_stat_buffer.st_size > 0;
+            dst_open_flags = do_delta ? O_RDWR : O_WRONLY;
             do_unlink_on_stop = true;
             dst_size_on_stop = 0;
             do_erase_xattrs = true;
@@ -1310,6 +1646,26 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToNativeFile(VFSHost &_src_vfs,
     uint64_t source_bytes_read = 0;
     uint64_t destination_bytes_written = 0;
 
+    if( do_delta ) {
+        // rewrite only the changed blocks, thus leaving nothing to do for the regular copying below
+        const auto read_source = [&src_file](void *_buffer, size_t _size) -> ssize_t {
+            return src_file->Read(_buffer, _size);
+        };
+        const auto rc = CopyChangedBlocksToNativeFile(read_source,
+                                                      src_stat_buffer.size,
+                                                      _src_vfs,
+                                                      _src_path,
+                                                      destination_fd,
+                                                      dst_stat_buffer.st_size,
+                                                      _dst_host,
+                                                      _dst_path,
+                                                      _source_data_feedback,
+                                                      _destination_data_feedback);
+        if( rc != StepResult::Ok )
+            return rc;
+        source_bytes_read = destination_bytes_written = src_stat_buffer.size;
+    }
+
     // read from source within current thread and write to destination within secondary queue
     while( src_stat_buffer.size != destination_bytes_written ) {
 
@@ -1326,8 +1682,10 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToNativeFile(VFSHost &_src_vfs,
                        dst_preffered_io_size,
                        &destination_bytes_written,
                        &write_return,
+                       &_destination_data_feedback,
                        &_dst_path,
                        &_dst_host] {
+            const ScopedIOPriority io_priority{IOPriority()};
             uint32_t left_to_write = bytes_to_write;
             uint32_t has_written = 0; // amount of bytes written into destination this time
             int write_loops = 0;
@@ -1335,6 +1693,9 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToNativeFile(VFSHost &_src_vfs,
                 const int64_t n_written =
                     write(destination_fd, write_buffer + has_written, std::min(left_to_write, dst_preffered_io_size));
                 if( n_written > 0 ) {
+                    Statistics().CommitWritten(n_written);
+                    if( _destination_data_feedback )
+                        _destination_data_feedback(write_buffer + has_written, static_cast<unsigned>(n_written));
                     has_written += n_written;
                     left_to_write -= n_written;
                     destination_bytes_written += n_written;
@@ -1397,6 +1758,7 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToNativeFile(VFSHost &_src_vfs,
             return *read_return;
 
         Statistics().CommitProcessed(Statistics::SourceType::Bytes, bytes_to_write);
+        ThrottleIO(has_read);
 
         // swap buffers ang go again
         bytes_to_write = has_read;
@@ -1451,7 +1813,8 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToNativeFile(VFSHost &_src_vfs,
 CopyingJob::StepResult CopyingJob::CopyVFSFileToVFSFile(VFSHost &_src_vfs,
                                                         const std::string &_src_path,
                                                         const std::string &_dst_path,
-                                                        const SourceDataFeedback &_source_data_feedback,
+                                                        const DataFeedback &_source_data_feedback,
+                                                        const DataFeedback &_destination_data_feedback,
                                                         const RequestNonexistentDst &_new_dst_callback)
 {
     // get information about the source file
@@ -1653,7 +2016,9 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToVFSFile(VFSHost &_src_vfs,
                        dst_preffered_io_size,
                        &destination_bytes_written,
                        &write_return,
+                       &_destination_data_feedback,
                        &_dst_path] {
+            const ScopedIOPriority io_priority{IOPriority()};
             uint32_t left_to_write = bytes_to_write;
             uint32_t has_written = 0; // amount of bytes written into destination this time
             int write_loops = 0;
@@ -1663,6 +2028,9 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToVFSFile(VFSHost &_src_vfs,
                 const int64_t n_written =
                     dst_file->Write(write_buffer + has_written, std::min(left_to_write, dst_preffered_io_size));
                 if( n_written > 0 ) {
+                    Statistics().CommitWritten(n_written);
+                    if( _destination_data_feedback )
+                        _destination_data_feedback(write_buffer + has_written, static_cast<unsigned>(n_written));
                     has_written += n_written;
                     left_to_write -= n_written;
                     destination_bytes_written += n_written;
@@ -1725,6 +2093,7 @@ CopyingJob::StepResult CopyingJob::CopyVFSFileToVFSFile(VFSHost &_src_vfs,
             return *read_return;
 
         Statistics().CommitProcessed(Statistics::SourceType::Bytes, bytes_to_write);
+        ThrottleIO(has_read);
 
         // swap buffers ang go again
         bytes_to_write = has_read;
@@ -2542,41 +2911,33 @@ void CopyingJob::ApplyTimestampsFixups()
     }
 }
 
-CopyingJob::StepResult CopyingJob::VerifyCopiedFile(const ChecksumExpectation &_exp, bool &_matched)
+CopyingJob::StepResult CopyingJob::FeedNativeFilePrefix(int _fd,
+                                                        uint64_t _size,
+                                                        const std::string &_path,
+                                                        VFSHost &_host,
+                                                        bool _is_destination,
+                                                        const DataFeedback &_feedback)
 {
-    _matched = false;
-    VFSFilePtr file;
-    int rc;
-    if( (rc = m_DestinationHost->CreateFile(_exp.destination_path.c_str(), file, nullptr)) != 0 )
-        switch( m_OnDestinationFileReadError(rc, _exp.destination_path, *m_DestinationHost) ) {
-            case DestinationFileReadErrorResolution::Skip:
-                return StepResult::Skipped;
-            case DestinationFileReadErrorResolution::Stop:
-                return StepResult::Stop;
-        }
-
-    if( (rc = file->Open(VFSFlags::OF_Read | VFSFlags::OF_ShLock | VFSFlags::OF_NoCache)) != 0 )
-        switch( m_OnDestinationFileReadError(rc, _exp.destination_path, *m_DestinationHost) ) {
-            case DestinationFileReadErrorResolution::Skip:
-                return StepResult::Skipped;
-            case DestinationFileReadErrorResolution::Stop:
-                return StepResult::Stop;
-        }
-
-    base::Hash hash(base::Hash::MD5);
+    if( !_feedback )
+        return StepResult::Ok;
 
-    const uint64_t sz = file->Size();
-    uint64_t szleft = sz;
     void *buf = m_Buffers[0].get();
     const uint64_t buf_sz = m_BufferSize;
-
-    while( szleft > 0 ) {
+    uint64_t offset = 0;
+    while( offset < _size ) {
         if( BlockIfPaused(); IsStopped() )
             return StepResult::Stop;
 
-        const ssize_t r = file->Read(buf, std::min(szleft, buf_sz));
-        if( r < 0 ) {
-            switch( m_OnDestinationFileReadError(static_cast<int>(r), _exp.destination_path, *m_DestinationHost) ) {
+        const ssize_t r = pread(_fd, buf, std::min(_size - offset, buf_sz), offset);
+        if( r > 0 ) {
+            _feedback(buf, static_cast<unsigned>(r));
+            offset += r;
+            continue;
+        }
+
+        const int vfs_error = r < 0 ? VFSError::FromErrno() : static_cast<int>(VFSError::UnexpectedEOF);
+        if( _is_destination ) {
+            switch( m_OnDestinationFileReadError(vfs_error, _path, _host) ) {
                 case DestinationFileReadErrorResolution::Skip:
                     return StepResult::Skipped;
                 case DestinationFileReadErrorResolution::Stop:
@@ -2584,13 +2945,16 @@ CopyingJob::StepResult CopyingJob::VerifyCopiedFile(const ChecksumExpectation &_
             }
         }
         else {
-            szleft -= r;
-            hash.Feed(buf, r);
+            switch( m_OnSourceFileReadError(vfs_error, _path, _host) ) {
+                case SourceFileReadErrorResolution::Skip:
+                    return StepResult::Skipped;
+                case SourceFileReadErrorResolution::Stop:
+                    return StepResult::Stop;
+                case SourceFileReadErrorResolution::Retry:
+                    continue;
+            }
         }
     }
-    file->Close();
-
-    _matched = _exp == hash.Final();
     return StepResult::Ok;
 }
 
@@ -2921,6 +3285,73 @@ const CopyingOptions &CopyingJob::Options() const noexcept
     return m_Options;
 }
 
+std::string CopyingJob::ComposeJournalKey() const
+{
+    // the options are a part of the key - a re-run with different ones starts from scratch
+    std::string key = fmt::format("{} {} {} {} {} {} {} {} {}\n{}\n",
+                                  m_Options.docopy,
+                                  m_Options.preserve_symlinks,
+                                  m_Options.copy_xattrs,
+                                  m_Options.copy_file_times,
+                                  m_Options.copy_unix_flags,
+                                  m_Options.copy_unix_owners,
+                                  static_cast<int>(m_Options.verification),
+                                  static_cast<int>(m_Options.exist_behavior),
+                                  static_cast<int>(m_Options.locked_items_behaviour),
+                                  m_InitialDestinationPath);
+    for( const auto &item : m_VFSListingItems )
+        key += fmt::format("{}:{}\n", item.Host()->Tag(), item.Path());
+    return key;
+}
+
+bool CopyingJob::IsCompletedInJournal(const std::string &_src_path,
+                                      const std::string &_dst_path,
+                                      bool _needs_checksum) const
+{
+    if( !m_Journal )
+        return false;
+
+    const auto record = m_Journal->Find(_dst_path);
+    if( record == nullptr || !record->finished || (_needs_checksum && !record->checksum) )
+        return false;
+
+    auto &io = routedio::RoutedIO::Default;
+    struct stat src_stat_buffer;
+    struct stat dst_stat_buffer;
+    if( io.stat(_src_path.c_str(), &src_stat_buffer) != 0 || io.stat(_dst_path.c_str(), &dst_stat_buffer) != 0 )
+        return false;
+
+    const TransferJournal::SourceIdentity source_identity{static_cast<uint64_t>(src_stat_buffer.st_size),
+                                                          src_stat_buffer.st_mtimespec};
+    return record->source == source_identity && record->destination == DestinationIdentity(dst_stat_buffer) &&
+           dst_stat_buffer.st_size == src_stat_buffer.st_size;
+}
+
+void CopyingJob::RecordCompletionInJournal(const std::string &_src_path,
+                                           const std::string &_dst_path,
+                                           const std::optional<ChecksumExpectation> &_checksums)
+{
+    if( !m_Journal )
+        return;
+
+    auto &io = routedio::RoutedIO::Default;
+    struct stat src_stat_buffer;
+    struct stat dst_stat_buffer;
+    if( io.stat(_src_path.c_str(), &src_stat_buffer) != 0 || io.stat(_dst_path.c_str(), &dst_stat_buffer) != 0 )
+        return;
+
+    const TransferJournal::SourceIdentity source_identity{static_cast<uint64_t>(src_stat_buffer.st_size),
+                                                          src_stat_buffer.st_mtimespec};
+    const auto destination_identity = DestinationIdentity(dst_stat_buffer);
+    if( !_checksums )
+        m_Journal->Finished(_dst_path, source_identity, destination_identity);
+    else if( _checksums->Matches() )
+        m_Journal->Finished(
+            _dst_path, source_identity, destination_identity, std::span<const uint8_t>(_checksums->destination.buf));
+    else
+        m_Journal->Progress(_dst_path, source_identity, destination_identity, 0); // the file will be copied once again
+}
+
 bool CopyingJob::IsNativeLockedItemNoFollow(int vfs_error, const std::string &_path) const
 {
     if( vfs_error != VFSError::FromErrno(EPERM) )
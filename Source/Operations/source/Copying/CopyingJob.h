@@ -12,6 +12,7 @@
 #include "SourceItems.h"
 #include "ChecksumExpectation.h"
 #include "CopyingJobCallbacks.h"
+#include "TransferJournal.h"
 
 namespace nc::ops {
 
@@ -97,24 +98,43 @@ private:
     std::string ComposeDestinationNameForItem(int _src_item_index) const;
     std::string ComposeDestinationNameForItemInDB(int _src_item_index, const copying::SourceItems &_db) const;
 
-    // will be used for checksum calculation when copying verifiyng is enabled
-    using SourceDataFeedback = std::function<void(const void *_data, unsigned _sz)>;
+    // will be used for checksum calculation when copying verifiyng is enabled.
+    // the source data is fed from the reading thread while the destination data is fed from the writing one.
+    using DataFeedback = std::function<void(const void *_data, unsigned _sz)>;
+
+    // reads the source data into a buffer, returns a VFSError code if the result is negative
+    using SourceReader = std::function<ssize_t(void *_buffer, size_t _size)>;
+
+    // overwrites an existing destination file by rewriting only the blocks which differ from the source
+    StepResult CopyChangedBlocksToNativeFile(const SourceReader &_read_source,
+                                             uint64_t _source_size,
+                                             VFSHost &_src_host,
+                                             const std::string &_src_path,
+                                             int _dst_fd,
+                                             uint64_t _dst_size,
+                                             vfs::NativeHost &_dst_host,
+                                             const std::string &_dst_path,
+                                             const DataFeedback &_source_data_feedback,
+                                             const DataFeedback &_destination_data_feedback);
 
     StepResult CopyNativeFileToNativeFile(vfs::NativeHost &_native_host,
                                           const std::string &_src_path,
                                           const std::string &_dst_path,
-                                          const SourceDataFeedback &_source_data_feedback,
+                                          const DataFeedback &_source_data_feedback,
+                                          const DataFeedback &_destination_data_feedback,
                                           const RequestNonexistentDst &_new_dst_callback);
     StepResult CopyVFSFileToNativeFile(VFSHost &_src_vfs,
                                        const std::string &_src_path,
                                        vfs::NativeHost &_dst_host,
                                        const std::string &_dst_path,
-                                       const SourceDataFeedback &_source_data_feedback,
+                                       const DataFeedback &_source_data_feedback,
+                                       const DataFeedback &_destination_data_feedback,
                                        const RequestNonexistentDst &_new_dst_callback);
     StepResult CopyVFSFileToVFSFile(VFSHost &_src_vfs,
                                     const std::string &_src_path,
                                     const std::string &_dst_path,
-                                    const SourceDataFeedback &_source_data_feedback,
+                                    const DataFeedback &_source_data_feedback,
+                                    const DataFeedback &_destination_data_feedback,
                                     const RequestNonexistentDst &_new_dst_callback);
 
     StepResult CopyNativeDirectoryToNativeDirectory(vfs::NativeHost &_native_host,
@@ -156,7 +176,12 @@ private:
                              const std::string &_src_path,
                              const std::string &_dst_path,
                              const RequestNonexistentDst &_new_dst_callback) const;
-    StepResult VerifyCopiedFile(const copying::ChecksumExpectation &_exp, bool &_matched);
+    StepResult FeedNativeFilePrefix(int _fd,
+                                    uint64_t _size,
+                                    const std::string &_path,
+                                    VFSHost &_host,
+                                    bool _is_destination,
+                                    const DataFeedback &_feedback);
     void ClearSourceItems();
     void ClearSourceItem(const std::string &_path, mode_t _mode, VFSHost &_host);
     void ApplyPermissionFixups();
@@ -174,10 +199,17 @@ private:
 
     StepResult OnCantOpenDestinationFile(int _vfs_error, const std::string &_path, VFSHost &_vfs);
 
+    std::string ComposeJournalKey() const;
+    bool IsCompletedInJournal(const std::string &_src_path, const std::string &_dst_path, bool _needs_checksum) const;
+    void RecordCompletionInJournal(const std::string &_src_path,
+                                   const std::string &_dst_path,
+                                   const std::optional<copying::ChecksumExpectation> &_checksums);
+
     const std::vector<VFSListingItem> m_VFSListingItems;
     copying::SourceItems m_SourceItems;
     int m_CurrentlyProcessingSourceItemIndex = -1;
     std::vector<copying::ChecksumExpectation> m_Checksums;
+    std::unique_ptr<copying::TransferJournal> m_Journal; // used only for native -> native copying
     std::vector<unsigned> m_SourceItemsToDelete;
     mutable std::vector<PermissionFixup> m_TargetPermissionsFixupEpilogue;
     mutable std::vector<TimestampFixup> m_TargetTimestampFixupEpilogue;
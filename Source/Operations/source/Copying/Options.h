@@ -1,6 +1,8 @@
-// Copyright (C) 2017-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
+#include <string>
+
 namespace nc::ops {
 
 struct CopyingOptions {
@@ -33,9 +35,15 @@ struct CopyingOptions {
     bool copy_file_times = true;
     bool copy_unix_flags = true;
     bool copy_unix_owners = true;
+    bool overwrite_changed_blocks_only = false; // when overwriting a native file, rewrite only the blocks that differ
     ChecksumVerification verification = ChecksumVerification::Never;
     ExistBehavior exist_behavior = ExistBehavior::Ask;
     LockedItemBehavior locked_items_behaviour = LockedItemBehavior::Ask;
+
+    // When set, the source items must reside below this directory and are placed into the destination directory by
+    // their paths relative to it instead of by their filenames, e.g. "/src/" + "a/b.txt" goes to "/dst/" + "a/b.txt".
+    // The intermediate destination directories are expected to exist already.
+    std::string source_root;
 };
 
 } // namespace nc::ops
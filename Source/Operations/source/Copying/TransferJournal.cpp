@@ -0,0 +1,265 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "TransferJournal.h"
+#include <Base/Hash.h>
+#include <algorithm>
+#include <charconv>
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nc::ops::copying {
+
+// The journal is a text file, each line of it is a record:
+// P <source size> <source mtime sec> <source mtime nsec> <destination inode> <destination mtime sec>
+//   <destination mtime nsec> <completed bytes> <destination path>
+// F <source size> <source mtime sec> <source mtime nsec> <destination inode> <destination mtime sec>
+//   <destination mtime nsec> <hex checksum or -> <destination path>
+// Malformed lines are skipped on loading. A tail without a trailing newline, e.g. left by a crash or by a short
+// write, is cut off before appending, so every new record starts on a line of its own.
+
+template <typename T>
+static std::optional<T> ParseNumber(std::string_view _str) noexcept
+{
+    T value = 0;
+    const auto last = _str.data() + _str.size();
+    const auto res = std::from_chars(_str.data(), last, value);
+    if( res.ec != std::errc{} || res.ptr != last )
+        return std::nullopt;
+    return value;
+}
+
+static std::optional<TransferJournal::Checksum> ParseChecksum(std::string_view _str) noexcept
+{
+    if( _str.size() != TransferJournal::ChecksumSize * 2 )
+        return std::nullopt;
+    TransferJournal::Checksum checksum;
+    for( size_t i = 0; i < checksum.size(); ++i ) {
+        const auto res = std::from_chars(_str.data() + i * 2, _str.data() + i * 2 + 2, checksum[i], 16);
+        if( res.ec != std::errc{} || res.ptr != _str.data() + i * 2 + 2 )
+            return std::nullopt;
+    }
+    return checksum;
+}
+
+// Splits off the next space-separated field from _str.
+static std::string_view NextField(std::string_view &_str) noexcept
+{
+    const auto space = _str.find(' ');
+    if( space == std::string_view::npos ) {
+        const auto field = _str;
+        _str = {};
+        return field;
+    }
+    const auto field = _str.substr(0, space);
+    _str.remove_prefix(space + 1);
+    return field;
+}
+
+static std::string FormatPayload(const TransferJournal::Record &_record)
+{
+    if( !_record.finished )
+        return std::to_string(_record.completed);
+    if( !_record.checksum )
+        return "-";
+    return base::Hash::Hex(std::vector<uint8_t>(_record.checksum->begin(), _record.checksum->end()));
+}
+
+bool operator==(const TransferJournal::SourceIdentity &_lhs, const TransferJournal::SourceIdentity &_rhs) noexcept
+{
+    return _lhs.size == _rhs.size && _lhs.mtime.tv_sec == _rhs.mtime.tv_sec && _lhs.mtime.tv_nsec == _rhs.mtime.tv_nsec;
+}
+
+bool operator==(const TransferJournal::DestinationIdentity &_lhs,
+                const TransferJournal::DestinationIdentity &_rhs) noexcept
+{
+    return _lhs.inode == _rhs.inode && _lhs.mtime.tv_sec == _rhs.mtime.tv_sec &&
+           _lhs.mtime.tv_nsec == _rhs.mtime.tv_nsec;
+}
+
+TransferJournal::TransferJournal(std::filesystem::path _path) : m_Path(std::move(_path))
+{
+    Load();
+}
+
+TransferJournal::~TransferJournal()
+{
+    if( m_FD >= 0 )
+        close(m_FD);
+}
+
+std::filesystem::path TransferJournal::PathFor(const std::filesystem::path &_directory, std::string_view _operation_key)
+{
+    const auto hash = base::Hash(base::Hash::XXH3_128).Feed(_operation_key.data(), _operation_key.size()).Final();
+    return _directory / fmt::format("copying.{}.journal", base::Hash::Hex(hash));
+}
+
+void TransferJournal::RemoveExpired(const std::filesystem::path &_directory, std::chrono::seconds _max_age) noexcept
+{
+    std::error_code ec;
+    const auto now = std::filesystem::file_time_type::clock::now();
+    for( auto it = std::filesystem::directory_iterator(_directory, ec); !ec && it != std::filesystem::directory_iterator();
+         it.increment(ec) ) {
+        const auto filename = it->path().filename().native();
+        if( !filename.starts_with("copying.") || !filename.ends_with(".journal") )
+            continue;
+        std::error_code entry_ec;
+        const auto modified = it->last_write_time(entry_ec);
+        if( !entry_ec && now - modified > _max_age )
+            std::filesystem::remove(it->path(), entry_ec);
+    }
+}
+
+const std::filesystem::path &TransferJournal::Path() const noexcept
+{
+    return m_Path;
+}
+
+const TransferJournal::Record *TransferJournal::Find(std::string_view _destination) const noexcept
+{
+    const auto it = m_Records.find(_destination);
+    return it == m_Records.end() ? nullptr : &it->second;
+}
+
+void TransferJournal::Progress(std::string_view _destination,
+                               const SourceIdentity &_source,
+                               const DestinationIdentity &_destination_identity,
+                               uint64_t _completed)
+{
+    Record record;
+    record.source = _source;
+    record.destination = _destination_identity;
+    record.completed = _completed;
+    Append(_destination, record);
+}
+
+void TransferJournal::Finished(std::string_view _destination,
+                               const SourceIdentity &_source,
+                               const DestinationIdentity &_destination_identity,
+                               std::optional<std::span<const uint8_t>> _checksum)
+{
+    Record record;
+    record.source = _source;
+    record.destination = _destination_identity;
+    record.completed = _source.size;
+    record.finished = true;
+    if( _checksum && _checksum->size() == ChecksumSize ) {
+        record.checksum.emplace();
+        std::ranges::copy(*_checksum, record.checksum->begin());
+    }
+    Append(_destination, record);
+}
+
+void TransferJournal::Remove() noexcept
+{
+    if( m_FD >= 0 ) {
+        close(m_FD);
+        m_FD = -1;
+    }
+    std::error_code ec;
+    std::filesystem::remove(m_Path, ec);
+    m_Records.clear();
+    m_Length = 0;
+}
+
+void TransferJournal::Load()
+{
+    std::ifstream in(m_Path, std::ios::binary);
+    if( !in )
+        return;
+    const std::string contents{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    std::string_view rest = contents;
+    while( true ) {
+        const auto newline = rest.find('\n');
+        if( newline == std::string_view::npos )
+            break;
+        if( auto parsed = Parse(rest.substr(0, newline)) )
+            m_Records.insert_or_assign(std::move(parsed->first), parsed->second);
+        rest.remove_prefix(newline + 1);
+    }
+    m_Length = contents.size() - rest.size();
+}
+
+void TransferJournal::Append(std::string_view _destination, const Record &_record)
+{
+    if( _destination.empty() || _destination.find('\n') != std::string_view::npos )
+        return; // such paths can't be written into the journal
+
+    const auto line = fmt::format("{} {} {} {} {} {} {} {} {}\n",
+                                  _record.finished ? 'F' : 'P',
+                                  _record.source.size,
+                                  _record.source.mtime.tv_sec,
+                                  _record.source.mtime.tv_nsec,
+                                  _record.destination.inode,
+                                  _record.destination.mtime.tv_sec,
+                                  _record.destination.mtime.tv_nsec,
+                                  FormatPayload(_record),
+                                  _destination);
+
+    if( m_FD < 0 ) {
+        m_FD = open(m_Path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if( m_FD < 0 )
+            return; // the journal is an optional facility, failing to write it must not fail the copying
+        if( ftruncate(m_FD, static_cast<off_t>(m_Length)) != 0 ) {
+            close(m_FD);
+            m_FD = -1;
+            return;
+        }
+    }
+
+    // the whole record goes in a single write(), a partial one is cut off so that the next record isn't glued to it
+    const auto written = write(m_FD, line.data(), line.size());
+    if( written == static_cast<ssize_t>(line.size()) ) {
+        m_Length += line.size();
+    }
+    else if( written > 0 && ftruncate(m_FD, static_cast<off_t>(m_Length)) != 0 ) {
+        close(m_FD); // reopening with the next record will try to cut off the partial one again
+        m_FD = -1;
+    }
+
+    m_Records.insert_or_assign(std::string(_destination), _record);
+}
+
+std::optional<std::pair<std::string, TransferJournal::Record>> TransferJournal::Parse(std::string_view _line) noexcept
+{
+    const auto kind = NextField(_line);
+    const auto size = ParseNumber<uint64_t>(NextField(_line));
+    const auto mtime_sec = ParseNumber<int64_t>(NextField(_line));
+    const auto mtime_nsec = ParseNumber<int64_t>(NextField(_line));
+    const auto dst_inode = ParseNumber<uint64_t>(NextField(_line));
+    const auto dst_mtime_sec = ParseNumber<int64_t>(NextField(_line));
+    const auto dst_mtime_nsec = ParseNumber<int64_t>(NextField(_line));
+    const auto payload = NextField(_line);
+    if( !size || !mtime_sec || !mtime_nsec || !dst_inode || !dst_mtime_sec || !dst_mtime_nsec || _line.empty() )
+        return std::nullopt;
+
+    Record record;
+    record.source.size = *size;
+    record.source.mtime.tv_sec = static_cast<time_t>(*mtime_sec);
+    record.source.mtime.tv_nsec = static_cast<long>(*mtime_nsec);
+    record.destination.inode = *dst_inode;
+    record.destination.mtime.tv_sec = static_cast<time_t>(*dst_mtime_sec);
+    record.destination.mtime.tv_nsec = static_cast<long>(*dst_mtime_nsec);
+    if( kind == "P" ) {
+        const auto completed = ParseNumber<uint64_t>(payload);
+        if( !completed || *completed > *size )
+            return std::nullopt;
+        record.completed = *completed;
+    }
+    else if( kind == "F" ) {
+        record.completed = *size;
+        record.finished = true;
+        if( payload != "-" ) {
+            record.checksum = ParseChecksum(payload);
+            if( !record.checksum )
+                return std::nullopt;
+        }
+    }
+    else {
+        return std::nullopt;
+    }
+    return std::make_pair(std::string(_line), record);
+}
+
+} // namespace nc::ops::copying
@@ -0,0 +1,95 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <Base/UnorderedUtil.h>
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <stdint.h>
+
+namespace nc::ops::copying {
+
+// A small on-disk log of the progress of a copying operation, which lets a re-run of the same operation continue from
+// where an interrupted one stopped.
+// Each record describes a destination file: the identity of its source (size and modification time), the identity of
+// the destination itself (inode and modification time) at the moment of recording, the range of bytes already copied
+// and, once the file is complete, the checksum of its contents. The records are appended to the file as the copying
+// goes and the latest record of a destination wins when the journal is loaded.
+// Since the files are copied sequentially, the completed range of a file is always [0, completed).
+// The journal is not thread-safe.
+class TransferJournal
+{
+public:
+    static constexpr size_t ChecksumSize = 16;
+    using Checksum = std::array<uint8_t, ChecksumSize>;
+
+    struct SourceIdentity {
+        uint64_t size = 0;
+        timespec mtime = {0, 0};
+        friend bool operator==(const SourceIdentity &_lhs, const SourceIdentity &_rhs) noexcept;
+    };
+
+    struct DestinationIdentity {
+        uint64_t inode = 0;
+        timespec mtime = {0, 0};
+        friend bool operator==(const DestinationIdentity &_lhs, const DestinationIdentity &_rhs) noexcept;
+    };
+
+    struct Record {
+        SourceIdentity source;
+        DestinationIdentity destination;
+        uint64_t completed = 0;
+        bool finished = false;
+        std::optional<Checksum> checksum; // set only for the finished files which were verified
+    };
+
+    // Loads the journal at _path if it exists, the file is created lazily with the first record.
+    explicit TransferJournal(std::filesystem::path _path);
+    TransferJournal(const TransferJournal &) = delete;
+    ~TransferJournal();
+    TransferJournal &operator=(const TransferJournal &) = delete;
+
+    // Composes a path for the journal of an operation, _operation_key must describe both the items and the options.
+    static std::filesystem::path PathFor(const std::filesystem::path &_directory, std::string_view _operation_key);
+
+    // Deletes the journals in _directory which weren't written to for longer than _max_age, i.e. the ones left by
+    // the operations which were never re-run.
+    static void RemoveExpired(const std::filesystem::path &_directory, std::chrono::seconds _max_age) noexcept;
+
+    const std::filesystem::path &Path() const noexcept;
+
+    // Returns the latest record of the destination, if any.
+    const Record *Find(std::string_view _destination) const noexcept;
+
+    // Records that the first _completed bytes of _destination were copied from the source.
+    void Progress(std::string_view _destination,
+                  const SourceIdentity &_source,
+                  const DestinationIdentity &_destination_identity,
+                  uint64_t _completed);
+
+    // Records that _destination was copied completely, with an optional checksum of the verified contents.
+    void Finished(std::string_view _destination,
+                  const SourceIdentity &_source,
+                  const DestinationIdentity &_destination_identity,
+                  std::optional<std::span<const uint8_t>> _checksum = std::nullopt);
+
+    // Deletes the file of the journal, supposed to be called once the operation has been completed.
+    void Remove() noexcept;
+
+private:
+    void Load();
+    void Append(std::string_view _destination, const Record &_record);
+    static std::optional<std::pair<std::string, Record>> Parse(std::string_view _line) noexcept;
+
+    std::filesystem::path m_Path;
+    ankerl::unordered_dense::map<std::string, Record, UnorderedStringHashEqual, UnorderedStringHashEqual> m_Records;
+    int m_FD = -1;
+    uint64_t m_Length = 0; // the size of the journal up to the end of its last complete record
+};
+
+} // namespace nc::ops::copying
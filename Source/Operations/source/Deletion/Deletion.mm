@@ -20,6 +20,13 @@ Deletion::Deletion(std::vector<VFSListingItem> _items, DeletionOptions _options)
     SetTitle(Caption(_items).UTF8String);
     m_LockedItemBehaviour = m_OrigOptions.locked_items_behaviour;
 
+    struct SchedulingProfile profile;
+    profile.AddDevices(_items);
+    // moving to the trash doesn't depend on the size of the items
+    profile.kind = _options.type == DeletionType::Trash ? SchedulingProfile::Kind::Interactive
+                                                        : SchedulingProfile::Classify(_items);
+    SetSchedulingProfile(std::move(profile));
+
     m_Job = std::make_unique<DeletionJob>(std::move(_items), _options.type);
     m_Job->m_OnReadDirError = [this](int _err, const std::string &_path, VFSHost &_vfs) {
         return OnReadDirError(_err, _path, _vfs);
@@ -2,13 +2,40 @@
 #include "DeletionJob.h"
 #include <Utility/PathManip.h>
 #include <Utility/NativeFSManager.h>
+#include <VFS/Native.h>
+#include <RoutedIO/RoutedIO.h>
+#include <Base/DispatchGroup.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/param.h>
 #include <sys/stat.h>
 #include <algorithm>
+#include <condition_variable>
+#include <thread>
+#include <typeinfo>
 
 namespace nc::ops {
 
+// A directory being removed by the native fast path.
+struct DeletionJob::NativeTreeNode {
+    std::string path; // without a trailing slash
+    std::shared_ptr<NativeTreeNode> parent;
+    std::atomic_int pending{1}; // the node's own scan + its subdirectories which are not removed yet
+};
+
+// A state shared by the workers removing a single native tree.
+struct DeletionJob::NativeTreeRemoval {
+    explicit NativeTreeRemoval(VFSHost &_vfs) : vfs(_vfs) {}
+    VFSHost &vfs;
+    std::mutex lock;
+    std::condition_variable cv;
+    std::vector<std::shared_ptr<NativeTreeNode>> queue; // LIFO, keeps the traversal close to depth-first
+    int busy = 0;
+};
+
+static constexpr int g_NativeTreeRemovalMaxWorkers = 8;
+
 static bool IsEAStorage(VFSHost &_host, const std::string &_directory, const char *_filename, uint8_t _unix_type);
 
 DeletionJob::DeletionJob(std::vector<VFSListingItem> _items, DeletionType _type)
@@ -48,10 +75,13 @@ void DeletionJob::DoScan()
             si.listing_item_index = i;
             si.filename = &m_Paths.back();
             si.type = m_Type;
-            m_Script.emplace(si);
 
             const auto nonempty_rm = bool(item.Host()->Features() & vfs::HostFeatures::NonEmptyRmDir);
-            if( m_Type == DeletionType::Permanent && nonempty_rm == false )
+            const auto needs_contents_removal = m_Type == DeletionType::Permanent && nonempty_rm == false;
+            si.native_tree = needs_contents_removal && IsNativeTreeRemovalApplicable(*item.Host());
+            m_Script.emplace(si);
+
+            if( needs_contents_removal && !si.native_tree )
                 ScanDirectory(item.Path(), i, si.filename);
         }
         else {
@@ -141,8 +171,14 @@ void DeletionJob::DoDelete()
 
         if( type == DeletionType::Permanent ) {
             const auto is_dir = IsPathWithTrailingSlash(path);
-            if( is_dir )
+            if( is_dir ) {
+                if( entry.native_tree ) {
+                    RemoveNativeTreeContents(path, *vfs);
+                    if( IsStopped() )
+                        return;
+                }
                 DoRmDir(path, *vfs);
+            }
             else
                 DoUnlink(path, *vfs);
         }
@@ -287,9 +323,10 @@ void DeletionJob::DoTrash(const std::string &_path, VFSHost &_vfs, SourceItem _s
             else if( resolution == TrashErrorResolution::DeletePermanently ) {
                 SourceItem si = _src;
                 si.type = DeletionType::Permanent;
-                m_Script.emplace(si);
                 const auto is_dir = IsPathWithTrailingSlash(_path);
-                if( is_dir )
+                si.native_tree = is_dir && IsNativeTreeRemovalApplicable(_vfs);
+                m_Script.emplace(si);
+                if( is_dir && !si.native_tree )
                     ScanDirectory(_path, si.listing_item_index, si.filename);
             }
             else {
@@ -335,6 +372,172 @@ int DeletionJob::UnlockItem(const std::string &_path, VFSHost &_vfs) const
     return chflags_rc;
 }
 
+bool DeletionJob::IsNativeTreeRemovalApplicable(const VFSHost &_vfs) const noexcept
+{
+    // The fast path talks to the filesystem directly and bypasses the VFSHost interface. Hence it's used only with the
+    // vanilla native host and only when the I/O isn't routed through the privileged helper.
+    return typeid(_vfs) == typeid(vfs::NativeHost) && !routedio::RoutedIO::Default.isrouted();
+}
+
+void DeletionJob::RemoveNativeTreeContents(const std::string &_path, VFSHost &_vfs)
+{
+    NativeTreeRemoval ctx{_vfs};
+    auto root = std::make_shared<NativeTreeNode>();
+    root->path = EnsureNoTrailingSlash(_path);
+    ctx.queue.emplace_back(std::move(root));
+
+    const int workers =
+        std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, g_NativeTreeRemovalMaxWorkers);
+    const base::DispatchGroup group;
+    for( int i = 0; i < workers; ++i )
+        group.Run([this, &ctx] { RemoveNativeTreeWorker(ctx); });
+    group.Wait();
+}
+
+void DeletionJob::RemoveNativeTreeWorker(NativeTreeRemoval &_ctx)
+{
+    while( true ) {
+        std::shared_ptr<NativeTreeNode> node;
+        {
+            auto lock = std::unique_lock{_ctx.lock};
+            _ctx.cv.wait(lock, [&] { return !_ctx.queue.empty() || _ctx.busy == 0 || IsStopped(); });
+            if( _ctx.queue.empty() || IsStopped() )
+                return; // either nothing is left or nothing will ever appear again
+            node = std::move(_ctx.queue.back());
+            _ctx.queue.pop_back();
+            ++_ctx.busy;
+        }
+
+        RemoveNativeTreeNode(_ctx, node);
+
+        {
+            const auto lock = std::lock_guard{_ctx.lock};
+            --_ctx.busy;
+        }
+        _ctx.cv.notify_all();
+    }
+}
+
+void DeletionJob::RemoveNativeTreeNode(NativeTreeRemoval &_ctx, const std::shared_ptr<NativeTreeNode> &_node)
+{
+    if( BlockIfPaused(); IsStopped() )
+        return;
+
+    const auto open_dir = [](const std::string &_dir_path) -> DIR * {
+        const int fd = open(_dir_path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if( fd < 0 )
+            return nullptr;
+        DIR *const dir = fdopendir(fd);
+        if( dir == nullptr ) {
+            const int err = errno;
+            close(fd);
+            errno = err;
+        }
+        return dir;
+    };
+
+    DIR *dir = nullptr;
+    while( (dir = open_dir(_node->path)) == nullptr ) {
+        const int rc = VFSError::FromErrno();
+        const auto lock = std::lock_guard{m_ResolutionLock};
+        switch( m_OnReadDirError(rc, _node->path, _ctx.vfs) ) {
+            case ReadDirErrorResolution::Retry:
+                continue;
+            case ReadDirErrorResolution::Stop:
+                Stop();
+                return;
+            case ReadDirErrorResolution::Skip:
+                ReleaseNativeTreeNode(_ctx, _node);
+                return;
+        }
+    }
+
+    struct Entry {
+        std::string name;
+        uint8_t type;
+    };
+    std::vector<Entry> entries;
+    const int dir_fd = dirfd(dir);
+    while( const dirent *const e = readdir(dir) ) {
+        if( strisdot(e->d_name) || strisdotdot(e->d_name) )
+            continue;
+        uint8_t type = e->d_type;
+        if( type == DT_UNKNOWN ) {
+            struct stat st;
+            if( fstatat(dir_fd, e->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 )
+                type = IFTODT(st.st_mode);
+        }
+        entries.emplace_back(Entry{e->d_name, type});
+    }
+    std::ranges::sort(entries, [](const Entry &_lhs, const Entry &_rhs) { return _lhs.name < _rhs.name; });
+
+    // AppleDouble "._name" companions go away together with "name", the same way IsEAStorage() treats them
+    const auto is_ea_storage = [&](const Entry &_e) {
+        if( _e.type != DT_REG || _e.name.size() < 3 || _e.name[0] != '.' || _e.name[1] != '_' )
+            return false;
+        const std::string_view origin = std::string_view(_e.name).substr(2);
+        return std::ranges::binary_search(
+            entries, origin, std::less<>{}, [](const Entry &_x) { return std::string_view(_x.name); });
+    };
+    std::erase_if(entries, is_ea_storage);
+    Statistics().CommitEstimated(Statistics::SourceType::Items, entries.size());
+
+    // hand out the subdirectories first, so other workers can start on them while this one unlinks the files
+    std::vector<std::shared_ptr<NativeTreeNode>> subdirs;
+    for( const auto &e : entries )
+        if( e.type == DT_DIR ) {
+            auto subdir = std::make_shared<NativeTreeNode>();
+            subdir->path = _node->path + "/" + e.name;
+            subdir->parent = _node;
+            subdirs.emplace_back(std::move(subdir));
+        }
+    if( !subdirs.empty() ) {
+        _node->pending += static_cast<int>(subdirs.size());
+        {
+            const auto lock = std::lock_guard{_ctx.lock};
+            _ctx.queue.insert(_ctx.queue.end(), subdirs.rbegin(), subdirs.rend());
+        }
+        _ctx.cv.notify_all();
+    }
+
+    uint64_t unlinked = 0;
+    for( const auto &e : entries ) {
+        if( e.type == DT_DIR )
+            continue;
+        if( BlockIfPaused(); IsStopped() )
+            break;
+        if( unlinkat(dir_fd, e.name.c_str(), 0) == 0 || errno == ENOENT ) {
+            ++unlinked;
+            continue;
+        }
+        // let the regular path-based routine deal with locked items and the error resolution
+        const auto lock = std::lock_guard{m_ResolutionLock};
+        DoUnlink(_node->path + "/" + e.name, _ctx.vfs);
+    }
+    closedir(dir);
+    if( unlinked != 0 )
+        Statistics().CommitProcessed(Statistics::SourceType::Items, unlinked);
+
+    ReleaseNativeTreeNode(_ctx, _node);
+}
+
+void DeletionJob::ReleaseNativeTreeNode(NativeTreeRemoval &_ctx, std::shared_ptr<NativeTreeNode> _node)
+{
+    // removes directories which have nothing pending anymore, going upwards
+    while( _node != nullptr && --_node->pending == 0 ) {
+        if( _node->parent == nullptr || IsStopped() )
+            return; // the root directory itself is removed by the caller
+        if( rmdir(_node->path.c_str()) == 0 ) {
+            Statistics().CommitProcessed(Statistics::SourceType::Items, 1);
+        }
+        else {
+            const auto lock = std::lock_guard{m_ResolutionLock};
+            DoRmDir(_node->path, _ctx.vfs);
+        }
+        _node = _node->parent;
+    }
+}
+
 static bool IsEAStorage(VFSHost &_host, const std::string &_directory, const char *_filename, uint8_t _unix_type)
 {
     if( _unix_type != DT_REG || !_host.IsNativeFS() || _filename[0] != '.' || _filename[1] != '_' || _filename[2] == 0 )
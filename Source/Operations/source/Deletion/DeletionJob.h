@@ -7,6 +7,7 @@
 #include <VFS/VFS.h>
 #include <Base/chained_strings.h>
 #include <stack>
+#include <mutex>
 
 namespace nc::ops {
 
@@ -23,7 +24,10 @@ private:
         int listing_item_index;
         DeletionType type;
         const base::chained_strings::node *filename;
+        bool native_tree = false; // contents of this directory will be removed via RemoveNativeTreeContents()
     };
+    struct NativeTreeNode;
+    struct NativeTreeRemoval;
 
     virtual void Perform() override;
     void DoScan();
@@ -35,11 +39,17 @@ private:
     void ScanDirectory(const std::string &_path, int _listing_item_index, const base::chained_strings::node *_prefix);
     bool IsNativeLockedItem(int vfs_err, const std::string &_path, VFSHost &_vfs) const;
     int UnlockItem(const std::string &_path, VFSHost &_vfs) const;
+    bool IsNativeTreeRemovalApplicable(const VFSHost &_vfs) const noexcept;
+    void RemoveNativeTreeContents(const std::string &_path, VFSHost &_vfs);
+    void RemoveNativeTreeWorker(NativeTreeRemoval &_ctx);
+    void RemoveNativeTreeNode(NativeTreeRemoval &_ctx, const std::shared_ptr<NativeTreeNode> &_node);
+    void ReleaseNativeTreeNode(NativeTreeRemoval &_ctx, std::shared_ptr<NativeTreeNode> _node);
 
     std::vector<VFSListingItem> m_SourceItems;
     DeletionType m_Type;
     base::chained_strings m_Paths;
     std::stack<SourceItem> m_Script;
+    std::mutex m_ResolutionLock; // serializes error resolution requests coming from parallel workers
 };
 
 } // namespace nc::ops
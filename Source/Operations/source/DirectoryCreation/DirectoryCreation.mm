@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "DirectoryCreation.h"
 #include "../AsyncDialogResponse.h"
 #include "../Internal.h"
@@ -20,6 +20,11 @@ DirectoryCreation::DirectoryCreation(std::string _directory_name, std::string _r
 {
     m_Directories = Split(_directory_name);
 
+    struct SchedulingProfile profile;
+    profile.kind = SchedulingProfile::Kind::Interactive;
+    profile.AddDevice(_vfs, _root_folder);
+    SetSchedulingProfile(std::move(profile));
+
     m_Job = std::make_unique<DirectoryCreationJob>(m_Directories, _root_folder, _vfs.shared_from_this());
     m_Job->m_OnError = [this](int _err, const std::string &_path, VFSHost &_vfs) {
         return static_cast<Callbacks::ErrorResolution>(OnError(_err, _path, _vfs));
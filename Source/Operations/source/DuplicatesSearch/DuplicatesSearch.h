@@ -0,0 +1,30 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "../Operation.h"
+#include "Options.h"
+#include <VFS/VFS.h>
+
+namespace nc::ops {
+
+class DuplicatesSearchJob;
+
+class DuplicatesSearch final : public Operation
+{
+public:
+    DuplicatesSearch(std::vector<VFSListingItem> _items, const DuplicatesSearchOptions &_options = {});
+    ~DuplicatesSearch();
+
+    // The groups of the files with the same contents. Valid only once the operation is completed.
+    const std::vector<std::vector<VFSListingItem>> &Groups() const noexcept;
+
+    // A temporary listing of the found duplicates to be shown in a panel. Valid only once the operation is completed.
+    VFSListingPtr ComposeListing() const;
+
+private:
+    virtual Job *GetJob() noexcept override;
+
+    std::unique_ptr<DuplicatesSearchJob> m_Job;
+};
+
+} // namespace nc::ops
@@ -0,0 +1,38 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "DuplicatesSearch.h"
+#include "DuplicatesSearchJob.h"
+#include "../Internal.h"
+
+namespace nc::ops {
+
+DuplicatesSearch::DuplicatesSearch(std::vector<VFSListingItem> _items, const DuplicatesSearchOptions &_options)
+{
+    struct SchedulingProfile profile;
+    profile.AddDevices(_items);
+    SetSchedulingProfile(std::move(profile));
+
+    m_Job = std::make_unique<DuplicatesSearchJob>(std::move(_items), _options);
+    SetTitle(NSLocalizedString(@"Searching for duplicates", "Title of the duplicates search operation").UTF8String);
+}
+
+DuplicatesSearch::~DuplicatesSearch()
+{
+    Wait();
+}
+
+Job *DuplicatesSearch::GetJob() noexcept
+{
+    return m_Job.get();
+}
+
+const std::vector<std::vector<VFSListingItem>> &DuplicatesSearch::Groups() const noexcept
+{
+    return m_Job->Groups();
+}
+
+VFSListingPtr DuplicatesSearch::ComposeListing() const
+{
+    return m_Job->ComposeListing(NSLocalizedString(@"Duplicates", "Title of the duplicates search results").UTF8String);
+}
+
+} // namespace nc::ops
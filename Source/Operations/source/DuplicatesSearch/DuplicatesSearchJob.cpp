@@ -0,0 +1,338 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "DuplicatesSearchJob.h"
+#include <VFS/VFSListingInput.h>
+#include <Base/DispatchGroup.h>
+#include <Base/UnorderedUtil.h>
+#include <algorithm>
+#include <atomic>
+#include <stack>
+#include <tuple>
+
+namespace nc::ops {
+
+DuplicatesSearchJob::DuplicatesSearchJob(std::vector<VFSListingItem> _items, const DuplicatesSearchOptions &_options)
+    : m_SourceItems(std::move(_items)), m_Options(_options)
+{
+    m_Options.io_concurrency = std::max(m_Options.io_concurrency, size_t(1));
+    m_Options.buffer_size = std::max(m_Options.buffer_size, size_t(4096));
+    m_Options.edge_block_size = std::clamp(m_Options.edge_block_size, size_t(1), m_Options.buffer_size);
+    Statistics().SetPreferredSource(Statistics::SourceType::Bytes);
+}
+
+DuplicatesSearchJob::~DuplicatesSearchJob() = default;
+
+static bool IsDirectory(const VFSListingItem &_item)
+{
+    return _item.IsDir() && !_item.IsSymlink();
+}
+
+const std::vector<std::vector<VFSListingItem>> &DuplicatesSearchJob::Groups() const noexcept
+{
+    return m_Groups;
+}
+
+VFSListingPtr DuplicatesSearchJob::ComposeListing(std::string _title) const
+{
+    std::vector<VFSListingPtr> listings;
+    if( m_Listing )
+        listings.emplace_back(m_Listing);
+    auto input = VFSListing::Compose(listings);
+    input.title = std::move(_title);
+    return VFSListing::Build(std::move(input));
+}
+
+void DuplicatesSearchJob::Perform()
+{
+    Scan();
+    if( IsStopped() )
+        return;
+
+    // 1st stage - the sizes, which are already known from the listings
+    std::vector<Candidate> candidates;
+    for( auto &group : SplitGroups(std::move(m_Candidates), false) ) {
+        RemoveHardLinks(group);
+        if( group.size() < 2 )
+            continue;
+        for( auto &candidate : group ) {
+            Statistics().CommitEstimated(Statistics::SourceType::Bytes,
+                                         std::min(candidate.size, uint64_t(m_Options.edge_block_size) * 2));
+            candidates.emplace_back(std::move(candidate));
+        }
+    }
+    m_Candidates = {};
+
+    // 2nd stage - the head and the tail blocks
+    HashCandidates(candidates, Stage::Edges);
+    if( IsStopped() )
+        return;
+    std::vector<std::vector<Candidate>> found;
+    std::vector<Candidate> remaining;
+    for( auto &group : SplitGroups(std::move(candidates), true) ) {
+        if( group.front().hashed_entirely ) {
+            found.emplace_back(std::move(group));
+            continue;
+        }
+        for( auto &candidate : group ) {
+            Statistics().CommitEstimated(Statistics::SourceType::Bytes, candidate.size);
+            remaining.emplace_back(std::move(candidate));
+        }
+    }
+
+    // 3rd stage - the whole contents
+    HashCandidates(remaining, Stage::Whole);
+    if( IsStopped() )
+        return;
+    for( auto &group : SplitGroups(std::move(remaining), true) )
+        found.emplace_back(std::move(group));
+
+    for( auto &group : found )
+        std::ranges::sort(group, [](const Candidate &_lhs, const Candidate &_rhs) { return _lhs.path < _rhs.path; });
+    std::ranges::stable_sort(found, [](const auto &_lhs, const auto &_rhs) {
+        return _lhs.front().size > _rhs.front().size;
+    });
+    BuildGroups(found);
+}
+
+// Fetches the listing items of the found files into a single listing, the groups which fell apart meanwhile are
+// dropped.
+void DuplicatesSearchJob::BuildGroups(const std::vector<std::vector<Candidate>> &_found)
+{
+    std::vector<VFSListingPtr> listings;
+    std::vector<size_t> group_sizes;
+    for( const auto &group : _found ) {
+        const size_t first = listings.size();
+        for( const auto &candidate : group ) {
+            if( IsStopped() )
+                return;
+            VFSListingPtr listing;
+            if( m_Hosts[candidate.host]->FetchSingleItemListing(
+                    candidate.path, listing, 0, [this] { return IsStopped(); }) == VFSError::Ok )
+                listings.emplace_back(std::move(listing));
+        }
+        if( listings.size() - first < 2 )
+            listings.resize(first);
+        else
+            group_sizes.emplace_back(listings.size() - first);
+    }
+    if( listings.empty() )
+        return;
+
+    m_Listing = VFSListing::Build(VFSListing::Compose(listings));
+    unsigned index = 0;
+    for( const size_t size : group_sizes ) {
+        auto &items = m_Groups.emplace_back();
+        for( size_t i = 0; i != size; ++i )
+            items.emplace_back(m_Listing->Item(index++));
+    }
+}
+
+// The hard links to the same file are not duplicates of each other, only one of them is kept.
+// The inodes are unique only within a volume, so the devices of the items with the same inodes are checked as well.
+void DuplicatesSearchJob::RemoveHardLinks(std::vector<Candidate> &_candidates)
+{
+    using Inode = std::pair<uint16_t, uint64_t>;
+    ankerl::unordered_dense::map<Inode, size_t> inodes;
+    for( const auto &candidate : _candidates )
+        if( candidate.has_inode )
+            ++inodes[Inode{candidate.host, candidate.inode}];
+
+    ankerl::unordered_dense::set<std::tuple<uint16_t, int32_t, uint64_t>> seen;
+    std::erase_if(_candidates, [&](const Candidate &_candidate) {
+        if( !_candidate.has_inode || inodes[Inode{_candidate.host, _candidate.inode}] < 2 )
+            return false;
+        VFSStat st;
+        if( m_Hosts[_candidate.host]->Stat(
+                _candidate.path, st, VFSFlags::F_NoFollow, [this] { return IsStopped(); }) != VFSError::Ok ||
+            !st.meaning.dev )
+            return false; // the volume is unknown, so the item can't be told to be a hard link
+        return !seen.emplace(_candidate.host, st.dev, _candidate.inode).second;
+    });
+}
+
+uint16_t DuplicatesSearchJob::InsertOrFindHost(const VFSHostPtr &_host)
+{
+    const auto it = std::ranges::find(m_Hosts, _host);
+    if( it != m_Hosts.end() )
+        return static_cast<uint16_t>(std::distance(m_Hosts.begin(), it));
+    m_Hosts.emplace_back(_host);
+    return static_cast<uint16_t>(m_Hosts.size() - 1);
+}
+
+void DuplicatesSearchJob::Scan()
+{
+    for( const auto &item : m_SourceItems ) {
+        if( BlockIfPaused(); IsStopped() )
+            return;
+        const uint16_t host = InsertOrFindHost(item.Host());
+        if( IsDirectory(item) )
+            ScanDirectory(item.Path(), host);
+        else
+            AddCandidate(item, host);
+    }
+}
+
+void DuplicatesSearchJob::ScanDirectory(const std::string &_path, uint16_t _host)
+{
+    VFSHost &host = *m_Hosts[_host];
+    std::stack<std::string> directories;
+    directories.push(_path);
+    while( !directories.empty() ) {
+        if( BlockIfPaused(); IsStopped() )
+            return;
+        const auto path = std::move(directories.top());
+        directories.pop();
+
+        VFSListingPtr listing;
+        const int rc = host.FetchDirectoryListing(path, listing, VFSFlags::F_NoDotDot, [this] { return IsStopped(); });
+        if( rc != VFSError::Ok )
+            continue;
+
+        for( const auto &item : *listing ) {
+            if( IsDirectory(item) )
+                directories.push(item.Path());
+            else
+                AddCandidate(item, _host);
+        }
+    }
+}
+
+void DuplicatesSearchJob::AddCandidate(const VFSListingItem &_item, uint16_t _host)
+{
+    if( !_item.IsReg() || _item.IsSymlink() || !_item.HasSize() || _item.Size() < m_Options.min_size )
+        return;
+    Candidate candidate;
+    candidate.path = _item.Path();
+    candidate.size = _item.Size();
+    candidate.host = _host;
+    if( _item.HasInode() ) {
+        candidate.inode = _item.Inode();
+        candidate.has_inode = true;
+    }
+    m_Candidates.emplace_back(std::move(candidate));
+}
+
+std::vector<std::vector<DuplicatesSearchJob::Candidate>>
+DuplicatesSearchJob::SplitGroups(std::vector<Candidate> _candidates, bool _by_hash)
+{
+    const auto key = [_by_hash](const Candidate &_c) {
+        return std::make_pair(_c.size, _by_hash ? _c.hash : std::array<uint8_t, 16>{});
+    };
+    std::ranges::sort(_candidates, [&](const Candidate &_lhs, const Candidate &_rhs) { return key(_lhs) < key(_rhs); });
+
+    std::vector<std::vector<Candidate>> groups;
+    for( auto first = _candidates.begin(); first != _candidates.end(); ) {
+        const auto last =
+            std::find_if(first, _candidates.end(), [&](const Candidate &_c) { return key(_c) != key(*first); });
+        if( std::distance(first, last) > 1 )
+            groups.emplace_back(std::make_move_iterator(first), std::make_move_iterator(last));
+        first = last;
+    }
+    return groups;
+}
+
+void DuplicatesSearchJob::HashCandidates(std::vector<Candidate> &_candidates, Stage _stage)
+{
+    if( _candidates.empty() )
+        return;
+
+    // each block drains the shared index with a buffer of its own
+    std::atomic_size_t next{0};
+    std::vector<uint8_t> readable(_candidates.size(), 0);
+    const auto work = [&] {
+        const auto buffer = std::make_unique<std::byte[]>(m_Options.buffer_size);
+        while( true ) {
+            if( BlockIfPaused(); IsStopped() )
+                return;
+            const size_t index = next++;
+            if( index >= _candidates.size() )
+                return;
+            auto &candidate = _candidates[index];
+            readable[index] = _stage == Stage::Edges ? HashEdges(candidate, buffer.get())
+                                                     : HashWhole(candidate, buffer.get());
+        }
+    };
+
+    const base::DispatchGroup group;
+    const size_t blocks = std::min(m_Options.io_concurrency, _candidates.size());
+    for( size_t i = 1; i < blocks; ++i )
+        group.Run(work);
+    work();
+    group.Wait();
+
+    // the files which couldn't be read are dropped
+    size_t kept = 0;
+    for( size_t i = 0; i != _candidates.size(); ++i )
+        if( readable[i] )
+            _candidates[kept++] = std::move(_candidates[i]);
+    _candidates.resize(kept);
+}
+
+bool DuplicatesSearchJob::HashEdges(Candidate &_candidate, std::byte *_buffer)
+{
+    const VFSFilePtr file = OpenFile(_candidate);
+    if( !file )
+        return false;
+
+    const uint64_t size = _candidate.size;
+    const uint64_t edge = m_Options.edge_block_size;
+    base::Hash hash(base::Hash::XXH3_128);
+    if( size <= edge * 2 ) {
+        if( !Feed(*file, size, hash, _buffer) )
+            return false;
+        _candidate.hashed_entirely = true;
+    }
+    else {
+        if( !Feed(*file, edge, hash, _buffer) )
+            return false;
+        if( file->GetReadParadigm() >= VFSFile::ReadParadigm::Seek ) {
+            if( file->Seek(size - edge, VFSFile::Seek_Set) < 0 )
+                return false;
+        }
+        else if( file->Skip(size - edge * 2) != static_cast<ssize_t>(size - edge * 2) ) {
+            return false;
+        }
+        if( !Feed(*file, edge, hash, _buffer) )
+            return false;
+    }
+    std::ranges::copy(hash.Final(), _candidate.hash.begin());
+    return true;
+}
+
+bool DuplicatesSearchJob::HashWhole(Candidate &_candidate, std::byte *_buffer)
+{
+    const VFSFilePtr file = OpenFile(_candidate);
+    if( !file )
+        return false;
+
+    base::Hash hash(base::Hash::XXH3_128);
+    if( !Feed(*file, _candidate.size, hash, _buffer) )
+        return false;
+    std::ranges::copy(hash.Final(), _candidate.hash.begin());
+    return true;
+}
+
+VFSFilePtr DuplicatesSearchJob::OpenFile(const Candidate &_candidate)
+{
+    VFSFilePtr file;
+    if( m_Hosts[_candidate.host]->CreateFile(_candidate.path, file, [this] { return IsStopped(); }) != VFSError::Ok ||
+        file->Open(VFSFlags::OF_Read | VFSFlags::OF_NoCache, [this] { return IsStopped(); }) != VFSError::Ok )
+        return nullptr;
+    return file;
+}
+
+bool DuplicatesSearchJob::Feed(VFSFile &_file, uint64_t _length, base::Hash &_hash, std::byte *_buffer)
+{
+    while( _length > 0 ) {
+        if( BlockIfPaused(); IsStopped() )
+            return false;
+        const ssize_t rc = _file.Read(_buffer, std::min(_length, uint64_t(m_Options.buffer_size)));
+        if( rc <= 0 )
+            return false; // either an error or the file became shorter than it was listed
+        _hash.Feed(_buffer, rc);
+        _length -= rc;
+        Statistics().CommitProcessed(Statistics::SourceType::Bytes, rc);
+    }
+    return true;
+}
+
+} // namespace nc::ops
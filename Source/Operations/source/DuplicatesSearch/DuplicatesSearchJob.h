@@ -0,0 +1,74 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "../Job.h"
+#include "Options.h"
+#include <Base/Hash.h>
+#include <VFS/VFS.h>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace nc::ops {
+
+// Finds the files with the same contents among the given items and the contents of the given directories.
+// The candidates are narrowed down in stages, each next one is more expensive and is applied only to the files which
+// are still indistinguishable:
+// 1. the files are grouped by their sizes;
+// 2. the groups are split by the hashes of the head and the tail blocks of the files;
+// 3. the groups are split by the hashes of the whole files.
+// The hashing stages read the files concurrently by a bounded number of dispatched blocks with a fixed buffer each.
+// The candidates are tracked by their paths rather than by the listing items, so the listings of the traversed
+// directories are not held in memory. The listing items are fetched again only for the files of the found groups.
+// The directories and the files which can't be read are skipped, the symlinks are not followed.
+class DuplicatesSearchJob final : public Job
+{
+public:
+    DuplicatesSearchJob(std::vector<VFSListingItem> _items, const DuplicatesSearchOptions &_options);
+    ~DuplicatesSearchJob();
+
+    // The groups of the same files, the larger files go first. Valid only once the job is completed.
+    const std::vector<std::vector<VFSListingItem>> &Groups() const noexcept;
+
+    // Composes a temporary listing of all found duplicates, the files of each group are adjacent.
+    // Valid only once the job is completed.
+    VFSListingPtr ComposeListing(std::string _title) const;
+
+private:
+    struct Candidate {
+        std::string path;
+        uint64_t size = 0;
+        uint64_t inode = 0;
+        uint16_t host = 0; // an index in m_Hosts
+        bool has_inode = false;
+        bool hashed_entirely = false; // the edge blocks already covered the whole file
+        std::array<uint8_t, 16> hash{};
+    };
+    enum class Stage {
+        Edges,
+        Whole
+    };
+
+    virtual void Perform() override;
+    void Scan();
+    void ScanDirectory(const std::string &_path, uint16_t _host);
+    uint16_t InsertOrFindHost(const VFSHostPtr &_host);
+    void AddCandidate(const VFSListingItem &_item, uint16_t _host);
+    void RemoveHardLinks(std::vector<Candidate> &_candidates);
+    void HashCandidates(std::vector<Candidate> &_candidates, Stage _stage);
+    bool HashEdges(Candidate &_candidate, std::byte *_buffer);
+    bool HashWhole(Candidate &_candidate, std::byte *_buffer);
+    VFSFilePtr OpenFile(const Candidate &_candidate);
+    bool Feed(VFSFile &_file, uint64_t _length, base::Hash &_hash, std::byte *_buffer);
+    void BuildGroups(const std::vector<std::vector<Candidate>> &_found);
+    static std::vector<std::vector<Candidate>> SplitGroups(std::vector<Candidate> _candidates, bool _by_hash);
+
+    std::vector<VFSListingItem> m_SourceItems;
+    DuplicatesSearchOptions m_Options;
+    std::vector<VFSHostPtr> m_Hosts;
+    std::vector<Candidate> m_Candidates;
+    VFSListingPtr m_Listing; // the found duplicates, the files of each group are adjacent
+    std::vector<std::vector<VFSListingItem>> m_Groups;
+};
+
+} // namespace nc::ops
@@ -0,0 +1,16 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nc::ops {
+
+struct DuplicatesSearchOptions {
+    uint64_t min_size = 1;              // smaller files are not considered
+    size_t io_concurrency = 4;          // the number of files being read at the same time
+    size_t edge_block_size = 16 * 1024; // the size of the head and the tail blocks hashed before the whole files
+    size_t buffer_size = 1024 * 1024;   // the size of the reading buffer of each worker
+};
+
+} // namespace nc::ops
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "../include/Operations/Job.h"
 #include <Base/IdleSleepPreventer.h>
 #include <boost/core/demangle.hpp>
@@ -33,6 +33,8 @@ void Job::Execute()
     pthread_setname_np(thread_title.c_str());
 
     const auto sleep_preventer = base::IdleSleepPreventer::Instance().GetPromise();
+    m_ThreadIOPriority = m_IOPriority;
+    SetThreadIOPriority(m_ThreadIOPriority);
     m_Stats.StartTiming();
 
     try {
@@ -90,6 +92,19 @@ void Job::Stop()
     OnStopped();
 }
 
+void Job::Interrupt()
+{
+    if( m_IsStopped )
+        return; // a cancellation which is already going on is not turned into an interruption
+    m_IsInterrupted = true;
+    Stop();
+}
+
+bool Job::IsInterrupted() const noexcept
+{
+    return m_IsInterrupted;
+}
+
 void Job::OnStopped()
 {
 }
@@ -113,6 +128,35 @@ const class Statistics &Job::Statistics() const
     return m_Stats;
 }
 
+void Job::SetBandwidthLimit(uint64_t _bytes_per_second)
+{
+    m_Throttle.SetRate(_bytes_per_second);
+}
+
+uint64_t Job::BandwidthLimit() const noexcept
+{
+    return m_Throttle.Rate();
+}
+
+void Job::SetIOPriority(enum IOPriority _priority) noexcept
+{
+    m_IOPriority = _priority;
+}
+
+enum IOPriority Job::IOPriority() const noexcept
+{
+    return m_IOPriority;
+}
+
+void Job::ThrottleIO(size_t _bytes)
+{
+    if( const enum IOPriority priority = m_IOPriority; priority != m_ThreadIOPriority ) {
+        m_ThreadIOPriority = priority;
+        SetThreadIOPriority(priority);
+    }
+    m_Throttle.Consume(_bytes, [this] { return IsStopped(); });
+}
+
 void Job::Pause()
 {
     if( m_IsPaused || m_IsCompleted || m_IsStopped )
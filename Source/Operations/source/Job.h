@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2020 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include <atomic>
@@ -7,6 +7,7 @@
 #include <Base/spinlock.h>
 #include "Statistics.h"
 #include "ItemStateReport.h"
+#include "Throttle.h"
 
 namespace nc::ops {
 
@@ -20,9 +21,13 @@ public:
     void Resume();
     void Stop();
 
+    // Stops the job, which is allowed to leave the state needed to resume its work later.
+    void Interrupt();
+
     bool IsRunning() const noexcept;
     bool IsPaused() const noexcept;
     bool IsStopped() const noexcept;
+    bool IsInterrupted() const noexcept;
     bool IsCompleted() const noexcept;
 
     void SetFinishCallback(std::function<void()> _callback);
@@ -33,6 +38,15 @@ public:
     class Statistics &Statistics();
     const class Statistics &Statistics() const;
 
+    // Limits the rate of the job's I/O, zero means no limit. Can be changed while the job is running.
+    void SetBandwidthLimit(uint64_t _bytes_per_second);
+    uint64_t BandwidthLimit() const noexcept;
+
+    // The disk I/O priority of the job's thread. Can be changed while the job is running, the change is picked up by
+    // the next throttled transfer.
+    void SetIOPriority(enum IOPriority _priority) noexcept;
+    enum IOPriority IOPriority() const noexcept;
+
 protected:
     Job();
     virtual void Perform();
@@ -43,11 +57,16 @@ protected:
     void BlockIfPaused();
     void TellItemReport(ItemStateReport _report);
 
+    // Blocks while the job exceeds its bandwidth limit, to be called from the job's thread after transferring _bytes.
+    // Doesn't block past the job being stopped, so IsStopped() has to be checked afterwards as usual.
+    void ThrottleIO(size_t _bytes);
+
 private:
     std::atomic_bool m_IsRunning;
     std::atomic_bool m_IsPaused;
     std::atomic_bool m_IsCompleted;
     std::atomic_bool m_IsStopped;
+    std::atomic_bool m_IsInterrupted{false};
     std::condition_variable m_PauseCV;
 
     std::function<void()> m_OnFinish;
@@ -57,6 +76,9 @@ private:
     spinlock m_CallbackLock;
 
     class Statistics m_Stats;
+    class Throttle m_Throttle;
+    std::atomic<enum IOPriority> m_IOPriority{nc::ops::IOPriority::Default};
+    enum IOPriority m_ThreadIOPriority = nc::ops::IOPriority::Default; // accessed only from the job's thread
 };
 
 } // namespace nc::ops
@@ -16,6 +16,11 @@ Linkage::Linkage(const std::string &_link_path,
                  const std::shared_ptr<VFSHost> &_vfs,
                  LinkageType _type)
 {
+    struct SchedulingProfile profile;
+    profile.kind = SchedulingProfile::Kind::Interactive;
+    profile.AddDevice(*_vfs, _link_path);
+    SetSchedulingProfile(std::move(profile));
+
     m_Job = std::make_unique<LinkageJob>(_link_path, _link_value, _vfs, _type);
     m_Job->m_OnCreateSymlinkError = [this](int _err, const std::string &_path, VFSHost &_vfs) {
         OnCreateSymlinkError(_err, _path, _vfs);
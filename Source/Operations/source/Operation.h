@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include <Base/ScopedObservable.h>
@@ -6,6 +6,7 @@
 #include <string_view>
 
 #include "ItemStateReport.h"
+#include "SchedulingProfile.h"
 
 #ifdef __OBJC__
 @class NSWindow;
@@ -21,6 +22,7 @@ namespace nc::ops {
 class Job;
 class Statistics;
 struct AsyncDialogResponse;
+enum class IOPriority : char;
 
 enum class OperationState {
     Cold = 0,
@@ -46,9 +48,21 @@ public:
     void Resume();
     void Stop();
 
+    // Stops the operation like Stop() does, but lets its job keep what's needed to continue by a re-run of the same
+    // operation, e.g. when the application quits. A plain Stop() is a cancellation which cleans up after itself.
+    void Interrupt();
+
     std::string Title() const;
     OperationState State() const;
     const class Statistics &Statistics() const;
+    const struct SchedulingProfile &SchedulingProfile() const noexcept;
+
+    // Limits the I/O rate of the operation, zero means no limit. Can be changed while the operation is running.
+    // Pool::SetBandwidthLimit() should be preferred for the enqueued operations, so the pool can reschedule.
+    void SetBandwidthLimit(uint64_t _bytes_per_second);
+    uint64_t BandwidthLimit() const;
+    void SetIOPriority(enum IOPriority _priority);
+    enum IOPriority IOPriority() const;
 
     void Wait() const;
     bool Wait(std::chrono::nanoseconds _wait_for_time) const;
@@ -100,6 +114,8 @@ protected:
     void WaitForDialogResponse(std::shared_ptr<AsyncDialogResponse> _response);
     void ReportHaltReason(NSString *_message, int _error, const std::string &_path, VFSHost &_vfs);
     void SetTitle(std::string _title);
+    // Supposed to be called in a constructor, the profile must not change once the operation is enqueued.
+    void SetSchedulingProfile(struct SchedulingProfile _profile);
 
 private:
     Operation(const Operation &) = delete;
@@ -119,6 +135,8 @@ private:
 
     std::string m_Title;
     mutable spinlock m_TitleLock;
+
+    struct SchedulingProfile m_SchedulingProfile;
 };
 
 } // namespace nc::ops
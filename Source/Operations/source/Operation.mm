@@ -42,6 +42,42 @@ const class Statistics &Operation::Statistics() const
     throw std::logic_error("Operation::Statistics(): no valid Job object to access to");
 }
 
+const struct SchedulingProfile &Operation::SchedulingProfile() const noexcept
+{
+    return m_SchedulingProfile;
+}
+
+void Operation::SetSchedulingProfile(struct SchedulingProfile _profile)
+{
+    m_SchedulingProfile = std::move(_profile);
+}
+
+void Operation::SetBandwidthLimit(uint64_t _bytes_per_second)
+{
+    if( auto job = GetJob() )
+        job->SetBandwidthLimit(_bytes_per_second);
+}
+
+uint64_t Operation::BandwidthLimit() const
+{
+    if( auto job = GetJob() )
+        return job->BandwidthLimit();
+    return 0;
+}
+
+void Operation::SetIOPriority(enum IOPriority _priority)
+{
+    if( auto job = GetJob() )
+        job->SetIOPriority(_priority);
+}
+
+enum IOPriority Operation::IOPriority() const
+{
+    if( auto job = GetJob() )
+        return job->IOPriority();
+    return nc::ops::IOPriority::Default;
+}
+
 OperationState Operation::State() const
 {
     if( auto j = GetJob() ) {
@@ -95,6 +131,16 @@ void Operation::Stop()
     }
 }
 
+void Operation::Interrupt()
+{
+    if( auto j = GetJob() ) {
+        const auto is_running = j->IsRunning();
+        j->Interrupt();
+        if( !is_running )
+            JobFinished();
+    }
+}
+
 void Operation::Wait() const
 {
     Wait(std::chrono::nanoseconds::max());
@@ -1,7 +1,8 @@
-// Copyright (C) 2017-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "Operation.h"
+#include "PoolScheduler.h"
 #include <Cocoa/Cocoa.h>
 #include <deque>
 
@@ -23,7 +24,8 @@ public:
     enum {
         NotifyAboutAddition = 1 << 0,
         NotifyAboutRemoval = 1 << 1,
-        NotifyAboutChange = NotifyAboutAddition | NotifyAboutRemoval
+        NotifyAboutChange = NotifyAboutAddition | NotifyAboutRemoval,
+        NotifyAboutScheduling = 1 << 2
     };
     using ObservationTicket = ScopedObservableBase::ObservationTicket;
     ObservationTicket Observe(uint64_t _notification_mask, std::function<void()> _callback);
@@ -43,6 +45,24 @@ public:
     // A client can customise this behaviour and decide it on a per-operation level.
     void SetEnqueuingCallback(std::function<bool(const Operation &_operation)> _should_be_queued);
 
+    // Per-device scheduling settings, see PoolScheduler for the details.
+    void SetDeviceConcurrency(int _maximum_per_device);
+    void SetDeviceConcurrency(std::string_view _device, int _maximum);
+    void SetDeviceBandwidth(std::string_view _device, uint64_t _bytes_per_second);
+
+    // Changes the I/O rate limit of an operation, either running or pending, and reschedules as a lowered limit
+    // frees the bandwidth budgets of the operation's devices. Zero means no limit.
+    void SetBandwidthLimit(Operation &_operation, uint64_t _bytes_per_second);
+
+    struct SchedulingDecision {
+        std::shared_ptr<Operation> operation;
+        PoolScheduler::Verdict verdict;
+        std::string device;
+    };
+    // The reasons why the pending operations are not started yet, as of the latest scheduling.
+    // Observers of NotifyAboutScheduling are notified each time the decisions are made.
+    std::vector<SchedulingDecision> SchedulingDecisions() const;
+
     bool IsInteractive() const;
     void SetDialogCallback(std::function<void(NSWindow *, std::function<void(NSModalResponse)>)> _callback);
     void SetOperationCompletionCallback(std::function<void(const std::shared_ptr<Operation> &)> _callback);
@@ -54,11 +74,15 @@ private:
     void OperationDidFinish(const std::shared_ptr<Operation> &_operation);
     bool ShowDialog(NSWindow *_dialog, std::function<void(NSModalResponse)> _callback);
     void StartPendingOperations();
+    void ScheduleRecheck();
 
     std::vector<std::shared_ptr<Operation>> m_RunningOperations;
     std::deque<std::shared_ptr<Operation>> m_PendingOperations;
     mutable std::mutex m_Lock;
     std::atomic_int m_Concurrency{5};
+    PoolScheduler m_Scheduler;                   // guarded by m_Lock
+    std::vector<SchedulingDecision> m_Decisions; // guarded by m_Lock
+    bool m_RecheckScheduled = false;             // guarded by m_Lock
 
     std::function<bool(const Operation &_operation)> m_ShouldBeQueuedCallback;
 
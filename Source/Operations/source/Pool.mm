@@ -1,7 +1,9 @@
-// Copyright (C) 2017-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Pool.h"
 #include "Operation.h"
+#include "Statistics.h"
 #include <Base/dispatch_cpp.h>
+#include <algorithm>
 #include <thread>
 
 namespace nc::ops {
@@ -93,25 +95,68 @@ void Pool::StartPendingOperations()
         std::erase_if(m_PendingOperations, [](const auto &_op) { return _op == nullptr; });
     }
 
-    // 2nd - gather any other operations until the pool has enough running operations
+    // 2nd - gather any other operations which the scheduler allows to start
+    bool waits_for_bandwidth = false;
     {
         const auto guard = std::lock_guard{m_Lock};
-        const auto running_now = static_cast<int>(m_RunningOperations.size());
-        auto gathered = 0;
-        while( running_now + gathered < m_Concurrency && !m_PendingOperations.empty() ) {
-            const auto op = m_PendingOperations.front();
-            m_PendingOperations.pop_front();
-            to_start.emplace_back(op);
-            m_RunningOperations.emplace_back(op);
-            ++gathered;
+        std::vector<PoolScheduler::Running> running;
+        for( const auto &op : m_RunningOperations ) {
+            // a capped operation can't consume more than its limit, even if it was faster a moment ago
+            double speed = op->Statistics().SpeedPerSecondDirect(Statistics::SourceType::Bytes);
+            if( const auto limit = op->BandwidthLimit(); limit != 0 )
+                speed = std::min(speed, static_cast<double>(limit));
+            running.emplace_back(PoolScheduler::Running{&op->SchedulingProfile(), speed});
         }
+        std::vector<const SchedulingProfile *> pending;
+        for( const auto &op : m_PendingOperations )
+            pending.emplace_back(&op->SchedulingProfile());
+
+        const auto free_slots = m_Concurrency - static_cast<int>(m_RunningOperations.size());
+        m_Decisions.clear();
+        for( auto &decision : m_Scheduler.Schedule(running, pending, free_slots) ) {
+            auto &op = m_PendingOperations[decision.index];
+            if( decision.verdict == PoolScheduler::Verdict::Start ) {
+                to_start.emplace_back(op);
+                m_RunningOperations.emplace_back(op);
+                continue;
+            }
+            waits_for_bandwidth |= decision.verdict == PoolScheduler::Verdict::WaitForBandwidth;
+            m_Decisions.emplace_back(SchedulingDecision{op, decision.verdict, std::move(decision.device)});
+        }
+        for( auto &op : to_start )
+            erase_from(m_PendingOperations, op);
     }
+    FireObservers(NotifyAboutScheduling);
+
+    // the throughput of the running operations changes without any notification, so it has to be polled
+    if( waits_for_bandwidth )
+        ScheduleRecheck();
 
     // now kickstart all these operations
     for( const auto &op : to_start )
         op->Start();
 }
 
+void Pool::ScheduleRecheck()
+{
+    {
+        const auto guard = std::lock_guard{m_Lock};
+        if( m_RecheckScheduled )
+            return;
+        m_RecheckScheduled = true;
+    }
+    const auto weak_this = std::weak_ptr<Pool>{shared_from_this()};
+    dispatch_to_main_queue_after(std::chrono::seconds{1}, [weak_this] {
+        if( const auto pool = weak_this.lock() ) {
+            {
+                const auto guard = std::lock_guard{pool->m_Lock};
+                pool->m_RecheckScheduled = false;
+            }
+            pool->StartPendingOperations();
+        }
+    });
+}
+
 Pool::ObservationTicket Pool::Observe(uint64_t _notification_mask, std::function<void()> _callback)
 {
     return AddTicketedObserver(std::move(_callback), _notification_mask);
@@ -188,6 +233,45 @@ void Pool::SetEnqueuingCallback(std::function<bool(const Operation &_operation)>
     m_ShouldBeQueuedCallback = std::move(_should_be_queued);
 }
 
+void Pool::SetDeviceConcurrency(int _maximum_per_device)
+{
+    {
+        const auto guard = std::lock_guard{m_Lock};
+        m_Scheduler.SetDeviceConcurrency(_maximum_per_device);
+    }
+    StartPendingOperations();
+}
+
+void Pool::SetDeviceConcurrency(std::string_view _device, int _maximum)
+{
+    {
+        const auto guard = std::lock_guard{m_Lock};
+        m_Scheduler.SetDeviceConcurrency(_device, _maximum);
+    }
+    StartPendingOperations();
+}
+
+void Pool::SetDeviceBandwidth(std::string_view _device, uint64_t _bytes_per_second)
+{
+    {
+        const auto guard = std::lock_guard{m_Lock};
+        m_Scheduler.SetDeviceBandwidth(_device, _bytes_per_second);
+    }
+    StartPendingOperations();
+}
+
+void Pool::SetBandwidthLimit(Operation &_operation, uint64_t _bytes_per_second)
+{
+    _operation.SetBandwidthLimit(_bytes_per_second);
+    StartPendingOperations();
+}
+
+std::vector<Pool::SchedulingDecision> Pool::SchedulingDecisions() const
+{
+    const auto guard = std::lock_guard{m_Lock};
+    return m_Decisions;
+}
+
 bool Pool::Empty() const
 {
     const auto guard = std::lock_guard{m_Lock};
@@ -198,10 +282,11 @@ void Pool::StopAndWaitForShutdown()
 {
     {
         const auto guard = std::lock_guard{m_Lock};
+        // the operations are interrupted rather than cancelled, so these could be continued after a restart
         for( auto &o : m_PendingOperations )
-            o->Stop();
+            o->Interrupt();
         for( auto &o : m_RunningOperations )
-            o->Stop();
+            o->Interrupt();
     }
 
     using namespace std::literals;
@@ -0,0 +1,115 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "PoolScheduler.h"
+#include <algorithm>
+#include <numeric>
+
+namespace nc::ops {
+
+namespace {
+
+struct DeviceLoad {
+    int operations = 0;
+    double bytes_per_second = 0.;
+};
+
+} // namespace
+
+void PoolScheduler::SetDeviceConcurrency(int _maximum_per_device)
+{
+    m_DeviceConcurrency = std::max(_maximum_per_device, 1);
+}
+
+void PoolScheduler::SetDeviceConcurrency(std::string_view _device, int _maximum)
+{
+    if( _maximum > 0 )
+        m_DevicesConcurrency.insert_or_assign(std::string(_device), _maximum);
+    else
+        m_DevicesConcurrency.erase(_device);
+}
+
+void PoolScheduler::SetDeviceBandwidth(std::string_view _device, uint64_t _bytes_per_second)
+{
+    if( _bytes_per_second > 0 )
+        m_DevicesBandwidth.insert_or_assign(std::string(_device), _bytes_per_second);
+    else
+        m_DevicesBandwidth.erase(_device);
+}
+
+int PoolScheduler::DeviceConcurrency(std::string_view _device) const noexcept
+{
+    const auto it = m_DevicesConcurrency.find(_device);
+    return it == m_DevicesConcurrency.end() ? m_DeviceConcurrency : it->second;
+}
+
+uint64_t PoolScheduler::DeviceBandwidth(std::string_view _device) const noexcept
+{
+    const auto it = m_DevicesBandwidth.find(_device);
+    return it == m_DevicesBandwidth.end() ? 0 : it->second;
+}
+
+std::vector<PoolScheduler::Decision> PoolScheduler::Schedule(std::span<const Running> _running,
+                                                             std::span<const SchedulingProfile *const> _pending,
+                                                             int _free_slots) const
+{
+    // only the bulk operations are accounted in the devices' loads
+    ankerl::unordered_dense::map<std::string_view, DeviceLoad> loads;
+    for( const auto &running : _running ) {
+        if( running.profile == nullptr || running.profile->kind != SchedulingProfile::Kind::Bulk )
+            continue;
+        for( const auto &device : running.profile->devices ) {
+            auto &load = loads[device];
+            ++load.operations;
+            load.bytes_per_second += running.bytes_per_second;
+        }
+    }
+
+    std::vector<size_t> order(_pending.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::ranges::stable_sort(order, [&](size_t _lhs, size_t _rhs) {
+        return _pending[_lhs]->kind == SchedulingProfile::Kind::Interactive &&
+               _pending[_rhs]->kind != SchedulingProfile::Kind::Interactive;
+    });
+
+    std::vector<Decision> decisions;
+    decisions.reserve(_pending.size());
+    for( const size_t index : order ) {
+        const SchedulingProfile &profile = *_pending[index];
+        Decision decision;
+        decision.index = index;
+        if( _free_slots <= 0 ) {
+            decision.verdict = Verdict::WaitForSlot;
+        }
+        else if( profile.kind == SchedulingProfile::Kind::Bulk ) {
+            for( const auto &device : profile.devices ) {
+                const auto it = loads.find(device);
+                if( it == loads.end() )
+                    continue;
+                if( it->second.operations >= DeviceConcurrency(device) ) {
+                    decision.verdict = Verdict::WaitForDevice;
+                    decision.device = device;
+                    break;
+                }
+                if( const uint64_t budget = DeviceBandwidth(device);
+                    budget != 0 && it->second.bytes_per_second >= static_cast<double>(budget) ) {
+                    decision.verdict = Verdict::WaitForBandwidth;
+                    decision.device = device;
+                    break;
+                }
+            }
+        }
+
+        if( decision.verdict == Verdict::Start ) {
+            --_free_slots;
+            if( profile.kind == SchedulingProfile::Kind::Bulk )
+                for( const auto &device : profile.devices )
+                    ++loads[device].operations;
+        }
+        decisions.emplace_back(std::move(decision));
+    }
+
+    // the operations to start go first
+    std::ranges::stable_partition(decisions, [](const Decision &_d) { return _d.verdict == Verdict::Start; });
+    return decisions;
+}
+
+} // namespace nc::ops
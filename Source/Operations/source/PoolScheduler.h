@@ -0,0 +1,68 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "SchedulingProfile.h"
+#include <Base/UnorderedUtil.h>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace nc::ops {
+
+// Decides which of the pending operations of a Pool can be started, based on their scheduling profiles:
+// - the interactive operations go before the bulk ones, otherwise the order of enqueueing is kept;
+// - the number of running operations is limited globally by the pool;
+// - the number of running bulk operations touching the same device is limited per device;
+// - a bulk operation is not started on a device which already reaches its bandwidth budget.
+// The interactive operations obey only the global limit.
+// This class is not thread-safe.
+class PoolScheduler
+{
+public:
+    enum class Verdict : char {
+        Start = 0,
+        WaitForSlot = 1,     // the global concurrency limit is reached
+        WaitForDevice = 2,   // the concurrency limit of a device is reached
+        WaitForBandwidth = 3 // the bandwidth budget of a device is used up
+    };
+
+    struct Decision {
+        size_t index = 0; // in the pending operations
+        Verdict verdict = Verdict::Start;
+        std::string device; // the contended device, if any
+    };
+
+    struct Running {
+        const SchedulingProfile *profile = nullptr;
+        double bytes_per_second = 0.; // the current throughput of the operation
+    };
+
+    static constexpr int DefaultDeviceConcurrency = 2;
+
+    // Sets the limit for the devices without an explicit one.
+    void SetDeviceConcurrency(int _maximum_per_device);
+
+    // Sets the limit for a particular device, a non-positive value resets it to the default one.
+    void SetDeviceConcurrency(std::string_view _device, int _maximum);
+
+    // Sets the bandwidth budget of a device, zero means no budget.
+    void SetDeviceBandwidth(std::string_view _device, uint64_t _bytes_per_second);
+
+    // Returns a decision for each of the pending operations. The operations to start go in the order in which they
+    // should be started.
+    std::vector<Decision> Schedule(std::span<const Running> _running,
+                                   std::span<const SchedulingProfile *const> _pending,
+                                   int _free_slots) const;
+
+private:
+    int DeviceConcurrency(std::string_view _device) const noexcept;
+    uint64_t DeviceBandwidth(std::string_view _device) const noexcept;
+
+    int m_DeviceConcurrency = DefaultDeviceConcurrency;
+    ankerl::unordered_dense::map<std::string, int, UnorderedStringHashEqual, UnorderedStringHashEqual>
+        m_DevicesConcurrency;
+    ankerl::unordered_dense::map<std::string, uint64_t, UnorderedStringHashEqual, UnorderedStringHashEqual>
+        m_DevicesBandwidth;
+};
+
+} // namespace nc::ops
@@ -1,6 +1,8 @@
 // Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "PoolViewController.h"
 #include "Pool.h"
+#include "Operation.h"
+#include "Throttle.h"
 #include "Internal.h"
 #include "BriefOperationViewController.h"
 #include <Base/dispatch_cpp.h>
@@ -12,8 +14,9 @@ using namespace nc::ops;
 using namespace std::literals;
 
 static const auto g_ViewAppearTimeout = 100ms;
+static const int g_SpeedLimitsMB[] = {1, 10, 50, 100};
 
-@interface NCOpsPoolViewController ()
+@interface NCOpsPoolViewController () <NSMenuDelegate>
 @property(strong, nonatomic) IBOutlet NSView *idleViewHolder;
 @property(strong, nonatomic) IBOutlet NSView *briefViewHolder;
 @property(strong, nonatomic) IBOutlet NSButton *upButton;
@@ -44,6 +47,65 @@ static const auto g_ViewAppearTimeout = 100ms;
     return self;
 }
 
+- (void)viewDidLoad
+{
+    [super viewDidLoad];
+    NSMenu *menu = [[NSMenu alloc] init];
+    menu.delegate = self;
+    self.briefViewHolder.menu = menu;
+}
+
+- (void)menuNeedsUpdate:(NSMenu *)_menu
+{
+    [_menu removeAllItems];
+    if( !m_ShownOperation )
+        return;
+
+    const auto current_limit = m_ShownOperation->BandwidthLimit();
+    const auto add_limit_item = [&](NSString *_title, uint64_t _limit) {
+        NSMenuItem *item = [[NSMenuItem alloc] initWithTitle:_title
+                                                      action:@selector(onSetBandwidthLimit:)
+                                               keyEquivalent:@""];
+        item.target = self;
+        item.representedObject = @(_limit);
+        item.state = current_limit == _limit ? NSControlStateValueOn : NSControlStateValueOff;
+        [_menu addItem:item];
+    };
+    add_limit_item(NSLocalizedString(@"Unlimited Speed", "Menu item to remove the speed limit of an operation"), 0);
+    for( const int limit : g_SpeedLimitsMB )
+        add_limit_item([NSString localizedStringWithFormat:NSLocalizedString(@"Limit Speed to %d MB/s",
+                                                                             "Menu item to limit the speed of an "
+                                                                             "operation, e.g. 'Limit Speed to 10 MB/s'"),
+                                                           limit],
+                       uint64_t(limit) * 1024 * 1024);
+
+    [_menu addItem:NSMenuItem.separatorItem];
+    NSMenuItem *low_priority =
+        [[NSMenuItem alloc] initWithTitle:NSLocalizedString(@"Low Disk Priority",
+                                                            "Menu item to run an operation with the background I/O "
+                                                            "priority")
+                                   action:@selector(onToggleLowIOPriority:)
+                            keyEquivalent:@""];
+    low_priority.target = self;
+    low_priority.state =
+        m_ShownOperation->IOPriority() == IOPriority::Background ? NSControlStateValueOn : NSControlStateValueOff;
+    [_menu addItem:low_priority];
+}
+
+- (void)onSetBandwidthLimit:(NSMenuItem *)_sender
+{
+    if( m_ShownOperation )
+        m_Pool->SetBandwidthLimit(*m_ShownOperation, [_sender.representedObject unsignedLongLongValue]);
+}
+
+- (void)onToggleLowIOPriority:(NSMenuItem *) [[maybe_unused]] _sender
+{
+    if( !m_ShownOperation )
+        return;
+    const bool is_low = m_ShownOperation->IOPriority() == IOPriority::Background;
+    m_ShownOperation->SetIOPriority(is_low ? IOPriority::Default : IOPriority::Background);
+}
+
 - (void)poolDidChangeCallback
 {
     dispatch_to_main_queue([=] { [self poolDidChange]; });
@@ -32,11 +32,11 @@ void Progress::CommitSkipped(uint64_t _delta)
 void Progress::CommitProcessed(uint64_t _delta)
 {
     const auto current_time = base::machtime();
-    m_TimepointsLock.lock();
+    // the lock covers the timeline as well, since jobs may commit from several worker threads at once
+    const auto lock = std::lock_guard{m_TimepointsLock};
     const auto delta_time = current_time - m_LastCommitTimePoint;
     m_LastCommitTimePoint = current_time;
     m_Processed += _delta;
-    m_TimepointsLock.unlock();
 
     const auto fp_bytes = double(_delta);
     const auto fp_delta_time = static_cast<double>(delta_time.count()) / 1000000000.;
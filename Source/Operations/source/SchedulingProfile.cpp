@@ -0,0 +1,65 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "SchedulingProfile.h"
+#include <Utility/NativeFSManager.h>
+#include <VFS/Native.h>
+#include <algorithm>
+#include <fmt/format.h>
+
+namespace nc::ops {
+
+static constexpr size_t g_InteractiveMaxItems = 16;
+static constexpr uint64_t g_InteractiveMaxBytes = 16 * 1024 * 1024;
+
+// "/dev/disk3s1" -> "/dev/disk3"
+static std::string_view PhysicalDisk(std::string_view _device) noexcept
+{
+    constexpr std::string_view prefix = "/dev/disk";
+    if( !_device.starts_with(prefix) )
+        return _device;
+    const auto digits_end = _device.find_first_not_of("0123456789", prefix.size());
+    return digits_end == prefix.size() ? _device : _device.substr(0, digits_end);
+}
+
+void SchedulingProfile::AddDevice(const VFSHost &_host, std::string_view _path)
+{
+    auto device = DeviceIdentifier(_host, _path);
+    if( std::ranges::find(devices, device) == devices.end() )
+        devices.emplace_back(std::move(device));
+}
+
+void SchedulingProfile::AddDevices(std::span<const VFSListingItem> _items)
+{
+    for( const auto &item : _items )
+        AddDevice(*item.Host(), item.Directory());
+}
+
+std::string SchedulingProfile::DeviceIdentifier(const VFSHost &_host, std::string_view _path)
+{
+    if( const auto native = dynamic_cast<const vfs::NativeHost *>(&_host) ) {
+        // the volumes are looked up by the path strings only, there's no I/O involved
+        if( const auto volume = native->NativeFSManager().VolumeFromPathFast(_path) ) {
+            if( !volume->mounted_from_name.empty() )
+                return std::string(PhysicalDisk(volume->mounted_from_name));
+            return volume->mounted_at_path;
+        }
+        return "/";
+    }
+    if( const auto &parent = _host.Parent() )
+        return DeviceIdentifier(*parent, _host.JunctionPath());
+    return fmt::format("{}:{}", _host.Tag(), _host.JunctionPath());
+}
+
+SchedulingProfile::Kind SchedulingProfile::Classify(std::span<const VFSListingItem> _items) noexcept
+{
+    if( _items.size() > g_InteractiveMaxItems )
+        return Kind::Bulk;
+    uint64_t total = 0;
+    for( const auto &item : _items ) {
+        if( item.IsDir() )
+            return Kind::Bulk;
+        total += item.HasSize() ? item.Size() : 0;
+    }
+    return total <= g_InteractiveMaxBytes ? Kind::Interactive : Kind::Bulk;
+}
+
+} // namespace nc::ops
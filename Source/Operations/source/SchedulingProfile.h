@@ -0,0 +1,37 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <VFS/VFS.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nc::ops {
+
+// Describes the resources an operation is going to use, the Pool relies on it to decide when to start the operation.
+struct SchedulingProfile {
+    enum class Kind : char {
+        Bulk = 0,       // long-running, e.g. copying of directories, yields to the interactive ones
+        Interactive = 1 // short, e.g. creating a directory or renaming a few files, should start as soon as possible
+    };
+
+    Kind kind = Kind::Bulk;
+    std::vector<std::string> devices; // identifiers of the storages the operation reads from or writes to
+
+    // Adds the device of the path on the host, if not added yet.
+    void AddDevice(const VFSHost &_host, std::string_view _path);
+
+    // Adds the devices of the items.
+    void AddDevices(std::span<const VFSListingItem> _items);
+
+    // Returns an identifier of the storage behind the path. The native volumes are identified by their physical disks,
+    // so that e.g. the APFS volumes of the same container share it. The archives are identified by the storage of the
+    // archive file and the network hosts by their addresses.
+    static std::string DeviceIdentifier(const VFSHost &_host, std::string_view _path);
+
+    // Tells whether processing the items is going to be quick: a few files with a small total size and no directories.
+    static Kind Classify(std::span<const VFSListingItem> _items) noexcept;
+};
+
+} // namespace nc::ops
@@ -1,4 +1,4 @@
-// Copyright (C) 2017-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Statistics.h"
 #include <Base/mach_time.h>
 
@@ -89,6 +89,16 @@ void Statistics::CommitSkipped(SourceType _type, uint64_t _delta)
     Timeline(_type).CommitSkipped(_delta);
 }
 
+void Statistics::CommitWritten(uint64_t _delta) noexcept
+{
+    m_BytesWritten.fetch_add(_delta, std::memory_order_relaxed);
+}
+
+uint64_t Statistics::BytesWritten() const noexcept
+{
+    return m_BytesWritten.load(std::memory_order_relaxed);
+}
+
 std::vector<Progress::TimePoint> Statistics::BytesPerSecond() const
 {
     return m_BytesTimeline.Data();
@@ -1,7 +1,8 @@
-// Copyright (C) 2017-2018 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "Progress.h"
+#include <atomic>
 
 namespace nc::ops {
 
@@ -39,6 +40,11 @@ public:
     void CommitProcessed(SourceType _type, uint64_t _delta);
     void CommitSkipped(SourceType _type, uint64_t _delta);
 
+    // Amount of bytes which were actually written, can be less than the processed volume when only some parts of the
+    // existing files were rewritten. Can be called from any thread.
+    void CommitWritten(uint64_t _delta) noexcept;
+    uint64_t BytesWritten() const noexcept;
+
 private:
     Progress &Timeline(SourceType _type) noexcept;
     const Progress &Timeline(SourceType _type) const noexcept;
@@ -50,6 +56,7 @@ private:
     std::chrono::nanoseconds m_SleptTimeDuration;
     std::chrono::nanoseconds m_FinalTimeDuration;
     SourceType m_PreferredSource;
+    std::atomic_uint64_t m_BytesWritten{0};
 
     Progress m_BytesTimeline;
     Progress m_ItemsTimeline;
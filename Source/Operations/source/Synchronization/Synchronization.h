@@ -0,0 +1,43 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "TreeDiff.h"
+#include "../Copying/Options.h"
+#include "../Deletion/Options.h"
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace nc::ops {
+
+class Copying;
+class Deletion;
+class Pool;
+
+struct SynchronizationOptions {
+    bool delete_extraneous = false; // removes the items which exist only in the destination tree
+    CopyingOptions copying;         // the existing items are always overwritten
+    DeletionOptions deletion;
+};
+
+// The operations which bring the destination tree in line with the source one.
+// The deletion must be completed before the copying is started, since it removes the destination items which are
+// replaced by the source items of a different type, e.g. a file by a directory.
+struct SynchronizationPlan {
+    std::shared_ptr<Deletion> deletion; // can be null
+    std::shared_ptr<Copying> copying;   // can be null, places the items by their paths relative to the source root
+};
+
+// Turns the entries produced by synchronization::TreeDiff into the Copying and Deletion operations.
+SynchronizationPlan MakeSynchronizationPlan(std::span<const synchronization::DiffEntry> _entries,
+                                            const std::string &_source_path,
+                                            const std::string &_destination_path,
+                                            const VFSHostPtr &_destination_host,
+                                            const SynchronizationOptions &_options);
+
+// Enqueues the deletion of the plan and then, once it is completed, the copying.
+// Nothing is copied if the deletion is stopped.
+void EnqueueSynchronization(Pool &_pool, SynchronizationPlan _plan);
+
+} // namespace nc::ops
@@ -0,0 +1,70 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Synchronization.h"
+#include "../Copying/Copying.h"
+#include "../Deletion/Deletion.h"
+#include "../Pool.h"
+#include <Base/dispatch_cpp.h>
+
+namespace nc::ops {
+
+using synchronization::DiffEntry;
+
+SynchronizationPlan MakeSynchronizationPlan(std::span<const DiffEntry> _entries,
+                                            const std::string &_source_path,
+                                            const std::string &_destination_path,
+                                            const VFSHostPtr &_destination_host,
+                                            const SynchronizationOptions &_options)
+{
+    std::vector<VFSListingItem> to_delete;
+    std::vector<VFSListingItem> to_copy;
+    for( const auto &entry : _entries ) {
+        const bool replaced_by_other_type = entry.kind == DiffEntry::Kind::Changed && (entry.reasons & DiffEntry::Type);
+        if( entry.destination &&
+            (replaced_by_other_type || (entry.kind == DiffEntry::Kind::Deleted && _options.delete_extraneous)) )
+            to_delete.emplace_back(entry.destination);
+        if( entry.source )
+            to_copy.emplace_back(entry.source);
+    }
+
+    SynchronizationPlan plan;
+    if( !to_delete.empty() )
+        plan.deletion = std::make_shared<Deletion>(std::move(to_delete), _options.deletion);
+
+    if( !to_copy.empty() ) {
+        // TreeDiff descends only into the directories which exist in both trees, so every destination directory is
+        // already there and a single operation can place all the items by their paths relative to the source root.
+        CopyingOptions copying_options = _options.copying;
+        copying_options.docopy = true;
+        copying_options.exist_behavior = CopyingOptions::ExistBehavior::OverwriteAll;
+        copying_options.source_root = _source_path;
+        auto destination = _destination_path;
+        if( destination.empty() || destination.back() != '/' )
+            destination += '/';
+        plan.copying = std::make_shared<Copying>(std::move(to_copy), destination, _destination_host, copying_options);
+    }
+    return plan;
+}
+
+void EnqueueSynchronization(Pool &_pool, SynchronizationPlan _plan)
+{
+    if( !_plan.deletion ) {
+        if( _plan.copying )
+            _pool.Enqueue(_plan.copying);
+        return;
+    }
+    if( !_plan.copying ) {
+        _pool.Enqueue(_plan.deletion);
+        return;
+    }
+
+    const auto weak_pool = std::weak_ptr<Pool>{_pool.shared_from_this()};
+    _plan.deletion->ObserveUnticketed(Operation::NotifyAboutCompletion, [weak_pool, copying = _plan.copying] {
+        dispatch_to_main_queue([weak_pool, copying] {
+            if( const auto pool = weak_pool.lock() )
+                pool->Enqueue(copying);
+        });
+    });
+    _pool.Enqueue(_plan.deletion);
+}
+
+} // namespace nc::ops
@@ -0,0 +1,330 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "TreeDiff.h"
+#include <Base/DispatchGroup.h>
+#include <Base/DispatchStack.h>
+#include <Base/UnorderedUtil.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace nc::ops::synchronization {
+
+static constexpr size_t g_CompareChunkSize = 1024 * 1024;
+
+namespace {
+
+// A pair of the same-named directories, each side of it is listed as a separate task.
+struct DirectoryPair {
+    std::string path; // relative to the roots
+    VFSListingPtr listings[2];
+    int errors[2] = {VFSError::Ok, VFSError::Ok};
+    std::atomic_int pending{2};
+};
+
+struct Task {
+    std::shared_ptr<DirectoryPair> pair;
+    int side = 0; // 0 - source, 1 - destination
+};
+
+} // namespace
+
+class TreeDiff::Traversal
+{
+public:
+    Traversal(const TreeDiff &_diff,
+              const Callback &_callback,
+              const ErrorCallback &_error_callback,
+              const VFSCancelChecker &_cancel_checker);
+
+    int Run();
+
+private:
+    void Process(const Task &_task);
+    void Push(std::string _path);
+    void Fetch(DirectoryPair &_pair, int _side);
+    void Compare(const DirectoryPair &_pair);
+    void CompareItems(const std::string &_path, const VFSListingItem &_source, const VFSListingItem &_destination);
+    void ReportError(const std::string &_path, int _vfs_error);
+    bool IsCancelled();
+
+    const TreeDiff &m_Diff;
+    const Callback &m_Callback;
+    const ErrorCallback &m_ErrorCallback;
+    const VFSCancelChecker &m_CancelChecker;
+    const base::DispatchGroup m_Group;
+    // the queue is processed depth-first, this keeps the amount of the listings held in memory low
+    base::DispatchStack<Task> m_Tasks;
+    std::atomic_bool m_Cancelled{false};
+};
+
+static std::string JoinPath(std::string_view _directory, std::string_view _filename)
+{
+    std::string path;
+    path.reserve(_directory.length() + _filename.length() + 1);
+    path += _directory;
+    if( !path.empty() && path.back() != '/' )
+        path += '/';
+    path += _filename;
+    return path;
+}
+
+static bool IsNotFound(int _vfs_error) noexcept
+{
+    return _vfs_error == VFSError::NotFound || _vfs_error == VFSError::FromErrno(ENOENT);
+}
+
+// The symlinks are compared by their values and are never followed.
+static bool IsDirectory(const VFSListingItem &_item)
+{
+    return _item.IsDir() && !_item.IsSymlink();
+}
+
+static uint8_t Differences(const VFSListingItem &_source,
+                           const VFSListingItem &_destination,
+                           const TreeDiffOptions &_options)
+{
+    using R = DiffEntry::Reason;
+    if( _source.IsSymlink() != _destination.IsSymlink() )
+        return R::Type;
+    if( _source.IsSymlink() )
+        return _source.HasSymlink() && _destination.HasSymlink() && _source.Symlink() != _destination.Symlink()
+                   ? R::Contents
+                   : R::None;
+    if( _source.IsReg() != _destination.IsReg() )
+        return R::Type;
+    uint8_t reasons = R::None;
+    if( _options.compare_size && _source.HasSize() && _destination.HasSize() && _source.Size() != _destination.Size() )
+        reasons |= R::Size;
+    if( _options.compare_mtime && _source.HasMTime() && _destination.HasMTime() &&
+        _source.MTime() != _destination.MTime() )
+        reasons |= R::ModificationTime;
+    return reasons;
+}
+
+static ssize_t ReadExactly(VFSFile &_file, std::byte *_buf, size_t _size)
+{
+    size_t done = 0;
+    while( done < _size ) {
+        const ssize_t rc = _file.Read(_buf + done, _size - done);
+        if( rc < 0 )
+            return rc;
+        if( rc == 0 )
+            break;
+        done += rc;
+    }
+    return static_cast<ssize_t>(done);
+}
+
+static bool HaveSizes(const VFSListingItem &_source, const VFSListingItem &_destination)
+{
+    return _source.HasSize() && _destination.HasSize();
+}
+
+// Returns 1 if the contents of the files are the same, 0 if they differ or a negative VFSError.
+// The reading stops at the first differing chunk. The sizes are trusted only when both sides report them.
+static int SameContents(const VFSListingItem &_source,
+                        const VFSListingItem &_destination,
+                        const VFSCancelChecker &_cancel_checker)
+{
+    const bool have_sizes = HaveSizes(_source, _destination);
+    if( have_sizes && _source.Size() == 0 && _destination.Size() == 0 )
+        return 1;
+    std::shared_ptr<VFSFile> files[2];
+    const VFSListingItem *const items[2] = {&_source, &_destination};
+    for( int i = 0; i < 2; ++i ) {
+        if( const int rc = items[i]->Host()->CreateFile(items[i]->Path(), files[i], _cancel_checker);
+            rc != VFSError::Ok )
+            return rc;
+        if( const int rc = files[i]->Open(VFSFlags::OF_Read | VFSFlags::OF_NoCache, _cancel_checker);
+            rc != VFSError::Ok )
+            return rc;
+    }
+
+    const size_t chunk_size = have_sizes ? std::min(_source.Size(), uint64_t(g_CompareChunkSize)) : g_CompareChunkSize;
+    const auto buffer = std::make_unique<std::byte[]>(chunk_size * 2);
+    std::byte *const buffers[2] = {buffer.get(), buffer.get() + chunk_size};
+    while( true ) {
+        if( _cancel_checker && _cancel_checker() )
+            return VFSError::Cancelled;
+        ssize_t done[2];
+        for( int i = 0; i < 2; ++i )
+            if( done[i] = ReadExactly(*files[i], buffers[i], chunk_size); done[i] < 0 )
+                return static_cast<int>(done[i]);
+        if( done[0] != done[1] || std::memcmp(buffers[0], buffers[1], done[0]) != 0 )
+            return 0;
+        if( done[0] < static_cast<ssize_t>(chunk_size) )
+            return 1;
+    }
+}
+
+TreeDiff::Traversal::Traversal(const TreeDiff &_diff,
+                               const Callback &_callback,
+                               const ErrorCallback &_error_callback,
+                               const VFSCancelChecker &_cancel_checker)
+    : m_Diff(_diff), m_Callback(_callback), m_ErrorCallback(_error_callback), m_CancelChecker(_cancel_checker),
+      m_Tasks(m_Group, _diff.m_Options.concurrency, [this](Task _task) { Process(_task); })
+{
+}
+
+int TreeDiff::Traversal::Run()
+{
+    // the roots are listed right away to report their errors to the caller
+    DirectoryPair root;
+    Fetch(root, 0);
+    Fetch(root, 1);
+    if( root.errors[0] != VFSError::Ok )
+        return root.errors[0];
+    if( root.errors[1] != VFSError::Ok && !IsNotFound(root.errors[1]) )
+        return root.errors[1];
+
+    // the roots are compared while the dispatched blocks already process their subdirectories
+    Compare(root);
+    m_Group.Wait();
+
+    return m_Cancelled ? VFSError::Cancelled : VFSError::Ok;
+}
+
+void TreeDiff::Traversal::Process(const Task &_task)
+{
+    if( IsCancelled() )
+        return;
+    Fetch(*_task.pair, _task.side);
+    // the pair is compared by whoever finishes listing it last
+    if( --_task.pair->pending == 0 && !IsCancelled() ) {
+        const auto &pair = *_task.pair;
+        if( pair.errors[0] != VFSError::Ok )
+            ReportError(pair.path, pair.errors[0]);
+        else if( pair.errors[1] != VFSError::Ok )
+            ReportError(pair.path, pair.errors[1]);
+        else
+            Compare(pair);
+    }
+}
+
+void TreeDiff::Traversal::Push(std::string _path)
+{
+    auto pair = std::make_shared<DirectoryPair>();
+    pair->path = std::move(_path);
+    Task tasks[2] = {Task{pair, 1}, Task{pair, 0}};
+    m_Tasks.Push(tasks);
+}
+
+void TreeDiff::Traversal::Fetch(DirectoryPair &_pair, int _side)
+{
+    VFSHost &host = _side == 0 ? *m_Diff.m_SourceHost : *m_Diff.m_DestinationHost;
+    const std::string &root = _side == 0 ? m_Diff.m_SourcePath : m_Diff.m_DestinationPath;
+    _pair.errors[_side] = host.FetchDirectoryListing(
+        JoinPath(root, _pair.path), _pair.listings[_side], VFSFlags::F_NoDotDot, m_CancelChecker);
+}
+
+void TreeDiff::Traversal::Compare(const DirectoryPair &_pair)
+{
+    const VFSListing *const source = _pair.listings[0].get();
+    const VFSListing *const destination = _pair.listings[1].get();
+
+    ankerl::unordered_dense::map<std::string_view, unsigned, UnorderedStringHashEqual, UnorderedStringHashEqual>
+        destination_indices;
+    if( destination != nullptr )
+        for( unsigned i = 0, e = destination->Count(); i != e; ++i )
+            destination_indices.emplace(destination->Filename(i), i);
+
+    std::vector<bool> matched(destination ? destination->Count() : 0, false);
+    for( const auto &source_item : *source ) {
+        if( IsCancelled() )
+            return;
+        auto path = JoinPath(_pair.path, source_item.Filename());
+        const auto it = destination_indices.find(source_item.Filename());
+        if( it == destination_indices.end() ) {
+            m_Callback(DiffEntry{DiffEntry::Kind::New, DiffEntry::None, std::move(path), source_item, {}});
+            continue;
+        }
+        matched[it->second] = true;
+        CompareItems(path, source_item, destination->Item(it->second));
+    }
+
+    for( unsigned i = 0; i != matched.size(); ++i )
+        if( !matched[i] )
+            m_Callback(DiffEntry{DiffEntry::Kind::Deleted,
+                                 DiffEntry::None,
+                                 JoinPath(_pair.path, destination->Filename(i)),
+                                 {},
+                                 destination->Item(i)});
+}
+
+void TreeDiff::Traversal::CompareItems(const std::string &_path,
+                                       const VFSListingItem &_source,
+                                       const VFSListingItem &_destination)
+{
+    const bool source_is_dir = IsDirectory(_source);
+    if( source_is_dir != IsDirectory(_destination) ) {
+        m_Callback(DiffEntry{DiffEntry::Kind::Changed, DiffEntry::Type, _path, _source, _destination});
+        return;
+    }
+    if( source_is_dir ) {
+        Push(_path);
+        return;
+    }
+
+    uint8_t reasons = Differences(_source, _destination, m_Diff.m_Options);
+    // the contents are read only when the cheap checks didn't find any difference
+    if( reasons == DiffEntry::None && m_Diff.m_Options.compare_contents && _source.IsReg() &&
+        (!HaveSizes(_source, _destination) || _source.Size() == _destination.Size()) ) {
+        const int same = SameContents(_source, _destination, m_CancelChecker);
+        if( same == VFSError::Cancelled ) {
+            m_Cancelled = true;
+            return;
+        }
+        if( same < 0 ) {
+            ReportError(_path, same);
+            return;
+        }
+        if( same == 0 )
+            reasons = DiffEntry::Contents;
+    }
+    if( reasons != DiffEntry::None )
+        m_Callback(DiffEntry{DiffEntry::Kind::Changed, reasons, _path, _source, _destination});
+}
+
+void TreeDiff::Traversal::ReportError(const std::string &_path, int _vfs_error)
+{
+    if( _vfs_error == VFSError::Cancelled ) {
+        m_Cancelled = true;
+        return;
+    }
+    if( m_ErrorCallback )
+        m_ErrorCallback(_path, _vfs_error);
+}
+
+bool TreeDiff::Traversal::IsCancelled()
+{
+    if( !m_Cancelled && m_CancelChecker && m_CancelChecker() )
+        m_Cancelled = true;
+    return m_Cancelled;
+}
+
+TreeDiff::TreeDiff(VFSHostPtr _source_host,
+                   std::string _source_path,
+                   VFSHostPtr _destination_host,
+                   std::string _destination_path,
+                   const TreeDiffOptions &_options)
+    : m_SourceHost(std::move(_source_host)), m_SourcePath(std::move(_source_path)),
+      m_DestinationHost(std::move(_destination_host)), m_DestinationPath(std::move(_destination_path)),
+      m_Options(_options)
+{
+    assert(m_SourceHost && m_DestinationHost);
+}
+
+int TreeDiff::Run(const Callback &_callback,
+                  const ErrorCallback &_error_callback,
+                  const VFSCancelChecker &_cancel_checker) const
+{
+    if( !_callback )
+        return VFSError::InvalidCall;
+    Traversal traversal(*this, _callback, _error_callback, _cancel_checker);
+    return traversal.Run();
+}
+
+} // namespace nc::ops::synchronization
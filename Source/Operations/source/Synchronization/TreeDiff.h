@@ -0,0 +1,80 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <VFS/VFS.h>
+#include <functional>
+#include <string>
+
+namespace nc::ops::synchronization {
+
+struct DiffEntry {
+    enum class Kind : char {
+        New = 0,     // exists only in the source tree
+        Changed = 1, // exists in both trees, but differs
+        Deleted = 2  // exists only in the destination tree
+    };
+
+    // Why a Changed entry is considered to be different, a combination of flags.
+    enum Reason : uint8_t {
+        None = 0,
+        Type = 1 << 0,             // a directory on one side and a non-directory on the other, or a file vs a symlink
+        Size = 1 << 1,             // the sizes differ
+        ModificationTime = 1 << 2, // the modification times differ
+        Contents = 1 << 3          // the sizes are the same, but the contents or the symlink values differ
+    };
+
+    Kind kind = Kind::New;
+    uint8_t reasons = None;
+    std::string path;           // relative to the roots of the trees, e.g. "dir/file.txt"
+    VFSListingItem source;      // empty for Deleted
+    VFSListingItem destination; // empty for New
+};
+
+struct TreeDiffOptions {
+    bool compare_size = true;
+    bool compare_mtime = true;
+    bool compare_contents = false; // reads the regular files of the same size on both sides
+    size_t concurrency = 4;        // the number of directory pairs being processed at the same time
+};
+
+/**
+ * Compares two directory trees, possibly residing on different VFS hosts.
+ * The trees are traversed together: each pair of the same-named directories is listed on both sides, the listings are
+ * matched by filename and the common subdirectories are queued for processing. The pairs are processed by a bounded
+ * number of blocks running in a dispatch group, so the sibling subtrees are compared concurrently.
+ * A directory which exists only on one side is reported once as New or Deleted, without descending into it.
+ * The entries are reported as soon as they are found, in no particular order.
+ */
+class TreeDiff
+{
+public:
+    // Called from the background threads, possibly concurrently.
+    using Callback = std::function<void(DiffEntry _entry)>;
+
+    // Called for the directories which could not be compared, their subtrees are skipped.
+    using ErrorCallback = std::function<void(const std::string &_path, int _vfs_error)>;
+
+    TreeDiff(VFSHostPtr _source_host,
+             std::string _source_path,
+             VFSHostPtr _destination_host,
+             std::string _destination_path,
+             const TreeDiffOptions &_options = {});
+
+    // Blocks until the trees are compared or the comparison is cancelled.
+    // A non-existent destination directory is treated as an empty one.
+    // Returns VFSError::Ok or an error of listing the roots.
+    int Run(const Callback &_callback,
+            const ErrorCallback &_error_callback = {},
+            const VFSCancelChecker &_cancel_checker = {}) const;
+
+private:
+    class Traversal;
+
+    VFSHostPtr m_SourceHost;
+    std::string m_SourcePath;
+    VFSHostPtr m_DestinationHost;
+    std::string m_DestinationPath;
+    TreeDiffOptions m_Options;
+};
+
+} // namespace nc::ops::synchronization
@@ -0,0 +1,96 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Throttle.h"
+#include <sys/resource.h>
+#include <algorithm>
+
+namespace nc::ops {
+
+static constexpr std::chrono::milliseconds g_CancelCheckPeriod{100};
+
+Throttle::Throttle(uint64_t _bytes_per_second) noexcept : m_Rate(_bytes_per_second), m_LastRefill(Clock::now())
+{
+}
+
+void Throttle::SetRate(uint64_t _bytes_per_second)
+{
+    {
+        const auto guard = std::lock_guard{m_Lock};
+        if( m_Rate == _bytes_per_second )
+            return;
+        Refill(Clock::now()); // the tokens gathered so far are counted with the previous rate
+        m_Rate = _bytes_per_second;
+        if( m_Rate == 0 )
+            m_Tokens = 0.;
+        else
+            m_Tokens = std::min(m_Tokens, std::chrono::duration<double>(Burst).count() * static_cast<double>(m_Rate));
+    }
+    m_RateChanged.notify_all();
+}
+
+uint64_t Throttle::Rate() const noexcept
+{
+    const auto guard = std::lock_guard{m_Lock};
+    return m_Rate;
+}
+
+void Throttle::Refill(Clock::time_point _now) noexcept
+{
+    const auto elapsed = std::chrono::duration<double>(_now - m_LastRefill).count();
+    m_LastRefill = _now;
+    if( m_Rate == 0 )
+        return;
+    const double rate = static_cast<double>(m_Rate);
+    m_Tokens = std::min(m_Tokens + elapsed * rate, std::chrono::duration<double>(Burst).count() * rate);
+}
+
+bool Throttle::Consume(size_t _bytes, const std::function<bool()> &_cancel)
+{
+    auto lock = std::unique_lock{m_Lock};
+    if( m_Rate == 0 )
+        return true;
+
+    Refill(Clock::now());
+    m_Tokens -= static_cast<double>(_bytes);
+    while( m_Rate != 0 && m_Tokens < 0. ) {
+        if( _cancel && _cancel() )
+            return false;
+        const auto debt = std::chrono::duration<double>(-m_Tokens / static_cast<double>(m_Rate));
+        const auto wait = std::min(std::chrono::duration_cast<std::chrono::nanoseconds>(debt) +
+                                       std::chrono::nanoseconds{1},
+                                   std::chrono::nanoseconds{g_CancelCheckPeriod});
+        m_RateChanged.wait_for(lock, wait);
+        Refill(Clock::now());
+    }
+    return true;
+}
+
+static int ToIOPolicy(IOPriority _priority) noexcept
+{
+    switch( _priority ) {
+        case IOPriority::Utility:
+            return IOPOL_UTILITY;
+        case IOPriority::Background:
+            return IOPOL_THROTTLE;
+        default:
+            return IOPOL_DEFAULT;
+    }
+}
+
+void SetThreadIOPriority(IOPriority _priority) noexcept
+{
+    setiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD, ToIOPolicy(_priority));
+}
+
+ScopedIOPriority::ScopedIOPriority(IOPriority _priority) noexcept
+    : m_Previous(getiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD))
+{
+    SetThreadIOPriority(_priority);
+}
+
+ScopedIOPriority::~ScopedIOPriority()
+{
+    if( m_Previous >= 0 )
+        setiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD, m_Previous);
+}
+
+} // namespace nc::ops
@@ -0,0 +1,71 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace nc::ops {
+
+/**
+ * A thread-safe token bucket which limits the rate of I/O.
+ * The bucket is refilled continuously with the rate and can accumulate up to Burst worth of tokens while idle.
+ * A transfer larger than the available tokens is allowed to go into debt, which is then paid off by waiting, so
+ * the chunks of any size can be used.
+ * The rate can be changed at any moment, including while some threads are waiting in Consume().
+ */
+class Throttle
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // The period of time for which the unused tokens are accumulated.
+    static constexpr std::chrono::milliseconds Burst{100};
+
+    // Zero means no limit.
+    Throttle(uint64_t _bytes_per_second = 0) noexcept;
+
+    void SetRate(uint64_t _bytes_per_second);
+    uint64_t Rate() const noexcept;
+
+    // Takes the tokens for transferring _bytes and blocks until the debt, if any, is paid off.
+    // Returns false if _cancel returned true while waiting. _cancel is checked at least every 100ms.
+    bool Consume(size_t _bytes, const std::function<bool()> &_cancel = {});
+
+private:
+    void Refill(Clock::time_point _now) noexcept;
+
+    mutable std::mutex m_Lock;
+    std::condition_variable m_RateChanged;
+    uint64_t m_Rate = 0;
+    double m_Tokens = 0.;
+    Clock::time_point m_LastRefill;
+};
+
+// The classes of I/O priority, which map into the Darwin's disk I/O policies.
+enum class IOPriority : char {
+    Default = 0,   // IOPOL_DEFAULT
+    Utility = 1,   // IOPOL_UTILITY, yields to the interactive I/O
+    Background = 2 // IOPOL_THROTTLE, runs only when the disk is otherwise idle
+};
+
+// Sets the disk I/O policy of the calling thread.
+void SetThreadIOPriority(IOPriority _priority) noexcept;
+
+// Sets the disk I/O policy of the calling thread and restores the previous one on destruction.
+// Intended for the blocks which are executed on shared dispatch queues.
+class ScopedIOPriority
+{
+public:
+    ScopedIOPriority(IOPriority _priority) noexcept;
+    ~ScopedIOPriority();
+    ScopedIOPriority(const ScopedIOPriority &) = delete;
+    void operator=(const ScopedIOPriority &) = delete;
+
+private:
+    int m_Previous;
+};
+
+} // namespace nc::ops
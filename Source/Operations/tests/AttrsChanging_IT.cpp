@@ -1,11 +1,14 @@
-// Copyright (C) 2017-2020 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Tests.h"
 #include "TestEnv.h"
 #include <sys/stat.h>
 #include "../source/AttrsChanging/AttrsChanging.h"
 #include <VFS/Native.h>
+#include <atomic>
 #include <chrono>
+#include <fmt/format.h>
 #include <set>
+#include <thread>
 
 using namespace nc;
 using namespace nc::ops;
@@ -173,6 +176,123 @@ TEST_CASE(PREFIX "Item reporting")
     CHECK(processed == expected);
 }
 
+TEST_CASE(PREFIX "Wide trees are changed in batches, items without changes are left intact")
+{
+    const TempTestDir tmp_dir;
+    const auto native_host = TestEnv().vfs_native;
+    const auto root = tmp_dir.directory / "test";
+    const long mtime = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()) - 10'000;
+    REQUIRE(mkdir(root.c_str(), 0755) == 0);
+    std::vector<std::filesystem::path> files;
+    for( int d = 0; d < 3; ++d ) {
+        const auto dir = root / fmt::format("dir{}", d);
+        REQUIRE(mkdir(dir.c_str(), 0755) == 0);
+        for( int i = 0; i < 500; ++i ) {
+            files.emplace_back(dir / fmt::format("file{}", i));
+            close(creat(files.back().c_str(), i % 2 ? 0700 : 0755));
+        }
+    }
+
+    AttrsChangingCommand cmd;
+    cmd.items = FetchItems(tmp_dir.directory, {"test"}, *native_host);
+    cmd.permissions.emplace();
+    cmd.permissions->grp_r = false;
+    cmd.permissions->grp_x = false;
+    cmd.permissions->oth_r = false;
+    cmd.permissions->oth_x = false;
+    cmd.times.emplace();
+    cmd.times->mtime = mtime;
+    cmd.apply_to_subdirs = true;
+
+    AttrsChanging operation{cmd};
+    size_t processed = 0;
+    operation.SetItemStatusCallback([&](nc::ops::ItemStateReport) { ++processed; });
+    operation.Start();
+    operation.Wait();
+    REQUIRE(operation.State() == OperationState::Completed);
+    CHECK(processed == files.size() + 4);
+
+    for( const auto &path : files ) {
+        VFSStat st;
+        REQUIRE(native_host->Stat(path.c_str(), st, 0, {}) == VFSError::Ok);
+        CHECK((st.mode & ~S_IFMT) == 0700);
+        CHECK(st.mtime.tv_sec == mtime);
+    }
+
+    // the second pass has nothing to change, so it must not touch the items at all
+    VFSStat before;
+    REQUIRE(native_host->Stat(files.front().c_str(), before, 0, {}) == VFSError::Ok);
+    std::this_thread::sleep_for(1100ms);
+    cmd.items = FetchItems(tmp_dir.directory, {"test"}, *native_host);
+    AttrsChanging second{cmd};
+    second.Start();
+    second.Wait();
+    REQUIRE(second.State() == OperationState::Completed);
+    VFSStat after;
+    REQUIRE(native_host->Stat(files.front().c_str(), after, 0, {}) == VFSError::Ok);
+    CHECK(after.ctime.tv_sec == before.ctime.tv_sec);
+}
+
+TEST_CASE(PREFIX "A failed batch falls back to processing the items one by one")
+{
+    struct FailingHost : vfs::NativeHost {
+        using NativeHost::NativeHost;
+        int SetAttributes(std::span<const vfs::AttributesChange>,
+                          std::span<vfs::AttributesChangeResult>,
+                          const VFSCancelChecker &) override
+        {
+            ++batches;
+            return VFSError::FromErrno(ENOTCONN);
+        }
+        int SetPermissions(std::string_view _path, uint16_t _mode, const VFSCancelChecker &_cancel_checker) override
+        {
+            if( fail_permissions )
+                return VFSError::FromErrno(EPERM);
+            return NativeHost::SetPermissions(_path, _mode, _cancel_checker);
+        }
+        std::atomic_int batches{0};
+        bool fail_permissions = false;
+    };
+    const auto host = std::make_shared<FailingHost>(*TestEnv().native_fs_man, *TestEnv().fsevents_file_update);
+
+    const TempTestDir tmp_dir;
+    const auto path1 = tmp_dir.directory / "test1";
+    const auto path2 = tmp_dir.directory / "test2";
+    close(creat(path1.c_str(), 0755));
+    close(creat(path2.c_str(), 0755));
+    AttrsChangingCommand cmd;
+    cmd.items = FetchItems(tmp_dir.directory, {"test1", "test2"}, *host);
+    cmd.permissions.emplace();
+    cmd.permissions->oth_r = false;
+    cmd.permissions->oth_x = false;
+
+    SECTION("The items can be changed individually")
+    {
+        AttrsChanging operation{cmd};
+        size_t processed = 0;
+        operation.SetItemStatusCallback([&](nc::ops::ItemStateReport) { ++processed; });
+        operation.Start();
+        operation.Wait();
+        CHECK(host->batches > 0);
+        REQUIRE(operation.State() == OperationState::Completed);
+        CHECK(processed == 2);
+        VFSStat st;
+        REQUIRE(host->Stat(path1.c_str(), st, 0, {}) == VFSError::Ok);
+        CHECK((st.mode & ~S_IFMT) == 0750);
+        REQUIRE(host->Stat(path2.c_str(), st, 0, {}) == VFSError::Ok);
+        CHECK((st.mode & ~S_IFMT) == 0750);
+    }
+    SECTION("The errors of the individual items are reported")
+    {
+        host->fail_permissions = true;
+        AttrsChanging operation{cmd};
+        operation.Start();
+        operation.Wait();
+        // the non-interactive operation stops on the first chmod error instead of completing silently
+        CHECK(operation.State() == OperationState::Stopped);
+    }
+}
+
 static std::vector<VFSListingItem>
 FetchItems(const std::string &_directory_path, const std::vector<std::string> &_filenames, VFSHost &_host)
 {
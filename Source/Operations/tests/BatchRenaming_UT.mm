@@ -3,6 +3,7 @@
 #include "Tests.h"
 #include "TestEnv.h"
 #include "../source/BatchRenaming/BatchRenamingScheme.h"
+#include <fmt/format.h>
 
 #define PREFIX "Operations::BatchRenaming "
 
@@ -442,6 +443,63 @@ TEST_CASE(PREFIX "Renaming - simple cases")
     }
 }
 
+TEST_CASE(PREFIX "Renaming a batch gives the same results as the NSString-based renaming")
+{
+    const TempTestDir tmp_dir;
+    std::vector<BatchRenamingScheme::FileInfo> file_infos;
+    for( int i = 0; i < 1000; ++i ) {
+        const auto filename = i % 3 ? fmt::format("Photo_{}.JPG", i) : fmt::format("документ {}", i);
+        file_infos.emplace_back(GetRegListingItem(filename, tmp_dir.directory));
+    }
+
+    struct Case {
+        NSString *pattern;
+        NSString *search_for = @"";
+        NSString *replace_with = @"";
+        BatchRenamingScheme::CaseTransform case_transform = BatchRenamingScheme::CaseTransform::Unchanged;
+    };
+    const Case test_cases[] = {
+        {.pattern = @"[N]"},
+        {.pattern = @"[N2-4]_[C10+5:4].[E]"},
+        {.pattern = @"[N05-14][A-3,2][[x]]"},
+        {.pattern = @"[U][N][n]_[Y][M][D]", .search_for = @"PHOTO", .replace_with = @"img"},
+        {.pattern = @"[A]", .case_transform = BatchRenamingScheme::CaseTransform::Capitalized},
+        {.pattern = @"[P]-[G]-[N]", .search_for = @"_", .replace_with = @" "},
+    };
+    const auto make_scheme = [](const Case &_case, NSString *_pattern) {
+        BatchRenamingScheme scheme;
+        REQUIRE(scheme.BuildActionsScript(_pattern));
+        scheme.SetReplacingOptions(_case.search_for, _case.replace_with, false, false, true, false);
+        scheme.SetCaseTransform(_case.case_transform, false);
+        return scheme;
+    };
+    for( const auto &test_case : test_cases ) {
+        INFO(test_case.pattern.UTF8String);
+        const auto scheme = make_scheme(test_case, test_case.pattern);
+        // a trailing case transform doesn't change the result, but makes the scheme use the NSString-based path
+        const auto reference = make_scheme(test_case, [test_case.pattern stringByAppendingString:@"[U]"]);
+
+        const auto renamed = scheme.Rename(file_infos);
+        const auto staged = scheme.ApplyPostprocessing(scheme.ApplyMask(file_infos));
+        REQUIRE(renamed.size() == file_infos.size());
+        REQUIRE(staged.size() == file_infos.size());
+        for( size_t i = 0; i != file_infos.size(); ++i ) {
+            NSString *const expected = reference.Rename(file_infos[i], static_cast<int>(i));
+            INFO(expected.UTF8String);
+            REQUIRE([renamed[i] isEqualToString:expected]);
+            REQUIRE([staged[i] isEqualToString:expected]);
+        }
+    }
+
+    // and some absolute values in case both paths go wrong in the same way
+    const auto scheme = make_scheme({}, @"[N2-4]_[C10+5:4].[E]");
+    const auto renamed = scheme.Rename(std::span{file_infos}.first(3));
+    REQUIRE(renamed.size() == 3);
+    CHECK([renamed[0] isEqualToString:@"оку_0010."]);
+    CHECK([renamed[1] isEqualToString:@"hot_0015.JPG"]);
+    CHECK([renamed[2] isEqualToString:@"hot_0020.JPG"]);
+}
+
 static VFSListingItem GetRegListingItem(const std::string &_filename, const std::filesystem::path &_at)
 {
     REQUIRE(close(creat((_at / _filename).c_str(), 0755)) == 0);
@@ -1,9 +1,10 @@
-// Copyright (C) 2017-2020 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Tests.h"
 #include "TestEnv.h"
 #include <filesystem>
 #include <sys/stat.h>
 #include <set>
+#include <fmt/format.h>
 
 #include "../source/Compression/Compression.h"
 #include "../source/Statistics.h"
@@ -27,6 +28,8 @@ static int VFSCompareEntries(const std::filesystem::path &_file1_full_path,
 static std::vector<VFSListingItem>
 FetchItems(const std::string &_directory_path, const std::vector<std::string> &_filenames, VFSHost &_host);
 
+static bool WriteFile(const std::filesystem::path &_path, std::string_view _data);
+
 TEST_CASE(PREFIX "Empty archive building")
 {
     const TempTestDir tmp_dir;
@@ -255,6 +258,165 @@ TEST_CASE(PREFIX "Item reporting")
     CHECK(processed == expected);
 }
 
+TEST_CASE(PREFIX "Big files are compressed losslessly in chunks")
+{
+    const TempTestDir tmp_dir;
+    const auto native_host = TestEnv().vfs_native;
+    std::string data;
+    for( int i = 0; data.size() < 5'000'000; ++i )
+        data += fmt::format("line #{}: {}\n", i, i * i % 7919);
+    REQUIRE(mkdir((tmp_dir.directory / "dir").c_str(), 0755) == 0);
+    REQUIRE(WriteFile(tmp_dir.directory / "dir/big.txt", data));
+    REQUIRE(WriteFile(tmp_dir.directory / "dir/exact.txt", std::string_view(data).substr(0, 1024 * 1024)));
+    REQUIRE(WriteFile(tmp_dir.directory / "dir/small.txt", std::string_view(data).substr(0, 1000)));
+    REQUIRE(WriteFile(tmp_dir.directory / "dir/empty.txt", {}));
+
+    Compression operation{FetchItems(tmp_dir.directory, {"dir"}, *native_host), tmp_dir.directory, native_host};
+    operation.Start();
+    operation.Wait();
+    REQUIRE(operation.State() == OperationState::Completed);
+
+    VFSStat arc_stat;
+    REQUIRE(native_host->Stat(operation.ArchivePath().c_str(), arc_stat, 0) == VFSError::Ok);
+    CHECK(arc_stat.size < data.size() / 2);
+
+    std::shared_ptr<vfs::ArchiveHost> arc_host;
+    REQUIRE_NOTHROW(arc_host = std::make_shared<vfs::ArchiveHost>(operation.ArchivePath().c_str(), native_host));
+    for( auto filename : {"big.txt", "exact.txt", "small.txt", "empty.txt"} ) {
+        int cmp_result = 0;
+        const auto src_path = tmp_dir.directory / "dir" / filename;
+        const auto arc_path = std::string("/dir/") + filename;
+        const auto cmp_rc =
+            VFSEasyCompareFiles(src_path.c_str(), native_host, arc_path.c_str(), arc_host, cmp_result);
+        CHECK(cmp_rc == VFSError::Ok);
+        CHECK(cmp_result == 0);
+    }
+}
+
+TEST_CASE(PREFIX "Compression level 0 stores the files as-is")
+{
+    const TempTestDir tmp_dir;
+    const auto native_host = TestEnv().vfs_native;
+    const std::string data(3'000'000, 'a');
+    REQUIRE(WriteFile(tmp_dir.directory / "a.txt", data));
+
+    CompressionOptions options;
+    options.zip.level = 0;
+    Compression operation{
+        FetchItems(tmp_dir.directory, {"a.txt"}, *native_host), tmp_dir.directory, native_host, options};
+    operation.Start();
+    operation.Wait();
+    REQUIRE(operation.State() == OperationState::Completed);
+
+    VFSStat arc_stat;
+    REQUIRE(native_host->Stat(operation.ArchivePath().c_str(), arc_stat, 0) == VFSError::Ok);
+    CHECK(arc_stat.size > data.size());
+
+    std::shared_ptr<vfs::ArchiveHost> arc_host;
+    REQUIRE_NOTHROW(arc_host = std::make_shared<vfs::ArchiveHost>(operation.ArchivePath().c_str(), native_host));
+    int cmp_result = 0;
+    const auto cmp_rc =
+        VFSEasyCompareFiles((tmp_dir.directory / "a.txt").c_str(), native_host, "/a.txt", arc_host, cmp_result);
+    CHECK(cmp_rc == VFSError::Ok);
+    CHECK(cmp_result == 0);
+}
+
+TEST_CASE(PREFIX "Files with extensions of compressed formats are not deflated")
+{
+    const TempTestDir tmp_dir;
+    const auto native_host = TestEnv().vfs_native;
+    const std::string data(3'000'000, 'a');
+    REQUIRE(WriteFile(tmp_dir.directory / "a.JPG", data));
+
+    SECTION("By default")
+    {
+        Compression operation{FetchItems(tmp_dir.directory, {"a.JPG"}, *native_host), tmp_dir.directory, native_host};
+        operation.Start();
+        operation.Wait();
+        REQUIRE(operation.State() == OperationState::Completed);
+        VFSStat arc_stat;
+        REQUIRE(native_host->Stat(operation.ArchivePath().c_str(), arc_stat, 0) == VFSError::Ok);
+        CHECK(arc_stat.size > data.size());
+    }
+    SECTION("Unless asked to")
+    {
+        CompressionOptions options;
+        options.zip.store_compressed_files = false;
+        Compression operation{
+            FetchItems(tmp_dir.directory, {"a.JPG"}, *native_host), tmp_dir.directory, native_host, options};
+        operation.Start();
+        operation.Wait();
+        REQUIRE(operation.State() == OperationState::Completed);
+        VFSStat arc_stat;
+        REQUIRE(native_host->Stat(operation.ArchivePath().c_str(), arc_stat, 0) == VFSError::Ok);
+        CHECK(arc_stat.size < data.size() / 100);
+    }
+}
+
+TEST_CASE(PREFIX "Compressing into other archive formats")
+{
+    const TempTestDir tmp_dir;
+    const auto native_host = TestEnv().vfs_native;
+    std::string data;
+    for( int i = 0; data.size() < 3'000'000; ++i )
+        data += fmt::format("line #{}: {}\n", i, i * i % 7919);
+    REQUIRE(mkdir((tmp_dir.directory / "dir").c_str(), 0755) == 0);
+    REQUIRE(WriteFile(tmp_dir.directory / "dir/big.txt", data));
+    REQUIRE(WriteFile(tmp_dir.directory / "dir/small.txt", std::string_view(data).substr(0, 1000)));
+    REQUIRE(symlink("./small.txt", (tmp_dir.directory / "dir/link").c_str()) == 0);
+
+    CompressionOptions options;
+    std::string extension;
+    SECTION("tar.zst")
+    {
+        options.format = CompressionFormat::TarZstd;
+        options.zstd.level = 5;
+        options.zstd.threads = 2;
+        extension = ".tar.zst";
+    }
+    SECTION("tar.xz")
+    {
+        options.format = CompressionFormat::TarXz;
+        options.xz.level = 1;
+        extension = ".tar.xz";
+    }
+    SECTION("7z")
+    {
+        options.format = CompressionFormat::SevenZip;
+        options.seven_zip.method = CompressionOptions::SevenZip::Method::LZMA2;
+        extension = ".7z";
+    }
+    Compression operation{
+        FetchItems(tmp_dir.directory, {"dir"}, *native_host), tmp_dir.directory, native_host, options};
+    operation.Start();
+    operation.Wait();
+    REQUIRE(operation.State() == OperationState::Completed);
+    CHECK(operation.ArchivePath() == (tmp_dir.directory / ("dir" + extension)).native());
+
+    std::shared_ptr<vfs::ArchiveHost> arc_host;
+    REQUIRE_NOTHROW(arc_host = std::make_shared<vfs::ArchiveHost>(operation.ArchivePath().c_str(), native_host));
+    int cmp_result = 0;
+    const auto cmp_rc = VFSCompareEntries(tmp_dir.directory / "dir", native_host, "/dir", arc_host, cmp_result);
+    CHECK(cmp_rc == VFSError::Ok);
+    CHECK(cmp_result == 0);
+}
+
+TEST_CASE(PREFIX "A password is rejected for the formats without encryption")
+{
+    const TempTestDir tmp_dir;
+    const auto native_host = TestEnv().vfs_native;
+    REQUIRE(WriteFile(tmp_dir.directory / "file.txt", "hello"));
+    const auto items = FetchItems(tmp_dir.directory, {"file.txt"}, *native_host);
+
+    CompressionOptions options{"secret"};
+    for( const auto format : {CompressionFormat::TarZstd, CompressionFormat::TarXz, CompressionFormat::SevenZip} ) {
+        options.format = format;
+        CHECK_THROWS_AS(Compression(items, tmp_dir.directory, native_host, options), std::invalid_argument);
+    }
+    options.format = CompressionFormat::Zip;
+    CHECK_NOTHROW(Compression(items, tmp_dir.directory, native_host, options));
+}
+
 static int VFSCompareEntries(const std::filesystem::path &_file1_full_path,
                              const VFSHostPtr &_file1_host,
                              const std::filesystem::path &_file2_full_path,
@@ -308,3 +470,13 @@ FetchItems(const std::string &_directory_path, const std::vector<std::string> &_
     _host.FetchFlexibleListingItems(_directory_path, _filenames, 0, items, nullptr);
     return items;
 }
+
+static bool WriteFile(const std::filesystem::path &_path, std::string_view _data)
+{
+    const int fd = open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IWUSR | S_IRUSR);
+    if( fd < 0 )
+        return false;
+    const bool written = write(fd, _data.data(), _data.size()) == static_cast<ssize_t>(_data.size());
+    close(fd);
+    return written;
+}
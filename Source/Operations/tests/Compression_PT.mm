@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+// #define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "Tests.h"
+#include "TestEnv.h"
+#include <random>
+#include <fmt/format.h>
+#include <sys/stat.h>
+#include "../source/Compression/Compression.h"
+#include <VFS/VFS.h>
+#include <VFS/Native.h>
+
+using namespace nc;
+using namespace nc::ops;
+
+#define PREFIX "Operations::Compression PT "
+
+static const std::string_view g_Words[] = {"alpha", "bravo", "charlie", "delta",  "echo",   "foxtrot", "golf",
+                                           "hotel", "india", "juliet",  "kilo",   "lima",   "mike",    "november",
+                                           "oscar", "papa",  "quebec",  "romeo",  "sierra", "tango",   "uniform",
+                                           "victor", "whiskey", "xray", "yankee", "zulu"};
+
+static void WriteSyntheticFile(const std::filesystem::path &_path, size_t _size, std::mt19937 &_rng)
+{
+    std::uniform_int_distribution<size_t> word(0, std::size(g_Words) - 1);
+    std::uniform_int_distribution<int> number(0, 1000000);
+    std::string data;
+    data.reserve(_size + 64);
+    while( data.size() < _size )
+        data += fmt::format("{} {} {}\n", g_Words[word(_rng)], number(_rng), g_Words[word(_rng)]);
+    data.resize(_size);
+    const int fd = open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IWUSR | S_IRUSR);
+    REQUIRE(fd >= 0);
+    REQUIRE(write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    close(fd);
+}
+
+// A tree of ~330MB: 64 big text files and 2000 small ones spread across 20 directories.
+static void BuildSyntheticTree(const std::filesystem::path &_root)
+{
+    std::mt19937 rng(42);
+    REQUIRE(mkdir((_root / "tree").c_str(), 0755) == 0);
+    for( int i = 0; i < 64; ++i )
+        WriteSyntheticFile(_root / "tree" / fmt::format("big{}.txt", i), 5 * 1024 * 1024, rng);
+    for( int d = 0; d < 20; ++d ) {
+        const auto dir = _root / "tree" / fmt::format("dir{}", d);
+        REQUIRE(mkdir(dir.c_str(), 0755) == 0);
+        for( int i = 0; i < 100; ++i )
+            WriteSyntheticFile(dir / fmt::format("small{}.txt", i), 4096 + i * 37, rng);
+    }
+}
+
+static void Compress(const std::filesystem::path &_root, const CompressionOptions &_options)
+{
+    const auto native_host = TestEnv().vfs_native;
+    std::vector<VFSListingItem> items;
+    native_host->FetchFlexibleListingItems(_root, {"tree"}, 0, items, nullptr);
+    Compression operation{items, _root, native_host, _options};
+    operation.Start();
+    operation.Wait();
+    REQUIRE(operation.State() == OperationState::Completed);
+    std::filesystem::remove(operation.ArchivePath());
+}
+
+TEST_CASE(PREFIX "Compressing a synthetic tree", "[!benchmark]")
+{
+    const TempTestDir tmp_dir;
+    BuildSyntheticTree(tmp_dir.directory);
+
+    BENCHMARK("Default level")
+    {
+        Compress(tmp_dir.directory, CompressionOptions{});
+    };
+    BENCHMARK("Fastest level")
+    {
+        CompressionOptions options;
+        options.zip.level = 1;
+        Compress(tmp_dir.directory, options);
+    };
+    BENCHMARK("Store only")
+    {
+        CompressionOptions options;
+        options.zip.level = 0;
+        Compress(tmp_dir.directory, options);
+    };
+    BENCHMARK("tar.zst")
+    {
+        CompressionOptions options;
+        options.format = CompressionFormat::TarZstd;
+        Compress(tmp_dir.directory, options);
+    };
+    BENCHMARK("tar.xz")
+    {
+        CompressionOptions options;
+        options.format = CompressionFormat::TarXz;
+        Compress(tmp_dir.directory, options);
+    };
+    BENCHMARK("Encrypted, single-threaded")
+    {
+        Compress(tmp_dir.directory, CompressionOptions{"password"});
+    };
+}
@@ -0,0 +1,144 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "TestEnv.h"
+#include "../source/Copying/TransferJournal.h"
+#include <fstream>
+
+using nc::ops::copying::TransferJournal;
+
+#define PREFIX "nc::ops::copying::TransferJournal "
+
+TEST_CASE(PREFIX "is empty when there's no file")
+{
+    const TempTestDir dir;
+    const TransferJournal journal(dir.directory / "journal");
+    CHECK(journal.Find("/some/path") == nullptr);
+    CHECK(!std::filesystem::exists(dir.directory / "journal"));
+}
+
+TEST_CASE(PREFIX "paths depend on the operation key")
+{
+    const TempTestDir dir;
+    const auto p1 = TransferJournal::PathFor(dir.directory, "key1");
+    const auto p2 = TransferJournal::PathFor(dir.directory, "key2");
+    CHECK(p1 == TransferJournal::PathFor(dir.directory, "key1"));
+    CHECK(p1 != p2);
+    CHECK(p1.parent_path() == dir.directory);
+}
+
+TEST_CASE(PREFIX "the records survive reloading and the latest one wins")
+{
+    const TempTestDir dir;
+    const auto path = dir.directory / "journal";
+    const TransferJournal::SourceIdentity source{1000, {1700000000, 123}};
+    const TransferJournal::DestinationIdentity destination{42, {1700000001, 456}};
+    const uint8_t checksum[TransferJournal::ChecksumSize] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 255};
+    {
+        TransferJournal journal(path);
+        journal.Progress("/dst/file 1", source, {}, 100);
+        journal.Progress("/dst/file 1", source, destination, 300);
+        journal.Finished("/dst/file 2", source, destination, std::span<const uint8_t>(checksum));
+        journal.Finished("/dst/file 3", source, destination);
+        REQUIRE(journal.Find("/dst/file 1") != nullptr);
+        CHECK(journal.Find("/dst/file 1")->completed == 300);
+    }
+    const TransferJournal journal(path);
+
+    const auto r1 = journal.Find("/dst/file 1");
+    REQUIRE(r1 != nullptr);
+    CHECK(r1->source == source);
+    CHECK(r1->destination == destination);
+    CHECK(r1->completed == 300);
+    CHECK(r1->finished == false);
+    CHECK(r1->checksum == std::nullopt);
+
+    const auto r2 = journal.Find("/dst/file 2");
+    REQUIRE(r2 != nullptr);
+    CHECK(r2->completed == 1000);
+    CHECK(r2->finished == true);
+    REQUIRE(r2->checksum);
+    CHECK(std::ranges::equal(*r2->checksum, checksum));
+
+    const auto r3 = journal.Find("/dst/file 3");
+    REQUIRE(r3 != nullptr);
+    CHECK(r3->finished == true);
+    CHECK(r3->checksum == std::nullopt);
+}
+
+TEST_CASE(PREFIX "ignores malformed and incomplete records")
+{
+    const TempTestDir dir;
+    const auto path = dir.directory / "journal";
+    {
+        std::ofstream f(path);
+        f << "P 100 1 2 3 4 5 50 /dst/a\n";
+        f << "X 100 1 2 3 4 5 50 /dst/b\n";
+        f << "P 100 1 2 3 4 5 500 /dst/c\n";
+        f << "F 100 1 2 3 4 5 abcd /dst/d\n";
+        f << "P 100 1 2 50 /dst/e\n"; // no destination identity
+        f << "P 100 1 2 3 4 5 70 /dst/a"; // no newline - a write was interrupted
+    }
+    const TransferJournal journal(path);
+    REQUIRE(journal.Find("/dst/a") != nullptr);
+    CHECK(journal.Find("/dst/a")->completed == 50);
+    CHECK(journal.Find("/dst/b") == nullptr);
+    CHECK(journal.Find("/dst/c") == nullptr);
+    CHECK(journal.Find("/dst/d") == nullptr);
+    CHECK(journal.Find("/dst/e") == nullptr);
+}
+
+TEST_CASE(PREFIX "new records don't get glued to an incomplete one")
+{
+    const TempTestDir dir;
+    const auto path = dir.directory / "journal";
+    {
+        std::ofstream f(path);
+        f << "P 100 1 2 3 4 5 50 /dst/a\n";
+        f << "P 100 1 2 3 4 5 7"; // the tail of a write that was cut short
+    }
+    {
+        TransferJournal journal(path);
+        journal.Progress("/dst/b", {200, {1, 2}}, {3, {4, 5}}, 80);
+    }
+    const TransferJournal journal(path);
+    REQUIRE(journal.Find("/dst/a") != nullptr);
+    CHECK(journal.Find("/dst/a")->completed == 50);
+    REQUIRE(journal.Find("/dst/b") != nullptr);
+    CHECK(journal.Find("/dst/b")->completed == 80);
+
+    std::ifstream f(path);
+    const std::string contents{std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()};
+    CHECK(contents == "P 100 1 2 3 4 5 50 /dst/a\nP 200 1 2 3 4 5 80 /dst/b\n");
+}
+
+TEST_CASE(PREFIX "removal deletes the file")
+{
+    const TempTestDir dir;
+    const auto path = dir.directory / "journal";
+    TransferJournal journal(path);
+    journal.Progress("/dst/file", {10, {1, 1}}, {}, 5);
+    CHECK(std::filesystem::exists(path));
+    journal.Remove();
+    CHECK(!std::filesystem::exists(path));
+    CHECK(journal.Find("/dst/file") == nullptr);
+}
+
+TEST_CASE(PREFIX "expired journals are removed")
+{
+    const TempTestDir dir;
+    const auto old_journal = TransferJournal::PathFor(dir.directory, "old");
+    const auto new_journal = TransferJournal::PathFor(dir.directory, "new");
+    const auto other = dir.directory / "other.journal";
+    for( const auto &path : {old_journal, new_journal, other} ) {
+        std::ofstream f(path);
+        f << "P 100 1 2 3 4 5 50 /dst/a\n";
+    }
+    const auto long_ago = std::filesystem::file_time_type::clock::now() - std::chrono::days{30};
+    std::filesystem::last_write_time(old_journal, long_ago);
+    std::filesystem::last_write_time(other, long_ago);
+
+    TransferJournal::RemoveExpired(dir.directory, std::chrono::days{7});
+    CHECK(!std::filesystem::exists(old_journal));
+    CHECK(std::filesystem::exists(new_journal));
+    CHECK(std::filesystem::exists(other));
+}
@@ -1,6 +1,7 @@
 // Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Tests.h"
 #include "TestEnv.h"
+#include "../source/Statistics.h"
 #include <Operations/Copying.h>
 #include <Utility/NativeFSManager.h>
 #include <VFS/Native.h>
@@ -1504,6 +1505,124 @@ TEST_CASE(PREFIX "Copying a native file that is being written to")
     CHECK(sz_b < sz_a);
 }
 
+TEST_CASE(PREFIX "Overwriting with changed blocks only")
+{
+    const TempTestDir tmp_dir;
+    const auto host = TestEnv().vfs_native;
+    const size_t size = 10'000'000;
+    const auto original = MakeNoise(size);
+    auto changed = original;
+    for( size_t i = 5'000'000; i < 5'000'100; ++i )
+        changed[i] = ~changed[i];
+    changed.resize(size + 1000, std::byte{42});
+    REQUIRE(Save(tmp_dir.directory / "src.zzz", changed));
+    REQUIRE(Save(tmp_dir.directory / "dst.zzz", original));
+
+    CopyingOptions opts;
+    opts.docopy = true;
+    opts.exist_behavior = CopyingOptions::ExistBehavior::OverwriteAll;
+    opts.overwrite_changed_blocks_only = true;
+    opts.verification = CopyingOptions::ChecksumVerification::Always;
+    Copying op(FetchItems(tmp_dir.directory, {"src.zzz"}, *host), tmp_dir.directory / "dst.zzz", host, opts);
+    RunOperationAndCheckSuccess(op);
+
+    int result = 0;
+    REQUIRE(VFSEasyCompareFiles(
+                (tmp_dir.directory / "src.zzz").c_str(), host, (tmp_dir.directory / "dst.zzz").c_str(), host, result) ==
+            0);
+    CHECK(result == 0);
+    CHECK(op.Statistics().BytesWritten() > 0);
+    CHECK(op.Statistics().BytesWritten() < size / 10);
+}
+
+TEST_CASE(PREFIX "An interrupted copy is resumed by a re-run of the same operation")
+{
+    const TempTestDir tmp_dir;
+    const auto host = TestEnv().vfs_native;
+    const size_t size = 160'000'000; // large enough to pass a few checkpoints of the journal
+    REQUIRE(Save(tmp_dir.directory / "src.zzz", MakeNoise(size)));
+
+    CopyingOptions opts;
+    opts.docopy = true;
+    const auto dst = tmp_dir.directory / "dst.zzz";
+    {
+        Copying op(FetchItems(tmp_dir.directory, {"src.zzz"}, *host), dst, host, opts);
+        op.SetBandwidthLimit(32 * 1024 * 1024); // slow enough to interrupt it midway
+        op.Start();
+        while( op.State() != OperationState::Completed && op.Statistics().BytesWritten() < 96 * 1024 * 1024 )
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        op.Interrupt();
+        op.Wait();
+        REQUIRE(op.State() == OperationState::Stopped);
+    }
+    // the journaled part of the destination is kept
+    REQUIRE(std::filesystem::exists(dst));
+    const auto kept = std::filesystem::file_size(dst);
+    CHECK(kept > 0);
+    CHECK(kept < size);
+
+    Copying op(FetchItems(tmp_dir.directory, {"src.zzz"}, *host), dst, host, opts);
+    RunOperationAndCheckSuccess(op);
+    CHECK(op.Statistics().BytesWritten() == size - kept);
+
+    int result = 0;
+    REQUIRE(VFSEasyCompareFiles((tmp_dir.directory / "src.zzz").c_str(), host, dst.c_str(), host, result) == 0);
+    CHECK(result == 0);
+}
+
+TEST_CASE(PREFIX "A cancelled copy doesn't leave a partial destination behind")
+{
+    const TempTestDir tmp_dir;
+    const auto host = TestEnv().vfs_native;
+    const size_t size = 160'000'000; // large enough to pass a few checkpoints of the journal
+    REQUIRE(Save(tmp_dir.directory / "src.zzz", MakeNoise(size)));
+
+    CopyingOptions opts;
+    opts.docopy = true;
+    const auto dst = tmp_dir.directory / "dst.zzz";
+    Copying op(FetchItems(tmp_dir.directory, {"src.zzz"}, *host), dst, host, opts);
+    op.SetBandwidthLimit(32 * 1024 * 1024); // slow enough to cancel it midway
+    op.Start();
+    while( op.State() != OperationState::Completed && op.Statistics().BytesWritten() < 96 * 1024 * 1024 )
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    op.Stop();
+    op.Wait();
+    REQUIRE(op.State() == OperationState::Stopped);
+    CHECK(!std::filesystem::exists(dst));
+}
+
+TEST_CASE(PREFIX "Items below the source root keep their relative paths")
+{
+    const TempTestDir tmp_dir;
+    const auto host = TestEnv().vfs_native;
+    std::filesystem::create_directories(tmp_dir.directory / "src/a/b");
+    std::filesystem::create_directories(tmp_dir.directory / "dst/a/b");
+    REQUIRE(Save(tmp_dir.directory / "src/1.txt", MakeNoise(10)));
+    REQUIRE(Save(tmp_dir.directory / "src/a/2.txt", MakeNoise(20)));
+    REQUIRE(Save(tmp_dir.directory / "src/a/b/3.txt", MakeNoise(30)));
+
+    std::vector<VFSListingItem> items;
+    for( const auto &[dir, file] : {std::pair{"src", "1.txt"}, {"src/a", "2.txt"}, {"src/a/b", "3.txt"}} ) {
+        auto fetched = FetchItems(tmp_dir.directory / dir, {file}, *host);
+        REQUIRE(fetched.size() == 1);
+        items.emplace_back(fetched.front());
+    }
+
+    CopyingOptions opts;
+    opts.docopy = true;
+    opts.source_root = tmp_dir.directory / "src";
+    Copying op(items, tmp_dir.directory / "dst/", host, opts);
+    RunOperationAndCheckSuccess(op);
+    CHECK(std::filesystem::file_size(tmp_dir.directory / "dst/1.txt") == 10);
+    CHECK(std::filesystem::file_size(tmp_dir.directory / "dst/a/2.txt") == 20);
+    CHECK(std::filesystem::file_size(tmp_dir.directory / "dst/a/b/3.txt") == 30);
+    CHECK(!std::filesystem::exists(tmp_dir.directory / "dst/2.txt"));
+    CHECK(!std::filesystem::exists(tmp_dir.directory / "dst/3.txt"));
+
+    opts.source_root = tmp_dir.directory / "src/a";
+    CHECK_THROWS_AS(Copying(items, tmp_dir.directory / "dst/", host, opts), std::invalid_argument);
+}
+
 static std::vector<std::byte> MakeNoise(size_t _size)
 {
     std::vector<std::byte> bytes(_size);
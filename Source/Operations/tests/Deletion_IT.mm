@@ -5,6 +5,7 @@
 #include <VFS/Native.h>
 #include <VFS/NetFTP.h>
 #include "../source/Deletion/Deletion.h"
+#include "../source/Statistics.h"
 #include "Environment.h"
 #include <sys/stat.h>
 #include <iostream>
@@ -233,6 +234,55 @@ TEST_CASE(PREFIX "Nested removal")
     REQUIRE(!host->Exists((d / "top").c_str()));
 }
 
+TEST_CASE(PREFIX "Wide nested removal")
+{
+    const TempTestDir dir;
+    auto &d = dir.directory;
+    const auto host = TestEnv().vfs_native;
+    int items = 1;
+    for( int i = 0; i < 16; ++i ) {
+        const auto sub = d / "top" / std::to_string(i);
+        REQUIRE_NOTHROW(std::filesystem::create_directories(sub / "nested"));
+        items += 2;
+        for( int j = 0; j < 32; ++j ) {
+            REQUIRE(close(creat((sub / std::to_string(j)).c_str(), 0755)) == 0);
+            REQUIRE(close(creat((sub / "nested" / std::to_string(j)).c_str(), 0755)) == 0);
+            items += 2;
+        }
+        REQUIRE_NOTHROW(std::filesystem::create_symlink("/bin/sh", sub / "nested" / "symlink"));
+        ++items;
+    }
+
+    Deletion operation{FetchItems(d.native(), {"top"}, *host), DeletionType::Permanent};
+    operation.Start();
+    operation.Wait();
+
+    REQUIRE(operation.State() == OperationState::Completed);
+    REQUIRE(!host->Exists((d / "top").c_str()));
+    CHECK(operation.Statistics().VolumeProcessed(Statistics::SourceType::Items) == static_cast<uint64_t>(items));
+}
+
+TEST_CASE(PREFIX "Nested removal - unlocking a locked file")
+{
+    const TempTestDir dir;
+    auto &d = dir.directory;
+    const auto host = TestEnv().vfs_native;
+    const auto locked = d / "top/next1/next2/locked";
+    REQUIRE_NOTHROW(std::filesystem::create_directories(d / "top/next1/next2"));
+    REQUIRE(close(creat((d / "top/next1/reg").c_str(), 0755)) == 0);
+    REQUIRE(close(creat(locked.c_str(), 0755)) == 0);
+    REQUIRE(chflags(locked.c_str(), UF_IMMUTABLE) == 0);
+    DeletionOptions options{DeletionType::Permanent};
+    options.locked_items_behaviour = DeletionOptions::LockedItemBehavior::UnlockAll;
+
+    Deletion operation{FetchItems(d.native(), {"top"}, *host), options};
+    operation.Start();
+    operation.Wait();
+
+    REQUIRE(operation.State() == OperationState::Completed);
+    REQUIRE(!host->Exists((d / "top").c_str()));
+}
+
 TEST_CASE(PREFIX "Nested trash")
 {
     const TempTestDir dir;
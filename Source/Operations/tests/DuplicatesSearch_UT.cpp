@@ -0,0 +1,154 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "TestEnv.h"
+#include "../source/DuplicatesSearch/DuplicatesSearch.h"
+#include <VFS/Native.h>
+#include <fstream>
+#include <set>
+
+using namespace nc;
+using namespace nc::ops;
+
+#define PREFIX "nc::ops::DuplicatesSearch "
+
+static void Write(const std::filesystem::path &_path, std::string_view _contents)
+{
+    std::ofstream(_path, std::ios::binary).write(_contents.data(), _contents.size());
+}
+
+static std::vector<VFSListingItem> FetchItems(const std::string &_directory_path,
+                                              const std::vector<std::string> &_filenames)
+{
+    std::vector<VFSListingItem> items;
+    TestEnv().vfs_native->FetchFlexibleListingItems(_directory_path, _filenames, 0, items, nullptr);
+    return items;
+}
+
+static std::vector<std::set<std::string>> Run(const std::vector<VFSListingItem> &_items,
+                                              const DuplicatesSearchOptions &_options = {})
+{
+    DuplicatesSearch operation{_items, _options};
+    operation.Start();
+    operation.Wait();
+    REQUIRE(operation.State() == OperationState::Completed);
+
+    std::vector<std::set<std::string>> groups;
+    for( const auto &group : operation.Groups() ) {
+        auto &paths = groups.emplace_back();
+        for( const auto &item : group )
+            paths.emplace(item.Filename());
+    }
+    return groups;
+}
+
+TEST_CASE(PREFIX "finds the files with the same contents")
+{
+    const TempTestDir dir;
+    const auto &d = dir.directory;
+    std::filesystem::create_directories(d / "a/b");
+    const std::string big(100000, 'x');
+    auto big_head_differs = big;
+    big_head_differs.front() = 'y';
+    auto big_middle_differs = big;
+    big_middle_differs[big.size() / 2] = 'y';
+
+    Write(d / "small1", "hello");
+    Write(d / "a/small2", "hello");
+    Write(d / "a/b/small3", "hello");
+    Write(d / "small_other", "world");
+    Write(d / "big1", big);
+    Write(d / "a/big2", big);
+    Write(d / "a/big_head_differs", big_head_differs);
+    Write(d / "a/b/big_middle_differs", big_middle_differs);
+    Write(d / "unique", "unique contents");
+
+    const auto groups = Run(FetchItems(d, {"small1", "small_other", "big1", "unique", "a"}));
+    // the larger files go first
+    REQUIRE(groups.size() == 2);
+    CHECK(groups[0] == std::set<std::string>{"big1", "big2"});
+    CHECK(groups[1] == std::set<std::string>{"small1", "small2", "small3"});
+}
+
+TEST_CASE(PREFIX "respects the minimal size")
+{
+    const TempTestDir dir;
+    const auto &d = dir.directory;
+    Write(d / "small1", "hello");
+    Write(d / "small2", "hello");
+    Write(d / "empty1", "");
+    Write(d / "empty2", "");
+    Write(d / "large1", "hello, world");
+    Write(d / "large2", "hello, world");
+
+    DuplicatesSearchOptions options;
+    SECTION("Default")
+    {
+        CHECK(Run(FetchItems(d, {"small1", "small2", "empty1", "empty2"}), options).size() == 1);
+    }
+    SECTION("Larger")
+    {
+        options.min_size = 6;
+        const auto groups = Run(FetchItems(d, {"small1", "small2", "large1", "large2"}), options);
+        REQUIRE(groups.size() == 1);
+        CHECK(groups[0] == std::set<std::string>{"large1", "large2"});
+    }
+}
+
+TEST_CASE(PREFIX "doesn't consider hard links as duplicates")
+{
+    const TempTestDir dir;
+    const auto &d = dir.directory;
+    Write(d / "file", "hello");
+    std::filesystem::create_hard_link(d / "file", d / "link");
+    CHECK(Run(FetchItems(d, {"file", "link"})).empty());
+}
+
+TEST_CASE(PREFIX "tells the same inodes on different volumes apart")
+{
+    // pretends that the link resides on another volume
+    struct OtherVolumeHost : vfs::NativeHost {
+        using NativeHost::NativeHost;
+        int Stat(std::string_view _path, VFSStat &_st, unsigned long _flags, const VFSCancelChecker &_cancel) override
+        {
+            const int rc = NativeHost::Stat(_path, _st, _flags, _cancel);
+            if( rc == VFSError::Ok && _path.ends_with("/link") )
+                ++_st.dev;
+            return rc;
+        }
+    };
+    const auto host = std::make_shared<OtherVolumeHost>(*TestEnv().native_fs_man, *TestEnv().fsevents_file_update);
+
+    const TempTestDir dir;
+    const auto &d = dir.directory;
+    Write(d / "file", "hello");
+    std::filesystem::create_hard_link(d / "file", d / "link");
+    std::vector<VFSListingItem> items;
+    host->FetchFlexibleListingItems(d, {"file", "link"}, 0, items, nullptr);
+    CHECK(Run(items) == std::vector<std::set<std::string>>{{"file", "link"}});
+}
+
+TEST_CASE(PREFIX "composes a listing with the groups kept together")
+{
+    const TempTestDir dir;
+    const auto &d = dir.directory;
+    std::filesystem::create_directories(d / "x");
+    Write(d / "a1", "aaaa");
+    Write(d / "x/a2", "aaaa");
+    Write(d / "b1", "bb");
+    Write(d / "x/b2", "bb");
+
+    DuplicatesSearchOptions options;
+    options.io_concurrency = 1;
+    DuplicatesSearch operation{FetchItems(d, {"a1", "b1", "x"}), options};
+    operation.Start();
+    operation.Wait();
+    REQUIRE(operation.State() == OperationState::Completed);
+
+    const auto listing = operation.ComposeListing();
+    REQUIRE(listing);
+    REQUIRE(listing->Count() == 4);
+    std::vector<std::string> filenames;
+    for( unsigned i = 0; i < listing->Count(); ++i )
+        filenames.emplace_back(listing->Filename(i));
+    CHECK(filenames == std::vector<std::string>{"a1", "a2", "b1", "b2"});
+}
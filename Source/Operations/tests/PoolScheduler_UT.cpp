@@ -0,0 +1,105 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "../source/PoolScheduler.h"
+
+using nc::ops::PoolScheduler;
+using nc::ops::SchedulingProfile;
+using Verdict = PoolScheduler::Verdict;
+using Kind = SchedulingProfile::Kind;
+
+#define PREFIX "nc::ops::PoolScheduler "
+
+static SchedulingProfile Profile(std::vector<std::string> _devices, Kind _kind = Kind::Bulk)
+{
+    SchedulingProfile profile;
+    profile.kind = _kind;
+    profile.devices = std::move(_devices);
+    return profile;
+}
+
+static std::vector<std::pair<size_t, Verdict>> Verdicts(const std::vector<PoolScheduler::Decision> &_decisions)
+{
+    std::vector<std::pair<size_t, Verdict>> verdicts;
+    for( const auto &decision : _decisions )
+        verdicts.emplace_back(decision.index, decision.verdict);
+    return verdicts;
+}
+
+TEST_CASE(PREFIX "keeps the order and the global limit for the operations without devices")
+{
+    const PoolScheduler scheduler;
+    const auto p = Profile({});
+    const SchedulingProfile *pending[] = {&p, &p, &p};
+    const auto decisions = scheduler.Schedule({}, pending, 2);
+    CHECK(Verdicts(decisions) == std::vector<std::pair<size_t, Verdict>>{
+                                     {0, Verdict::Start}, {1, Verdict::Start}, {2, Verdict::WaitForSlot}});
+}
+
+TEST_CASE(PREFIX "limits the bulk operations per device")
+{
+    PoolScheduler scheduler;
+    scheduler.SetDeviceConcurrency(1);
+    scheduler.SetDeviceConcurrency("fast", 2);
+    const auto slow = Profile({"slow"});
+    const auto fast = Profile({"fast"});
+    const auto both = Profile({"fast", "slow"});
+    const PoolScheduler::Running running[] = {{&slow, 0.}};
+    const SchedulingProfile *pending[] = {&slow, &both, &fast, &fast, &fast};
+    const auto decisions = scheduler.Schedule(running, pending, 10);
+    CHECK(Verdicts(decisions) == std::vector<std::pair<size_t, Verdict>>{{2, Verdict::Start},
+                                                                         {3, Verdict::Start},
+                                                                         {0, Verdict::WaitForDevice},
+                                                                         {1, Verdict::WaitForDevice},
+                                                                         {4, Verdict::WaitForDevice}});
+    CHECK(decisions[2].device == "slow");
+    CHECK(decisions[3].device == "slow");
+    CHECK(decisions[4].device == "fast");
+}
+
+TEST_CASE(PREFIX "puts the interactive operations first and doesn't limit them per device")
+{
+    PoolScheduler scheduler;
+    scheduler.SetDeviceConcurrency(1);
+    const auto bulk = Profile({"disk"});
+    const auto interactive = Profile({"disk"}, Kind::Interactive);
+    const PoolScheduler::Running running[] = {{&bulk, 0.}};
+    const SchedulingProfile *pending[] = {&bulk, &interactive, &interactive};
+    SECTION("Enough slots")
+    {
+        CHECK(Verdicts(scheduler.Schedule(running, pending, 10)) ==
+              std::vector<std::pair<size_t, Verdict>>{
+                  {1, Verdict::Start}, {2, Verdict::Start}, {0, Verdict::WaitForDevice}});
+    }
+    SECTION("One slot")
+    {
+        CHECK(Verdicts(scheduler.Schedule(running, pending, 1)) ==
+              std::vector<std::pair<size_t, Verdict>>{
+                  {1, Verdict::Start}, {2, Verdict::WaitForSlot}, {0, Verdict::WaitForSlot}});
+    }
+}
+
+TEST_CASE(PREFIX "respects the bandwidth budgets")
+{
+    PoolScheduler scheduler;
+    scheduler.SetDeviceConcurrency(10);
+    scheduler.SetDeviceBandwidth("disk", 100);
+    const auto p = Profile({"disk"});
+    const SchedulingProfile *pending[] = {&p};
+    {
+        const PoolScheduler::Running running[] = {{&p, 60.}};
+        CHECK(Verdicts(scheduler.Schedule(running, pending, 10)) ==
+              std::vector<std::pair<size_t, Verdict>>{{0, Verdict::Start}});
+    }
+    {
+        const PoolScheduler::Running running[] = {{&p, 60.}, {&p, 50.}};
+        const auto decisions = scheduler.Schedule(running, pending, 10);
+        CHECK(Verdicts(decisions) == std::vector<std::pair<size_t, Verdict>>{{0, Verdict::WaitForBandwidth}});
+        CHECK(decisions[0].device == "disk");
+    }
+    scheduler.SetDeviceBandwidth("disk", 0);
+    {
+        const PoolScheduler::Running running[] = {{&p, 60.}, {&p, 50.}};
+        CHECK(Verdicts(scheduler.Schedule(running, pending, 10)) ==
+              std::vector<std::pair<size_t, Verdict>>{{0, Verdict::Start}});
+    }
+}
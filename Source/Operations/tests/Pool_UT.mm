@@ -1,4 +1,4 @@
-// Copyright (C) 2021-2023 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2021-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Tests.h"
 #include "TestEnv.h"
 #include "../source/Pool.h"
@@ -332,3 +332,60 @@ TEST_CASE(PREFIX "Does enqueueing as the callback says")
         CHECK(op2->State() == nc::ops::OperationState::Completed);
     }
 }
+
+TEST_CASE(PREFIX "Limits the operations per device and reports the decisions")
+{
+    using Kind = nc::ops::SchedulingProfile::Kind;
+    auto pool = Pool::Make();
+    struct MyJob : public Job {
+        void Perform() override
+        {
+            while( done == false )
+                std::this_thread::sleep_for(std::chrono::microseconds{100});
+            SetCompleted();
+        }
+        std::atomic_bool done{false};
+    };
+    struct MyOperation : public Operation {
+        MyOperation(std::string _device, Kind _kind = Kind::Bulk)
+        {
+            struct SchedulingProfile profile;
+            profile.kind = _kind;
+            profile.devices = {std::move(_device)};
+            SetSchedulingProfile(std::move(profile));
+        }
+        ~MyOperation() override { Wait(); }
+        Job *GetJob() noexcept override { return &job; }
+        MyJob job;
+    };
+
+    pool->SetConcurrency(5);
+    pool->SetDeviceConcurrency(1);
+    auto op1 = std::make_shared<MyOperation>("disk1");
+    auto op2 = std::make_shared<MyOperation>("disk1");
+    auto op3 = std::make_shared<MyOperation>("disk2");
+    auto op4 = std::make_shared<MyOperation>("disk1", Kind::Interactive);
+    pool->Enqueue(op1);
+    pool->Enqueue(op2);
+    pool->Enqueue(op3);
+    pool->Enqueue(op4);
+    CHECK(op1->State() == nc::ops::OperationState::Running);
+    CHECK(op2->State() == nc::ops::OperationState::Cold);
+    CHECK(op3->State() == nc::ops::OperationState::Running);
+    CHECK(op4->State() == nc::ops::OperationState::Running);
+
+    const auto decisions = pool->SchedulingDecisions();
+    REQUIRE(decisions.size() == 1);
+    CHECK(decisions[0].operation == op2);
+    CHECK(decisions[0].verdict == PoolScheduler::Verdict::WaitForDevice);
+    CHECK(decisions[0].device == "disk1");
+
+    op1->job.done = true;
+    CHECK(check_until_or_die([&] { return op2->State() == nc::ops::OperationState::Running; }, 1s));
+    CHECK(pool->SchedulingDecisions().empty());
+
+    op2->job.done = true;
+    op3->job.done = true;
+    op4->job.done = true;
+    CHECK(check_until_or_die([&] { return pool->Empty(); }, 1s));
+}
@@ -0,0 +1,179 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "TestEnv.h"
+#include "../source/Synchronization/TreeDiff.h"
+#include <fstream>
+#include <map>
+#include <mutex>
+
+using nc::ops::synchronization::DiffEntry;
+using nc::ops::synchronization::TreeDiff;
+using nc::ops::synchronization::TreeDiffOptions;
+
+#define PREFIX "nc::ops::synchronization::TreeDiff "
+
+namespace {
+
+struct Diff {
+    int rc = VFSError::Ok;
+    std::map<std::string, std::pair<DiffEntry::Kind, uint8_t>> entries;
+    std::map<std::string, int> errors;
+};
+
+} // namespace
+
+static void Write(const std::filesystem::path &_path, std::string_view _contents)
+{
+    std::ofstream(_path, std::ios::binary).write(_contents.data(), _contents.size());
+    // the same modification time for all the files, so only the explicit changes are detected
+    std::filesystem::last_write_time(_path, std::filesystem::file_time_type{} + std::chrono::hours(24 * 365 * 40));
+}
+
+static Diff Run(const std::filesystem::path &_source, const std::filesystem::path &_destination, TreeDiffOptions _opts)
+{
+    Diff diff;
+    std::mutex lock;
+    const TreeDiff tree_diff(TestEnv().vfs_native, _source, TestEnv().vfs_native, _destination, _opts);
+    diff.rc = tree_diff.Run(
+        [&](DiffEntry _entry) {
+            const auto guard = std::lock_guard{lock};
+            diff.entries[_entry.path] = {_entry.kind, _entry.reasons};
+        },
+        [&](const std::string &_path, int _vfs_error) {
+            const auto guard = std::lock_guard{lock};
+            diff.errors[_path] = _vfs_error;
+        });
+    return diff;
+}
+
+TEST_CASE(PREFIX "reports new, changed and deleted items")
+{
+    const TempTestDir dir;
+    const auto src = dir.directory / "src";
+    const auto dst = dir.directory / "dst";
+    std::filesystem::create_directories(src / "a/b/c");
+    std::filesystem::create_directories(dst / "a/b");
+    std::filesystem::create_directories(src / "new_dir/sub");
+    std::filesystem::create_directories(dst / "old_dir/sub");
+    Write(src / "same", "abc");
+    Write(dst / "same", "abc");
+    Write(src / "a/b/bigger", "abcd");
+    Write(dst / "a/b/bigger", "abc");
+    Write(src / "a/b/new", "abc");
+    Write(dst / "a/deleted", "abc");
+    Write(src / "a/b/c/file", "abc");
+    Write(src / "new_dir/sub/file", "abc");
+    Write(dst / "old_dir/sub/file", "abc");
+
+    const auto diff = Run(src, dst, {});
+    CHECK(diff.rc == VFSError::Ok);
+    CHECK(diff.errors.empty());
+    CHECK(diff.entries == decltype(diff.entries){
+                             {"a/b/bigger", {DiffEntry::Kind::Changed, DiffEntry::Size}},
+                             {"a/b/c", {DiffEntry::Kind::New, DiffEntry::None}},
+                             {"a/b/new", {DiffEntry::Kind::New, DiffEntry::None}},
+                             {"a/deleted", {DiffEntry::Kind::Deleted, DiffEntry::None}},
+                             {"new_dir", {DiffEntry::Kind::New, DiffEntry::None}},
+                             {"old_dir", {DiffEntry::Kind::Deleted, DiffEntry::None}},
+                         });
+}
+
+TEST_CASE(PREFIX "detects changes of modification time and type")
+{
+    const TempTestDir dir;
+    const auto src = dir.directory / "src";
+    const auto dst = dir.directory / "dst";
+    std::filesystem::create_directories(src / "dir_vs_file");
+    std::filesystem::create_directories(dst);
+    Write(src / "touched", "abc");
+    Write(dst / "touched", "abc");
+    std::filesystem::last_write_time(dst / "touched", std::filesystem::file_time_type{});
+    Write(dst / "dir_vs_file", "abc");
+    Write(src / "link_vs_file", "abc");
+    std::filesystem::create_symlink("somewhere", dst / "link_vs_file");
+    std::filesystem::create_symlink("somewhere", src / "link");
+    std::filesystem::create_symlink("elsewhere", dst / "link");
+
+    SECTION("Comparing modification times")
+    {
+        const auto diff = Run(src, dst, {});
+        CHECK(diff.entries == decltype(diff.entries){
+                                 {"dir_vs_file", {DiffEntry::Kind::Changed, DiffEntry::Type}},
+                                 {"link", {DiffEntry::Kind::Changed, DiffEntry::Contents}},
+                                 {"link_vs_file", {DiffEntry::Kind::Changed, DiffEntry::Type}},
+                                 {"touched", {DiffEntry::Kind::Changed, DiffEntry::ModificationTime}},
+                             });
+    }
+    SECTION("Ignoring modification times")
+    {
+        TreeDiffOptions opts;
+        opts.compare_mtime = false;
+        const auto diff = Run(src, dst, opts);
+        CHECK(diff.entries.contains("touched") == false);
+        CHECK(diff.entries.size() == 3);
+    }
+}
+
+TEST_CASE(PREFIX "compares contents only when asked to")
+{
+    const TempTestDir dir;
+    const auto src = dir.directory / "src";
+    const auto dst = dir.directory / "dst";
+    std::filesystem::create_directories(src);
+    std::filesystem::create_directories(dst);
+    const std::string big(3 * 1024 * 1024 + 17, 'x');
+    Write(src / "big", big);
+    Write(dst / "big", std::string(big).replace(big.size() - 1, 1, "y"));
+    Write(src / "big_same", big);
+    Write(dst / "big_same", big);
+    Write(src / "empty", "");
+    Write(dst / "empty", "");
+
+    SECTION("Metadata only")
+    {
+        CHECK(Run(src, dst, {}).entries.empty());
+    }
+    SECTION("Contents")
+    {
+        TreeDiffOptions opts;
+        opts.compare_contents = true;
+        const auto diff = Run(src, dst, opts);
+        CHECK(diff.entries == decltype(diff.entries){
+                                 {"big", {DiffEntry::Kind::Changed, DiffEntry::Contents}},
+                             });
+    }
+}
+
+TEST_CASE(PREFIX "treats a missing destination as an empty one")
+{
+    const TempTestDir dir;
+    std::filesystem::create_directories(dir.directory / "src/dir");
+    Write(dir.directory / "src/file", "abc");
+    const auto diff = Run(dir.directory / "src", dir.directory / "dst", {});
+    CHECK(diff.rc == VFSError::Ok);
+    CHECK(diff.entries == decltype(diff.entries){
+                             {"dir", {DiffEntry::Kind::New, DiffEntry::None}},
+                             {"file", {DiffEntry::Kind::New, DiffEntry::None}},
+                         });
+}
+
+TEST_CASE(PREFIX "fails when the source can't be listed")
+{
+    const TempTestDir dir;
+    const auto diff = Run(dir.directory / "src", dir.directory, {});
+    CHECK(diff.rc != VFSError::Ok);
+    CHECK(diff.entries.empty());
+}
+
+TEST_CASE(PREFIX "can be cancelled")
+{
+    const TempTestDir dir;
+    for( int i = 0; i < 10; ++i ) {
+        std::filesystem::create_directories(dir.directory / "src" / std::to_string(i) / "sub");
+        std::filesystem::create_directories(dir.directory / "dst" / std::to_string(i) / "sub");
+    }
+    const TreeDiff tree_diff(
+        TestEnv().vfs_native, dir.directory / "src", TestEnv().vfs_native, dir.directory / "dst");
+    const int rc = tree_diff.Run([](DiffEntry) {}, {}, [] { return true; });
+    CHECK(rc == VFSError::Cancelled);
+}
@@ -0,0 +1,105 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "../source/Throttle.h"
+#include <atomic>
+#include <thread>
+
+using nc::ops::Throttle;
+using namespace std::chrono_literals;
+
+#define PREFIX "nc::ops::Throttle "
+
+static std::chrono::duration<double> Measure(const std::function<void()> &_f)
+{
+    const auto start = Throttle::Clock::now();
+    _f();
+    return Throttle::Clock::now() - start;
+}
+
+TEST_CASE(PREFIX "doesn't block without a limit")
+{
+    Throttle throttle;
+    const auto elapsed = Measure([&] {
+        for( int i = 0; i < 1000; ++i )
+            CHECK(throttle.Consume(1024 * 1024));
+    });
+    CHECK(elapsed < 100ms);
+}
+
+TEST_CASE(PREFIX "keeps the rate")
+{
+    // 2MB at 4MB/s must take 0.5s, the idle bucket being empty at first
+    const uint64_t rate = 4 * 1024 * 1024;
+    const size_t total = 2 * 1024 * 1024;
+    SECTION("Small chunks")
+    {
+        Throttle throttle{rate};
+        const auto elapsed = Measure([&] {
+            for( size_t done = 0; done < total; done += 64 * 1024 )
+                throttle.Consume(64 * 1024);
+        });
+        CHECK(elapsed > 450ms);
+        CHECK(elapsed < 650ms);
+    }
+    SECTION("Chunks larger than the burst")
+    {
+        Throttle throttle{rate};
+        const auto elapsed = Measure([&] {
+            for( size_t done = 0; done < total; done += 1024 * 1024 )
+                throttle.Consume(1024 * 1024);
+        });
+        // the debt of the last chunk is paid off as well
+        CHECK(elapsed > 450ms);
+        CHECK(elapsed < 650ms);
+    }
+    SECTION("Concurrent consumers share the rate")
+    {
+        Throttle throttle{rate};
+        const auto elapsed = Measure([&] {
+            std::vector<std::thread> threads;
+            for( int t = 0; t < 4; ++t )
+                threads.emplace_back([&] {
+                    for( size_t done = 0; done < total / 4; done += 32 * 1024 )
+                        throttle.Consume(32 * 1024);
+                });
+            for( auto &thread : threads )
+                thread.join();
+        });
+        CHECK(elapsed > 450ms);
+        CHECK(elapsed < 650ms);
+    }
+}
+
+TEST_CASE(PREFIX "applies a new rate to the waiting consumers")
+{
+    Throttle throttle{1024};
+    std::atomic_bool done{false};
+    std::thread consumer([&] {
+        throttle.Consume(1024 * 1024); // ~17 minutes at the initial rate
+        done = true;
+    });
+    std::this_thread::sleep_for(50ms);
+    CHECK(done == false);
+    const auto elapsed = Measure([&] {
+        throttle.SetRate(0);
+        consumer.join();
+    });
+    CHECK(done == true);
+    CHECK(elapsed < 100ms);
+    CHECK(throttle.Rate() == 0);
+}
+
+TEST_CASE(PREFIX "stops waiting when cancelled")
+{
+    Throttle throttle{1024};
+    std::atomic_bool cancelled{false};
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(50ms);
+        cancelled = true;
+    });
+    bool consumed = true;
+    const auto elapsed = Measure([&] { consumed = throttle.Consume(1024 * 1024, [&] { return cancelled.load(); }); });
+    canceller.join();
+    CHECK(consumed == false);
+    CHECK(elapsed < 300ms);
+}
@@ -0,0 +1,187 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "../source/Compression/ZipStreamWriter.h"
+#include <libarchive/archive.h>
+#include <libarchive/archive_entry.h>
+#include <zlib.h>
+#include <sys/stat.h>
+#include <cstring>
+
+using namespace nc::ops;
+
+#define PREFIX "Operations::ZipStreamWriter "
+
+namespace {
+
+struct ReadEntry {
+    std::string path;
+    mode_t mode = 0;
+    std::string data;
+};
+
+struct Output {
+    std::vector<std::byte> bytes;
+    ZipStreamWriter::Sink Sink()
+    {
+        return [this](const void *_buffer, size_t _size) {
+            const auto p = static_cast<const std::byte *>(_buffer);
+            bytes.insert(bytes.end(), p, p + _size);
+            return true;
+        };
+    }
+};
+
+} // namespace
+
+static std::vector<ReadEntry> ReadBack(const std::vector<std::byte> &_zip);
+static std::vector<std::byte> Deflate(std::string_view _data);
+static uint32_t CRC32(std::string_view _data);
+static ZipStreamWriter::EntryInfo Info(std::string _path, uint16_t _mode);
+
+TEST_CASE(PREFIX "An empty archive consists of the end of central directory only")
+{
+    Output out;
+    ZipStreamWriter writer(out.Sink());
+    REQUIRE(writer.Finish());
+    CHECK(out.bytes.size() == 22);
+    CHECK(writer.BytesWritten() == 22);
+}
+
+TEST_CASE(PREFIX "Directories, symlinks and stored files")
+{
+    Output out;
+    ZipStreamWriter writer(out.Sink());
+    const std::string contents = "Hello, world!";
+    REQUIRE(writer.AddDirectory(Info("dir/", S_IFDIR | 0755)));
+    REQUIRE(writer.AddFile(Info("dir/file.txt", S_IFREG | 0644), std::as_bytes(std::span{contents})));
+    REQUIRE(writer.AddSymlink(Info("dir/link", S_IFLNK | 0755), "file.txt"));
+    REQUIRE(writer.Finish());
+    CHECK(writer.BytesWritten() == out.bytes.size());
+
+    const auto entries = ReadBack(out.bytes);
+    REQUIRE(entries.size() == 3);
+    CHECK(entries[0].path == "dir/");
+    CHECK(S_ISDIR(entries[0].mode));
+    CHECK(entries[1].path == "dir/file.txt");
+    CHECK(S_ISREG(entries[1].mode));
+    CHECK(entries[1].data == contents);
+    CHECK(entries[2].path == "dir/link");
+    CHECK(S_ISLNK(entries[2].mode));
+    CHECK(entries[2].data == "file.txt");
+}
+
+TEST_CASE(PREFIX "Deflated data fed in pieces")
+{
+    std::string contents;
+    for( int i = 0; i < 100000; ++i )
+        contents += std::to_string(i);
+    const auto deflated = Deflate(contents);
+    REQUIRE(deflated.size() < contents.size());
+
+    Output out;
+    ZipStreamWriter writer(out.Sink());
+    REQUIRE(writer.BeginFile(Info("numbers.txt", S_IFREG | 0644), ZipStreamWriter::Method::Deflate, contents.size()));
+    const auto half = deflated.size() / 2;
+    REQUIRE(writer.WriteFileData(std::span{deflated}.first(half)));
+    REQUIRE(writer.WriteFileData(std::span{deflated}.subspan(half)));
+    REQUIRE(writer.EndFile(CRC32(contents), contents.size()));
+    REQUIRE(writer.Finish());
+
+    const auto entries = ReadBack(out.bytes);
+    REQUIRE(entries.size() == 1);
+    CHECK(entries[0].path == "numbers.txt");
+    CHECK(entries[0].data == contents);
+}
+
+TEST_CASE(PREFIX "Misuse is reported")
+{
+    Output out;
+    ZipStreamWriter writer(out.Sink());
+    CHECK(writer.EndFile(0, 0) == false);
+    CHECK(writer.WriteFileData({}) == false);
+    REQUIRE(writer.BeginFile(Info("a", S_IFREG | 0644), ZipStreamWriter::Method::Store, 0));
+    CHECK(writer.BeginFile(Info("b", S_IFREG | 0644), ZipStreamWriter::Method::Store, 0) == false);
+    CHECK(writer.Finish() == false);
+}
+
+TEST_CASE(PREFIX "Sink failures are propagated")
+{
+    ZipStreamWriter writer([](const void *, size_t) { return false; });
+    const std::string contents(4 * 1024 * 1024, 'x');
+    CHECK(writer.AddFile(Info("big", S_IFREG | 0644), std::as_bytes(std::span{contents})) == false);
+    CHECK(writer.Finish() == false);
+}
+
+TEST_CASE(PREFIX "More than 65535 entries switch to ZIP64 end of central directory")
+{
+    Output out;
+    ZipStreamWriter writer(out.Sink());
+    const int amount = 70000;
+    for( int i = 0; i < amount; ++i )
+        REQUIRE(writer.AddFile(Info(std::to_string(i), S_IFREG | 0644), {}));
+    REQUIRE(writer.Finish());
+
+    const auto entries = ReadBack(out.bytes);
+    REQUIRE(entries.size() == amount);
+    CHECK(entries.front().path == "0");
+    CHECK(entries.back().path == std::to_string(amount - 1));
+}
+
+static std::vector<ReadEntry> ReadBack(const std::vector<std::byte> &_zip)
+{
+    std::vector<ReadEntry> entries;
+    struct archive *a = archive_read_new();
+    archive_read_support_format_zip_seekable(a);
+    if( archive_read_open_memory(a, _zip.data(), _zip.size()) == ARCHIVE_OK ) {
+        struct archive_entry *e = nullptr;
+        while( archive_read_next_header(a, &e) == ARCHIVE_OK ) {
+            ReadEntry entry;
+            entry.path = archive_entry_pathname(e);
+            entry.mode = archive_entry_mode(e);
+            if( S_ISLNK(entry.mode) ) {
+                entry.data = archive_entry_symlink(e);
+            }
+            else {
+                char buf[65536];
+                la_ssize_t rc = 0;
+                while( (rc = archive_read_data(a, buf, sizeof(buf))) > 0 )
+                    entry.data.append(buf, rc);
+            }
+            entries.emplace_back(std::move(entry));
+        }
+    }
+    archive_read_free(a);
+    return entries;
+}
+
+static std::vector<std::byte> Deflate(std::string_view _data)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::vector<std::byte> out(deflateBound(&stream, static_cast<uLong>(_data.size())));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(_data.data()));
+    stream.avail_in = static_cast<uInt>(_data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+static uint32_t CRC32(std::string_view _data)
+{
+    return static_cast<uint32_t>(
+        crc32(crc32(0, nullptr, 0), reinterpret_cast<const Bytef *>(_data.data()), static_cast<uInt>(_data.size())));
+}
+
+static ZipStreamWriter::EntryInfo Info(std::string _path, uint16_t _mode)
+{
+    ZipStreamWriter::EntryInfo info;
+    info.path = std::move(_path);
+    info.mode = _mode;
+    info.mtime = 1700000000;
+    info.atime = 1700000000;
+    return info;
+}
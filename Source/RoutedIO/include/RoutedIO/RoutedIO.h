@@ -1,13 +1,43 @@
-// Copyright (C) 2014-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include <xpc/xpc.h>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <atomic>
+#include <optional>
+#include <span>
+#include <utility>
 
 namespace nc::routedio {
 
+/**
+ * A set of attribute changes of a single filesystem item, processed by PosixIOInterface::chattrs().
+ * The changes are applied in the order of declaration, symlinks are followed.
+ */
+struct AttrsChange {
+    const char *path = nullptr;
+    std::optional<mode_t> mode;
+    std::optional<std::pair<uid_t, gid_t>> owner;
+    std::optional<u_int> flags;
+    std::optional<time_t> btime;
+    std::optional<time_t> mtime;
+    std::optional<time_t> ctime;
+    std::optional<time_t> atime;
+};
+
+struct AttrsChangeResult {
+    enum class Step : unsigned char {
+        None = 0,
+        Mode = 1,
+        Owner = 2,
+        Flags = 3,
+        Times = 4
+    };
+    Step failed = Step::None; // the first step which failed, the rest of the item was not processed
+    int error = 0;            // errno of the failure
+};
+
 /**
  * NB!
  * readdir call uses _readdir_unlocked (without mutex guarding) and requires that call should be
@@ -40,6 +70,8 @@ public:
     virtual int chctime(const char *_path, time_t _time) noexcept = 0;
     virtual int chbtime(const char *_path, time_t _time) noexcept = 0;
     virtual int chatime(const char *_path, time_t _time) noexcept = 0;
+    // _results must have the same size as _changes, a single routed call is made for the whole batch
+    virtual void chattrs(std::span<const AttrsChange> _changes, std::span<AttrsChangeResult> _results) noexcept = 0;
     virtual ssize_t readlink(const char *_path, char *_symlink, size_t _buf_sz) noexcept = 0;
     virtual int symlink(const char *_value, const char *_symlink_path) noexcept = 0;
     virtual int link(const char *_path_exist, const char *_path_newnode) noexcept = 0;
@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "AttrsChange.h"
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <string_view>
+#include <sys/attr.h>
+#include <unistd.h>
+
+namespace nc::routedio {
+
+static AttrsChangeResult ApplyAttrsChange(int _dir_fd, const char *_name, const AttrsChange &_change) noexcept
+{
+    using Step = AttrsChangeResult::Step;
+
+    if( _change.mode && fchmodat(_dir_fd, _name, *_change.mode, 0) != 0 )
+        return {Step::Mode, errno};
+
+    if( _change.owner && fchownat(_dir_fd, _name, _change.owner->first, _change.owner->second, 0) != 0 )
+        return {Step::Owner, errno};
+
+    if( _change.flags ) {
+        struct attrlist attrs;
+        memset(&attrs, 0, sizeof(attrs));
+        attrs.bitmapcount = ATTR_BIT_MAP_COUNT;
+        attrs.commonattr = ATTR_CMN_FLAGS;
+        uint32_t flags = *_change.flags;
+        if( setattrlistat(_dir_fd, _name, &attrs, &flags, sizeof(flags), 0) != 0 )
+            return {Step::Flags, errno};
+    }
+
+    // the attribute buffer must follow the order of the bits in the attributes mask
+    struct attrlist attrs;
+    memset(&attrs, 0, sizeof(attrs));
+    attrs.bitmapcount = ATTR_BIT_MAP_COUNT;
+    timespec times[4];
+    size_t times_num = 0;
+    const auto add = [&](const std::optional<time_t> &_time, attrgroup_t _attr) {
+        if( _time ) {
+            attrs.commonattr |= _attr;
+            times[times_num++] = {.tv_sec = *_time, .tv_nsec = 0};
+        }
+    };
+    add(_change.btime, ATTR_CMN_CRTIME);
+    add(_change.mtime, ATTR_CMN_MODTIME);
+    add(_change.ctime, ATTR_CMN_CHGTIME);
+    add(_change.atime, ATTR_CMN_ACCTIME);
+    if( times_num != 0 && setattrlistat(_dir_fd, _name, &attrs, times, times_num * sizeof(timespec), 0) != 0 )
+        return {Step::Times, errno};
+
+    return {};
+}
+
+void ApplyAttrsChanges(std::span<const AttrsChange> _changes, std::span<AttrsChangeResult> _results) noexcept
+{
+    assert(_changes.size() == _results.size());
+
+    int dir_fd = -1;
+    std::string_view dir_path;
+    for( size_t i = 0; i != _changes.size(); ++i ) {
+        const AttrsChange &change = _changes[i];
+        const std::string_view path = change.path;
+        const auto slash = path.rfind('/');
+        if( slash == std::string_view::npos || slash + 1 == path.size() ) {
+            // relative paths and paths with a trailing slash are used as-is
+            _results[i] = ApplyAttrsChange(AT_FDCWD, change.path, change);
+            continue;
+        }
+
+        const std::string_view parent = slash == 0 ? path.substr(0, 1) : path.substr(0, slash);
+        if( parent != dir_path ) {
+            if( dir_fd >= 0 )
+                close(dir_fd);
+            const std::string parent_path(parent);
+            dir_fd = open(parent_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            dir_path = dir_fd >= 0 ? parent : std::string_view{};
+        }
+
+        if( dir_fd >= 0 )
+            _results[i] = ApplyAttrsChange(dir_fd, change.path + slash + 1, change);
+        else
+            _results[i] = ApplyAttrsChange(AT_FDCWD, change.path, change);
+    }
+
+    if( dir_fd >= 0 )
+        close(dir_fd);
+}
+
+} // namespace nc::routedio
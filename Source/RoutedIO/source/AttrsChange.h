@@ -0,0 +1,13 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+
+#pragma once
+
+#include "../include/RoutedIO/RoutedIO.h"
+
+namespace nc::routedio {
+
+// Applies the changes in the current process. Items sharing a parent directory are addressed relative to a single
+// descriptor of that directory, so the path lookup is done once per directory instead of once per call.
+void ApplyAttrsChanges(std::span<const AttrsChange> _changes, std::span<AttrsChangeResult> _results) noexcept;
+
+} // namespace nc::routedio
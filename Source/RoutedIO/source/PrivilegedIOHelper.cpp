@@ -1,5 +1,6 @@
-// Copyright (C) 2014-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "Trash.h"
+#include "AttrsChange.h"
 #include <Security/Security.h>
 #include <cerrno>
 #include <cstdio>
@@ -7,8 +8,10 @@
 #include <frozen/unordered_map.h>
 #include <libproc.h>
 #include <mach-o/dyld.h>
+#include <optional>
 #include <sys/stat.h>
 #include <syslog.h>
+#include <vector>
 #include <xpc/xpc.h>
 #include <Base/CFPtr.h>
 
@@ -473,7 +476,69 @@ static bool HandleTrash(xpc_object_t _event) noexcept
     return true;
 }
 
-static constexpr frozen::unordered_map<frozen::string, bool (*)(xpc_object_t), 23> g_Handlers{
+static std::optional<int64_t> get_optional_int64(xpc_object_t _dict, const char *_key) noexcept
+{
+    xpc_object_t value = xpc_dictionary_get_value(_dict, _key);
+    if( value == nullptr || xpc_get_type(value) != XPC_TYPE_INT64 )
+        return std::nullopt;
+    return xpc_int64_get_value(value);
+}
+
+static bool HandleChAttrs(xpc_object_t _event) noexcept
+{
+    xpc_object_t xpc_items = xpc_dictionary_get_value(_event, "items");
+    if( xpc_items == nullptr || xpc_get_type(xpc_items) != XPC_TYPE_ARRAY )
+        return false;
+
+    // the paths point into the event, which outlives the changes
+    const size_t count = xpc_array_get_count(xpc_items);
+    std::vector<nc::routedio::AttrsChange> changes(count);
+    for( size_t i = 0; i != count; ++i ) {
+        xpc_object_t item = xpc_array_get_value(xpc_items, i);
+        if( xpc_get_type(item) != XPC_TYPE_DICTIONARY )
+            return false;
+        const char *path = xpc_dictionary_get_string(item, "path");
+        if( path == nullptr )
+            return false;
+
+        auto &change = changes[i];
+        change.path = path;
+        if( auto mode = get_optional_int64(item, "mode") )
+            change.mode = static_cast<mode_t>(*mode);
+        const auto uid = get_optional_int64(item, "uid");
+        const auto gid = get_optional_int64(item, "gid");
+        if( uid && gid )
+            change.owner = std::make_pair(static_cast<uid_t>(*uid), static_cast<gid_t>(*gid));
+        if( auto flags = get_optional_int64(item, "flags") )
+            change.flags = static_cast<u_int>(*flags);
+        change.btime = get_optional_int64(item, "btime");
+        change.mtime = get_optional_int64(item, "mtime");
+        change.ctime = get_optional_int64(item, "ctime");
+        change.atime = get_optional_int64(item, "atime");
+    }
+
+    std::vector<nc::routedio::AttrsChangeResult> results(count);
+    nc::routedio::ApplyAttrsChanges(changes, results);
+
+    xpc_object_t xpc_results = xpc_array_create(nullptr, 0);
+    for( const auto &result : results ) {
+        xpc_object_t xpc_result = xpc_dictionary_create(nullptr, nullptr, 0);
+        xpc_dictionary_set_int64(xpc_result, "step", static_cast<int64_t>(result.failed));
+        xpc_dictionary_set_int64(xpc_result, "error", result.error);
+        xpc_array_append_value(xpc_results, xpc_result);
+        xpc_release(xpc_result);
+    }
+
+    xpc_connection_t remote = xpc_dictionary_get_remote_connection(_event);
+    xpc_object_t reply = xpc_dictionary_create_reply(_event);
+    xpc_dictionary_set_value(reply, "results", xpc_results);
+    xpc_release(xpc_results);
+    xpc_connection_send_message(remote, reply);
+    xpc_release(reply);
+    return true;
+}
+
+static constexpr frozen::unordered_map<frozen::string, bool (*)(xpc_object_t), 24> g_Handlers{
     {"heartbeat", HandleHeartbeat}, //
     {"uninstall", HandleUninstall}, //
     {"exit", HandleExit},           //
@@ -489,6 +554,7 @@ static constexpr frozen::unordered_map<frozen::string, bool (*)(xpc_object_t), 2
     {"chctime", HandleChTime},      //
     {"chbtime", HandleChTime},      //
     {"chatime", HandleChTime},      //
+    {"chattrs", HandleChAttrs},     //
     {"rmdir", HandleRmDir},         //
     {"unlink", HandleUnlink},       //
     {"rename", HandleRename},       //
@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include <Base/CFPtr.h>
 #include <cassert>
 #include <cerrno>
@@ -15,6 +15,7 @@
 #include <unistd.h>
 
 #include "RoutedIOInterfaces.h"
+#include "AttrsChange.h"
 #include "Trash.h"
 
 // hack to access function from libc implementation directly.
@@ -156,6 +157,12 @@ int PosixIOInterfaceNative::chbtime(const char *_path, time_t _time) noexcept
     return ApplyTimeChange(_path, _time, ATTR_CMN_CRTIME);
 }
 
+void PosixIOInterfaceNative::chattrs(std::span<const AttrsChange> _changes,
+                                     std::span<AttrsChangeResult> _results) noexcept
+{
+    ApplyAttrsChanges(_changes, _results);
+}
+
 int PosixIOInterfaceNative::killpg(int _pid, int _signal) noexcept
 {
     return ::killpg(_pid, _signal);
@@ -878,6 +885,96 @@ int PosixIOInterfaceRouted::chctime(const char *_path, time_t _time) noexcept
     return 0;
 }
 
+static AttrsChangeResult::Step FirstStepOf(const AttrsChange &_change) noexcept
+{
+    if( _change.mode )
+        return AttrsChangeResult::Step::Mode;
+    if( _change.owner )
+        return AttrsChangeResult::Step::Owner;
+    if( _change.flags )
+        return AttrsChangeResult::Step::Flags;
+    return AttrsChangeResult::Step::Times;
+}
+
+static xpc_object_t MakeXPCAttrsChange(const AttrsChange &_change) noexcept
+{
+    xpc_object_t item = xpc_dictionary_create(nullptr, nullptr, 0);
+    xpc_dictionary_set_string(item, "path", _change.path);
+    if( _change.mode )
+        xpc_dictionary_set_int64(item, "mode", *_change.mode);
+    if( _change.owner ) {
+        xpc_dictionary_set_int64(item, "uid", _change.owner->first);
+        xpc_dictionary_set_int64(item, "gid", _change.owner->second);
+    }
+    if( _change.flags )
+        xpc_dictionary_set_int64(item, "flags", *_change.flags);
+    if( _change.btime )
+        xpc_dictionary_set_int64(item, "btime", *_change.btime);
+    if( _change.mtime )
+        xpc_dictionary_set_int64(item, "mtime", *_change.mtime);
+    if( _change.ctime )
+        xpc_dictionary_set_int64(item, "ctime", *_change.ctime);
+    if( _change.atime )
+        xpc_dictionary_set_int64(item, "atime", *_change.atime);
+    return item;
+}
+
+void PosixIOInterfaceRouted::chattrs(std::span<const AttrsChange> _changes,
+                                     std::span<AttrsChangeResult> _results) noexcept
+{
+    xpc_connection_t conn = Connection();
+    if( !conn ) // fallback to native on disabled routing or on helper connectity problems
+        return super::chattrs(_changes, _results);
+
+    xpc_object_t items = xpc_array_create(nullptr, 0);
+    for( const AttrsChange &change : _changes ) {
+        xpc_object_t item = MakeXPCAttrsChange(change);
+        xpc_array_append_value(items, item);
+        xpc_release(item);
+    }
+
+    xpc_object_t message = xpc_dictionary_create(nullptr, nullptr, 0);
+    xpc_dictionary_set_string(message, "operation", "chattrs");
+    xpc_dictionary_set_value(message, "items", items);
+    xpc_release(items);
+
+    xpc_object_t reply = xpc_connection_send_message_with_reply_sync(conn, message);
+    xpc_release(message);
+
+    if( xpc_get_type(reply) == XPC_TYPE_ERROR ) {
+        xpc_release(reply); // connection broken, faling back to native
+        return super::chattrs(_changes, _results);
+    }
+
+    const auto fail_all = [&](int _error) {
+        for( size_t i = 0; i != _changes.size(); ++i )
+            _results[i] = {FirstStepOf(_changes[i]), _error};
+    };
+
+    if( auto err = xpc_dictionary_get_int64(reply, "error") ) {
+        // got a graceful error, propaganate it
+        xpc_release(reply);
+        fail_all(static_cast<int>(err));
+        return;
+    }
+
+    xpc_object_t results = xpc_dictionary_get_value(reply, "results");
+    if( results == nullptr || xpc_get_type(results) != XPC_TYPE_ARRAY ||
+        xpc_array_get_count(results) != _changes.size() ) {
+        xpc_release(reply);
+        fail_all(EIO);
+        return;
+    }
+
+    for( size_t i = 0; i != _changes.size(); ++i ) {
+        xpc_object_t result = xpc_array_get_value(results, i);
+        _results[i].failed = static_cast<AttrsChangeResult::Step>(xpc_dictionary_get_int64(result, "step"));
+        _results[i].error = static_cast<int>(xpc_dictionary_get_int64(result, "error"));
+    }
+
+    xpc_release(reply);
+}
+
 int PosixIOInterfaceRouted::killpg(int _pid, int _signal) noexcept
 {
 
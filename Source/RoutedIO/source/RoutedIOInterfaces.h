@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2014-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "../include/RoutedIO/RoutedIO.h"
@@ -34,6 +34,7 @@ public:
     int chctime(const char *_path, time_t _time) noexcept override;
     int chbtime(const char *_path, time_t _time) noexcept override;
     int chatime(const char *_path, time_t _time) noexcept override;
+    void chattrs(std::span<const AttrsChange> _changes, std::span<AttrsChangeResult> _results) noexcept override;
     int killpg(int _pid, int _signal) noexcept override;
     int trash(const char *_path) noexcept override;
 
@@ -66,6 +67,7 @@ public:
     int chctime(const char *_path, time_t _time) noexcept override;
     int chbtime(const char *_path, time_t _time) noexcept override;
     int chatime(const char *_path, time_t _time) noexcept override;
+    void chattrs(std::span<const AttrsChange> _changes, std::span<AttrsChangeResult> _results) noexcept override;
     int killpg(int _pid, int _signal) noexcept override;
     int trash(const char *_path) noexcept override;
 
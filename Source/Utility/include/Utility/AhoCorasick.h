@@ -0,0 +1,76 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace nc::utility {
+
+/**
+ * AhoCorasick finds all occurrences of a set of strings in a text in a single pass.
+ * Works with UTF-16 code units and can be fed with the text piece by piece, carrying the state between the pieces.
+ * Case-insensitive matching folds the code units of the Basic Multilingual Plane into lowercase.
+ * The automaton is immutable once built and can be used from several threads at once.
+ */
+class AhoCorasick
+{
+public:
+    using State = uint32_t;
+    static constexpr State Root = 0;
+
+    // Empty strings are accepted but are never reported as found.
+    AhoCorasick(std::span<const std::u16string> _strings, bool _case_sensitive);
+
+    size_t StringsCount() const noexcept;
+
+    // Length of the string in code units.
+    size_t StringLength(size_t _string) const noexcept;
+
+    size_t MaximumStringLength() const noexcept;
+
+    // Feeds _text into the automaton, which is in _state, and returns the state it ends up with.
+    // _on_found(size_t _string, size_t _end) is called for every occurrence, _end being the index in _text which
+    // follows the last code unit of the occurrence. The occurrence can start in a previously fed piece of the text.
+    // Once _on_found returns false the feeding stops and the state reached so far is returned.
+    template <class OnFound>
+    State Feed(State _state, std::span<const char16_t> _text, OnFound &&_on_found) const;
+
+private:
+    void Build(std::span<const std::u16string> _strings, bool _case_sensitive);
+
+    // code units are mapped to the classes of equivalence, class #0 are all units absent in the strings
+    std::vector<uint16_t> m_Classes;
+    size_t m_ClassesCount = 1;
+
+    // transitions, indexed by [state * m_ClassesCount + class]
+    std::vector<State> m_Transitions;
+
+    // strings which end at each state, indexed by [m_Found[state], m_Found[state + 1])
+    std::vector<uint32_t> m_Found;
+    std::vector<uint32_t> m_FoundStrings;
+
+    std::vector<size_t> m_Lengths;
+};
+
+template <class OnFound>
+AhoCorasick::State AhoCorasick::Feed(State _state, std::span<const char16_t> _text, OnFound &&_on_found) const
+{
+    const State *const transitions = m_Transitions.data();
+    const uint16_t *const classes = m_Classes.data();
+    const uint32_t *const found = m_Found.data();
+    const size_t classes_count = m_ClassesCount;
+    const size_t size = _text.size();
+    for( size_t i = 0; i < size; ++i ) {
+        _state = transitions[_state * classes_count + classes[_text[i]]];
+        if( found[_state] != found[_state + 1] )
+            for( uint32_t f = found[_state]; f != found[_state + 1]; ++f )
+                if( !_on_found(static_cast<size_t>(m_FoundStrings[f]), i + 1) )
+                    return _state;
+    }
+    return _state;
+}
+
+} // namespace nc::utility
@@ -0,0 +1,61 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "Encodings.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace nc::utility {
+
+/**
+ * EncodingDetector guesses whether data is binary or text and in which encoding the text is by accumulating
+ * statistics over one or several samples of it, e.g. over a few regions of a large file.
+ * Samples don't have to start or end at character boundaries.
+ * The byte histograms of the samples are matched against letter frequency models to rank the single-byte codepages.
+ */
+class EncodingDetector
+{
+public:
+    struct Candidate {
+        Encoding encoding = Encoding::ENCODING_INVALID;
+        double confidence = 0.; // [0, 1]
+    };
+
+    struct Verdict {
+        bool is_binary = false;
+        // Sorted by confidence in descending order, never empty.
+        std::vector<Candidate> candidates;
+    };
+
+    // _offset is the position of the sample within the whole data, it's used to find the byte order marks and to
+    // align the code units of UTF-16.
+    void Feed(uint64_t _offset, std::span<const std::byte> _sample) noexcept;
+
+    // Amount of bytes fed so far.
+    uint64_t Fed() const noexcept;
+
+    Verdict Conclude() const;
+
+private:
+    void FeedUTF8(const unsigned char *_bytes, size_t _size) noexcept;
+    void FeedUTF16(const unsigned char *_bytes, size_t _size) noexcept;
+    double UTF8Confidence() const noexcept;
+    double UTF16Confidence(bool _le) const noexcept;
+    double ZerosPenalty() const noexcept;
+
+    // distributions of bytes at even and odd offsets, required to tell UTF-16LE from UTF-16BE
+    std::array<uint64_t, 256> m_Even{};
+    std::array<uint64_t, 256> m_Odd{};
+    uint64_t m_Fed = 0;
+    uint64_t m_UTF8Errors = 0;
+    uint64_t m_UTF16LEErrors = 0;
+    uint64_t m_UTF16BEErrors = 0;
+    std::optional<Encoding> m_BOM;
+};
+
+} // namespace nc::utility
@@ -106,6 +106,13 @@ void InterpretSingleByteBufferAsUniCharPreservingBufferSize(
     Encoding _codepage);
 // not setting a null-terminator!
 
+// Converts UTF-16 code units into a single-byte codepage, i.e. produces exactly _input_size bytes.
+// Returns false if any of the characters can't be represented in the codepage or maps onto several bytes at once.
+bool InterpretUnicharsAsSingleByte(const uint16_t *_input,
+                                   size_t _input_size,
+                                   unsigned char *_output, // should be at least _input_size bytes long
+                                   Encoding _codepage) noexcept;
+
 void InterpretUTF8BufferAsUniCharPreservingBufferSize(
     const unsigned char *_input,
     size_t _input_size,
@@ -0,0 +1,110 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "AhoCorasick.h"
+#include <Base/ToLower.h>
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <queue>
+
+namespace nc::utility {
+
+static constexpr AhoCorasick::State g_NoState = std::numeric_limits<AhoCorasick::State>::max();
+
+AhoCorasick::AhoCorasick(std::span<const std::u16string> _strings, bool _case_sensitive)
+{
+    Build(_strings, _case_sensitive);
+}
+
+void AhoCorasick::Build(std::span<const std::u16string> _strings, bool _case_sensitive)
+{
+    const auto fold = [_case_sensitive](char16_t _c) -> char16_t {
+        return _case_sensitive ? _c : static_cast<char16_t>(base::g_ToLower[_c]);
+    };
+
+    // enumerate the distinct code units of the strings
+    m_Classes.assign(65536, 0);
+    m_ClassesCount = 1;
+    for( const auto &string : _strings )
+        for( const char16_t c : string )
+            if( m_Classes[fold(c)] == 0 )
+                m_Classes[fold(c)] = static_cast<uint16_t>(m_ClassesCount++);
+    if( !_case_sensitive )
+        for( size_t c = 0; c < m_Classes.size(); ++c )
+            m_Classes[c] = m_Classes[fold(static_cast<char16_t>(c))];
+
+    // build a trie of the strings
+    std::vector<std::vector<uint32_t>> found(1);
+    m_Transitions.assign(m_ClassesCount, g_NoState);
+    m_Lengths.clear();
+    for( size_t index = 0; index < _strings.size(); ++index ) {
+        const auto &string = _strings[index];
+        m_Lengths.push_back(string.size());
+        if( string.empty() )
+            continue;
+        State state = Root;
+        for( const char16_t c : string ) {
+            State &next = m_Transitions[(state * m_ClassesCount) + m_Classes[c]];
+            if( next == g_NoState ) {
+                next = static_cast<State>(found.size());
+                found.emplace_back();
+                m_Transitions.resize(m_Transitions.size() + m_ClassesCount, g_NoState);
+            }
+            state = m_Transitions[(state * m_ClassesCount) + m_Classes[c]];
+        }
+        found[state].push_back(static_cast<uint32_t>(index));
+    }
+
+    // turn the trie into a complete automaton by following the failure links in breadth-first order
+    const size_t states_count = found.size();
+    std::vector<State> failure(states_count, Root);
+    std::queue<State> queue;
+    for( size_t c = 0; c < m_ClassesCount; ++c ) {
+        State &next = m_Transitions[c];
+        if( next == g_NoState )
+            next = Root;
+        else
+            queue.push(next);
+    }
+    while( !queue.empty() ) {
+        const State state = queue.front();
+        queue.pop();
+        for( size_t c = 0; c < m_ClassesCount; ++c ) {
+            State &next = m_Transitions[(state * m_ClassesCount) + c];
+            const State fallback = m_Transitions[(failure[state] * m_ClassesCount) + c];
+            if( next == g_NoState ) {
+                next = fallback;
+            }
+            else {
+                failure[next] = fallback;
+                found[next].insert(found[next].end(), found[fallback].begin(), found[fallback].end());
+                queue.push(next);
+            }
+        }
+    }
+
+    m_Found.clear();
+    m_FoundStrings.clear();
+    for( const auto &strings : found ) {
+        m_Found.push_back(static_cast<uint32_t>(m_FoundStrings.size()));
+        m_FoundStrings.insert(m_FoundStrings.end(), strings.begin(), strings.end());
+    }
+    m_Found.push_back(static_cast<uint32_t>(m_FoundStrings.size()));
+}
+
+size_t AhoCorasick::StringsCount() const noexcept
+{
+    return m_Lengths.size();
+}
+
+size_t AhoCorasick::StringLength(size_t _string) const noexcept
+{
+    assert(_string < m_Lengths.size());
+    return m_Lengths[_string];
+}
+
+size_t AhoCorasick::MaximumStringLength() const noexcept
+{
+    return m_Lengths.empty() ? 0 : *std::max_element(m_Lengths.begin(), m_Lengths.end());
+}
+
+} // namespace nc::utility
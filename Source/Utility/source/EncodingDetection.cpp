@@ -0,0 +1,411 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include <Utility/EncodingDetection.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace nc::utility {
+
+namespace {
+
+struct LetterFrequency {
+    char16_t lower;
+    char16_t upper; // 0 if there's no uppercase form
+    double frequency;
+};
+
+struct LanguageModel {
+    std::span<const LetterFrequency> letters;
+    std::span<const Encoding> codepages; // ties are resolved in favor of the codepages listed first
+};
+
+} // namespace
+
+// the histogram is accumulated into 32-bit counters, flush them often enough to avoid overflowing
+static constexpr size_t g_HistogramChunk = size_t(1) << 30;
+
+// relative frequency of uppercase letters in a regular text
+static constexpr double g_UppercaseShare = 0.1;
+
+// a text of a single script in UTF-16 has the vast majority of its high bytes the same
+static constexpr double g_UTF16ConcentrationWeight = 1.5;
+
+// a weight of an invalid UTF-8 sequence against a valid one
+static constexpr double g_UTF8ErrorWeight = 8.;
+
+// non-ASCII letters of the Western European languages, frequencies are relative to each other
+static constexpr LetterFrequency g_WesternLetters[] = {
+    {u'é', u'É', 25.},  {u'è', u'È', 4.},   {u'ê', u'Ê', 2.5},  {u'ë', u'Ë', 0.3}, {u'à', u'À', 5.},
+    {u'â', u'Â', 1.},   {u'á', u'Á', 6.},   {u'ä', u'Ä', 7.},   {u'å', u'Å', 3.},  {u'æ', u'Æ', 0.8},
+    {u'ç', u'Ç', 1.5},  {u'î', u'Î', 0.6},  {u'ï', u'Ï', 0.2},  {u'í', u'Í', 5.},  {u'ì', u'Ì', 0.5},
+    {u'ñ', u'Ñ', 3.},   {u'ó', u'Ó', 6.},   {u'ò', u'Ò', 1.},   {u'ô', u'Ô', 0.8}, {u'ö', u'Ö', 6.},
+    {u'õ', u'Õ', 0.8},  {u'ø', u'Ø', 1.5},  {u'ú', u'Ú', 2.},   {u'ù', u'Ù', 0.3}, {u'û', u'Û', 0.3},
+    {u'ü', u'Ü', 6.},   {u'ã', u'Ã', 2.},   {u'ß', 0, 3.},      {u'ý', u'Ý', 0.1}, {u'ÿ', 0, 0.05},
+    {u'œ', u'Œ', 0.3},
+};
+
+static constexpr Encoding g_WesternCodepages[] = {
+    Encoding::ENCODING_WIN1252,
+    Encoding::ENCODING_ISO_8859_1,
+    Encoding::ENCODING_ISO_8859_15,
+    Encoding::ENCODING_MACOS_ROMAN_WESTERN,
+    Encoding::ENCODING_OEM850,
+    Encoding::ENCODING_OEM437,
+};
+
+// non-ASCII letters of the Central European languages
+static constexpr LetterFrequency g_CentralLetters[] = {
+    {u'á', u'Á', 7.},   {u'é', u'É', 5.},   {u'í', u'Í', 5.},   {u'ó', u'Ó', 4.},   {u'ú', u'Ú', 1.5},
+    {u'ý', u'Ý', 3.},   {u'č', u'Č', 4.},   {u'ď', u'Ď', 0.5},  {u'ě', u'Ě', 4.},   {u'ň', u'Ň', 0.5},
+    {u'ř', u'Ř', 3.5},  {u'š', u'Š', 4.5},  {u'ť', u'Ť', 0.8},  {u'ů', u'Ů', 2.},   {u'ž', u'Ž', 4.},
+    {u'ą', u'Ą', 4.},   {u'ć', u'Ć', 1.5},  {u'ę', u'Ę', 4.},   {u'ł', u'Ł', 5.},   {u'ń', u'Ń', 1.5},
+    {u'ś', u'Ś', 2.},   {u'ź', u'Ź', 0.3},  {u'ż', u'Ż', 3.},   {u'ö', u'Ö', 2.},   {u'ü', u'Ü', 1.5},
+    {u'ő', u'Ő', 2.},   {u'ű', u'Ű', 0.8},  {u'ä', u'Ä', 0.3},  {u'ô', u'Ô', 0.3},  {u'ă', u'Ă', 2.},
+    {u'â', u'Â', 1.},   {u'î', u'Î', 1.},   {u'ş', u'Ş', 1.5},  {u'ţ', u'Ţ', 1.5},
+};
+
+static constexpr Encoding g_CentralCodepages[] = {
+    Encoding::ENCODING_WIN1250,
+    Encoding::ENCODING_ISO_8859_2,
+    Encoding::ENCODING_OEM852,
+};
+
+// Russian letters
+static constexpr LetterFrequency g_CyrillicLetters[] = {
+    {u'о', u'О', 10.97}, {u'е', u'Е', 8.45}, {u'а', u'А', 8.01}, {u'и', u'И', 7.35}, {u'н', u'Н', 6.70},
+    {u'т', u'Т', 6.26},  {u'с', u'С', 5.47}, {u'р', u'Р', 4.73}, {u'в', u'В', 4.54}, {u'л', u'Л', 4.40},
+    {u'к', u'К', 3.49},  {u'м', u'М', 3.21}, {u'д', u'Д', 2.98}, {u'п', u'П', 2.81}, {u'у', u'У', 2.62},
+    {u'я', u'Я', 2.01},  {u'ы', u'Ы', 1.90}, {u'ь', u'Ь', 1.74}, {u'г', u'Г', 1.70}, {u'з', u'З', 1.65},
+    {u'б', u'Б', 1.59},  {u'ч', u'Ч', 1.44}, {u'й', u'Й', 1.21}, {u'х', u'Х', 0.97}, {u'ж', u'Ж', 0.94},
+    {u'ш', u'Ш', 0.73},  {u'ю', u'Ю', 0.64}, {u'ц', u'Ц', 0.48}, {u'щ', u'Щ', 0.36}, {u'э', u'Э', 0.32},
+    {u'ф', u'Ф', 0.26},  {u'ъ', u'Ъ', 0.04}, {u'ё', u'Ё', 0.04},
+};
+
+static constexpr Encoding g_CyrillicCodepages[] = {
+    Encoding::ENCODING_WIN1251,
+    Encoding::ENCODING_OEM866,
+    Encoding::ENCODING_ISO_8859_5,
+    Encoding::ENCODING_OEM855,
+};
+
+static constexpr LanguageModel g_LanguageModels[] = {
+    {g_WesternLetters, g_WesternCodepages},
+    {g_CentralLetters, g_CentralCodepages},
+    {g_CyrillicLetters, g_CyrillicCodepages},
+};
+
+// non-letters which are frequent in regular texts regardless of the language, sorted
+static constexpr char16_t g_CommonSymbols[] = {
+    0x00A0, // no-break space
+    0x00A7, // §
+    0x00A9, // ©
+    0x00AB, // «
+    0x00AE, // ®
+    0x00B0, // °
+    0x00B1, // ±
+    0x00B7, // ·
+    0x00BB, // »
+    0x2013, // –
+    0x2014, // —
+    0x2018, // ‘
+    0x2019, // ’
+    0x201C, // “
+    0x201D, // ”
+    0x201E, // „
+    0x2022, // •
+    0x2026, // …
+    0x20AC, // €
+    0x2116, // №
+    0x2122, // ™
+};
+static_assert(std::ranges::is_sorted(g_CommonSymbols));
+
+static std::optional<Encoding> DetectBOM(const unsigned char *_bytes, size_t _size) noexcept
+{
+    if( _size >= 3 && _bytes[0] == 0xEF && _bytes[1] == 0xBB && _bytes[2] == 0xBF )
+        return Encoding::ENCODING_UTF8;
+    if( _size >= 2 && _bytes[0] == 0xFF && _bytes[1] == 0xFE )
+        return Encoding::ENCODING_UTF16LE;
+    if( _size >= 2 && _bytes[0] == 0xFE && _bytes[1] == 0xFF )
+        return Encoding::ENCODING_UTF16BE;
+    return std::nullopt;
+}
+
+static void Histogram(const unsigned char *_bytes,
+                      size_t _size,
+                      std::array<uint64_t, 256> &_even,
+                      std::array<uint64_t, 256> &_odd) noexcept
+{
+    // four interleaved tables break the dependency chains of consecutive increments of the same counter
+    std::array<std::array<uint32_t, 256>, 4> tables;
+    while( _size != 0 ) {
+        const size_t chunk = std::min(_size, g_HistogramChunk);
+        for( auto &table : tables )
+            table.fill(0);
+
+        size_t i = 0;
+        for( ; i + 4 <= chunk; i += 4 ) {
+            ++tables[0][_bytes[i + 0]];
+            ++tables[1][_bytes[i + 1]];
+            ++tables[2][_bytes[i + 2]];
+            ++tables[3][_bytes[i + 3]];
+        }
+        for( ; i < chunk; ++i )
+            ++tables[i % 4][_bytes[i]];
+
+        for( size_t b = 0; b < 256; ++b ) {
+            _even[b] += tables[0][b] + tables[2][b];
+            _odd[b] += tables[1][b] + tables[3][b];
+        }
+        _bytes += chunk;
+        _size -= chunk;
+    }
+}
+
+static bool IsUTF8Continuation(unsigned char _byte) noexcept
+{
+    return (_byte & 0xC0) == 0x80;
+}
+
+// Checks whether the bytes are a valid beginning of a UTF-8 sequence which was cut by the end of a sample.
+static bool IsTruncatedUTF8Sequence(const unsigned char *_bytes, size_t _size) noexcept
+{
+    const unsigned char lead = _bytes[0];
+    const size_t length = (lead & 0xE0) == 0xC0 ? 2 : (lead & 0xF0) == 0xE0 ? 3 : (lead & 0xF8) == 0xF0 ? 4 : 0;
+    return length > _size && std::all_of(_bytes + 1, _bytes + _size, IsUTF8Continuation);
+}
+
+// Whether the byte is a control character which is unlikely to be found in a text.
+static bool IsBinaryControl(size_t _byte) noexcept
+{
+    return (_byte < 0x20 && _byte != '\t' && _byte != '\n' && _byte != '\v' && _byte != '\f' && _byte != '\r' &&
+            _byte != 0x1B) ||
+           _byte == 0x7F;
+}
+
+static bool IsCommonSymbol(char16_t _c) noexcept
+{
+    return std::ranges::binary_search(g_CommonSymbols, _c);
+}
+
+static std::array<unsigned short, 128> DecodeUpperHalf(Encoding _codepage) noexcept
+{
+    std::array<unsigned char, 128> bytes;
+    std::iota(bytes.begin(), bytes.end(), static_cast<unsigned char>(0x80));
+    std::array<unsigned short, 128> chars;
+    InterpretSingleByteBufferAsUniCharPreservingBufferSize(bytes.data(), bytes.size(), chars.data(), _codepage);
+    return chars;
+}
+
+// Returns the cosine similarity between the observed distribution of the non-ASCII letters and the model, scaled by
+// the share of bytes which make sense in a text.
+static double CodepageConfidence(const std::array<uint64_t, 256> &_histogram,
+                                 uint64_t _non_ascii,
+                                 const LanguageModel &_model,
+                                 Encoding _codepage) noexcept
+{
+    const auto chars = DecodeUpperHalf(_codepage);
+    double dot = 0.;
+    double observed_norm = 0.;
+    uint64_t sensible = 0;
+    for( size_t b = 0x80; b < 256; ++b ) {
+        const uint64_t count = _histogram[b];
+        if( count == 0 )
+            continue;
+        const char16_t c = chars[b - 0x80];
+        const auto letter = std::ranges::find_if(_model.letters, [c](const LetterFrequency &_l) {
+            return _l.lower == c || (_l.upper != 0 && _l.upper == c);
+        });
+        if( letter != _model.letters.end() ) {
+            const double frequency = letter->lower == c ? letter->frequency : letter->frequency * g_UppercaseShare;
+            dot += static_cast<double>(count) * frequency;
+            observed_norm += static_cast<double>(count) * static_cast<double>(count);
+            sensible += count;
+        }
+        else if( IsCommonSymbol(c) ) {
+            sensible += count;
+        }
+    }
+    if( dot == 0. )
+        return 0.;
+
+    double model_norm = 0.;
+    for( const LetterFrequency &letter : _model.letters ) {
+        model_norm += letter.frequency * letter.frequency;
+        if( letter.upper != 0 )
+            model_norm += (letter.frequency * g_UppercaseShare) * (letter.frequency * g_UppercaseShare);
+    }
+
+    const double cosine = dot / (std::sqrt(observed_norm) * std::sqrt(model_norm));
+    return cosine * static_cast<double>(sensible) / static_cast<double>(_non_ascii);
+}
+
+void EncodingDetector::Feed(uint64_t _offset, std::span<const std::byte> _sample) noexcept
+{
+    auto bytes = reinterpret_cast<const unsigned char *>(_sample.data());
+    size_t size = _sample.size();
+    if( size == 0 )
+        return;
+
+    if( _offset == 0 )
+        m_BOM = DetectBOM(bytes, size);
+
+    if( _offset % 2 == 1 ) {
+        // keep the UTF-16 code units aligned
+        ++bytes;
+        --size;
+    }
+
+    Histogram(bytes, size, m_Even, m_Odd);
+    FeedUTF8(bytes, size);
+    FeedUTF16(bytes, size);
+    m_Fed += size;
+}
+
+void EncodingDetector::FeedUTF8(const unsigned char *_bytes, size_t _size) noexcept
+{
+    size_t pos = 0;
+    // the sample can start in the middle of a sequence
+    while( pos < _size && pos < 3 && IsUTF8Continuation(_bytes[pos]) )
+        ++pos;
+
+    while( pos < _size ) {
+        pos += ScanUTF8ForValidSequenceLength(_bytes + pos, _size - pos);
+        if( pos == _size || IsTruncatedUTF8Sequence(_bytes + pos, _size - pos) )
+            break;
+        ++m_UTF8Errors;
+        ++pos;
+    }
+}
+
+void EncodingDetector::FeedUTF16(const unsigned char *_bytes, size_t _size) noexcept
+{
+    const size_t words = _size / 2;
+    for( const bool le : {true, false} ) {
+        const unsigned char *high = _bytes + (le ? 1 : 0);
+        uint64_t errors = 0;
+        for( size_t i = 0; i < words; ++i ) {
+            const unsigned char h = high[i * 2];
+            if( (h & 0xF8) != 0xD8 )
+                continue; // not a surrogate
+            if( h < 0xDC ) {
+                if( i + 1 == words )
+                    break; // torn by the end of the sample
+                const unsigned char next = high[(i + 1) * 2];
+                if( next >= 0xDC && next <= 0xDF ) {
+                    ++i;
+                    continue;
+                }
+            }
+            else if( i == 0 ) {
+                continue; // torn by the beginning of the sample
+            }
+            ++errors;
+        }
+        (le ? m_UTF16LEErrors : m_UTF16BEErrors) += errors;
+    }
+}
+
+uint64_t EncodingDetector::Fed() const noexcept
+{
+    return m_Fed;
+}
+
+double EncodingDetector::UTF8Confidence() const noexcept
+{
+    uint64_t non_ascii = 0;
+    uint64_t leads = 0;
+    for( size_t b = 0x80; b < 256; ++b ) {
+        non_ascii += m_Even[b] + m_Odd[b];
+        if( b >= 0xC2 && b <= 0xF4 )
+            leads += m_Even[b] + m_Odd[b];
+    }
+    if( non_ascii == 0 && m_UTF8Errors == 0 )
+        return ZerosPenalty(); // plain ASCII
+
+    const double valid = static_cast<double>(leads > m_UTF8Errors ? leads - m_UTF8Errors : 0);
+    const double invalid = static_cast<double>(m_UTF8Errors) * g_UTF8ErrorWeight;
+    return valid + invalid > 0. ? ZerosPenalty() * valid / (valid + invalid) : 0.;
+}
+
+double EncodingDetector::ZerosPenalty() const noexcept
+{
+    // zeros are valid characters in UTF-8 and in the codepages, but not in a text, while they are all over UTF-16
+    if( m_Fed == 0 )
+        return 1.;
+    const uint64_t zeros = m_Even[0] + m_Odd[0];
+    return std::max(0., 1. - (static_cast<double>(zeros) * 20. / static_cast<double>(m_Fed)));
+}
+
+double EncodingDetector::UTF16Confidence(bool _le) const noexcept
+{
+    const auto &high = _le ? m_Odd : m_Even;
+    const auto &low = _le ? m_Even : m_Odd;
+    const uint64_t high_total = std::reduce(high.begin(), high.end(), uint64_t(0));
+    const uint64_t low_total = std::reduce(low.begin(), low.end(), uint64_t(0));
+    if( high_total == 0 || low_total == 0 )
+        return 0.;
+
+    const double high_concentration =
+        static_cast<double>(*std::ranges::max_element(high)) / static_cast<double>(high_total);
+    const double low_concentration =
+        static_cast<double>(*std::ranges::max_element(low)) / static_cast<double>(low_total);
+    double confidence = std::clamp((high_concentration - low_concentration) * g_UTF16ConcentrationWeight, 0., 1.);
+
+    // characters like U+xx00 are rare, as well as broken surrogate pairs
+    const uint64_t errors = _le ? m_UTF16LEErrors : m_UTF16BEErrors;
+    confidence *= std::max(0., 1. - (static_cast<double>(errors) * 100. / static_cast<double>(high_total)));
+    confidence *= std::max(0., 1. - (static_cast<double>(low[0]) * 20. / static_cast<double>(low_total)));
+    return confidence;
+}
+
+EncodingDetector::Verdict EncodingDetector::Conclude() const
+{
+    std::array<uint64_t, 256> histogram;
+    for( size_t b = 0; b < 256; ++b )
+        histogram[b] = m_Even[b] + m_Odd[b];
+    const uint64_t non_ascii = std::reduce(histogram.begin() + 0x80, histogram.end(), uint64_t(0));
+
+    Verdict verdict;
+    verdict.candidates.push_back({Encoding::ENCODING_UTF8, UTF8Confidence()});
+    verdict.candidates.push_back({Encoding::ENCODING_UTF16LE, UTF16Confidence(true)});
+    verdict.candidates.push_back({Encoding::ENCODING_UTF16BE, UTF16Confidence(false)});
+    if( non_ascii != 0 ) {
+        const double zeros_penalty = ZerosPenalty();
+        for( const LanguageModel &model : g_LanguageModels )
+            for( const Encoding codepage : model.codepages )
+                verdict.candidates.push_back(
+                    {codepage, zeros_penalty * CodepageConfidence(histogram, non_ascii, model, codepage)});
+    }
+    if( m_BOM )
+        std::ranges::find_if(verdict.candidates, [&](const Candidate &_c) { return _c.encoding == *m_BOM; })
+            ->confidence = 1.;
+
+    std::ranges::stable_sort(verdict.candidates, std::ranges::greater{}, &Candidate::confidence);
+    if( m_BOM )
+        std::ranges::stable_partition(verdict.candidates, [&](const Candidate &_c) { return _c.encoding == *m_BOM; });
+    verdict.candidates.erase(std::find_if(std::next(verdict.candidates.begin()),
+                                          verdict.candidates.end(),
+                                          [](const Candidate &_c) { return _c.confidence == 0.; }),
+                             verdict.candidates.end());
+
+    const Encoding best = verdict.candidates.front().encoding;
+    if( best == Encoding::ENCODING_UTF16LE || best == Encoding::ENCODING_UTF16BE ) {
+        // zero bytes are expected in UTF-16, look for the zero code units instead
+        const auto &low = best == Encoding::ENCODING_UTF16LE ? m_Even : m_Odd;
+        const uint64_t low_total = std::reduce(low.begin(), low.end(), uint64_t(0));
+        verdict.is_binary = low[0] * 100 > low_total;
+    }
+    else {
+        // zeros are the most telling sign of the binary data
+        uint64_t suspicious = 0;
+        for( size_t b = 0; b < 0x80; ++b )
+            if( IsBinaryControl(b) )
+                suspicious += histogram[b] * (b == 0 ? 4 : 1);
+        verdict.is_binary = suspicious * 200 > m_Fed;
+    }
+    return verdict;
+}
+
+} // namespace nc::utility
@@ -1,8 +1,19 @@
 // Copyright (C) 2013-2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include <Utility/Encodings.h>
+#include "EncodingsScalar.h"
 
 namespace nc::utility {
 
@@ -930,6 +941,160 @@ static_assert(sizeof(g_SingleBytesTable) / sizeof(unsigned short *) ==
 
 static const uint16_t g_ReplacementCharacter = 0xFFFD; //  � character
 
+// The decoders below process the input in blocks of 16 bytes whenever it's possible: runs of ASCII characters, runs
+// of UTF-8 two-byte sequences and single-byte codepages are handled with vector instructions, while everything else
+// falls back to the scalar steps which decode exactly one sequence (or one malformed byte) at a time. Both paths
+// produce identical output.
+static constexpr size_t g_BlockSize = 16;
+
+// Returns the amount of leading ASCII bytes in the block, [0..16].
+static inline size_t ASCIIPrefixLength(const unsigned char *_block) noexcept
+{
+#if defined(__aarch64__)
+    const uint8x16_t non_ascii = vcgeq_u8(vld1q_u8(_block), vdupq_n_u8(0x80));
+    // NEON has no movemask, so the comparison result is narrowed into 4 bits per byte instead
+    const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(non_ascii), 4)), 0);
+    return mask == 0 ? g_BlockSize : static_cast<size_t>(std::countr_zero(mask)) / 4;
+#elif defined(__SSE2__)
+    const unsigned mask =
+        static_cast<unsigned>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(_block))));
+    return mask == 0 ? g_BlockSize : static_cast<size_t>(std::countr_zero(mask));
+#else
+    for( size_t i = 0; i < g_BlockSize; ++i )
+        if( _block[i] >= 0x80 )
+            return i;
+    return g_BlockSize;
+#endif
+}
+
+// Checks whether the block contains any control characters, i.e. bytes below 0x20.
+static inline bool HasControlCharacters(const unsigned char *_block) noexcept
+{
+#if defined(__aarch64__)
+    return vmaxvq_u8(vcltq_u8(vld1q_u8(_block), vdupq_n_u8(0x20))) != 0;
+#elif defined(__SSE2__)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_block));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1F)), v)) != 0;
+#else
+    for( size_t i = 0; i < g_BlockSize; ++i )
+        if( _block[i] < 0x20 )
+            return true;
+    return false;
+#endif
+}
+
+// Zero-extends 16 bytes into 16 UTF-16 code units.
+static inline void WidenBlock(const unsigned char *_block, uint16_t *_output) noexcept
+{
+#if defined(__aarch64__)
+    const uint8x16_t v = vld1q_u8(_block);
+    vst1q_u16(_output, vmovl_u8(vget_low_u8(v)));
+    vst1q_u16(_output + 8, vmovl_u8(vget_high_u8(v)));
+#elif defined(__SSE2__)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_block));
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_output), _mm_unpacklo_epi8(v, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_output + 8), _mm_unpackhi_epi8(v, zero));
+#else
+    for( size_t i = 0; i < g_BlockSize; ++i )
+        _output[i] = _block[i];
+#endif
+}
+
+// Checks whether the block consists of exactly 8 two-byte sequences, i.e. 110xxxxx 10xxxxxx pairs.
+static inline bool IsTwoByteSequencesBlock(const unsigned char *_block) noexcept
+{
+    // each pair is treated as a little-endian 16-bit word: the leading byte is in the low half
+#if defined(__aarch64__)
+    const uint16x8_t w = vreinterpretq_u16_u8(vld1q_u8(_block));
+    return vminvq_u16(vceqq_u16(vandq_u16(w, vdupq_n_u16(0xC0E0)), vdupq_n_u16(0x80C0))) != 0;
+#elif defined(__SSE2__)
+    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_block));
+    const __m128i masked = _mm_and_si128(w, _mm_set1_epi16(static_cast<short>(0xC0E0)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(masked, _mm_set1_epi16(static_cast<short>(0x80C0)))) == 0xFFFF;
+#else
+    for( size_t i = 0; i < g_BlockSize; i += 2 )
+        if( (_block[i] & 0xE0) != 0xC0 || (_block[i + 1] & 0xC0) != 0x80 )
+            return false;
+    return true;
+#endif
+}
+
+// Decodes a block verified by IsTwoByteSequencesBlock() into 8 UTF-16 code units.
+static inline void DecodeTwoByteSequencesBlock(const unsigned char *_block, uint16_t *_output) noexcept
+{
+#if defined(__aarch64__)
+    const uint16x8_t w = vreinterpretq_u16_u8(vld1q_u8(_block));
+    const uint16x8_t high = vshlq_n_u16(vandq_u16(w, vdupq_n_u16(0x1F)), 6);
+    const uint16x8_t low = vandq_u16(vshrq_n_u16(w, 8), vdupq_n_u16(0x3F));
+    vst1q_u16(_output, vorrq_u16(high, low));
+#elif defined(__SSE2__)
+    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_block));
+    const __m128i high = _mm_slli_epi16(_mm_and_si128(w, _mm_set1_epi16(0x1F)), 6);
+    const __m128i low = _mm_and_si128(_mm_srli_epi16(w, 8), _mm_set1_epi16(0x3F));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(_output), _mm_or_si128(high, low));
+#else
+    for( size_t i = 0; i < g_BlockSize / 2; ++i )
+        _output[i] = static_cast<uint16_t>(((_block[2 * i] & 0x1F) << 6) | (_block[2 * i + 1] & 0x3F));
+#endif
+}
+
+// Checks whether the codepage maps the lower half of the table onto ASCII as-is.
+static bool IsASCIICompatible(const unsigned short *_table) noexcept
+{
+    for( unsigned short i = 0; i < 0x80; ++i )
+        if( _table[i] != i )
+            return false;
+    return true;
+}
+
+#if defined(__aarch64__)
+namespace {
+
+// The codepage table split into the planes of low and high bytes of the resulting code units, each plane is kept in
+// 4 quadruples of registers suitable for 64-entry table lookups.
+struct SingleByteTablePlanes {
+    uint8x16x4_t low[4];
+    uint8x16x4_t high[4];
+};
+
+} // namespace
+
+static SingleByteTablePlanes MakeSingleByteTablePlanes(const unsigned short *_table) noexcept
+{
+    uint8_t low[256];
+    uint8_t high[256];
+    for( int i = 0; i < 256; ++i ) {
+        low[i] = static_cast<uint8_t>(_table[i] & 0xFF);
+        high[i] = static_cast<uint8_t>(_table[i] >> 8);
+    }
+    SingleByteTablePlanes planes;
+    for( int i = 0; i < 4; ++i ) {
+        planes.low[i] = vld1q_u8_x4(low + 64 * i);
+        planes.high[i] = vld1q_u8_x4(high + 64 * i);
+    }
+    return planes;
+}
+
+// Translates 16 bytes via the codepage table. Lookups yield zeros for out-of-range indices, hence each byte hits
+// exactly one of the four quarters of a plane and the partial results can be simply OR-ed.
+static inline void TranslateBlock(const unsigned char *_block,
+                                  const SingleByteTablePlanes &_planes,
+                                  uint16_t *_output) noexcept
+{
+    const uint8x16_t index = vld1q_u8(_block);
+    uint8x16_t low = vqtbl4q_u8(_planes.low[0], index);
+    uint8x16_t high = vqtbl4q_u8(_planes.high[0], index);
+    for( int i = 1; i < 4; ++i ) {
+        const uint8x16_t shifted = vsubq_u8(index, vdupq_n_u8(static_cast<uint8_t>(64 * i)));
+        low = vorrq_u8(low, vqtbl4q_u8(_planes.low[i], shifted));
+        high = vorrq_u8(high, vqtbl4q_u8(_planes.high[i], shifted));
+    }
+    // interleaving the planes gives little-endian 16-bit code units
+    vst2q_u8(reinterpret_cast<uint8_t *>(_output), uint8x16x2_t{{low, high}});
+}
+#endif
+
 void InterpretSingleByteBufferAsUniCharPreservingBufferSize(
     const unsigned char *_input,
     size_t _input_size,
@@ -943,245 +1108,390 @@ void InterpretSingleByteBufferAsUniCharPreservingBufferSize(
 
     auto *t = g_SingleBytesTable[std::to_underlying(_codepage)];
     const unsigned char *end = _input + _input_size;
+    if( _input_size >= g_BlockSize * 4 ) { // not worth the setup for tiny inputs
+        const bool ascii_compatible = IsASCIICompatible(t);
+#if defined(__aarch64__)
+        const SingleByteTablePlanes planes = MakeSingleByteTablePlanes(t);
+        for( ; static_cast<size_t>(end - _input) >= g_BlockSize; _input += g_BlockSize, _output += g_BlockSize ) {
+            if( ascii_compatible && ASCIIPrefixLength(_input) == g_BlockSize )
+                WidenBlock(_input, _output);
+            else
+                TranslateBlock(_input, planes, _output);
+        }
+#else
+        // no byte-wide table lookups here, so only the runs of ASCII are vectorized
+        if( ascii_compatible )
+            for( ; static_cast<size_t>(end - _input) >= g_BlockSize; _input += g_BlockSize, _output += g_BlockSize ) {
+                const size_t ascii = ASCIIPrefixLength(_input);
+                WidenBlock(_input, _output);
+                for( size_t i = ascii; i < g_BlockSize; ++i )
+                    _output[i] = t[_input[i]];
+            }
+#endif
+    }
     while( _input < end )
         *(_output++) = t[*(_input++)];
 }
 
-void InterpretUTF8BufferAsUniCharPreservingBufferSize(
-    const unsigned char *_input,
-    size_t _input_size,
-    unsigned short *_output, // should be at least _input_size 16b words long,
-    unsigned short _stuffing_symb,
-    unsigned short _bad_symb)
+bool InterpretUnicharsAsSingleByte(const uint16_t *_input,
+                                   size_t _input_size,
+                                   unsigned char *_output,
+                                   Encoding _codepage) noexcept
 {
-    const unsigned char *end = _input + _input_size;
+    if( _codepage < Encoding::ENCODING_SINGLE_BYTES_FIRST__ || _codepage > Encoding::ENCODING_SINGLE_BYTES_LAST__ )
+        return false;
 
-    while( _input < end ) {
-        unsigned char current = *_input;
-
-        int sz = 0;
-
-        // get symbol size in bytes
-        if( (current & 0x80) == 0 )
-            sz = 1; // single-byte
-        else if( (current & 0xE0) == 0xC0 )
-            sz = 2; // two-byte
-        else if( (current & 0xF0) == 0xE0 )
-            sz = 3; // three-byte
-        else if( (current & 0xF8) == 0xF0 )
-            sz = 4; // four-byte
-        else {
-            // malformed!
+    auto *t = g_SingleBytesTable[std::to_underlying(_codepage)];
+    std::array<std::pair<uint16_t, unsigned char>, 256> reverse;
+    for( int i = 0; i < 256; ++i )
+        reverse[i] = {t[i], static_cast<unsigned char>(i)};
+    std::ranges::sort(reverse);
+
+    for( size_t i = 0; i < _input_size; ++i ) {
+        const auto range = std::ranges::equal_range(reverse, _input[i], {}, &std::pair<uint16_t, unsigned char>::first);
+        if( range.size() != 1 )
+            return false; // either unmappable or ambiguous
+        _output[i] = range.front().second;
+    }
+    return true;
+}
 
-            // skip current character and move further
-            *_output = _bad_symb;
-            ++_input;
-            ++_output;
-            continue;
+// Returns the length of a sequence by its leading byte or 0 if the byte can't start a sequence.
+static inline int UTF8SequenceLength(unsigned char _leading) noexcept
+{
+    if( (_leading & 0x80) == 0 )
+        return 1; // single-byte
+    else if( (_leading & 0xE0) == 0xC0 )
+        return 2; // two-byte
+    else if( (_leading & 0xF0) == 0xE0 )
+        return 3; // three-byte
+    else if( (_leading & 0xF8) == 0xF0 )
+        return 4; // four-byte
+    else
+        return 0; // malformed
+}
+
+static inline void StepUTF8AsUniCharPreservingBufferSize(const unsigned char *&_input,
+                                                         const unsigned char *_end,
+                                                         unsigned short *&_output,
+                                                         unsigned short _stuffing_symb,
+                                                         unsigned short _bad_symb) noexcept
+{
+    unsigned char current = *_input;
+    const int sz = UTF8SequenceLength(current);
+    if( sz == 0 ) {
+        // malformed! - skip current character and move further
+        *(_output++) = _bad_symb;
+        ++_input;
+        return;
+    }
+
+    if( sz == 1 ) {
+        // just out current symbol
+        *(_output++) = current >= 32 ? current : g_NonPrintedSymbsVisualization[current];
+        ++_input;
+        return;
+    }
+
+    // try to extract a sequence
+    for( int i = 1; i < sz; ++i ) {
+        // check for an unexpected end of buffer
+        if( _input + i == _end ) {
+            // just fill output as bad
+            for( int z = 0; z < i; ++z ) {
+                ++_input;
+                *(_output++) = _bad_symb;
+            }
+            return;
         }
 
-        if( sz == 1 ) {
-            // just out current symbol
-            if( current >= 32 )
-                *_output = current;
-            else
-                *_output = g_NonPrintedSymbsVisualization[current];
+        current = *(_input + i);
+
+        // check for malformed sequence
+        if( (current & 0xC0) != 0x80 ) {
+            // bad, bad sequence! - skip the heading character and move further
+            *(_output++) = _bad_symb;
             ++_input;
-            ++_output;
-            continue;
+            return;
         }
+    }
 
-        // try to extract a sequence
-
+    // seems that sequence is ok
+    if( sz == 2 ) {
+        const unsigned char high = *_input;
+        const unsigned char low = *(_input + 1);
+        *(_output++) = static_cast<unsigned short>(((static_cast<unsigned short>(high & 0x1F)) << 6) | (low & 0x3F));
+        *(_output++) = _stuffing_symb;
+        _input += 2;
+    }
+    else if( sz == 3 ) {
+        const unsigned char _1 = *_input;
+        const unsigned char _2 = *(_input + 1);
+        const unsigned char _3 = *(_input + 2);
+        *(_output++) = static_cast<unsigned short>((static_cast<unsigned short>(_1 & 0xF) << 12) |
+                                                   (static_cast<unsigned short>(_2 & 0x3F) << 6) |
+                                                   (static_cast<unsigned short>(_3 & 0x3F)));
+        *(_output++) = _stuffing_symb;
+        *(_output++) = _stuffing_symb;
+        _input += 3;
+    }
+    else {
+        // toooooo long for current implementation
+        *(_output++) = _bad_symb; // symbols that didn't fit into 16bits
+        ++_input;
         for( int i = 1; i < sz; ++i ) {
-            // check for an unexpected end of buffer
-            if( _input + i == end ) {
-                // just fill output as bad
-                for( int z = 0; z < i; ++z ) {
-                    ++_input;
-                    *_output = _bad_symb;
-                    ++_output;
-                }
-                goto goon;
-            }
+            *(_output++) = _stuffing_symb;
+            ++_input;
+        }
+    }
+}
 
-            current = *(_input + i);
+static inline void StepUTF8AsUTF16(const unsigned char *&_input,
+                                   const unsigned char *_end,
+                                   uint16_t *&_output_buf,
+                                   uint16_t _bad_symb) noexcept
+{
+    const unsigned char current = *_input;
+    const int sz = UTF8SequenceLength(current);
+    if( sz == 0 ) {
+        // malformed! - skip current character and move further
+        *(_output_buf++) = _bad_symb;
+        ++_input;
+        return;
+    }
+
+    if( sz == 1 ) { // just out current symbol
+        *(_output_buf++) = current;
+        ++_input;
+        return;
+    }
 
-            // check for malformed sequence
-            if( (current & 0xC0) != 0x80 ) {
-                // bad, bad sequence!
+    // try to extract a sequence
 
-                // skip the heading character and move further
-                *_output = _bad_symb;
+    // validate sequence
+    for( int i = 1; i < sz; ++i ) {
+        // check for an unexpected end of buffer
+        if( _input + i == _end ) {
+            // just fill output as bad
+            for( int z = 0; z < i; ++z ) {
                 ++_input;
-                ++_output;
-                goto goon;
+                *(_output_buf++) = _bad_symb;
             }
+            return;
         }
 
-        // seems that sequence is ok
-        if( sz == 2 ) {
-            const unsigned char high = *_input;
-            const unsigned char low = *(_input + 1);
-            const unsigned short out =
-                static_cast<unsigned short>(((static_cast<unsigned short>(high & 0x1F)) << 6) | (low & 0x3F));
-
-            *_output = out;
-            ++_output;
-            *_output = _stuffing_symb;
-            ++_output;
-            _input += 2;
-            continue;
+        // check for malformed sequence
+        if( (_input[i] & 0xC0) != 0x80 ) {
+            // bad, bad sequence! - skip the heading character and move further
+            *(_output_buf++) = _bad_symb;
+            ++_input;
+            return;
         }
-        else if( sz == 3 ) {
-            const unsigned char _1 = *_input;
-            const unsigned char _2 = *(_input + 1);
-            const unsigned char _3 = *(_input + 2);
-            const unsigned short out = static_cast<unsigned short>((static_cast<unsigned short>(_1 & 0xF) << 12) |
-                                                                   (static_cast<unsigned short>(_2 & 0x3F) << 6) |
-                                                                   (static_cast<unsigned short>(_3 & 0x3F)));
-            *_output = out;
-            ++_output;
-            *_output = _stuffing_symb;
-            ++_output;
-            *_output = _stuffing_symb;
-            ++_output;
-            _input += 3;
-            continue;
+    }
+
+    // seems that sequence is ok
+    if( sz == 2 ) {
+        const unsigned short _1 = _input[0] & 0x1F;
+        const unsigned short _2 = _input[1] & 0x3F;
+        *(_output_buf++) = static_cast<unsigned short>((_1 << 6) | _2);
+        _input += 2;
+    }
+    else if( sz == 3 ) {
+        const uint16_t _1 = _input[0] & 0x0F;
+        const uint16_t _2 = _input[1] & 0x3F;
+        const uint16_t _3 = _input[2] & 0x3F;
+        *(_output_buf++) = static_cast<unsigned short>((_1 << 12) | (_2 << 6) | _3);
+        _input += 3;
+    }
+    else {
+        const uint32_t _1 = _input[0] & 0x07;
+        const uint32_t _2 = _input[1] & 0x3F;
+        const uint32_t _3 = _input[2] & 0x3F;
+        const uint32_t _4 = _input[3] & 0x3F;
+        const uint32_t out = (_1 << 18) | (_2 << 12) | (_3 << 6) | _4;
+        if( out < 0x10000 ) { // possibly malformed UTF8 (?)
+            *(_output_buf++) = uint16_t(out);
         }
         else {
-            // toooooo long for current implementation
-
-            *_output = _bad_symb; // symbols that didn't fit into 16bits
-            ++_output;
-            ++_input;
-            for( int i = 1; i < sz; ++i ) {
-                *_output = _stuffing_symb;
-                ++_output;
-                ++_input;
-            }
-            continue;
+            *(_output_buf++) = static_cast<unsigned short>(0xD800 + ((out - 0x010000) >> 10));
+            *(_output_buf++) = static_cast<unsigned short>(0xDC00 + ((out - 0x010000) & 0x3FF));
         }
-    goon:;
+        _input += 4;
     }
 }
 
-void InterpretUTF8BufferAsUTF16(const uint8_t *_input,
-                                size_t _input_size,
-                                uint16_t *_output_buf, // should be at least _input_size 16b words long
-                                size_t *_output_sz,    // size of an output
-                                uint16_t _bad_symb     // something like '?' or U+FFFD
-)
+static inline void StepUTF8AsIndexedUTF16(const unsigned char *&_input,
+                                          const unsigned char *_start,
+                                          const unsigned char *_end,
+                                          unsigned short *&_output_buf,
+                                          uint32_t *&_indexes_buf,
+                                          unsigned short _bad_symb) noexcept
 {
-    const unsigned char *end = _input + _input_size;
+    const uint32_t index = static_cast<uint32_t>(_input - _start);
+    unsigned char current = *_input;
+    const int sz = UTF8SequenceLength(current);
+    if( sz == 0 ) {
+        // malformed! - skip current character and move further
+        *(_output_buf++) = _bad_symb;
+        *(_indexes_buf++) = index;
+        ++_input;
+        return;
+    }
 
-    size_t total = 0;
+    if( sz == 1 ) {
+        // just out current symbol
+        *(_output_buf++) = current;
+        *(_indexes_buf++) = index;
+        ++_input;
+        return;
+    }
 
-    while( _input < end ) {
-        const unsigned char current = *_input;
-
-        int sz = 0;
-
-        // get symbol size in bytes
-        if( (current & 0x80) == 0 )
-            sz = 1; // single-byte
-        else if( (current & 0xE0) == 0xC0 )
-            sz = 2; // two-byte
-        else if( (current & 0xF0) == 0xE0 )
-            sz = 3; // three-byte
-        else if( (current & 0xF8) == 0xF0 )
-            sz = 4; // four-byte
-        else {
-            // malformed! - skip current character and move further
-            *_output_buf = _bad_symb;
-            ++_input;
-            ++_output_buf;
-            ++total;
-            continue;
+    // try to extract a sequence
+    for( int i = 1; i < sz; ++i ) {
+        // check for an unexpected end of buffer
+        if( _input + i == _end ) {
+            // just fill output as bad
+            for( int z = 0; z < i; ++z ) {
+                *(_output_buf++) = _bad_symb;
+                *(_indexes_buf++) = static_cast<uint32_t>(_input - _start);
+                ++_input;
+            }
+            return;
         }
 
-        if( sz == 1 ) { // just out current symbol
-            *_output_buf = current;
+        current = *(_input + i);
+
+        // check for malformed sequence
+        if( (current & 0xC0) != 0x80 ) {
+            // bad, bad sequence! - skip the heading character and move further
+            *(_output_buf++) = _bad_symb;
+            *(_indexes_buf++) = index;
             ++_input;
-            ++_output_buf;
-            ++total;
-            continue;
+            return;
         }
+    }
 
-        // try to extract a sequence
+    // seems that sequence is ok
+    if( sz == 2 ) {
+        const unsigned short high = *_input;
+        const unsigned short low = *(_input + 1);
+        *(_output_buf++) = static_cast<unsigned short>((((high & 0x1F)) << 6) | (low & 0x3F));
+        *(_indexes_buf++) = index;
+        _input += 2;
+    }
+    else if( sz == 3 ) {
+        const unsigned short _1 = *_input;
+        const unsigned short _2 = *(_input + 1);
+        const unsigned short _3 = *(_input + 2);
+        *(_output_buf++) = static_cast<unsigned short>((((_1 & 0xF)) << 12) | (((_2 & 0x3F)) << 6) | (_3 & 0x3F));
+        *(_indexes_buf++) = index;
+        _input += 3;
+    }
+    else {
+        const uint32_t _1 = _input[0] & 0x07;
+        const uint32_t _2 = _input[1] & 0x3F;
+        const uint32_t _3 = _input[2] & 0x3F;
+        const uint32_t _4 = _input[3] & 0x3F;
+        const uint32_t out = (_1 << 18) | (_2 << 12) | (_3 << 6) | _4;
+        if( out < 0x10000 || // possibly malformed UTF8 (?)
+            (out >= 0x30000U && out < 0xE0000U) ) {
+            *(_output_buf++) = _bad_symb;
+            *(_indexes_buf++) = index;
+        }
+        else {
+            *(_output_buf++) = static_cast<unsigned short>(0xD800 + ((out - 0x010000) >> 10));
+            *(_output_buf++) = static_cast<unsigned short>(0xDC00 + ((out - 0x010000) & 0x3FF));
+            // lead and trailing surrpairs chars will point at same byte position
+            *(_indexes_buf++) = index;
+            *(_indexes_buf++) = index;
+        }
+        _input += 4;
+    }
+}
 
-        // validate sequence
-        for( int i = 1; i < sz; ++i ) {
-            // check for an unexpected end of buffer
-            if( _input + i == end ) {
-                // just fill output as bad
-                for( int z = 0; z < i; ++z ) {
-                    ++_input;
-                    *_output_buf = _bad_symb;
-                    ++_output_buf;
-                    ++total;
-                }
-                goto goon;
-            }
+// Returns the length of a complete and valid sequence at _input or 0 if there's none.
+static inline size_t ValidUTF8SequenceLength(const unsigned char *_input, const unsigned char *_end) noexcept
+{
+    const int sz = UTF8SequenceLength(*_input);
+    if( sz == 0 || _end - _input < sz )
+        return 0;
+    for( int i = 1; i < sz; ++i )
+        if( (_input[i] & 0xC0) != 0x80 )
+            return 0;
+    return static_cast<size_t>(sz);
+}
 
-            // check for malformed sequence
-            if( (_input[i] & 0xC0) != 0x80 ) {
-                // bad, bad sequence! - skip the heading character and move further
-                *_output_buf = _bad_symb;
-                ++_input;
-                ++_output_buf;
-                ++total;
-                goto goon;
+void InterpretUTF8BufferAsUniCharPreservingBufferSize(
+    const unsigned char *_input,
+    size_t _input_size,
+    unsigned short *_output, // should be at least _input_size 16b words long,
+    unsigned short _stuffing_symb,
+    unsigned short _bad_symb)
+{
+    const unsigned char *const end = _input + _input_size;
+
+    while( _input < end ) {
+        if( static_cast<size_t>(end - _input) >= g_BlockSize ) {
+            const size_t ascii = ASCIIPrefixLength(_input);
+            if( ascii != 0 ) {
+                // the output is always at the same offset as the input, so the whole block can be written
+                WidenBlock(_input, _output);
+                if( HasControlCharacters(_input) )
+                    for( size_t i = 0; i < ascii; ++i )
+                        if( _input[i] < 32 )
+                            _output[i] = g_NonPrintedSymbsVisualization[_input[i]];
+                _input += ascii;
+                _output += ascii;
+                if( ascii == g_BlockSize )
+                    continue;
+            }
+            else if( IsTwoByteSequencesBlock(_input) ) {
+                uint16_t decoded[g_BlockSize / 2];
+                DecodeTwoByteSequencesBlock(_input, decoded);
+                for( size_t i = 0; i < g_BlockSize / 2; ++i ) {
+                    *(_output++) = decoded[i];
+                    *(_output++) = _stuffing_symb;
+                }
+                _input += g_BlockSize;
+                continue;
             }
         }
+        StepUTF8AsUniCharPreservingBufferSize(_input, end, _output, _stuffing_symb, _bad_symb);
+    }
+}
 
-        // seems that sequence is ok
-        if( sz == 2 ) {
-            const unsigned short _1 = _input[0] & 0x1F;
-            const unsigned short _2 = _input[1] & 0x3F;
-            const unsigned short out = static_cast<unsigned short>((_1 << 6) | _2);
-            *(_output_buf++) = out;
-            ++total;
-            _input += 2;
-            continue;
-        }
-        else if( sz == 3 ) {
-            const uint16_t _1 = _input[0] & 0x0F;
-            const uint16_t _2 = _input[1] & 0x3F;
-            const uint16_t _3 = _input[2] & 0x3F;
-            const unsigned short out = static_cast<unsigned short>((_1 << 12) | (_2 << 6) | _3);
-            *(_output_buf++) = out;
-            ++total;
-            _input += 3;
-            continue;
-        }
-        else if( sz == 4 ) {
-            uint32_t out;
-            const uint32_t _1 = _input[0] & 0x07;
-            const uint32_t _2 = _input[1] & 0x3F;
-            const uint32_t _3 = _input[2] & 0x3F;
-            const uint32_t _4 = _input[3] & 0x3F;
-            out = (_1 << 18) | (_2 << 12) | (_3 << 6) | _4;
-            if( out < 0x10000 ) { // possibly malformed UTF8 (?)
-                *(_output_buf++) = uint16_t(out);
-                total += 1;
+void InterpretUTF8BufferAsUTF16(const uint8_t *_input,
+                                size_t _input_size,
+                                uint16_t *_output_buf, // should be at least _input_size 16b words long
+                                size_t *_output_sz,    // size of an output
+                                uint16_t _bad_symb     // something like '?' or U+FFFD
+)
+{
+    const unsigned char *const end = _input + _input_size;
+    const uint16_t *const output_start = _output_buf;
+
+    while( _input < end ) {
+        if( static_cast<size_t>(end - _input) >= g_BlockSize ) {
+            const size_t ascii = ASCIIPrefixLength(_input);
+            if( ascii != 0 ) {
+                // the output never runs ahead of the input, so the whole block can be written
+                WidenBlock(_input, _output_buf);
+                _input += ascii;
+                _output_buf += ascii;
+                if( ascii == g_BlockSize )
+                    continue;
             }
-            else {
-                const uint16_t ls = static_cast<unsigned short>(0xD800 + ((out - 0x010000) >> 10));
-                const uint16_t ts = static_cast<unsigned short>(0xDC00 + ((out - 0x010000) & 0x3FF));
-                *(_output_buf++) = ls;
-                *(_output_buf++) = ts;
-                total += 2;
+            else if( IsTwoByteSequencesBlock(_input) ) {
+                DecodeTwoByteSequencesBlock(_input, _output_buf);
+                _input += g_BlockSize;
+                _output_buf += g_BlockSize / 2;
+                continue;
             }
-            _input += 4;
-            continue;
         }
-        else
-            assert(0);
-    goon:;
+        StepUTF8AsUTF16(_input, end, _output_buf, _bad_symb);
     }
 
-    *_output_sz = total;
+    *_output_sz = static_cast<size_t>(_output_buf - output_start);
 }
 
 void InterpretUTF8BufferAsIndexedUTF16(const unsigned char *_input,
@@ -1192,144 +1502,40 @@ void InterpretUTF8BufferAsIndexedUTF16(const unsigned char *_input,
                                        unsigned short _bad_symb     // something like '?' or U+FFFD
 )
 {
-    const unsigned char *end = _input + _input_size, *start = _input;
-
-    size_t total = 0;
+    const unsigned char *const start = _input;
+    const unsigned char *const end = _input + _input_size;
+    const unsigned short *const output_start = _output_buf;
 
     while( _input < end ) {
-        unsigned char current = *_input;
-
-        int sz = 0;
-
-        // get symbol size in bytes
-        if( (current & 0x80) == 0 )
-            sz = 1; // single-byte
-        else if( (current & 0xE0) == 0xC0 )
-            sz = 2; // two-byte
-        else if( (current & 0xF0) == 0xE0 )
-            sz = 3; // three-byte
-        else if( (current & 0xF8) == 0xF0 )
-            sz = 4; // four-byte
-        else {
-            // malformed!
-
-            // skip current character and move further
-            *_output_buf = _bad_symb;
-            *_indexes_buf = static_cast<uint32_t>(_input - start);
-            ++_indexes_buf;
-            ++_input;
-            ++_output_buf;
-            ++total;
-            continue;
-        }
-
-        if( sz == 1 ) {
-            // just out current symbol
-            *_output_buf = current;
-            *_indexes_buf = static_cast<uint32_t>(_input - start);
-            ++_indexes_buf;
-            ++_input;
-            ++_output_buf;
-            ++total;
-
-            continue;
-        }
-
-        // try to extract a sequence
-
-        for( int i = 1; i < sz; ++i ) {
-            // check for an unexpected end of buffer
-            if( _input + i == end ) {
-                // just fill output as bad
-                for( int z = 0; z < i; ++z ) {
-                    *_output_buf = _bad_symb;
-                    *_indexes_buf = static_cast<uint32_t>(_input - start);
-                    ++_indexes_buf;
-                    ++_input;
-                    ++_output_buf;
-                    ++total;
-                }
-                goto goon;
-            }
-
-            current = *(_input + i);
-
-            // check for malformed sequence
-            if( (current & 0xC0) != 0x80 ) {
-                // bad, bad sequence!
-
-                // skip the heading character and move further
-                *_output_buf = _bad_symb;
-                *_indexes_buf = static_cast<uint32_t>(_input - start);
-                ++_indexes_buf;
-                ++_input;
-                ++_output_buf;
-                ++total;
-                goto goon;
-            }
-        }
-
-        // seems that sequence is ok
-        if( sz == 2 ) {
-            const unsigned short high = *_input;
-            const unsigned short low = *(_input + 1);
-            const unsigned short out = static_cast<unsigned short>((((high & 0x1F)) << 6) | (low & 0x3F));
-
-            *_output_buf = out;
-            *_indexes_buf = static_cast<uint32_t>(_input - start);
-            ++_indexes_buf;
-            ++_output_buf;
-            ++total;
-            _input += 2;
-            continue;
-        }
-        else if( sz == 3 ) {
-            const unsigned short _1 = *_input;
-            const unsigned short _2 = *(_input + 1);
-            const unsigned short _3 = *(_input + 2);
-            const unsigned short out =
-                static_cast<unsigned short>((((_1 & 0xF)) << 12) | (((_2 & 0x3F)) << 6) | (_3 & 0x3F));
-            *_output_buf = out;
-            *_indexes_buf = static_cast<uint32_t>(_input - start);
-            ++_indexes_buf;
-            ++_output_buf;
-            ++total;
-            _input += 3;
-            continue;
-        }
-        else if( sz == 4 ) {
-            const uint32_t _1 = _input[0] & 0x07;
-            const uint32_t _2 = _input[1] & 0x3F;
-            const uint32_t _3 = _input[2] & 0x3F;
-            const uint32_t _4 = _input[3] & 0x3F;
-            const uint32_t out = (_1 << 18) | (_2 << 12) | (_3 << 6) | _4;
-            if( out < 0x10000 || // possibly malformed UTF8 (?)
-                (out >= 0x30000U && out < 0xE0000U) ) {
-                *(_output_buf++) = _bad_symb;
-                *(_indexes_buf++) = static_cast<uint32_t>(_input - start);
-                total += 1;
+        if( static_cast<size_t>(end - _input) >= g_BlockSize ) {
+            const size_t ascii = ASCIIPrefixLength(_input);
+            if( ascii != 0 ) {
+                // the output never runs ahead of the input, so the whole block can be written
+                WidenBlock(_input, _output_buf);
+                const uint32_t index = static_cast<uint32_t>(_input - start);
+                for( size_t i = 0; i < ascii; ++i )
+                    _indexes_buf[i] = index + static_cast<uint32_t>(i);
+                _input += ascii;
+                _output_buf += ascii;
+                _indexes_buf += ascii;
+                if( ascii == g_BlockSize )
+                    continue;
             }
-            else {
-                const uint16_t ls = static_cast<unsigned short>(0xD800 + ((out - 0x010000) >> 10));
-                const uint16_t ts = static_cast<unsigned short>(0xDC00 + ((out - 0x010000) & 0x3FF));
-                *(_output_buf++) = ls;
-                *(_output_buf++) = ts;
-                *(_indexes_buf++) = static_cast<uint32_t>(_input - start); // lead and trailing surrpairs chars will
-                                                                           // point at same byte position
-                *(_indexes_buf++) = static_cast<uint32_t>(_input - start);
-                total += 2;
+            else if( IsTwoByteSequencesBlock(_input) ) {
+                DecodeTwoByteSequencesBlock(_input, _output_buf);
+                const uint32_t index = static_cast<uint32_t>(_input - start);
+                for( size_t i = 0; i < g_BlockSize / 2; ++i )
+                    _indexes_buf[i] = index + static_cast<uint32_t>(2 * i);
+                _input += g_BlockSize;
+                _output_buf += g_BlockSize / 2;
+                _indexes_buf += g_BlockSize / 2;
+                continue;
             }
-
-            _input += 4;
-            continue;
         }
-        else
-            assert(0);
-    goon:;
+        StepUTF8AsIndexedUTF16(_input, start, end, _output_buf, _indexes_buf, _bad_symb);
     }
 
-    *_output_sz = total;
-    //    *_output_buf = 0;
+    *_output_sz = static_cast<size_t>(_output_buf - output_start);
 }
 
 void InterpretUTF16LEBufferAsUniChar(const unsigned char *_input,
@@ -1634,6 +1840,89 @@ void InterpretUnicodeAsUTF8(const uint32_t *_input,
         *_input_chars_eaten = cur - _input;
 }
 
+size_t ScanUTF8ForValidSequenceLength(const unsigned char *_input, size_t _input_size) noexcept
+{
+    if( _input == nullptr || _input_size == 0 )
+        return 0;
+
+    const unsigned char *const end = _input + _input_size;
+    const unsigned char *current = _input;
+    while( current < end ) {
+        if( static_cast<size_t>(end - current) >= g_BlockSize ) {
+            const size_t ascii = ASCIIPrefixLength(current);
+            current += ascii;
+            if( ascii == g_BlockSize )
+                continue;
+            if( ascii == 0 && IsTwoByteSequencesBlock(current) ) {
+                current += g_BlockSize;
+                continue;
+            }
+        }
+        const size_t length = ValidUTF8SequenceLength(current, end);
+        if( length == 0 )
+            break;
+        current += length;
+    }
+    return static_cast<size_t>(current - _input);
+}
+
+namespace scalar {
+
+void InterpretSingleByteBufferAsUniCharPreservingBufferSize(const unsigned char *_input,
+                                                            size_t _input_size,
+                                                            unsigned short *_output,
+                                                            Encoding _codepage)
+{
+    if( _codepage < Encoding::ENCODING_SINGLE_BYTES_FIRST__ || _codepage > Encoding::ENCODING_SINGLE_BYTES_LAST__ ) {
+        memset(_output, 0, sizeof(unsigned short) * _input_size);
+        return;
+    }
+
+    auto *t = g_SingleBytesTable[std::to_underlying(_codepage)];
+    const unsigned char *end = _input + _input_size;
+    while( _input < end )
+        *(_output++) = t[*(_input++)];
+}
+
+void InterpretUTF8BufferAsUniCharPreservingBufferSize(const unsigned char *_input,
+                                                      size_t _input_size,
+                                                      unsigned short *_output,
+                                                      unsigned short _stuffing_symb,
+                                                      unsigned short _bad_symb)
+{
+    const unsigned char *const end = _input + _input_size;
+    while( _input < end )
+        StepUTF8AsUniCharPreservingBufferSize(_input, end, _output, _stuffing_symb, _bad_symb);
+}
+
+void InterpretUTF8BufferAsUTF16(const uint8_t *_input,
+                                size_t _input_size,
+                                uint16_t *_output_buf,
+                                size_t *_output_sz,
+                                uint16_t _bad_symb)
+{
+    const unsigned char *const end = _input + _input_size;
+    const uint16_t *const output_start = _output_buf;
+    while( _input < end )
+        StepUTF8AsUTF16(_input, end, _output_buf, _bad_symb);
+    *_output_sz = static_cast<size_t>(_output_buf - output_start);
+}
+
+void InterpretUTF8BufferAsIndexedUTF16(const unsigned char *_input,
+                                       size_t _input_size,
+                                       unsigned short *_output_buf,
+                                       uint32_t *_indexes_buf,
+                                       size_t *_output_sz,
+                                       unsigned short _bad_symb)
+{
+    const unsigned char *const start = _input;
+    const unsigned char *const end = _input + _input_size;
+    const unsigned short *const output_start = _output_buf;
+    while( _input < end )
+        StepUTF8AsIndexedUTF16(_input, start, end, _output_buf, _indexes_buf, _bad_symb);
+    *_output_sz = static_cast<size_t>(_output_buf - output_start);
+}
+
 size_t ScanUTF8ForValidSequenceLength(const unsigned char *_input, size_t _input_size) noexcept
 {
     if( _input == nullptr || _input_size == 0 )
@@ -1682,4 +1971,6 @@ size_t ScanUTF8ForValidSequenceLength(const unsigned char *_input, size_t _input
     return static_cast<size_t>(length);
 }
 
+} // namespace scalar
+
 } // namespace nc::utility
@@ -0,0 +1,38 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <Utility/Encodings.h>
+
+// Straightforward byte-by-byte versions of the decoders from Encodings.h.
+// They produce the same output as the vectorized ones and are kept as a reference for testing.
+namespace nc::utility::scalar {
+
+size_t ScanUTF8ForValidSequenceLength(const unsigned char *_input, size_t _input_size) noexcept;
+
+void InterpretSingleByteBufferAsUniCharPreservingBufferSize(const unsigned char *_input,
+                                                            size_t _input_size,
+                                                            unsigned short *_output,
+                                                            Encoding _codepage);
+
+void InterpretUTF8BufferAsUniCharPreservingBufferSize(const unsigned char *_input,
+                                                      size_t _input_size,
+                                                      unsigned short *_output,
+                                                      unsigned short _stuffing_symb,
+                                                      unsigned short _bad_symb);
+
+void InterpretUTF8BufferAsUTF16(const uint8_t *_input,
+                                size_t _input_size,
+                                uint16_t *_output_buf,
+                                size_t *_output_sz,
+                                uint16_t _bad_symb);
+
+void InterpretUTF8BufferAsIndexedUTF16(const unsigned char *_input,
+                                       size_t _input_size,
+                                       unsigned short *_output_buf,
+                                       uint32_t *_indexes_buf,
+                                       size_t *_output_sz,
+                                       unsigned short _bad_symb);
+
+} // namespace nc::utility::scalar
@@ -0,0 +1,86 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include <AhoCorasick.h>
+#include "UnitTests_main.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using nc::utility::AhoCorasick;
+
+#define PREFIX "nc::utility::AhoCorasick "
+
+using Occurrences = std::vector<std::pair<size_t, size_t>>; // string, end
+
+static Occurrences FindAll(const AhoCorasick &_ac, std::u16string_view _text)
+{
+    Occurrences occurrences;
+    _ac.Feed(AhoCorasick::Root, _text, [&](size_t _string, size_t _end) {
+        occurrences.emplace_back(_string, _end);
+        return true;
+    });
+    std::sort(occurrences.begin(), occurrences.end(), [](auto &_lhs, auto &_rhs) {
+        return std::make_pair(_lhs.second, _lhs.first) < std::make_pair(_rhs.second, _rhs.first);
+    });
+    return occurrences;
+}
+
+TEST_CASE(PREFIX "Finds overlapping strings")
+{
+    const std::u16string strings[] = {u"he", u"she", u"his", u"hers"};
+    const AhoCorasick ac(strings, true);
+    CHECK(ac.StringsCount() == 4);
+    CHECK(ac.MaximumStringLength() == 4);
+    CHECK(FindAll(ac, u"ushers") == Occurrences{{0, 4}, {1, 4}, {3, 6}});
+    CHECK(FindAll(ac, u"ahishers") == Occurrences{{2, 4}, {0, 6}, {1, 6}, {3, 8}});
+    CHECK(FindAll(ac, u"nothing").empty());
+    CHECK(FindAll(ac, u"").empty());
+}
+
+TEST_CASE(PREFIX "Case sensitivity")
+{
+    const std::u16string strings[] = {u"Hello", u"ПРИВЕТ"};
+    const AhoCorasick sensitive(strings, true);
+    const AhoCorasick insensitive(strings, false);
+    CHECK(FindAll(sensitive, u"hello, привет").empty());
+    CHECK(FindAll(sensitive, u"Hello, ПРИВЕТ") == Occurrences{{0, 5}, {1, 13}});
+    CHECK(FindAll(insensitive, u"hello, привет") == Occurrences{{0, 5}, {1, 13}});
+    CHECK(FindAll(insensitive, u"HeLLo, ПрИвЕт") == Occurrences{{0, 5}, {1, 13}});
+}
+
+TEST_CASE(PREFIX "Carries the state between pieces")
+{
+    const std::u16string strings[] = {u"abcd", u"cde"};
+    const AhoCorasick ac(strings, true);
+    const std::u16string_view text = u"xxabcdexx";
+    for( size_t split = 0; split <= text.size(); ++split ) {
+        Occurrences occurrences;
+        auto state = AhoCorasick::Root;
+        size_t base = 0;
+        for( const auto piece : {text.substr(0, split), text.substr(split)} ) {
+            state = ac.Feed(state, piece, [&](size_t _string, size_t _end) {
+                occurrences.emplace_back(_string, base + _end);
+                return true;
+            });
+            base += piece.size();
+        }
+        CHECK(occurrences == Occurrences{{0, 6}, {1, 7}});
+    }
+}
+
+TEST_CASE(PREFIX "Stops when asked to")
+{
+    const std::u16string strings[] = {u"a"};
+    const AhoCorasick ac(strings, true);
+    size_t calls = 0;
+    ac.Feed(AhoCorasick::Root, u"aaaa", [&](size_t, size_t) { return ++calls < 2; });
+    CHECK(calls == 2);
+}
+
+TEST_CASE(PREFIX "Empty and duplicate strings")
+{
+    const std::u16string strings[] = {u"", u"ab", u"ab"};
+    const AhoCorasick ac(strings, true);
+    CHECK(ac.StringsCount() == 3);
+    CHECK(ac.StringLength(0) == 0);
+    CHECK(FindAll(ac, u"ab") == Occurrences{{1, 2}, {2, 2}});
+}
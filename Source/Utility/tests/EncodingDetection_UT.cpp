@@ -0,0 +1,161 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include <EncodingDetection.h>
+#include "UnitTests_main.h"
+#include <string>
+#include <vector>
+
+using namespace nc::utility;
+using namespace std::literals;
+
+#define PREFIX "nc::utility::EncodingDetector "
+
+static std::span<const std::byte> Bytes(std::string_view _s)
+{
+    return {reinterpret_cast<const std::byte *>(_s.data()), _s.size()};
+}
+
+static std::string Repeat(std::string_view _s, size_t _times)
+{
+    std::string result;
+    for( size_t i = 0; i < _times; ++i )
+        result += _s;
+    return result;
+}
+
+static std::string Encode(std::u16string_view _s, Encoding _encoding)
+{
+    std::string result(_s.size(), '\0');
+    REQUIRE(InterpretUnicharsAsSingleByte(reinterpret_cast<const uint16_t *>(_s.data()),
+                                          _s.size(),
+                                          reinterpret_cast<unsigned char *>(result.data()),
+                                          _encoding));
+    return result;
+}
+
+static std::string ToUTF16(std::u16string_view _s, bool _le)
+{
+    std::string result;
+    for( const char16_t c : _s ) {
+        const char lo = static_cast<char>(c & 0xFF);
+        const char hi = static_cast<char>(c >> 8);
+        result += _le ? lo : hi;
+        result += _le ? hi : lo;
+    }
+    return result;
+}
+
+static EncodingDetector::Verdict Detect(std::string_view _data)
+{
+    EncodingDetector detector;
+    detector.Feed(0, Bytes(_data));
+    return detector.Conclude();
+}
+
+static const std::u16string g_Russian =
+    u"Съешь же ещё этих мягких французских булок, да выпей чаю. Широкая электрификация южных губерний даст мощный "
+    u"толчок подъёму сельского хозяйства.\n";
+
+static const std::u16string g_French =
+    u"Le cœur déçu mais l'âme plutôt naïve, Louÿs rêva de crapaüter en canoë au delà des îles, près du mälström où "
+    u"brûlent les novæ. Voilà l'été à Noël.\n";
+
+static const std::u16string g_Czech =
+    u"Příliš žluťoučký kůň úpěl ďábelské ódy. Hleď, toť přízračný kůň v mátožné póze šíleně úpí. Zvláště zákeřný "
+    u"učeň s ďolíčky běží podél zóny úlů.\n";
+
+TEST_CASE(PREFIX "Plain ASCII is a UTF-8 text")
+{
+    const auto verdict = Detect(Repeat("Hello, World!\r\n\tThe quick brown fox.\n", 100));
+    CHECK(verdict.is_binary == false);
+    REQUIRE(!verdict.candidates.empty());
+    CHECK(verdict.candidates.front().encoding == Encoding::ENCODING_UTF8);
+    CHECK(verdict.candidates.front().confidence == 1.);
+}
+
+TEST_CASE(PREFIX "Empty data")
+{
+    const auto verdict = EncodingDetector{}.Conclude();
+    CHECK(verdict.is_binary == false);
+    REQUIRE(verdict.candidates.size() == 1);
+    CHECK(verdict.candidates.front().encoding == Encoding::ENCODING_UTF8);
+}
+
+TEST_CASE(PREFIX "Binary data")
+{
+    std::string data;
+    for( int i = 0; i < 10'000; ++i )
+        data += static_cast<char>((i * 7919) % 251);
+    CHECK(Detect(data).is_binary);
+    CHECK(Detect(Repeat("text", 1000) + std::string(100, '\0')).is_binary);
+}
+
+TEST_CASE(PREFIX "UTF-8")
+{
+    const std::u16string utf16 = g_Russian + g_French;
+    std::string text(utf16.size() * 3 + 1, '\0');
+    size_t size = 0;
+    InterpretUnicharsAsUTF8(reinterpret_cast<const uint16_t *>(utf16.data()),
+                            utf16.size(),
+                            reinterpret_cast<unsigned char *>(text.data()),
+                            text.size(),
+                            size,
+                            nullptr);
+    text.resize(size);
+    const auto verdict = Detect(Repeat(text, 20));
+    CHECK(verdict.is_binary == false);
+    CHECK(verdict.candidates.front().encoding == Encoding::ENCODING_UTF8);
+    CHECK(verdict.candidates.front().confidence == 1.);
+}
+
+TEST_CASE(PREFIX "UTF-8 samples which cut sequences")
+{
+    const std::string text = reinterpret_cast<const char *>(u8"Привет, мир! ");
+    EncodingDetector detector;
+    const std::string data = Repeat(text, 100);
+    detector.Feed(1, Bytes(std::string_view(data).substr(1, 100)));
+    detector.Feed(501, Bytes(std::string_view(data).substr(501, 701)));
+    const auto verdict = detector.Conclude();
+    CHECK(verdict.candidates.front().encoding == Encoding::ENCODING_UTF8);
+    CHECK(verdict.candidates.front().confidence == 1.);
+}
+
+TEST_CASE(PREFIX "UTF-16")
+{
+    for( const bool le : {true, false} ) {
+        const auto verdict = Detect(ToUTF16(g_Russian + g_French, le));
+        CHECK(verdict.is_binary == false);
+        CHECK(verdict.candidates.front().encoding == (le ? Encoding::ENCODING_UTF16LE : Encoding::ENCODING_UTF16BE));
+        CHECK(verdict.candidates.front().confidence > 0.5);
+    }
+    CHECK(Detect(ToUTF16(u"Hello, World!", true)).candidates.front().encoding == Encoding::ENCODING_UTF16LE);
+}
+
+TEST_CASE(PREFIX "Byte order marks")
+{
+    CHECK(Detect("\xFF\xFEH\0i\0"sv).candidates.front().encoding == Encoding::ENCODING_UTF16LE);
+    CHECK(Detect("\xFE\xFF\0H\0i"sv).candidates.front().encoding == Encoding::ENCODING_UTF16BE);
+    CHECK(Detect("\xEF\xBB\xBFHi"sv).candidates.front().encoding == Encoding::ENCODING_UTF8);
+}
+
+TEST_CASE(PREFIX "Single-byte codepages")
+{
+    struct TC {
+        const std::u16string &text;
+        Encoding encoding;
+    } const tcs[] = {
+        {g_Russian, Encoding::ENCODING_WIN1251},
+        {g_Russian, Encoding::ENCODING_OEM866},
+        {g_Russian, Encoding::ENCODING_ISO_8859_5},
+        {g_French, Encoding::ENCODING_WIN1252},
+        {g_French, Encoding::ENCODING_MACOS_ROMAN_WESTERN},
+        {g_Czech, Encoding::ENCODING_WIN1250},
+        {g_Czech, Encoding::ENCODING_ISO_8859_2},
+    };
+    for( const auto &tc : tcs ) {
+        INFO(NameFromEncoding(tc.encoding));
+        const auto verdict = Detect(Repeat(Encode(tc.text, tc.encoding), 10));
+        CHECK(verdict.is_binary == false);
+        CHECK(verdict.candidates.front().encoding == tc.encoding);
+        CHECK(verdict.candidates.front().confidence > verdict.candidates.at(1).confidence);
+    }
+}
@@ -0,0 +1,125 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "UnitTests_main.h"
+#include "Encodings.h"
+#include "../source/EncodingsScalar.h"
+#include <random>
+#include <string>
+#include <vector>
+
+// NB! disable by default, include in the UtilityUT to enable
+
+#define PREFIX "Encodings PT "
+
+using namespace nc::utility;
+
+// Builds ~16MB of text made of random words from the given alphabet, separated by spaces and newlines.
+static std::string MakeText(const std::vector<std::string> &_alphabet)
+{
+    const size_t size = 16 * 1024 * 1024;
+    std::mt19937 rng(42);
+    std::string text;
+    text.reserve(size + 64);
+    while( text.size() < size ) {
+        const size_t word = 2 + rng() % 8;
+        for( size_t i = 0; i < word; ++i )
+            text += _alphabet[rng() % _alphabet.size()];
+        text += rng() % 10 ? ' ' : '\n';
+    }
+    text.resize(size);
+    return text;
+}
+
+static void Benchmark(const std::string &_text)
+{
+    const auto input = reinterpret_cast<const unsigned char *>(_text.data());
+    const size_t size = _text.size();
+    std::vector<uint16_t> output(size);
+    std::vector<uint32_t> indices(size);
+    size_t output_sz = 0;
+
+    BENCHMARK("InterpretUTF8BufferAsUniCharPreservingBufferSize")
+    {
+        InterpretUTF8BufferAsUniCharPreservingBufferSize(input, size, output.data(), ' ', 0xFFFD);
+        return output.back();
+    };
+    BENCHMARK("scalar::InterpretUTF8BufferAsUniCharPreservingBufferSize")
+    {
+        scalar::InterpretUTF8BufferAsUniCharPreservingBufferSize(input, size, output.data(), ' ', 0xFFFD);
+        return output.back();
+    };
+    BENCHMARK("InterpretUTF8BufferAsUTF16")
+    {
+        InterpretUTF8BufferAsUTF16(input, size, output.data(), &output_sz, 0xFFFD);
+        return output_sz;
+    };
+    BENCHMARK("scalar::InterpretUTF8BufferAsUTF16")
+    {
+        scalar::InterpretUTF8BufferAsUTF16(input, size, output.data(), &output_sz, 0xFFFD);
+        return output_sz;
+    };
+    BENCHMARK("InterpretUTF8BufferAsIndexedUTF16")
+    {
+        InterpretUTF8BufferAsIndexedUTF16(input, size, output.data(), indices.data(), &output_sz, 0xFFFD);
+        return output_sz;
+    };
+    BENCHMARK("scalar::InterpretUTF8BufferAsIndexedUTF16")
+    {
+        scalar::InterpretUTF8BufferAsIndexedUTF16(input, size, output.data(), indices.data(), &output_sz, 0xFFFD);
+        return output_sz;
+    };
+    BENCHMARK("ScanUTF8ForValidSequenceLength")
+    {
+        return ScanUTF8ForValidSequenceLength(input, size);
+    };
+    BENCHMARK("scalar::ScanUTF8ForValidSequenceLength")
+    {
+        return scalar::ScanUTF8ForValidSequenceLength(input, size);
+    };
+}
+
+TEST_CASE(PREFIX "Decoding of 16MB of Latin text", "[!benchmark]")
+{
+    std::vector<std::string> alphabet;
+    for( char c = 'a'; c <= 'z'; ++c )
+        alphabet.emplace_back(1, c);
+    Benchmark(MakeText(alphabet));
+}
+
+TEST_CASE(PREFIX "Decoding of 16MB of Cyrillic text", "[!benchmark]")
+{
+    const std::vector<std::string> alphabet = {"а", "б", "в", "г", "д", "е", "ж", "з", "и", "к", "л",
+                                               "м", "н", "о", "п", "р", "с", "т", "у", "ф", "х", "я"};
+    Benchmark(MakeText(alphabet));
+}
+
+TEST_CASE(PREFIX "Decoding of 16MB of CJK text with some emojis", "[!benchmark]")
+{
+    const std::vector<std::string> alphabet = {"北", "京", "市", "東", "京", "都", "大", "阪", "😁", "🙀"};
+    Benchmark(MakeText(alphabet));
+}
+
+TEST_CASE(PREFIX "Decoding of 16MB of WIN1251 text", "[!benchmark]")
+{
+    std::vector<std::string> alphabet;
+    for( unsigned char c = 0xE0; c != 0; ++c ) // а..я
+        alphabet.emplace_back(1, static_cast<char>(c));
+    for( char c = 'a'; c <= 'z'; ++c )
+        alphabet.emplace_back(1, c);
+    const std::string text = MakeText(alphabet);
+    const auto input = reinterpret_cast<const unsigned char *>(text.data());
+    std::vector<uint16_t> output(text.size());
+
+    BENCHMARK("InterpretSingleByteBufferAsUniCharPreservingBufferSize")
+    {
+        InterpretSingleByteBufferAsUniCharPreservingBufferSize(
+            input, text.size(), output.data(), Encoding::ENCODING_WIN1251);
+        return output.back();
+    };
+    BENCHMARK("scalar::InterpretSingleByteBufferAsUniCharPreservingBufferSize")
+    {
+        scalar::InterpretSingleByteBufferAsUniCharPreservingBufferSize(
+            input, text.size(), output.data(), Encoding::ENCODING_WIN1251);
+        return output.back();
+    };
+}
@@ -1,6 +1,8 @@
 // Copyright (C) 2014-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "UnitTests_main.h"
 #include "Encodings.h"
+#include "../source/EncodingsScalar.h"
+#include <random>
 #include <string_view>
 
 #define PREFIX "Encodings "
@@ -97,3 +99,147 @@ TEST_CASE(PREFIX "ScanUTF8ForValidSequenceLength")
     CHECK(len("\xf0\x9f\x99z") == 0);
     CHECK(len("x\xf0\x9f\x99z") == 1);
 }
+
+TEST_CASE(PREFIX "ScanUTF8ForValidSequenceLength on long buffers")
+{
+    const std::string ascii(100, 'a');
+    const std::string cyrillic = reinterpret_cast<const char *>(u8"ПриветПриветПриветПривет");
+    auto len = [](const std::string &s) {
+        return nc::utility::ScanUTF8ForValidSequenceLength(reinterpret_cast<const unsigned char *>(s.data()), s.size());
+    };
+    CHECK(len(ascii) == 100);
+    CHECK(len(cyrillic) == cyrillic.size());
+    CHECK(len(ascii + cyrillic + ascii) == 200 + cyrillic.size());
+    CHECK(len(ascii + "\xff" + ascii) == 100);
+    CHECK(len(cyrillic + "\xd0") == cyrillic.size());
+    CHECK(len(cyrillic.substr(1) + ascii) == 0);
+}
+
+// Feeds the decoders with random mixtures of valid and malformed sequences and compares the results with the
+// byte-by-byte reference implementations.
+TEST_CASE(PREFIX "UTF8 decoders produce the same output as the scalar versions")
+{
+    using namespace nc::utility;
+    const std::vector<std::vector<unsigned char>> pieces = {
+        {'a'},                    // ASCII
+        {0x0A},                   // control character
+        {0xD0, 0xBF},             // п
+        {0xE2, 0x82, 0xAC},       // €
+        {0xF0, 0x9F, 0x98, 0x81}, // 😁
+        {0xF4, 0x8F, 0xBF, 0xBF}, // U+10FFFF
+        {0xF0, 0x80, 0x80, 0x80}, // overlong
+        {0xE0, 0x80},             // truncated
+        {0x80},                   // stray continuation
+        {0xC0},                   // lonely leading byte
+        {0xFF}                    // never valid
+    };
+    std::mt19937 rng(42);
+    for( int iteration = 0; iteration < 20000; ++iteration ) {
+        // favor ASCII and two-byte sequences to exercise the vectorized paths, sometimes use pure noise
+        const int mode = iteration % 4;
+        const size_t size = rng() % 256;
+        std::vector<unsigned char> input;
+        while( input.size() < size ) {
+            if( mode == 0 ) {
+                input.push_back(static_cast<unsigned char>(rng()));
+                continue;
+            }
+            const size_t usual = mode == 1 ? 0 : 2;
+            const size_t piece = rng() % 16 ? usual : rng() % pieces.size();
+            input.insert(input.end(), pieces[piece].begin(), pieces[piece].end());
+        }
+        input.resize(size); // possibly cut the last sequence
+
+        std::vector<uint16_t> out(size), out_ref(size);
+        std::vector<uint32_t> idx(size), idx_ref(size);
+        size_t out_sz = 0, out_ref_sz = 0;
+
+        InterpretUTF8BufferAsUniCharPreservingBufferSize(input.data(), size, out.data(), '>', '?');
+        scalar::InterpretUTF8BufferAsUniCharPreservingBufferSize(input.data(), size, out_ref.data(), '>', '?');
+        REQUIRE(out == out_ref);
+
+        InterpretUTF8BufferAsUTF16(input.data(), size, out.data(), &out_sz, 0xFFFD);
+        scalar::InterpretUTF8BufferAsUTF16(input.data(), size, out_ref.data(), &out_ref_sz, 0xFFFD);
+        REQUIRE(out_sz == out_ref_sz);
+        REQUIRE(std::equal(out.begin(), out.begin() + out_sz, out_ref.begin()));
+
+        InterpretUTF8BufferAsIndexedUTF16(input.data(), size, out.data(), idx.data(), &out_sz, 0xFFFD);
+        scalar::InterpretUTF8BufferAsIndexedUTF16(
+            input.data(), size, out_ref.data(), idx_ref.data(), &out_ref_sz, 0xFFFD);
+        REQUIRE(out_sz == out_ref_sz);
+        REQUIRE(std::equal(out.begin(), out.begin() + out_sz, out_ref.begin()));
+        REQUIRE(std::equal(idx.begin(), idx.begin() + out_sz, idx_ref.begin()));
+
+        REQUIRE(ScanUTF8ForValidSequenceLength(input.data(), size) ==
+                scalar::ScanUTF8ForValidSequenceLength(input.data(), size));
+    }
+}
+
+TEST_CASE(PREFIX "Single-byte decoding produces the same output as the scalar version")
+{
+    using namespace nc::utility;
+    std::mt19937 rng(42);
+    for( auto e = std::to_underlying(Encoding::ENCODING_SINGLE_BYTES_FIRST__);
+         e <= std::to_underlying(Encoding::ENCODING_SINGLE_BYTES_LAST__);
+         ++e ) {
+        const auto encoding = static_cast<Encoding>(e);
+        for( int iteration = 0; iteration < 100; ++iteration ) {
+            // mostly ASCII with some of the upper half, or noise
+            const size_t size = rng() % 300;
+            std::vector<unsigned char> input(size);
+            for( auto &c : input )
+                c = static_cast<unsigned char>(iteration % 2 && rng() % 32 ? rng() % 128 : rng());
+
+            std::vector<uint16_t> out(size), out_ref(size);
+            InterpretSingleByteBufferAsUniCharPreservingBufferSize(input.data(), size, out.data(), encoding);
+            scalar::InterpretSingleByteBufferAsUniCharPreservingBufferSize(
+                input.data(), size, out_ref.data(), encoding);
+            REQUIRE(out == out_ref);
+        }
+    }
+}
+
+TEST_CASE(PREFIX "InterpretUnicharsAsSingleByte")
+{
+    using namespace nc::utility;
+    const std::u16string privet = u"привет, world";
+    std::vector<unsigned char> out(privet.size());
+    const auto input = reinterpret_cast<const uint16_t *>(privet.data());
+    SECTION("WIN1251")
+    {
+        REQUIRE(InterpretUnicharsAsSingleByte(input, privet.size(), out.data(), Encoding::ENCODING_WIN1251));
+        CHECK(out == std::vector<unsigned char>{
+                         0xEF, 0xF0, 0xE8, 0xE2, 0xE5, 0xF2, ',', ' ', 'w', 'o', 'r', 'l', 'd'});
+    }
+    SECTION("OEM866")
+    {
+        REQUIRE(InterpretUnicharsAsSingleByte(input, privet.size(), out.data(), Encoding::ENCODING_OEM866));
+        CHECK(out == std::vector<unsigned char>{
+                         0xAF, 0xE0, 0xA8, 0xA2, 0xA5, 0xE2, ',', ' ', 'w', 'o', 'r', 'l', 'd'});
+    }
+    SECTION("Unrepresentable")
+    {
+        CHECK(!InterpretUnicharsAsSingleByte(input, privet.size(), out.data(), Encoding::ENCODING_WIN1252));
+        CHECK(!InterpretUnicharsAsSingleByte(input, privet.size(), out.data(), Encoding::ENCODING_UTF8));
+    }
+    SECTION("Round trip")
+    {
+        for( auto e = std::to_underlying(Encoding::ENCODING_SINGLE_BYTES_FIRST__);
+             e <= std::to_underlying(Encoding::ENCODING_SINGLE_BYTES_LAST__);
+             ++e ) {
+            const auto encoding = static_cast<Encoding>(e);
+            std::vector<unsigned char> bytes(256);
+            for( int i = 0; i < 256; ++i )
+                bytes[i] = static_cast<unsigned char>(i);
+            std::vector<uint16_t> decoded(256);
+            InterpretSingleByteBufferAsUniCharPreservingBufferSize(bytes.data(), 256, decoded.data(), encoding);
+            for( int i = 0; i < 256; ++i ) {
+                unsigned char encoded = 0;
+                const bool ambiguous = std::count(decoded.begin(), decoded.end(), decoded[i]) > 1;
+                CHECK(InterpretUnicharsAsSingleByte(&decoded[i], 1, &encoded, encoding) == !ambiguous);
+                if( !ambiguous )
+                    CHECK(encoded == i);
+            }
+        }
+    }
+}
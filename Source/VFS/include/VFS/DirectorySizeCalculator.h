@@ -0,0 +1,47 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <VFS/VFS.h>
+
+#include <functional>
+#include <span>
+#include <string>
+
+namespace nc::vfs {
+
+/**
+ * Calculates the sizes of multiple directories at once, e.g. of a selection in a panel.
+ * The directories of the same host are traversed together by a bounded number of blocks running in a dispatch group:
+ * each block takes the pending directories one level at a time via Host::CalculateDirectoryLevelSize() and puts their
+ * subdirectories into the host's shared queue, from which any block can pick them up. This way a single huge directory
+ * is traversed by all blocks instead of one. Different hosts are traversed independently of each other.
+ * The size of each directory is reported as soon as its whole subtree is processed.
+ * Is thread agnostic, but the same calculator should not be used by several threads at the same time.
+ */
+class DirectorySizeCalculator
+{
+public:
+    struct Directory {
+        VFSHostPtr host;
+        std::string path;
+    };
+
+    // Called once per each directory from the background threads, possibly concurrently.
+    // _size is either the calculated size or a negative VFSError if the directory itself can't be read.
+    using Callback = std::function<void(size_t _index, ssize_t _size)>;
+
+    static constexpr size_t DefaultConcurrencyPerHost = 4;
+
+    DirectorySizeCalculator(size_t _concurrency_per_host = DefaultConcurrencyPerHost);
+
+    // Blocks until all directories are calculated or the calculation is cancelled. In the latter case the sizes of the
+    // directories which haven't been calculated yet are not reported.
+    void Calculate(std::span<const Directory> _directories,
+                   const Callback &_callback,
+                   const VFSCancelChecker &_cancel_checker = {}) const;
+
+private:
+    size_t m_ConcurrencyPerHost;
+};
+
+} // namespace nc::vfs
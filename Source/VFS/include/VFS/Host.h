@@ -8,6 +8,7 @@
 #include "VFSFactory.h"
 #include "../../source/Listing.h"
 #include <string_view>
+#include <span>
 
 namespace nc::vfs {
 
@@ -63,6 +64,37 @@ struct HostFeatures {
     };
 };
 
+/**
+ * A set of attribute changes of a single item, applied by Host::SetAttributes().
+ * The changes are applied in the order of declaration, absent members are left intact.
+ */
+struct AttributesChange {
+    struct Ownership {
+        unsigned uid = 0;
+        unsigned gid = 0;
+    };
+    std::string path;
+    std::optional<uint16_t> permissions;
+    std::optional<Ownership> ownership;
+    std::optional<uint32_t> flags;
+    std::optional<time_t> btime;
+    std::optional<time_t> mtime;
+    std::optional<time_t> ctime;
+    std::optional<time_t> atime;
+};
+
+struct AttributesChangeResult {
+    enum class Step : unsigned char {
+        None = 0,
+        Permissions = 1,
+        Ownership = 2,
+        Flags = 3,
+        Times = 4
+    };
+    Step failed = Step::None; // the first step which failed, the rest of the item was not processed
+    int error = VFSError::Ok;
+};
+
 class Host : public std::enable_shared_from_this<Host>
 {
 public:
@@ -204,6 +236,19 @@ public:
 
     virtual ssize_t CalculateDirectorySize(std::string_view _path, const VFSCancelChecker &_cancel_checker = nullptr);
 
+    /**
+     * Returns the total size of the non-directory entries directly inside _path and reports the filenames of its
+     * subdirectories via _subdirectory. This is a building block for traversals which visit the directories in
+     * parallel, e.g. DirectorySizeCalculator.
+     * The default implementation uses FetchDirectoryListing() and resorts to Stat() only for the symlinks and for the
+     * entries which come without a size.
+     * Returns a negative VFSError on failure.
+     */
+    virtual ssize_t
+    CalculateDirectoryLevelSize(std::string_view _path,
+                                const std::function<void(std::string_view _subdirectory)> &_subdirectory,
+                                const VFSCancelChecker &_cancel_checker = nullptr);
+
     virtual bool ShouldProduceThumbnails() const;
 
     virtual int FetchUsers(std::vector<VFSUser> &_target, const VFSCancelChecker &_cancel_checker = nullptr);
@@ -317,6 +362,16 @@ public:
                              unsigned _gid,
                              const VFSCancelChecker &_cancel_checker = nullptr);
 
+    /**
+     * Applies a batch of attribute changes, _results must have the same size as _changes.
+     * A failure of an individual item is reported via its result and doesn't stop processing of the batch.
+     * Returns VFSError::Cancelled if the batch was interrupted, the results of unprocessed items are left intact.
+     * Default implementation calls SetPermissions(), SetOwnership(), SetFlags() and SetTimes() for each item.
+     */
+    virtual int SetAttributes(std::span<const AttributesChange> _changes,
+                              std::span<AttributesChangeResult> _results,
+                              const VFSCancelChecker &_cancel_checker = nullptr);
+
     /***********************************************************************************************
      * Observation of changes
      **********************************************************************************************/
@@ -0,0 +1,84 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <VFS/FileWindow.h>
+#include <VFS/SearchInFile.h>
+#include <Utility/AhoCorasick.h>
+#include <Utility/Encodings.h>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace nc::vfs {
+
+/**
+ * Looks for several texts at once in a VFS file accessible through a FileWindow object, reading the file only once
+ * regardless of how many texts there are.
+ * Can be reused for many files, but is thread agnostic.
+ */
+class MultiSearchInFile
+{
+public:
+    using Response = SearchInFile::Response;
+    using Options = SearchInFile::Options;
+    using Location = SearchInFile::Location;
+    using CancelChecker = SearchInFile::CancelChecker;
+
+    enum class Composition {
+        Any, // the search is over once any of the texts is found
+        All  // the search goes on until all of the texts are found
+    };
+
+    struct Result {
+        // Found if the composition is satisfied, NotFound otherwise
+        Response response;
+
+        // The first occurrence of each of the texts, in the same order as the texts
+        std::vector<std::optional<Location>> locations;
+    };
+
+    // _texts are utf8-encoded, empty texts are ignored.
+    MultiSearchInFile(std::span<const std::string> _texts, Options _options);
+
+    size_t TextsCount() const noexcept;
+
+    // Searches from the beginning of the file, the contents are interpreted in _encoding.
+    // Responds with Invalid if there's no non-empty texts to look for.
+    Result Search(FileWindow &_file,
+                  utility::Encoding _encoding,
+                  Composition _composition,
+                  const CancelChecker &_checker = {});
+
+private:
+    MultiSearchInFile(const MultiSearchInFile &) = delete;
+    void operator=(const MultiSearchInFile &) = delete;
+
+    struct Unit {
+        uint64_t offset;
+        uint16_t character;
+    };
+
+    // the indices below address the tail followed by the decoded window
+    bool IsWholePhrase(size_t _start, size_t _end) const;
+    uint64_t UnitOffset(size_t _index, uint64_t _file_size) const;
+    void Remember(size_t _fed);
+
+    utility::AhoCorasick m_Automaton;
+    Options m_Options;
+    size_t m_NonEmptyTexts = 0;
+
+    // the current window decoded into UTF-16
+    std::unique_ptr<uint16_t[]> m_Decoded;
+    std::unique_ptr<uint32_t[]> m_DecodedIndx;
+    size_t m_DecodedSize = 0;
+    size_t m_DecodedCapacity = 0;
+    uint64_t m_DecodedPos = 0; // the file offset of the first decoded character
+
+    // the last characters fed before the current window, required to locate the occurrences which start in the
+    // previous windows and to tell where the words begin
+    std::vector<Unit> m_Tail;
+};
+
+} // namespace nc::vfs
@@ -0,0 +1,5 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include "../../source/Native/DirectorySizeCache.h"
+#include "../../source/Native/DirectorySizeCacheObserver.h"
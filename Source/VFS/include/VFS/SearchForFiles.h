@@ -7,12 +7,18 @@
 #include <VFS/VFS.h>
 
 #include <functional>
+#include <memory>
+#include <span>
 #include <string>
 #include <queue>
+#include <vector>
 #include <stdint.h>
 
 namespace nc::vfs {
 
+class FileWindow;
+class MultiSearchInFile;
+
 class SearchForFiles
 {
 public:
@@ -26,7 +32,16 @@ public:
     };
 
     struct FilterContent {
+        enum class Mode {
+            Text,  // 'text' is a plain text
+            Regex, // 'text' is a RE2 regular expression
+            Hex,   // 'text' is a hexadecimal byte pattern like "DE AD ?? EF", 'encoding' and the flags are ignored
+            Texts  // 'texts' are plain texts looked for in a single pass over a file, 'text' is ignored
+        };
         std::string text; // utf8-encoded
+        Mode mode = Mode::Text;
+        std::vector<std::string> texts; // utf8-encoded
+        bool all_texts = false;         // a file should contain all of the 'texts' rather than any of them
         utility::Encoding encoding = utility::Encoding::ENCODING_UTF8;
         bool whole_phrase = false; // search for a phrase, not a part of something
         bool case_sensitive = false;
@@ -38,9 +53,14 @@ public:
         uint64_t max = std::numeric_limits<uint64_t>::max();
     };
 
-    // _content_found used to pass info where requested content was found, or {-1,0} if not used
-    using FoundCallback =
-        std::function<void(const char *_filename, const char *_in_path, VFSHost &_in_host, CFRange _content_found)>;
+    // _content_found used to pass info where requested content was found, or {-1,0} if not used.
+    // _texts_found is used with FilterContent::Mode::Texts to pass where each of the texts was found first, in the
+    // same order as the texts, {-1,0} for those which were not found. It's empty otherwise.
+    using FoundCallback = std::function<void(const char *_filename,
+                                             const char *_in_path,
+                                             VFSHost &_in_host,
+                                             CFRange _content_found,
+                                             std::span<const CFRange> _texts_found)>;
 
     using SpawnArchiveCallback = std::function<VFSHostPtr(const char *_for_path, VFSHost &_in_host)>;
 
@@ -109,15 +129,18 @@ private:
                            const char *_dir_path,
                            const VFSDirEnt &_dirent,
                            VFSHost &_in_host,
-                           CFRange _cont_range);
+                           CFRange _cont_range,
+                           std::span<const CFRange> _texts_ranges);
 
     void NotifyLookingIn(const char *_path, VFSHost &_in_host) const;
-    bool FilterByContent(const char *_full_path, VFSHost &_in_host, CFRange &_r);
+    bool FilterByContent(const char *_full_path, VFSHost &_in_host, CFRange &_r, std::vector<CFRange> &_texts_r);
+    bool FilterByTexts(FileWindow &_fw, utility::Encoding _encoding, CFRange &_r, std::vector<CFRange> &_texts_r);
     bool FilterByFilename(const char *_filename) const;
 
     base::SerialQueue m_Queue;
     utility::FileMask m_FilterName;
     std::optional<FilterContent> m_FilterContent;
+    std::unique_ptr<MultiSearchInFile> m_MultiSearch; // built for FilterContent::Mode::Texts
     std::optional<FilterSize> m_FilterSize;
 
     FoundCallback m_Callback;
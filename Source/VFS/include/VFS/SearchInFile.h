@@ -6,14 +6,21 @@
 #include <memory>
 #include <functional>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 #include <VFS/FileWindow.h>
 #include <Utility/Encodings.h>
 
+namespace re2 {
+class RE2;
+}
+
 namespace nc::vfs {
 
 /**
- * Provides a *stateful* searching facilty to find text in VFS file accessible through
- * a FileWindow object.
+ * Provides a *stateful* searching facilty to find text, regular expressions or byte patterns in VFS file accessible
+ * through a FileWindow object.
  * Is thread agnostic.
  */
 class SearchInFile
@@ -33,6 +40,24 @@ public:
         std::optional<Location> location;
     };
 
+    // A sequence of bytes to look for, each of which can be fully or partially a wildcard.
+    struct BytesPattern {
+        std::vector<std::byte> bytes; // the bits which are not in the mask must be zero
+        std::vector<std::byte> mask;  // the bits to compare, 0x00 for the wildcard bytes
+
+        // Parses pairs of hexadecimal digits, e.g. "DE AD ?? EF" or "4?0A", where '?' is a wildcard nibble.
+        // Whitespace is ignored. Returns nullopt if the string is malformed or empty.
+        static std::optional<BytesPattern> FromHex(std::string_view _hex);
+    };
+
+    // Regular expressions are matched within a window of this many bytes after the start of a match, longer matches
+    // can be cut short.
+    static constexpr size_t MaximumRegexMatchLength = 8192;
+
+    // The amount of bytes before the search position which regular expressions can look at, e.g. to tell whether the
+    // position is at the beginning of a line or of a word.
+    static constexpr size_t RegexLookbehind = 256;
+
     // will not own _file, caller need to close it after work
     // assumes that _file is in exclusive use in SearchInFile - that no one else will alter it
     SearchInFile(nc::vfs::FileWindow &_file);
@@ -49,6 +74,14 @@ public:
     CFStringRef TextSearchString();         // may be NULL. don't alter it. don't release it
     utility::Encoding TextSearchEncoding(); // may be ENCODING_INVALID
 
+    // _pattern is an utf8-encoded RE2 expression, the file contents are interpreted in _encoding.
+    // The search will respond with Invalid if the expression can't be compiled.
+    // Case sensitivity and whole phrase options are respected.
+    void ToggleRegexSearch(std::string_view _pattern, utility::Encoding _encoding);
+
+    // Searches for raw bytes, the search options are ignored.
+    void ToggleBytesSearch(const BytesPattern &_pattern);
+
     using CancelChecker = std::function<bool()>;
     Result Search(const CancelChecker &_checker = {});
 
@@ -57,11 +90,15 @@ private:
     void operator=(const SearchInFile &); // forbid
 
     Response SearchText(uint64_t *_offset, uint64_t *_bytes_len, CancelChecker _checker);
+    Response SearchRegex(uint64_t *_offset, uint64_t *_bytes_len, const CancelChecker &_checker);
+    Response SearchBytes(uint64_t *_offset, uint64_t *_bytes_len, const CancelChecker &_checker);
+    std::string_view RegexHaystack();
 
     enum class WorkMode {
         NotSet,
-        Text
-        /* binary(hex) and regexp(tempates) later */
+        Text,
+        Regex,
+        Bytes
     };
 
     nc::vfs::FileWindow &m_File;
@@ -83,12 +120,31 @@ private:
     CFStringRef m_RequestedTextSearch = nullptr;
     utility::Encoding m_TextSearchEncoding;
 
+    // the requested text converted into a single-byte encoding, empty if not applicable.
+    // case-sensitive searches in such encodings don't need to decode the file contents at all.
+    std::vector<unsigned char> m_EncodedTextSearch;
+
     std::unique_ptr<uint16_t[]> m_DecodedBuffer;
     std::unique_ptr<uint32_t[]> m_DecodedBufferIndx;
 
     size_t m_DecodedBufferSize = 0;
     CFStringRef m_DecodedBufferString = nullptr;
 
+    // regex search related stuff
+    std::string m_RegexPattern;
+    utility::Encoding m_RegexEncoding = utility::Encoding::ENCODING_INVALID;
+    std::unique_ptr<re2::RE2> m_Regex; // compiled lazily since the options can be changed after the toggling
+    Options m_RegexOptions = static_cast<Options>(0);
+
+    // the contents of the window transcoded into UTF-8 for non-UTF-8 encodings,
+    // along with the offset in the window of each byte, plus the end offset.
+    // the indices are empty when the window is searched as-is.
+    std::string m_TranscodedBuffer;
+    std::vector<uint32_t> m_TranscodedBufferIndx;
+
+    // bytes search related stuff
+    BytesPattern m_BytesPattern;
+
     WorkMode m_WorkMode = WorkMode::NotSet;
 };
 
@@ -0,0 +1,248 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <Base/UnorderedUtil.h>
+#include <Base/mach_time.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace nc::vfs {
+
+/**
+ * DirectoryCache is a thread-safe path -> directory contents map shared by the network VFS hosts.
+ * Directories are published as immutable snapshots: readers get a shared_ptr to a snapshot and can use it without any
+ * locking, while writers replace the snapshot with an updated copy. The map is split into shards with individual locks
+ * so that lookups of different directories from different threads don't contend.
+ * The cache is bounded by a total cost of the directories, the least recently used ones are evicted first.
+ * Directories older than the time-to-live are not returned by Find() and have to be fetched again.
+ */
+template <class T>
+class DirectoryCache
+{
+public:
+    // Returns an approximate memory footprint of a directory, e.g. the number of its entries.
+    using CostFunction = std::function<size_t(const T &_directory)>;
+
+    DirectoryCache(std::chrono::nanoseconds _ttl, size_t _max_cost, CostFunction _cost);
+
+    // Returns the snapshot of the directory at _path or nullptr if it's not in the cache or outdated.
+    std::shared_ptr<const T> Find(std::string_view _path) const;
+
+    // Places a freshly fetched directory, replacing any existing one.
+    void Insert(std::string_view _path, std::shared_ptr<const T> _directory);
+
+    // Publishes a modified copy of the directory at _path, if any, which keeps the original fetch time.
+    // _modify is called under the shard lock and must not access the cache.
+    // Returns true if the directory was in the cache.
+    bool Update(std::string_view _path, const std::function<void(T &_directory)> &_modify);
+
+    // Returns true if the directory was in the cache.
+    bool Erase(std::string_view _path);
+
+    // Moves the directory at _from to _to, replacing any existing one. Returns true if the directory was in the cache.
+    bool Move(std::string_view _from, std::string_view _to);
+
+    void Clear();
+
+    // Total cost of the directories currently stored.
+    size_t Cost() const noexcept;
+
+private:
+    static constexpr size_t ShardsCount = 16;
+
+    struct Node {
+        std::shared_ptr<const T> directory;
+        std::chrono::nanoseconds fetch_time;
+        size_t cost;
+        mutable uint64_t last_access;
+    };
+
+    using MapT = ankerl::unordered_dense::map<std::string, Node, UnorderedStringHashEqual, UnorderedStringHashEqual>;
+
+    struct alignas(64) Shard {
+        MapT nodes;
+        size_t cost = 0;
+        mutable std::mutex lock;
+    };
+
+    Shard &ShardFor(std::string_view _path) noexcept;
+    const Shard &ShardFor(std::string_view _path) const noexcept;
+    void Place(Shard &_shard, std::string_view _path, Node _node);
+    void EvictExcess(Shard &_shard);
+    uint64_t Tick() const noexcept;
+
+    std::chrono::nanoseconds m_TTL;
+    size_t m_MaxShardCost;
+    CostFunction m_Cost;
+    std::array<Shard, ShardsCount> m_Shards;
+    mutable std::atomic_uint64_t m_Clock{0};
+};
+
+template <class T>
+DirectoryCache<T>::DirectoryCache(std::chrono::nanoseconds _ttl, size_t _max_cost, CostFunction _cost)
+    : m_TTL(_ttl), m_MaxShardCost(std::max(_max_cost / ShardsCount, size_t(1))), m_Cost(std::move(_cost))
+{
+}
+
+template <class T>
+typename DirectoryCache<T>::Shard &DirectoryCache<T>::ShardFor(std::string_view _path) noexcept
+{
+    return m_Shards[UnorderedStringHashEqual{}(_path) % ShardsCount];
+}
+
+template <class T>
+const typename DirectoryCache<T>::Shard &DirectoryCache<T>::ShardFor(std::string_view _path) const noexcept
+{
+    return m_Shards[UnorderedStringHashEqual{}(_path) % ShardsCount];
+}
+
+template <class T>
+uint64_t DirectoryCache<T>::Tick() const noexcept
+{
+    return m_Clock.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <class T>
+std::shared_ptr<const T> DirectoryCache<T>::Find(std::string_view _path) const
+{
+    const auto now = base::machtime();
+    const auto &shard = ShardFor(_path);
+    const auto lock = std::lock_guard{shard.lock};
+    const auto it = shard.nodes.find(_path);
+    if( it == shard.nodes.end() )
+        return nullptr;
+    if( it->second.fetch_time + m_TTL < now )
+        return nullptr;
+    it->second.last_access = Tick();
+    return it->second.directory;
+}
+
+template <class T>
+void DirectoryCache<T>::Insert(std::string_view _path, std::shared_ptr<const T> _directory)
+{
+    if( !_directory )
+        return;
+    Node node;
+    node.cost = m_Cost(*_directory);
+    node.directory = std::move(_directory);
+    node.fetch_time = base::machtime();
+    node.last_access = Tick();
+
+    auto &shard = ShardFor(_path);
+    const auto lock = std::lock_guard{shard.lock};
+    Place(shard, _path, std::move(node));
+}
+
+template <class T>
+bool DirectoryCache<T>::Update(std::string_view _path, const std::function<void(T &_directory)> &_modify)
+{
+    auto &shard = ShardFor(_path);
+    const auto lock = std::lock_guard{shard.lock};
+    const auto it = shard.nodes.find(_path);
+    if( it == shard.nodes.end() )
+        return false;
+
+    auto copy = std::make_shared<T>(*it->second.directory);
+    _modify(*copy);
+    const size_t cost = m_Cost(*copy);
+    shard.cost = shard.cost - it->second.cost + cost;
+    it->second.cost = cost;
+    it->second.directory = std::move(copy);
+    it->second.last_access = Tick();
+    EvictExcess(shard);
+    return true;
+}
+
+template <class T>
+bool DirectoryCache<T>::Erase(std::string_view _path)
+{
+    auto &shard = ShardFor(_path);
+    const auto lock = std::lock_guard{shard.lock};
+    const auto it = shard.nodes.find(_path);
+    if( it == shard.nodes.end() )
+        return false;
+    shard.cost -= it->second.cost;
+    shard.nodes.erase(it);
+    return true;
+}
+
+template <class T>
+bool DirectoryCache<T>::Move(std::string_view _from, std::string_view _to)
+{
+    std::optional<Node> node;
+    {
+        auto &shard = ShardFor(_from);
+        const auto lock = std::lock_guard{shard.lock};
+        const auto it = shard.nodes.find(_from);
+        if( it == shard.nodes.end() )
+            return false;
+        shard.cost -= it->second.cost;
+        node = std::move(it->second);
+        shard.nodes.erase(it);
+    }
+    // the directory is briefly absent which is no different from being evicted
+    auto &shard = ShardFor(_to);
+    const auto lock = std::lock_guard{shard.lock};
+    Place(shard, _to, std::move(*node));
+    return true;
+}
+
+template <class T>
+void DirectoryCache<T>::Clear()
+{
+    for( auto &shard : m_Shards ) {
+        const auto lock = std::lock_guard{shard.lock};
+        shard.nodes.clear();
+        shard.cost = 0;
+    }
+}
+
+template <class T>
+size_t DirectoryCache<T>::Cost() const noexcept
+{
+    size_t cost = 0;
+    for( auto &shard : m_Shards ) {
+        const auto lock = std::lock_guard{shard.lock};
+        cost += shard.cost;
+    }
+    return cost;
+}
+
+template <class T>
+void DirectoryCache<T>::Place(Shard &_shard, std::string_view _path, Node _node)
+{
+    _shard.cost += _node.cost;
+    if( auto it = _shard.nodes.find(_path); it != _shard.nodes.end() ) {
+        _shard.cost -= it->second.cost;
+        it->second = std::move(_node);
+    }
+    else {
+        _shard.nodes.emplace(std::string(_path), std::move(_node));
+    }
+    EvictExcess(_shard);
+}
+
+template <class T>
+void DirectoryCache<T>::EvictExcess(Shard &_shard)
+{
+    // the shards are small enough for a linear search of the least recently used directory to be cheaper than
+    // maintaining a list ordered by access. the most recent directory is never evicted, even if it alone is too large.
+    while( _shard.cost > m_MaxShardCost && _shard.nodes.size() > 1 ) {
+        auto lru = _shard.nodes.begin();
+        for( auto it = std::next(lru); it != _shard.nodes.end(); ++it )
+            if( it->second.last_access < lru->second.last_access )
+                lru = it;
+        _shard.cost -= lru->second.cost;
+        _shard.nodes.erase(lru);
+    }
+}
+
+} // namespace nc::vfs
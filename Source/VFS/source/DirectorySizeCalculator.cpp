@@ -0,0 +1,165 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "../include/VFS/DirectorySizeCalculator.h"
+#include <Base/DispatchGroup.h>
+#include <Base/DispatchStack.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace nc::vfs {
+
+namespace {
+
+struct Root {
+    size_t index = 0;              // in the calculation's input
+    std::atomic_int64_t size{0};   // accumulated so far
+    std::atomic_size_t pending{1}; // directories of this subtree which are not processed yet
+    int error = VFSError::Ok;      // set only when the root directory itself can't be read
+};
+
+struct Task {
+    Root *root = nullptr;
+    std::string path;
+    bool is_root = false;
+};
+
+// Traverses the directories of a single host with a bounded number of blocks running in the dispatch group.
+class Traversal
+{
+public:
+    Traversal(Host &_host,
+              size_t _concurrency,
+              const base::DispatchGroup &_group,
+              const DirectorySizeCalculator::Callback &_callback,
+              const VFSCancelChecker &_cancel_checker);
+
+    void Start(std::span<Root *const> _roots, std::span<const std::string_view> _paths);
+
+private:
+    void Process(const Task &_task);
+
+    Host &m_Host;
+    const DirectorySizeCalculator::Callback &m_Callback;
+    const VFSCancelChecker &m_CancelChecker;
+    base::DispatchStack<Task> m_Tasks; // the pending directories, processed depth-first, stopped on cancellation
+};
+
+} // namespace
+
+static std::string JoinPath(std::string_view _directory, std::string_view _filename)
+{
+    std::string path;
+    path.reserve(_directory.length() + _filename.length() + 1);
+    path += _directory;
+    if( path.empty() || path.back() != '/' )
+        path += '/';
+    path += _filename;
+    return path;
+}
+
+Traversal::Traversal(Host &_host,
+                     size_t _concurrency,
+                     const base::DispatchGroup &_group,
+                     const DirectorySizeCalculator::Callback &_callback,
+                     const VFSCancelChecker &_cancel_checker)
+    : m_Host(_host), m_Callback(_callback), m_CancelChecker(_cancel_checker),
+      m_Tasks(_group, _concurrency, [this](Task _task) {
+          if( m_CancelChecker && m_CancelChecker() )
+              m_Tasks.Stop();
+          else
+              Process(_task);
+      })
+{
+}
+
+void Traversal::Start(std::span<Root *const> _roots, std::span<const std::string_view> _paths)
+{
+    assert(_roots.size() == _paths.size());
+    std::vector<Task> tasks;
+    tasks.reserve(_roots.size());
+    // reversed, so the roots are picked up in their original order
+    for( size_t i = _roots.size(); i-- > 0; )
+        tasks.emplace_back(Task{_roots[i], std::string(_paths[i]), true});
+    m_Tasks.Push(tasks);
+}
+
+void Traversal::Process(const Task &_task)
+{
+    Root &root = *_task.root;
+    std::vector<Task> subdirectories;
+    const ssize_t size = m_Host.CalculateDirectoryLevelSize(
+        _task.path,
+        [&](std::string_view _subdirectory) {
+            ++root.pending;
+            subdirectories.emplace_back(Task{&root, JoinPath(_task.path, _subdirectory)});
+        },
+        m_CancelChecker);
+
+    if( size == VFSError::Cancelled ) {
+        m_Tasks.Stop();
+        return;
+    }
+
+    // the subdirectories are queued at once, the first one reported ends up on top to be processed next
+    std::ranges::reverse(subdirectories);
+    m_Tasks.Push(subdirectories);
+
+    if( size >= 0 )
+        root.size += size;
+    else if( _task.is_root )
+        root.error = static_cast<int>(size); // the failures deeper in the subtree are silently skipped
+
+    if( --root.pending == 0 && !m_Tasks.Stopped() )
+        m_Callback(root.index, root.error != VFSError::Ok ? root.error : root.size.load());
+}
+
+DirectorySizeCalculator::DirectorySizeCalculator(size_t _concurrency_per_host)
+    : m_ConcurrencyPerHost(std::max(_concurrency_per_host, size_t(1)))
+{
+}
+
+void DirectorySizeCalculator::Calculate(std::span<const Directory> _directories,
+                                        const Callback &_callback,
+                                        const VFSCancelChecker &_cancel_checker) const
+{
+    if( _directories.empty() || !_callback )
+        return;
+
+    const auto roots = std::make_unique<Root[]>(_directories.size());
+
+    // group the directories by their hosts, keeping the original order within each group
+    std::vector<Host *> hosts;
+    std::vector<std::vector<Root *>> host_roots;
+    std::vector<std::vector<std::string_view>> host_paths;
+    for( size_t i = 0; i != _directories.size(); ++i ) {
+        roots[i].index = i;
+        Host *const host = _directories[i].host.get();
+        if( host == nullptr ) {
+            _callback(i, VFSError::InvalidCall);
+            continue;
+        }
+        const auto it = std::ranges::find(hosts, host);
+        const size_t group = std::distance(hosts.begin(), it);
+        if( it == hosts.end() ) {
+            hosts.emplace_back(host);
+            host_roots.emplace_back();
+            host_paths.emplace_back();
+        }
+        host_roots[group].emplace_back(&roots[i]);
+        host_paths[group].emplace_back(_directories[i].path);
+    }
+
+    const base::DispatchGroup dispatch_group;
+    std::vector<std::unique_ptr<Traversal>> traversals;
+    for( size_t group = 0; group != hosts.size(); ++group ) {
+        traversals.emplace_back(
+            std::make_unique<Traversal>(*hosts[group], m_ConcurrencyPerHost, dispatch_group, _callback, _cancel_checker));
+        traversals.back()->Start(host_roots[group], host_paths[group]);
+    }
+    dispatch_group.Wait();
+}
+
+} // namespace nc::vfs
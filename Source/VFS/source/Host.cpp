@@ -202,23 +202,52 @@ ssize_t Host::CalculateDirectorySize(std::string_view _path, const VFSCancelChec
         if( _cancel_checker && _cancel_checker() ) // check if we need to quit
             return VFSError::Cancelled;
 
-        IterateDirectoryListing(look_paths.front().c_str(), [&](const VFSDirEnt &_dirent) {
-            std::filesystem::path full_path = look_paths.front() / _dirent.name;
-            if( _dirent.type == VFSDirEnt::Dir )
-                look_paths.emplace(std::move(full_path));
-            else {
-                VFSStat stat;
-                if( Stat(full_path.c_str(), stat, VFSFlags::F_NoFollow, nullptr) == 0 )
-                    total_size += stat.size;
-            }
-            return true;
-        });
+        const std::filesystem::path &directory = look_paths.front();
+        const ssize_t level_size = CalculateDirectoryLevelSize(
+            directory.native(),
+            [&](std::string_view _subdirectory) { look_paths.emplace(directory / _subdirectory); },
+            _cancel_checker);
+        if( level_size > 0 )
+            total_size += level_size;
         look_paths.pop();
     }
 
     return total_size;
 }
 
+ssize_t Host::CalculateDirectoryLevelSize(std::string_view _path,
+                                          const std::function<void(std::string_view _subdirectory)> &_subdirectory,
+                                          const VFSCancelChecker &_cancel_checker)
+{
+    VFSListingPtr listing;
+    const int rc = FetchDirectoryListing(_path, listing, VFSFlags::F_NoDotDot, _cancel_checker);
+    if( rc != VFSError::Ok )
+        return rc;
+
+    int64_t size = 0;
+    for( unsigned i = 0, e = listing->Count(); i != e; ++i ) {
+        if( listing->IsSymlink(i) ) {
+            // the listings can contain the sizes of the symlinks' targets
+            VFSStat stat;
+            if( Stat(listing->Path(i), stat, VFSFlags::F_NoFollow, nullptr) == 0 )
+                size += stat.size;
+        }
+        else if( listing->IsDir(i) ) {
+            if( _subdirectory )
+                _subdirectory(listing->Filename(i));
+        }
+        else if( listing->HasSize(i) ) {
+            size += listing->Size(i);
+        }
+        else {
+            VFSStat stat;
+            if( Stat(listing->Path(i), stat, VFSFlags::F_NoFollow, nullptr) == 0 )
+                size += stat.size;
+        }
+    }
+    return size;
+}
+
 bool Host::IsDirectoryChangeObservationAvailable([[maybe_unused]] std::string_view _path)
 {
     return false;
@@ -521,6 +550,52 @@ int Host::SetFlags([[maybe_unused]] std::string_view _path,
     return VFSError::NotSupported;
 }
 
+int Host::SetAttributes(std::span<const AttributesChange> _changes,
+                        std::span<AttributesChangeResult> _results,
+                        const VFSCancelChecker &_cancel_checker)
+{
+    if( _changes.size() != _results.size() )
+        return VFSError::InvalidCall;
+
+    using Step = AttributesChangeResult::Step;
+    for( size_t i = 0; i != _changes.size(); ++i ) {
+        if( _cancel_checker && _cancel_checker() )
+            return VFSError::Cancelled;
+
+        const AttributesChange &change = _changes[i];
+        AttributesChangeResult &result = _results[i];
+        result = {};
+        if( change.permissions ) {
+            const int rc = SetPermissions(change.path, *change.permissions, _cancel_checker);
+            if( rc != VFSError::Ok ) {
+                result = {Step::Permissions, rc};
+                continue;
+            }
+        }
+        if( change.ownership ) {
+            const int rc = SetOwnership(change.path, change.ownership->uid, change.ownership->gid, _cancel_checker);
+            if( rc != VFSError::Ok ) {
+                result = {Step::Ownership, rc};
+                continue;
+            }
+        }
+        if( change.flags ) {
+            const int rc = SetFlags(change.path, *change.flags, Flags::None, _cancel_checker);
+            if( rc != VFSError::Ok ) {
+                result = {Step::Flags, rc};
+                continue;
+            }
+        }
+        if( change.btime || change.mtime || change.ctime || change.atime ) {
+            const int rc =
+                SetTimes(change.path, change.btime, change.mtime, change.ctime, change.atime, _cancel_checker);
+            if( rc != VFSError::Ok )
+                result = {Step::Times, rc};
+        }
+    }
+    return VFSError::Ok;
+}
+
 void Host::SetFeatures(uint64_t _features_bitset)
 {
     m_Features = _features_bitset;
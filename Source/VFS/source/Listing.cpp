@@ -4,6 +4,7 @@
 #include "ListingInput.h"
 #include <sys/param.h>
 #include <Base/mach_time.h>
+#include <algorithm>
 
 namespace nc::vfs {
 
@@ -292,11 +293,127 @@ ListingInput Listing::Compose(const std::vector<base::intrusive_ptr<const Listin
     return result;
 }
 
+class Listing::CompositionBuilder
+{
+public:
+    CompositionBuilder(size_t _items_count);
+    void Add(const base::intrusive_ptr<const Listing> &_listing, unsigned _ind);
+    base::intrusive_ptr<const Listing> Build(std::string _title);
+
+private:
+    uint32_t Slot(const base::intrusive_ptr<const Listing> &_listing);
+
+    Composition m_Composition;
+    ankerl::unordered_dense::map<const Listing *, uint32_t> m_Slots;
+    size_t m_Count = 0;
+};
+
+Listing::CompositionBuilder::CompositionBuilder(size_t _items_count)
+{
+    if( _items_count > std::numeric_limits<unsigned>::max() )
+        throw std::invalid_argument("VFSListing::BuildComposite: too many items");
+    m_Composition.items = std::make_unique<Composition::Ref[]>(_items_count);
+}
+
+uint32_t Listing::CompositionBuilder::Slot(const base::intrusive_ptr<const Listing> &_listing)
+{
+    const auto [it, inserted] = m_Slots.emplace(_listing.get(), static_cast<uint32_t>(m_Composition.listings.size()));
+    if( inserted )
+        m_Composition.listings.emplace_back(_listing);
+    return it->second;
+}
+
+void Listing::CompositionBuilder::Add(const base::intrusive_ptr<const Listing> &_listing, unsigned _ind)
+{
+    if( _ind >= _listing->Count() )
+        throw std::invalid_argument("VFSListing::BuildComposite: invalid index");
+
+    if( const auto &composition = _listing->m_Composition ) {
+        // refer to the original item directly to keep a single level of indirection
+        const auto ref = composition->items[_ind];
+        m_Composition.items[m_Count++] = {Slot(composition->listings[ref.listing]), ref.index};
+    }
+    else {
+        m_Composition.items[m_Count++] = {Slot(_listing), _ind};
+    }
+}
+
+base::intrusive_ptr<const Listing> Listing::CompositionBuilder::Build(std::string _title)
+{
+    auto l = base::intrusive_ptr<Listing>{new Listing};
+    l->m_ItemsCount = static_cast<unsigned>(m_Count);
+    l->m_Title = std::move(_title);
+    l->m_CreationTime = time(nullptr);
+    l->m_CreationTicks = base::machtime();
+
+    // the same treatment as Compose() + Build() gives: a common host if all items share it, dense directories
+    const auto &listings = m_Composition.listings;
+    const bool common_host = !listings.empty() && std::ranges::all_of(listings, [&](auto &_listing) {
+        return _listing->HasCommonHost() && _listing->Host() == listings.front()->Host();
+    });
+    if( common_host )
+        l->m_Hosts = variable_container<VFSHostPtr>{listings.front()->Host()};
+    else
+        l->m_Hosts.reset(variable_container<>::type::dense);
+    l->m_Directories.reset(variable_container<>::type::dense);
+
+    l->m_Composition = std::make_unique<Composition>(std::move(m_Composition));
+    return l;
+}
+
+base::intrusive_ptr<const Listing>
+Listing::BuildComposite(const std::vector<base::intrusive_ptr<const Listing>> &_listings,
+                        const std::vector<std::vector<unsigned>> &_items_indeces,
+                        std::string _title)
+{
+    if( _items_indeces.empty() ) {
+        size_t count = 0;
+        for( auto &listing : _listings )
+            count += listing->Count();
+
+        CompositionBuilder builder(count);
+        for( auto &listing : _listings )
+            for( unsigned i = 0, e = listing->Count(); i != e; ++i )
+                builder.Add(listing, i);
+        return builder.Build(std::move(_title));
+    }
+
+    if( _listings.size() != _items_indeces.size() )
+        throw std::invalid_argument("VFSListing::BuildComposite input containers has different sizes");
+
+    size_t count = 0;
+    for( auto &indeces : _items_indeces )
+        count += indeces.size();
+
+    CompositionBuilder builder(count);
+    for( size_t l = 0, e = _listings.size(); l != e; ++l )
+        for( auto i : _items_indeces[l] )
+            builder.Add(_listings[l], i);
+
+    return builder.Build(std::move(_title));
+}
+
+static bool IsSameAsStat(const Listing &_listing, unsigned _ind, const VFSStat &_st) noexcept
+{
+    const auto same = [](bool _had, auto _old, bool _has, auto _new) {
+        return _had == _has && (!_has || _old == _new);
+    };
+    return same(_listing.HasSize(_ind), _listing.Size(_ind), _st.meaning.size, _st.size) &&
+           same(_listing.HasInode(_ind), _listing.Inode(_ind), _st.meaning.inode, _st.inode) &&
+           same(_listing.HasATime(_ind), _listing.ATime(_ind), _st.meaning.atime, _st.atime.tv_sec) &&
+           same(_listing.HasBTime(_ind), _listing.BTime(_ind), _st.meaning.btime, _st.btime.tv_sec) &&
+           same(_listing.HasCTime(_ind), _listing.CTime(_ind), _st.meaning.ctime, _st.ctime.tv_sec) &&
+           same(_listing.HasMTime(_ind), _listing.MTime(_ind), _st.meaning.mtime, _st.mtime.tv_sec) &&
+           same(_listing.HasUID(_ind), _listing.UID(_ind), _st.meaning.uid, _st.uid) &&
+           same(_listing.HasGID(_ind), _listing.GID(_ind), _st.meaning.gid, _st.gid) &&
+           same(_listing.HasUnixFlags(_ind), _listing.UnixFlags(_ind), _st.meaning.flags, _st.flags);
+}
+
 VFSListingPtr Listing::ProduceUpdatedTemporaryPanelListing(const Listing &_original, VFSCancelChecker _cancel_checker)
 {
+    // only the items whose stat data did change are copied, the rest are referred to in the original listing
     ListingInput result;
     unsigned count = 0;
-    result.title = _original.Title();
     result.hosts.reset(variable_container<>::type::dense);
     result.directories.reset(variable_container<>::type::dense);
     result.display_filenames.reset(variable_container<>::type::sparse);
@@ -311,6 +428,14 @@ VFSListingPtr Listing::ProduceUpdatedTemporaryPanelListing(const Listing &_origi
     result.unix_flags.reset(variable_container<>::type::sparse);
     result.symlinks.reset(variable_container<>::type::sparse);
 
+    // for each surviving item: its index in the original listing or, if it was updated, in the result
+    struct Survivor {
+        unsigned index;
+        bool updated;
+    };
+    std::vector<Survivor> survivors;
+    survivors.reserve(_original.Count());
+
     std::string path;
     for( unsigned i = 0, e = _original.Count(); i != e; ++i ) {
         if( _cancel_checker && _cancel_checker() )
@@ -322,6 +447,10 @@ VFSListingPtr Listing::ProduceUpdatedTemporaryPanelListing(const Listing &_origi
         VFSStat st;
         auto stat_flags = _original.IsSymlink(i) ? VFSFlags::F_NoFollow : 0;
         if( _original.Host(i)->Stat(path.c_str(), st, stat_flags, _cancel_checker) == 0 ) {
+            if( IsSameAsStat(_original, i, st) ) {
+                survivors.push_back({i, false});
+                continue;
+            }
 
             result.filenames.emplace_back(_original.Filename(i));
             result.unix_modes.emplace_back(_original.UnixMode(i));
@@ -354,6 +483,7 @@ VFSListingPtr Listing::ProduceUpdatedTemporaryPanelListing(const Listing &_origi
             if( _original.HasDisplayFilename(i) )
                 result.display_filenames.insert(count, _original.DisplayFilename(i));
 
+            survivors.push_back({count, true});
             count++;
         }
     }
@@ -361,7 +491,17 @@ VFSListingPtr Listing::ProduceUpdatedTemporaryPanelListing(const Listing &_origi
     if( _cancel_checker && _cancel_checker() )
         return nullptr;
 
-    return Build(std::move(result));
+    if( count == survivors.size() ) {
+        result.title = _original.Title();
+        return Build(std::move(result));
+    }
+
+    const auto original = base::intrusive_ptr{&_original};
+    const auto updated = Build(std::move(result));
+    CompositionBuilder builder(survivors.size());
+    for( const auto survivor : survivors )
+        builder.Add(survivor.updated ? updated : original, survivor.index);
+    return builder.Build(_original.Title());
 }
 
 const base::intrusive_ptr<const Listing> &Listing::EmptyListing() noexcept
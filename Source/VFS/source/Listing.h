@@ -45,6 +45,23 @@ public:
     static ListingInput Compose(const std::vector<base::intrusive_ptr<const Listing>> &_listings,
                                 const std::vector<std::vector<unsigned>> &_items_indeces);
 
+    /**
+     * compose many listings into a new listing which refers to the items of the original ones instead of copying
+     * them. takes all items of the listings or, if _items_indeces is not empty, only the specified ones.
+     * the original listings are kept alive by the composite one, composites of composites are flattened.
+     * pays off only when many items are taken from a few large listings - for the results of per-item fetches, e.g.
+     * single-item listings, Build(Compose()) is cheaper since it doesn't keep a listing alive per item.
+     * will throw on errors
+     */
+    static base::intrusive_ptr<const Listing>
+    BuildComposite(const std::vector<base::intrusive_ptr<const Listing>> &_listings,
+                   const std::vector<std::vector<unsigned>> &_items_indeces = {},
+                   std::string _title = {});
+
+    /**
+     * stats the items of the temporary panel listing again. the items which didn't change are referred to instead of
+     * being copied.
+     */
     static base::intrusive_ptr<const Listing> ProduceUpdatedTemporaryPanelListing(const Listing &_original,
                                                                                   VFSCancelChecker _cancel_checker);
 
@@ -54,6 +71,7 @@ public:
     unsigned Count() const noexcept;
     bool Empty() const noexcept;
     bool IsUniform() const noexcept;
+    bool IsComposite() const noexcept;
     bool HasCommonHost() const noexcept;
     bool HasCommonDirectory() const noexcept;
 
@@ -146,10 +164,21 @@ public:
     iterator end() const noexcept;
 
 private:
+    // Items of a composite listing are the items of other listings, referred to by indices
+    struct Composition {
+        struct Ref {
+            uint32_t listing;
+            uint32_t index;
+        };
+        std::vector<base::intrusive_ptr<const Listing>> listings;
+        std::unique_ptr<Ref[]> items;
+    };
+
     Listing();
     Listing(const Listing &) = delete;
     Listing &operator=(const Listing &) = delete;
     void BuildFilenames();
+    class CompositionBuilder;
 
     unsigned m_ItemsCount;
     time_t m_CreationTime;
@@ -176,6 +205,7 @@ private:
     base::variable_container<std::string> m_DisplayFilenames;
     base::variable_container<base::CFString> m_DisplayFilenamesCF;
     ankerl::unordered_dense::map<size_t, std::vector<utility::Tags::Tag>> m_Tags;
+    std::unique_ptr<Composition> m_Composition; // the per-item data above is empty if this is set
 
     // this is a copy of POSIX/BSD constants to reduce headers pollution
     inline constexpr static const mode_t m_S_IFMT = 0170000;
@@ -341,39 +371,51 @@ private:
     if( (a) >= m_ItemsCount ) [[unlikely]]                                                                             \
         throw std::out_of_range(std::string(__PRETTY_FUNCTION__) + ": index out of range");
 
+#define VFS_LISTING_FORWARD_COMPOSITE(a, method)                                                                       \
+    if( m_Composition ) {                                                                                              \
+        const auto ref = m_Composition->items[(a)];                                                                    \
+        return m_Composition->listings[ref.listing]->method(ref.index);                                                \
+    }
+
 inline bool Listing::HasExtension(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasExtension);
     return m_ExtensionOffsets[_ind] != 0;
 }
 
 inline uint16_t Listing::ExtensionOffset(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, ExtensionOffset);
     return m_ExtensionOffsets[_ind];
 }
 
 inline const char *Listing::Extension(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, Extension);
     return m_Filenames[_ind].c_str() + m_ExtensionOffsets[_ind];
 }
 
 inline const std::string &Listing::Filename(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, Filename);
     return m_Filenames[_ind];
 }
 
 inline CFStringRef Listing::FilenameCF(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, FilenameCF);
     return *m_FilenamesCF[_ind];
 }
 
 inline std::string Listing::Path(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, Path);
     if( !IsDotDot(_ind) )
         return m_Directories[_ind] + m_Filenames[_ind];
     else {
@@ -387,6 +429,7 @@ inline std::string Listing::Path(unsigned _ind) const
 inline std::string Listing::FilenameWithoutExt(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, FilenameWithoutExt);
     if( m_ExtensionOffsets[_ind] == 0 )
         return m_Filenames[_ind];
     return m_Filenames[_ind].substr(0, m_ExtensionOffsets[_ind] - 1);
@@ -405,6 +448,7 @@ inline const VFSHostPtr &Listing::Host(unsigned _ind) const
         return m_Hosts[0];
     else {
         VFS_LISTING_CHECK_BOUNDS(_ind);
+        VFS_LISTING_FORWARD_COMPOSITE(_ind, Host);
         return m_Hosts[_ind];
     }
 }
@@ -423,6 +467,7 @@ inline const std::string &Listing::Directory(unsigned _ind) const
     }
     else {
         VFS_LISTING_CHECK_BOUNDS(_ind);
+        VFS_LISTING_FORWARD_COMPOSITE(_ind, Directory);
         return m_Directories[_ind];
     }
 }
@@ -442,6 +487,11 @@ inline bool Listing::IsUniform() const noexcept
     return HasCommonHost() && HasCommonDirectory();
 }
 
+inline bool Listing::IsComposite() const noexcept
+{
+    return m_Composition != nullptr;
+}
+
 inline const std::string &Listing::Title() const noexcept
 {
     return m_Title;
@@ -460,138 +510,161 @@ inline bool Listing::HasCommonDirectory() const noexcept
 inline bool Listing::HasSize(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasSize);
     return m_Sizes.has(_ind);
 }
 
 inline uint64_t Listing::Size(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, Size);
     return m_Sizes.has(_ind) ? m_Sizes[_ind] : 0;
 }
 
 inline bool Listing::HasInode(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasInode);
     return m_Inodes.has(_ind);
 }
 
 inline uint64_t Listing::Inode(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, Inode);
     return m_Inodes.has(_ind) ? m_Inodes[_ind] : 0;
 }
 
 inline bool Listing::HasATime(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasATime);
     return m_ATimes.has(_ind);
 }
 
 inline time_t Listing::ATime(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, ATime);
     return m_ATimes.has(_ind) ? m_ATimes[_ind] : m_CreationTime;
 }
 
 inline bool Listing::HasMTime(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasMTime);
     return m_MTimes.has(_ind);
 }
 
 inline time_t Listing::MTime(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, MTime);
     return m_MTimes.has(_ind) ? m_MTimes[_ind] : m_CreationTime;
 }
 
 inline bool Listing::HasCTime(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasCTime);
     return m_CTimes.has(_ind);
 }
 
 inline time_t Listing::CTime(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, CTime);
     return m_CTimes.has(_ind) ? m_CTimes[_ind] : m_CreationTime;
 }
 
 inline bool Listing::HasBTime(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasBTime);
     return m_BTimes.has(_ind);
 }
 
 inline time_t Listing::BTime(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, BTime);
     return m_BTimes.has(_ind) ? m_BTimes[_ind] : m_CreationTime;
 }
 
 inline bool Listing::HasAddTime(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasAddTime);
     return m_AddTimes.has(_ind);
 }
 
 inline time_t Listing::AddTime(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, AddTime);
     return m_AddTimes.has(_ind) ? m_AddTimes[_ind] : BTime(_ind);
 }
 
 inline mode_t Listing::UnixMode(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, UnixMode);
     return m_UnixModes[_ind];
 }
 
 inline uint8_t Listing::UnixType(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, UnixType);
     return m_UnixTypes[_ind];
 }
 
 inline bool Listing::HasUID(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasUID);
     return m_UIDS.has(_ind);
 }
 
 inline uid_t Listing::UID(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, UID);
     return m_UIDS.has(_ind) ? m_UIDS[_ind] : 0;
 }
 
 inline bool Listing::HasGID(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasGID);
     return m_GIDS.has(_ind);
 }
 
 inline gid_t Listing::GID(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, GID);
     return m_GIDS.has(_ind) ? m_GIDS[_ind] : 0;
 }
 
 inline bool Listing::HasUnixFlags(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasUnixFlags);
     return m_UnixFlags.has(_ind);
 }
 
 inline uint32_t Listing::UnixFlags(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, UnixFlags);
     return m_UnixFlags.has(_ind) ? m_UnixFlags[_ind] : 0;
 }
 
 inline bool Listing::HasSymlink(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasSymlink);
     return m_Symlinks.has(_ind);
 }
 
@@ -599,18 +672,21 @@ inline const std::string &Listing::Symlink(unsigned _ind) const
 {
     [[clang::no_destroy]] static const std::string st = "";
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, Symlink);
     return m_Symlinks.has(_ind) ? m_Symlinks[_ind] : st;
 }
 
 inline bool Listing::HasTags(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasTags);
     return m_Tags.contains(_ind);
 }
 
 inline std::span<const utility::Tags::Tag> Listing::Tags(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, Tags);
     if( auto it = m_Tags.find(_ind); it != m_Tags.end() )
         return it->second;
     return {};
@@ -619,24 +695,28 @@ inline std::span<const utility::Tags::Tag> Listing::Tags(unsigned _ind) const
 inline bool Listing::HasDisplayFilename(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, HasDisplayFilename);
     return m_DisplayFilenames.has(_ind);
 }
 
 inline const std::string &Listing::DisplayFilename(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, DisplayFilename);
     return m_DisplayFilenames.has(_ind) ? m_DisplayFilenames[_ind] : Filename(_ind);
 }
 
 inline CFStringRef Listing::DisplayFilenameCF(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, DisplayFilenameCF);
     return m_DisplayFilenamesCF.has(_ind) ? *m_DisplayFilenamesCF[_ind] : FilenameCF(_ind);
 }
 
 inline bool Listing::IsDotDot(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, IsDotDot);
     auto &s = m_Filenames[_ind];
     return s[0] == '.' && s[1] == '.' && s[2] == 0;
 }
@@ -644,24 +724,28 @@ inline bool Listing::IsDotDot(unsigned _ind) const
 inline bool Listing::IsDir(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, IsDir);
     return (m_UnixModes[_ind] & m_S_IFMT) == m_S_IFDIR;
 }
 
 inline bool Listing::IsReg(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, IsReg);
     return (m_UnixModes[_ind] & m_S_IFMT) == m_S_IFREG;
 }
 
 inline bool Listing::IsSymlink(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, IsSymlink);
     return m_UnixTypes[_ind] == m_DT_LNK;
 }
 
 inline bool Listing::IsHidden(unsigned _ind) const
 {
     VFS_LISTING_CHECK_BOUNDS(_ind);
+    VFS_LISTING_FORWARD_COMPOSITE(_ind, IsHidden);
     return (Filename(_ind)[0] == '.' || (UnixFlags(_ind) & m_UF_HIDDEN)) && !IsDotDot(_ind);
 }
 
@@ -686,6 +770,7 @@ inline Listing::iterator Listing::end() const noexcept
 }
 
 #undef VFS_LISTING_CHECK_BOUNDS
+#undef VFS_LISTING_FORWARD_COMPOSITE
 
 inline ListingItem::ListingItem() noexcept : L(nullptr), I(std::numeric_limits<unsigned>::max())
 {
@@ -0,0 +1,161 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "MultiSearchInFile.h"
+#include <algorithm>
+#include <cassert>
+
+namespace nc::vfs {
+
+// the longest byte sequence which encodes a single character
+static constexpr size_t g_MaximumCharacterBytes = 4;
+
+static std::vector<std::u16string> ToUTF16(std::span<const std::string> _texts)
+{
+    std::vector<std::u16string> texts;
+    texts.reserve(_texts.size());
+    for( const auto &text : _texts ) {
+        std::u16string decoded(text.size(), 0);
+        size_t decoded_size = 0;
+        utility::InterpretAsUnichar(utility::Encoding::ENCODING_UTF8,
+                                    reinterpret_cast<const unsigned char *>(text.data()),
+                                    text.size(),
+                                    reinterpret_cast<uint16_t *>(decoded.data()),
+                                    nullptr,
+                                    &decoded_size);
+        decoded.resize(decoded_size);
+        texts.emplace_back(std::move(decoded));
+    }
+    return texts;
+}
+
+MultiSearchInFile::MultiSearchInFile(std::span<const std::string> _texts, Options _options)
+    : m_Automaton(ToUTF16(_texts), (_options & Options::CaseSensitive) != Options::None), m_Options(_options)
+{
+    for( size_t i = 0; i < m_Automaton.StringsCount(); ++i )
+        if( m_Automaton.StringLength(i) != 0 )
+            ++m_NonEmptyTexts;
+}
+
+size_t MultiSearchInFile::TextsCount() const noexcept
+{
+    return m_Automaton.StringsCount();
+}
+
+MultiSearchInFile::Result MultiSearchInFile::Search(FileWindow &_file,
+                                                    utility::Encoding _encoding,
+                                                    Composition _composition,
+                                                    const CancelChecker &_checker)
+{
+    Result result;
+    result.locations.resize(TextsCount());
+    if( m_NonEmptyTexts == 0 ) {
+        result.response = Response::Invalid;
+        return result;
+    }
+
+    const uint64_t file_size = _file.FileSize();
+    const size_t window_size = _file.WindowSize();
+    if( m_DecodedCapacity < window_size ) {
+        m_Decoded = std::make_unique<uint16_t[]>(window_size);
+        m_DecodedIndx = std::make_unique<uint32_t[]>(window_size);
+        m_DecodedCapacity = window_size;
+    }
+    m_DecodedSize = 0;
+    m_Tail.clear();
+
+    const bool whole_phrase = (m_Options & Options::FindWholePhrase) != Options::None;
+    size_t found = 0;
+    bool done = false;
+    auto state = utility::AhoCorasick::Root;
+    uint64_t position = 0;
+    while( position < file_size && !done ) {
+        if( _checker && _checker() ) {
+            result.response = Response::Canceled;
+            return result;
+        }
+
+        const uint64_t window_pos = std::min(position, file_size - window_size);
+        if( _file.MoveWindow(window_pos) != 0 ) {
+            result.response = Response::IOErr;
+            return result;
+        }
+        const size_t left_window_gap = position - window_pos;
+        const bool is_last = window_pos + window_size >= file_size;
+
+        utility::InterpretAsUnichar(_encoding,
+                                    static_cast<const unsigned char *>(_file.Window()) + left_window_gap,
+                                    window_size - left_window_gap,
+                                    m_Decoded.get(),
+                                    m_DecodedIndx.get(),
+                                    &m_DecodedSize);
+        m_DecodedPos = position;
+
+        // the characters at the window's end can be cut - leave them to the next window, which will start with them
+        size_t fed = m_DecodedSize;
+        if( !is_last ) {
+            const size_t limit = window_size - left_window_gap - g_MaximumCharacterBytes;
+            while( fed > 0 && m_DecodedIndx[fed - 1] >= limit )
+                --fed;
+            assert(fed > 0 && fed < m_DecodedSize);
+        }
+
+        const auto text = std::span<const char16_t>(reinterpret_cast<const char16_t *>(m_Decoded.get()), fed);
+        state = m_Automaton.Feed(state, text, [&](size_t _text, size_t _end) {
+            if( result.locations[_text] )
+                return true; // only the first occurrence is of interest
+            const size_t end = m_Tail.size() + _end;
+            const size_t start = end - m_Automaton.StringLength(_text);
+            if( whole_phrase && !IsWholePhrase(start, end) )
+                return true;
+            const uint64_t offset = UnitOffset(start, file_size);
+            result.locations[_text] = Location{.offset = offset, .bytes_len = UnitOffset(end, file_size) - offset};
+            ++found;
+            done = _composition == Composition::Any || found == m_NonEmptyTexts;
+            return !done;
+        });
+
+        if( is_last )
+            break;
+        Remember(fed);
+        position += m_DecodedIndx[fed];
+    }
+
+    const bool satisfied = _composition == Composition::Any ? found != 0 : found == m_NonEmptyTexts;
+    result.response = satisfied ? Response::Found : Response::NotFound;
+    return result;
+}
+
+uint64_t MultiSearchInFile::UnitOffset(size_t _index, uint64_t _file_size) const
+{
+    if( _index < m_Tail.size() )
+        return m_Tail[_index].offset;
+    _index -= m_Tail.size();
+    return _index < m_DecodedSize ? m_DecodedPos + m_DecodedIndx[_index] : _file_size;
+}
+
+bool MultiSearchInFile::IsWholePhrase(size_t _start, size_t _end) const
+{
+    static const auto alphanumeric = CFCharacterSetGetPredefined(kCFCharacterSetAlphaNumeric);
+    const auto character = [this](size_t _index) -> uint16_t {
+        return _index < m_Tail.size() ? m_Tail[_index].character : m_Decoded[_index - m_Tail.size()];
+    };
+
+    if( _start > 0 && CFCharacterSetIsCharacterMember(alphanumeric, character(_start - 1)) )
+        return false;
+
+    if( _end < m_Tail.size() + m_DecodedSize && CFCharacterSetIsCharacterMember(alphanumeric, character(_end)) )
+        return false;
+
+    return true;
+}
+
+void MultiSearchInFile::Remember(size_t _fed)
+{
+    // the longest text and a character before it
+    const size_t keep = m_Automaton.MaximumStringLength() + 1;
+    for( size_t i = _fed - std::min(_fed, keep); i < _fed; ++i )
+        m_Tail.push_back({m_DecodedPos + m_DecodedIndx[i], m_Decoded[i]});
+    if( m_Tail.size() > keep )
+        m_Tail.erase(m_Tail.begin(), m_Tail.end() - keep);
+}
+
+} // namespace nc::vfs
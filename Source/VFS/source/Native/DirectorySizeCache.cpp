@@ -0,0 +1,266 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "DirectorySizeCache.h"
+#include <Base/WriteAtomically.h>
+#include <VFS/Log.h>
+#include <fmt/std.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace nc::vfs::native {
+
+// the layout is a header followed by the directories, all integers are in the native byte order:
+// u64 signature, u64 last event id, u64 number of directories,
+// [ u32 path length, path, i64 mtime sec, i64 mtime nsec, u64 files size, u64 files count,
+//   u32 number of subdirectories, [ u32 filename length, filename ] ]
+static constexpr uint64_t g_Signature = 0x31'43'53'44'43'4E'00'00; // "\0\0NCDSC1"
+
+namespace {
+
+class Writer
+{
+public:
+    template <class T>
+    void Put(T _value)
+    {
+        const auto bytes = reinterpret_cast<const char *>(&_value);
+        m_Buffer.append(bytes, sizeof(T));
+    }
+
+    void Put(std::string_view _string)
+    {
+        Put(static_cast<uint32_t>(_string.size()));
+        m_Buffer.append(_string);
+    }
+
+    std::span<const std::byte> Bytes() const noexcept
+    {
+        return {reinterpret_cast<const std::byte *>(m_Buffer.data()), m_Buffer.size()};
+    }
+
+private:
+    std::string m_Buffer;
+};
+
+class Reader
+{
+public:
+    Reader(std::string_view _bytes) noexcept : m_Bytes(_bytes) {}
+
+    template <class T>
+    bool Get(T &_value) noexcept
+    {
+        if( m_Bytes.size() < sizeof(T) )
+            return false;
+        std::memcpy(&_value, m_Bytes.data(), sizeof(T));
+        m_Bytes.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    bool Get(std::string &_string)
+    {
+        uint32_t length = 0;
+        if( !Get(length) || m_Bytes.size() < length )
+            return false;
+        _string.assign(m_Bytes.data(), length);
+        m_Bytes.remove_prefix(length);
+        return true;
+    }
+
+    bool AtEnd() const noexcept { return m_Bytes.empty(); }
+
+private:
+    std::string_view m_Bytes;
+};
+
+} // namespace
+
+DirectorySizeCache::DirectorySizeCache(size_t _max_directories) : m_MaxDirectories(_max_directories)
+{
+}
+
+std::string DirectorySizeCache::Key(std::string_view _path)
+{
+    // directories are stored with a trailing slash so that the subtrees can be matched by a prefix
+    std::string key(_path);
+    if( key.empty() || key.back() != '/' )
+        key += '/';
+    return key;
+}
+
+std::optional<DirectorySizeCache::Directory> DirectorySizeCache::Find(std::string_view _path,
+                                                                      const Timestamp &_mtime) const
+{
+    const auto key = Key(_path);
+    const auto lock = std::lock_guard{m_Lock};
+    const auto it = m_Directories.find(key);
+    if( it == m_Directories.end() || it->second.mtime != _mtime )
+        return std::nullopt;
+    return it->second;
+}
+
+void DirectorySizeCache::Commit(std::string_view _path, Directory _directory, std::optional<uint64_t> _scanned_at)
+{
+    auto key = Key(_path);
+    const auto lock = std::lock_guard{m_Lock};
+    if( _scanned_at && InvalidatedSince(key, *_scanned_at) )
+        return;
+    if( auto it = m_Directories.find(key); it != m_Directories.end() )
+        it->second = std::move(_directory);
+    else if( m_Directories.size() < m_MaxDirectories )
+        m_Directories.emplace(std::move(key), std::move(_directory));
+}
+
+uint64_t DirectorySizeCache::Generation() const
+{
+    const auto lock = std::lock_guard{m_Lock};
+    return m_Generation;
+}
+
+void DirectorySizeCache::Bury(std::string _key, bool _recursive)
+{
+    m_Tombstones.push_back({++m_Generation, std::move(_key), _recursive});
+    if( m_Tombstones.size() > MaxTombstones )
+        m_Tombstones.pop_front();
+}
+
+bool DirectorySizeCache::InvalidatedSince(std::string_view _key, uint64_t _generation) const noexcept
+{
+    if( _generation >= m_Generation )
+        return false;
+    if( m_Tombstones.empty() || m_Tombstones.front().generation > _generation + 1 )
+        return true; // the invalidations made since then were already forgotten - can't tell, so assume the worst
+    for( auto it = m_Tombstones.rbegin(); it != m_Tombstones.rend() && it->generation > _generation; ++it )
+        if( it->recursive ? _key.starts_with(it->key) : _key == it->key )
+            return true;
+    return false;
+}
+
+void DirectorySizeCache::Invalidate(std::string_view _path)
+{
+    auto key = Key(_path);
+    const auto lock = std::lock_guard{m_Lock};
+    m_Directories.erase(key);
+    Bury(std::move(key), false);
+}
+
+void DirectorySizeCache::InvalidateRecursively(std::string_view _path)
+{
+    auto key = Key(_path);
+    const auto lock = std::lock_guard{m_Lock};
+    if( key == "/" ) {
+        m_Directories.clear();
+    }
+    else {
+        // the erasure of the map moves the last element into the erased slot, so the iteration goes backwards
+        auto &values = m_Directories.values();
+        for( size_t i = values.size(); i-- > 0; )
+            if( values[i].first.starts_with(key) )
+                m_Directories.erase(m_Directories.begin() + i);
+    }
+    Bury(std::move(key), true);
+}
+
+void DirectorySizeCache::Clear()
+{
+    const auto lock = std::lock_guard{m_Lock};
+    m_Directories.clear();
+    Bury("/", true);
+}
+
+size_t DirectorySizeCache::Size() const
+{
+    const auto lock = std::lock_guard{m_Lock};
+    return m_Directories.size();
+}
+
+uint64_t DirectorySizeCache::LastEventID() const
+{
+    const auto lock = std::lock_guard{m_Lock};
+    return m_LastEventID;
+}
+
+void DirectorySizeCache::SetLastEventID(uint64_t _event_id)
+{
+    const auto lock = std::lock_guard{m_Lock};
+    m_LastEventID = _event_id;
+}
+
+bool DirectorySizeCache::Save(const std::filesystem::path &_path) const
+{
+    Writer writer;
+    {
+        const auto lock = std::lock_guard{m_Lock};
+        writer.Put(g_Signature);
+        writer.Put(m_LastEventID);
+        writer.Put(static_cast<uint64_t>(m_Directories.size()));
+        for( const auto &[path, directory] : m_Directories ) {
+            writer.Put(std::string_view{path});
+            writer.Put(directory.mtime.sec);
+            writer.Put(directory.mtime.nsec);
+            writer.Put(directory.files_size);
+            writer.Put(directory.files_count);
+            writer.Put(static_cast<uint32_t>(directory.subdirectories.size()));
+            for( const auto &subdirectory : directory.subdirectories )
+                writer.Put(std::string_view{subdirectory});
+        }
+    }
+
+    if( !base::WriteAtomically(_path, writer.Bytes()) ) {
+        Log::Error("DirectorySizeCache failed to write {}, errno: {}", _path, errno);
+        return false;
+    }
+    Log::Debug("DirectorySizeCache saved into {}", _path);
+    return true;
+}
+
+bool DirectorySizeCache::Load(const std::filesystem::path &_path)
+{
+    std::ifstream in(_path, std::ios::in | std::ios::binary);
+    if( !in ) {
+        Clear();
+        return false;
+    }
+    const std::string bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+    MapT directories;
+    uint64_t last_event_id = 0;
+    const bool parsed = [&] {
+        Reader reader(bytes);
+        uint64_t signature = 0;
+        uint64_t count = 0;
+        if( !reader.Get(signature) || signature != g_Signature || !reader.Get(last_event_id) || !reader.Get(count) )
+            return false;
+        for( uint64_t i = 0; i < count; ++i ) {
+            std::string path;
+            Directory directory;
+            uint32_t subdirectories = 0;
+            if( !reader.Get(path) || !reader.Get(directory.mtime.sec) || !reader.Get(directory.mtime.nsec) ||
+                !reader.Get(directory.files_size) || !reader.Get(directory.files_count) ||
+                !reader.Get(subdirectories) )
+                return false;
+            for( uint32_t j = 0; j < subdirectories; ++j )
+                if( !reader.Get(directory.subdirectories.emplace_back()) )
+                    return false;
+            if( path.empty() || path.back() != '/' )
+                return false;
+            directories.emplace(std::move(path), std::move(directory));
+        }
+        return reader.AtEnd();
+    }();
+
+    if( !parsed ) {
+        Log::Warn("DirectorySizeCache failed to parse {}", _path);
+        Clear();
+        return false;
+    }
+
+    const auto lock = std::lock_guard{m_Lock};
+    m_Directories = std::move(directories);
+    m_LastEventID = last_event_id;
+    Bury("/", true);
+    Log::Debug("DirectorySizeCache loaded {} directories from {}", m_Directories.size(), _path);
+    return true;
+}
+
+} // namespace nc::vfs::native
@@ -0,0 +1,113 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <Base/UnorderedUtil.h>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nc::vfs::native {
+
+/**
+ * DirectorySizeCache remembers what was found in each directory when calculating directory sizes, so that repeated
+ * calculations only have to rescan the subtrees that have changed since.
+ * Each directory is stored individually along with its modification time at the moment of scanning, which is how
+ * additions, removals and renames of the directory entries are detected. Changes of the files' contents don't touch
+ * the modification time of their directory and have to be reported via Invalidate(), e.g. by DirectorySizeCacheObserver.
+ * An invalidation which arrives while a directory is being scanned must not be overwritten by the stale results of
+ * that scan, so each invalidation bumps a generation and Commit() skips the directories invalidated after the
+ * generation the scan has started at.
+ * The cache can be persisted across sessions via Save()/Load().
+ * Is thread-safe.
+ */
+class DirectorySizeCache
+{
+public:
+    struct Timestamp {
+        int64_t sec = 0;
+        int64_t nsec = 0;
+        bool operator==(const Timestamp &) const noexcept = default;
+    };
+
+    struct Directory {
+        // the modification time of the directory itself at the moment of scanning
+        Timestamp mtime;
+
+        // the total size of the non-directory entries directly inside this directory
+        uint64_t files_size = 0;
+
+        // the number of the non-directory entries directly inside this directory
+        uint64_t files_count = 0;
+
+        // filenames of the subdirectories
+        std::vector<std::string> subdirectories;
+    };
+
+    static constexpr size_t DefaultMaxDirectories = 1'000'000;
+
+    // The number of the latest invalidations remembered to check the commits against.
+    static constexpr size_t MaxTombstones = 4096;
+
+    DirectorySizeCache(size_t _max_directories = DefaultMaxDirectories);
+
+    // Returns the directory at _path if it's in the cache and its modification time is the same as _mtime.
+    std::optional<Directory> Find(std::string_view _path, const Timestamp &_mtime) const;
+
+    // Stores a freshly scanned directory, replacing any existing one.
+    // New directories are ignored once the cache is full.
+    // If _scanned_at is specified, which is what Generation() returned before the directory was read, the directory is
+    // ignored when it was invalidated since then.
+    void Commit(std::string_view _path, Directory _directory, std::optional<uint64_t> _scanned_at = std::nullopt);
+
+    // The number of invalidations happened so far, including the implicit ones by Clear() and Load().
+    uint64_t Generation() const;
+
+    // Forgets the directory at _path, its subdirectories are kept.
+    void Invalidate(std::string_view _path);
+
+    // Forgets the directory at _path and everything beneath it.
+    void InvalidateRecursively(std::string_view _path);
+
+    void Clear();
+
+    // The number of directories currently stored.
+    size_t Size() const;
+
+    // The identifier of the last file system event that was reflected in the cache, 0 if none.
+    uint64_t LastEventID() const;
+    void SetLastEventID(uint64_t _event_id);
+
+    // Writes the cache into _path atomically. Returns false on failure.
+    bool Save(const std::filesystem::path &_path) const;
+
+    // Replaces the contents of the cache with the contents of _path. Returns false on failure, leaving the cache empty.
+    bool Load(const std::filesystem::path &_path);
+
+private:
+    using MapT =
+        ankerl::unordered_dense::map<std::string, Directory, UnorderedStringHashEqual, UnorderedStringHashEqual>;
+
+    struct Tombstone {
+        uint64_t generation = 0;
+        std::string key;
+        bool recursive = false;
+    };
+
+    static std::string Key(std::string_view _path);
+    void Bury(std::string _key, bool _recursive);
+    bool InvalidatedSince(std::string_view _key, uint64_t _generation) const noexcept;
+
+    size_t m_MaxDirectories;
+    MapT m_Directories;
+    uint64_t m_Generation = 0;
+    std::deque<Tombstone> m_Tombstones;
+    uint64_t m_LastEventID = 0;
+    mutable std::mutex m_Lock;
+};
+
+} // namespace nc::vfs::native
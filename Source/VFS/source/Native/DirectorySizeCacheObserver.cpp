@@ -0,0 +1,106 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "DirectorySizeCacheObserver.h"
+#include "DirectorySizeCache.h"
+#include <VFS/Log.h>
+#include <algorithm>
+
+namespace nc::vfs::native {
+
+// the cache doesn't need to react instantly, coalescing the events is more valuable
+static const CFAbsoluteTime g_Latency = 1.0;
+
+DirectorySizeCacheObserver::DirectorySizeCacheObserver(DirectorySizeCache &_cache) : m_Cache(_cache)
+{
+    // without a known position in the events history the cache can't tell what has changed in the meantime
+    FSEventStreamEventId since = m_Cache.LastEventID();
+    if( since == 0 ) {
+        m_Cache.Clear();
+        since = FSEventsGetCurrentEventId();
+        m_Cache.SetLastEventID(since);
+    }
+
+    const auto root = CFSTR("/");
+    const auto paths = CFArrayCreate(nullptr, reinterpret_cast<const void **>(&root), 1, &kCFTypeArrayCallBacks);
+    auto context = FSEventStreamContext{0, this, nullptr, nullptr, nullptr};
+    m_Stream = FSEventStreamCreate(nullptr, &Callback, &context, paths, since, g_Latency, kFSEventStreamCreateFlagNone);
+    CFRelease(paths);
+    if( m_Stream == nullptr ) {
+        Log::Warn("DirectorySizeCacheObserver failed to create an events stream");
+        m_Cache.Clear();
+        return;
+    }
+
+    m_Queue = dispatch_queue_create("nc::vfs::native::DirectorySizeCacheObserver", DISPATCH_QUEUE_SERIAL);
+    FSEventStreamSetDispatchQueue(m_Stream, m_Queue);
+    if( !FSEventStreamStart(m_Stream) ) {
+        Log::Warn("DirectorySizeCacheObserver failed to start an events stream");
+        m_Cache.Clear();
+    }
+}
+
+DirectorySizeCacheObserver::~DirectorySizeCacheObserver()
+{
+    if( m_Stream ) {
+        FSEventStreamStop(m_Stream);
+        FSEventStreamInvalidate(m_Stream);
+        FSEventStreamRelease(m_Stream);
+    }
+    if( m_Queue ) {
+        // wait for a callback that might be in flight
+        dispatch_sync_f(m_Queue, nullptr, [](void *) {});
+        dispatch_release(m_Queue);
+    }
+}
+
+void DirectorySizeCacheObserver::Callback([[maybe_unused]] ConstFSEventStreamRef _stream,
+                                          void *_user_data,
+                                          size_t _num,
+                                          void *_paths,
+                                          const FSEventStreamEventFlags _flags[],
+                                          const FSEventStreamEventId _ids[])
+{
+    auto &observer = *static_cast<DirectorySizeCacheObserver *>(_user_data);
+    Process(observer.m_Cache,
+            std::span<const char *const>{static_cast<const char *const *>(_paths), _num},
+            std::span<const FSEventStreamEventFlags>{_flags, _num},
+            std::span<const FSEventStreamEventId>{_ids, _num});
+}
+
+void DirectorySizeCacheObserver::Process(DirectorySizeCache &_cache,
+                                         std::span<const char *const> _paths,
+                                         std::span<const FSEventStreamEventFlags> _flags,
+                                         std::span<const FSEventStreamEventId> _ids) noexcept
+{
+    constexpr FSEventStreamEventFlags lost_events = kFSEventStreamEventFlagUserDropped |
+                                                    kFSEventStreamEventFlagKernelDropped |
+                                                    kFSEventStreamEventFlagEventIdsWrapped;
+    constexpr FSEventStreamEventFlags lost_subtree = kFSEventStreamEventFlagMustScanSubDirs |
+                                                     kFSEventStreamEventFlagRootChanged |
+                                                     kFSEventStreamEventFlagMount | kFSEventStreamEventFlagUnmount;
+
+    FSEventStreamEventId last_id = 0;
+    for( size_t i = 0; i < _paths.size(); ++i ) {
+        const auto flags = _flags[i];
+        if( flags & kFSEventStreamEventFlagHistoryDone )
+            continue; // a marker without a path, its id is meaningless
+
+        if( flags & lost_events ) {
+            Log::Info("DirectorySizeCacheObserver lost some events, dropping the cache");
+            _cache.Clear();
+        }
+        else if( flags & lost_subtree ) {
+            Log::Debug("DirectorySizeCacheObserver invalidates the subtree at {}", _paths[i]);
+            _cache.InvalidateRecursively(_paths[i]);
+        }
+        else {
+            // the events report the directories where something has changed
+            _cache.Invalidate(_paths[i]);
+        }
+        last_id = std::max(last_id, _ids[i]);
+    }
+
+    if( last_id != 0 )
+        _cache.SetLastEventID(last_id);
+}
+
+} // namespace nc::vfs::native
@@ -0,0 +1,46 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <CoreServices/CoreServices.h>
+#include <dispatch/dispatch.h>
+#include <memory>
+#include <span>
+
+namespace nc::vfs::native {
+
+class DirectorySizeCache;
+
+/**
+ * Keeps a DirectorySizeCache up to date by invalidating the directories reported by FSEvents.
+ * The events are requested since the last event reflected in the cache, so the changes made while Nimble Commander
+ * was not running are picked up as well.
+ * The cache must outlive the observer.
+ */
+class DirectorySizeCacheObserver
+{
+public:
+    DirectorySizeCacheObserver(DirectorySizeCache &_cache);
+    DirectorySizeCacheObserver(const DirectorySizeCacheObserver &) = delete;
+    ~DirectorySizeCacheObserver();
+    DirectorySizeCacheObserver &operator=(const DirectorySizeCacheObserver &) = delete;
+
+    // Implementation detail exposed for testability
+    static void Process(DirectorySizeCache &_cache,
+                        std::span<const char *const> _paths,
+                        std::span<const FSEventStreamEventFlags> _flags,
+                        std::span<const FSEventStreamEventId> _ids) noexcept;
+
+private:
+    static void Callback(ConstFSEventStreamRef _stream,
+                         void *_user_data,
+                         size_t _num,
+                         void *_paths,
+                         const FSEventStreamEventFlags _flags[],
+                         const FSEventStreamEventId _ids[]);
+
+    DirectorySizeCache &m_Cache;
+    dispatch_queue_t m_Queue = nullptr;
+    FSEventStreamRef m_Stream = nullptr;
+};
+
+} // namespace nc::vfs::native
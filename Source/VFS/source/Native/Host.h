@@ -8,6 +8,10 @@ class NativeFSManager;
 class FSEventsFileUpdate;
 } // namespace nc::utility
 
+namespace nc::vfs::native {
+class DirectorySizeCache;
+} // namespace nc::vfs::native
+
 namespace nc::vfs {
 
 class NativeHost : public Host
@@ -59,6 +63,10 @@ public:
 
     ssize_t CalculateDirectorySize(std::string_view _path, const VFSCancelChecker &_cancel_checker) override;
 
+    ssize_t CalculateDirectoryLevelSize(std::string_view _path,
+                                        const std::function<void(std::string_view _subdirectory)> &_subdirectory,
+                                        const VFSCancelChecker &_cancel_checker) override;
+
     int ReadSymlink(std::string_view _path,
                     char *_buffer,
                     size_t _buffer_size,
@@ -94,6 +102,10 @@ public:
                  std::optional<time_t> _acc_time,
                  const VFSCancelChecker &_cancel_checker) override;
 
+    int SetAttributes(std::span<const AttributesChange> _changes,
+                      std::span<AttributesChangeResult> _results,
+                      const VFSCancelChecker &_cancel_checker) override;
+
     int FetchUsers(std::vector<VFSUser> &_target, const VFSCancelChecker &_cancel_checker) override;
 
     int FetchGroups(std::vector<VFSGroup> &_target, const VFSCancelChecker &_cancel_checker) override;
@@ -109,8 +121,16 @@ public:
 
     nc::utility::NativeFSManager &NativeFSManager() const noexcept;
 
+    // Lets CalculateDirectorySize() reuse the results of the previous calculations for the unchanged directories.
+    // Should be set before the host is used.
+    void SetDirectorySizeCache(std::shared_ptr<native::DirectorySizeCache> _cache) noexcept;
+
 private:
+    // Returns the real path of a directory and its device if the sizes of its tree can be cached.
+    std::optional<std::pair<std::string, dev_t>> DirectorySizeCacheablePath(const char *_path) const;
+
     nc::utility::NativeFSManager &m_NativeFSManager;
+    std::shared_ptr<native::DirectorySizeCache> m_DirectorySizeCache;
     [[maybe_unused]] nc::utility::FSEventsFileUpdate &m_FSEventsFileUpdate;
 };
 
@@ -12,6 +12,7 @@
 #include <Utility/NativeFSManager.h>
 #include <RoutedIO/RoutedIO.h>
 #include "DisplayNamesCache.h"
+#include "DirectorySizeCache.h"
 #include "File.h"
 #include <VFS/VFSError.h>
 #include <VFS/Log.h>
@@ -24,6 +25,7 @@
 #include <sys/mount.h>
 
 #include <algorithm>
+#include <deque>
 
 // hack to access function from libc implementation directly.
 // this func does readdir but without mutex locking
@@ -370,13 +372,28 @@ int NativeHost::CreateFile(std::string_view _path,
     return VFSError::Ok;
 }
 
+namespace {
+
+// A directory scanned during the size calculation, it's committed into the cache once all its files are accounted for
+struct ScannedDirectory {
+    std::string path;
+    DirectorySizeCache::Directory directory;
+    std::atomic_uint64_t files_size{0};
+    std::atomic_uint64_t files_count{0};
+};
+
+} // namespace
+
 // return VFSError on error or cancellation
 static int CalculateDirectoriesSizesHelper(char *_path,
                                            size_t _path_len,
                                            std::atomic_bool &_iscancelling,
                                            const VFSCancelChecker &_checker,
                                            dispatch_queue &_stat_queue,
-                                           std::atomic_int64_t &_size_stock)
+                                           std::atomic_int64_t &_size_stock,
+                                           const DirectorySizeCache *_cache,
+                                           dev_t _cache_device,
+                                           std::deque<ScannedDirectory> &_scanned)
 {
     if( _checker && _checker() ) {
         _iscancelling = true;
@@ -385,13 +402,53 @@ static int CalculateDirectoriesSizesHelper(char *_path,
 
     auto &io = routedio::RoutedIO::InterfaceForAccess(_path, R_OK); // <-- sync IO operation
 
+    // the root directory already ends with a slash
+    const size_t prefix_len = _path_len == 1 ? 0 : _path_len;
+
+    ScannedDirectory *scanned = nullptr;
+    if( _cache ) {
+        struct stat st;
+        // the directories of other volumes mounted inside the tree are not covered by the invalidation
+        if( io.stat(_path, &st) == 0 && st.st_dev == _cache_device ) { // <-- sync IO operation
+            const DirectorySizeCache::Timestamp mtime{st.st_mtimespec.tv_sec, st.st_mtimespec.tv_nsec};
+            if( auto cached = _cache->Find(_path, mtime) ) {
+                // the entries of this directory are the same as before, only the subdirectories need to be checked
+                _size_stock += cached->files_size;
+                _path[prefix_len] = '/';
+                char *var = _path + prefix_len + 1;
+                for( const auto &subdirectory : cached->subdirectories ) {
+                    memcpy(var, subdirectory.c_str(), subdirectory.length() + 1);
+                    CalculateDirectoriesSizesHelper(_path,
+                                                    prefix_len + subdirectory.length() + 1,
+                                                    _iscancelling,
+                                                    _checker,
+                                                    _stat_queue,
+                                                    _size_stock,
+                                                    _cache,
+                                                    _cache_device,
+                                                    _scanned);
+                    if( _iscancelling )
+                        break;
+                }
+                _path[_path_len] = 0;
+                return VFSError::Ok;
+            }
+            scanned = &_scanned.emplace_back();
+            scanned->path = _path;
+            scanned->directory.mtime = mtime;
+        }
+    }
+
     const auto dirp = io.opendir(_path); // <-- sync IO operation
-    if( dirp == nullptr )
+    if( dirp == nullptr ) {
+        if( scanned )
+            _scanned.pop_back();
         return VFSError::FromErrno();
+    }
 
-    _path[_path_len] = '/';
-    _path[_path_len + 1] = 0;
-    char *var = _path + _path_len + 1;
+    _path[prefix_len] = '/';
+    _path[prefix_len + 1] = 0;
+    char *var = _path + prefix_len + 1;
 
     dirent *entp = nullptr;
     while( (entp = io.readdir(dirp)) != nullptr ) { // <-- sync IO operation
@@ -409,20 +466,34 @@ static int CalculateDirectoriesSizesHelper(char *_path,
 
         memcpy(var, entp->d_name, entp->d_namlen + 1);
         if( entp->d_type == DT_DIR ) {
-            CalculateDirectoriesSizesHelper(
-                _path, _path_len + entp->d_namlen + 1, _iscancelling, _checker, _stat_queue, _size_stock);
+            if( scanned )
+                scanned->directory.subdirectories.emplace_back(entp->d_name, entp->d_namlen);
+            CalculateDirectoriesSizesHelper(_path,
+                                            prefix_len + entp->d_namlen + 1,
+                                            _iscancelling,
+                                            _checker,
+                                            _stat_queue,
+                                            _size_stock,
+                                            _cache,
+                                            _cache_device,
+                                            _scanned);
             if( _iscancelling )
                 goto cleanup;
         }
         else if( entp->d_type == DT_REG || entp->d_type == DT_LNK ) {
             std::string full_path = _path;
-            _stat_queue.async([&, full_path = std::move(full_path)] {
+            _stat_queue.async([&, scanned, full_path = std::move(full_path)] {
                 if( _iscancelling )
                     return;
 
                 struct stat st;
-                if( io.lstat(full_path.c_str(), &st) == 0 ) // <-- sync IO operation
+                if( io.lstat(full_path.c_str(), &st) == 0 ) { // <-- sync IO operation
                     _size_stock += st.st_size;
+                    if( scanned ) {
+                        scanned->files_size += st.st_size;
+                        ++scanned->files_count;
+                    }
+                }
             });
         }
         else if( entp->d_type == DT_UNKNOWN ) {
@@ -431,13 +502,26 @@ static int CalculateDirectoriesSizesHelper(char *_path,
             struct stat st;
             if( io.lstat(_path, &st) == 0 ) { // <-- sync IO operation
                 if( S_ISDIR(st.st_mode) ) {
-                    CalculateDirectoriesSizesHelper(
-                        _path, _path_len + entp->d_namlen + 1, _iscancelling, _checker, _stat_queue, _size_stock);
+                    if( scanned )
+                        scanned->directory.subdirectories.emplace_back(entp->d_name, entp->d_namlen);
+                    CalculateDirectoriesSizesHelper(_path,
+                                                    prefix_len + entp->d_namlen + 1,
+                                                    _iscancelling,
+                                                    _checker,
+                                                    _stat_queue,
+                                                    _size_stock,
+                                                    _cache,
+                                                    _cache_device,
+                                                    _scanned);
                     if( _iscancelling )
                         goto cleanup;
                 }
                 else if( S_ISREG(st.st_mode) || S_ISLNK(st.st_mode) ) {
                     _size_stock += st.st_size;
+                    if( scanned ) {
+                        scanned->files_size += st.st_size;
+                        ++scanned->files_count;
+                    }
                 }
             }
         }
@@ -466,16 +550,137 @@ ssize_t NativeHost::CalculateDirectorySize(std::string_view _path, const VFSCanc
 
     dispatch_queue stat_queue("VFSNativeHost.CalculateDirectoriesSizes");
 
+    // the cached directories are matched by their paths, which must not contain double slashes
+    size_t path_len = _path.length();
+    if( path_len > 1 && path[path_len - 1] == '/' )
+        path[--path_len] = 0;
+
+    DirectorySizeCache *cache = nullptr;
+    dev_t cache_device = 0;
+    uint64_t cache_generation = 0;
+    if( m_DirectorySizeCache ) {
+        if( auto cacheable = DirectorySizeCacheablePath(path) ) {
+            // the tree is scanned via its real path, so the paths of the subdirectories are real as well
+            memcpy(path, cacheable->first.c_str(), cacheable->first.length() + 1);
+            path_len = cacheable->first.length();
+            cache = m_DirectorySizeCache.get();
+            cache_device = cacheable->second;
+            cache_generation = cache->Generation();
+        }
+    }
+
     std::atomic_int64_t size{0};
-    const int result =
-        CalculateDirectoriesSizesHelper(path, strlen(path), iscancelling, _cancel_checker, stat_queue, size);
+    std::deque<ScannedDirectory> scanned;
+    const int result = CalculateDirectoriesSizesHelper(
+        path, path_len, iscancelling, _cancel_checker, stat_queue, size, cache, cache_device, scanned);
     stat_queue.sync([] {});
+
+    // a cancelled calculation might have skipped some entries, so only complete ones are remembered.
+    // the directories changed during the scan might have been read before the change, so these are skipped as well.
+    if( cache && result >= 0 && !iscancelling ) {
+        for( auto &directory : scanned ) {
+            directory.directory.files_size = directory.files_size;
+            directory.directory.files_count = directory.files_count;
+            cache->Commit(directory.path, std::move(directory.directory), cache_generation);
+        }
+    }
+
     if( result >= 0 )
         return size;
     else
         return result;
 }
 
+ssize_t NativeHost::CalculateDirectoryLevelSize(std::string_view _path,
+                                                const std::function<void(std::string_view _subdirectory)> &_subdirectory,
+                                                const VFSCancelChecker &_cancel_checker)
+{
+    if( _cancel_checker && _cancel_checker() )
+        return VFSError::Cancelled;
+
+    if( !_path.starts_with("/") )
+        return VFSError::InvalidCall;
+
+    std::string path(_path);
+    if( path.length() > 1 && path.back() == '/' )
+        path.pop_back();
+
+    auto &io = routedio::RoutedIO::InterfaceForAccess(path.c_str(), R_OK); // <-- sync IO operation
+
+    DirectorySizeCache::Directory directory;
+    std::string cache_path;
+    bool cacheable = false;
+    uint64_t cache_generation = 0;
+    if( m_DirectorySizeCache ) {
+        cache_generation = m_DirectorySizeCache->Generation();
+        struct stat st;
+        auto real = DirectorySizeCacheablePath(path.c_str());
+        if( real && io.stat(real->first.c_str(), &st) == 0 ) { // <-- sync IO operation
+            cache_path = std::move(real->first);
+            directory.mtime = {st.st_mtimespec.tv_sec, st.st_mtimespec.tv_nsec};
+            if( auto cached = m_DirectorySizeCache->Find(cache_path, directory.mtime) ) {
+                if( _subdirectory )
+                    for( const auto &subdirectory : cached->subdirectories )
+                        _subdirectory(subdirectory);
+                return cached->files_size;
+            }
+            cacheable = true;
+        }
+    }
+
+    const auto dirp = io.opendir(path.c_str()); // <-- sync IO operation
+    if( dirp == nullptr )
+        return VFSError::FromErrno();
+    auto close_dirp = at_scope_end([&] { io.closedir(dirp); }); // <-- sync IO operation
+
+    if( path != "/" )
+        path += '/';
+    const size_t path_len = path.length();
+
+    dirent *entp = nullptr;
+    while( (entp = io.readdir(dirp)) != nullptr ) { // <-- sync IO operation
+        if( _cancel_checker && _cancel_checker() )
+            return VFSError::Cancelled;
+
+        if( entp->d_ino == 0 )
+            continue; // apple's documentation suggest to skip such files
+        if( entp->d_namlen == 1 && entp->d_name[0] == '.' )
+            continue; // do not process self entry
+        if( entp->d_namlen == 2 && entp->d_name[0] == '.' && entp->d_name[1] == '.' )
+            continue; // do not process parent entry
+
+        if( entp->d_type == DT_DIR ) {
+            directory.subdirectories.emplace_back(entp->d_name, entp->d_namlen);
+            continue;
+        }
+
+        if( entp->d_type != DT_REG && entp->d_type != DT_LNK && entp->d_type != DT_UNKNOWN )
+            continue;
+
+        path.resize(path_len);
+        path.append(entp->d_name, entp->d_namlen);
+        struct stat st;
+        if( io.lstat(path.c_str(), &st) != 0 ) // <-- sync IO operation
+            continue;
+        if( S_ISDIR(st.st_mode) ) {
+            directory.subdirectories.emplace_back(entp->d_name, entp->d_namlen);
+        }
+        else if( S_ISREG(st.st_mode) || S_ISLNK(st.st_mode) ) {
+            directory.files_size += st.st_size;
+            ++directory.files_count;
+        }
+    }
+
+    if( _subdirectory )
+        for( const auto &subdirectory : directory.subdirectories )
+            _subdirectory(subdirectory);
+
+    const auto size = static_cast<ssize_t>(directory.files_size);
+    if( cacheable )
+        m_DirectorySizeCache->Commit(cache_path, std::move(directory), cache_generation);
+    return size;
+}
+
 bool NativeHost::IsDirectoryChangeObservationAvailable(std::string_view _path)
 {
     if( _path.empty() )
@@ -790,6 +995,56 @@ int NativeHost::SetOwnership(std::string_view _path,
     return VFSError::FromErrno();
 }
 
+int NativeHost::SetAttributes(std::span<const AttributesChange> _changes,
+                              std::span<AttributesChangeResult> _results,
+                              const VFSCancelChecker &_cancel_checker)
+{
+    if( _changes.size() != _results.size() )
+        return VFSError::InvalidCall;
+
+    // a single routed call per chunk, small enough to keep the XPC messages reasonably sized
+    constexpr size_t chunk_size = 1024;
+    std::vector<routedio::AttrsChange> changes;
+    std::vector<routedio::AttrsChangeResult> results;
+    changes.reserve(std::min(chunk_size, _changes.size()));
+    results.reserve(std::min(chunk_size, _changes.size()));
+
+    auto &io = routedio::RoutedIO::Default;
+    for( size_t first = 0; first < _changes.size(); first += chunk_size ) {
+        if( _cancel_checker && _cancel_checker() )
+            return VFSError::Cancelled;
+
+        const size_t last = std::min(first + chunk_size, _changes.size());
+        changes.clear();
+        for( size_t i = first; i != last; ++i ) {
+            const AttributesChange &change = _changes[i];
+            routedio::AttrsChange &rchange = changes.emplace_back();
+            rchange.path = change.path.c_str();
+            rchange.mode = change.permissions;
+            if( change.ownership )
+                rchange.owner = std::make_pair(change.ownership->uid, change.ownership->gid);
+            rchange.flags = change.flags;
+            rchange.btime = change.btime;
+            rchange.mtime = change.mtime;
+            rchange.ctime = change.ctime;
+            rchange.atime = change.atime;
+        }
+        results.assign(changes.size(), {});
+
+        io.chattrs(changes, results);
+
+        for( size_t i = first; i != last; ++i ) {
+            const routedio::AttrsChangeResult &rresult = results[i - first];
+            if( rresult.failed == routedio::AttrsChangeResult::Step::None )
+                _results[i] = {};
+            else
+                _results[i] = {.failed = static_cast<AttributesChangeResult::Step>(rresult.failed),
+                               .error = VFSError::FromErrno(rresult.error)};
+        }
+    }
+    return VFSError::Ok;
+}
+
 int NativeHost::FetchUsers(std::vector<VFSUser> &_target, [[maybe_unused]] const VFSCancelChecker &_cancel_checker)
 {
     _target.clear();
@@ -908,6 +1163,26 @@ nc::utility::NativeFSManager &NativeHost::NativeFSManager() const noexcept
     return m_NativeFSManager;
 }
 
+std::optional<std::pair<std::string, dev_t>> NativeHost::DirectorySizeCacheablePath(const char *_path) const
+{
+    // FSEvents report the real paths and only for the local volumes, so the cached directories must comply
+    char real_path[MAXPATHLEN];
+    if( realpath(_path, real_path) == nullptr )
+        return std::nullopt;
+    const auto volume = m_NativeFSManager.VolumeFromPath(real_path);
+    if( !volume || !volume->mount_flags.local )
+        return std::nullopt;
+    struct stat st;
+    if( stat(real_path, &st) != 0 )
+        return std::nullopt;
+    return std::pair<std::string, dev_t>{real_path, st.st_dev};
+}
+
+void NativeHost::SetDirectorySizeCache(std::shared_ptr<native::DirectorySizeCache> _cache) noexcept
+{
+    m_DirectorySizeCache = std::move(_cache);
+}
+
 static uint32_t MergeUnixFlags(uint32_t _symlink_flags, uint32_t _target_flags) noexcept
 {
     const uint32_t hidden_flag = _symlink_flags & UF_HIDDEN;
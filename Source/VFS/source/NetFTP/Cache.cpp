@@ -6,6 +6,13 @@
 
 namespace nc::vfs::ftp {
 
+using namespace std::literals;
+
+static const auto g_ListingTimeout = 5min;
+
+// an approximate bound of the entries kept in the cache
+static const size_t g_MaxCachedEntries = 250'000;
+
 Entry::Entry(const std::string &_name) : name(_name)
 {
 }
@@ -31,34 +38,40 @@ const Entry *Directory::EntryByName(const std::string &_name) const
     return i != end(entries) ? &(*i) : nullptr;
 }
 
-std::shared_ptr<Directory> Cache::FindDirectory(std::string_view _path) const noexcept
+Entry *Directory::EntryByName(const std::string &_name)
 {
-    const std::lock_guard<std::mutex> lock(m_CacheLock);
-
-    return FindDirectoryInt(_path);
+    auto i = std::ranges::find_if(entries, [&](auto &_e) { return _e.name == _name; });
+    return i != end(entries) ? &(*i) : nullptr;
 }
 
-void Cache::MarkDirectoryDirty(std::string_view _path)
+static std::string ParentDirectory(const std::filesystem::path &_path)
 {
-    assert(!_path.empty() && _path.back() == '/');
+    std::filesystem::path dir_path = _path.parent_path();
+    if( dir_path != "/" )
+        dir_path += "/";
+    return dir_path.native();
+}
 
-    const std::lock_guard<std::mutex> lock(m_CacheLock);
-    if( auto d = FindDirectoryInt(_path) )
-        d->dirty_structure = true;
+Cache::Cache()
+    : m_Directories(g_ListingTimeout, g_MaxCachedEntries, [](const Directory &_dir) { return _dir.entries.size() + 1; })
+{
 }
 
-std::shared_ptr<Directory> Cache::FindDirectoryInt(std::string_view _path) const noexcept
+std::shared_ptr<const Directory> Cache::FindDirectory(std::string_view _path) const noexcept
 {
     if( _path.empty() || _path.front() != '/' )
         return nullptr;
 
     assert(_path.back() == '/');
 
-    auto i = m_Directories.find(_path);
-    if( i != m_Directories.end() )
-        return i->second;
+    return m_Directories.Find(_path);
+}
+
+void Cache::MarkDirectoryDirty(std::string_view _path)
+{
+    assert(!_path.empty() && _path.back() == '/');
 
-    return nullptr;
+    m_Directories.Update(_path, [](Directory &_dir) { _dir.dirty_structure = true; });
 }
 
 void Cache::InsertLISTDirectory(const char *_path, std::shared_ptr<Directory> _directory)
@@ -76,13 +89,7 @@ void Cache::InsertLISTDirectory(const char *_path, std::shared_ptr<Directory> _d
 
     _directory->path = dir;
 
-    const std::lock_guard<std::mutex> lock(m_CacheLock);
-
-    auto i = m_Directories.find(dir);
-    if( i != m_Directories.end() )
-        i->second = _directory;
-    else
-        m_Directories.emplace(dir, _directory);
+    m_Directories.Insert(dir, std::move(_directory));
 }
 
 void Cache::CommitNewFile(const std::string &_path)
@@ -91,29 +98,23 @@ void Cache::CommitNewFile(const std::string &_path)
 
     const std::filesystem::path p = _path;
     assert(p.is_absolute());
+    const std::string dir_path = ParentDirectory(p);
 
-    std::filesystem::path dir_path = p.parent_path();
-    if( dir_path != "/" )
-        dir_path += "/";
-
-    const std::lock_guard<std::mutex> lock(m_CacheLock);
-    auto dir = FindDirectoryInt(dir_path.native());
-    if( dir != nullptr ) {
-        if( auto entry = dir->EntryByName(p.filename().native()) ) {
+    bool added = false;
+    m_Directories.Update(dir_path, [&](Directory &_dir) {
+        _dir.has_dirty_items = true;
+        if( auto entry = _dir.EntryByName(p.filename().native()) ) {
             entry->dirty = true;
-            dir->has_dirty_items = true;
             return;
         }
-
-        auto copy = std::make_shared<Directory>(*dir);
-        copy->entries.emplace_back(p.filename().native());
-        copy->entries.back().mode = S_IFREG;
-        copy->entries.back().dirty = true;
-        copy->has_dirty_items = true;
-
-        m_Directories.find(dir_path.native())->second = copy;
-        m_Callback(dir_path.native());
-    }
+        _dir.entries.emplace_back(p.filename().native());
+        _dir.entries.back().mode = S_IFREG;
+        _dir.entries.back().dirty = true;
+        added = true;
+    });
+
+    if( added )
+        m_Callback(dir_path);
 }
 
 void Cache::MakeEntryDirty(const std::string &_path)
@@ -122,41 +123,33 @@ void Cache::MakeEntryDirty(const std::string &_path)
     const std::filesystem::path p = _path;
     assert(p.is_absolute());
 
-    std::filesystem::path dir_path = p.parent_path();
-    if( dir_path != "/" )
-        dir_path += "/";
+    const auto dir = FindDirectory(ParentDirectory(p));
+    if( dir == nullptr || dir->EntryByName(p.filename().native()) == nullptr )
+        return; // don't copy the directory for nothing
 
-    const std::lock_guard<std::mutex> lock(m_CacheLock);
-    auto dir = FindDirectoryInt(dir_path.native());
-    if( dir ) {
-        auto entry = dir->EntryByName(p.filename().native());
-        if( entry ) {
+    m_Directories.Update(ParentDirectory(p), [&](Directory &_dir) {
+        if( auto entry = _dir.EntryByName(p.filename().native()) ) {
             entry->dirty = true;
-            dir->has_dirty_items = true;
+            _dir.has_dirty_items = true;
         }
-    }
+    });
 }
 
 void Cache::CommitRMD(const std::string &_path)
 {
     Log::Trace("Cache::CommitRMD({}) called", _path);
-    const std::lock_guard<std::mutex> lock(m_CacheLock);
 
-    EraseEntryInt(_path);
+    EraseEntry(_path);
 
     std::filesystem::path p = _path;
     p += "/";
-
-    auto i = m_Directories.find(p.native());
-    if( i != m_Directories.end() )
-        m_Directories.erase(i);
+    m_Directories.Erase(p.native());
 }
 
 void Cache::CommitUnlink(std::string_view _path)
 {
     Log::Trace("Cache::CommitUnlink({}) called", _path);
-    const std::lock_guard<std::mutex> lock(m_CacheLock);
-    EraseEntryInt(_path);
+    EraseEntry(_path);
 }
 
 void Cache::CommitMKD(const std::string &_path)
@@ -164,23 +157,15 @@ void Cache::CommitMKD(const std::string &_path)
     Log::Trace("Cache::CommitMKD({}) called", _path);
     const std::filesystem::path p = _path;
     assert(p.is_absolute());
-
-    std::filesystem::path dir_path = p.parent_path();
-    if( dir_path != "/" )
-        dir_path += "/";
-
-    const std::lock_guard<std::mutex> lock(m_CacheLock);
-    auto dir = FindDirectoryInt(dir_path.native());
-    if( dir != nullptr ) {
-        auto copy = std::make_shared<Directory>(*dir);
-        copy->entries.emplace_back(p.filename().native());
-        copy->entries.back().mode = S_IFDIR;
-        copy->entries.back().dirty = true;
-        copy->has_dirty_items = true;
-
-        m_Directories.find(dir_path.native())->second = copy;
-    }
-    m_Callback(dir_path.native());
+    const std::string dir_path = ParentDirectory(p);
+
+    m_Directories.Update(dir_path, [&](Directory &_dir) {
+        _dir.entries.emplace_back(p.filename().native());
+        _dir.entries.back().mode = S_IFDIR;
+        _dir.entries.back().dirty = true;
+        _dir.has_dirty_items = true;
+    });
+    m_Callback(dir_path);
 }
 
 void Cache::CommitRename(const std::string &_old_path, const std::string &_new_path)
@@ -189,57 +174,25 @@ void Cache::CommitRename(const std::string &_old_path, const std::string &_new_p
     std::filesystem::path old_path = _old_path, new_path = _new_path;
     assert(old_path.is_absolute() && new_path.is_absolute());
 
-    const std::lock_guard<std::mutex> lock(m_CacheLock);
-
-    std::filesystem::path old_par_path = old_path.parent_path();
-    if( old_par_path != "/" )
-        old_par_path += "/";
-    std::filesystem::path new_par_path = new_path.parent_path();
-    if( new_par_path != "/" )
-        new_par_path += "/";
-
     const bool same_dir = old_path.parent_path() == new_path.parent_path();
 
-    const Entry *old_entry = nullptr;
-    auto dir = FindDirectoryInt(old_par_path.native());
-    if( dir ) {
-        auto copy = std::make_shared<Directory>();
-        copy->path = dir->path;
-        copy->dirty_structure = dir->dirty_structure;
-        copy->has_dirty_items = dir->has_dirty_items;
-
-        for( auto &i : dir->entries )
-            if( i.name != old_path.filename() ) {
-                copy->entries.emplace_back(i);
-            }
-            else if( same_dir ) {
-                Entry e(new_path.filename().native());
-                e.size = i.size;
-                e.time = i.time;
-                e.mode = i.mode;
-                e.dirty = i.dirty;
-                copy->entries.push_back(e);
-            }
-            else
-                old_entry = &i;
-
-        m_Directories.find(old_par_path.native())->second = copy;
-    }
+    std::optional<Entry> old_entry;
+    m_Directories.Update(ParentDirectory(old_path), [&](Directory &_dir) {
+        const auto it = std::ranges::find_if(_dir.entries, [&](auto &_e) { return _e.name == old_path.filename(); });
+        if( it == _dir.entries.end() )
+            return;
+        if( same_dir ) {
+            it->name = new_path.filename().native();
+        }
+        else {
+            old_entry = std::move(*it);
+            _dir.entries.erase(it);
+        }
+    });
 
     if( !same_dir && old_entry ) {
-        dir = FindDirectoryInt(new_par_path.native());
-        if( dir ) {
-            auto copy = std::make_shared<Directory>(*dir);
-
-            Entry e(new_path.filename().native());
-            e.size = old_entry->size;
-            e.time = old_entry->time;
-            e.mode = old_entry->mode;
-            e.dirty = old_entry->dirty;
-            copy->entries.push_back(e);
-
-            m_Directories.find(new_par_path.native())->second = copy;
-        }
+        old_entry->name = new_path.filename().native();
+        m_Directories.Update(ParentDirectory(new_path), [&](Directory &_dir) { _dir.entries.push_back(*old_entry); });
     }
 
     // if _old_path was a dir and we have it in cache - need to rename it too
@@ -247,39 +200,22 @@ void Cache::CommitRename(const std::string &_old_path, const std::string &_new_p
         old_path /= "/";
     if( new_path != "/" )
         new_path /= "/";
-    auto self_dir = m_Directories.find(old_path.c_str());
-    if( self_dir != m_Directories.end() ) {
-        auto data = self_dir->second;
-        m_Directories.erase(self_dir);
-        m_Directories.emplace(new_path.native(), data);
-    }
+    m_Directories.Move(old_path.native(), new_path.native());
 }
 
-void Cache::EraseEntryInt(std::string_view _path)
+void Cache::EraseEntry(std::string_view _path)
 {
-    Log::Trace("Cache::EraseEntryInt({}) called", _path);
+    Log::Trace("Cache::EraseEntry({}) called", _path);
     const std::filesystem::path p = _path;
     assert(p.filename() != ""); // _path with no trailing slashes
     assert(p.is_absolute());
 
     // find and erase entry of this dir in parent dir if any
-    std::filesystem::path dir_path = p.parent_path();
-    if( dir_path != "/" )
-        dir_path += "/";
-
-    auto dir = FindDirectoryInt(dir_path.native());
-    if( dir ) {
-        auto copy = std::make_shared<Directory>();
-        copy->path = dir->path;
-        copy->dirty_structure = dir->dirty_structure;
-        copy->has_dirty_items = dir->has_dirty_items;
-
-        for( auto &i : dir->entries )
-            if( i.name != p.filename() )
-                copy->entries.emplace_back(i);
-        m_Directories.find(dir_path.native())->second = copy;
-    }
-    m_Callback(dir_path.native());
+    const std::string dir_path = ParentDirectory(p);
+    m_Directories.Update(dir_path, [&](Directory &_dir) {
+        std::erase_if(_dir.entries, [&](auto &_e) { return _e.name == p.filename(); });
+    });
+    m_Callback(dir_path);
 }
 
 void Cache::SetChangesCallback(std::function<void(const std::string &_at_dir)> _handler)
@@ -3,9 +3,8 @@
 
 #include <curl/curl.h>
 #include <VFS/Host.h>
+#include "../DirectoryCache.h"
 #include <deque>
-#include <mutex>
-#include <Base/UnorderedUtil.h>
 #include <Base/CFPtr.h>
 #include <string_view>
 #include <functional>
@@ -20,7 +19,7 @@ struct Entry {
     uint64_t size = 0;
     time_t time = 0;
     mode_t mode = 0;
-    mutable bool dirty = false; // true when this entry was explicitly set as outdated
+    bool dirty = false; // true when this entry was explicitly set as outdated
 
     // links support in the future
 
@@ -36,21 +35,27 @@ struct Directory {
 
     inline bool IsOutdated() const
     {
-        return dirty_structure; // || (GetTimeInNanoseconds() > snapshot_time + g_ListingOutdateLimit);
+        return dirty_structure;
     }
 
     const Entry *EntryByName(const std::string &_name) const;
+    Entry *EntryByName(const std::string &_name);
 };
 
+/**
+ * Cached directories are immutable snapshots, all changes are published as updated copies.
+ */
 class Cache
 {
 public:
+    Cache();
+
     void SetChangesCallback(std::function<void(const std::string &_at_dir)> _handler);
 
     /**
      * Return nullptr if was not able to find directory.
      */
-    std::shared_ptr<Directory> FindDirectory(std::string_view _path) const noexcept;
+    std::shared_ptr<const Directory> FindDirectory(std::string_view _path) const noexcept;
 
     /**
      * Commits new freshly downloaded ftp listing.
@@ -94,15 +99,9 @@ public:
     void CommitRename(const std::string &_old_path, const std::string &_new_path);
 
 private:
-    using DirectoriesT = ankerl::unordered_dense::
-        map<std::string, std::shared_ptr<Directory>, UnorderedStringHashEqual, UnorderedStringHashEqual>;
-
-    std::shared_ptr<Directory> FindDirectoryInt(std::string_view _path) const noexcept;
-    void EraseEntryInt(std::string_view _path);
-
-    DirectoriesT m_Directories; // "/Abra/Cadabra/" -> Directory
+    void EraseEntry(std::string_view _path);
 
-    mutable std::mutex m_CacheLock;
+    DirectoryCache<Directory> m_Directories; // "/Abra/Cadabra/" -> Directory
     std::function<void(const std::string &_at_dir)> m_Callback;
 };
 
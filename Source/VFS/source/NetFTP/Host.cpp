@@ -127,7 +127,7 @@ int FTPHost::DoInit()
 
 int FTPHost::DownloadAndCacheListing(CURLInstance *_inst,
                                      const char *_path,
-                                     std::shared_ptr<Directory> *_cached_dir,
+                                     std::shared_ptr<const Directory> *_cached_dir,
                                      const VFSCancelChecker &_cancel_checker)
 {
     Log::Trace("FTPHost::DownloadAndCacheListing({}, {}) called", static_cast<void *>(_inst), _path);
@@ -271,7 +271,7 @@ int FTPHost::Stat(std::string_view _path, VFSStat &_st, unsigned long _flags, co
 
     // assume that file is freshly created and thus we don't have it in current cache state
     // download new listing, sync I/O
-    std::shared_ptr<Directory> dir;
+    std::shared_ptr<const Directory> dir;
     const int result = DownloadAndCacheListing(m_ListingInstance.get(), parent_dir.c_str(), &dir, _cancel_checker);
     if( result != 0 ) {
         return result;
@@ -293,7 +293,7 @@ int FTPHost::FetchDirectoryListing(std::string_view _path,
     if( _flags & VFSFlags::F_ForceRefresh )
         m_Cache->MarkDirectoryDirty(_path);
 
-    std::shared_ptr<Directory> dir;
+    std::shared_ptr<const Directory> dir;
     const int result = GetListingForFetching(m_ListingInstance.get(), _path, dir, _cancel_checker);
     if( result != 0 )
         return result;
@@ -342,7 +342,7 @@ int FTPHost::FetchDirectoryListing(std::string_view _path,
 
 int FTPHost::GetListingForFetching(CURLInstance *_inst,
                                    std::string_view _path,
-                                   std::shared_ptr<Directory> &_cached_dir,
+                                   std::shared_ptr<const Directory> &_cached_dir,
                                    const VFSCancelChecker &_cancel_checker)
 {
     if( _path.empty() || _path[0] != '/' )
@@ -551,7 +551,7 @@ void FTPHost::MakeDirectoryStructureDirty(const char *_path)
 {
     if( auto dir = m_Cache->FindDirectory(_path) ) {
         InformDirectoryChanged(dir->path);
-        dir->dirty_structure = true;
+        m_Cache->MarkDirectoryDirty(dir->path);
     }
 }
 
@@ -601,7 +601,7 @@ bool FTPHost::IsWritable() const
 int FTPHost::IterateDirectoryListing(std::string_view _path,
                                      const std::function<bool(const VFSDirEnt &_dirent)> &_handler)
 {
-    std::shared_ptr<Directory> dir;
+    std::shared_ptr<const Directory> dir;
     const int result = GetListingForFetching(m_ListingInstance.get(), _path, dir, nullptr);
     if( result != 0 )
         return result;
@@ -84,12 +84,12 @@ private:
     int DoInit();
     int DownloadAndCacheListing(ftp::CURLInstance *_inst,
                                 const char *_path,
-                                std::shared_ptr<ftp::Directory> *_cached_dir,
+                                std::shared_ptr<const ftp::Directory> *_cached_dir,
                                 const VFSCancelChecker &_cancel_checker);
 
     int GetListingForFetching(ftp::CURLInstance *_inst,
                               std::string_view _path,
-                              std::shared_ptr<ftp::Directory> &_cached_dir,
+                              std::shared_ptr<const ftp::Directory> &_cached_dir,
                               const VFSCancelChecker &_cancel_checker);
 
     std::unique_ptr<ftp::CURLInstance> SpawnCURL();
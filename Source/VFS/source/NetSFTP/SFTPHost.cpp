@@ -995,6 +995,115 @@ int SFTPHost::SetTimes(std::string_view _path,
         return VFSErrorForConnection(*conn);
 }
 
+int SFTPHost::SetAttributes(std::span<const AttributesChange> _changes,
+                            std::span<AttributesChangeResult> _results,
+                            const VFSCancelChecker &_cancel_checker)
+{
+    if( _changes.size() != _results.size() )
+        return VFSError::InvalidCall;
+
+    // All changes are sent via a single connection and each item normally costs a single SETSTAT round trip.
+    // libssh2 allows only one outstanding stat request per SFTP session, so the requests can't be pipelined further.
+    std::unique_ptr<Connection> conn;
+    if( const int rc = GetConnection(conn); rc < 0 )
+        return rc;
+
+    const AutoConnectionReturn acr(conn, this);
+
+    const auto setstat = [&](const std::string &_path, LIBSSH2_SFTP_ATTRIBUTES &_attrs) {
+        const auto rc = libssh2_sftp_stat_ex(
+            conn->sftp, _path.c_str(), static_cast<unsigned>(_path.length()), LIBSSH2_SFTP_SETSTAT, &_attrs);
+        return rc == 0 ? VFSError::Ok : VFSErrorForConnection(*conn);
+    };
+
+    using Step = AttributesChangeResult::Step;
+    for( size_t i = 0; i != _changes.size(); ++i ) {
+        if( _cancel_checker && _cancel_checker() )
+            return VFSError::Cancelled;
+
+        const AttributesChange &change = _changes[i];
+        AttributesChangeResult &result = _results[i];
+        result = {};
+
+        // SFTP can only set both access and modification times at once, birth and change times are ignored
+        std::optional<time_t> mtime = change.mtime;
+        std::optional<time_t> atime = change.atime;
+        int times_rc = VFSError::Ok;
+        if( mtime.has_value() != atime.has_value() ) {
+            LIBSSH2_SFTP_ATTRIBUTES attrs;
+            const int rc = libssh2_sftp_stat_ex(conn->sftp,
+                                                change.path.c_str(),
+                                                static_cast<unsigned>(change.path.length()),
+                                                LIBSSH2_SFTP_LSTAT,
+                                                &attrs);
+            if( rc != 0 )
+                times_rc = VFSErrorForConnection(*conn);
+            else if( !(attrs.flags & LIBSSH2_SFTP_ATTR_ACMODTIME) )
+                times_rc = VFSError::NotSupported;
+            else {
+                mtime = mtime.value_or(attrs.mtime);
+                atime = atime.value_or(attrs.atime);
+            }
+        }
+        const bool set_times = times_rc == VFSError::Ok && mtime && atime;
+
+        LIBSSH2_SFTP_ATTRIBUTES perm_attrs;
+        memset(&perm_attrs, 0, sizeof(perm_attrs));
+        if( change.permissions ) {
+            perm_attrs.flags = LIBSSH2_SFTP_ATTR_PERMISSIONS;
+            perm_attrs.permissions = *change.permissions;
+        }
+        LIBSSH2_SFTP_ATTRIBUTES own_attrs;
+        memset(&own_attrs, 0, sizeof(own_attrs));
+        if( change.ownership ) {
+            own_attrs.flags = LIBSSH2_SFTP_ATTR_UIDGID;
+            own_attrs.uid = change.ownership->uid;
+            own_attrs.gid = change.ownership->gid;
+        }
+        LIBSSH2_SFTP_ATTRIBUTES time_attrs;
+        memset(&time_attrs, 0, sizeof(time_attrs));
+        if( set_times ) {
+            time_attrs.flags = LIBSSH2_SFTP_ATTR_ACMODTIME;
+            time_attrs.atime = *atime;
+            time_attrs.mtime = *mtime;
+        }
+
+        LIBSSH2_SFTP_ATTRIBUTES attrs;
+        memset(&attrs, 0, sizeof(attrs));
+        attrs.flags = perm_attrs.flags | own_attrs.flags | time_attrs.flags;
+        attrs.permissions = perm_attrs.permissions;
+        attrs.uid = own_attrs.uid;
+        attrs.gid = own_attrs.gid;
+        attrs.atime = time_attrs.atime;
+        attrs.mtime = time_attrs.mtime;
+
+        if( attrs.flags != 0 && setstat(change.path, attrs) != VFSError::Ok ) {
+            // the combined request failed - find out which step is the culprit by applying them one by one
+            if( perm_attrs.flags != 0 )
+                if( const int rc = setstat(change.path, perm_attrs); rc != VFSError::Ok ) {
+                    result = {Step::Permissions, rc};
+                    continue;
+                }
+            if( own_attrs.flags != 0 )
+                if( const int rc = setstat(change.path, own_attrs); rc != VFSError::Ok ) {
+                    result = {Step::Ownership, rc};
+                    continue;
+                }
+            if( time_attrs.flags != 0 )
+                if( const int rc = setstat(change.path, time_attrs); rc != VFSError::Ok ) {
+                    result = {Step::Times, rc};
+                    continue;
+                }
+        }
+
+        if( change.flags )
+            result = {Step::Flags, VFSError::NotSupported};
+        else if( times_rc != VFSError::Ok )
+            result = {Step::Times, times_rc};
+    }
+    return VFSError::Ok;
+}
+
 int SFTPHost::FetchUsers(std::vector<VFSUser> &_target, [[maybe_unused]] const VFSCancelChecker &_cancel_checker)
 {
     if( m_OSType == sftp::OSType::Unknown )
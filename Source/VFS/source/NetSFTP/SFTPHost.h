@@ -85,6 +85,9 @@ public:
                          std::optional<time_t> _chg_time,
                          std::optional<time_t> _acc_time,
                          const VFSCancelChecker &_cancel_checker = {}) override;
+    virtual int SetAttributes(std::span<const AttributesChange> _changes,
+                              std::span<AttributesChangeResult> _results,
+                              const VFSCancelChecker &_cancel_checker = {}) override;
     virtual int FetchUsers(std::vector<VFSUser> &_target, const VFSCancelChecker &_cancel_checker = {}) override;
     virtual int FetchGroups(std::vector<VFSGroup> &_target, const VFSCancelChecker &_cancel_checker = {}) override;
 
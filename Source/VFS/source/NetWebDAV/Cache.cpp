@@ -13,26 +13,36 @@ using namespace std::literals;
 
 static const auto g_ListingTimeout = 60s;
 
-Cache::Cache() = default;
+// an approximate bound of the items kept in the cache
+static const size_t g_MaxCachedItems = 250'000;
+
+Cache::Cache()
+    : m_Dirs(g_ListingTimeout, g_MaxCachedItems, [](const Directory &_directory) { return _directory.items.size() + 1; })
+{
+}
 
 Cache::~Cache() = default;
 
+template <class Items>
+static auto FindItem(Items &_items, std::string_view _filename)
+{
+    // NOLINTBEGIN
+    return std::lower_bound(std::begin(_items), std::end(_items), _filename, [](auto &_1, auto &_2) {
+        return _1.filename < _2;
+    });
+    // NOLINTEND
+}
+
 void Cache::CommitListing(const std::string &_at_path, std::vector<PropFindResponse> _items)
 {
     const auto path = EnsureTrailingSlash(_at_path);
-    const auto time = base::machtime();
 
     std::ranges::sort(_items, [](const auto &_1st, const auto &_2nd) { return _1st.filename < _2nd.filename; });
 
-    {
-        const auto lock = std::lock_guard{m_Lock};
-        auto &directory = m_Dirs[path];
-        directory.fetch_time = time;
-        directory.has_dirty_items = false;
-        directory.items = std::move(_items);
-        directory.dirty_marks.resize(directory.items.size());
-        std::ranges::fill(directory.dirty_marks, false);
-    }
+    auto directory = std::make_shared<Directory>();
+    directory->items = std::move(_items);
+    directory->dirty_marks.resize(directory->items.size(), false);
+    m_Dirs.Insert(path, std::move(directory));
 
     Notify(path);
 }
@@ -41,17 +51,12 @@ std::optional<std::vector<PropFindResponse>> Cache::Listing(const std::string &_
 {
     const auto path = EnsureTrailingSlash(_at_path);
 
-    const auto lock = std::lock_guard{m_Lock};
-
-    const auto it = m_Dirs.find(path);
-    if( it == end(m_Dirs) )
+    const auto listing = m_Dirs.Find(path);
+    if( listing == nullptr )
         return std::nullopt;
-    const auto &listing = it->second;
-    if( listing.has_dirty_items )
+    if( listing->has_dirty_items )
         return std::nullopt;
-    if( IsOutdated(listing) )
-        return std::nullopt;
-    return listing.items;
+    return listing->items;
 }
 
 std::pair<std::optional<PropFindResponse>, Cache::E> Cache::Item(std::string_view _at_path) const
@@ -60,28 +65,16 @@ std::pair<std::optional<PropFindResponse>, Cache::E> Cache::Item(std::string_vie
     if( filename.empty() )
         return {std::nullopt, E::NonExist};
 
-    const auto lock = std::lock_guard{m_Lock};
-
-    const auto dir_it = m_Dirs.find(directory);
-    if( dir_it == end(m_Dirs) )
+    const auto listing = m_Dirs.Find(directory);
+    if( listing == nullptr )
         return {std::nullopt, E::Unknown};
 
-    const auto &listing = dir_it->second;
-
-    if( IsOutdated(listing) )
-        return {std::nullopt, E::Unknown};
-
-    // NOLINTBEGIN
-    const auto item =
-        std::lower_bound(std::begin(listing.items), std::end(listing.items), filename, [](auto &_1, auto &_2) {
-            return _1.filename < _2;
-        });
-    // NOLINTEND
-    if( item == std::end(listing.items) || item->filename != filename )
+    const auto item = FindItem(listing->items, filename);
+    if( item == std::end(listing->items) || item->filename != filename )
         return {std::nullopt, E::NonExist};
 
-    const auto index = std::distance(begin(listing.items), item);
-    if( listing.dirty_marks[index] )
+    const auto index = std::distance(begin(listing->items), item);
+    if( listing->dirty_marks[index] )
         return {std::nullopt, E::Unknown};
 
     return {*item, E::Ok};
@@ -89,14 +82,7 @@ std::pair<std::optional<PropFindResponse>, Cache::E> Cache::Item(std::string_vie
 
 void Cache::DiscardListing(const std::string &_at_path)
 {
-    const auto path = EnsureTrailingSlash(_at_path);
-    const auto lock = std::lock_guard{m_Lock};
-    m_Dirs.erase(path);
-}
-
-bool Cache::IsOutdated(const Directory &_listing)
-{
-    return _listing.fetch_time + g_ListingTimeout < base::machtime();
+    m_Dirs.Erase(EnsureTrailingSlash(_at_path));
 }
 
 void Cache::CommitMkDir(const std::string &_at_path)
@@ -105,35 +91,25 @@ void Cache::CommitMkDir(const std::string &_at_path)
     if( filename.empty() )
         return;
 
-    {
-        const auto lock = std::lock_guard{m_Lock};
-
-        const auto dir_it = m_Dirs.find(directory);
-        if( dir_it == end(m_Dirs) )
-            return;
-
-        auto &listing = dir_it->second;
-        // NOLINTBEGIN
-        const auto item_it = lower_bound(
-            begin(listing.items), end(listing.items), filename, [](auto &_1, auto &_2) { return _1.filename < _2; });
-        // NOLINTEND
-        if( item_it == end(listing.items) || item_it->filename != filename ) {
+    const bool updated = m_Dirs.Update(directory, [&, &filename = filename](Directory &_listing) {
+        const auto item_it = FindItem(_listing.items, filename);
+        if( item_it == end(_listing.items) || item_it->filename != filename ) {
             PropFindResponse r;
             r.filename = filename;
             r.is_directory = true;
-            const auto index = distance(begin(listing.items), item_it);
-            listing.items.insert(item_it, std::move(r));
-            listing.dirty_marks.insert(begin(listing.dirty_marks) + index, true);
+            const auto index = distance(begin(_listing.items), item_it);
+            _listing.items.insert(item_it, std::move(r));
+            _listing.dirty_marks.insert(begin(_listing.dirty_marks) + index, true);
         }
         else {
-            const auto index = distance(begin(listing.items), item_it);
-            listing.dirty_marks[index] = true;
+            const auto index = distance(begin(_listing.items), item_it);
+            _listing.dirty_marks[index] = true;
         }
+        _listing.has_dirty_items = true;
+    });
 
-        listing.has_dirty_items = true;
-    }
-
-    Notify(directory);
+    if( updated )
+        Notify(directory);
 }
 
 void Cache::CommitMkFile(const std::string &_at_path)
@@ -142,34 +118,24 @@ void Cache::CommitMkFile(const std::string &_at_path)
     if( filename.empty() )
         return;
 
-    {
-        const auto lock = std::lock_guard{m_Lock};
-
-        const auto dir_it = m_Dirs.find(directory);
-        if( dir_it == end(m_Dirs) )
-            return;
-
-        auto &listing = dir_it->second;
-        // NOLINTBEGIN
-        const auto item_it = lower_bound(
-            begin(listing.items), end(listing.items), filename, [](auto &_1, auto &_2) { return _1.filename < _2; });
-        // NOLINTEND
-        const auto index = distance(begin(listing.items), item_it);
-        if( item_it == end(listing.items) || item_it->filename != filename ) {
+    const bool updated = m_Dirs.Update(directory, [&, &filename = filename](Directory &_listing) {
+        const auto item_it = FindItem(_listing.items, filename);
+        const auto index = distance(begin(_listing.items), item_it);
+        if( item_it == end(_listing.items) || item_it->filename != filename ) {
             PropFindResponse r;
             r.filename = filename;
             r.is_directory = false;
-            listing.items.insert(item_it, std::move(r));
-            listing.dirty_marks.insert(begin(listing.dirty_marks) + index, true);
+            _listing.items.insert(item_it, std::move(r));
+            _listing.dirty_marks.insert(begin(_listing.dirty_marks) + index, true);
         }
         else {
-            listing.dirty_marks[index] = true;
+            _listing.dirty_marks[index] = true;
         }
+        _listing.has_dirty_items = true;
+    });
 
-        listing.has_dirty_items = true;
-    }
-
-    Notify(directory);
+    if( updated )
+        Notify(directory);
 }
 
 void Cache::CommitRmDir(const std::string &_at_path)
@@ -184,103 +150,65 @@ void Cache::CommitUnlink(std::string_view _at_path)
     if( filename.empty() )
         return;
 
-    {
-        const auto lock = std::lock_guard{m_Lock};
-
-        const auto dir_it = m_Dirs.find(directory);
-        if( dir_it == end(m_Dirs) )
-            return;
-
-        auto &listing = dir_it->second;
-        // NOLINTBEGIN
-        const auto item_it = lower_bound(
-            begin(listing.items), end(listing.items), filename, [](auto &_1, auto &_2) { return _1.filename < _2; });
-        // NOLINTEND
-        if( item_it != end(listing.items) && item_it->filename == filename ) {
-            const auto index = distance(begin(listing.items), item_it);
-            listing.items.erase(item_it);
-            listing.dirty_marks.erase(begin(listing.dirty_marks) + index);
+    const bool updated = m_Dirs.Update(directory, [&, &filename = filename](Directory &_listing) {
+        const auto item_it = FindItem(_listing.items, filename);
+        if( item_it != end(_listing.items) && item_it->filename == filename ) {
+            const auto index = distance(begin(_listing.items), item_it);
+            _listing.items.erase(item_it);
+            _listing.dirty_marks.erase(begin(_listing.dirty_marks) + index);
         }
-        listing.has_dirty_items = true;
-    }
+        _listing.has_dirty_items = true;
+    });
 
-    Notify(directory);
+    if( updated )
+        Notify(directory);
 }
 
 void Cache::CommitMove(std::string_view _old_path, std::string_view _new_path)
 {
-    {
-        const auto lock = std::lock_guard{m_Lock};
-
-        const auto dir_it = m_Dirs.find(EnsureTrailingSlash(std::string(_old_path)));
-        if( dir_it != end(m_Dirs) ) {
-            m_Dirs[EnsureTrailingSlash(std::string(_new_path))] = std::move(dir_it->second);
-            m_Dirs.erase(dir_it);
-        }
-    }
+    m_Dirs.Move(EnsureTrailingSlash(std::string(_old_path)), EnsureTrailingSlash(std::string(_new_path)));
 
     const auto [old_directory, old_filename] = DeconstructPath(_old_path);
     if( old_filename.empty() )
         return;
 
     std::optional<PropFindResponse> entry;
-
-    {
-        const auto lock = std::lock_guard{m_Lock};
-        const auto dir_it = m_Dirs.find(old_directory);
-        if( dir_it == end(m_Dirs) )
-            return;
-
-        auto &listing = dir_it->second;
-        // NOLINTBEGIN
-        const auto item_it =
-            lower_bound(begin(listing.items), end(listing.items), old_filename, [](auto &_1, auto &_2) {
-                return _1.filename < _2;
-            });
-        // NOLINTEND
-        if( item_it != end(listing.items) && item_it->filename == old_filename ) {
+    const bool updated_old = m_Dirs.Update(old_directory, [&, &old_filename = old_filename](Directory &_listing) {
+        const auto item_it = FindItem(_listing.items, old_filename);
+        if( item_it != end(_listing.items) && item_it->filename == old_filename ) {
             entry = std::move(*item_it);
-            const auto index = distance(begin(listing.items), item_it);
-            listing.items.erase(item_it);
-            listing.dirty_marks.erase(begin(listing.dirty_marks) + index);
+            const auto index = distance(begin(_listing.items), item_it);
+            _listing.items.erase(item_it);
+            _listing.dirty_marks.erase(begin(_listing.dirty_marks) + index);
         }
-    }
+    });
+    if( !updated_old )
+        return;
     Notify(old_directory);
 
     const auto [new_directory, new_filename] = DeconstructPath(_new_path);
     if( new_filename.empty() )
         return;
 
-    {
-        const auto lock = std::lock_guard{m_Lock};
-
-        const auto dir_it = m_Dirs.find(new_directory);
-        if( dir_it == end(m_Dirs) )
+    const bool updated_new = m_Dirs.Update(new_directory, [&, &new_filename = new_filename](Directory &_listing) {
+        _listing.has_dirty_items = true;
+        if( !entry )
             return;
-        auto &listing = dir_it->second;
-        listing.has_dirty_items = true;
-
-        if( entry ) {
-            entry->filename = new_filename;
-            // NOLINTBEGIN
-            const auto item_it = std::lower_bound(std::begin(listing.items),
-                                                  std::end(listing.items),
-                                                  new_filename,
-                                                  [](auto &_1, auto &_2) { return _1.filename < _2; });
-            // NOLINTEND
-            const auto index = std::distance(std::begin(listing.items), item_it);
-            if( item_it == std::end(listing.items) || item_it->filename != new_filename ) {
-                listing.items.insert(item_it, std::move(*entry));
-                listing.dirty_marks.insert(std::begin(listing.dirty_marks) + index, true);
-            }
-            else {
-                *item_it = std::move(*entry);
-                listing.dirty_marks[index] = true;
-            }
+        entry->filename = new_filename;
+        const auto item_it = FindItem(_listing.items, new_filename);
+        const auto index = std::distance(std::begin(_listing.items), item_it);
+        if( item_it == std::end(_listing.items) || item_it->filename != new_filename ) {
+            _listing.items.insert(item_it, std::move(*entry));
+            _listing.dirty_marks.insert(std::begin(_listing.dirty_marks) + index, true);
         }
-    }
+        else {
+            *item_it = std::move(*entry);
+            _listing.dirty_marks[index] = true;
+        }
+    });
 
-    Notify(new_directory);
+    if( updated_new )
+        Notify(new_directory);
 }
 
 void Cache::Notify(const std::string &_changed_dir_path)
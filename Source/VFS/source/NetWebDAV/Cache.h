@@ -1,6 +1,7 @@
 // Copyright (C) 2017-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
+#include "../DirectoryCache.h"
 #include <chrono>
 #include <string>
 #include <unordered_map>
@@ -42,7 +43,6 @@ public:
 
 private:
     struct Directory {
-        std::chrono::nanoseconds fetch_time = std::chrono::nanoseconds{0};
         bool has_dirty_items = false;
 
         std::vector<PropFindResponse> items; // sorted by .filename
@@ -54,10 +54,8 @@ private:
     };
 
     void Notify(const std::string &_changed_dir_path);
-    static bool IsOutdated(const Directory &);
 
-    std::unordered_map<std::string, Directory> m_Dirs;
-    mutable std::mutex m_Lock;
+    DirectoryCache<Directory> m_Dirs;
 
     std::atomic_ulong m_LastTicket{1};
     std::unordered_multimap<std::string, Observer> m_Observers;
@@ -3,6 +3,7 @@
 #include <sys/stat.h>
 #include <VFS/FileWindow.h>
 #include <VFS/SearchInFile.h>
+#include <VFS/MultiSearchInFile.h>
 
 namespace nc::vfs {
 
@@ -48,6 +49,15 @@ void SearchForFiles::SetFilterContent(const FilterContent &_filter)
     if( IsRunning() )
         throw std::logic_error("Filters can't be changed during background search process");
     m_FilterContent = _filter;
+    m_MultiSearch.reset();
+    if( _filter.mode == FilterContent::Mode::Texts ) {
+        auto options = SearchInFile::Options::None;
+        if( _filter.case_sensitive )
+            options |= SearchInFile::Options::CaseSensitive;
+        if( _filter.whole_phrase )
+            options |= SearchInFile::Options::FindWholePhrase;
+        m_MultiSearch = std::make_unique<MultiSearchInFile>(_filter.texts, options);
+    }
 }
 
 void SearchForFiles::SetFilterSize(const FilterSize &_filter)
@@ -65,6 +75,7 @@ void SearchForFiles::ClearFilters()
         throw std::logic_error("Filters can't be changed during background search process");
     m_FilterName = {};
     m_FilterContent = std::nullopt;
+    m_MultiSearch.reset();
     m_FilterSize = std::nullopt;
 }
 
@@ -180,13 +191,14 @@ void SearchForFiles::ProcessDirent(const char *_full_path,
 
     // Filter by file content
     CFRange content_pos{-1, 0};
+    std::vector<CFRange> texts_pos;
     if( failed_filtering == false && m_FilterContent ) {
-        if( _dirent.type != VFSDirEnt::Reg || !FilterByContent(_full_path, _in_host, content_pos) )
+        if( _dirent.type != VFSDirEnt::Reg || !FilterByContent(_full_path, _in_host, content_pos, texts_pos) )
             failed_filtering = true;
     }
 
     if( failed_filtering == false )
-        ProcessValidEntry(_full_path, _dir_path, _dirent, _in_host, content_pos);
+        ProcessValidEntry(_full_path, _dir_path, _dirent, _in_host, content_pos, texts_pos);
 
     if( m_SearchOptions & Options::GoIntoSubDirs )
         if( _dirent.type == VFSDirEnt::Dir )
@@ -198,10 +210,14 @@ void SearchForFiles::ProcessDirent(const char *_full_path,
                 m_DirsFIFO.emplace(archive_host, "/");
 }
 
-bool SearchForFiles::FilterByContent(const char *_full_path, VFSHost &_in_host, CFRange &_r)
+bool SearchForFiles::FilterByContent(const char *_full_path,
+                                     VFSHost &_in_host,
+                                     CFRange &_r,
+                                     std::vector<CFRange> &_texts_r)
 {
     assert(m_FilterContent);
     _r = CFRangeMake(-1, 0);
+    _texts_r.clear();
 
     VFSFilePtr file;
     if( _in_host.CreateFile(_full_path, file, nullptr) != 0 )
@@ -220,11 +236,26 @@ bool SearchForFiles::FilterByContent(const char *_full_path, VFSHost &_in_host,
     if( const utility::Encoding xattr_enc = EncodingFromXAttr(file); xattr_enc != utility::Encoding::ENCODING_INVALID )
         encoding = xattr_enc;
 
+    if( m_FilterContent->mode == FilterContent::Mode::Texts )
+        return FilterByTexts(fw, encoding, _r, _texts_r);
+
     using nc::vfs::SearchInFile;
     SearchInFile sif(fw);
 
-    const base::CFString request{m_FilterContent->text};
-    sif.ToggleTextSearch(*request, encoding);
+    switch( m_FilterContent->mode ) {
+        case FilterContent::Mode::Text:
+            sif.ToggleTextSearch(*base::CFString{m_FilterContent->text}, encoding);
+            break;
+        case FilterContent::Mode::Regex:
+            sif.ToggleRegexSearch(m_FilterContent->text, encoding);
+            break;
+        case FilterContent::Mode::Hex:
+            if( auto pattern = SearchInFile::BytesPattern::FromHex(m_FilterContent->text) )
+                sif.ToggleBytesSearch(*pattern);
+            else
+                return false;
+            break;
+    }
     const auto search_options = [&] {
         auto options = SearchInFile::Options::None;
         if( m_FilterContent->case_sensitive )
@@ -247,6 +278,33 @@ bool SearchForFiles::FilterByContent(const char *_full_path, VFSHost &_in_host,
     return false;
 }
 
+bool SearchForFiles::FilterByTexts(FileWindow &_fw,
+                                   utility::Encoding _encoding,
+                                   CFRange &_r,
+                                   std::vector<CFRange> &_texts_r)
+{
+    assert(m_MultiSearch);
+    const auto composition =
+        m_FilterContent->all_texts ? MultiSearchInFile::Composition::All : MultiSearchInFile::Composition::Any;
+    const auto result = m_MultiSearch->Search(_fw, _encoding, composition, [this] { return m_Queue.IsStopped(); });
+    for( const auto &location : result.locations ) {
+        if( location ) {
+            _texts_r.push_back(CFRangeMake(location->offset, location->bytes_len));
+            if( _r.location < 0 || location->offset < static_cast<uint64_t>(_r.location) )
+                _r = _texts_r.back(); // report the earliest of the texts as the found content
+        }
+        else {
+            _texts_r.push_back(CFRangeMake(-1, 0));
+        }
+    }
+
+    if( result.response == SearchInFile::Response::Found )
+        return m_FilterContent->not_containing == false;
+    if( result.response == SearchInFile::Response::NotFound )
+        return m_FilterContent->not_containing == true;
+    return false;
+}
+
 bool SearchForFiles::FilterByFilename(const char *_filename) const
 {
     return m_FilterName.MatchName(_filename);
@@ -256,10 +314,11 @@ void SearchForFiles::ProcessValidEntry([[maybe_unused]] const char *_full_path,
                                        const char *_dir_path,
                                        const VFSDirEnt &_dirent,
                                        VFSHost &_in_host,
-                                       CFRange _cont_range)
+                                       CFRange _cont_range,
+                                       std::span<const CFRange> _texts_ranges)
 {
     if( m_Callback ) // change to assert
-        m_Callback(_dirent.name, _dir_path, _in_host, _cont_range);
+        m_Callback(_dirent.name, _dir_path, _in_host, _cont_range, _texts_ranges);
 }
 
 bool SearchForFiles::IsRunning() const noexcept
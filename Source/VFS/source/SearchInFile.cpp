@@ -2,13 +2,29 @@
 #include "SearchInFile.h"
 #include <Utility/Encodings.h>
 #include <VFS/FileWindow.h>
+#include <re2/re2.h>
+#include <algorithm>
+#include <bit>
 #include <exception>
+#include <functional>
+#include <span>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace nc::vfs {
 
 static const unsigned g_MaximumCodeUnit = 2;
 
 static bool IsWholePhrase(CFStringRef _string, CFRange _range);
+static bool
+IsWholePhrase(std::span<const unsigned char> _window, size_t _location, size_t _length, utility::Encoding _encoding);
+static std::vector<unsigned char> EncodeSingleByte(CFStringRef _string, utility::Encoding _encoding);
+static std::optional<size_t> FindBytes(std::span<const std::byte> _haystack,
+                                       const SearchInFile::BytesPattern &_pattern);
 
 SearchInFile::SearchInFile(nc::vfs::FileWindow &_file)
     : m_File(_file), m_TextSearchEncoding(utility::Encoding::ENCODING_INVALID)
@@ -49,26 +65,43 @@ void SearchInFile::ToggleTextSearch(CFStringRef _string, utility::Encoding _enco
         CFRelease(m_RequestedTextSearch);
     m_RequestedTextSearch = CFStringCreateCopy(nullptr, _string);
     m_TextSearchEncoding = _encoding;
+    m_EncodedTextSearch = EncodeSingleByte(m_RequestedTextSearch, m_TextSearchEncoding);
 
     m_WorkMode = WorkMode::Text;
 }
 
+void SearchInFile::ToggleRegexSearch(std::string_view _pattern, utility::Encoding _encoding)
+{
+    m_RegexPattern = _pattern;
+    m_RegexEncoding = _encoding;
+    m_Regex.reset();
+    m_WorkMode = WorkMode::Regex;
+}
+
+void SearchInFile::ToggleBytesSearch(const BytesPattern &_pattern)
+{
+    assert(_pattern.bytes.size() == _pattern.mask.size());
+    m_BytesPattern = _pattern;
+    m_WorkMode = WorkMode::Bytes;
+}
+
 SearchInFile::Result SearchInFile::Search(const CancelChecker &_checker)
 {
-    if( m_WorkMode == WorkMode::Text ) {
-        uint64_t offset = 0;
-        uint64_t bytes_len = 0;
-        Result result;
+    uint64_t offset = 0;
+    uint64_t bytes_len = 0;
+    Result result;
+    if( m_WorkMode == WorkMode::Text )
         result.response = SearchText(&offset, &bytes_len, _checker);
-        if( result.response == Response::Found )
-            result.location = {.offset = offset, .bytes_len = bytes_len};
-        return result;
-    }
-    else {
-        Result result;
+    else if( m_WorkMode == WorkMode::Regex )
+        result.response = SearchRegex(&offset, &bytes_len, _checker);
+    else if( m_WorkMode == WorkMode::Bytes )
+        result.response = SearchBytes(&offset, &bytes_len, _checker);
+    else
         result.response = Response::NotFound;
-        return result;
-    }
+
+    if( result.response == Response::Found )
+        result.location = {.offset = offset, .bytes_len = bytes_len};
+    return result;
 }
 
 bool SearchInFile::IsEOF() const
@@ -90,6 +123,8 @@ SearchInFile::Response SearchInFile::SearchText(uint64_t *_offset, uint64_t *_by
     if( CFStringGetLength(m_RequestedTextSearch) <= 0 )
         return Response::Invalid;
 
+    const std::boyer_moore_horspool_searcher searcher(m_EncodedTextSearch.begin(), m_EncodedTextSearch.end());
+
     while( true ) {
         if( m_Position >= m_File.FileSize() )
             break; // when finished searching
@@ -108,64 +143,285 @@ SearchInFile::Response SearchInFile::SearchText(uint64_t *_offset, uint64_t *_by
         assert(m_Position >= m_File.WindowPos() &&
                m_Position < m_File.WindowPos() + m_File.WindowSize()); // sanity check
 
-        // get UniChars from this window using given encoding
-        assert(utility::BytesForCodeUnit(m_TextSearchEncoding) <= 2); // TODO: support for UTF-32 in the future
-        const bool isodd = (utility::BytesForCodeUnit(m_TextSearchEncoding) == 2) && ((m_File.WindowPos() & 1) == 1);
-        utility::InterpretAsUnichar(m_TextSearchEncoding,
-                                    static_cast<const unsigned char *>(m_File.Window()) + left_window_gap +
-                                        (isodd ? 1 : 0),
-                                    m_File.WindowSize() - left_window_gap - (isodd ? 1 : 0),
-                                    m_DecodedBuffer.get(),
-                                    m_DecodedBufferIndx.get(),
-                                    &m_DecodedBufferSize);
-
-        assert(m_DecodedBufferSize != 0);
-
-        // use this UniChars to produce a regular CFString
-        if( m_DecodedBufferString != nullptr )
-            CFRelease(m_DecodedBufferString);
-        m_DecodedBufferString =
-            CFStringCreateWithCharactersNoCopy(nullptr, m_DecodedBuffer.get(), m_DecodedBufferSize, kCFAllocatorNull);
-
-        const auto find_flags = m_SearchOptionsBits.case_sensitive ? 0 : kCFCompareCaseInsensitive;
-        const CFRange result = CFStringFind(m_DecodedBufferString, m_RequestedTextSearch, find_flags);
-
-        if( result.location == kCFNotFound ) {
-            // lets proceed further
-            if( m_File.WindowPos() + m_File.WindowSize() < m_File.FileSize() ) { // can move on
-                // left some space in the tail to exclude situations when searched text is cut
-                // between the windows
-                assert(left_window_gap == 0);
-                assert(size_t(CFStringGetLength(m_RequestedTextSearch) * g_MaximumCodeUnit) < m_File.WindowSize());
-                m_Position =
-                    m_Position + m_File.WindowSize() - CFStringGetLength(m_RequestedTextSearch) * g_MaximumCodeUnit;
-            }
-            else { // this is the end (c)
-                m_Position = m_File.FileSize();
+        if( m_SearchOptionsBits.case_sensitive && !m_EncodedTextSearch.empty() ) {
+            // a single-byte encoding with a representable needle - look for the raw bytes, no decoding required
+            const auto window = std::span<const unsigned char>(
+                static_cast<const unsigned char *>(m_File.Window()) + left_window_gap,
+                m_File.WindowSize() - left_window_gap);
+            const auto found = std::search(window.begin(), window.end(), searcher);
+            if( found != window.end() ) {
+                const size_t location = found - window.begin();
+                const size_t length = m_EncodedTextSearch.size();
+                m_Position = m_Position + location + length;
+                if( m_SearchOptionsBits.find_whole_phrase &&
+                    !IsWholePhrase(window, location, length, m_TextSearchEncoding) )
+                    continue; // false alarm - just move position beyond found part and go on
+
+                if( _offset != nullptr )
+                    *_offset = m_Position - length;
+                if( _bytes_len != nullptr )
+                    *_bytes_len = length;
+                return Response::Found;
             }
         }
         else {
-            assert(size_t(result.location + result.length) <= m_DecodedBufferSize); // sanity check
-            // check for whole phrase is this option is set
-            if( m_SearchOptionsBits.find_whole_phrase && !IsWholePhrase(m_DecodedBufferString, result) ) {
-                // false alarm - just move position beyond found part ang go on
+            // get UniChars from this window using given encoding
+            assert(utility::BytesForCodeUnit(m_TextSearchEncoding) <= 2); // TODO: support for UTF-32 in the future
+            const bool isodd =
+                (utility::BytesForCodeUnit(m_TextSearchEncoding) == 2) && ((m_File.WindowPos() & 1) == 1);
+            utility::InterpretAsUnichar(m_TextSearchEncoding,
+                                        static_cast<const unsigned char *>(m_File.Window()) + left_window_gap +
+                                            (isodd ? 1 : 0),
+                                        m_File.WindowSize() - left_window_gap - (isodd ? 1 : 0),
+                                        m_DecodedBuffer.get(),
+                                        m_DecodedBufferIndx.get(),
+                                        &m_DecodedBufferSize);
+
+            assert(m_DecodedBufferSize != 0);
+
+            // use this UniChars to produce a regular CFString
+            if( m_DecodedBufferString != nullptr )
+                CFRelease(m_DecodedBufferString);
+            m_DecodedBufferString = CFStringCreateWithCharactersNoCopy(
+                nullptr, m_DecodedBuffer.get(), m_DecodedBufferSize, kCFAllocatorNull);
+
+            const auto find_flags = m_SearchOptionsBits.case_sensitive ? 0 : kCFCompareCaseInsensitive;
+            const CFRange result = CFStringFind(m_DecodedBufferString, m_RequestedTextSearch, find_flags);
+
+            if( result.location != kCFNotFound ) {
+                assert(size_t(result.location + result.length) <= m_DecodedBufferSize); // sanity check
+                // check for whole phrase is this option is set
+                if( m_SearchOptionsBits.find_whole_phrase && !IsWholePhrase(m_DecodedBufferString, result) ) {
+                    // false alarm - just move position beyond found part ang go on
+                    m_Position = m_Position + m_DecodedBufferIndx[result.location + result.length];
+                    continue;
+                }
+
+                if( _offset != nullptr )
+                    *_offset = m_Position + m_DecodedBufferIndx[result.location];
+
+                if( _offset != nullptr )
+                    *_bytes_len = (size_t(result.location + result.length) < m_DecodedBufferSize
+                                       ? m_DecodedBufferIndx[result.location + result.length]
+                                       : m_File.WindowSize() - left_window_gap) -
+                                  m_DecodedBufferIndx[result.location];
                 m_Position = m_Position + m_DecodedBufferIndx[result.location + result.length];
+                return Response::Found;
+            }
+        }
+
+        // lets proceed further
+        if( m_File.WindowPos() + m_File.WindowSize() < m_File.FileSize() ) { // can move on
+            // left some space in the tail to exclude situations when searched text is cut
+            // between the windows
+            assert(left_window_gap == 0);
+            assert(size_t(CFStringGetLength(m_RequestedTextSearch) * g_MaximumCodeUnit) < m_File.WindowSize());
+            m_Position =
+                m_Position + m_File.WindowSize() - CFStringGetLength(m_RequestedTextSearch) * g_MaximumCodeUnit;
+        }
+        else { // this is the end (c)
+            m_Position = m_File.FileSize();
+        }
+    }
+
+    return Response::NotFound;
+}
+
+SearchInFile::Response SearchInFile::SearchRegex(uint64_t *_offset, uint64_t *_bytes_len, const CancelChecker &_checker)
+{
+    if( m_File.FileSize() == 0 )
+        return Response::NotFound; // for singular case
+
+    if( m_Position >= m_File.FileSize() )
+        return Response::EndOfFile; // when finished searching
+
+    if( m_RegexPattern.empty() )
+        return Response::Invalid;
+
+    if( m_Regex == nullptr || m_RegexOptions != m_SearchOptions ) {
+        re2::RE2::Options options;
+        options.set_log_errors(false);
+        options.set_case_sensitive(m_SearchOptionsBits.case_sensitive);
+        // '^' and '$' should match at the lines' boundaries, not only at the window's ones
+        const std::string pattern = m_SearchOptionsBits.find_whole_phrase ? "(?m)\\b(?:" + m_RegexPattern + ")\\b"
+                                                                          : "(?m)" + m_RegexPattern;
+        m_Regex = std::make_unique<re2::RE2>(pattern, options);
+        m_RegexOptions = m_SearchOptions;
+    }
+    if( !m_Regex->ok() )
+        return Response::Invalid;
+
+    const size_t window_size = m_File.WindowSize();
+    // matches which end past this offset in a window can be cut by the window's end
+    const size_t safe_end = window_size - std::min(MaximumRegexMatchLength, window_size / 4);
+
+    while( m_Position < m_File.FileSize() ) {
+        if( _checker && _checker() )
+            return Response::Canceled;
+
+        // position the window slightly before the search position to provide the context for the lookbehind
+        const uint64_t window_pos =
+            std::min(m_Position - std::min<uint64_t>(m_Position, RegexLookbehind), m_File.FileSize() - window_size);
+        if( m_File.MoveWindow(window_pos) != 0 )
+            return Response::IOErr;
+        const bool is_last = window_pos + window_size >= m_File.FileSize();
+        const size_t start = m_Position - window_pos;
+
+        const std::string_view text = RegexHaystack();
+        const auto to_window = [&](size_t _text_index) -> size_t {
+            return m_TranscodedBufferIndx.empty() ? _text_index : m_TranscodedBufferIndx[_text_index];
+        };
+        size_t text_start = start;
+        if( !m_TranscodedBufferIndx.empty() )
+            text_start = std::lower_bound(m_TranscodedBufferIndx.begin(), m_TranscodedBufferIndx.end(), start) -
+                         m_TranscodedBufferIndx.begin();
+
+        // look for the first non-empty match
+        re2::StringPiece match;
+        bool found = false;
+        while( text_start <= text.size() ) {
+            found = m_Regex->Match(text, text_start, text.size(), re2::RE2::UNANCHORED, &match, 1);
+            if( !found || !match.empty() )
+                break;
+            text_start = match.data() - text.data() + 1;
+            found = false;
+        }
+
+        if( !found ) {
+            m_Position = is_last ? m_File.FileSize() : std::max(m_Position + 1, window_pos + safe_end);
+            continue;
+        }
+
+        const size_t match_begin = to_window(match.data() - text.data());
+        const size_t match_end = to_window(match.data() - text.data() + match.size());
+        if( !is_last && match_end > safe_end ) {
+            // the match might be longer with more data available - search again in a window starting around it
+            const size_t restart = std::min(match_begin, safe_end);
+            if( restart > start ) {
+                m_Position = window_pos + restart;
                 continue;
             }
+        }
 
-            if( _offset != nullptr )
-                *_offset = m_Position + m_DecodedBufferIndx[result.location];
+        if( _offset != nullptr )
+            *_offset = window_pos + match_begin;
+        if( _bytes_len != nullptr )
+            *_bytes_len = match_end - match_begin;
+        m_Position = window_pos + match_end;
+        return Response::Found;
+    }
+
+    return Response::NotFound;
+}
+
+std::string_view SearchInFile::RegexHaystack()
+{
+    const auto window = static_cast<const unsigned char *>(m_File.Window());
+    const size_t window_size = m_File.WindowSize();
+    if( m_RegexEncoding == utility::Encoding::ENCODING_UTF8 ) {
+        m_TranscodedBufferIndx.clear();
+        return {reinterpret_cast<const char *>(window), window_size};
+    }
+
+    // the code units of multibyte encodings are aligned with the beginning of the file
+    const size_t skip = (utility::BytesForCodeUnit(m_RegexEncoding) == 2) && ((m_File.WindowPos() & 1) == 1) ? 1 : 0;
+    utility::InterpretAsUnichar(m_RegexEncoding,
+                                window + skip,
+                                window_size - skip,
+                                m_DecodedBuffer.get(),
+                                m_DecodedBufferIndx.get(),
+                                &m_DecodedBufferSize);
+
+    m_TranscodedBuffer.clear();
+    m_TranscodedBufferIndx.clear();
+    const auto put = [this](uint32_t _code_point, uint32_t _window_index) {
+        unsigned char bytes[4];
+        size_t size = 0;
+        if( _code_point < 0x80 ) {
+            bytes[size++] = static_cast<unsigned char>(_code_point);
+        }
+        else if( _code_point < 0x800 ) {
+            bytes[size++] = static_cast<unsigned char>(0xC0 | (_code_point >> 6));
+            bytes[size++] = static_cast<unsigned char>(0x80 | (_code_point & 0x3F));
+        }
+        else if( _code_point < 0x10000 ) {
+            bytes[size++] = static_cast<unsigned char>(0xE0 | (_code_point >> 12));
+            bytes[size++] = static_cast<unsigned char>(0x80 | ((_code_point >> 6) & 0x3F));
+            bytes[size++] = static_cast<unsigned char>(0x80 | (_code_point & 0x3F));
+        }
+        else {
+            bytes[size++] = static_cast<unsigned char>(0xF0 | (_code_point >> 18));
+            bytes[size++] = static_cast<unsigned char>(0x80 | ((_code_point >> 12) & 0x3F));
+            bytes[size++] = static_cast<unsigned char>(0x80 | ((_code_point >> 6) & 0x3F));
+            bytes[size++] = static_cast<unsigned char>(0x80 | (_code_point & 0x3F));
+        }
+        m_TranscodedBuffer.append(reinterpret_cast<const char *>(bytes), size);
+        m_TranscodedBufferIndx.insert(m_TranscodedBufferIndx.end(), size, _window_index);
+    };
+
+    for( size_t i = 0; i < m_DecodedBufferSize; ++i ) {
+        const uint32_t index = static_cast<uint32_t>(m_DecodedBufferIndx[i] + skip);
+        const uint16_t unit = m_DecodedBuffer[i];
+        if( unit >= 0xD800 && unit < 0xDC00 && i + 1 < m_DecodedBufferSize && m_DecodedBuffer[i + 1] >= 0xDC00 &&
+            m_DecodedBuffer[i + 1] < 0xE000 ) {
+            put(0x10000 + ((uint32_t(unit) - 0xD800) << 10) + (uint32_t(m_DecodedBuffer[i + 1]) - 0xDC00), index);
+            ++i;
+        }
+        else if( unit >= 0xD800 && unit < 0xE000 ) {
+            put(0xFFFD, index); // an unpaired surrogate
+        }
+        else {
+            put(unit, index);
+        }
+    }
+    m_TranscodedBufferIndx.push_back(static_cast<uint32_t>(window_size));
+    return m_TranscodedBuffer;
+}
+
+SearchInFile::Response SearchInFile::SearchBytes(uint64_t *_offset, uint64_t *_bytes_len, const CancelChecker &_checker)
+{
+    const size_t length = m_BytesPattern.bytes.size();
+    if( length == 0 || length != m_BytesPattern.mask.size() )
+        return Response::Invalid;
+
+    if( m_File.FileSize() < length )
+        return Response::NotFound; // for singular case
+
+    if( m_Position >= m_File.FileSize() )
+        return Response::EndOfFile; // when finished searching
+
+    if( length > m_File.WindowSize() )
+        return Response::Invalid;
+
+    while( m_Position + length <= m_File.FileSize() ) {
+        if( _checker && _checker() )
+            return Response::Canceled;
 
+        const uint64_t window_pos = std::min(m_Position, m_File.FileSize() - m_File.WindowSize());
+        if( m_File.MoveWindow(window_pos) != 0 )
+            return Response::IOErr;
+        const size_t left_window_gap = m_Position - window_pos;
+        const auto window = std::span<const std::byte>(static_cast<const std::byte *>(m_File.Window()),
+                                                       m_File.WindowSize())
+                                .subspan(left_window_gap);
+
+        if( const auto found = FindBytes(window, m_BytesPattern) ) {
             if( _offset != nullptr )
-                *_bytes_len = (size_t(result.location + result.length) < m_DecodedBufferSize
-                                   ? m_DecodedBufferIndx[result.location + result.length]
-                                   : m_File.WindowSize() - left_window_gap) -
-                              m_DecodedBufferIndx[result.location];
-            m_Position = m_Position + m_DecodedBufferIndx[result.location + result.length];
+                *_offset = m_Position + *found;
+            if( _bytes_len != nullptr )
+                *_bytes_len = length;
+            m_Position = m_Position + *found + length;
             return Response::Found;
         }
+
+        if( window_pos + m_File.WindowSize() >= m_File.FileSize() )
+            break; // this is the end (c)
+
+        // the next window overlaps this one by the pattern's length minus one byte
+        m_Position = window_pos + m_File.WindowSize() - (length - 1);
     }
 
+    m_Position = m_File.FileSize();
     return Response::NotFound;
 }
 
@@ -210,4 +466,149 @@ static bool IsWholePhrase(CFStringRef _string, CFRange _range)
     return true;
 }
 
+static bool
+IsWholePhrase(std::span<const unsigned char> _window, size_t _location, size_t _length, utility::Encoding _encoding)
+{
+    static const auto alphanumeric = CFCharacterSetGetPredefined(kCFCharacterSetAlphaNumeric);
+    assert(_length > 0);
+    assert(_location + _length <= _window.size());
+
+    const auto is_alphanumeric = [&](unsigned char _byte) {
+        unsigned short character = 0;
+        utility::InterpretSingleByteBufferAsUniCharPreservingBufferSize(&_byte, 1, &character, _encoding);
+        return CFCharacterSetIsCharacterMember(alphanumeric, character);
+    };
+
+    if( _location > 0 && is_alphanumeric(_window[_location - 1]) )
+        return false;
+
+    if( _location + _length < _window.size() && is_alphanumeric(_window[_location + _length]) )
+        return false;
+
+    return true;
+}
+
+static std::vector<unsigned char> EncodeSingleByte(CFStringRef _string, utility::Encoding _encoding)
+{
+    if( _encoding < utility::Encoding::ENCODING_SINGLE_BYTES_FIRST__ ||
+        _encoding > utility::Encoding::ENCODING_SINGLE_BYTES_LAST__ )
+        return {};
+
+    const auto length = CFStringGetLength(_string);
+    if( length <= 0 )
+        return {};
+
+    std::vector<uint16_t> characters(length);
+    CFStringGetCharacters(_string, CFRangeMake(0, length), characters.data());
+    std::vector<unsigned char> encoded(length);
+    if( !utility::InterpretUnicharsAsSingleByte(characters.data(), characters.size(), encoded.data(), _encoding) )
+        return {};
+    return encoded;
+}
+
+static bool MatchesAt(const std::byte *_haystack, const SearchInFile::BytesPattern &_pattern) noexcept
+{
+    const size_t length = _pattern.bytes.size();
+    for( size_t i = 0; i < length; ++i )
+        if( (_haystack[i] & _pattern.mask[i]) != _pattern.bytes[i] )
+            return false;
+    return true;
+}
+
+static std::optional<size_t> FindBytes(std::span<const std::byte> _haystack,
+                                       const SearchInFile::BytesPattern &_pattern)
+{
+    const size_t length = _pattern.bytes.size();
+    if( length == 0 || length > _haystack.size() )
+        return std::nullopt;
+    const size_t positions = _haystack.size() - length + 1;
+
+    // the first and the last fully-specified bytes are used as anchors to quickly skip the irrelevant positions
+    const auto first = std::find(_pattern.mask.begin(), _pattern.mask.end(), std::byte{0xFF});
+    if( first == _pattern.mask.end() ) {
+        for( size_t i = 0; i < positions; ++i )
+            if( MatchesAt(_haystack.data() + i, _pattern) )
+                return i;
+        return std::nullopt;
+    }
+    const size_t a = first - _pattern.mask.begin();
+    const auto last = std::find(_pattern.mask.rbegin(), _pattern.mask.rend(), std::byte{0xFF});
+    const size_t b = _pattern.mask.rend() - last - 1;
+    const auto *const bytes = reinterpret_cast<const uint8_t *>(_haystack.data());
+    const uint8_t anchor_a = static_cast<uint8_t>(_pattern.bytes[a]);
+    const uint8_t anchor_b = static_cast<uint8_t>(_pattern.bytes[b]);
+
+    size_t i = 0;
+#if defined(__aarch64__)
+    const uint8x16_t va = vdupq_n_u8(anchor_a);
+    const uint8x16_t vb = vdupq_n_u8(anchor_b);
+    for( ; i + 16 <= positions; i += 16 ) {
+        const uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(bytes + i + a), va), vceqq_u8(vld1q_u8(bytes + i + b), vb));
+        // narrow each byte of the comparison result into a nibble of a 64-bit mask
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while( mask != 0 ) {
+            const size_t offset = std::countr_zero(mask) / 4;
+            if( MatchesAt(_haystack.data() + i + offset, _pattern) )
+                return i + offset;
+            mask &= ~(uint64_t(0xF) << (offset * 4));
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i va = _mm_set1_epi8(static_cast<char>(anchor_a));
+    const __m128i vb = _mm_set1_epi8(static_cast<char>(anchor_b));
+    for( ; i + 16 <= positions; i += 16 ) {
+        const __m128i ea = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i + a)), va);
+        const __m128i eb = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i + b)), vb);
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(ea, eb)));
+        while( mask != 0 ) {
+            const size_t offset = std::countr_zero(mask);
+            if( MatchesAt(_haystack.data() + i + offset, _pattern) )
+                return i + offset;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for( ; i < positions; ++i )
+        if( bytes[i + a] == anchor_a && bytes[i + b] == anchor_b && MatchesAt(_haystack.data() + i, _pattern) )
+            return i;
+    return std::nullopt;
+}
+
+std::optional<SearchInFile::BytesPattern> SearchInFile::BytesPattern::FromHex(std::string_view _hex)
+{
+    BytesPattern pattern;
+    uint8_t value = 0;
+    uint8_t mask = 0;
+    bool high = true;
+    for( const char c : _hex ) {
+        if( c == ' ' || c == '\t' || c == '\n' || c == '\r' )
+            continue;
+        uint8_t nibble_value = 0;
+        uint8_t nibble_mask = 0xF;
+        if( c >= '0' && c <= '9' )
+            nibble_value = static_cast<uint8_t>(c - '0');
+        else if( c >= 'a' && c <= 'f' )
+            nibble_value = static_cast<uint8_t>(c - 'a' + 10);
+        else if( c >= 'A' && c <= 'F' )
+            nibble_value = static_cast<uint8_t>(c - 'A' + 10);
+        else if( c == '?' )
+            nibble_mask = 0;
+        else
+            return std::nullopt;
+
+        if( high ) {
+            value = static_cast<uint8_t>(nibble_value << 4);
+            mask = static_cast<uint8_t>(nibble_mask << 4);
+        }
+        else {
+            pattern.bytes.push_back(std::byte{static_cast<uint8_t>(value | nibble_value)});
+            pattern.mask.push_back(std::byte{static_cast<uint8_t>(mask | nibble_mask)});
+        }
+        high = !high;
+    }
+    if( !high || pattern.bytes.empty() )
+        return std::nullopt;
+    return pattern;
+}
+
 } // namespace nc::vfs
@@ -0,0 +1,122 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include <VFS/../../source/DirectoryCache.h>
+#include <fmt/core.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace nc::vfs;
+using namespace std::literals;
+#define PREFIX "[nc::vfs::DirectoryCache] "
+
+namespace {
+
+struct Dir {
+    std::vector<std::string> entries;
+};
+
+} // namespace
+
+static DirectoryCache<Dir> MakeCache(std::chrono::nanoseconds _ttl = 1h, size_t _max_cost = 1'000'000)
+{
+    return {_ttl, _max_cost, [](const Dir &_dir) { return _dir.entries.size() + 1; }};
+}
+
+static std::shared_ptr<Dir> MakeDir(std::vector<std::string> _entries)
+{
+    return std::make_shared<Dir>(Dir{std::move(_entries)});
+}
+
+TEST_CASE(PREFIX "Insert and find")
+{
+    auto cache = MakeCache();
+    CHECK(cache.Find("/a/") == nullptr);
+    cache.Insert("/a/", MakeDir({"x", "y"}));
+    const auto dir = cache.Find("/a/");
+    REQUIRE(dir);
+    CHECK(dir->entries == std::vector<std::string>{"x", "y"});
+    CHECK(cache.Find("/b/") == nullptr);
+    CHECK(cache.Cost() == 3);
+
+    cache.Insert("/a/", MakeDir({"z"}));
+    CHECK(cache.Find("/a/")->entries == std::vector<std::string>{"z"});
+    CHECK(cache.Cost() == 2);
+}
+
+TEST_CASE(PREFIX "Updates publish copies")
+{
+    auto cache = MakeCache();
+    cache.Insert("/a/", MakeDir({"x"}));
+    const auto before = cache.Find("/a/");
+    CHECK(cache.Update("/a/", [](Dir &_dir) { _dir.entries.push_back("y"); }));
+    const auto after = cache.Find("/a/");
+    CHECK(before->entries == std::vector<std::string>{"x"});
+    CHECK(after->entries == std::vector<std::string>{"x", "y"});
+    CHECK(cache.Cost() == 3);
+    CHECK(cache.Update("/b/", [](Dir &) { FAIL(); }) == false);
+}
+
+TEST_CASE(PREFIX "Erase and move")
+{
+    auto cache = MakeCache();
+    cache.Insert("/a/", MakeDir({"x"}));
+    cache.Insert("/b/", MakeDir({"y"}));
+    CHECK(cache.Move("/a/", "/c/"));
+    CHECK(cache.Find("/a/") == nullptr);
+    CHECK(cache.Find("/c/")->entries == std::vector<std::string>{"x"});
+    CHECK(cache.Move("/c/", "/b/"));
+    CHECK(cache.Find("/b/")->entries == std::vector<std::string>{"x"});
+    CHECK(cache.Cost() == 2);
+    CHECK(cache.Move("/a/", "/d/") == false);
+    CHECK(cache.Erase("/b/"));
+    CHECK(cache.Erase("/b/") == false);
+    CHECK(cache.Cost() == 0);
+}
+
+TEST_CASE(PREFIX "Outdated directories are not returned")
+{
+    auto cache = MakeCache(1ms);
+    cache.Insert("/a/", MakeDir({"x"}));
+    std::this_thread::sleep_for(5ms);
+    CHECK(cache.Find("/a/") == nullptr);
+    cache.Insert("/a/", MakeDir({"x"}));
+    CHECK(cache.Find("/a/") != nullptr);
+}
+
+TEST_CASE(PREFIX "Evicts least recently used directories")
+{
+    auto cache = MakeCache(1h, 16 * 10);
+    cache.Insert("/hot/", MakeDir({}));
+    for( int i = 0; i < 1000; ++i ) {
+        cache.Insert(fmt::format("/{}/", i), MakeDir({"x"}));
+        REQUIRE(cache.Find("/hot/"));
+    }
+    CHECK(cache.Cost() <= 16 * 10);
+    CHECK(cache.Find("/0/") == nullptr);
+    CHECK(cache.Find("/999/") != nullptr);
+}
+
+TEST_CASE(PREFIX "Concurrent access")
+{
+    auto cache = MakeCache(1h, 1000);
+    std::atomic_bool failed = false;
+    std::vector<std::thread> threads;
+    for( int t = 0; t < 4; ++t )
+        threads.emplace_back([&cache, &failed, t] {
+            for( int i = 0; i < 10'000; ++i ) {
+                const auto path = fmt::format("/{}/", (i * (t + 1)) % 100);
+                if( auto dir = cache.Find(path) ) {
+                    if( dir->entries.size() > 2 )
+                        failed = true;
+                }
+                else
+                    cache.Insert(path, MakeDir({"x"}));
+                cache.Update(path, [](Dir &_dir) { _dir.entries.resize(2); });
+            }
+        });
+    for( auto &thread : threads )
+        thread.join();
+    CHECK(failed == false);
+    CHECK(cache.Cost() <= 1000);
+}
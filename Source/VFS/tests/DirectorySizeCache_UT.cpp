@@ -0,0 +1,203 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "TestEnv.h"
+#include <NativeDirectorySizeCache.h>
+#include <fstream>
+
+using namespace nc::vfs;
+using namespace nc::vfs::native;
+#define PREFIX "[nc::vfs::native::DirectorySizeCache] "
+
+static DirectorySizeCache::Directory MakeDirectory(int64_t _mtime, uint64_t _size, std::vector<std::string> _subdirs = {})
+{
+    DirectorySizeCache::Directory directory;
+    directory.mtime = {_mtime, 0};
+    directory.files_size = _size;
+    directory.files_count = 1;
+    directory.subdirectories = std::move(_subdirs);
+    return directory;
+}
+
+TEST_CASE(PREFIX "Returns only directories with the same modification time")
+{
+    DirectorySizeCache cache;
+    CHECK(cache.Find("/a", {1, 0}) == std::nullopt);
+    cache.Commit("/a", MakeDirectory(1, 10, {"b"}));
+    const auto found = cache.Find("/a/", {1, 0});
+    REQUIRE(found);
+    CHECK(found->files_size == 10);
+    CHECK(found->subdirectories == std::vector<std::string>{"b"});
+    CHECK(cache.Find("/a", {1, 1}) == std::nullopt);
+    CHECK(cache.Find("/a", {2, 0}) == std::nullopt);
+}
+
+TEST_CASE(PREFIX "Invalidation")
+{
+    DirectorySizeCache cache;
+    for( auto path : {"/a", "/a/b", "/a/b/c", "/ab", "/d"} )
+        cache.Commit(path, MakeDirectory(1, 10));
+    REQUIRE(cache.Size() == 5);
+
+    cache.Invalidate("/a/b");
+    CHECK(cache.Find("/a/b", {1, 0}) == std::nullopt);
+    CHECK(cache.Find("/a/b/c", {1, 0}));
+    CHECK(cache.Size() == 4);
+
+    cache.InvalidateRecursively("/a/");
+    CHECK(cache.Find("/a", {1, 0}) == std::nullopt);
+    CHECK(cache.Find("/a/b/c", {1, 0}) == std::nullopt);
+    CHECK(cache.Find("/ab", {1, 0}));
+    CHECK(cache.Size() == 2);
+
+    cache.InvalidateRecursively("/");
+    CHECK(cache.Size() == 0);
+}
+
+TEST_CASE(PREFIX "Skips the commits of directories invalidated during their scan")
+{
+    DirectorySizeCache cache;
+    const auto scanned_at = cache.Generation();
+    cache.Invalidate("/a/b");
+    cache.InvalidateRecursively("/c");
+    for( auto path : {"/a", "/a/b", "/a/b/c", "/c", "/c/d", "/cd"} )
+        cache.Commit(path, MakeDirectory(1, 10), scanned_at);
+    CHECK(cache.Find("/a", {1, 0}));
+    CHECK(cache.Find("/a/b", {1, 0}) == std::nullopt);
+    CHECK(cache.Find("/a/b/c", {1, 0}));
+    CHECK(cache.Find("/c", {1, 0}) == std::nullopt);
+    CHECK(cache.Find("/c/d", {1, 0}) == std::nullopt);
+    CHECK(cache.Find("/cd", {1, 0}));
+
+    // the scans started after the invalidations are committed as usual
+    cache.Commit("/a/b", MakeDirectory(1, 10), cache.Generation());
+    CHECK(cache.Find("/a/b", {1, 0}));
+
+    // once the invalidations made during a scan are forgotten, nothing of it is committed
+    const auto long_ago = cache.Generation();
+    for( size_t i = 0; i <= DirectorySizeCache::MaxTombstones; ++i )
+        cache.Invalidate("/x");
+    cache.Commit("/e", MakeDirectory(1, 10), long_ago);
+    CHECK(cache.Find("/e", {1, 0}) == std::nullopt);
+}
+
+TEST_CASE(PREFIX "Doesn't grow beyond the limit")
+{
+    DirectorySizeCache cache(2);
+    cache.Commit("/a", MakeDirectory(1, 10));
+    cache.Commit("/b", MakeDirectory(1, 10));
+    cache.Commit("/c", MakeDirectory(1, 10));
+    CHECK(cache.Size() == 2);
+    CHECK(cache.Find("/c", {1, 0}) == std::nullopt);
+    cache.Commit("/a", MakeDirectory(2, 20));
+    CHECK(cache.Find("/a", {2, 0})->files_size == 20);
+}
+
+TEST_CASE(PREFIX "Persistence")
+{
+    const TestDir dir;
+    const auto path = dir.directory / "cache.bin";
+    {
+        DirectorySizeCache cache;
+        cache.Commit("/a", MakeDirectory(1, 10, {"b", "c"}));
+        cache.Commit("/a/b", MakeDirectory(2, 20));
+        cache.SetLastEventID(12345);
+        REQUIRE(cache.Save(path));
+    }
+    {
+        DirectorySizeCache cache;
+        REQUIRE(cache.Load(path));
+        CHECK(cache.Size() == 2);
+        CHECK(cache.LastEventID() == 12345);
+        CHECK(cache.Find("/a", {1, 0})->subdirectories == std::vector<std::string>{"b", "c"});
+        CHECK(cache.Find("/a/b", {2, 0})->files_size == 20);
+    }
+    {
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        DirectorySizeCache cache;
+        cache.Commit("/x", MakeDirectory(1, 10));
+        CHECK(cache.Load(path) == false);
+        CHECK(cache.Size() == 0);
+        CHECK(cache.Load(dir.directory / "nonexistent") == false);
+    }
+}
+
+TEST_CASE(PREFIX "NativeHost rescans only the changed directories")
+{
+    const TestDir dir;
+    const auto root = dir.directory / "root";
+    std::filesystem::create_directories(root / "a" / "b");
+    std::ofstream{root / "x"} << "12345";
+    std::ofstream{root / "a" / "y"} << "123";
+    std::ofstream{root / "a" / "b" / "z"} << "1";
+
+    const auto cache = std::make_shared<DirectorySizeCache>();
+    const auto host = std::make_shared<NativeHost>(*TestEnv().native_fs_man, *TestEnv().fsevents_file_update);
+    host->SetDirectorySizeCache(cache);
+    CHECK(host->CalculateDirectorySize(root.native(), {}) == 9);
+    CHECK(cache->Size() == 3);
+
+    // the contents of a file are changed without touching its directory, so the cached size is used
+    std::ofstream{root / "a" / "y", std::ios::app} << "45";
+    CHECK(host->CalculateDirectorySize(root.native(), {}) == 9);
+    cache->Invalidate((std::filesystem::canonical(root) / "a").native());
+    CHECK(host->CalculateDirectorySize(root.native(), {}) == 11);
+
+    // adding a file updates the modification time of its directory
+    std::ofstream{root / "a" / "b" / "w"} << "1234567";
+    CHECK(host->CalculateDirectorySize((root / "").native(), {}) == 18);
+    CHECK(cache->Size() == 3);
+}
+
+TEST_CASE(PREFIX "NativeHost caches the directories by their real paths")
+{
+    const TestDir dir;
+    const auto root = dir.directory / "root";
+    std::filesystem::create_directories(root / "a");
+    std::ofstream{root / "a" / "y"} << "123";
+    std::filesystem::create_directory_symlink(root, dir.directory / "link");
+
+    const auto cache = std::make_shared<DirectorySizeCache>();
+    const auto host = std::make_shared<NativeHost>(*TestEnv().native_fs_man, *TestEnv().fsevents_file_update);
+    host->SetDirectorySizeCache(cache);
+    CHECK(host->CalculateDirectorySize((dir.directory / "link").native(), {}) == 3);
+    CHECK(cache->Size() == 2);
+
+    // FSEvents report the changes under the real path
+    std::ofstream{root / "a" / "y", std::ios::app} << "45";
+    cache->Invalidate((std::filesystem::canonical(root) / "a").native());
+    CHECK(host->CalculateDirectorySize((dir.directory / "link").native(), {}) == 5);
+    CHECK(host->CalculateDirectoryLevelSize((dir.directory / "link" / "a").native(), {}, {}) == 5);
+    CHECK(cache->Size() == 2);
+}
+
+TEST_CASE(PREFIX "Observer invalidates the reported directories")
+{
+    DirectorySizeCache cache;
+    auto fill = [&] {
+        for( auto path : {"/a", "/a/b", "/c"} )
+            cache.Commit(path, MakeDirectory(1, 10));
+    };
+    auto process = [&](const char *_path, FSEventStreamEventFlags _flags, FSEventStreamEventId _id) {
+        DirectorySizeCacheObserver::Process(cache, std::span{&_path, 1}, std::span{&_flags, 1}, std::span{&_id, 1});
+    };
+
+    fill();
+    process("/a/", kFSEventStreamEventFlagNone, 10);
+    CHECK(cache.Size() == 2);
+    CHECK(cache.Find("/a/b", {1, 0}));
+    CHECK(cache.LastEventID() == 10);
+
+    fill();
+    process("/a", kFSEventStreamEventFlagMustScanSubDirs, 11);
+    CHECK(cache.Size() == 1);
+    CHECK(cache.LastEventID() == 11);
+
+    fill();
+    process("", kFSEventStreamEventFlagHistoryDone, 0);
+    CHECK(cache.Size() == 3);
+    CHECK(cache.LastEventID() == 11);
+
+    process("/", kFSEventStreamEventFlagKernelDropped, 12);
+    CHECK(cache.Size() == 0);
+    CHECK(cache.LastEventID() == 12);
+}
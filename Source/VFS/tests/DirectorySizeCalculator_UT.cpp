@@ -0,0 +1,75 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "TestEnv.h"
+#include <VFS/DirectorySizeCalculator.h>
+#include <fmt/core.h>
+#include <fstream>
+#include <mutex>
+
+using namespace nc::vfs;
+#define PREFIX "[nc::vfs::DirectorySizeCalculator] "
+
+static void MakeFile(const std::filesystem::path &_path, size_t _size)
+{
+    std::ofstream{_path} << std::string(_size, 'x');
+}
+
+TEST_CASE(PREFIX "Calculates the sizes of all directories")
+{
+    const TestDir dir;
+    const auto &root = dir.directory;
+    std::filesystem::create_directories(root / "a" / "b" / "c");
+    std::filesystem::create_directories(root / "d");
+    std::filesystem::create_directories(root / "e");
+    MakeFile(root / "a" / "1", 10);
+    MakeFile(root / "a" / "b" / "2", 20);
+    MakeFile(root / "a" / "b" / "c" / "3", 30);
+    for( int i = 0; i < 100; ++i ) {
+        std::filesystem::create_directories(root / "d" / std::to_string(i));
+        MakeFile(root / "d" / std::to_string(i) / "f", i);
+    }
+
+    const auto &host = TestEnv().vfs_native;
+    const std::vector<DirectorySizeCalculator::Directory> directories{{host, (root / "a").native()},
+                                                                      {host, (root / "d").native()},
+                                                                      {host, (root / "e").native()},
+                                                                      {host, (root / "nonexistent").native()},
+                                                                      {nullptr, "/"}};
+    std::mutex lock;
+    std::vector<std::optional<ssize_t>> sizes(directories.size());
+    size_t reported = 0;
+    for( size_t concurrency : {1, 4} ) {
+        std::ranges::fill(sizes, std::nullopt);
+        reported = 0;
+        DirectorySizeCalculator{concurrency}.Calculate(directories, [&](size_t _index, ssize_t _size) {
+            const auto guard = std::lock_guard{lock};
+            REQUIRE(_index < sizes.size());
+            REQUIRE(sizes[_index] == std::nullopt);
+            sizes[_index] = _size;
+            ++reported;
+        });
+        CHECK(reported == directories.size());
+        CHECK(sizes[0] == 60);
+        CHECK(sizes[1] == 4950);
+        CHECK(sizes[2] == 0);
+        CHECK(sizes[3] < 0);
+        CHECK(sizes[4] == VFSError::InvalidCall);
+    }
+}
+
+TEST_CASE(PREFIX "Stops when cancelled")
+{
+    const TestDir dir;
+    for( int i = 0; i < 10; ++i )
+        std::filesystem::create_directories(dir.directory / std::to_string(i) / "x");
+
+    const auto &host = TestEnv().vfs_native;
+    std::vector<DirectorySizeCalculator::Directory> directories;
+    for( int i = 0; i < 10; ++i )
+        directories.push_back({host, (dir.directory / std::to_string(i)).native()});
+
+    std::atomic_int reported = 0;
+    DirectorySizeCalculator{}.Calculate(
+        directories, [&](size_t, ssize_t) { ++reported; }, [] { return true; });
+    CHECK(reported == 0);
+}
@@ -0,0 +1,108 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "TestEnv.h"
+#include <VFSListingInput.h>
+#include <Native.h>
+#include <VFSDeclarations.h>
+#include <fstream>
+
+using namespace nc::vfs;
+using nc::base::variable_container;
+#define PREFIX "[nc::vfs::Listing] "
+
+static VFSListingPtr MakeListing(const std::string &_directory, const std::vector<std::string> &_filenames)
+{
+    ListingInput input;
+    input.hosts.insert(0, TestEnv().vfs_native);
+    input.directories.insert(0, _directory);
+    input.sizes.reset(variable_container<>::type::sparse);
+    input.symlinks.reset(variable_container<>::type::sparse);
+    for( unsigned i = 0; i < _filenames.size(); ++i ) {
+        input.filenames.emplace_back(_filenames[i]);
+        input.unix_modes.emplace_back(S_IFREG | S_IRUSR);
+        input.unix_types.emplace_back(DT_REG);
+        input.sizes.insert(i, 100 + i);
+    }
+    return Listing::Build(std::move(input));
+}
+
+TEST_CASE(PREFIX "BuildComposite refers to the items of the original listings")
+{
+    const auto first = MakeListing("/first/", {"a.txt", "b"});
+    const auto second = MakeListing("/second/", {"c.jpg"});
+    const auto composite = Listing::BuildComposite({first, second}, {}, "Title");
+    REQUIRE(composite);
+    CHECK(composite->IsComposite());
+    CHECK(composite->Title() == "Title");
+    REQUIRE(composite->Count() == 3);
+    CHECK(composite->HasCommonHost());
+    CHECK(composite->Host() == TestEnv().vfs_native);
+    CHECK(composite->HasCommonDirectory() == false);
+    CHECK(composite->Path(0) == "/first/a.txt");
+    CHECK(composite->Path(1) == "/first/b");
+    CHECK(composite->Path(2) == "/second/c.jpg");
+    CHECK(composite->Extension(2) == std::string_view("jpg"));
+    CHECK(composite->HasExtension(1) == false);
+    CHECK(composite->Size(1) == 101);
+    CHECK(composite->IsReg(2));
+    CHECK(&composite->Filename(2) == &second->Filename(0));
+    CHECK(composite->FilenameCF(0) == first->FilenameCF(0));
+    CHECK(composite->Item(1).Filename() == "b");
+    CHECK_THROWS_AS(composite->Filename(3), std::out_of_range);
+}
+
+TEST_CASE(PREFIX "BuildComposite flattens composites of composites")
+{
+    const auto first = MakeListing("/first/", {"a", "b", "c"});
+    const auto second = MakeListing("/second/", {"d", "e"});
+    const auto inner = Listing::BuildComposite({first, second}, {{2, 0}, {1}});
+    REQUIRE(inner->Count() == 3);
+    const auto outer = Listing::BuildComposite({inner, second}, {{2, 1}, {0}});
+    REQUIRE(outer->Count() == 3);
+    CHECK(outer->Path(0) == "/second/e");
+    CHECK(outer->Path(1) == "/first/a");
+    CHECK(outer->Path(2) == "/second/d");
+    CHECK(&outer->Filename(1) == &first->Filename(0));
+    CHECK(outer->Size(2) == 100);
+}
+
+TEST_CASE(PREFIX "BuildComposite rejects invalid input")
+{
+    const auto listing = MakeListing("/first/", {"a"});
+    CHECK_THROWS_AS(Listing::BuildComposite({listing}, {{1}}), std::invalid_argument);
+    CHECK_THROWS_AS(Listing::BuildComposite({listing}, {{0}, {0}}), std::invalid_argument);
+    const auto empty = Listing::BuildComposite({});
+    REQUIRE(empty);
+    CHECK(empty->Empty());
+}
+
+TEST_CASE(PREFIX "ProduceUpdatedTemporaryPanelListing refers to the unchanged items")
+{
+    const TestDir dir;
+    const auto &host = TestEnv().vfs_native;
+    std::ofstream{dir.directory / "a"} << "hello";
+    std::ofstream{dir.directory / "b"} << "world";
+    std::ofstream{dir.directory / "c"} << "!";
+
+    std::vector<VFSListingPtr> listings;
+    for( auto name : {"a", "b", "c"} ) {
+        VFSListingPtr listing;
+        REQUIRE(host->FetchSingleItemListing((dir.directory / name).native(), listing, 0, {}) == VFSError::Ok);
+        listings.emplace_back(listing);
+    }
+    const auto original = Listing::BuildComposite(listings, {}, "Title");
+
+    std::ofstream{dir.directory / "b", std::ios::app} << ", world";
+    std::filesystem::remove(dir.directory / "c");
+
+    const auto updated = Listing::ProduceUpdatedTemporaryPanelListing(*original, {});
+    REQUIRE(updated);
+    CHECK(updated->Title() == "Title");
+    REQUIRE(updated->Count() == 2);
+    CHECK(updated->Filename(0) == "a");
+    CHECK(updated->Size(0) == 5);
+    CHECK(updated->FilenameCF(0) == original->FilenameCF(0));
+    CHECK(updated->Filename(1) == "b");
+    CHECK(updated->Size(1) == 12);
+    CHECK(updated->Directory(1) == original->Directory(1));
+}
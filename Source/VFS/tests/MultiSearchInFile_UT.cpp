@@ -0,0 +1,124 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "MultiSearchInFile.h"
+#include "VFSGenericMemReadOnlyFile.h"
+
+using nc::utility::Encoding;
+using nc::vfs::FileWindow;
+using nc::vfs::GenericMemReadOnlyFile;
+using nc::vfs::MultiSearchInFile;
+using Composition = MultiSearchInFile::Composition;
+using Options = MultiSearchInFile::Options;
+using Response = MultiSearchInFile::Response;
+using namespace std::literals;
+#define PREFIX "[nc::vfs::MultiSearchInFile] "
+
+static FileWindow MakeFileWindow(std::string_view _data)
+{
+    auto mem_file = std::make_shared<GenericMemReadOnlyFile>("", nullptr, _data);
+    mem_file->Open(VFSFlags::OF_Read);
+    return FileWindow{mem_file};
+}
+
+TEST_CASE(PREFIX "Finds all texts in a single pass")
+{
+    const std::string texts[] = {"fox", "dog", "cat", "brown"};
+    MultiSearchInFile search(texts, Options::None);
+    auto fw = MakeFileWindow("The quick brown fox jumps over the lazy dog");
+
+    auto result = search.Search(fw, Encoding::ENCODING_UTF8, Composition::All);
+    CHECK(result.response == Response::NotFound);
+    REQUIRE(result.locations.size() == 4);
+    REQUIRE(result.locations[0]);
+    CHECK(result.locations[0]->offset == 16);
+    CHECK(result.locations[0]->bytes_len == 3);
+    REQUIRE(result.locations[1]);
+    CHECK(result.locations[1]->offset == 40);
+    CHECK(result.locations[2] == std::nullopt);
+    REQUIRE(result.locations[3]);
+    CHECK(result.locations[3]->offset == 10);
+    CHECK(result.locations[3]->bytes_len == 5);
+
+    result = search.Search(fw, Encoding::ENCODING_UTF8, Composition::Any);
+    CHECK(result.response == Response::Found);
+    CHECK(result.locations[3]);
+    CHECK(result.locations[1] == std::nullopt); // the search stops at the first found text
+}
+
+TEST_CASE(PREFIX "Respects the options")
+{
+    const std::string texts[] = {"hello", reinterpret_cast<const char *>(u8"мир")};
+    auto fw = MakeFileWindow(reinterpret_cast<const char *>(u8"HELLO, МИРОВОЙ мир! Othello"));
+    {
+        MultiSearchInFile search(texts, Options::None);
+        const auto result = search.Search(fw, Encoding::ENCODING_UTF8, Composition::All);
+        CHECK(result.response == Response::Found);
+        CHECK(result.locations[0]->offset == 0);
+        CHECK(result.locations[1]->offset == 7);
+        CHECK(result.locations[1]->bytes_len == 6);
+    }
+    {
+        MultiSearchInFile search(texts, Options::CaseSensitive);
+        const auto result = search.Search(fw, Encoding::ENCODING_UTF8, Composition::All);
+        CHECK(result.locations[0]->offset == 32);
+        CHECK(result.locations[1]->offset == 22);
+    }
+    {
+        MultiSearchInFile search(texts, Options::CaseSensitive | Options::FindWholePhrase);
+        const auto result = search.Search(fw, Encoding::ENCODING_UTF8, Composition::All);
+        CHECK(result.response == Response::NotFound);
+        CHECK(result.locations[0] == std::nullopt);
+        CHECK(result.locations[1]->offset == 22);
+    }
+}
+
+TEST_CASE(PREFIX "Finds texts across the windows boundaries")
+{
+    const auto window_size = FileWindow::DefaultWindowSize;
+    const std::string texts[] = {"needle", reinterpret_cast<const char *>(u8"иголка")};
+    for( const size_t offset : {size_t(window_size - 3), size_t(window_size - 6), size_t(7 * window_size + 1)} ) {
+        std::string memory(offset, 'x');
+        memory += reinterpret_cast<const char *>(u8"needle иголка");
+        memory.resize(memory.size() + window_size, 'x');
+        auto fw = MakeFileWindow(memory);
+        MultiSearchInFile search(texts, Options::FindWholePhrase);
+        const auto result = search.Search(fw, Encoding::ENCODING_UTF8, Composition::All);
+        CHECK(result.response == Response::NotFound); // "xneedle" is not a whole word
+
+        MultiSearchInFile search2(texts, Options::None);
+        const auto result2 = search2.Search(fw, Encoding::ENCODING_UTF8, Composition::All);
+        REQUIRE(result2.response == Response::Found);
+        CHECK(result2.locations[0]->offset == offset);
+        CHECK(result2.locations[0]->bytes_len == 6);
+        CHECK(result2.locations[1]->offset == offset + 7);
+        CHECK(result2.locations[1]->bytes_len == 12);
+    }
+}
+
+TEST_CASE(PREFIX "Searches in other encodings")
+{
+    const std::string texts[] = {reinterpret_cast<const char *>(u8"привет")};
+    MultiSearchInFile search(texts, Options::None);
+    {
+        auto fw = MakeFileWindow("\x20\x00\x3F\x04\x40\x04\x38\x04\x32\x04\x35\x04\x42\x04"sv);
+        const auto result = search.Search(fw, Encoding::ENCODING_UTF16LE, Composition::Any);
+        REQUIRE(result.response == Response::Found);
+        CHECK(result.locations[0]->offset == 2);
+        CHECK(result.locations[0]->bytes_len == 12);
+    }
+    {
+        auto fw = MakeFileWindow("\xcf\xf0\xe8\xe2\xe5\xf2!");
+        const auto result = search.Search(fw, Encoding::ENCODING_WIN1251, Composition::Any);
+        REQUIRE(result.response == Response::Found);
+        CHECK(result.locations[0]->offset == 0);
+        CHECK(result.locations[0]->bytes_len == 6);
+    }
+}
+
+TEST_CASE(PREFIX "Doesn't search for empty texts")
+{
+    const std::string texts[] = {""};
+    MultiSearchInFile search(texts, Options::None);
+    auto fw = MakeFileWindow("some data");
+    CHECK(search.Search(fw, Encoding::ENCODING_UTF8, Composition::Any).response == Response::Invalid);
+}
@@ -4,6 +4,7 @@
 #include "SearchForFiles.h"
 #include <Utility/PathManip.h>
 #include <Native.h>
+#include <map>
 #include <set>
 #include <fstream>
 #include <sys/stat.h>
@@ -26,7 +27,11 @@ TEST_CASE(PREFIX "Test basic searching")
 
     using set = std::set<std::string>;
     set filenames;
-    auto callback = [&](const char *_filename, [[maybe_unused]] const char *_in_path, VFSHost &, CFRange) {
+    auto callback = [&](const char *_filename,
+                        [[maybe_unused]] const char *_in_path,
+                        VFSHost &,
+                        CFRange,
+                        std::span<const CFRange>) {
         filenames.emplace(_filename);
     };
 
@@ -97,7 +102,11 @@ TEST_CASE(PREFIX "Test size filter")
 
     using set = std::set<std::string>;
     set filenames;
-    auto callback = [&](const char *_filename, [[maybe_unused]] const char *_in_path, VFSHost &, CFRange) {
+    auto callback = [&](const char *_filename,
+                        [[maybe_unused]] const char *_in_path,
+                        VFSHost &,
+                        CFRange,
+                        std::span<const CFRange>) {
         filenames.emplace(_filename);
     };
 
@@ -143,7 +152,11 @@ TEST_CASE(PREFIX "Test content filter")
 
     using set = std::set<std::string>;
     set filenames;
-    auto callback = [&](const char *_filename, [[maybe_unused]] const char *_in_path, VFSHost &, CFRange) {
+    auto callback = [&](const char *_filename,
+                        [[maybe_unused]] const char *_in_path,
+                        VFSHost &,
+                        CFRange,
+                        std::span<const CFRange>) {
         filenames.emplace(_filename);
     };
 
@@ -224,6 +237,63 @@ TEST_CASE(PREFIX "Test content filter")
     }
 }
 
+TEST_CASE(PREFIX "Test multiple texts content filter")
+{
+    using Options = SearchForFiles::Options;
+    TestDir test_dir;
+    BuildTestData(test_dir.directory);
+    auto &host = TestEnv().vfs_native;
+
+    std::map<std::string, std::vector<CFRange>> found;
+    auto callback =
+        [&](const char *_filename, const char *, VFSHost &, CFRange, std::span<const CFRange> _texts_found) {
+            found[_filename].assign(_texts_found.begin(), _texts_found.end());
+        };
+
+    SearchForFiles search;
+    auto do_search = [&](int _flags) {
+        search.Go(test_dir.directory, host, _flags, callback, {});
+        search.Wait();
+    };
+
+    auto filter = SearchForFiles::FilterContent{};
+    filter.mode = SearchForFiles::FilterContent::Mode::Texts;
+    filter.texts = {"world", "hello", reinterpret_cast<const char *>(u8"мир")};
+    SECTION("any")
+    {
+        search.SetFilterContent(filter);
+        do_search(Options::GoIntoSubDirs | Options::SearchForFiles);
+        REQUIRE(found.size() == 3);
+        REQUIRE(found["filename1.txt"].size() == 3);
+        CHECK(found["filename1.txt"][1].location == 0);
+        CHECK(found["filename2.txt"][2].location == 14);
+        CHECK(found["filename3.txt"][0].location == 19);
+    }
+    SECTION("all")
+    {
+        filter.texts = {"world", "hello"};
+        filter.all_texts = true;
+        search.SetFilterContent(filter);
+        do_search(Options::GoIntoSubDirs | Options::SearchForFiles);
+        REQUIRE(found.size() == 1);
+        REQUIRE(found["filename1.txt"].size() == 2);
+        CHECK(found["filename1.txt"][0].location == 7);
+        CHECK(found["filename1.txt"][0].length == 5);
+        CHECK(found["filename1.txt"][1].location == 0);
+    }
+    SECTION("all, not containing")
+    {
+        filter.texts = {"world", "hello"};
+        filter.all_texts = true;
+        filter.not_containing = true;
+        search.SetFilterContent(filter);
+        do_search(Options::GoIntoSubDirs | Options::SearchForFiles);
+        CHECK(found.size() == 2);
+        CHECK(found.contains("filename2.txt"));
+        CHECK(found.contains("filename3.txt"));
+    }
+}
+
 static void BuildTestData(const std::string &_root_path)
 {
     Save(_root_path + "filename1.txt", "Hello, world!");
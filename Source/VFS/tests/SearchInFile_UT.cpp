@@ -213,6 +213,232 @@ TEST_CASE(PREFIX "Handles case the whole phrase flag")
     }
 }
 
+TEST_CASE(PREFIX "Searches in single-byte encodings")
+{
+    // "0123456789Привет, привет" in CP1251
+    const std::string data = "0123456789\xCF\xF0\xE8\xE2\xE5\xF2, \xEF\xF0\xE8\xE2\xE5\xF2";
+    auto fw = MakeFileWindow(data);
+    auto search = SearchInFile{fw};
+    const auto lowercase = CFString(reinterpret_cast<const char *>(u8"привет"));
+    SECTION("case insensitive")
+    { // default option
+        search.ToggleTextSearch(*lowercase, Encoding::ENCODING_WIN1251);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 10);
+        CHECK(result.location->bytes_len == 6);
+    }
+    SECTION("case sensitive")
+    {
+        search.ToggleTextSearch(*lowercase, Encoding::ENCODING_WIN1251);
+        search.SetSearchOptions(SearchInFile::Options::CaseSensitive);
+        auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 18);
+        CHECK(result.location->bytes_len == 6);
+        result = search.Search();
+        CHECK(result.response == SearchInFile::Response::NotFound);
+    }
+    SECTION("case sensitive, whole phrase")
+    {
+        const auto cf_string = CFString(reinterpret_cast<const char *>(u8"ривет"));
+        search.ToggleTextSearch(*cf_string, Encoding::ENCODING_WIN1251);
+        search.SetSearchOptions(SearchInFile::Options::CaseSensitive | SearchInFile::Options::FindWholePhrase);
+        const auto result = search.Search();
+        CHECK(result.response == SearchInFile::Response::NotFound);
+    }
+    SECTION("case sensitive, not representable in the encoding")
+    {
+        const auto cf_string = CFString(reinterpret_cast<const char *>(u8"привет😁"));
+        search.ToggleTextSearch(*cf_string, Encoding::ENCODING_WIN1251);
+        search.SetSearchOptions(SearchInFile::Options::CaseSensitive);
+        const auto result = search.Search();
+        CHECK(result.response == SearchInFile::Response::NotFound);
+    }
+}
+
+TEST_CASE(PREFIX "Searches for regular expressions")
+{
+    auto fw = MakeFileWindow("first line 42\nsecond line 1234\nThird LINE");
+    auto search = SearchInFile{fw};
+    SECTION("digits")
+    {
+        search.ToggleRegexSearch("[0-9]+", Encoding::ENCODING_UTF8);
+        auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 11);
+        CHECK(result.location->bytes_len == 2);
+        result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 26);
+        CHECK(result.location->bytes_len == 4);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+    SECTION("lines boundaries")
+    {
+        search.ToggleRegexSearch("^[a-z]+", Encoding::ENCODING_UTF8);
+        search.SetSearchOptions(SearchInFile::Options::CaseSensitive);
+        auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 0);
+        CHECK(result.location->bytes_len == 5);
+        result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 14);
+        CHECK(result.location->bytes_len == 6);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+    SECTION("case insensitive")
+    {
+        search.ToggleRegexSearch("third line", Encoding::ENCODING_UTF8);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 31);
+        CHECK(result.location->bytes_len == 10);
+    }
+    SECTION("whole phrase")
+    {
+        search.ToggleRegexSearch("[0-9]{2}", Encoding::ENCODING_UTF8);
+        search.SetSearchOptions(SearchInFile::Options::FindWholePhrase);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 11);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+    SECTION("invalid expression")
+    {
+        search.ToggleRegexSearch("([0-9]", Encoding::ENCODING_UTF8);
+        CHECK(search.Search().response == SearchInFile::Response::Invalid);
+    }
+}
+
+TEST_CASE(PREFIX "Searches for regular expressions across the windows boundaries")
+{
+    const auto window_size = FileWindow::DefaultWindowSize;
+    for( const auto offset : {window_size - 3, (10 * window_size) - 10, (10 * window_size) + 1} ) {
+        std::string memory(offset, ' ');
+        memory += "key=value1234;";
+        memory.resize(memory.size() + window_size, ' ');
+
+        auto fw = MakeFileWindow(memory);
+        auto search = SearchInFile{fw};
+        search.ToggleRegexSearch("key=[a-z]+[0-9]+;", Encoding::ENCODING_UTF8);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == static_cast<uint64_t>(offset));
+        CHECK(result.location->bytes_len == 14);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+    }
+}
+
+TEST_CASE(PREFIX "Searches for regular expressions in other encodings")
+{
+    SECTION("UTF-16LE")
+    {
+        const auto string = std::string_view("\x20\x00\x3F\x04\x40\x04\x38\x04\x32\x04\x35\x04\x42\x04", 14);
+        auto fw = MakeFileWindow(string);
+        auto search = SearchInFile{fw};
+        search.ToggleRegexSearch(reinterpret_cast<const char *>(u8"пр.+т"), Encoding::ENCODING_UTF16LE);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 2);
+        CHECK(result.location->bytes_len == 12);
+    }
+    SECTION("WIN1251")
+    {
+        const auto string = std::string_view("\xcf\xf0\xe8\xe2\xe5\xf2, \xec\xe8\xf0!");
+        auto fw = MakeFileWindow(string);
+        auto search = SearchInFile{fw};
+        search.ToggleRegexSearch(reinterpret_cast<const char *>(u8"м[а-я]+"), Encoding::ENCODING_WIN1251);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 8);
+        CHECK(result.location->bytes_len == 3);
+    }
+}
+
+TEST_CASE(PREFIX "Parses hexadecimal byte patterns")
+{
+    using BP = SearchInFile::BytesPattern;
+    const auto bytes = [](std::initializer_list<unsigned> _l) {
+        std::vector<std::byte> v;
+        for( auto b : _l )
+            v.push_back(std::byte(b));
+        return v;
+    };
+    {
+        const auto p = BP::FromHex("DE ad\t0f");
+        REQUIRE(p);
+        CHECK(p->bytes == bytes({0xDE, 0xAD, 0x0F}));
+        CHECK(p->mask == bytes({0xFF, 0xFF, 0xFF}));
+    }
+    {
+        const auto p = BP::FromHex("?? 4? ?A");
+        REQUIRE(p);
+        CHECK(p->bytes == bytes({0x00, 0x40, 0x0A}));
+        CHECK(p->mask == bytes({0x00, 0xF0, 0x0F}));
+    }
+    CHECK(BP::FromHex("") == std::nullopt);
+    CHECK(BP::FromHex("  ") == std::nullopt);
+    CHECK(BP::FromHex("ABC") == std::nullopt);
+    CHECK(BP::FromHex("0x00") == std::nullopt);
+    CHECK(BP::FromHex("GG") == std::nullopt);
+}
+
+TEST_CASE(PREFIX "Searches for byte patterns")
+{
+    const auto window_size = FileWindow::DefaultWindowSize;
+    std::string memory(3 * window_size, '\0');
+    for( size_t i = 0; i < memory.size(); ++i )
+        memory[i] = static_cast<char>(i % 251);
+    const auto put = [&](size_t _offset, std::string_view _bytes) {
+        std::copy(_bytes.begin(), _bytes.end(), memory.begin() + _offset);
+    };
+    put(100, "\xDE\xAD\xBE\xEF");
+    put(window_size - 2, "\xDE\xAD\x01\xEF");
+    put(2 * window_size + 7, "\xDE\xAD\xBE\xEF");
+
+    auto fw = MakeFileWindow(memory);
+    auto search = SearchInFile{fw};
+    SECTION("exact")
+    {
+        search.ToggleBytesSearch(*SearchInFile::BytesPattern::FromHex("DEADBEEF"));
+        auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 100);
+        CHECK(result.location->bytes_len == 4);
+        result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 2 * window_size + 7);
+        CHECK(search.Search().response == SearchInFile::Response::NotFound);
+        CHECK(search.Search().response == SearchInFile::Response::EndOfFile);
+    }
+    SECTION("wildcards across the windows boundary")
+    {
+        search.ToggleBytesSearch(*SearchInFile::BytesPattern::FromHex("DE AD ?? EF"));
+        search.MoveCurrentPosition(101);
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == window_size - 2);
+        CHECK(result.location->bytes_len == 4);
+    }
+    SECTION("all wildcards")
+    {
+        search.ToggleBytesSearch(*SearchInFile::BytesPattern::FromHex("????"));
+        const auto result = search.Search();
+        REQUIRE(result.response == SearchInFile::Response::Found);
+        CHECK(result.location->offset == 0);
+        CHECK(result.location->bytes_len == 2);
+    }
+    SECTION("longer than the file")
+    {
+        auto small_fw = MakeFileWindow("\xDE\xAD");
+        auto small_search = SearchInFile{small_fw};
+        small_search.ToggleBytesSearch(*SearchInFile::BytesPattern::FromHex("DEADBEEF"));
+        CHECK(small_search.Search().response == SearchInFile::Response::NotFound);
+    }
+}
+
 static FileWindow MakeFileWindow(std::string_view _data)
 {
     assert(_data.data() != nullptr);
@@ -129,6 +129,41 @@ TEST_CASE(PREFIX "SetFlags")
     }
 }
 
+TEST_CASE(PREFIX "SetAttributes")
+{
+    const TestDir dir;
+    const auto host = TestEnv().vfs_native;
+    REQUIRE(mkdir((dir.directory / "a").c_str(), 0755) == 0);
+    std::vector<AttributesChange> changes;
+    for( const auto *name : {"a/1", "a/2", "b", "c"} ) {
+        REQUIRE(close(creat((dir.directory / name).c_str(), 0644)) == 0);
+        AttributesChange change;
+        change.path = dir.directory / name;
+        change.permissions = 0600;
+        change.flags = UF_HIDDEN;
+        change.mtime = 1'000'000'000;
+        changes.emplace_back(std::move(change));
+    }
+    AttributesChange missing;
+    missing.path = dir.directory / "a/missing";
+    missing.mtime = 1'000'000'000;
+    changes.insert(std::next(changes.begin()), missing);
+
+    std::vector<AttributesChangeResult> results(changes.size());
+    REQUIRE(host->SetAttributes(changes, results) == VFSError::Ok);
+
+    CHECK(results[1].failed == AttributesChangeResult::Step::Times);
+    CHECK(results[1].error == VFSError::FromErrno(ENOENT));
+    for( const size_t i : {0ul, 2ul, 3ul, 4ul} ) {
+        CHECK(results[i].failed == AttributesChangeResult::Step::None);
+        struct ::stat st;
+        REQUIRE(::stat(changes[i].path.c_str(), &st) == 0);
+        CHECK((st.st_mode & ~S_IFMT) == 0600);
+        CHECK(st.st_flags & UF_HIDDEN);
+        CHECK(st.st_mtimespec.tv_sec == 1'000'000'000);
+    }
+}
+
 TEST_CASE(PREFIX "Fetching")
 {
     const TestDir test_dir_holder;
@@ -0,0 +1,23 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <VFS/FileWindow.h>
+#include <Utility/EncodingDetection.h>
+
+#include <chrono>
+
+namespace nc::viewer {
+
+/**
+ * Guesses whether a file is binary or text and which encoding the text is in.
+ * Looks at several regions of the file: the head, the tail and a few pseudo-random places in the middle, so that
+ * large files with mixed contents are not judged only by their beginning.
+ * The current window of _window is the first sample, the others are read in background from an independent copy of
+ * the file, so _window is not moved.
+ * Only the current window is looked at if the file can't be read at arbitrary positions.
+ * Returns once _budget is exhausted even if a read is still in progress, the samples not read by then are ignored.
+ */
+utility::EncodingDetector::Verdict DetectContents(vfs::FileWindow &_window,
+                                                  std::chrono::nanoseconds _budget = std::chrono::milliseconds{30});
+
+} // namespace nc::viewer
@@ -1,6 +1,7 @@
 // Copyright (C) 2013-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
+#include "LineIndex.h"
 #include <VFS/FileWindow.h>
 #include <Utility/Encodings.h>
 #include <MacTypes.h>
@@ -17,6 +18,9 @@ class DataBackend
 {
 public:
     DataBackend(std::shared_ptr<nc::vfs::FileWindow> _fw, utility::Encoding _encoding);
+    DataBackend(const DataBackend &) = delete;
+    ~DataBackend();
+    DataBackend &operator=(const DataBackend &) = delete;
 
     ////////////////////////////////////////////////////////////////////////////////////////////
     // settings
@@ -25,7 +29,13 @@ public:
 
     ////////////////////////////////////////////////////////////////////////////////////////////
     // operations
-    int MoveWindowSync(uint64_t _pos); // return VFS error code
+
+    /**
+     * Moves the window to _pos. Windows are prefetched and decoded in background in the direction of the recent
+     * movements, if a requested window is already there it's swapped in without any I/O.
+     * Returns VFS error code.
+     */
+    int MoveWindowSync(uint64_t _pos);
 
     ////////////////////////////////////////////////////////////////////////////////////////////
     // data access
@@ -60,23 +70,52 @@ public:
     // Returns a filename component of the underlying VFS file's path
     std::filesystem::path FileName() const;
 
+    /**
+     * Index of lines of the whole file, it's being built in background and can be queried while in progress.
+     * May be nullptr if there's no underlying VFS file.
+     */
+    std::shared_ptr<const LineIndex> Lines() const;
+
+    struct PrefetchStatistics {
+        uint64_t hits = 0;   // window movements served from the prefetched windows
+        uint64_t misses = 0; // window movements which had to read the file synchronously
+    };
+    PrefetchStatistics PrefetchStats() const;
+
+    /**
+     * Blocks until the windows which are being prefetched in background are ready.
+     */
+    void WaitForPrefetching() const;
+
 private:
-    void DecodeBuffer(); // called by internal update logic
+    // Raw bytes of a file window along with their decoded representation, immutable once built.
+    struct Window {
+        uint64_t pos = 0;
+        utility::Encoding encoding = utility::Encoding::ENCODING_INVALID;
+        std::unique_ptr<uint8_t[]> raw;
 
-    std::shared_ptr<nc::vfs::FileWindow> m_FileWindow;
-    utility::Encoding m_Encoding;
+        // decoded buffer with unichars, useful size of decoded_size
+        std::unique_ptr<UniChar[]> decoded;
 
-    // decoded buffer with unichars
-    // useful size of m_DecodedBufferSize
-    std::unique_ptr<UniChar[]> m_DecodeBuffer;
+        // array indexing every decoded unicode character into a byte offset within the raw window,
+        // useful size of decoded_size
+        std::unique_ptr<uint32_t[]> indices;
 
-    // array indexing every m_DecodeBuffer unicode character into a
-    // byte offset within original file window
-    // useful size of m_DecodedBufferSize
-    std::unique_ptr<uint32_t[]> m_DecodeBufferIndx;
+        // amount of unichars
+        size_t decoded_size = 0;
+    };
+    struct Prefetcher;
 
-    // amount of unichars
-    size_t m_DecodedBufferSize = 0;
+    static std::shared_ptr<const Window>
+    MakeWindow(uint64_t _pos, std::unique_ptr<uint8_t[]> _raw, size_t _size, utility::Encoding _encoding);
+    std::shared_ptr<const Window> MakeWindowFromFileWindow() const;
+    void Prefetch(uint64_t _previous_pos);
+
+    std::shared_ptr<nc::vfs::FileWindow> m_FileWindow;
+    utility::Encoding m_Encoding;
+    std::shared_ptr<const Window> m_Window;   // the current window, never nullptr
+    std::shared_ptr<Prefetcher> m_Prefetcher; // may be nullptr if the file can't be read in background
+    std::shared_ptr<LineIndex> m_Lines;
 };
 
 inline uint64_t DataBackend::FileSize() const
@@ -86,12 +125,12 @@ inline uint64_t DataBackend::FileSize() const
 
 inline uint64_t DataBackend::FilePos() const
 {
-    return m_FileWindow->WindowPos();
+    return m_Window->pos;
 }
 
 inline const void *DataBackend::Raw() const
 {
-    return m_FileWindow->Window();
+    return m_Window->raw.get();
 }
 
 inline uint64_t DataBackend::RawSize() const
@@ -101,17 +140,22 @@ inline uint64_t DataBackend::RawSize() const
 
 inline const UniChar *DataBackend::UniChars() const
 {
-    return m_DecodeBuffer.get();
+    return m_Window->decoded.get();
 }
 
 inline const uint32_t *DataBackend::UniCharToByteIndeces() const
 {
-    return m_DecodeBufferIndx.get();
+    return m_Window->indices.get();
 }
 
 inline uint32_t DataBackend::UniCharsSize() const
 {
-    return static_cast<uint32_t>(m_DecodedBufferSize);
+    return static_cast<uint32_t>(m_Window->decoded_size);
+}
+
+inline std::shared_ptr<const LineIndex> DataBackend::Lines() const
+{
+    return m_Lines;
 }
 
 inline bool DataBackend::IsFullCoverage() const
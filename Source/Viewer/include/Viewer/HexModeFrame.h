@@ -1,13 +1,15 @@
-// Copyright (C) 2019-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2019-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "TextModeWorkingSet.h"
 
 #include <Utility/FontExtras.h>
 #include <Base/CFPtr.h>
+#include <Base/LRUCache.h>
 #include <Base/spinlock.h>
 
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace nc::viewer {
@@ -15,6 +17,8 @@ namespace nc::viewer {
 class HexModeFrame
 {
 public:
+    class RowsCache;
+
     struct Source {
         std::shared_ptr<const TextModeWorkingSet> working_set;
         const std::byte *raw_bytes_begin;
@@ -25,6 +29,9 @@ public:
         CTFontRef font = nullptr;
         nc::utility::FontGeometryInfo font_info;
         CGColorRef foreground_color = nullptr;
+
+        // optional, lets the rows formatted by the previous frames to be reused
+        std::shared_ptr<RowsCache> rows_cache;
     };
 
     class Row;
@@ -135,6 +142,41 @@ private:
     base::CFPtr<CFDictionaryRef> m_Attributes;
 };
 
+/**
+ * Keeps the address and the hexadecimal columns strings of recently built rows, keyed by the global offset of a row.
+ * Rows are reused only if their bytes are the same. Thread-safe.
+ */
+class HexModeFrame::RowsCache
+{
+public:
+    static constexpr size_t Capacity = 4096;
+
+    // Returns empty vector if there's no suitable row.
+    std::vector<base::CFPtr<CFStringRef>> Find(const Source &_source, long _offset, std::span<const std::byte> _bytes);
+
+    void Insert(const Source &_source,
+                long _offset,
+                std::span<const std::byte> _bytes,
+                const std::vector<base::CFPtr<CFStringRef>> &_strings);
+
+private:
+    struct Layout {
+        int bytes_per_column = 0;
+        int number_of_columns = 0;
+        int digits_in_address = 0;
+        bool operator==(const Layout &) const noexcept = default;
+    };
+    struct Entry {
+        std::vector<std::byte> bytes;
+        std::vector<base::CFPtr<CFStringRef>> strings; // address and columns
+    };
+    static Layout LayoutOf(const Source &_source) noexcept;
+
+    spinlock m_Lock;
+    Layout m_Layout;
+    base::LRUCache<long, Entry, Capacity> m_Entries;
+};
+
 class HexModeFrame::RowsBuilder
 {
 public:
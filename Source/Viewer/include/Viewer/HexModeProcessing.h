@@ -1,4 +1,4 @@
-// Copyright (C) 2019-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2019-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #pragma once
 
 #include "TextModeWorkingSet.h"
@@ -36,6 +36,13 @@ struct HexModeSplitter {
 
     static base::CFPtr<CFStringRef>
     MakeBytesHexString(const std::byte *_first, const std::byte *_last, char16_t _gap_symbol = ' ');
+
+    /**
+     * Writes 3 characters per byte: two uppercase hexadecimal digits followed by _gap_symbol.
+     * _buffer must be at least (_last - _first) * 3 characters long.
+     */
+    static void
+    FormatBytesHex(const std::byte *_first, const std::byte *_last, char16_t *_buffer, char16_t _gap_symbol) noexcept;
 };
 
 } // namespace nc::viewer
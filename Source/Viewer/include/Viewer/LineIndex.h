@@ -0,0 +1,67 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <VFS/VFSFile.h>
+#include <Utility/Encodings.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace nc::viewer {
+
+/**
+ * LineIndex maps line numbers of a whole file into byte offsets and vice versa.
+ * The file is scanned for newlines on a background queue, the index can be queried while the scanning is still in
+ * progress - the answers are precise for the already indexed part of the file and nullopt for the rest.
+ * Only a sparse table of checkpoints is kept in memory - the offset of every CheckpointStride-th line, the positions
+ * in between are resolved by rescanning a piece of the file starting from the nearest checkpoint.
+ * Lines are zero-based, a line starts at the beginning of a file and after every newline which is not the last
+ * character of a file. Thus an empty file has a single empty line.
+ * Destroying the index cancels the scanning without waiting for it.
+ */
+class LineIndex
+{
+public:
+    static constexpr uint64_t CheckpointStride = 1024;
+
+    // _file must be opened, the index reads from an independent copy of it, the original object is not touched.
+    // Only single-byte encodings, UTF-8 and UTF-16 are supported.
+    LineIndex(const VFSFilePtr &_file, utility::Encoding _encoding);
+    LineIndex(const LineIndex &) = delete;
+    ~LineIndex();
+    LineIndex &operator=(const LineIndex &) = delete;
+
+    utility::Encoding Encoding() const noexcept;
+
+    // Whether the whole file has been scanned.
+    bool IsComplete() const noexcept;
+
+    // Whether the scanning has stopped prematurely, either due to an I/O error or if the file can't be copied.
+    bool IsFailed() const noexcept;
+
+    // Amount of bytes scanned so far.
+    uint64_t IndexedBytes() const noexcept;
+
+    // Amount of lines found so far.
+    uint64_t LinesCount() const noexcept;
+
+    // Returns the offset of the beginning of the line, or nullopt if that line is not known yet.
+    // Can perform blocking I/O.
+    std::optional<uint64_t> LineToOffset(uint64_t _line) const;
+
+    // Returns the line which contains the byte at _offset, or nullopt if that part of the file is not scanned yet.
+    // Can perform blocking I/O.
+    std::optional<uint64_t> OffsetToLine(uint64_t _offset) const;
+
+    // Blocks until the scanning is over.
+    void Wait() const;
+
+private:
+    struct State;
+    static void Index(const std::shared_ptr<State> &_state, const VFSFilePtr &_file);
+
+    std::shared_ptr<State> m_State;
+};
+
+} // namespace nc::viewer
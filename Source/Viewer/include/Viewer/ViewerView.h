@@ -96,6 +96,7 @@ class SettingsStorage;
 @property(nonatomic) std::string language;
 
 - (void)scrollToVerticalPosition:(double)_p; // [0..1]
+- (bool)scrollToLine:(uint64_t)_line;        // zero-based, false if the line is not indexed (yet)
 - (void)scrollToSelection;
 - (CFRange)SelectionWithinWindow;         // bytes within a decoded window
 - (CFRange)SelectionWithinWindowUnichars; // unichars within a decoded window
@@ -0,0 +1,141 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "ContentsDetection.h"
+#include "IndependentFile.h"
+#include <Base/dispatch_cpp.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace nc::viewer {
+
+// amount of samples taken from the middle of a file in addition to the head and the tail
+static constexpr size_t g_MiddleSamples = 6;
+
+static std::span<const std::byte> Sample(const vfs::FileWindow &_window) noexcept
+{
+    return {static_cast<const std::byte *>(_window.Window()), _window.WindowSize()};
+}
+
+// Returns the positions of the samples except the current one, sorted and not overlapping with each other.
+static std::vector<uint64_t> SamplesPositions(uint64_t _file_size, uint64_t _window_size, uint64_t _current)
+{
+    std::vector<uint64_t> positions;
+    if( _file_size <= _window_size )
+        return positions;
+
+    const uint64_t max_pos = _file_size - _window_size;
+    positions.push_back(0);
+    positions.push_back(max_pos);
+    // the positions must be the same for the same file, thus a fixed seed
+    std::minstd_rand rng(static_cast<std::minstd_rand::result_type>(_file_size));
+    for( size_t i = 0; i < g_MiddleSamples; ++i ) {
+        const uint64_t pos = std::uniform_int_distribution<uint64_t>(0, max_pos)(rng);
+        positions.push_back(pos & ~uint64_t(1)); // keep the UTF-16 code units aligned
+    }
+
+    std::ranges::sort(positions);
+    std::erase_if(positions, [&](uint64_t _pos) {
+        // no sense to look at the regions overlapping with the ones already taken
+        return _pos + _window_size > _current && _pos < _current + _window_size;
+    });
+    // samples overlapping with the previous one would count the same bytes twice
+    std::vector<uint64_t> distinct;
+    for( const uint64_t pos : positions )
+        if( distinct.empty() || pos >= distinct.back() + _window_size )
+            distinct.push_back(pos);
+    return distinct;
+}
+
+// The samples read in background, shared with the reading block which may outlive the detection.
+namespace {
+struct SamplesReading {
+    std::atomic_bool abandoned = false;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<std::pair<uint64_t, std::vector<std::byte>>> samples;
+    bool done = false;
+};
+} // namespace
+
+static bool ReadSample(VFSFile &_file, uint64_t _pos, std::span<std::byte> _buffer)
+{
+    const bool random = _file.GetReadParadigm() >= VFSFile::ReadParadigm::Random;
+    if( !random && _file.Seek(static_cast<off_t>(_pos), VFSFile::Seek_Set) < 0 )
+        return false;
+    size_t done = 0;
+    while( done != _buffer.size() ) {
+        std::byte *const buffer = _buffer.data() + done;
+        const size_t left = _buffer.size() - done;
+        const ssize_t read = random ? _file.ReadAt(static_cast<off_t>(_pos + done), buffer, left)
+                                    : _file.Read(buffer, left);
+        if( read <= 0 )
+            return false;
+        done += static_cast<size_t>(read);
+    }
+    return true;
+}
+
+static void ReadSamples(const std::shared_ptr<SamplesReading> &_reading,
+                        const VFSFilePtr &_origin,
+                        const std::vector<uint64_t> &_positions,
+                        size_t _size)
+{
+    const auto file = MakeIndependentCopy(_origin);
+    for( size_t i = 0; file && i != _positions.size() && !_reading->abandoned; ++i ) {
+        std::vector<std::byte> sample(_size);
+        if( !ReadSample(*file, _positions[i], sample) )
+            break;
+        {
+            const std::lock_guard lock{_reading->mutex};
+            _reading->samples.emplace_back(_positions[i], std::move(sample));
+        }
+        _reading->ready.notify_all();
+    }
+    {
+        const std::lock_guard lock{_reading->mutex};
+        _reading->done = true;
+    }
+    _reading->ready.notify_all();
+}
+
+
+utility::EncodingDetector::Verdict DetectContents(vfs::FileWindow &_window, std::chrono::nanoseconds _budget)
+{
+    const auto deadline = std::chrono::steady_clock::now() + _budget;
+    const uint64_t initial_pos = _window.WindowPos();
+
+    utility::EncodingDetector detector;
+    detector.Feed(initial_pos, Sample(_window));
+
+    const auto paradigm = _window.File()->GetReadParadigm();
+    if( paradigm != VFSFile::ReadParadigm::Random && paradigm != VFSFile::ReadParadigm::Seek )
+        return detector.Conclude();
+
+    auto positions = SamplesPositions(_window.FileSize(), _window.WindowSize(), initial_pos);
+    if( positions.empty() )
+        return detector.Conclude();
+
+    // the samples are read in background, so a stuck read can't hold the caller for longer than the budget
+    const auto reading = std::make_shared<SamplesReading>();
+    dispatch_to_background(
+        [reading, origin = _window.File(), positions = std::move(positions), size = _window.WindowSize()] {
+            ReadSamples(reading, origin, positions, size);
+        });
+
+    auto lock = std::unique_lock{reading->mutex};
+    for( size_t consumed = 0;; ++consumed ) {
+        const bool available = reading->ready.wait_until(
+            lock, deadline, [&] { return consumed < reading->samples.size() || reading->done; });
+        if( !available || consumed == reading->samples.size() )
+            break;
+        const auto &[pos, sample] = reading->samples[consumed];
+        detector.Feed(pos, sample);
+    }
+    reading->abandoned = true;
+    return detector.Conclude();
+}
+
+} // namespace nc::viewer
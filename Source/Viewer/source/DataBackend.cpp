@@ -1,28 +1,110 @@
 // Copyright (C) 2013-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "DataBackend.h"
+#include "IndependentFile.h"
 #include <Utility/Encodings.h>
 #include <Utility/PathManip.h>
+#include <Base/LRUCache.h>
+#include <Base/dispatch_cpp.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
 
 namespace nc::viewer {
 
+// amount of decoded windows kept around, both prefetched and recently visited
+static constexpr size_t g_PrefetchCapacity = 8;
+
+// amount of windows prefetched ahead in the direction of movement
+static constexpr size_t g_PrefetchDepth = 2;
+
+struct DataBackend::Prefetcher {
+    VFSFilePtr origin; // only touched to make an independent copy
+    std::atomic_bool cancelled = false;
+
+    std::mutex file_mutex;
+    VFSFilePtr file; // an independent copy of the origin, made lazily in background
+    bool file_failed = false;
+
+    std::mutex mutex;
+    std::condition_variable pending_done; // notified whenever a window is removed from pending
+    base::LRUCache<uint64_t, std::shared_ptr<const Window>, g_PrefetchCapacity> windows;
+    std::vector<uint64_t> pending;
+    PrefetchStatistics stats;
+};
+
+// Whether newlines are represented by the same sequence of bytes in both encodings.
+static bool HaveSameNewlines(utility::Encoding _lhs, utility::Encoding _rhs) noexcept
+{
+    using utility::Encoding;
+    const auto kind = [](Encoding _e) {
+        return _e == Encoding::ENCODING_UTF16LE || _e == Encoding::ENCODING_UTF16BE ? _e : Encoding::ENCODING_UTF8;
+    };
+    return kind(_lhs) == kind(_rhs);
+}
+
+static bool ReadFully(VFSFile &_file, uint64_t _pos, uint8_t *_buffer, size_t _size)
+{
+    while( _size != 0 ) {
+        const ssize_t read = _file.ReadAt(static_cast<off_t>(_pos), _buffer, _size);
+        if( read <= 0 )
+            return false;
+        _pos += static_cast<uint64_t>(read);
+        _buffer += read;
+        _size -= static_cast<size_t>(read);
+    }
+    return true;
+}
+
 DataBackend::DataBackend(std::shared_ptr<nc::vfs::FileWindow> _fw, utility::Encoding _encoding)
-    : m_FileWindow(_fw), m_Encoding(_encoding), m_DecodeBuffer(std::make_unique<UniChar[]>(m_FileWindow->WindowSize())),
-      m_DecodeBufferIndx(std::make_unique<uint32_t[]>(m_FileWindow->WindowSize()))
+    : m_FileWindow(_fw), m_Encoding(_encoding)
 {
     assert(utility::IsValidEncoding(_encoding));
-    DecodeBuffer();
+    m_Window = MakeWindowFromFileWindow();
+    if( const auto &file = m_FileWindow->File() ) {
+        m_Lines = std::make_shared<LineIndex>(file, m_Encoding);
+        if( !IsFullCoverage() && file->GetReadParadigm() == VFSFile::ReadParadigm::Random ) {
+            m_Prefetcher = std::make_shared<Prefetcher>();
+            m_Prefetcher->origin = file;
+        }
+    }
+}
+
+DataBackend::~DataBackend()
+{
+    if( m_Prefetcher )
+        m_Prefetcher->cancelled = true;
 }
 
-void DataBackend::DecodeBuffer()
+std::shared_ptr<const DataBackend::Window> DataBackend::MakeWindow(uint64_t _pos,
+                                                                   std::unique_ptr<uint8_t[]> _raw,
+                                                                   size_t _size,
+                                                                   utility::Encoding _encoding)
 {
-    assert(utility::BytesForCodeUnit(m_Encoding) <= 2); // TODO: support for UTF-32 in the future
-    const bool odd = (utility::BytesForCodeUnit(m_Encoding) == 2) && ((m_FileWindow->WindowPos() & 1) == 1);
-    utility::InterpretAsUnichar(m_Encoding,
-                                reinterpret_cast<const unsigned char *>(m_FileWindow->Window()) + (odd ? 1 : 0),
-                                m_FileWindow->WindowSize() - (odd ? 1 : 0),
-                                m_DecodeBuffer.get(),
-                                m_DecodeBufferIndx.get(),
-                                &m_DecodedBufferSize);
+    assert(utility::BytesForCodeUnit(_encoding) <= 2); // TODO: support for UTF-32 in the future
+    auto window = std::make_shared<Window>();
+    window->pos = _pos;
+    window->encoding = _encoding;
+    window->raw = std::move(_raw);
+    window->decoded = std::make_unique<UniChar[]>(_size);
+    window->indices = std::make_unique<uint32_t[]>(_size);
+    const bool odd = (utility::BytesForCodeUnit(_encoding) == 2) && ((_pos & 1) == 1);
+    utility::InterpretAsUnichar(_encoding,
+                                window->raw.get() + (odd ? 1 : 0),
+                                _size - (odd ? 1 : 0),
+                                window->decoded.get(),
+                                window->indices.get(),
+                                &window->decoded_size);
+    return window;
+}
+
+std::shared_ptr<const DataBackend::Window> DataBackend::MakeWindowFromFileWindow() const
+{
+    const size_t size = m_FileWindow->WindowSize();
+    auto raw = std::make_unique<uint8_t[]>(size);
+    std::memcpy(raw.get(), m_FileWindow->Window(), size);
+    return MakeWindow(m_FileWindow->WindowPos(), std::move(raw), size, m_Encoding);
 }
 
 utility::Encoding DataBackend::Encoding() const
@@ -35,23 +117,136 @@ void DataBackend::SetEncoding(utility::Encoding _encoding)
     if( _encoding != m_Encoding ) {
         assert(utility::IsValidEncoding(_encoding));
         m_Encoding = _encoding;
-        DecodeBuffer();
+
+        const size_t size = RawSize();
+        auto raw = std::make_unique<uint8_t[]>(size);
+        std::memcpy(raw.get(), m_Window->raw.get(), size);
+        m_Window = MakeWindow(m_Window->pos, std::move(raw), size, m_Encoding);
+
+        if( m_Prefetcher ) {
+            const std::lock_guard lock{m_Prefetcher->mutex};
+            m_Prefetcher->windows.clear();
+        }
+
+        if( m_Lines && !HaveSameNewlines(m_Lines->Encoding(), m_Encoding) )
+            m_Lines = std::make_shared<LineIndex>(m_FileWindow->File(), m_Encoding);
     }
 }
 
 int DataBackend::MoveWindowSync(uint64_t _pos)
 {
-    if( _pos == m_FileWindow->WindowPos() )
+    if( _pos == m_Window->pos )
         return 0; // nothing to do
 
-    const int ret = m_FileWindow->MoveWindow(_pos);
-    if( ret < 0 )
-        return ret;
+    const uint64_t previous_pos = m_Window->pos;
+    std::shared_ptr<const Window> prefetched;
+    if( m_Prefetcher ) {
+        const std::lock_guard lock{m_Prefetcher->mutex};
+        if( m_Prefetcher->windows.count(_pos) && m_Prefetcher->windows.at(_pos)->encoding == m_Encoding )
+            prefetched = m_Prefetcher->windows.at(_pos);
+        ++(prefetched ? m_Prefetcher->stats.hits : m_Prefetcher->stats.misses);
+    }
+
+    if( prefetched ) {
+        m_Window = std::move(prefetched);
+    }
+    else {
+        const int ret = m_FileWindow->MoveWindow(_pos);
+        if( ret < 0 )
+            return ret;
+        m_Window = MakeWindowFromFileWindow();
+        if( m_Prefetcher ) {
+            const std::lock_guard lock{m_Prefetcher->mutex};
+            m_Prefetcher->windows.insert(_pos, m_Window);
+        }
+    }
 
-    DecodeBuffer();
+    Prefetch(previous_pos);
     return 0;
 }
 
+void DataBackend::Prefetch(uint64_t _previous_pos)
+{
+    if( !m_Prefetcher )
+        return;
+
+    // assume that the movement continues in the same direction with the same stride, ignore jumps
+    const uint64_t pos = m_Window->pos;
+    const uint64_t max_pos = FileSize() - RawSize();
+    const bool forward = pos > _previous_pos;
+    const uint64_t stride = forward ? pos - _previous_pos : _previous_pos - pos;
+    if( stride > RawSize() )
+        return;
+
+    std::vector<uint64_t> positions;
+    {
+        const std::lock_guard lock{m_Prefetcher->mutex};
+        auto &windows = m_Prefetcher->windows;
+        auto &pending = m_Prefetcher->pending;
+        for( size_t i = 1; i <= g_PrefetchDepth; ++i ) {
+            const uint64_t delta = stride * i;
+            const uint64_t next = forward ? std::min(pos + delta, max_pos) : (pos > delta ? pos - delta : 0);
+            if( next == pos || std::ranges::find(positions, next) != positions.end() )
+                continue;
+            if( windows.count(next) ) {
+                windows.at(next); // refreshes the window, so it's not evicted before being reached
+                continue;
+            }
+            if( std::ranges::find(pending, next) != pending.end() )
+                continue;
+            positions.push_back(next);
+        }
+        pending.insert(pending.end(), positions.begin(), positions.end());
+    }
+    if( positions.empty() )
+        return;
+
+    dispatch_to_background([prefetcher = m_Prefetcher,
+                            positions = std::move(positions),
+                            size = static_cast<size_t>(RawSize()),
+                            encoding = m_Encoding] {
+        for( const uint64_t window_pos : positions ) {
+            std::shared_ptr<const Window> window;
+            if( !prefetcher->cancelled ) {
+                const std::lock_guard lock{prefetcher->file_mutex};
+                if( !prefetcher->file && !prefetcher->file_failed ) {
+                    prefetcher->file = MakeIndependentCopy(prefetcher->origin);
+                    prefetcher->file_failed = prefetcher->file == nullptr;
+                }
+                if( prefetcher->file ) {
+                    auto raw = std::make_unique<uint8_t[]>(size);
+                    if( ReadFully(*prefetcher->file, window_pos, raw.get(), size) )
+                        window = MakeWindow(window_pos, std::move(raw), size, encoding);
+                }
+            }
+
+            {
+                const std::lock_guard lock{prefetcher->mutex};
+                std::erase(prefetcher->pending, window_pos);
+                if( window )
+                    prefetcher->windows.insert(window_pos, std::move(window));
+            }
+            prefetcher->pending_done.notify_all();
+        }
+    });
+}
+
+void DataBackend::WaitForPrefetching() const
+{
+    if( !m_Prefetcher )
+        return;
+    auto lock = std::unique_lock{m_Prefetcher->mutex};
+    m_Prefetcher->pending_done.wait(lock, [this] { return m_Prefetcher->pending.empty(); });
+}
+
+DataBackend::PrefetchStatistics DataBackend::PrefetchStats() const
+{
+    if( !m_Prefetcher )
+        return {};
+    const std::lock_guard lock{m_Prefetcher->mutex};
+    return m_Prefetcher->stats;
+}
+
 std::filesystem::path DataBackend::FileName() const
 {
     if( !m_FileWindow->File() ) {
@@ -197,26 +197,50 @@ HexModeFrame::Row HexModeFrame::RowsBuilder::Build(const std::pair<int, int> _ch
     if( _row_bytes.first < 0 || _row_bytes.second < 0 || _row_bytes.first + _row_bytes.second > m_RawBytesNumber )
         throw std::out_of_range("HexModeFrame::RowsBuilder::Build invalid _row_bytes");
 
+    const auto row_bytes =
+        std::span<const std::byte>(m_Source.raw_bytes_begin + _row_bytes.first, static_cast<size_t>(_row_bytes.second));
+    const long row_offset = m_Source.working_set->GlobalOffset() + _row_bytes.first;
+
+    // the address and the columns depend only on the offset and the bytes of a row, try to reuse them
+    std::vector<base::CFPtr<CFStringRef>> cached;
+    if( m_Source.rows_cache )
+        cached = m_Source.rows_cache->Find(m_Source, row_offset, row_bytes);
+
     std::vector<base::CFPtr<CFStringRef>> strings;
+    if( !cached.empty() ) {
+        strings.reserve(cached.size() + 1);
+        strings.emplace_back(std::move(cached.front()));
+        strings.emplace_back(MakeSubstring(m_Source.working_set->String(), _chars_indices));
+        std::move(std::next(cached.begin()), cached.end(), std::back_inserter(strings));
+    }
+    else {
+        // AddressIndex = 0
+        auto address_str = HexModeSplitter::MakeAddressString(_row_bytes.first,
+                                                              m_Source.working_set->GlobalOffset(),
+                                                              m_Source.bytes_per_column * m_Source.number_of_columns,
+                                                              m_Source.digits_in_address);
+        strings.emplace_back(std::move(address_str));
+
+        // SnippetIndex = 1
+        strings.emplace_back(MakeSubstring(m_Source.working_set->String(), _chars_indices));
 
-    // AddressIndex = 0
-    auto address_str = HexModeSplitter::MakeAddressString(_row_bytes.first,
-                                                          m_Source.working_set->GlobalOffset(),
-                                                          m_Source.bytes_per_column * m_Source.number_of_columns,
-                                                          m_Source.digits_in_address);
-    strings.emplace_back(std::move(address_str));
-
-    // SnippetIndex = 1
-    strings.emplace_back(MakeSubstring(m_Source.working_set->String(), _chars_indices));
-
-    // ColumnsBaseIndex = 2
-    auto bytes_ptr = m_Source.raw_bytes_begin + _row_bytes.first;
-    const auto bytes_end = bytes_ptr + _row_bytes.second;
-    const auto bytes_per_column = m_Source.bytes_per_column;
-    for( int column = 0; column < m_Source.number_of_columns && bytes_ptr < bytes_end; ++column ) {
-        const auto to_consume = std::min(bytes_per_column, int(bytes_end - bytes_ptr));
-        strings.emplace_back(HexModeSplitter::MakeBytesHexString(bytes_ptr, bytes_ptr + to_consume));
-        bytes_ptr += to_consume;
+        // ColumnsBaseIndex = 2
+        auto bytes_ptr = row_bytes.data();
+        const auto bytes_end = bytes_ptr + row_bytes.size();
+        const auto bytes_per_column = m_Source.bytes_per_column;
+        for( int column = 0; column < m_Source.number_of_columns && bytes_ptr < bytes_end; ++column ) {
+            const auto to_consume = std::min(bytes_per_column, int(bytes_end - bytes_ptr));
+            strings.emplace_back(HexModeSplitter::MakeBytesHexString(bytes_ptr, bytes_ptr + to_consume));
+            bytes_ptr += to_consume;
+        }
+
+        if( m_Source.rows_cache ) {
+            std::vector<base::CFPtr<CFStringRef>> to_cache;
+            to_cache.reserve(strings.size() - 1);
+            to_cache.emplace_back(strings[Row::AddressIndex]);
+            to_cache.insert(to_cache.end(), std::next(strings.begin(), Row::ColumnsBaseIndex), strings.end());
+            m_Source.rows_cache->Insert(m_Source, row_offset, row_bytes, to_cache);
+        }
     }
 
     // make place for future CTLine objects
@@ -225,4 +249,34 @@ HexModeFrame::Row HexModeFrame::RowsBuilder::Build(const std::pair<int, int> _ch
     return {_chars_indices, _string_bytes, _row_bytes, std::move(strings), std::move(lines), m_Attributes};
 }
 
+HexModeFrame::RowsCache::Layout HexModeFrame::RowsCache::LayoutOf(const Source &_source) noexcept
+{
+    return {_source.bytes_per_column, _source.number_of_columns, _source.digits_in_address};
+}
+
+std::vector<base::CFPtr<CFStringRef>>
+HexModeFrame::RowsCache::Find(const Source &_source, long _offset, std::span<const std::byte> _bytes)
+{
+    const std::lock_guard<spinlock> guard(m_Lock);
+    if( m_Layout != LayoutOf(_source) || m_Entries.count(_offset) == 0 )
+        return {};
+    const auto &entry = m_Entries.at(_offset);
+    if( !std::ranges::equal(entry.bytes, _bytes) )
+        return {};
+    return entry.strings;
+}
+
+void HexModeFrame::RowsCache::Insert(const Source &_source,
+                                     long _offset,
+                                     std::span<const std::byte> _bytes,
+                                     const std::vector<base::CFPtr<CFStringRef>> &_strings)
+{
+    const std::lock_guard<spinlock> guard(m_Lock);
+    if( m_Layout != LayoutOf(_source) ) {
+        m_Entries.clear();
+        m_Layout = LayoutOf(_source);
+    }
+    m_Entries.insert(_offset, Entry{{_bytes.begin(), _bytes.end()}, _strings});
+}
+
 } // namespace nc::viewer
@@ -1,8 +1,16 @@
-// Copyright (C) 2019-2021 Michael Kazakov. Subject to GNU General Public License version 3.
+// Copyright (C) 2019-2024 Michael Kazakov. Subject to GNU General Public License version 3.
 #include "HexModeProcessing.h"
 
+#include <array>
+#include <cstring>
 #include <string>
 
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
 namespace nc::viewer {
 
 static constexpr char g_4Bits_To_Char[16] =
@@ -88,18 +96,65 @@ base::CFPtr<CFStringRef> HexModeSplitter::MakeAddressString(const int _row_bytes
     return base::CFPtr<CFStringRef>::adopt(str);
 }
 
-static void Fill(const std::byte *const _first,
-                 const std::byte *const _last,
-                 char16_t *const _buffer,
-                 const char16_t _gap_symbol) noexcept
+// Both hexadecimal digits of every byte, the high one goes first in memory.
+static constexpr std::array<std::array<char16_t, 2>, 256> g_Byte_To_Chars = [] {
+    std::array<std::array<char16_t, 2>, 256> table{};
+    for( int c = 0; c < 256; ++c )
+        table[c] = {static_cast<char16_t>(g_4Bits_To_Char[c >> 4]), static_cast<char16_t>(g_4Bits_To_Char[c & 0xF])};
+    return table;
+}();
+
+void HexModeSplitter::FormatBytesHex(const std::byte *const _first,
+                                     const std::byte *const _last,
+                                     char16_t *const _buffer,
+                                     const char16_t _gap_symbol) noexcept
 {
+    auto source = _first;
     auto target = _buffer;
-    for( auto source = _first; source < _last; source += 1, target += 3 ) {
-        const auto c = static_cast<int>(*source);
-        const auto lower_4bits = g_4Bits_To_Char[c & 0x0F];
-        const auto upper_4bits = g_4Bits_To_Char[(c & 0xF0) >> 4];
-        target[0] = upper_4bits;
-        target[1] = lower_4bits;
+#if defined(__aarch64__)
+    const uint8x16_t digits = vld1q_u8(reinterpret_cast<const uint8_t *>(g_4Bits_To_Char));
+    const uint16x8_t gap = vdupq_n_u16(_gap_symbol);
+    for( ; _last - source >= 16; source += 16, target += 48 ) {
+        const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t *>(source));
+        const uint8x16_t high = vqtbl1q_u8(digits, vshrq_n_u8(bytes, 4));
+        const uint8x16_t low = vqtbl1q_u8(digits, vandq_u8(bytes, vdupq_n_u8(0xF)));
+        // the structured store interleaves high digits, low digits and gaps
+        const uint16x8x3_t first = {vmovl_u8(vget_low_u8(high)), vmovl_u8(vget_low_u8(low)), gap};
+        const uint16x8x3_t second = {vmovl_high_u8(high), vmovl_high_u8(low), gap};
+        vst3q_u16(reinterpret_cast<uint16_t *>(target), first);
+        vst3q_u16(reinterpret_cast<uint16_t *>(target + 24), second);
+    }
+#elif defined(__SSSE3__)
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(g_4Bits_To_Char));
+    const __m128i low_nibble = _mm_set1_epi8(0xF);
+    const __m128i zero = _mm_setzero_si128();
+    // spread pairs of digits into triplets, leaving zeroes in place of the gaps
+    const __m128i spread_0 = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+    const __m128i spread_1 = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const auto g = static_cast<short>(_gap_symbol);
+    const __m128i gaps_0 = _mm_setr_epi16(0, 0, g, 0, 0, g, 0, 0);
+    const __m128i gaps_1 = _mm_setr_epi16(g, 0, 0, g, 0, 0, g, 0);
+    const __m128i gaps_2 = _mm_setr_epi16(0, g, 0, 0, g, 0, 0, g);
+    const auto store = [&](__m128i _pairs, char16_t *_target) {
+        const __m128i triplets_0 = _mm_shuffle_epi8(_pairs, spread_0);
+        const __m128i triplets_1 = _mm_shuffle_epi8(_pairs, spread_1);
+        const auto out = reinterpret_cast<__m128i *>(_target);
+        _mm_storeu_si128(out + 0, _mm_or_si128(_mm_unpacklo_epi8(triplets_0, zero), gaps_0));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_unpackhi_epi8(triplets_0, zero), gaps_1));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_unpacklo_epi8(triplets_1, zero), gaps_2));
+    };
+    for( ; _last - source >= 16; source += 16, target += 48 ) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source));
+        const __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibble));
+        const __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, low_nibble));
+        store(_mm_unpacklo_epi8(high, low), target);
+        store(_mm_unpackhi_epi8(high, low), target + 24);
+    }
+#endif
+    for( ; source < _last; source += 1, target += 3 ) {
+        const auto &chars = g_Byte_To_Chars[static_cast<uint8_t>(*source)];
+        target[0] = chars[0];
+        target[1] = chars[1];
         target[2] = _gap_symbol;
     }
 }
@@ -110,21 +165,14 @@ base::CFPtr<CFStringRef> HexModeSplitter::MakeBytesHexString(const std::byte *co
 {
     const auto size = static_cast<int>(_last - _first);
     const auto chars_per_byte = 3;
-    const auto max_bytes_via_alloca = 1024;
-    if( size * chars_per_byte * sizeof(char16_t) < max_bytes_via_alloca ) {
-        auto buffer = static_cast<char16_t *>(alloca(size * chars_per_byte * sizeof(char16_t)));
-        Fill(_first, _last, buffer, _gap_symbol);
-        const auto str = CFStringCreateWithCharacters(
-            nullptr, reinterpret_cast<const UniChar *>(buffer), std::max(size * chars_per_byte - 1, 0));
-        return base::CFPtr<CFStringRef>::adopt(str);
-    }
-    else {
-        std::u16string buffer(size * chars_per_byte, static_cast<char16_t>(0));
-        Fill(_first, _last, buffer.data(), _gap_symbol);
-        const auto str = CFStringCreateWithCharacters(
-            nullptr, reinterpret_cast<const UniChar *>(buffer.data()), std::max(size * chars_per_byte - 1, 0));
-        return base::CFPtr<CFStringRef>::adopt(str);
-    }
+    // rows are formatted over and over again, keep the buffer around instead of allocating it every time
+    static thread_local std::u16string buffer;
+    if( buffer.size() < static_cast<size_t>(size * chars_per_byte) )
+        buffer.resize(size * chars_per_byte);
+    FormatBytesHex(_first, _last, buffer.data(), _gap_symbol);
+    const auto str = CFStringCreateWithCharacters(
+        nullptr, reinterpret_cast<const UniChar *>(buffer.data()), std::max(size * chars_per_byte - 1, 0));
+    return base::CFPtr<CFStringRef>::adopt(str);
 }
 
 } // namespace nc::viewer
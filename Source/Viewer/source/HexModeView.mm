@@ -26,6 +26,7 @@ static std::shared_ptr<const TextModeWorkingSet> BuildWorkingSetForBackendState(
     NSScrollView *m_ScrollView;
     std::shared_ptr<const TextModeWorkingSet> m_WorkingSet;
     std::shared_ptr<const HexModeFrame> m_Frame;
+    std::shared_ptr<HexModeFrame::RowsCache> m_RowsCache;
     FontGeometryInfo m_FontInfo;
     std::unique_ptr<HexModeLayout> m_Layout;
     NSScroller *m_VerticalScroller;
@@ -44,6 +45,7 @@ static std::shared_ptr<const TextModeWorkingSet> BuildWorkingSetForBackendState(
         m_Theme = &_theme;
         m_FontInfo = FontGeometryInfo{(__bridge CTFontRef)m_Theme->Font()};
         m_WorkingSet = MakeEmptyWorkingSet();
+        m_RowsCache = std::make_shared<HexModeFrame::RowsCache>();
         m_Frame = [self buildFrame];
 
         HexModeLayout::Source layout_source;
@@ -133,6 +135,7 @@ static std::shared_ptr<const TextModeWorkingSet> BuildWorkingSetForBackendState(
     source.raw_bytes_end = reinterpret_cast<const std::byte *>(m_Backend->Raw()) + m_Backend->RawSize();
     source.number_of_columns = 2;
     source.bytes_per_column = 8;
+    source.rows_cache = m_RowsCache;
 
     return std::make_shared<HexModeFrame>(source);
 }
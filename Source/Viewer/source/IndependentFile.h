@@ -0,0 +1,23 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#pragma once
+
+#include <VFS/VFSFile.h>
+#include <VFS/VFSError.h>
+#include <VFS/VFSSeqToRandomWrapper.h>
+
+namespace nc::viewer {
+
+// Returns an opened file which can be read from a background thread independently from _file, or nullptr if the file
+// can't be copied. Can perform blocking I/O.
+inline VFSFilePtr MakeIndependentCopy(const VFSFilePtr &_file)
+{
+    if( auto wrapper = std::dynamic_pointer_cast<VFSSeqToRandomROWrapperFile>(_file) )
+        return wrapper->Share();
+
+    auto clone = _file->Clone();
+    if( !clone || clone->Open(VFSFlags::OF_Read) != VFSError::Ok )
+        return nullptr;
+    return clone;
+}
+
+} // namespace nc::viewer
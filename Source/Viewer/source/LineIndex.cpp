@@ -0,0 +1,334 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "LineIndex.h"
+#include "IndependentFile.h"
+#include "Log.h"
+#include <Base/dispatch_cpp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace nc::viewer {
+
+// size of the reads done by the background scanning
+static constexpr size_t g_IndexingChunkSize = 1024 * 1024;
+
+// size of the reads done when resolving a query, at most CheckpointStride lines have to be skipped
+static constexpr size_t g_QueryChunkSize = 64 * 1024;
+
+// newlines are searched in blocks of this size, one bit of a mask per byte
+static constexpr size_t g_BlockSize = 64;
+
+struct LineIndex::State {
+    utility::Encoding encoding;
+    std::atomic_bool cancelled = false;
+
+    // the copy of the file used by the scanning and by the queries
+    std::mutex file_mutex;
+    VFSFilePtr file;
+
+    mutable std::mutex mutex;
+    mutable std::condition_variable done_cv;
+    std::vector<uint64_t> checkpoints{0}; // offsets of the lines #0, #CheckpointStride, #2*CheckpointStride etc
+    uint64_t newlines = 0;
+    uint64_t last_line_start = 0;
+    uint64_t indexed_bytes = 0;
+    uint64_t file_size = 0;
+    bool complete = false;
+    bool failed = false;
+    bool done = false;
+
+    // must be called with the mutex held
+    uint64_t LinesCount() const noexcept
+    {
+        const bool trailing_newline = complete && newlines != 0 && last_line_start == file_size;
+        return newlines + 1 - (trailing_newline ? 1 : 0);
+    }
+};
+
+// Builds a bitmask of the bytes which are equal to _value in a 64-byte block.
+static inline uint64_t EqualityMask(const unsigned char *_block, unsigned char _value) noexcept
+{
+#if defined(__aarch64__)
+    const uint8x16_t value = vdupq_n_u8(_value);
+    const uint8x16_t bits = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t masks[4];
+    for( int i = 0; i < 4; ++i )
+        masks[i] = vandq_u8(vceqq_u8(vld1q_u8(_block + 16 * i), value), bits);
+    // three rounds of pairwise additions squeeze every 8 weighted bytes into a single byte
+    const uint8x16_t sum = vpaddq_u8(vpaddq_u8(masks[0], masks[1]), vpaddq_u8(masks[2], masks[3]));
+    return vgetq_lane_u64(vreinterpretq_u64_u8(vpaddq_u8(sum, sum)), 0);
+#elif defined(__SSE2__)
+    const __m128i value = _mm_set1_epi8(static_cast<char>(_value));
+    uint64_t mask = 0;
+    for( int i = 0; i < 4; ++i ) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_block + 16 * i));
+        mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, value))))
+                << (16 * i);
+    }
+    return mask;
+#else
+    uint64_t mask = 0;
+    for( size_t i = 0; i < g_BlockSize; ++i )
+        if( _block[i] == _value )
+            mask |= uint64_t(1) << i;
+    return mask;
+#endif
+}
+
+// Builds a bitmask of the newlines in a 64-byte block. For UTF-16 only the meaningful byte of a newline is marked.
+static inline uint64_t NewlinesMask(const unsigned char *_block, utility::Encoding _encoding) noexcept
+{
+    const uint64_t lf = EqualityMask(_block, '\n');
+    if( lf == 0 )
+        return 0;
+    if( _encoding == utility::Encoding::ENCODING_UTF16LE ) // 0A 00 at an even offset
+        return lf & (EqualityMask(_block, 0) >> 1) & 0x5555555555555555ULL;
+    if( _encoding == utility::Encoding::ENCODING_UTF16BE ) // 00 0A at an even offset
+        return lf & (EqualityMask(_block, 0) << 1) & 0xAAAAAAAAAAAAAAAAULL;
+    return lf;
+}
+
+// Calls _on_line_start with the offset, relative to _data, of every line started by a newline within the buffer,
+// and stops once it returns false. The buffer must begin at an even offset of a file in case of UTF-16.
+// Returns false if the enumeration was stopped.
+template <class F>
+static bool ForEachLineStart(const unsigned char *_data, size_t _size, utility::Encoding _encoding, F &&_on_line_start)
+{
+    // the line starts right after the newline, i.e. after the 00 byte in case of UTF-16LE
+    const size_t distance = _encoding == utility::Encoding::ENCODING_UTF16LE ? 2 : 1;
+    for( size_t base = 0; base < _size; base += g_BlockSize ) {
+        uint64_t mask = 0;
+        if( _size - base >= g_BlockSize ) {
+            mask = NewlinesMask(_data + base, _encoding);
+        }
+        else {
+            unsigned char tail[g_BlockSize];
+            memset(tail, 0xFF, sizeof(tail)); // neither a newline nor a zero
+            memcpy(tail, _data + base, _size - base);
+            mask = NewlinesMask(tail, _encoding);
+        }
+        for( ; mask != 0; mask &= mask - 1 )
+            if( !_on_line_start(base + static_cast<size_t>(std::countr_zero(mask)) + distance) )
+                return false;
+    }
+    return true;
+}
+
+static bool IsUTF16(utility::Encoding _encoding) noexcept
+{
+    return _encoding == utility::Encoding::ENCODING_UTF16LE || _encoding == utility::Encoding::ENCODING_UTF16BE;
+}
+
+// Reads [_from, _to) in chunks and feeds the absolute offsets of line starts into _on_line_start.
+// Returns false on I/O errors. Must be called with the file mutex held.
+template <class F>
+static bool ScanRange(VFSFile &_file, utility::Encoding _encoding, uint64_t _from, uint64_t _to, F &&_on_line_start)
+{
+    const auto buffer = std::make_unique<unsigned char[]>(g_QueryChunkSize);
+    for( uint64_t offset = _from; offset < _to; ) {
+        const size_t to_read = std::min(uint64_t(g_QueryChunkSize), _to - offset);
+        const ssize_t read = _file.ReadAt(static_cast<off_t>(offset), buffer.get(), to_read);
+        if( read <= 0 )
+            return false;
+        size_t size = static_cast<size_t>(read);
+        if( IsUTF16(_encoding) && offset + size < _to )
+            size &= ~size_t(1); // keep the next read aligned to code units
+        if( size == 0 )
+            return false;
+        const bool go_on = ForEachLineStart(
+            buffer.get(), size, _encoding, [&](size_t _start) { return _on_line_start(offset + _start); });
+        if( !go_on )
+            break;
+        offset += size;
+    }
+    return true;
+}
+
+LineIndex::LineIndex(const VFSFilePtr &_file, utility::Encoding _encoding) : m_State(std::make_shared<State>())
+{
+    assert(_file);
+    assert(utility::BytesForCodeUnit(_encoding) <= 2);
+    m_State->encoding = _encoding;
+    dispatch_to_background([state = m_State, file = _file] { Index(state, file); });
+}
+
+LineIndex::~LineIndex()
+{
+    m_State->cancelled = true;
+}
+
+void LineIndex::Index(const std::shared_ptr<State> &_state, const VFSFilePtr &_file)
+{
+    State &state = *_state;
+    const auto finish = [&](bool _complete, bool _failed) {
+        {
+            const std::lock_guard lock{state.mutex};
+            state.complete = _complete;
+            state.failed = _failed;
+            state.done = true;
+        }
+        state.done_cv.notify_all();
+    };
+
+    const VFSFilePtr file = MakeIndependentCopy(_file);
+    const ssize_t file_size = file ? file->Size() : -1;
+    if( file_size < 0 ) {
+        Log::Warn("LineIndex: unable to open a copy of {}", _file->Path());
+        finish(false, true);
+        return;
+    }
+    {
+        const std::lock_guard lock{state.file_mutex};
+        state.file = file;
+    }
+    {
+        const std::lock_guard lock{state.mutex};
+        state.file_size = static_cast<uint64_t>(file_size);
+    }
+
+    const auto buffer = std::make_unique<unsigned char[]>(g_IndexingChunkSize);
+    std::vector<uint64_t> checkpoints;
+    uint64_t newlines = 0;
+    uint64_t last_line_start = 0;
+    uint64_t offset = 0;
+    while( offset < static_cast<uint64_t>(file_size) ) {
+        if( state.cancelled ) {
+            finish(false, false);
+            return;
+        }
+
+        const size_t to_read = std::min(uint64_t(g_IndexingChunkSize), file_size - offset);
+        ssize_t read = 0;
+        {
+            const std::lock_guard lock{state.file_mutex};
+            read = file->ReadAt(static_cast<off_t>(offset), buffer.get(), to_read);
+        }
+        size_t size = read > 0 ? static_cast<size_t>(read) : 0;
+        if( IsUTF16(state.encoding) && offset + size < static_cast<uint64_t>(file_size) )
+            size &= ~size_t(1); // keep the next read aligned to code units
+        if( size == 0 ) {
+            Log::Warn("LineIndex: failed to read {} at {}, error: {}", _file->Path(), offset, read);
+            finish(false, true);
+            return;
+        }
+
+        checkpoints.clear();
+        ForEachLineStart(buffer.get(), size, state.encoding, [&](size_t _start) {
+            last_line_start = offset + _start;
+            if( ++newlines % CheckpointStride == 0 )
+                checkpoints.push_back(last_line_start);
+            return true;
+        });
+        offset += size;
+
+        const std::lock_guard lock{state.mutex};
+        state.checkpoints.insert(state.checkpoints.end(), checkpoints.begin(), checkpoints.end());
+        state.newlines = newlines;
+        state.last_line_start = last_line_start;
+        state.indexed_bytes = offset;
+    }
+    finish(true, false);
+}
+
+utility::Encoding LineIndex::Encoding() const noexcept
+{
+    return m_State->encoding;
+}
+
+bool LineIndex::IsComplete() const noexcept
+{
+    const std::lock_guard lock{m_State->mutex};
+    return m_State->complete;
+}
+
+bool LineIndex::IsFailed() const noexcept
+{
+    const std::lock_guard lock{m_State->mutex};
+    return m_State->failed;
+}
+
+uint64_t LineIndex::IndexedBytes() const noexcept
+{
+    const std::lock_guard lock{m_State->mutex};
+    return m_State->indexed_bytes;
+}
+
+uint64_t LineIndex::LinesCount() const noexcept
+{
+    const std::lock_guard lock{m_State->mutex};
+    return m_State->LinesCount();
+}
+
+std::optional<uint64_t> LineIndex::LineToOffset(uint64_t _line) const
+{
+    uint64_t checkpoint = 0;
+    uint64_t indexed_bytes = 0;
+    {
+        const std::lock_guard lock{m_State->mutex};
+        if( _line >= m_State->LinesCount() )
+            return std::nullopt;
+        checkpoint = m_State->checkpoints[_line / CheckpointStride];
+        indexed_bytes = m_State->indexed_bytes;
+    }
+
+    const uint64_t to_skip = _line % CheckpointStride;
+    if( to_skip == 0 )
+        return checkpoint;
+
+    const std::lock_guard lock{m_State->file_mutex};
+    uint64_t skipped = 0;
+    std::optional<uint64_t> offset;
+    ScanRange(*m_State->file, m_State->encoding, checkpoint, indexed_bytes, [&](uint64_t _start) {
+        if( ++skipped != to_skip )
+            return true;
+        offset = _start;
+        return false;
+    });
+    return offset;
+}
+
+std::optional<uint64_t> LineIndex::OffsetToLine(uint64_t _offset) const
+{
+    uint64_t checkpoint = 0;
+    uint64_t line = 0;
+    {
+        const std::lock_guard lock{m_State->mutex};
+        if( _offset >= m_State->indexed_bytes )
+            return std::nullopt;
+        const auto &checkpoints = m_State->checkpoints;
+        const auto it = std::prev(std::upper_bound(checkpoints.begin(), checkpoints.end(), _offset));
+        checkpoint = *it;
+        line = static_cast<uint64_t>(std::distance(checkpoints.begin(), it)) * CheckpointStride;
+    }
+
+    const std::lock_guard lock{m_State->file_mutex};
+    const bool scanned = ScanRange(*m_State->file, m_State->encoding, checkpoint, _offset + 1, [&](uint64_t _start) {
+        if( _start > _offset )
+            return false;
+        ++line;
+        return true;
+    });
+    if( !scanned )
+        return std::nullopt;
+    return line;
+}
+
+void LineIndex::Wait() const
+{
+    std::unique_lock lock{m_State->mutex};
+    m_State->done_cv.wait(lock, [&] { return m_State->done; });
+}
+
+} // namespace nc::viewer
@@ -3,11 +3,11 @@
 #include "Highlighting/SettingsStorage.h"
 #include <Utility/HexadecimalColor.h>
 #include <Utility/NSView+Sugar.h>
-#include <Utility/DataBlockAnalysis.h>
 #include <Utility/TemporaryFileStorage.h>
 #include <Utility/ObjCpp.h>
 #include <Config/Config.h>
 #include "DataBackend.h"
+#include "ContentsDetection.h"
 #include <Base/dispatch_cpp.h>
 #include <VFS/VFS.h>
 #include "Theme.h"
@@ -172,20 +172,13 @@ using namespace nc::viewer;
     if( encoding == utility::Encoding::ENCODING_INVALID )
         encoding = utility::Encoding::ENCODING_MACOS_ROMAN_WESTERN; // this should not happen, but just to be sure
 
-    StaticDataBlockAnalysis stat;
-    DoStaticDataBlockAnalysis(_file->Window(), _file->WindowSize(), &stat);
+    const auto verdict = DetectContents(*_file);
     if( m_Config->GetBool(g_ConfigAutoDetectEncoding) ) {
-        if( stat.likely_utf16_le )
-            encoding = utility::Encoding::ENCODING_UTF16LE;
-        else if( stat.likely_utf16_be )
-            encoding = utility::Encoding::ENCODING_UTF16BE;
-        else if( stat.can_be_utf8 )
-            encoding = utility::Encoding::ENCODING_UTF8;
-        else
-            encoding = utility::Encoding::ENCODING_MACOS_ROMAN_WESTERN;
+        const auto &best = verdict.candidates.front();
+        encoding = best.confidence > 0. ? best.encoding : utility::Encoding::ENCODING_MACOS_ROMAN_WESTERN;
     }
 
-    ViewMode mode = stat.is_binary ? ViewMode::Hex : ViewMode::Text;
+    ViewMode mode = verdict.is_binary ? ViewMode::Hex : ViewMode::Text;
 
     [self setKnownFile:_file encoding:encoding mode:mode language:std::nullopt];
 }
@@ -413,7 +406,7 @@ using namespace nc::viewer;
 
 - (uint64_t)verticalPositionInBytes
 {
-    // should always be = uint64_t(m_ViewImpl->GetOffsetWithinWindow()) + m_File->WindowPos()
+    // should always be = uint64_t(m_ViewImpl->GetOffsetWithinWindow()) + m_Data->FilePos()
     return m_VerticalPositionInBytes;
 }
 
@@ -434,6 +427,17 @@ using namespace nc::viewer;
     }
 }
 
+- (bool)scrollToLine:(uint64_t)_line
+{
+    if( !m_Data || !m_Data->Lines() )
+        return false;
+    const auto offset = m_Data->Lines()->LineToOffset(_line);
+    if( !offset )
+        return false;
+    self.verticalPositionInBytes = *offset;
+    return true;
+}
+
 // searching for selected UniChars in file window if there's any overlapping of
 // selected bytes in file on current window position
 // this method should be called on any file window movement
@@ -448,8 +452,8 @@ using namespace nc::viewer;
         return;
     }
 
-    uint64_t window_pos = m_File->WindowPos();
-    uint64_t window_size = m_File->WindowSize();
+    uint64_t window_pos = m_Data->FilePos();
+    uint64_t window_size = m_Data->RawSize();
 
     uint64_t start = m_SelectionInFile.location;
     uint64_t end = start + m_SelectionInFile.length;
@@ -22,6 +22,7 @@ using namespace nc::viewer;
 static const auto g_ConfigRespectComAppleTextEncoding = "viewer.respectComAppleTextEncoding";
 static const auto g_ConfigSearchCaseSensitive = "viewer.searchCaseSensitive";
 static const auto g_ConfigSearchForWholePhrase = "viewer.searchForWholePhrase";
+static const auto g_ConfigSearchMode = "viewer.searchMode";
 static const auto g_ConfigWindowSize = "viewer.fileWindowSize";
 static const auto g_ConfigAutomaticRefresh = "viewer.automaticRefresh";
 static const auto g_AutomaticRefreshDelay = std::chrono::milliseconds(200);
@@ -70,6 +71,37 @@ struct BackgroundFileOpener {
     std::shared_ptr<nc::vfs::SearchInFile> search_in_file;
 };
 
+// the values are persisted in the config
+enum class SearchMode : int {
+    Text = 0,
+    Regex = 1,
+    Hex = 2
+};
+
+struct SearchRequest {
+    std::string text; // utf8-encoded
+    utility::Encoding encoding = utility::Encoding::ENCODING_INVALID;
+    SearchMode mode = SearchMode::Text;
+    bool operator==(const SearchRequest &) const noexcept = default;
+};
+
+static void ToggleSearch(nc::vfs::SearchInFile &_search, const SearchRequest &_request)
+{
+    switch( _request.mode ) {
+        case SearchMode::Text:
+            _search.ToggleTextSearch((__bridge CFStringRef)[NSString stringWithUTF8StdString:_request.text],
+                                     _request.encoding);
+            break;
+        case SearchMode::Regex:
+            _search.ToggleRegexSearch(_request.text, _request.encoding);
+            break;
+        case SearchMode::Hex:
+            if( auto pattern = nc::vfs::SearchInFile::BytesPattern::FromHex(_request.text) )
+                _search.ToggleBytesSearch(*pattern);
+            break;
+    }
+}
+
 } // namespace nc::viewer
 
 @interface NCViewerViewController ()
@@ -93,6 +125,8 @@ struct BackgroundFileOpener {
     std::shared_ptr<nc::vfs::FileWindow> m_SearchFileWindow;
     std::shared_ptr<nc::vfs::SearchInFile> m_SearchInFile;
     nc::base::SerialQueue m_SearchInFileQueue;
+    std::optional<nc::viewer::SearchRequest> m_SearchRequest; // the last one toggled in m_SearchInFile
+    nc::viewer::SearchMode m_SearchMode;
     nc::viewer::History *m_History;
     nc::config::Config *m_Config;
     std::function<nc::utility::ActionShortcut(std::string_view _name)> m_Shortcuts;
@@ -123,6 +157,7 @@ struct BackgroundFileOpener {
         m_Config = &_config;
         m_Shortcuts = _shortcuts;
         m_AutomaticFileRefreshScheduled = false;
+        m_SearchMode = static_cast<SearchMode>(std::clamp(m_Config->GetInt(g_ConfigSearchMode), 0, 2));
         __weak NCViewerViewController *weak_self = self;
         m_SearchInFileQueue.SetOnChange(
             [=] { [static_cast<NCViewerViewController *>(weak_self) onSearchInFileQueueStateChanged]; });
@@ -344,29 +379,45 @@ struct BackgroundFileOpener {
     item.target = self;
     [menu insertItem:item atIndex:1];
 
+    item = [[NSMenuItem alloc]
+        initWithTitle:NSLocalizedString(@"Regular expression", "Menu item option in internal viewer search")
+               action:@selector(onSearchFieldMenuRegexAction:)
+        keyEquivalent:@""];
+    item.state = m_SearchMode == SearchMode::Regex;
+    item.target = self;
+    [menu insertItem:item atIndex:2];
+
+    item = [[NSMenuItem alloc]
+        initWithTitle:NSLocalizedString(@"Hexadecimal bytes", "Menu item option in internal viewer search")
+               action:@selector(onSearchFieldMenuHexAction:)
+        keyEquivalent:@""];
+    item.state = m_SearchMode == SearchMode::Hex;
+    item.target = self;
+    [menu insertItem:item atIndex:3];
+
     item = [[NSMenuItem alloc]
         initWithTitle:NSLocalizedString(@"Clear Recents", "Menu item title in internal viewer search")
                action:nullptr
         keyEquivalent:@""];
     item.tag = NSSearchFieldClearRecentsMenuItemTag;
-    [menu insertItem:item atIndex:2];
+    [menu insertItem:item atIndex:4];
 
     item = [NSMenuItem separatorItem];
     item.tag = NSSearchFieldRecentsTitleMenuItemTag;
-    [menu insertItem:item atIndex:3];
+    [menu insertItem:item atIndex:5];
 
     item = [[NSMenuItem alloc]
         initWithTitle:NSLocalizedString(@"Recent Searches", "Menu item title in internal viewer search")
                action:nullptr
         keyEquivalent:@""];
     item.tag = NSSearchFieldRecentsTitleMenuItemTag;
-    [menu insertItem:item atIndex:4];
+    [menu insertItem:item atIndex:6];
 
     item = [[NSMenuItem alloc] initWithTitle:NSLocalizedString(@"Recents", "Menu item title in internal viewer search")
                                       action:nullptr
                                keyEquivalent:@""];
     item.tag = NSSearchFieldRecentsMenuItemTag;
-    [menu insertItem:item atIndex:5];
+    [menu insertItem:item atIndex:7];
 
     return menu;
 }
@@ -392,20 +443,27 @@ struct BackgroundFileOpener {
         return;
     }
 
-    if( m_SearchInFile->TextSearchString() == nullptr ||
-        [str compare:(__bridge NSString *)m_SearchInFile->TextSearchString()] != NSOrderedSame ||
-        m_SearchInFile->TextSearchEncoding() != m_View.encoding ) {
+    SearchRequest request;
+    request.text = str.UTF8String;
+    request.encoding = m_View.encoding;
+    request.mode = m_SearchMode;
+    if( m_SearchRequest != request ) {
         // user did some changes in search request
+        if( request.mode == SearchMode::Hex && !nc::vfs::SearchInFile::BytesPattern::FromHex(request.text) ) {
+            NSBeep();
+            return;
+        }
+
         m_View.selectionInFile = CFRangeMake(-1, 0); // remove current selection
 
         uint64_t view_offset = m_View.verticalPositionInBytes;
-        utility::Encoding encoding = m_View.encoding;
 
         m_SearchInFileQueue.Stop(); // we should stop current search if any
         m_SearchInFileQueue.Wait();
+        m_SearchRequest = request;
         m_SearchInFileQueue.Run([=] {
             m_SearchInFile->MoveCurrentPosition(view_offset);
-            m_SearchInFile->ToggleTextSearch((__bridge CFStringRef)str, encoding);
+            ToggleSearch(*m_SearchInFile, request);
         });
     }
     else {
@@ -427,6 +485,9 @@ struct BackgroundFileOpener {
                 [m_View scrollToSelection];
             });
         }
+        else if( result.response == nc::vfs::SearchInFile::Response::Invalid ) {
+            dispatch_to_main_queue([] { NSBeep(); });
+        }
     });
 }
 
@@ -472,6 +533,28 @@ struct BackgroundFileOpener {
     m_Config->Set(g_ConfigSearchForWholePhrase, bool(options & Options::FindWholePhrase));
 }
 
+- (void)onSearchFieldMenuRegexAction:(id) [[maybe_unused]] _sender
+{
+    [self setSearchMode:m_SearchMode == SearchMode::Regex ? SearchMode::Text : SearchMode::Regex];
+}
+
+- (void)onSearchFieldMenuHexAction:(id) [[maybe_unused]] _sender
+{
+    [self setSearchMode:m_SearchMode == SearchMode::Hex ? SearchMode::Text : SearchMode::Hex];
+}
+
+- (void)setSearchMode:(SearchMode)_mode
+{
+    m_SearchMode = _mode;
+
+    auto cell = static_cast<NSSearchFieldCell *>(m_SearchField.cell);
+    NSMenu *menu = cell.searchMenuTemplate;
+    [menu itemAtIndex:2].state = _mode == SearchMode::Regex;
+    [menu itemAtIndex:3].state = _mode == SearchMode::Hex;
+    cell.searchMenuTemplate = menu;
+    m_Config->Set(g_ConfigSearchMode, static_cast<int>(_mode));
+}
+
 - (void)setSearchProgressIndicator:(NSProgressIndicator *)searchProgressIndicator
 {
     dispatch_assert_main_queue();
@@ -506,6 +589,11 @@ struct BackgroundFileOpener {
         const long pos = string.integerValue;
         m_View.verticalPositionInBytes = std::clamp(pos, 0l, m_WorkFile->Size());
     }
+    if( self.goToPositionKindButton.selectedTag == 2 ) {
+        const long line = string.integerValue; // one-based
+        if( ![m_View scrollToLine:static_cast<uint64_t>(std::max(line, 1l) - 1)] )
+            NSBeep();
+    }
 }
 
 - (void)buildTitle
@@ -537,7 +625,10 @@ struct BackgroundFileOpener {
         m_SearchInFile->MoveCurrentPosition(_selection.location + _selection.length);
     else
         m_SearchInFile->MoveCurrentPosition(0);
-    m_SearchInFile->ToggleTextSearch((__bridge CFStringRef)search_request, m_View.encoding);
+
+    // the term comes from a plain text search, regardless of the mode chosen in the viewer
+    m_SearchRequest = SearchRequest{.text = _request, .encoding = m_View.encoding, .mode = SearchMode::Text};
+    ToggleSearch(*m_SearchInFile, *m_SearchRequest);
 }
 
 - (bool)isOpened
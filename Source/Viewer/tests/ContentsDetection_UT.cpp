@@ -0,0 +1,96 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "ContentsDetection.h"
+#include <VFS/VFSGenericMemReadOnlyFile.h>
+#include <VFS/Host.h>
+#include <string>
+#include <thread>
+
+using nc::utility::Encoding;
+using nc::viewer::DetectContents;
+
+#define PREFIX "DetectContents "
+
+static std::shared_ptr<nc::vfs::FileWindow> MakeWindow(std::string_view _contents)
+{
+    auto file = std::make_shared<nc::vfs::GenericMemReadOnlyFile>("/foo.txt", nc::vfs::Host::DummyHost(), _contents);
+    file->Open(nc::vfs::Flags::OF_Read);
+    return std::make_shared<nc::vfs::FileWindow>(file);
+}
+
+static std::string MakeText(size_t _size)
+{
+    std::string text;
+    while( text.size() < _size )
+        text += "The quick brown fox jumps over the lazy dog.\n";
+    text.resize(_size);
+    return text;
+}
+
+TEST_CASE(PREFIX "Small text file")
+{
+    const std::string contents = "Hello, World!\n";
+    const auto window = MakeWindow(contents);
+    const auto verdict = DetectContents(*window);
+    CHECK(verdict.is_binary == false);
+    CHECK(verdict.candidates.front().encoding == Encoding::ENCODING_UTF8);
+}
+
+TEST_CASE(PREFIX "Looks beyond the head of a file")
+{
+    // "Привет, мир! " in Windows-1251
+    const std::string_view cyrillic = "\xCF\xF0\xE8\xE2\xE5\xF2, \xEC\xE8\xF0! ";
+    std::string contents = MakeText(1'000'000);
+    for( size_t i = 500'000; i + cyrillic.size() < contents.size(); i += 100 )
+        contents.replace(i, cyrillic.size(), cyrillic);
+    const auto window = MakeWindow(contents);
+    const auto verdict = DetectContents(*window, std::chrono::seconds{10});
+    CHECK(verdict.is_binary == false);
+    CHECK(verdict.candidates.front().encoding == Encoding::ENCODING_WIN1251);
+    CHECK(window->WindowPos() == 0);
+}
+
+TEST_CASE(PREFIX "Text with a binary tail")
+{
+    std::string contents = MakeText(1'000'000);
+    for( size_t i = 900'000; i < contents.size(); ++i )
+        contents[i] = static_cast<char>(i % 7);
+    const auto window = MakeWindow(contents);
+    CHECK(DetectContents(*window, std::chrono::seconds{10}).is_binary);
+    CHECK(window->WindowPos() == 0);
+}
+
+TEST_CASE(PREFIX "Takes only the first sample when out of time")
+{
+    std::string contents = MakeText(1'000'000);
+    for( size_t i = 900'000; i < contents.size(); ++i )
+        contents[i] = static_cast<char>(i % 7);
+    const auto window = MakeWindow(contents);
+    CHECK(DetectContents(*window, std::chrono::nanoseconds{0}).is_binary == false);
+}
+
+TEST_CASE(PREFIX "Doesn't wait for a slow read past the budget")
+{
+    struct SlowFile : nc::vfs::GenericMemReadOnlyFile {
+        SlowFile(std::shared_ptr<const std::string> _contents)
+            : GenericMemReadOnlyFile("/foo.txt", nc::vfs::Host::DummyHost(), *_contents), contents(_contents)
+        {
+        }
+        std::shared_ptr<VFSFile> Clone() const override { return std::make_shared<SlowFile>(contents); }
+        ssize_t ReadAt(off_t _pos, void *_buf, size_t _size) override
+        {
+            if( _pos != 0 )
+                std::this_thread::sleep_for(std::chrono::milliseconds{500});
+            return GenericMemReadOnlyFile::ReadAt(_pos, _buf, _size);
+        }
+        std::shared_ptr<const std::string> contents;
+    };
+    const auto contents = std::make_shared<const std::string>(MakeText(1'000'000));
+    const auto file = std::make_shared<SlowFile>(contents);
+    file->Open(nc::vfs::Flags::OF_Read);
+    nc::vfs::FileWindow window(file);
+    const auto started = std::chrono::steady_clock::now();
+    const auto verdict = DetectContents(window, std::chrono::milliseconds{50});
+    CHECK(std::chrono::steady_clock::now() - started < std::chrono::milliseconds{400});
+    CHECK(verdict.is_binary == false);
+}
@@ -0,0 +1,96 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "DataBackend.h"
+#include <VFS/VFSGenericMemReadOnlyFile.h>
+#include <VFS/Host.h>
+#include <cstring>
+#include <string>
+
+using nc::utility::Encoding;
+using nc::viewer::DataBackend;
+
+#define PREFIX "DataBackend "
+
+static std::string MakeContents(size_t _size)
+{
+    std::string contents;
+    for( size_t i = 0; contents.size() < _size; ++i )
+        contents += std::to_string(i) + ' ';
+    contents.resize(_size);
+    return contents;
+}
+
+static std::shared_ptr<DataBackend> MakeBackend(std::string_view _contents, Encoding _encoding)
+{
+    auto file = std::make_shared<nc::vfs::GenericMemReadOnlyFile>("/foo.txt", nc::vfs::Host::DummyHost(), _contents);
+    file->Open(nc::vfs::Flags::OF_Read);
+    auto window = std::make_shared<nc::vfs::FileWindow>(file);
+    return std::make_shared<DataBackend>(window, _encoding);
+}
+
+static bool WindowIsCorrect(const DataBackend &_backend, std::string_view _contents)
+{
+    if( std::memcmp(_backend.Raw(), _contents.data() + _backend.FilePos(), _backend.RawSize()) != 0 )
+        return false;
+    // ASCII contents are decoded one-to-one
+    if( _backend.UniCharsSize() != _backend.RawSize() )
+        return false;
+    for( uint32_t i = 0; i < _backend.UniCharsSize(); ++i )
+        if( _backend.UniChars()[i] != static_cast<unsigned char>(_contents[_backend.FilePos() + i]) ||
+            _backend.UniCharToByteIndeces()[i] != i )
+            return false;
+    return true;
+}
+
+TEST_CASE(PREFIX "Moves the window")
+{
+    const std::string contents = MakeContents(1'000'000);
+    const auto backend = MakeBackend(contents, Encoding::ENCODING_UTF8);
+    REQUIRE(backend->FilePos() == 0);
+    REQUIRE(backend->RawSize() == nc::vfs::FileWindow::DefaultWindowSize);
+    CHECK(WindowIsCorrect(*backend, contents));
+    for( const uint64_t pos : {100'000, 110'000, 90'000, 500'000, 0, 1'000'000 - 32768} ) {
+        REQUIRE(backend->MoveWindowSync(pos) == 0);
+        CHECK(backend->FilePos() == pos);
+        CHECK(WindowIsCorrect(*backend, contents));
+    }
+    CHECK(backend->MoveWindowSync(1'000'000) != 0);
+}
+
+TEST_CASE(PREFIX "Sequential movements are served from prefetched windows")
+{
+    const std::string contents = MakeContents(1'000'000);
+    const auto backend = MakeBackend(contents, Encoding::ENCODING_UTF8);
+    const uint64_t stride = backend->RawSize() / 2;
+    int moves = 0;
+    for( uint64_t pos = stride; pos + backend->RawSize() <= contents.size(); pos += stride, ++moves ) {
+        REQUIRE(backend->MoveWindowSync(pos) == 0);
+        REQUIRE(WindowIsCorrect(*backend, contents));
+        backend->WaitForPrefetching();
+    }
+    for( uint64_t pos = backend->FilePos() - stride; pos != 0; pos -= stride, ++moves ) {
+        REQUIRE(backend->MoveWindowSync(pos) == 0);
+        REQUIRE(WindowIsCorrect(*backend, contents));
+        backend->WaitForPrefetching();
+    }
+    // only the very first movement has no direction to prefetch in
+    const auto stats = backend->PrefetchStats();
+    CHECK(stats.misses == 1);
+    CHECK(stats.hits == static_cast<uint64_t>(moves - 1));
+}
+
+TEST_CASE(PREFIX "Changing the encoding drops prefetched windows")
+{
+    std::string contents;
+    for( int i = 0; i < 100'000; ++i )
+        contents += reinterpret_cast<const char *>(u8"Привет! ");
+    const auto backend = MakeBackend(contents, Encoding::ENCODING_MACOS_ROMAN_WESTERN);
+    const uint64_t stride = backend->RawSize() / 2;
+    REQUIRE(backend->MoveWindowSync(stride) == 0);
+    backend->WaitForPrefetching();
+    backend->SetEncoding(Encoding::ENCODING_UTF8);
+    REQUIRE(backend->MoveWindowSync(stride * 2) == 0);
+    // decoded as UTF8 there are fewer characters than bytes
+    CHECK(backend->UniCharsSize() < backend->RawSize());
+    CHECK(backend->PrefetchStats().hits == 0);
+}
@@ -86,6 +86,46 @@ TEST_CASE(PREFIX "Verify RowsBuilder against Hello, World!")
     }
 }
 
+TEST_CASE(PREFIX "RowsBuilder reuses the rows from RowsCache only when the bytes are the same")
+{
+    auto string = std::string{"0123456789abcdef"};
+    const auto font = CTFontCreateWithName(CFSTR("Menlo-Regular"), 13., nullptr);
+    const auto release_font = at_scope_end([&] { CFRelease(font); });
+    HexModeFrame::Source source;
+    source.raw_bytes_begin = reinterpret_cast<const std::byte *>(string.data());
+    source.raw_bytes_end = reinterpret_cast<const std::byte *>(string.data()) + string.size();
+    source.font = font;
+    source.font_info = nc::utility::FontGeometryInfo{font};
+    source.foreground_color = CGColorGetConstantColor(kCGColorBlack);
+    source.digits_in_address = 6;
+    source.bytes_per_column = 4;
+    source.number_of_columns = 2;
+    source.rows_cache = std::make_shared<HexModeFrame::RowsCache>();
+    const auto build = [&] {
+        source.working_set = ProduceWorkingSet(string.data(), static_cast<int>(string.length()));
+        const HexModeFrame::RowsBuilder builder(source);
+        return builder.Build(std::make_pair(8, 8), std::make_pair(8, 8), std::make_pair(8, 8));
+    };
+    const auto row1 = build();
+    const auto row2 = build();
+    REQUIRE(row2.ColumnsNumber() == 2);
+    CHECK(row1.AddressString() == row2.AddressString()); // the very same object
+    CHECK(row1.ColumnString(1) == row2.ColumnString(1));
+    CHECK(Equal(row2.SnippetString(), CFSTR("89abcdef")));
+    CHECK(Equal(row2.ColumnString(0), CFSTR("38 39 61 62")));
+
+    string[15] = 'F';
+    const auto row3 = build();
+    CHECK(Equal(row3.SnippetString(), CFSTR("89abcdeF")));
+    CHECK(Equal(row3.ColumnString(1), CFSTR("63 64 65 46")));
+
+    source.bytes_per_column = 8;
+    source.number_of_columns = 1;
+    const auto row4 = build();
+    REQUIRE(row4.ColumnsNumber() == 1);
+    CHECK(Equal(row4.ColumnString(0), CFSTR("38 39 61 62 63 64 65 46")));
+}
+
 [[maybe_unused]] static std::shared_ptr<const TextModeWorkingSet>
 ProduceWorkingSet(const char16_t *_chars, const int _chars_number, long _ws_offset)
 {
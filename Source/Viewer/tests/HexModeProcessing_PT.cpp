@@ -0,0 +1,44 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "Tests.h"
+#include "HexModeProcessing.h"
+#include <random>
+#include <string>
+#include <vector>
+
+// NB! disable by default, include in the ViewerUT to enable
+
+#define PREFIX "HexModeProcessing PT "
+
+using namespace nc::viewer;
+
+static std::vector<std::byte> MakeData()
+{
+    std::vector<std::byte> data(64 * 1024 * 1024);
+    std::mt19937 rng(42);
+    for( auto &byte : data )
+        byte = static_cast<std::byte>(rng());
+    return data;
+}
+
+TEST_CASE(PREFIX "Formatting 64MB", "[!benchmark]")
+{
+    const auto data = MakeData();
+    const auto first = data.data();
+    const auto last = data.data() + data.size();
+
+    BENCHMARK("FormatBytesHex, whole buffer")
+    {
+        std::u16string output(data.size() * 3, u' ');
+        HexModeSplitter::FormatBytesHex(first, last, output.data(), u' ');
+        return output.back();
+    };
+
+    BENCHMARK("MakeBytesHexString, 8-byte columns")
+    {
+        long length = 0;
+        for( auto column = first; column < last; column += 8 )
+            length += CFStringGetLength(HexModeSplitter::MakeBytesHexString(column, column + 8).get());
+        return length;
+    };
+}
@@ -5,6 +5,8 @@
 #include <Utility/Encodings.h>
 
 #include <algorithm>
+#include <string>
+#include <vector>
 
 using namespace nc::viewer;
 
@@ -362,6 +364,30 @@ TEST_CASE(PREFIX "Check hex conversions")
     }
 }
 
+TEST_CASE(PREFIX "FormatBytesHex matches a straightforward formatting for all bytes and lengths")
+{
+    std::vector<std::byte> data(300);
+    for( size_t i = 0; i < data.size(); ++i )
+        data[i] = static_cast<std::byte>((i * 7 + 3) % 256);
+    // every byte value is covered at some position, vectorized paths are hit at different alignments
+    for( size_t offset = 0; offset < 17; ++offset ) {
+        for( size_t length = 0; offset + length <= data.size(); length += 13 ) {
+            std::u16string expected;
+            for( size_t i = 0; i < length; ++i ) {
+                const auto byte = std::to_integer<unsigned>(data[offset + i]);
+                expected += u"0123456789ABCDEF"[byte >> 4];
+                expected += u"0123456789ABCDEF"[byte & 0xF];
+                expected += u'|';
+            }
+            std::u16string actual(length * 3, u'?');
+            HexModeSplitter::FormatBytesHex(data.data() + offset, data.data() + offset + length, actual.data(), u'|');
+            INFO(offset);
+            INFO(length);
+            CHECK(actual == expected);
+        }
+    }
+}
+
 [[maybe_unused]] static std::shared_ptr<const TextModeWorkingSet>
 ProduceWorkingSet(const char16_t *_chars, const int _chars_number, long _ws_offset)
 {
@@ -0,0 +1,137 @@
+// Copyright (C) 2024 Michael Kazakov. Subject to GNU General Public License version 3.
+#include "Tests.h"
+#include "LineIndex.h"
+#include <VFS/VFSGenericMemReadOnlyFile.h>
+#include <VFS/Host.h>
+#include <string>
+
+using nc::utility::Encoding;
+using nc::viewer::LineIndex;
+
+#define PREFIX "LineIndex "
+
+static VFSFilePtr MakeFile(std::string_view _contents)
+{
+    auto file = std::make_shared<nc::vfs::GenericMemReadOnlyFile>("/foo.txt", nc::vfs::Host::DummyHost(), _contents);
+    file->Open(nc::vfs::Flags::OF_Read);
+    return file;
+}
+
+static std::string ToUTF16(std::string_view _ascii, Encoding _encoding)
+{
+    std::string result;
+    for( const char c : _ascii ) {
+        if( _encoding == Encoding::ENCODING_UTF16LE ) {
+            result += c;
+            result += '\0';
+        }
+        else {
+            result += '\0';
+            result += c;
+        }
+    }
+    return result;
+}
+
+TEST_CASE(PREFIX "Basic cases")
+{
+    struct TC {
+        std::string_view contents;
+        uint64_t lines;
+    } const tcs[] = {
+        {"", 1},
+        {"a", 1},
+        {"\n", 1},
+        {"\n\n", 2},
+        {"abc\ndef", 2},
+        {"abc\ndef\n", 2},
+        {"abc\r\ndef\r\n\r\n", 3},
+    };
+    for( const auto &tc : tcs ) {
+        INFO(tc.contents);
+        const LineIndex index(MakeFile(tc.contents), Encoding::ENCODING_UTF8);
+        index.Wait();
+        CHECK(index.IsComplete());
+        CHECK(!index.IsFailed());
+        CHECK(index.IndexedBytes() == tc.contents.size());
+        CHECK(index.LinesCount() == tc.lines);
+        CHECK(index.LineToOffset(0) == 0);
+        CHECK(index.LineToOffset(tc.lines) == std::nullopt);
+        CHECK(index.OffsetToLine(tc.contents.size()) == std::nullopt);
+    }
+}
+
+TEST_CASE(PREFIX "Maps lines to offsets and back")
+{
+    const std::string contents = "first\nsecond line\n\nfourth";
+    const LineIndex index(MakeFile(contents), Encoding::ENCODING_UTF8);
+    index.Wait();
+    REQUIRE(index.LinesCount() == 4);
+    CHECK(index.LineToOffset(1) == 6);
+    CHECK(index.LineToOffset(2) == 18);
+    CHECK(index.LineToOffset(3) == 19);
+    CHECK(index.OffsetToLine(0) == 0);
+    CHECK(index.OffsetToLine(5) == 0);
+    CHECK(index.OffsetToLine(6) == 1);
+    CHECK(index.OffsetToLine(17) == 1);
+    CHECK(index.OffsetToLine(18) == 2);
+    CHECK(index.OffsetToLine(19) == 3);
+    CHECK(index.OffsetToLine(24) == 3);
+}
+
+TEST_CASE(PREFIX "Crosses checkpoints and chunks")
+{
+    // lines of varying length, ~8MB in total
+    std::string contents;
+    std::vector<uint64_t> offsets;
+    for( int i = 0; i < 300'000; ++i ) {
+        offsets.push_back(contents.size());
+        contents += std::string(i % 41, 'x');
+        contents += '\n';
+    }
+    const LineIndex index(MakeFile(contents), Encoding::ENCODING_UTF8);
+    index.Wait();
+    REQUIRE(index.IsComplete());
+    REQUIRE(index.LinesCount() == offsets.size());
+    for( size_t line = 0; line < offsets.size(); line += 997 ) {
+        CHECK(index.LineToOffset(line) == offsets[line]);
+        CHECK(index.OffsetToLine(offsets[line]) == line);
+    }
+    for( const uint64_t line : {1023, 1024, 1025, 2048, 299'999} ) {
+        CHECK(index.LineToOffset(line) == offsets[line]);
+        CHECK(index.OffsetToLine(offsets[line]) == line);
+        CHECK(index.OffsetToLine(offsets[line] - 1) == line - 1);
+    }
+}
+
+TEST_CASE(PREFIX "UTF16")
+{
+    for( const auto encoding : {Encoding::ENCODING_UTF16LE, Encoding::ENCODING_UTF16BE} ) {
+        // U+0A0A and U+0A00/U+000A mixtures must not be mistaken for newlines
+        std::string contents = ToUTF16("ab\ncd\n", encoding);
+        contents += std::string_view("\x0A\x0A", 2);
+        contents += ToUTF16("\nx", encoding);
+        contents += std::string_view(encoding == Encoding::ENCODING_UTF16LE ? "\x00\x0A" : "\x0A\x00", 2);
+        const LineIndex index(MakeFile(contents), encoding);
+        index.Wait();
+        REQUIRE(index.IsComplete());
+        CHECK(index.LinesCount() == 4);
+        CHECK(index.LineToOffset(1) == 6);
+        CHECK(index.LineToOffset(2) == 12);
+        CHECK(index.LineToOffset(3) == 16);
+        CHECK(index.OffsetToLine(5) == 0);
+        CHECK(index.OffsetToLine(6) == 1);
+        CHECK(index.OffsetToLine(15) == 2);
+        CHECK(index.OffsetToLine(19) == 3);
+    }
+}
+
+TEST_CASE(PREFIX "Can be destroyed while indexing")
+{
+    // the data must outlive the background scanning which can still be running after the index is gone
+    [[clang::no_destroy]] static const std::string contents(64 * 1024 * 1024, '\n');
+    for( int i = 0; i < 10; ++i ) {
+        const LineIndex index(MakeFile(contents), Encoding::ENCODING_UTF8);
+        CHECK(index.LineToOffset(0) == 0);
+    }
+}